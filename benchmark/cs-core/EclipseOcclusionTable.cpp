@@ -0,0 +1,102 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "../../src/cs-core/EclipseOcclusionTable.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+
+// This compares two ways of finding the occluders which cast a shadow onto each shadow receiver of
+// a scene. Before the EclipseOcclusionTable was introduced, each receiver tested all occluders
+// itself. Now the table is computed once per frame and each receiver only performs a look-up.
+
+using namespace cs::core;
+
+namespace {
+
+const EclipseOcclusionTable::Sphere cSun{glm::dvec3(1.5e11, 0.0, 0.0), 6.96e8};
+const EclipseOcclusionTable::Sphere cEarth{glm::dvec3(0.0, 0.0, 0.0), 6.371e6};
+
+// Creates a scene with the given number of bodies scattered around the Earth. The first few bodies
+// are used as occluders.
+std::vector<EclipseOcclusionTable::Sphere> createBodies(int count) {
+  std::mt19937                           gen(42);
+  std::uniform_real_distribution<double> position(-4e8, 4e8);
+  std::uniform_real_distribution<double> radius(1e3, 2e6);
+
+  std::vector<EclipseOcclusionTable::Sphere> bodies{cEarth};
+
+  for (int i = 1; i < count; ++i) {
+    bodies.push_back({glm::dvec3(position(gen), position(gen), position(gen)), radius(gen)});
+  }
+
+  return bodies;
+}
+
+} // namespace
+
+int main() {
+  const int frameCount = 200;
+
+  // Each body is assumed to own this many shadow receivers, e.g. for the body itself, its
+  // atmosphere, its rings, and some overlays.
+  const int receiversPerBody = 4;
+
+  for (int bodyCount : {100, 500, 1000}) {
+    for (int occluderCount : {4, 16}) {
+      auto bodies    = createBodies(bodyCount);
+      auto occluders = std::vector<EclipseOcclusionTable::Sphere>(
+          bodies.begin(), bodies.begin() + occluderCount);
+
+      EclipseOcclusionTable table;
+      size_t                found = 0;
+
+      auto measure = [&](std::string const& label, auto&& func) {
+        found      = 0;
+        auto start = std::chrono::steady_clock::now();
+
+        for (int f = 0; f < frameCount; ++f) {
+          func();
+        }
+
+        double us = std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - start)
+                        .count();
+
+        std::cout << label << ": " << us / frameCount << " µs per frame with " << bodyCount
+                  << " bodies and " << occluderCount << " occluders (" << found / frameCount
+                  << " shadowed receivers)" << std::endl;
+      };
+
+      measure("Per-receiver tests", [&]() {
+        for (auto const& body : bodies) {
+          for (int r = 0; r < receiversPerBody; ++r) {
+            for (auto const& occluder : occluders) {
+              found += EclipseOcclusionTable::isInPenumbra(cSun, occluder, body) ? 1 : 0;
+            }
+          }
+        }
+      });
+
+      measure("Occlusion table", [&]() {
+        table.update(cSun, occluders, bodies);
+
+        for (size_t b = 0; b < bodies.size(); ++b) {
+          for (int r = 0; r < receiversPerBody; ++r) {
+            size_t count = 0;
+            table.getOccluders(b, count);
+            found += count;
+          }
+        }
+      });
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,71 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "../../src/cs-core/ObjectHandle.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// This compares looking up celestial objects by name, like SolarSystem::getObject() does, with
+// accessing them through an ObjectHandle which has been created once.
+
+using namespace cs;
+
+int main() {
+  const int objectCount = 200;
+  const int frameCount  = 1000;
+
+  // Roughly the number of times each object is looked up per frame by the trajectories, bodies,
+  // atmospheres, overlays, labels, and eclipse shadows.
+  const int accessesPerObject = 5;
+
+  core::ObjectHandleRegistry::ObjectMap objects;
+  std::vector<std::string>              names;
+
+  for (int i = 0; i < objectCount; ++i) {
+    names.push_back("Object " + std::to_string(i));
+    objects.insert(names.back(),
+        std::make_shared<scene::CelestialObject>("Center " + std::to_string(i), "J2000"));
+  }
+
+  core::ObjectHandleRegistry      registry(objects);
+  std::vector<core::ObjectHandle> handles;
+
+  for (auto const& name : names) {
+    handles.push_back(registry.getHandle(name));
+  }
+
+  // This is accumulated and printed so that the compiler cannot optimize the look-ups away.
+  size_t checksum = 0;
+
+  auto measure = [&](std::string const& label, auto&& func) {
+    auto start = std::chrono::steady_clock::now();
+
+    for (int f = 0; f < frameCount; ++f) {
+      for (int i = 0; i < objectCount; ++i) {
+        for (int a = 0; a < accessesPerObject; ++a) {
+          checksum += func(i)->getCenterName().size();
+        }
+      }
+    }
+
+    double us =
+        std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << label << ": " << us / frameCount << " µs per frame with " << objectCount
+              << " objects" << std::endl;
+  };
+
+  measure("Map look-up", [&](int i) { return objects.find(names[i])->second; });
+  measure("Object handle", [&](int i) { return handles[i].get().get(); });
+
+  std::cout << "Checksum: " << checksum << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,80 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "../../src/cs-utils/FrameStats.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// This measures the CPU overhead of FrameStats::ScopedTimer for a frame with many timed ranges.
+// The ranges are either named by concatenating a string for each scope, like the per-object
+// timers used to do, or by an interned FrameStats::RangeId which is created once. Both variants
+// are measured with pEnableMeasurements set to false and to true.
+
+using namespace cs::utils;
+
+int main() {
+  const int frameCount = 200;
+  const int rangeCount = 500;
+
+  auto& stats = FrameStats::get();
+
+  std::vector<std::string>         objectNames;
+  std::vector<FrameStats::RangeId> ranges;
+
+  for (int i = 0; i < rangeCount; ++i) {
+    objectNames.emplace_back("Object " + std::to_string(i));
+    ranges.emplace_back("Update " + objectNames.back());
+  }
+
+  auto measure = [&](std::string const& label, auto&& func) {
+    auto start = std::chrono::steady_clock::now();
+
+    for (int f = 0; f < frameCount; ++f) {
+      for (int i = 0; i < rangeCount; ++i) {
+        func(i);
+      }
+    }
+
+    double us =
+        std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << label << ": " << us / frameCount << " µs per frame with " << rangeCount
+              << " ranges" << std::endl;
+  };
+
+  stats.pEnableMeasurements = false;
+
+  measure("Disabled, string concatenation", [&](int i) {
+    FrameStats::ScopedTimer timer("Update " + objectNames[i], FrameStats::TimerMode::eCPU);
+  });
+
+  measure("Disabled, RangeId", [&](int i) {
+    FrameStats::ScopedTimer timer(ranges[i], FrameStats::TimerMode::eCPU);
+  });
+
+  // The results are never reset here, as FrameStats::startFrame() requires an OpenGL context.
+  // Toggling pEnableMeasurements recreates the query pools, so both variants start without results.
+  stats.pEnableMeasurements = true;
+
+  measure("Enabled, string concatenation", [&](int i) {
+    FrameStats::ScopedTimer timer("Update " + objectNames[i], FrameStats::TimerMode::eCPU);
+  });
+
+  stats.pEnableMeasurements = false;
+  stats.pEnableMeasurements = true;
+
+  measure("Enabled, RangeId", [&](int i) {
+    FrameStats::ScopedTimer timer(ranges[i], FrameStats::TimerMode::eCPU);
+  });
+
+  stats.pEnableMeasurements = false;
+
+  return 0;
+}
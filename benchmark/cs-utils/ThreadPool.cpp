@@ -0,0 +1,103 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "../../src/cs-utils/ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// This measures the throughput of the ThreadPool for many tiny tasks. First, several producer
+// threads enqueue tasks concurrently, which is where the global lock of a single task queue
+// contended most. Then, a recursive computation enqueues nested tasks from within the workers, so
+// that idle workers have to steal them.
+
+using namespace cs::utils;
+
+namespace {
+
+void measureProducers(size_t threads) {
+  const int taskCount = 200000;
+
+  ThreadPool       pool(threads);
+  std::atomic<int> counter = 0;
+
+  auto start = std::chrono::steady_clock::now();
+
+  std::vector<std::thread> producers;
+  for (size_t p = 0; p < threads; ++p) {
+    producers.emplace_back([&]() {
+      for (int i = 0; i < taskCount / static_cast<int>(threads); ++i) {
+        pool.enqueue([&]() { ++counter; });
+      }
+    });
+  }
+
+  for (auto& producer : producers) {
+    producer.join();
+  }
+
+  while (!pool.hasFinished()) {
+    std::this_thread::yield();
+  }
+
+  double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+                  .count();
+
+  std::cout << "Producers: " << threads << " threads, " << counter << " tasks in " << ms << " ms ("
+            << counter / ms << " tasks/ms)" << std::endl;
+}
+
+void measureNestedTasks(size_t threads) {
+  ThreadPool pool(threads);
+
+  std::function<int(int)> fib = [&](int n) -> int {
+    if (n < 16) {
+      return n < 2 ? n : fib(n - 1) + fib(n - 2);
+    }
+
+    auto a = pool.enqueue([&, n]() { return fib(n - 1); });
+    int  b = fib(n - 2);
+
+    while (a.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+      pool.runPendingTask();
+    }
+
+    return a.get() + b;
+  };
+
+  auto start  = std::chrono::steady_clock::now();
+  int  result = pool.enqueue([&]() { return fib(30); }).get();
+
+  double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+                  .count();
+
+  std::cout << "Nested tasks: " << threads << " threads, fib(30) = " << result << " in " << ms
+            << " ms" << std::endl;
+}
+
+} // namespace
+
+int main() {
+  size_t hardwareThreads = std::max(1U, std::thread::hardware_concurrency());
+
+  for (size_t threads : {size_t(1), size_t(2), size_t(4)}) {
+    measureProducers(threads);
+  }
+
+  if (hardwareThreads > 4) {
+    measureProducers(hardwareThreads);
+  }
+
+  measureNestedTasks(hardwareThreads);
+
+  return 0;
+}
@@ -76,6 +76,7 @@ Mark::Mark(std::shared_ptr<cs::core::InputManager> pInputManager,
     , mInputManager(std::move(pInputManager))
     , mSolarSystem(std::move(pSolarSystem))
     , mSettings(std::move(settings))
+    , mObject(mSolarSystem->getObjectHandle(getObjectName()))
     , mPosition(0.0, 0.0, 0.0)
     , mShader(std::make_unique<VistaGLSLShader>()) {
 
@@ -95,6 +96,7 @@ Mark::Mark(Mark const& other)
     , mInputManager(other.mInputManager)
     , mSolarSystem(other.mSolarSystem)
     , mSettings(other.mSettings)
+    , mObject(other.mObject)
     , mPosition(other.mPosition)
     , mShader(std::make_unique<VistaGLSLShader>()) {
 
@@ -126,9 +128,16 @@ glm::dvec3 const& Mark::getPosition() const {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void Mark::setObjectName(std::string name) {
+  Tool::setObjectName(std::move(name));
+  mObject = mSolarSystem->getObjectHandle(getObjectName());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 void Mark::update() {
 
-  auto object = mSolarSystem->getObject(getObjectName());
+  auto const& object = mObject.get();
 
   // This seems to be the first time the tool is moved, so we have to store the distance to the
   // observer so that we can scale the tool later based on the observer's position.
@@ -224,7 +233,7 @@ void Mark::initData() {
   mHoveredPlanetConnection =
       mInputManager->pHoveredObject.connect([this](cs::core::InputManager::Intersection const& i) {
         if (pActive.get() && i.mObject) {
-          auto object = mSolarSystem->getObject(getObjectName());
+          auto const& object = mObject.get();
           if (i.mObject == object) {
             auto radii = object->getRadii();
             pLngLat    = cs::utils::convert::cartesianToLngLat(i.mPosition, radii);
@@ -235,22 +244,22 @@ void Mark::initData() {
   // update position
   mSelfLngLatConnection = pLngLat.connect([this](glm::dvec2 const& lngLat) {
     // Request the height under the Mark and add it
-    auto   object  = mSolarSystem->getObject(getObjectName());
-    auto   surface = object->getSurface();
-    double height  = surface ? surface->getHeight(lngLat) : 0.0;
-    auto   radii   = object->getRadii();
-    mPosition      = cs::utils::convert::toCartesian(
-             lngLat, radii, height * mSettings->mGraphics.pHeightScale.get());
+    auto const& object  = mObject.get();
+    auto        surface = object->getSurface();
+    double      height  = surface ? surface->getHeight(lngLat) : 0.0;
+    auto        radii   = object->getRadii();
+    mPosition           = cs::utils::convert::toCartesian(
+        lngLat, radii, height * mSettings->mGraphics.pHeightScale.get());
   });
 
   // connect the heightscale value to this object. Whenever the heightscale value changes
   // the landmark will be set to the correct height value
   mHeightScaleConnection = mSettings->mGraphics.pHeightScale.connect([this](float h) {
-    auto   object  = mSolarSystem->getObject(getObjectName());
-    auto   surface = object->getSurface();
-    double height  = surface ? surface->getHeight(pLngLat.get()) * h : 0.0;
-    auto   radii   = object->getRadii();
-    mPosition      = cs::utils::convert::toCartesian(pLngLat.get(), radii, height);
+    auto const& object  = mObject.get();
+    auto        surface = object->getSurface();
+    double      height  = surface ? surface->getHeight(pLngLat.get()) * h : 0.0;
+    auto        radii   = object->getRadii();
+    mPosition           = cs::utils::convert::toCartesian(pLngLat.get(), radii, height);
   });
 }
 
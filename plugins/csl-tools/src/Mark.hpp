@@ -10,6 +10,8 @@
 
 #include "Tool.hpp"
 
+#include "../../../src/cs-core/ObjectHandle.hpp"
+
 #include <VistaBase/VistaColor.h>
 #include <VistaKernel/GraphicsManager/VistaOpenGLDraw.h>
 #include <VistaKernel/GraphicsManager/VistaOpenGLNode.h>
@@ -62,6 +64,9 @@ class CSL_TOOLS_EXPORT Mark : public IVistaOpenGLDraw, public Tool {
 
   glm::dvec3 const& getPosition() const;
 
+  /// Also updates the handle of the object the mark is attached to.
+  void setObjectName(std::string name) override;
+
   /// Called from Tools class.
   void update() override;
 
@@ -73,6 +78,7 @@ class CSL_TOOLS_EXPORT Mark : public IVistaOpenGLDraw, public Tool {
   std::shared_ptr<cs::core::InputManager> mInputManager;
   std::shared_ptr<cs::core::SolarSystem>  mSolarSystem;
   std::shared_ptr<cs::core::Settings>     mSettings;
+  cs::core::ObjectHandle                  mObject;
 
   std::unique_ptr<VistaTransformNode> mTransform;
   std::unique_ptr<VistaOpenGLNode>    mParent;
@@ -0,0 +1,1230 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-FileCopyrightText: 2017 Eric Bruneton
+// SPDX-FileCopyrightText: 2008 INRIA
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "CpuPreprocessor.hpp"
+
+#include "common.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/constants.hpp>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+// This file contains a C++ port of the shader code in csp-atmosphere-preprocessing-functions.glsl
+// and of the parts of the common.glsl of the Bruneton model which are used during preprocessing.
+// Both are based on the original implementation by Eric Bruneton:
+// https://github.com/ebruneton/precomputed_atmospheric_scattering/blob/master/atmosphere/functions.glsl
+
+// The functions below have the same names as their GLSL counterparts and use the same floating
+// point precision, so that the results can be compared to the output of the OpenGL preprocessor.
+// Please refer to the GLSL files for a detailed explanation of the individual methods. The only
+// intended differences are:
+//   * The GLSL code uses preprocessor directives to switch between the variants with and without
+//     refraction. Here, this is a runtime decision.
+//   * Textures are sampled in software. The GPU uses a reduced precision for the interpolation
+//     weights, so there will be some small differences to the OpenGL output.
+//   * The density distributions and phase functions are sampled directly from one-dimensional
+//     arrays instead of rows of a texture. As the texture coordinates used in the GLSL code always
+//     hit the center of a row, this makes no difference.
+
+namespace {
+
+// Helpers -----------------------------------------------------------------------------------------
+
+// These helpers do not depend on any atmosphere parameters.
+
+float clampCosine(float mu) {
+  return std::clamp(mu, -1.F, 1.F);
+}
+
+double clampCosine(double mu) {
+  return std::clamp(mu, -1.0, 1.0);
+}
+
+float clampDistance(float d) {
+  return std::max(d, 0.F);
+}
+
+float safeSqrt(float a) {
+  return std::sqrt(std::max(a, 0.F));
+}
+
+float smoothstep(float edge0, float edge1, float x) {
+  float t = std::clamp((x - edge0) / (edge1 - edge0), 0.F, 1.F);
+  return t * t * (3.F - 2.F * t);
+}
+
+float angleBetweenVectors(glm::vec2 const& u, glm::vec2 const& v) {
+  return 2.F * std::asin(0.5F * glm::length(u - v));
+}
+
+float getTextureCoordFromUnitRange(float x, int textureSize) {
+  return 0.5F / static_cast<float>(textureSize) + x * (1.F - 1.F / static_cast<float>(textureSize));
+}
+
+float getUnitRangeFromTextureCoord(float u, int textureSize) {
+  return (u - 0.5F / static_cast<float>(textureSize)) /
+         (1.F - 1.F / static_cast<float>(textureSize));
+}
+
+// Samples the given one-dimensional data like a texture row with linear filtering and
+// clamp-to-edge wrapping.
+template <typename T>
+T sample(std::vector<T> const& data, float u) {
+  float   x    = u * static_cast<float>(data.size()) - 0.5F;
+  float   x0   = std::floor(x);
+  float   t    = x - x0;
+  int32_t last = static_cast<int32_t>(data.size()) - 1;
+  int32_t i0   = std::clamp(static_cast<int32_t>(x0), 0, last);
+  int32_t i1   = std::clamp(static_cast<int32_t>(x0) + 1, 0, last);
+  return data[i0] * (1.F - t) + data[i1] * t;
+}
+
+// Atmosphere Model --------------------------------------------------------------------------------
+
+// This class contains all constants which are injected into the GLSL code by the Preprocessor as
+// well as the ported shader functions. A new instance is created for each batch of wavelengths.
+
+using Texture = CpuPreprocessor::Texture;
+
+struct ScatteringComponent {
+  std::vector<float> const* mDensity{};
+  std::vector<glm::vec3>    mPhase;
+  glm::vec3                 mExtinction{};
+  glm::vec3                 mScattering{};
+};
+
+struct AbsorbingComponent {
+  std::vector<float> const* mDensity{};
+  glm::vec3                 mExtinction{};
+};
+
+struct RayInfo {
+  float mOpticalDepth   = 0.F;
+  float mThetaDeviation = 0.F;
+  float mContactRadius  = 0.F;
+};
+
+class Model {
+ public:
+  Model(Params const& params, Metadata const& metadata, std::vector<float> const& phaseData,
+      glm::vec3 const& lambdas)
+      : mRefraction(params.mRefraction.get())
+      , mTransmittanceTextureWidth(params.mTransmittanceTextureWidth.get())
+      , mTransmittanceTextureHeight(params.mTransmittanceTextureHeight.get())
+      , mScatteringTextureRSize(params.mScatteringTextureRSize.get())
+      , mScatteringTextureMuSize(params.mScatteringTextureMuSize.get())
+      , mScatteringTextureMuSSize(params.mScatteringTextureMuSSize.get())
+      , mScatteringTextureNuSize(params.mScatteringTextureNuSize.get())
+      , mIrradianceTextureWidth(params.mIrradianceTextureWidth.get())
+      , mIrradianceTextureHeight(params.mIrradianceTextureHeight.get())
+      , mSampleCountOpticalDepth(params.mSampleCountOpticalDepth.get())
+      , mStepSizeOpticalDepth(params.mStepSizeOpticalDepth.get())
+      , mSampleCountSingleScattering(params.mSampleCountSingleScattering.get())
+      , mStepSizeSingleScattering(params.mStepSizeSingleScattering.get())
+      , mSampleCountScatteringDensity(params.mSampleCountScatteringDensity.get())
+      , mSampleCountMultiScattering(params.mSampleCountMultiScattering.get())
+      , mStepSizeMultiScattering(params.mStepSizeMultiScattering.get())
+      , mSampleCountIndirectIrradiance(params.mSampleCountIndirectIrradiance.get())
+      , mSolarIrradiance(common::getSolarIrradiance(lambdas))
+      , mGroundAlbedo(params.mGroundAlbedo.get())
+      , mIndexOfRefraction(params.mRefractiveIndex)
+      , mSunAngularRadius(metadata.mSunAngularRadius)
+      , mBottomRadius(params.mMinAltitude)
+      , mTopRadius(params.mMaxAltitude)
+      , mMuSMin(std::cos(params.mMaxSunZenithAngle.get())) {
+
+    // The phase data contains one row of RGB values for each scattering component.
+    size_t numAngles = params.mMolecules.mPhase.size();
+
+    auto createScatteringComponent = [&](Params::ScatteringComponent const& component,
+                                         size_t                             phaseRow) {
+      ScatteringComponent result;
+      result.mDensity    = &component.mDensity;
+      result.mScattering = common::interpolate(params.mWavelengths, component.mScattering, lambdas);
+      result.mExtinction = result.mScattering +
+                           common::interpolate(params.mWavelengths, component.mAbsorption, lambdas);
+
+      for (size_t i = 0; i < numAngles; ++i) {
+        size_t offset = 3 * (phaseRow * numAngles + i);
+        result.mPhase.emplace_back(
+            phaseData[offset], phaseData[offset + 1], phaseData[offset + 2]);
+      }
+
+      return result;
+    };
+
+    mMolecules = createScatteringComponent(params.mMolecules, 0);
+    mAerosols  = createScatteringComponent(params.mAerosols, 1);
+
+    mOzone.mDensity = &params.mOzone->mDensity;
+    mOzone.mExtinction =
+        common::interpolate(params.mWavelengths, params.mOzone->mAbsorption, lambdas);
+  }
+
+  // common.glsl -----------------------------------------------------------------------------------
+
+  float clampRadius(float r) const {
+    return std::clamp(r, mBottomRadius, mTopRadius);
+  }
+
+  float distanceToTopAtmosphereBoundary(float r, float mu) const {
+    float discriminant = r * r * (mu * mu - 1.F) + mTopRadius * mTopRadius;
+    return clampDistance(-r * mu + safeSqrt(discriminant));
+  }
+
+  float distanceToBottomAtmosphereBoundary(float r, float mu) const {
+    float discriminant = r * r * (mu * mu - 1.F) + mBottomRadius * mBottomRadius;
+    return clampDistance(-r * mu - safeSqrt(discriminant));
+  }
+
+  bool rayIntersectsGround(float r, float mu) const {
+    return mu < 0.F && r * r * (mu * mu - 1.F) + mBottomRadius * mBottomRadius >= 0.F;
+  }
+
+  float distanceToNearestAtmosphereBoundary(float r, float mu, bool rayRMuIntersectsGround) const {
+    if (rayRMuIntersectsGround) {
+      return distanceToBottomAtmosphereBoundary(r, mu);
+    }
+    return distanceToTopAtmosphereBoundary(r, mu);
+  }
+
+  glm::vec2 getTransmittanceTextureUvFromRMu(float r, float mu) const {
+    float H    = std::sqrt(mTopRadius * mTopRadius - mBottomRadius * mBottomRadius);
+    float rho  = safeSqrt(r * r - mBottomRadius * mBottomRadius);
+    float d    = distanceToTopAtmosphereBoundary(r, mu);
+    float dMin = mTopRadius - r;
+    float dMax = rho + H;
+    float xMu  = (d - dMin) / (dMax - dMin);
+    float xR   = rho / H;
+    return glm::vec2(getTextureCoordFromUnitRange(xMu, mTransmittanceTextureWidth),
+        getTextureCoordFromUnitRange(xR, mTransmittanceTextureHeight));
+  }
+
+  void getRMuFromTransmittanceTextureUv(glm::vec2 const& uv, float& r, float& mu) const {
+    float xMu  = getUnitRangeFromTextureCoord(uv.x, mTransmittanceTextureWidth);
+    float xR   = getUnitRangeFromTextureCoord(uv.y, mTransmittanceTextureHeight);
+    float H    = std::sqrt(mTopRadius * mTopRadius - mBottomRadius * mBottomRadius);
+    float rho  = H * xR;
+    r          = std::sqrt(rho * rho + mBottomRadius * mBottomRadius);
+    float dMin = mTopRadius - r;
+    float dMax = rho + H;
+    float d    = dMin + xMu * (dMax - dMin);
+    mu         = d == 0.F ? 1.F : (H * H - rho * rho - d * d) / (2.F * r * d);
+    mu         = clampCosine(mu);
+  }
+
+  glm::vec3 getTransmittanceToTopAtmosphereBoundary(
+      Texture const& transmittanceTexture, float r, float mu) const {
+    return transmittanceTexture.sample(getTransmittanceTextureUvFromRMu(r, mu));
+  }
+
+  glm::vec3 getTransmittance(Texture const& transmittanceTexture, float r, float mu, float d,
+      bool rayRMuIntersectsGround) const {
+
+    float rD  = clampRadius(std::sqrt(d * d + 2.F * r * mu * d + r * r));
+    float muD = clampCosine((r * mu + d) / rD);
+
+    if (rayRMuIntersectsGround) {
+      return glm::min(getTransmittanceToTopAtmosphereBoundary(transmittanceTexture, rD, -muD) /
+                          getTransmittanceToTopAtmosphereBoundary(transmittanceTexture, r, -mu),
+          glm::vec3(1.F));
+    }
+
+    return glm::min(getTransmittanceToTopAtmosphereBoundary(transmittanceTexture, r, mu) /
+                        getTransmittanceToTopAtmosphereBoundary(transmittanceTexture, rD, muD),
+        glm::vec3(1.F));
+  }
+
+  glm::vec3 getTransmittanceToSun(Texture const& transmittanceTexture, float r, float muS) const {
+    float sinThetaH = mBottomRadius / r;
+    float cosThetaH = -std::sqrt(std::max(1.F - sinThetaH * sinThetaH, 0.F));
+    return getTransmittanceToTopAtmosphereBoundary(transmittanceTexture, r, muS) *
+           smoothstep(
+               -sinThetaH * mSunAngularRadius, sinThetaH * mSunAngularRadius, muS - cosThetaH);
+  }
+
+  glm::vec4 getScatteringTextureUvwzFromRMuMuSNu(
+      float r, float mu, float muS, float nu, bool rayRMuIntersectsGround) const {
+
+    float H   = std::sqrt(mTopRadius * mTopRadius - mBottomRadius * mBottomRadius);
+    float rho = safeSqrt(r * r - mBottomRadius * mBottomRadius);
+    float u_r = getTextureCoordFromUnitRange(rho / H, mScatteringTextureRSize);
+
+    float rMu          = r * mu;
+    float discriminant = rMu * rMu - r * r + mBottomRadius * mBottomRadius;
+    float uMu;
+    if (rayRMuIntersectsGround) {
+      float d    = -rMu - safeSqrt(discriminant);
+      float dMin = r - mBottomRadius;
+      float dMax = rho;
+      uMu        = 0.5F - 0.5F * getTextureCoordFromUnitRange(
+                                dMax == dMin ? 0.F : (d - dMin) / (dMax - dMin),
+                                mScatteringTextureMuSize / 2);
+    } else {
+      float d    = -rMu + safeSqrt(discriminant + H * H);
+      float dMin = mTopRadius - r;
+      float dMax = rho + H;
+      uMu        = 0.5F + 0.5F * getTextureCoordFromUnitRange(
+                                (d - dMin) / (dMax - dMin), mScatteringTextureMuSize / 2);
+    }
+
+    float d    = distanceToTopAtmosphereBoundary(mBottomRadius, muS);
+    float dMin = mTopRadius - mBottomRadius;
+    float dMax = H;
+    float a    = (d - dMin) / (dMax - dMin);
+    float D    = distanceToTopAtmosphereBoundary(mBottomRadius, mMuSMin);
+    float A    = (D - dMin) / (dMax - dMin);
+    float uMuS = getTextureCoordFromUnitRange(
+        std::max(1.F - a / A, 0.F) / (1.F + a), mScatteringTextureMuSSize);
+
+    float uNu = (nu + 1.F) / 2.F;
+    return glm::vec4(uNu, uMuS, uMu, u_r);
+  }
+
+  void getRMuMuSNuFromScatteringTextureUvwz(glm::vec4 const& uvwz, float& r, float& mu, float& muS,
+      float& nu, bool& rayRMuIntersectsGround) const {
+
+    float H   = std::sqrt(mTopRadius * mTopRadius - mBottomRadius * mBottomRadius);
+    float rho = H * getUnitRangeFromTextureCoord(uvwz.w, mScatteringTextureRSize);
+    r         = std::sqrt(rho * rho + mBottomRadius * mBottomRadius);
+
+    if (uvwz.z < 0.5F) {
+      float dMin = r - mBottomRadius;
+      float dMax = rho;
+      float d    = dMin + (dMax - dMin) * getUnitRangeFromTextureCoord(
+                                           1.F - 2.F * uvwz.z, mScatteringTextureMuSize / 2);
+      mu = d == 0.F ? -1.F : clampCosine(-(rho * rho + d * d) / (2.F * r * d));
+      rayRMuIntersectsGround = true;
+    } else {
+      float dMin = mTopRadius - r;
+      float dMax = rho + H;
+      float d    = dMin + (dMax - dMin) * getUnitRangeFromTextureCoord(
+                                           2.F * uvwz.z - 1.F, mScatteringTextureMuSize / 2);
+      mu = d == 0.F ? 1.F : clampCosine((H * H - rho * rho - d * d) / (2.F * r * d));
+      rayRMuIntersectsGround = false;
+    }
+
+    float xMuS = getUnitRangeFromTextureCoord(uvwz.y, mScatteringTextureMuSSize);
+    float dMin = mTopRadius - mBottomRadius;
+    float dMax = H;
+    float D    = distanceToTopAtmosphereBoundary(mBottomRadius, mMuSMin);
+    float A    = (D - dMin) / (dMax - dMin);
+    float a    = (A - xMuS * A) / (1.F + xMuS * A);
+    float d    = dMin + std::min(a, A) * (dMax - dMin);
+    muS        = d == 0.F ? 1.F : clampCosine((H * H - d * d) / (2.F * mBottomRadius * d));
+
+    nu = clampCosine(uvwz.x * 2.F - 1.F);
+  }
+
+  glm::vec2 getIrradianceTextureUvFromRMuS(float r, float muS) const {
+    float xR   = (r - mBottomRadius) / (mTopRadius - mBottomRadius);
+    float xMuS = muS * 0.5F + 0.5F;
+    return glm::vec2(getTextureCoordFromUnitRange(xMuS, mIrradianceTextureWidth),
+        getTextureCoordFromUnitRange(xR, mIrradianceTextureHeight));
+  }
+
+  void getRMuSFromIrradianceTextureUv(glm::vec2 const& uv, float& r, float& muS) const {
+    float xMuS = getUnitRangeFromTextureCoord(uv.x, mIrradianceTextureWidth);
+    float xR   = getUnitRangeFromTextureCoord(uv.y, mIrradianceTextureHeight);
+    r          = mBottomRadius + xR * (mTopRadius - mBottomRadius);
+    muS        = clampCosine(2.F * xMuS - 1.F);
+  }
+
+  // Refraction Computation ------------------------------------------------------------------------
+
+  float getDensity(std::vector<float> const& density, float altitude) const {
+    float u = std::clamp(altitude / (mTopRadius - mBottomRadius), 0.F, 1.F);
+    return sample(density, u);
+  }
+
+  float getRefractiveIndexMinusOne(float altitude) const {
+    return mIndexOfRefraction * getDensity(*mMolecules.mDensity, altitude);
+  }
+
+  double getRefractiveIndex(float altitude) const {
+    return 1.0 + static_cast<double>(getRefractiveIndexMinusOne(altitude));
+  }
+
+  float getIoRGradientLength(float altitude, float dh) const {
+    return (getRefractiveIndexMinusOne(altitude + dh) - getRefractiveIndexMinusOne(altitude)) / dh;
+  }
+
+  // This corresponds to refractRaySeron() which is the variant used by the GLSL code.
+  glm::dvec2 refractRay(glm::dvec2 const& origin, glm::dvec2 const& dir, double dx) const {
+    float altitude = std::max(0.F, static_cast<float>(glm::length(origin) - mBottomRadius));
+    double     refractiveIndex = getRefractiveIndex(altitude);
+    double     gradientLength  = getIoRGradientLength(altitude, 10.F);
+    glm::dvec2 dn              = glm::normalize(origin) * gradientLength;
+    return glm::normalize(refractiveIndex * dir + dn * dx);
+  }
+
+  // This corresponds to rayStepRK4() which is the variant used by the GLSL code.
+  void rayStep(glm::dvec2& origin, glm::dvec2& dir, double dx) const {
+    glm::dvec2 k1 = refractRay(origin, dir, dx);
+    glm::dvec2 k2 = refractRay(origin + k1 * dx / 2.0, dir, dx);
+    glm::dvec2 k3 = refractRay(origin + k2 * dx / 2.0, dir, dx);
+    glm::dvec2 k4 = refractRay(origin + k3 * dx, dir, dx);
+    dir           = (k1 + 2.0 * k2 + 2.0 * k3 + k4) / 6.0;
+    origin += dir * dx;
+  }
+
+  // Transmittance Computation ---------------------------------------------------------------------
+
+  RayInfo computeOpticalLengthToTopAtmosphereBoundary(
+      std::vector<float> const& density, float r, float mu) const {
+
+    RayInfo result;
+
+    if (!mRefraction) {
+      float dx = distanceToTopAtmosphereBoundary(r, mu) /
+                 static_cast<float>(mSampleCountOpticalDepth);
+
+      for (int i = 0; i <= mSampleCountOpticalDepth; ++i) {
+        float d_i      = static_cast<float>(i) * dx;
+        float r_i      = std::sqrt(d_i * d_i + 2.F * r * mu * d_i + r * r);
+        float y_i      = getDensity(density, r_i - mBottomRadius);
+        float weight_i = i == 0 || i == mSampleCountOpticalDepth ? 0.5F : 1.F;
+        result.mOpticalDepth += y_i * weight_i * dx;
+      }
+
+      return result;
+    }
+
+    glm::dvec2 startRayDir(std::sqrt(1.F - mu * mu), mu);
+
+    result.mContactRadius = r - mBottomRadius;
+
+    glm::dvec2 currentDir(std::sqrt(1.F - mu * mu), mu);
+    glm::dvec2 samplePos(0.0, r);
+    bool       leftAtmosphere = false;
+    double     weight         = 0.5;
+    float      dx             = static_cast<float>(mStepSizeOpticalDepth);
+
+    while (!leftAtmosphere) {
+      double sampleRadius = glm::length(samplePos);
+
+      glm::dvec2 segmentStart  = samplePos - currentDir * static_cast<double>(dx) * 0.5;
+      double     segmentStartR = glm::length(segmentStart);
+      glm::dvec2 segmentEnd    = samplePos + currentDir * static_cast<double>(dx) * 0.5;
+      double     segmentEndR   = glm::length(segmentEnd);
+
+      if (segmentEndR > mTopRadius) {
+        weight         = 1.0 - (segmentEndR - mTopRadius) / (segmentEndR - segmentStartR);
+        leftAtmosphere = true;
+      }
+
+      float altitude = static_cast<float>(sampleRadius) - mBottomRadius;
+      result.mOpticalDepth += getDensity(density, altitude) * static_cast<float>(weight);
+      result.mContactRadius = std::min(result.mContactRadius, altitude);
+
+      rayStep(samplePos, currentDir, dx);
+      weight = 1.0;
+    }
+
+    result.mThetaDeviation = angleBetweenVectors(glm::vec2(startRayDir), glm::vec2(currentDir));
+    result.mOpticalDepth *= dx;
+
+    return result;
+  }
+
+  glm::vec3 computeTransmittanceToTopAtmosphereBoundaryTexture(
+      glm::vec2 const& fragCoord, float& thetaDeviation, float& contactRadius) const {
+
+    float r;
+    float mu;
+    getRMuFromTransmittanceTextureUv(
+        fragCoord / glm::vec2(mTransmittanceTextureWidth, mTransmittanceTextureHeight), r, mu);
+
+    RayInfo molecules = computeOpticalLengthToTopAtmosphereBoundary(*mMolecules.mDensity, r, mu);
+    RayInfo aerosols  = computeOpticalLengthToTopAtmosphereBoundary(*mAerosols.mDensity, r, mu);
+    RayInfo ozone     = computeOpticalLengthToTopAtmosphereBoundary(*mOzone.mDensity, r, mu);
+
+    glm::vec3 transmittance = glm::exp(-(mMolecules.mExtinction * molecules.mOpticalDepth +
+                                         mAerosols.mExtinction * aerosols.mOpticalDepth +
+                                         mOzone.mExtinction * ozone.mOpticalDepth));
+
+    thetaDeviation = molecules.mThetaDeviation;
+    contactRadius  = molecules.mContactRadius;
+
+    return transmittance;
+  }
+
+  // Single-Scattering Computation -----------------------------------------------------------------
+
+  glm::vec3 getOpticalDepth(float r) const {
+    float altitude         = r - mBottomRadius;
+    float moleculesDensity = getDensity(*mMolecules.mDensity, altitude);
+    float aerosolsDensity  = getDensity(*mAerosols.mDensity, altitude);
+    float ozoneDensity     = getDensity(*mOzone.mDensity, altitude);
+
+    return mMolecules.mExtinction * moleculesDensity + mAerosols.mExtinction * aerosolsDensity +
+           mOzone.mExtinction * ozoneDensity;
+  }
+
+  glm::vec3 getSunDirection(float mu, float muS, float nu) const {
+    float rayDirX = safeSqrt(1.F - mu * mu);
+    float rayDirY = mu;
+
+    float sunDirX = (nu - rayDirY * muS) / (rayDirX + 1e-20F);
+    float sunDirY = muS;
+    float sunDirZ = safeSqrt(1.F - sunDirX * sunDirX - sunDirY * sunDirY);
+
+    return glm::vec3(sunDirX, sunDirY, sunDirZ);
+  }
+
+  void computeSingleScatteringIntegrand(Texture const& transmittanceTexture, float r, float mu,
+      float muS, float nu, float d, bool rayRMuIntersectsGround, glm::vec3& molecules,
+      glm::vec3& aerosols) const {
+    float     rD            = clampRadius(std::sqrt(d * d + 2.F * r * mu * d + r * r));
+    float     muSD          = clampCosine((r * muS + d * nu) / rD);
+    glm::vec3 transmittance = getTransmittance(transmittanceTexture, r, mu, d,
+                                  rayRMuIntersectsGround) *
+                              getTransmittanceToSun(transmittanceTexture, rD, muSD);
+    molecules = transmittance * getDensity(*mMolecules.mDensity, rD - mBottomRadius);
+    aerosols  = transmittance * getDensity(*mAerosols.mDensity, rD - mBottomRadius);
+  }
+
+  void computeSingleScattering(Texture const& transmittanceTexture, float r, float mu, float muS,
+      float nu, bool rayRMuIntersectsGround, glm::vec3& molecules, glm::vec3& aerosols) const {
+
+    if (!mRefraction) {
+      float dx = distanceToNearestAtmosphereBoundary(r, mu, rayRMuIntersectsGround) /
+                 static_cast<float>(mSampleCountSingleScattering);
+
+      glm::vec3 moleculesSum(0.F);
+      glm::vec3 aerosolsSum(0.F);
+      for (int i = 0; i <= mSampleCountSingleScattering; ++i) {
+        float     d_i = static_cast<float>(i) * dx;
+        glm::vec3 molecules_i;
+        glm::vec3 aerosols_i;
+        computeSingleScatteringIntegrand(transmittanceTexture, r, mu, muS, nu, d_i,
+            rayRMuIntersectsGround, molecules_i, aerosols_i);
+        float weight_i = (i == 0 || i == mSampleCountSingleScattering) ? 0.5F : 1.F;
+        moleculesSum += molecules_i * weight_i;
+        aerosolsSum += aerosols_i * weight_i;
+      }
+      molecules = moleculesSum * dx * mSolarIrradiance * mMolecules.mScattering;
+      aerosols  = aerosolsSum * dx * mSolarIrradiance * mAerosols.mScattering;
+      return;
+    }
+
+    glm::dvec2 currentDir(std::sqrt(1.F - mu * mu), mu);
+    glm::vec3  sunDir = getSunDirection(mu, muS, nu);
+
+    glm::vec3  moleculesSum(0.F);
+    glm::vec3  aerosolsSum(0.F);
+    glm::dvec3 opticalDepthRay(0.0);
+
+    glm::dvec2 samplePos(0.0, r);
+    bool       hitGroundOrLeftAtmosphere = false;
+    double     weight                    = 0.5;
+    float      dx = static_cast<float>(mStepSizeSingleScattering);
+
+    while (!hitGroundOrLeftAtmosphere) {
+      double sampleRadius = glm::length(samplePos);
+
+      glm::dvec2 segmentStart  = samplePos - currentDir * static_cast<double>(dx) * 0.5;
+      double     segmentStartR = glm::length(segmentStart);
+      glm::dvec2 segmentEnd    = samplePos + currentDir * static_cast<double>(dx) * 0.5;
+      double     segmentEndR   = glm::length(segmentEnd);
+
+      if (segmentEndR < mBottomRadius) {
+        weight = 1.0 - (mBottomRadius - segmentEndR) / (segmentStartR - segmentEndR);
+        hitGroundOrLeftAtmosphere = true;
+      }
+
+      if (segmentEndR > mTopRadius) {
+        weight = 1.0 - (segmentEndR - mTopRadius) / (segmentEndR - segmentStartR);
+        hitGroundOrLeftAtmosphere = true;
+      }
+
+      float radius = static_cast<float>(sampleRadius);
+      float muSD   = clampCosine(glm::dot(sunDir, glm::vec3(glm::vec2(samplePos), 0.F)) / radius);
+
+      glm::vec3 transmittanceSun = getTransmittanceToSun(transmittanceTexture, radius, muSD);
+      opticalDepthRay += glm::dvec3(getOpticalDepth(radius) * dx) * weight;
+      glm::vec3 transmittanceRay = glm::exp(-glm::vec3(opticalDepthRay));
+
+      float altitude         = radius - mBottomRadius;
+      float moleculesDensity = getDensity(*mMolecules.mDensity, altitude);
+      float aerosolsDensity  = getDensity(*mAerosols.mDensity, altitude);
+      moleculesSum += transmittanceSun * transmittanceRay * moleculesDensity *
+                      static_cast<float>(weight);
+      aerosolsSum += transmittanceSun * transmittanceRay * aerosolsDensity *
+                     static_cast<float>(weight);
+
+      rayStep(samplePos, currentDir, dx);
+      weight = 1.0;
+    }
+
+    molecules = moleculesSum * mSolarIrradiance * mMolecules.mScattering * dx;
+    aerosols  = aerosolsSum * mSolarIrradiance * mAerosols.mScattering * dx;
+  }
+
+  glm::vec3 phaseFunction(ScatteringComponent const& component, float nu) const {
+    float theta = std::acos(nu) / glm::pi<float>(); // 0<->1
+    return sample(component.mPhase, theta);
+  }
+
+  // Single-Scattering Texture Precomputation ------------------------------------------------------
+
+  void getRMuMuSNuFromScatteringTextureFragCoord(glm::vec3 const& fragCoord, float& r, float& mu,
+      float& muS, float& nu, bool& rayRMuIntersectsGround) const {
+    glm::vec4 scatteringTextureSize(mScatteringTextureNuSize - 1, mScatteringTextureMuSSize,
+        mScatteringTextureMuSize, mScatteringTextureRSize);
+    float muSSize      = static_cast<float>(mScatteringTextureMuSSize);
+    float fragCoordNu  = std::floor(fragCoord.x / muSSize);
+    float fragCoordMuS = fragCoord.x - muSSize * std::floor(fragCoord.x / muSSize);
+    glm::vec4 uvwz =
+        glm::vec4(fragCoordNu, fragCoordMuS, fragCoord.y, fragCoord.z) / scatteringTextureSize;
+    getRMuMuSNuFromScatteringTextureUvwz(uvwz, r, mu, muS, nu, rayRMuIntersectsGround);
+    nu = std::clamp(nu, mu * muS - std::sqrt((1.F - mu * mu) * (1.F - muS * muS)),
+        mu * muS + std::sqrt((1.F - mu * mu) * (1.F - muS * muS)));
+  }
+
+  void computeSingleScatteringTexture(Texture const& transmittanceTexture,
+      glm::vec3 const& fragCoord, glm::vec3& molecules, glm::vec3& aerosols) const {
+    float r;
+    float mu;
+    float muS;
+    float nu;
+    bool  rayRMuIntersectsGround;
+    getRMuMuSNuFromScatteringTextureFragCoord(fragCoord, r, mu, muS, nu, rayRMuIntersectsGround);
+    computeSingleScattering(
+        transmittanceTexture, r, mu, muS, nu, rayRMuIntersectsGround, molecules, aerosols);
+  }
+
+  // Single-Scattering Texture Lookup --------------------------------------------------------------
+
+  glm::vec3 getScattering(Texture const& scatteringTexture, float r, float mu, float muS, float nu,
+      bool rayRMuIntersectsGround) const {
+    glm::vec4 uvwz = getScatteringTextureUvwzFromRMuMuSNu(r, mu, muS, nu, rayRMuIntersectsGround);
+    float     nuSize    = static_cast<float>(mScatteringTextureNuSize);
+    float     texCoordX = uvwz.x * (nuSize - 1.F);
+    float     texX      = std::floor(texCoordX);
+    float     lerp      = texCoordX - texX;
+    glm::vec3 uvw0((texX + uvwz.y) / nuSize, uvwz.z, uvwz.w);
+    glm::vec3 uvw1((texX + 1.F + uvwz.y) / nuSize, uvwz.z, uvwz.w);
+    return scatteringTexture.sample(uvw0) * (1.F - lerp) + scatteringTexture.sample(uvw1) * lerp;
+  }
+
+  glm::vec3 getScattering(Texture const& singleMoleculesScatteringTexture,
+      Texture const& singleAerosolsScatteringTexture, Texture const& multipleScatteringTexture,
+      float r, float mu, float muS, float nu, bool rayRMuIntersectsGround,
+      int scatteringOrder) const {
+    if (scatteringOrder == 1) {
+      glm::vec3 molecules =
+          getScattering(singleMoleculesScatteringTexture, r, mu, muS, nu, rayRMuIntersectsGround);
+      glm::vec3 aerosols =
+          getScattering(singleAerosolsScatteringTexture, r, mu, muS, nu, rayRMuIntersectsGround);
+      return molecules * phaseFunction(mMolecules, nu) + aerosols * phaseFunction(mAerosols, nu);
+    }
+    return getScattering(multipleScatteringTexture, r, mu, muS, nu, rayRMuIntersectsGround);
+  }
+
+  // Multiple-Scattering Computation ---------------------------------------------------------------
+
+  glm::vec3 computeScatteringDensity(Texture const& transmittanceTexture,
+      Texture const& singleMoleculesScatteringTexture,
+      Texture const& singleAerosolsScatteringTexture, Texture const& multipleScatteringTexture,
+      Texture const& irradianceTexture, float r, float mu, float muS, float nu,
+      int scatteringOrder) const {
+
+    glm::vec3 zenithDirection(0.F, 0.F, 1.F);
+    glm::vec3 omega(std::sqrt(1.F - mu * mu), 0.F, mu);
+    float     sunDirX = omega.x == 0.F ? 0.F : (nu - mu * muS) / omega.x;
+    float     sunDirY = std::sqrt(std::max(1.F - sunDirX * sunDirX - muS * muS, 0.F));
+    glm::vec3 omegaS(sunDirX, sunDirY, muS);
+
+    const float dPhi   = glm::pi<float>() / static_cast<float>(mSampleCountScatteringDensity);
+    const float dTheta = glm::pi<float>() / static_cast<float>(mSampleCountScatteringDensity);
+    glm::vec3   moleculesAerosols(0.F);
+
+    // The density does not depend on the direction, so we can compute it once.
+    float moleculesDensity = getDensity(*mMolecules.mDensity, r - mBottomRadius);
+    float aerosolsDensity  = getDensity(*mAerosols.mDensity, r - mBottomRadius);
+
+    for (int l = 0; l < mSampleCountScatteringDensity; ++l) {
+      float theta                     = (static_cast<float>(l) + 0.5F) * dTheta;
+      float cosTheta                  = std::cos(theta);
+      float sinTheta                  = std::sin(theta);
+      bool  rayRThetaIntersectsGround = rayIntersectsGround(r, cosTheta);
+
+      float     distanceToGround = 0.F;
+      glm::vec3 transmittanceToGround(0.F);
+      glm::vec3 groundAlbedo(0.F);
+      if (rayRThetaIntersectsGround) {
+        distanceToGround      = distanceToBottomAtmosphereBoundary(r, cosTheta);
+        transmittanceToGround = getTransmittance(
+            transmittanceTexture, r, cosTheta, distanceToGround, true /* ray_intersects_ground */);
+        groundAlbedo = mGroundAlbedo;
+      }
+
+      for (int m = 0; m < 2 * mSampleCountScatteringDensity; ++m) {
+        float     phi = (static_cast<float>(m) + 0.5F) * dPhi;
+        glm::vec3 omega_i(std::cos(phi) * sinTheta, std::sin(phi) * sinTheta, cosTheta);
+        float     domega_i = dTheta * dPhi * std::sin(theta);
+
+        float     nu1              = glm::dot(omegaS, omega_i);
+        glm::vec3 incidentRadiance = getScattering(singleMoleculesScatteringTexture,
+            singleAerosolsScatteringTexture, multipleScatteringTexture, r, omega_i.z, muS, nu1,
+            rayRThetaIntersectsGround, scatteringOrder - 1);
+
+        glm::vec3 groundNormal = glm::normalize(zenithDirection * r + omega_i * distanceToGround);
+        glm::vec3 groundIrradiance =
+            getIrradiance(irradianceTexture, mBottomRadius, glm::dot(groundNormal, omegaS));
+        incidentRadiance +=
+            transmittanceToGround * groundAlbedo * (1.F / glm::pi<float>()) * groundIrradiance;
+
+        float nu2 = glm::dot(omega, omega_i);
+        moleculesAerosols +=
+            incidentRadiance *
+            (mMolecules.mScattering * moleculesDensity * phaseFunction(mMolecules, nu2) +
+                mAerosols.mScattering * aerosolsDensity * phaseFunction(mAerosols, nu2)) *
+            domega_i;
+      }
+    }
+    return moleculesAerosols;
+  }
+
+  glm::vec3 computeMultipleScattering(Texture const& transmittanceTexture,
+      Texture const& scatteringDensityTexture, float r, float mu, float muS, float nu,
+      bool rayRMuIntersectsGround) const {
+
+    if (!mRefraction) {
+      float dx = distanceToNearestAtmosphereBoundary(r, mu, rayRMuIntersectsGround) /
+                 static_cast<float>(mSampleCountMultiScattering);
+
+      glm::vec3 moleculesAerosolsSum(0.F);
+      for (int i = 0; i <= mSampleCountMultiScattering; ++i) {
+        float d_i = static_cast<float>(i) * dx;
+
+        float r_i   = clampRadius(std::sqrt(d_i * d_i + 2.F * r * mu * d_i + r * r));
+        float mu_i  = clampCosine((r * mu + d_i) / r_i);
+        float muS_i = clampCosine((r * muS + d_i * nu) / r_i);
+
+        glm::vec3 moleculesAerosols_i =
+            getScattering(scatteringDensityTexture, r_i, mu_i, muS_i, nu, rayRMuIntersectsGround) *
+            getTransmittance(transmittanceTexture, r, mu, d_i, rayRMuIntersectsGround) * dx;
+        float weight_i = (i == 0 || i == mSampleCountMultiScattering) ? 0.5F : 1.F;
+        moleculesAerosolsSum += moleculesAerosols_i * weight_i;
+      }
+      return moleculesAerosolsSum;
+    }
+
+    glm::dvec2 currentDir(std::sqrt(1.F - mu * mu), mu);
+    glm::vec3  sunDir = getSunDirection(mu, muS, nu);
+
+    glm::vec3  moleculesAerosolsSum(0.F);
+    glm::dvec3 opticalDepthRay(0.0);
+
+    glm::dvec2 samplePos(0.0, r);
+    bool       hitGroundOrLeftAtmosphere = false;
+    double     weight                    = 0.5;
+    float      dx = static_cast<float>(mStepSizeMultiScattering);
+
+    while (!hitGroundOrLeftAtmosphere) {
+      double sampleRadius = glm::length(samplePos);
+
+      glm::dvec2 segmentStart  = samplePos - currentDir * static_cast<double>(dx) * 0.5;
+      double     segmentStartR = glm::length(segmentStart);
+      glm::dvec2 segmentEnd    = samplePos + currentDir * static_cast<double>(dx) * 0.5;
+      double     segmentEndR   = glm::length(segmentEnd);
+
+      if (segmentEndR < mBottomRadius) {
+        weight = 1.0 - (mBottomRadius - segmentEndR) / (segmentStartR - segmentEndR);
+        hitGroundOrLeftAtmosphere = true;
+      }
+
+      if (segmentEndR > mTopRadius) {
+        weight = 1.0 - (segmentEndR - mTopRadius) / (segmentEndR - segmentStartR);
+        hitGroundOrLeftAtmosphere = true;
+      }
+
+      glm::dvec3 sunDirD(sunDir);
+      float      currentMu = static_cast<float>(
+          clampCosine(glm::dot(samplePos / sampleRadius, currentDir)));
+      float currentMuS = static_cast<float>(
+          clampCosine(glm::dot(glm::dvec3(samplePos, 0.0) / sampleRadius, sunDirD)));
+      float currentNu =
+          static_cast<float>(clampCosine(glm::dot(glm::dvec3(currentDir, 0.0), sunDirD)));
+
+      float radius = static_cast<float>(sampleRadius);
+      opticalDepthRay += glm::dvec3(getOpticalDepth(radius) * dx) * weight;
+      glm::vec3 transmittanceRay = glm::exp(-glm::vec3(opticalDepthRay)) * dx;
+
+      moleculesAerosolsSum += getScattering(scatteringDensityTexture, radius, currentMu,
+                                  currentMuS, currentNu, rayRMuIntersectsGround) *
+                              transmittanceRay * static_cast<float>(weight);
+
+      rayStep(samplePos, currentDir, dx);
+      weight = 1.0;
+    }
+
+    return moleculesAerosolsSum;
+  }
+
+  // Multiple-Scattering Texture Precomputation ----------------------------------------------------
+
+  glm::vec3 computeScatteringDensityTexture(Texture const& transmittanceTexture,
+      Texture const& singleMoleculesScatteringTexture,
+      Texture const& singleAerosolsScatteringTexture, Texture const& multipleScatteringTexture,
+      Texture const& irradianceTexture, glm::vec3 const& fragCoord, int scatteringOrder) const {
+    float r;
+    float mu;
+    float muS;
+    float nu;
+    bool  rayRMuIntersectsGround;
+    getRMuMuSNuFromScatteringTextureFragCoord(fragCoord, r, mu, muS, nu, rayRMuIntersectsGround);
+    return computeScatteringDensity(transmittanceTexture, singleMoleculesScatteringTexture,
+        singleAerosolsScatteringTexture, multipleScatteringTexture, irradianceTexture, r, mu, muS,
+        nu, scatteringOrder);
+  }
+
+  glm::vec3 computeMultipleScatteringTexture(Texture const& transmittanceTexture,
+      Texture const& scatteringDensityTexture, glm::vec3 const& fragCoord, float& nu) const {
+    float r;
+    float mu;
+    float muS;
+    bool  rayRMuIntersectsGround;
+    getRMuMuSNuFromScatteringTextureFragCoord(fragCoord, r, mu, muS, nu, rayRMuIntersectsGround);
+    return computeMultipleScattering(
+        transmittanceTexture, scatteringDensityTexture, r, mu, muS, nu, rayRMuIntersectsGround);
+  }
+
+  // Compute Irradiance ----------------------------------------------------------------------------
+
+  glm::vec3 computeDirectIrradiance(Texture const& transmittanceTexture, float r, float muS) const {
+    float alphaS              = mSunAngularRadius;
+    float averageCosineFactor = muS < -alphaS
+                                    ? 0.F
+                                    : (muS > alphaS ? muS : (muS + alphaS) * (muS + alphaS) /
+                                                                (4.F * alphaS));
+
+    return mSolarIrradiance *
+           getTransmittanceToTopAtmosphereBoundary(transmittanceTexture, r, muS) *
+           averageCosineFactor;
+  }
+
+  glm::vec3 computeIndirectIrradiance(Texture const& singleMoleculesScatteringTexture,
+      Texture const& singleAerosolsScatteringTexture, Texture const& multipleScatteringTexture,
+      float r, float muS, int scatteringOrder) const {
+
+    const float dPhi   = glm::pi<float>() / static_cast<float>(mSampleCountIndirectIrradiance);
+    const float dTheta = glm::pi<float>() / static_cast<float>(mSampleCountIndirectIrradiance);
+
+    glm::vec3 result(0.F);
+    glm::vec3 omegaS(std::sqrt(1.F - muS * muS), 0.F, muS);
+    for (int j = 0; j < mSampleCountIndirectIrradiance / 2; ++j) {
+      float theta = (static_cast<float>(j) + 0.5F) * dTheta;
+      for (int i = 0; i < 2 * mSampleCountIndirectIrradiance; ++i) {
+        float     phi = (static_cast<float>(i) + 0.5F) * dPhi;
+        glm::vec3 omega(
+            std::cos(phi) * std::sin(theta), std::sin(phi) * std::sin(theta), std::cos(theta));
+        float domega = dTheta * dPhi * std::sin(theta);
+
+        float nu = glm::dot(omega, omegaS);
+        result += getScattering(singleMoleculesScatteringTexture, singleAerosolsScatteringTexture,
+                      multipleScatteringTexture, r, omega.z, muS, nu,
+                      false /* rayRThetaIntersectsGround */, scatteringOrder) *
+                  omega.z * domega;
+      }
+    }
+    return result;
+  }
+
+  // Irradiance-Texture Precomputation -------------------------------------------------------------
+
+  glm::vec3 computeDirectIrradianceTexture(
+      Texture const& transmittanceTexture, glm::vec2 const& fragCoord) const {
+    float r;
+    float muS;
+    getRMuSFromIrradianceTextureUv(
+        fragCoord / glm::vec2(mIrradianceTextureWidth, mIrradianceTextureHeight), r, muS);
+    return computeDirectIrradiance(transmittanceTexture, r, muS);
+  }
+
+  glm::vec3 computeIndirectIrradianceTexture(Texture const& singleMoleculesScatteringTexture,
+      Texture const& singleAerosolsScatteringTexture, Texture const& multipleScatteringTexture,
+      glm::vec2 const& fragCoord, int scatteringOrder) const {
+    float r;
+    float muS;
+    getRMuSFromIrradianceTextureUv(
+        fragCoord / glm::vec2(mIrradianceTextureWidth, mIrradianceTextureHeight), r, muS);
+    return computeIndirectIrradiance(singleMoleculesScatteringTexture,
+        singleAerosolsScatteringTexture, multipleScatteringTexture, r, muS, scatteringOrder);
+  }
+
+  // Irradiance-Texture Lookup ---------------------------------------------------------------------
+
+  glm::vec3 getIrradiance(Texture const& irradianceTexture, float r, float muS) const {
+    return irradianceTexture.sample(getIrradianceTextureUvFromRMuS(r, muS));
+  }
+
+  // Atmosphere Parameters -------------------------------------------------------------------------
+
+  ScatteringComponent mMolecules;
+  ScatteringComponent mAerosols;
+  AbsorbingComponent  mOzone;
+
+ private:
+  bool      mRefraction;
+  int32_t   mTransmittanceTextureWidth;
+  int32_t   mTransmittanceTextureHeight;
+  int32_t   mScatteringTextureRSize;
+  int32_t   mScatteringTextureMuSize;
+  int32_t   mScatteringTextureMuSSize;
+  int32_t   mScatteringTextureNuSize;
+  int32_t   mIrradianceTextureWidth;
+  int32_t   mIrradianceTextureHeight;
+  int32_t   mSampleCountOpticalDepth;
+  int32_t   mStepSizeOpticalDepth;
+  int32_t   mSampleCountSingleScattering;
+  int32_t   mStepSizeSingleScattering;
+  int32_t   mSampleCountScatteringDensity;
+  int32_t   mSampleCountMultiScattering;
+  int32_t   mStepSizeMultiScattering;
+  int32_t   mSampleCountIndirectIrradiance;
+  glm::vec3 mSolarIrradiance;
+  glm::vec3 mGroundAlbedo;
+  float     mIndexOfRefraction;
+  float     mSunAngularRadius;
+  float     mBottomRadius;
+  float     mTopRadius;
+  float     mMuSMin;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// This emulates the additive blending used by the Preprocessor to accumulate the results of
+// several precomputation steps.
+void accumulate(glm::vec3& target, glm::vec3 const& value, bool blend) {
+  if (blend) {
+    target += value;
+  } else {
+    target = value;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // anonymous namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+CpuPreprocessor::Texture::Texture(int32_t width, int32_t height, int32_t depth)
+    : mWidth(width)
+    , mHeight(height)
+    , mDepth(depth)
+    , mData(static_cast<size_t>(width) * height * depth, glm::vec3(0.F)) {
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+glm::vec3& CpuPreprocessor::Texture::at(int32_t x, int32_t y, int32_t z) {
+  return mData[(static_cast<size_t>(z) * mHeight + y) * mWidth + x];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+glm::vec3 const& CpuPreprocessor::Texture::at(int32_t x, int32_t y, int32_t z) const {
+  return mData[(static_cast<size_t>(z) * mHeight + y) * mWidth + x];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+glm::vec3 CpuPreprocessor::Texture::sample(glm::vec2 const& uv) const {
+  return sample(glm::vec3(uv, 0.5F));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+glm::vec3 CpuPreprocessor::Texture::sample(glm::vec3 const& uvw) const {
+  glm::ivec3 size(mWidth, mHeight, mDepth);
+  glm::vec3  coords = uvw * glm::vec3(size) - 0.5F;
+  glm::vec3  floor  = glm::floor(coords);
+  glm::vec3  t      = coords - floor;
+  glm::ivec3 i0     = glm::clamp(glm::ivec3(floor), glm::ivec3(0), size - 1);
+  glm::ivec3 i1     = glm::clamp(glm::ivec3(floor) + 1, glm::ivec3(0), size - 1);
+
+  auto sampleLayer = [&](int32_t z) {
+    return glm::mix(glm::mix(at(i0.x, i0.y, z), at(i1.x, i0.y, z), t.x),
+        glm::mix(at(i0.x, i1.y, z), at(i1.x, i1.y, z), t.x), t.y);
+  };
+
+  return glm::mix(sampleLayer(i0.z), sampleLayer(i1.z), t.z);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+CpuPreprocessor::CpuPreprocessor(Params params, uint32_t threads)
+    : mParams(std::move(params))
+    , mScatteringTextureWidth(
+          mParams.mScatteringTextureNuSize.get() * mParams.mScatteringTextureMuSSize.get())
+    , mScatteringTextureHeight(mParams.mScatteringTextureMuSize.get())
+    , mScatteringTextureDepth(mParams.mScatteringTextureRSize.get())
+    , mMetadata(common::createMetadata(mParams))
+    , mThreadPool(threads > 0 ? threads : std::max(1U, std::thread::hardware_concurrency()))
+    , mMultipleScatteringTexture(
+          mScatteringTextureWidth, mScatteringTextureHeight, mScatteringTextureDepth)
+    , mSingleAerosolsScatteringTexture(
+          mScatteringTextureWidth, mScatteringTextureHeight, mScatteringTextureDepth)
+    , mTransmittanceTexture(
+          mParams.mTransmittanceTextureWidth.get(), mParams.mTransmittanceTextureHeight.get())
+    , mThetaDeviationTexture(
+          mParams.mTransmittanceTextureWidth.get(), mParams.mTransmittanceTextureHeight.get())
+    , mIrradianceTexture(
+          mParams.mIrradianceTextureWidth.get(), mParams.mIrradianceTextureHeight.get()) {
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t CpuPreprocessor::getThreadCount() const {
+  return mThreadPool.getThreadCount();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The control flow is the same as in Preprocessor::run().
+
+void CpuPreprocessor::run(unsigned int numScatteringOrders) {
+  Texture deltaIrradianceTexture(
+      mParams.mIrradianceTextureWidth.get(), mParams.mIrradianceTextureHeight.get());
+  Texture deltaMoleculesScatteringTexture(
+      mScatteringTextureWidth, mScatteringTextureHeight, mScatteringTextureDepth);
+  Texture deltaAerosolsScatteringTexture(
+      mScatteringTextureWidth, mScatteringTextureHeight, mScatteringTextureDepth);
+  Texture deltaScatteringDensityTexture(
+      mScatteringTextureWidth, mScatteringTextureHeight, mScatteringTextureDepth);
+
+  // As in the Preprocessor, we can store deltaMoleculesScatteringTexture and
+  // deltaMultipleScatteringTexture in the same texture to save memory.
+  Texture& deltaMultipleScatteringTexture = deltaMoleculesScatteringTexture;
+
+  if (mParams.mWavelengths.size() <= 3) {
+    std::cout << "Precomputing atmospheric scattering (1/1)..." << std::endl;
+    glm::vec3 lambdas{common::kLambdaR, common::kLambdaG, common::kLambdaB};
+
+    precompute(deltaIrradianceTexture, deltaMoleculesScatteringTexture,
+        deltaAerosolsScatteringTexture, deltaScatteringDensityTexture,
+        deltaMultipleScatteringTexture, lambdas,
+        common::getLuminanceFromRadiance(mParams.mWavelengths, lambdas), false /* blend */,
+        numScatteringOrders);
+  } else {
+    int numIterations = static_cast<int>(mParams.mWavelengths.size()) / 3;
+    for (int i = 0; i < numIterations; ++i) {
+      std::cout << "Precomputing atmospheric scattering (" << i + 1 << "/" << numIterations
+                << ")..." << std::endl;
+
+      glm::vec3 lambdas{mParams.mWavelengths[i * 3 + 0], mParams.mWavelengths[i * 3 + 1],
+          mParams.mWavelengths[i * 3 + 2]};
+
+      precompute(deltaIrradianceTexture, deltaMoleculesScatteringTexture,
+          deltaAerosolsScatteringTexture, deltaScatteringDensityTexture,
+          deltaMultipleScatteringTexture, lambdas,
+          common::getLuminanceFromRadiance(mParams.mWavelengths, lambdas), i > 0 /* blend */,
+          numScatteringOrders);
+    }
+
+    std::cout << "Finishing precomputation..." << std::endl;
+
+    // The transmittance, the theta deviation and the phase functions have to be recomputed for
+    // kLambdaR, kLambdaG, kLambdaB.
+    glm::vec3 lambdas{common::kLambdaR, common::kLambdaG, common::kLambdaB};
+    mPhaseData = common::getPhaseFunctionData(
+        {mParams.mMolecules, mParams.mAerosols}, mParams.mWavelengths, lambdas);
+    computeTransmittance(lambdas);
+  }
+
+  std::cout << "Precomputation Done." << std::endl;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// This writes the same files as Preprocessor::save().
+
+void CpuPreprocessor::save(std::string const& directory) {
+  std::cout << "Saving precomputed atmosphere to disk..." << std::endl;
+
+  auto write2D = [](std::string const& path, Texture const& texture) {
+    common::writeTexture2D(path, &texture.mData[0].x, texture.mWidth, texture.mHeight);
+  };
+
+  auto write3D = [](std::string const& path, Texture const& texture) {
+    common::writeTexture3D(
+        path, &texture.mData[0].x, texture.mWidth, texture.mHeight, texture.mDepth);
+  };
+
+  // For debugging purposes, we print the maximum ray deviation in degrees.
+  float maxThetaDeviation = common::getMaxThetaDeviation(&mThetaDeviationTexture.mData[0].x,
+      mThetaDeviationTexture.mWidth, mThetaDeviationTexture.mHeight);
+
+  std::cout << "Maximum ray deviation: " << maxThetaDeviation * 180.F / glm::pi<float>()
+            << " degrees." << std::endl;
+
+  int numAngles = static_cast<int>(mParams.mMolecules.mPhase.size());
+  common::writeTexture2D(directory + "/phase.tif", mPhaseData.data(), numAngles, 2);
+  write2D(directory + "/transmittance.tif", mTransmittanceTexture);
+  write2D(directory + "/indirect_illuminance.tif", mIrradianceTexture);
+  write3D(directory + "/multiple_scattering.tif", mMultipleScatteringTexture);
+  write3D(directory + "/single_aerosols_scattering.tif", mSingleAerosolsScatteringTexture);
+
+  if (mParams.mRefraction.get()) {
+    write2D(directory + "/theta_deviation.tif", mThetaDeviationTexture);
+  }
+
+  common::writeMetadata(directory, mMetadata);
+
+  std::cout << "Precomputed atmosphere saved to disk." << std::endl;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The steps are the same as in Preprocessor::precompute(). Please refer to the extensive comment
+// above that method for an outline of the data flow. Each step is parallelized over the texels of
+// its output texture. In addition, steps which do not depend on each other are executed
+// concurrently: the direct irradiance (2.) and the single scattering (3.) only require the
+// transmittance. In the loop, the indirect irradiance of the previous scattering order (4.2.) is
+// computed together with the scattering density of the current order (4.1.). For this, the new
+// delta irradiance is written to a separate texture which is swapped in afterwards.
+
+void CpuPreprocessor::precompute(Texture& deltaIrradianceTexture,
+    Texture& deltaMoleculesScatteringTexture, Texture& deltaAerosolsScatteringTexture,
+    Texture& deltaScatteringDensityTexture, Texture& deltaMultipleScatteringTexture,
+    glm::vec3 const& lambdas, glm::mat3 const& luminanceFromRadiance, bool blend,
+    unsigned int numScatteringOrders) {
+
+  // The matrix is meant to be uploaded to the GPU with transposition enabled.
+  glm::mat3 luminance = glm::transpose(luminanceFromRadiance);
+
+  mPhaseData = common::getPhaseFunctionData(
+      {mParams.mMolecules, mParams.mAerosols}, mParams.mWavelengths, lambdas);
+
+  Model                model(mParams, mMetadata, mPhaseData, lambdas);
+  cs::utils::TaskGroup group(mThreadPool);
+
+  // 1. Compute the transmittance, and store it in mTransmittanceTexture.
+  computeTransmittance(lambdas);
+
+  // 2. Compute the direct irradiance, store it in deltaIrradianceTexture and, depending on
+  // 'blend', either initialize mIrradianceTexture with zeros or leave it unchanged.
+  forEachTexel(group, deltaIrradianceTexture, [&](int32_t x, int32_t y, int32_t /*z*/) {
+    glm::vec2 fragCoord(x + 0.5F, y + 0.5F);
+    deltaIrradianceTexture.at(x, y) =
+        model.computeDirectIrradianceTexture(mTransmittanceTexture, fragCoord);
+    accumulate(mIrradianceTexture.at(x, y), glm::vec3(0.F), blend);
+  });
+
+  // 3. Compute the molecules and aerosols single scattering, store them in
+  // deltaMoleculesScatteringTexture and deltaAerosolsScatteringTexture, and accumulate the
+  // resulting luminance in mMultipleScatteringTexture and mSingleAerosolsScatteringTexture.
+  forEachTexel(group, deltaMoleculesScatteringTexture, [&](int32_t x, int32_t y, int32_t z) {
+    glm::vec3 fragCoord(x + 0.5F, y + 0.5F, z + 0.5F);
+    glm::vec3 molecules;
+    glm::vec3 aerosols;
+    model.computeSingleScatteringTexture(mTransmittanceTexture, fragCoord, molecules, aerosols);
+    deltaMoleculesScatteringTexture.at(x, y, z) = molecules;
+    deltaAerosolsScatteringTexture.at(x, y, z)  = aerosols;
+    accumulate(mMultipleScatteringTexture.at(x, y, z), luminance * molecules, blend);
+    accumulate(mSingleAerosolsScatteringTexture.at(x, y, z), luminance * aerosols, blend);
+  });
+
+  group.wait();
+
+  // 4. Compute the 2nd, 3rd and 4th order of scattering, in sequence.
+  Texture nextDeltaIrradianceTexture(deltaIrradianceTexture.mWidth, deltaIrradianceTexture.mHeight);
+
+  for (int scatteringOrder = 2; scatteringOrder <= static_cast<int>(numScatteringOrders);
+       ++scatteringOrder) {
+
+    // 4.1. Compute the scattering density, and store it in deltaScatteringDensityTexture.
+    forEachTexel(group, deltaScatteringDensityTexture, [&](int32_t x, int32_t y, int32_t z) {
+      glm::vec3 fragCoord(x + 0.5F, y + 0.5F, z + 0.5F);
+      deltaScatteringDensityTexture.at(x, y, z) = model.computeScatteringDensityTexture(
+          mTransmittanceTexture, deltaMoleculesScatteringTexture, deltaAerosolsScatteringTexture,
+          deltaMultipleScatteringTexture, deltaIrradianceTexture, fragCoord, scatteringOrder);
+    });
+
+    // 4.2. Compute the indirect irradiance, store it in nextDeltaIrradianceTexture and accumulate
+    // it in mIrradianceTexture.
+    forEachTexel(group, nextDeltaIrradianceTexture, [&](int32_t x, int32_t y, int32_t /*z*/) {
+      glm::vec2 fragCoord(x + 0.5F, y + 0.5F);
+      glm::vec3 deltaIrradiance = model.computeIndirectIrradianceTexture(
+          deltaMoleculesScatteringTexture, deltaAerosolsScatteringTexture,
+          deltaMultipleScatteringTexture, fragCoord, scatteringOrder - 1);
+      nextDeltaIrradianceTexture.at(x, y) = deltaIrradiance;
+      mIrradianceTexture.at(x, y) += luminance * deltaIrradiance;
+    });
+
+    group.wait();
+
+    std::swap(deltaIrradianceTexture.mData, nextDeltaIrradianceTexture.mData);
+
+    // 4.3. Compute the multiple scattering, store it in deltaMultipleScatteringTexture, and
+    // accumulate it in mMultipleScatteringTexture.
+    forEachTexel(group, deltaMultipleScatteringTexture, [&](int32_t x, int32_t y, int32_t z) {
+      glm::vec3 fragCoord(x + 0.5F, y + 0.5F, z + 0.5F);
+      float     nu;
+      glm::vec3 deltaMultipleScattering = model.computeMultipleScatteringTexture(
+          mTransmittanceTexture, deltaScatteringDensityTexture, fragCoord, nu);
+      deltaMultipleScatteringTexture.at(x, y, z) = deltaMultipleScattering;
+      mMultipleScatteringTexture.at(x, y, z) +=
+          luminance * deltaMultipleScattering / model.phaseFunction(model.mMolecules, nu);
+    });
+
+    group.wait();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void CpuPreprocessor::computeTransmittance(glm::vec3 const& lambdas) {
+  Model                model(mParams, mMetadata, mPhaseData, lambdas);
+  cs::utils::TaskGroup group(mThreadPool);
+
+  forEachTexel(group, mTransmittanceTexture, [&](int32_t x, int32_t y, int32_t /*z*/) {
+    glm::vec2 fragCoord(x + 0.5F, y + 0.5F);
+    float     thetaDeviation = 0.F;
+    float     contactRadius  = 0.F;
+    mTransmittanceTexture.at(x, y) =
+        model.computeTransmittanceToTopAtmosphereBoundaryTexture(
+            fragCoord, thetaDeviation, contactRadius);
+
+    if (mParams.mRefraction.get()) {
+      mThetaDeviationTexture.at(x, y) = glm::vec3(thetaDeviation, contactRadius, 0.F);
+    }
+  });
+
+  group.wait();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void CpuPreprocessor::forEachTexel(cs::utils::TaskGroup& group, Texture const& texture,
+    std::function<void(int32_t, int32_t, int32_t)> kernel) {
+
+  // The kernel is shared by all tasks. It is only destroyed once the last row has been computed.
+  auto sharedKernel = std::make_shared<std::function<void(int32_t, int32_t, int32_t)>>(
+      std::move(kernel));
+
+  for (int32_t z = 0; z < texture.mDepth; ++z) {
+    for (int32_t y = 0; y < texture.mHeight; ++y) {
+      group.enqueue([sharedKernel, width = texture.mWidth, y, z]() {
+        for (int32_t x = 0; x < width; ++x) {
+          (*sharedKernel)(x, y, z);
+        }
+      });
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
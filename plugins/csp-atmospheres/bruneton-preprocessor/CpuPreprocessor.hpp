@@ -0,0 +1,96 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-FileCopyrightText: 2017 Eric Bruneton
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef CPU_PREPROCESSOR_HPP
+#define CPU_PREPROCESSOR_HPP
+
+#include "../../../../src/cs-utils/ThreadPool.hpp"
+#include "Metadata.hpp"
+#include "Params.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+/// This class performs the same precomputation as the Preprocessor class, but without OpenGL. The
+/// shader code has been ported to C++ and each precomputation step is distributed among the
+/// threads of a thread pool. Therefore, it can be used on machines without a GPU or a display. It
+/// produces the same output files as the Preprocessor. See the source file for more information.
+class CpuPreprocessor {
+ public:
+  /// This is used to store the intermediate and final results of the precomputation. It can be
+  /// sampled like an OpenGL texture with linear filtering and clamp-to-edge wrapping.
+  struct Texture {
+    Texture(int32_t width, int32_t height, int32_t depth = 1);
+
+    glm::vec3&       at(int32_t x, int32_t y, int32_t z = 0);
+    glm::vec3 const& at(int32_t x, int32_t y, int32_t z = 0) const;
+
+    glm::vec3 sample(glm::vec2 const& uv) const;
+    glm::vec3 sample(glm::vec3 const& uvw) const;
+
+    int32_t                mWidth;
+    int32_t                mHeight;
+    int32_t                mDepth;
+    std::vector<glm::vec3> mData;
+  };
+
+  /// The constructor of the class takes all parameters which define the attributes of the
+  /// atmosphere. The precomputation will use the given number of threads. If zero is passed, one
+  /// thread per hardware thread is used.
+  CpuPreprocessor(Params params, uint32_t threads);
+
+  /// This will preprocess the multiple scattering up to the given number. Setting this to one will
+  /// disable multiple scattering.
+  void run(unsigned int numScatteringOrders);
+
+  /// This will save the precomputed textures to the given directory.
+  void save(std::string const& directory);
+
+  /// Returns the number of threads which are used for the precomputation.
+  size_t getThreadCount() const;
+
+ private:
+  void precompute(Texture& deltaIrradianceTexture, Texture& deltaMoleculesScatteringTexture,
+      Texture& deltaAerosolsScatteringTexture, Texture& deltaScatteringDensityTexture,
+      Texture& deltaMultipleScatteringTexture, glm::vec3 const& lambdas,
+      glm::mat3 const& luminanceFromRadiance, bool blend, unsigned int numScatteringOrders);
+
+  void computeTransmittance(glm::vec3 const& lambdas);
+
+  /// Enqueues a task for each row of the given texture to the given task group. Each task calls
+  /// the given kernel for all texels of its row. The caller has to wait for the task group to
+  /// finish. Enqueueing several independent steps before waiting allows them to be executed
+  /// concurrently.
+  void forEachTexel(cs::utils::TaskGroup& group, Texture const& texture,
+      std::function<void(int32_t, int32_t, int32_t)> kernel);
+
+  const Params  mParams;
+  const int32_t mScatteringTextureWidth;
+  const int32_t mScatteringTextureHeight;
+  const int32_t mScatteringTextureDepth;
+
+  Metadata mMetadata;
+
+  cs::utils::ThreadPool mThreadPool;
+
+  // As in the Preprocessor class, this texture stores single molecule-scattering plus all
+  // multiple-scattering contributions. The single aerosols scattering is stored in an extra
+  // texture.
+  Texture mMultipleScatteringTexture;
+  Texture mSingleAerosolsScatteringTexture;
+
+  std::vector<float> mPhaseData;
+  Texture            mTransmittanceTexture;
+  Texture            mThetaDeviationTexture;
+  Texture            mIrradianceTexture;
+};
+
+#endif // CPU_PREPROCESSOR_HPP
@@ -10,14 +10,13 @@
 
 #include "../../../../src/cs-utils/filesystem.hpp"
 #include "../../../../src/cs-utils/utils.hpp"
+#include "common.hpp"
 
 #include <cassert>
 #include <cmath>
-#include <fstream>
 #include <glm/gtc/type_ptr.hpp>
 #include <iostream>
 #include <memory>
-#include <tiffio.h>
 
 // This file is based in large parts on the original implementation by Eric Bruneton:
 // https://github.com/ebruneton/precomputed_atmospheric_scattering/blob/master/atmosphere/model.cc
@@ -43,148 +42,6 @@
 
 namespace {
 
-// Values from "Reference Solar Spectral Irradiance: ASTM G-173", ETR column  (see
-// http://rredc.nrel.gov/solar/spectra/am1.5/ASTMG173/ASTMG173.html), summed and averaged in each
-// bin (e.g. the value for 360nm is the average of the ASTM G-173 values for all wavelengths between
-// 360 and 370nm). Values in W.m^-2. Copied from:
-// https://github.com/ebruneton/precomputed_atmospheric_scattering/blob/master/atmosphere/demo/demo.cc
-// clang-format off
-const std::vector<float> SOLAR_IRRADIANCE = {
-                                                                1.11776F, 1.14259F, 1.01249F, 1.14716F,
-    1.72765F, 1.73054F, 1.6887F,  1.61253F, 1.91198F, 2.03474F, 2.02042F, 2.02212F, 1.93377F, 1.95809F,
-    1.91686F, 1.8298F,  1.8685F,  1.8931F,  1.85149F, 1.8504F,  1.8341F,  1.8345F,  1.8147F,  1.78158F,
-    1.7533F,  1.6965F,  1.68194F, 1.64654F, 1.6048F,  1.52143F, 1.55622F, 1.5113F,  1.474F,   1.4482F,
-    1.41018F, 1.36775F, 1.34188F, 1.31429F, 1.28303F, 1.26758F, 1.2367F,  1.2082F,  1.18737F, 1.14683F,
-    1.12362F, 1.1058F,  1.07124F, 1.04992F
-};
-
-const std::vector<float> WAVELENGTHS = {
-                                              360.F, 370.F, 380.F, 390.F,
-    400.F, 410.F, 420.F, 430.F, 440.F, 450.F, 460.F, 470.F, 480.F, 490.F,
-    500.F, 510.F, 520.F, 530.F, 540.F, 550.F, 560.F, 570.F, 580.F, 590.F,
-    600.F, 610.F, 620.F, 630.F, 640.F, 650.F, 660.F, 670.F, 680.F, 690.F,
-    700.F, 710.F, 720.F, 730.F, 740.F, 750.F, 760.F, 770.F, 780.F, 790.F,
-    800.F, 810.F, 820.F, 830.F
-};
-// clang-format on
-
-// The conversion factor between watts and lumens.
-constexpr float MAX_LUMINOUS_EFFICACY = 683.0;
-
-// Values from "CIE (1931) 2-deg color matching functions", see
-// "http://web.archive.org/web/20081228084047/http://www.cvrl.org/database/data/cmfs/ciexyz31.txt".
-// Copied from:
-// https://github.com/ebruneton/precomputed_atmospheric_scattering/blob/master/atmosphere/constants.h
-// clang-format off
-constexpr float CIE_2_DEG_COLOR_MATCHING_FUNCTIONS[380] = {
-    360.F, 0.000129900000F, 0.000003917000F, 0.000606100000F,
-    365.F, 0.000232100000F, 0.000006965000F, 0.001086000000F,
-    370.F, 0.000414900000F, 0.000012390000F, 0.001946000000F,
-    375.F, 0.000741600000F, 0.000022020000F, 0.003486000000F,
-    380.F, 0.001368000000F, 0.000039000000F, 0.006450001000F,
-    385.F, 0.002236000000F, 0.000064000000F, 0.010549990000F,
-    390.F, 0.004243000000F, 0.000120000000F, 0.020050010000F,
-    395.F, 0.007650000000F, 0.000217000000F, 0.036210000000F,
-    400.F, 0.014310000000F, 0.000396000000F, 0.067850010000F,
-    405.F, 0.023190000000F, 0.000640000000F, 0.110200000000F,
-    410.F, 0.043510000000F, 0.001210000000F, 0.207400000000F,
-    415.F, 0.077630000000F, 0.002180000000F, 0.371300000000F,
-    420.F, 0.134380000000F, 0.004000000000F, 0.645600000000F,
-    425.F, 0.214770000000F, 0.007300000000F, 1.039050100000F,
-    430.F, 0.283900000000F, 0.011600000000F, 1.385600000000F,
-    435.F, 0.328500000000F, 0.016840000000F, 1.622960000000F,
-    440.F, 0.348280000000F, 0.023000000000F, 1.747060000000F,
-    445.F, 0.348060000000F, 0.029800000000F, 1.782600000000F,
-    450.F, 0.336200000000F, 0.038000000000F, 1.772110000000F,
-    455.F, 0.318700000000F, 0.048000000000F, 1.744100000000F,
-    460.F, 0.290800000000F, 0.060000000000F, 1.669200000000F,
-    465.F, 0.251100000000F, 0.073900000000F, 1.528100000000F,
-    470.F, 0.195360000000F, 0.090980000000F, 1.287640000000F,
-    475.F, 0.142100000000F, 0.112600000000F, 1.041900000000F,
-    480.F, 0.095640000000F, 0.139020000000F, 0.812950100000F,
-    485.F, 0.057950010000F, 0.169300000000F, 0.616200000000F,
-    490.F, 0.032010000000F, 0.208020000000F, 0.465180000000F,
-    495.F, 0.014700000000F, 0.258600000000F, 0.353300000000F,
-    500.F, 0.004900000000F, 0.323000000000F, 0.272000000000F,
-    505.F, 0.002400000000F, 0.407300000000F, 0.212300000000F,
-    510.F, 0.009300000000F, 0.503000000000F, 0.158200000000F,
-    515.F, 0.029100000000F, 0.608200000000F, 0.111700000000F,
-    520.F, 0.063270000000F, 0.710000000000F, 0.078249990000F,
-    525.F, 0.109600000000F, 0.793200000000F, 0.057250010000F,
-    530.F, 0.165500000000F, 0.862000000000F, 0.042160000000F,
-    535.F, 0.225749900000F, 0.914850100000F, 0.029840000000F,
-    540.F, 0.290400000000F, 0.954000000000F, 0.020300000000F,
-    545.F, 0.359700000000F, 0.980300000000F, 0.013400000000F,
-    550.F, 0.433449900000F, 0.994950100000F, 0.008749999000F,
-    555.F, 0.512050100000F, 1.000000000000F, 0.005749999000F,
-    560.F, 0.594500000000F, 0.995000000000F, 0.003900000000F,
-    565.F, 0.678400000000F, 0.978600000000F, 0.002749999000F,
-    570.F, 0.762100000000F, 0.952000000000F, 0.002100000000F,
-    575.F, 0.842500000000F, 0.915400000000F, 0.001800000000F,
-    580.F, 0.916300000000F, 0.870000000000F, 0.001650001000F,
-    585.F, 0.978600000000F, 0.816300000000F, 0.001400000000F,
-    590.F, 1.026300000000F, 0.757000000000F, 0.001100000000F,
-    595.F, 1.056700000000F, 0.694900000000F, 0.001000000000F,
-    600.F, 1.062200000000F, 0.631000000000F, 0.000800000000F,
-    605.F, 1.045600000000F, 0.566800000000F, 0.000600000000F,
-    610.F, 1.002600000000F, 0.503000000000F, 0.000340000000F,
-    615.F, 0.938400000000F, 0.441200000000F, 0.000240000000F,
-    620.F, 0.854449900000F, 0.381000000000F, 0.000190000000F,
-    625.F, 0.751400000000F, 0.321000000000F, 0.000100000000F,
-    630.F, 0.642400000000F, 0.265000000000F, 0.000049999990F,
-    635.F, 0.541900000000F, 0.217000000000F, 0.000030000000F,
-    640.F, 0.447900000000F, 0.175000000000F, 0.000020000000F,
-    645.F, 0.360800000000F, 0.138200000000F, 0.000010000000F,
-    650.F, 0.283500000000F, 0.107000000000F, 0.000000000000F,
-    655.F, 0.218700000000F, 0.081600000000F, 0.000000000000F,
-    660.F, 0.164900000000F, 0.061000000000F, 0.000000000000F,
-    665.F, 0.121200000000F, 0.044580000000F, 0.000000000000F,
-    670.F, 0.087400000000F, 0.032000000000F, 0.000000000000F,
-    675.F, 0.063600000000F, 0.023200000000F, 0.000000000000F,
-    680.F, 0.046770000000F, 0.017000000000F, 0.000000000000F,
-    685.F, 0.032900000000F, 0.011920000000F, 0.000000000000F,
-    690.F, 0.022700000000F, 0.008210000000F, 0.000000000000F,
-    695.F, 0.015840000000F, 0.005723000000F, 0.000000000000F,
-    700.F, 0.011359160000F, 0.004102000000F, 0.000000000000F,
-    705.F, 0.008110916000F, 0.002929000000F, 0.000000000000F,
-    710.F, 0.005790346000F, 0.002091000000F, 0.000000000000F,
-    715.F, 0.004109457000F, 0.001484000000F, 0.000000000000F,
-    720.F, 0.002899327000F, 0.001047000000F, 0.000000000000F,
-    725.F, 0.002049190000F, 0.000740000000F, 0.000000000000F,
-    730.F, 0.001439971000F, 0.000520000000F, 0.000000000000F,
-    735.F, 0.000999949300F, 0.000361100000F, 0.000000000000F,
-    740.F, 0.000690078600F, 0.000249200000F, 0.000000000000F,
-    745.F, 0.000476021300F, 0.000171900000F, 0.000000000000F,
-    750.F, 0.000332301100F, 0.000120000000F, 0.000000000000F,
-    755.F, 0.000234826100F, 0.000084800000F, 0.000000000000F,
-    760.F, 0.000166150500F, 0.000060000000F, 0.000000000000F,
-    765.F, 0.000117413000F, 0.000042400000F, 0.000000000000F,
-    770.F, 0.000083075270F, 0.000030000000F, 0.000000000000F,
-    775.F, 0.000058706520F, 0.000021200000F, 0.000000000000F,
-    780.F, 0.000041509940F, 0.000014990000F, 0.000000000000F,
-    785.F, 0.000029353260F, 0.000010600000F, 0.000000000000F,
-    790.F, 0.000020673830F, 0.000007465700F, 0.000000000000F,
-    795.F, 0.000014559770F, 0.000005257800F, 0.000000000000F,
-    800.F, 0.000010253980F, 0.000003702900F, 0.000000000000F,
-    805.F, 0.000007221456F, 0.000002607800F, 0.000000000000F,
-    810.F, 0.000005085868F, 0.000001836600F, 0.000000000000F,
-    815.F, 0.000003581652F, 0.000001293400F, 0.000000000000F,
-    820.F, 0.000002522525F, 0.000000910930F, 0.000000000000F,
-    825.F, 0.000001776509F, 0.000000641530F, 0.000000000000F,
-    830.F, 0.000001251141F, 0.000000451810F, 0.000000000000F,
-};
-// clang-format on
-
-// The conversion matrix from XYZ to linear sRGB color spaces.
-// Values from https://en.wikipedia.org/wiki/SRGB.
-// clang-format off
-constexpr float XYZ_TO_SRGB[9] = {
-    +3.2406F, -1.5372F, -0.4986F,
-    -0.9689F, +1.8758F, +0.0415F,
-    +0.0557F, -0.2040F, +1.0570F
-};
-// clang-format on
-
 // Shader Definitions ------------------------------------------------------------------------------
 
 // Below, the source code for several shaders is defined.
@@ -533,90 +390,22 @@ void DrawQuad(std::vector<bool> const& enableBlend, GLuint quadVAO) {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-// This is functionality-wise identical to the original implementation.
-
-float CieColorMatchingFunctionTableValue(float wavelength, int column) {
-  if (wavelength <= WAVELENGTHS.front() || wavelength >= WAVELENGTHS.back()) {
-    return 0.F;
-  }
-  float u   = (wavelength - WAVELENGTHS.front()) / 5.F;
-  int   row = static_cast<int>(std::floor(u));
-  assert(row >= 0 && row + 1 < 95);
-  assert(CIE_2_DEG_COLOR_MATCHING_FUNCTIONS[4 * row] <= wavelength &&
-         CIE_2_DEG_COLOR_MATCHING_FUNCTIONS[4 * (row + 1)] >= wavelength);
-  u -= row;
-  return CIE_2_DEG_COLOR_MATCHING_FUNCTIONS[4 * row + column] * (1.F - u) +
-         CIE_2_DEG_COLOR_MATCHING_FUNCTIONS[4 * (row + 1) + column] * u;
-}
-
-////////////////////////////////////////////////////////////////////////////////////////////////////
-
-// This is functionality-wise identical to the original implementation.
-
-float Interpolate(std::vector<float> const& xVals, std::vector<float> const& yVals, float x) {
-  assert(yVals.size() == xVals.size());
-
-  if (x < xVals[0]) {
-    return yVals[0];
-  }
-
-  for (unsigned int i = 0; i < xVals.size() - 1; ++i) {
-    if (x < xVals[i + 1]) {
-      float u = (x - xVals[i]) / (xVals[i + 1] - xVals[i]);
-      return yVals[i] * (1.F - u) + yVals[i + 1] * u;
-    }
-  }
-
-  return yVals[yVals.size() - 1];
-}
-
-////////////////////////////////////////////////////////////////////////////////////////////////////
-
-// This is functionality-wise identical to the original implementation.
-
-void ComputeSpectralRadianceToLuminanceFactors(float lambdaPower, float* kR, float* kG, float* kB) {
-
-  *kR           = 0.F;
-  *kG           = 0.F;
-  *kB           = 0.F;
-  float solarR  = Interpolate(WAVELENGTHS, SOLAR_IRRADIANCE, Preprocessor::kLambdaR);
-  float solarG  = Interpolate(WAVELENGTHS, SOLAR_IRRADIANCE, Preprocessor::kLambdaG);
-  float solarB  = Interpolate(WAVELENGTHS, SOLAR_IRRADIANCE, Preprocessor::kLambdaB);
-  float dLambda = 1.0;
-  for (float lambda = WAVELENGTHS.front(); lambda <= WAVELENGTHS.back(); lambda += dLambda) {
-    float        x_bar      = CieColorMatchingFunctionTableValue(lambda, 1);
-    float        y_bar      = CieColorMatchingFunctionTableValue(lambda, 2);
-    float        z_bar      = CieColorMatchingFunctionTableValue(lambda, 3);
-    const float* xyz2srgb   = XYZ_TO_SRGB;
-    float        r_bar      = xyz2srgb[0] * x_bar + xyz2srgb[1] * y_bar + xyz2srgb[2] * z_bar;
-    float        g_bar      = xyz2srgb[3] * x_bar + xyz2srgb[4] * y_bar + xyz2srgb[5] * z_bar;
-    float        b_bar      = xyz2srgb[6] * x_bar + xyz2srgb[7] * y_bar + xyz2srgb[8] * z_bar;
-    float        irradiance = Interpolate(WAVELENGTHS, SOLAR_IRRADIANCE, lambda);
-    *kR += r_bar * irradiance / solarR * pow(lambda / Preprocessor::kLambdaR, lambdaPower);
-    *kG += g_bar * irradiance / solarG * pow(lambda / Preprocessor::kLambdaG, lambdaPower);
-    *kB += b_bar * irradiance / solarB * pow(lambda / Preprocessor::kLambdaB, lambdaPower);
-  }
-  *kR *= MAX_LUMINOUS_EFFICACY * dLambda;
-  *kG *= MAX_LUMINOUS_EFFICACY * dLambda;
-  *kB *= MAX_LUMINOUS_EFFICACY * dLambda;
-}
-
-////////////////////////////////////////////////////////////////////////////////////////////////////
-
 // The functions below are used to inject the atmosphere components into the shader source code.
 // These were not present in the original implementation and have been added because we refactored
 // how data is passed to the shader.
 
-// This first method is used to create a GLSL "vec3(...)" string based on a linearly interpolated 1D
-// function. The function is defined by the first two parameters and the three values are extracted
-// by linear interpolation using the three values passed in as last parameter.
+// This first method is used to create a GLSL "vec3(...)" string from the given vector.
+std::string printVec3(glm::vec3 const& v) {
+  return "vec3(" + cs::utils::toString(v.r) + "," + cs::utils::toString(v.g) + "," +
+         cs::utils::toString(v.b) + ")";
+}
+
+// This creates a GLSL "vec3(...)" string based on a linearly interpolated 1D function. The function
+// is defined by the first two parameters and the three values are extracted by linear interpolation
+// using the three values passed in as last parameter.
 std::string extractVec3(
     std::vector<float> const& xVals, std::vector<float> const& yVals, glm::vec3 const& lambdas) {
-  float r = Interpolate(xVals, yVals, lambdas[0]);
-  float g = Interpolate(xVals, yVals, lambdas[1]);
-  float b = Interpolate(xVals, yVals, lambdas[2]);
-  return "vec3(" + cs::utils::toString(r) + "," + cs::utils::toString(g) + "," +
-         cs::utils::toString(b) + ")";
+  return printVec3(common::interpolate(xVals, yVals, lambdas));
 }
 
 // This creates an GLSL snippet corresponding to the given scattering component.
@@ -676,24 +465,7 @@ Preprocessor::Preprocessor(Params params)
     , mScatteringTextureHeight(mParams.mScatteringTextureMuSize.get())
     , mScatteringTextureDepth(mParams.mScatteringTextureRSize.get()) {
 
-  // Compute angular radius of the sun.
-  float sunRadius             = 696340000.F; // meters
-  mMetadata.mSunAngularRadius = std::asin(sunRadius / mParams.mSunDistance);
-
-  // Compute the values for the SUN_RADIANCE_TO_LUMINANCE constant.
-  float sunAngularRadiusAtEarth = 0.0046547F; // radians
-  float attenuation =
-      std::pow(mMetadata.mSunAngularRadius, 2.F) / std::pow(sunAngularRadiusAtEarth, 2.F);
-  float sunKR, sunKG, sunKB;
-  ComputeSpectralRadianceToLuminanceFactors(0 /* lambdaPower */, &sunKR, &sunKG, &sunKB);
-  sunKR *= Interpolate(WAVELENGTHS, SOLAR_IRRADIANCE, kLambdaR) * attenuation;
-  sunKG *= Interpolate(WAVELENGTHS, SOLAR_IRRADIANCE, kLambdaG) * attenuation;
-  sunKB *= Interpolate(WAVELENGTHS, SOLAR_IRRADIANCE, kLambdaB) * attenuation;
-
-  mMetadata.mSunIlluminance          = glm::vec3(sunKR, sunKG, sunKB);
-  mMetadata.mScatteringTextureNuSize = mParams.mScatteringTextureNuSize.get();
-  mMetadata.mMaxSunZenithAngle       = mParams.mMaxSunZenithAngle.get();
-  mMetadata.mRefraction              = mParams.mRefraction.get();
+  mMetadata = common::createMetadata(mParams);
 
   // A lambda that creates a GLSL header containing our atmosphere computation functions,
   // specialized for the given atmosphere parameters and for the 3 wavelengths in 'lambdas'.
@@ -728,7 +500,7 @@ Preprocessor::Preprocessor(Params params)
       "const int SAMPLE_COUNT_MULTI_SCATTERING = "    + cs::utils::toString(mParams.mSampleCountMultiScattering) + ";\n" +
       "const int STEP_SIZE_MULTI_SCATTERING = "       + cs::utils::toString(mParams.mStepSizeMultiScattering) + ";\n" +
       "const int SAMPLE_COUNT_INDIRECT_IRRADIANCE = " + cs::utils::toString(mParams.mSampleCountIndirectIrradiance) + ";\n" +
-      "const vec3 SOLAR_IRRADIANCE = "                + extractVec3(WAVELENGTHS, SOLAR_IRRADIANCE, lambdas) + ";\n" +
+      "const vec3 SOLAR_IRRADIANCE = "                + printVec3(common::getSolarIrradiance(lambdas)) + ";\n" +
       "const vec3 GROUND_ALBEDO = vec3("              + cs::utils::toString(mParams.mGroundAlbedo) + ");\n" +
       "const float INDEX_OF_REFRACTION = "            + cs::utils::toString(mParams.mRefractiveIndex) + ";\n" +
       "const float SUN_ANGULAR_RADIUS = "             + cs::utils::toString(mMetadata.mSunAngularRadius) + ";\n" +
@@ -859,10 +631,9 @@ void Preprocessor::run(unsigned int numScatteringOrders) {
     std::cout << "Precomputing atmospheric scattering (1/1)..." << std::endl;
     glm::vec3 lambdas{kLambdaR, kLambdaG, kLambdaB};
 
-    float skyKR, skyKG, skyKB;
-    ComputeSpectralRadianceToLuminanceFactors(-3 /* lambdaPower */, &skyKR, &skyKG, &skyKB);
+    glm::mat3 luminanceFromRadiance =
+        common::getLuminanceFromRadiance(mParams.mWavelengths, lambdas);
 
-    glm::mat3 luminanceFromRadiance{skyKR, 0.0, 0.0, 0.0, skyKG, 0.0, 0.0, 0.0, skyKB};
     precompute(fbo, deltaIrradianceTexture, deltaMoleculesScatteringTexture,
         deltaAerosolsScatteringTexture, deltaScatteringDensityTexture,
         deltaMultipleScatteringTexture, lambdas, luminanceFromRadiance, false /* blend */,
@@ -876,24 +647,8 @@ void Preprocessor::run(unsigned int numScatteringOrders) {
       glm::vec3 lambdas{mParams.mWavelengths[i * 3 + 0], mParams.mWavelengths[i * 3 + 1],
           mParams.mWavelengths[i * 3 + 2]};
 
-      auto coeff = [this](float lambda, int component) {
-        // Note that we don't include MAX_LUMINOUS_EFFICACY here, to avoid artefacts due to too
-        // large values when using half precision on GPU. We add this term back in
-        // kAtmosphereShader, via SKY_SPECTRAL_RADIANCE_TO_LUMINANCE (see also the comments in the
-        // Model constructor).
-        float x = CieColorMatchingFunctionTableValue(lambda, 1);
-        float y = CieColorMatchingFunctionTableValue(lambda, 2);
-        float z = CieColorMatchingFunctionTableValue(lambda, 3);
-        return static_cast<float>(
-                   (XYZ_TO_SRGB[component * 3] * x + XYZ_TO_SRGB[component * 3 + 1] * y +
-                       XYZ_TO_SRGB[component * 3 + 2] * z) *
-                   (mParams.mWavelengths[1] - mParams.mWavelengths[0])) *
-               MAX_LUMINOUS_EFFICACY;
-      };
-
-      glm::mat3 luminanceFromRadiance{coeff(lambdas[0], 0), coeff(lambdas[1], 0),
-          coeff(lambdas[2], 0), coeff(lambdas[0], 1), coeff(lambdas[1], 1), coeff(lambdas[2], 1),
-          coeff(lambdas[0], 2), coeff(lambdas[1], 2), coeff(lambdas[2], 2)};
+      glm::mat3 luminanceFromRadiance =
+          common::getLuminanceFromRadiance(mParams.mWavelengths, lambdas);
 
       precompute(fbo, deltaIrradianceTexture, deltaMoleculesScatteringTexture,
           deltaAerosolsScatteringTexture, deltaScatteringDensityTexture,
@@ -957,83 +712,40 @@ void Preprocessor::run(unsigned int numScatteringOrders) {
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 // This method did not exist in the original implementation. It saves the precomputed textures as
-// tiff files to disk. The metadata is saved as a json file.
+// tiff files to disk. Each texture is also stored in the binary format which can be loaded faster
+// by CosmoScout VR. The metadata is saved as a json file.
 
 void Preprocessor::save(std::string const& directory) {
   std::cout << "Saving precomputed atmosphere to disk..." << std::endl;
 
-  // For debugging purposes, we print the maximum ray deviation in degrees.
-  std::vector<float> pixels(
-      mParams.mTransmittanceTextureWidth.get() * mParams.mTransmittanceTextureHeight.get() * 3);
-  glBindTexture(GL_TEXTURE_2D, mThetaDeviationTexture);
-  glGetTexImage(GL_TEXTURE_2D, 0, GL_RGB, GL_FLOAT, pixels.data());
-  glBindTexture(GL_TEXTURE_2D, 0);
-
-  float maxThetaDeviation = 0.F;
-  for (int x = 0; x < mParams.mTransmittanceTextureWidth.get(); ++x) {
-    for (int y = 0; y < mParams.mTransmittanceTextureHeight.get(); ++y) {
-      int i = 3 * (y * mParams.mTransmittanceTextureWidth.get() + x);
-
-      float thetaDeviation = pixels[i];
-      float contactRadius  = pixels[i + 1];
-
-      if (contactRadius > 0.F) {
-        maxThetaDeviation = std::max(maxThetaDeviation, thetaDeviation);
-      }
-    }
-  }
-
-  std::cout << "Maximum ray deviation: " << maxThetaDeviation * 180.F / glm::pi<float>()
-            << " degrees." << std::endl;
+  // Reads back the given texture from the GPU.
+  auto readTexture = [](GLenum target, GLuint texture, size_t size) {
+    std::vector<float> data(size * 3);
+    glBindTexture(target, texture);
+    glGetTexImage(target, 0, GL_RGB, GL_FLOAT, data.data());
+    glBindTexture(target, 0);
+    return data;
+  };
 
-  auto write2D = [](std::string const& path, GLuint texture, int width, int height) {
-    std::vector<float> data(width * height * 3);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGB, GL_FLOAT, data.data());
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    auto* tiff = TIFFOpen(path.c_str(), "w");
-    TIFFSetField(tiff, TIFFTAG_IMAGEWIDTH, width);
-    TIFFSetField(tiff, TIFFTAG_IMAGELENGTH, height);
-    TIFFSetField(tiff, TIFFTAG_SAMPLESPERPIXEL, 3);
-    TIFFSetField(tiff, TIFFTAG_BITSPERSAMPLE, 32);
-    TIFFSetField(tiff, TIFFTAG_SAMPLEFORMAT, SAMPLEFORMAT_IEEEFP);
-    TIFFSetField(tiff, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_RGB);
-    TIFFSetField(tiff, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
-    TIFFSetField(tiff, TIFFTAG_ROWSPERSTRIP, 1);
-    for (int y = 0; y < height; ++y) {
-      TIFFWriteScanline(tiff, data.data() + y * width * 3, y);
-    }
-    TIFFClose(tiff);
+  auto write2D = [&](std::string const& path, GLuint texture, int width, int height) {
+    auto data = readTexture(GL_TEXTURE_2D, texture, width * height);
+    common::writeTexture2D(path, data.data(), width, height);
   };
 
-  auto write3D = [](std::string const& path, GLuint texture, int width, int height, int depth) {
-    std::vector<float> data(width * height * depth * 3);
-    glBindTexture(GL_TEXTURE_3D, texture);
-    glGetTexImage(GL_TEXTURE_3D, 0, GL_RGB, GL_FLOAT, data.data());
-    glBindTexture(GL_TEXTURE_3D, 0);
-
-    auto* tiff = TIFFOpen(path.c_str(), "w");
-
-    for (int z = 0; z < depth; ++z) {
-      TIFFSetField(tiff, TIFFTAG_PAGENUMBER, z, z);
-      TIFFSetField(tiff, TIFFTAG_SUBFILETYPE, FILETYPE_PAGE);
-      TIFFSetField(tiff, TIFFTAG_IMAGEWIDTH, width);
-      TIFFSetField(tiff, TIFFTAG_IMAGELENGTH, height);
-      TIFFSetField(tiff, TIFFTAG_SAMPLESPERPIXEL, 3);
-      TIFFSetField(tiff, TIFFTAG_BITSPERSAMPLE, 32);
-      TIFFSetField(tiff, TIFFTAG_SAMPLEFORMAT, SAMPLEFORMAT_IEEEFP);
-      TIFFSetField(tiff, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_RGB);
-      TIFFSetField(tiff, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
-      TIFFSetField(tiff, TIFFTAG_ROWSPERSTRIP, 1);
-      for (int y = 0; y < height; ++y) {
-        TIFFWriteScanline(tiff, data.data() + z * width * height * 3 + y * width * 3, y);
-      }
-      TIFFWriteDirectory(tiff);
-    }
-    TIFFClose(tiff);
+  auto write3D = [&](std::string const& path, GLuint texture, int width, int height, int depth) {
+    auto data = readTexture(GL_TEXTURE_3D, texture, width * height * depth);
+    common::writeTexture3D(path, data.data(), width, height, depth);
   };
 
+  // For debugging purposes, we print the maximum ray deviation in degrees.
+  auto thetaDeviation = readTexture(GL_TEXTURE_2D, mThetaDeviationTexture,
+      mParams.mTransmittanceTextureWidth.get() * mParams.mTransmittanceTextureHeight.get());
+  float maxThetaDeviation = common::getMaxThetaDeviation(thetaDeviation.data(),
+      mParams.mTransmittanceTextureWidth.get(), mParams.mTransmittanceTextureHeight.get());
+
+  std::cout << "Maximum ray deviation: " << maxThetaDeviation * 180.F / glm::pi<float>()
+            << " degrees." << std::endl;
+
   int numAngles = static_cast<int>(mParams.mMolecules.mPhase.size());
   write2D(directory + "/phase.tif", mPhaseTexture, numAngles, 2);
   write2D(directory + "/transmittance.tif", mTransmittanceTexture,
@@ -1050,9 +762,7 @@ void Preprocessor::save(std::string const& directory) {
         mParams.mTransmittanceTextureWidth.get(), mParams.mTransmittanceTextureHeight.get());
   }
 
-  std::ofstream  out(directory + "/metadata.json");
-  nlohmann::json data = mMetadata;
-  out << std::setw(2) << data;
+  common::writeMetadata(directory, mMetadata);
 
   std::cout << "Precomputed atmosphere saved to disk." << std::endl;
 }
@@ -1289,17 +999,8 @@ void Preprocessor::updatePhaseFunctionTexture(
   }
 
   size_t numAngles = scatteringComponents.front().mPhase.size();
-
-  std::vector<float> data;
-  data.reserve(3 * scatteringComponents.size() * numAngles);
-
-  for (size_t i(0); i < scatteringComponents.size(); ++i) {
-    for (auto const& spectrum : scatteringComponents[i].mPhase) {
-      data.push_back(static_cast<float>(Interpolate(mParams.mWavelengths, spectrum, lambdas[0])));
-      data.push_back(static_cast<float>(Interpolate(mParams.mWavelengths, spectrum, lambdas[1])));
-      data.push_back(static_cast<float>(Interpolate(mParams.mWavelengths, spectrum, lambdas[2])));
-    }
-  }
+  auto   data =
+      common::getPhaseFunctionData(scatteringComponents, mParams.mWavelengths, lambdas);
 
   mPhaseTexture = NewTexture2d(static_cast<int>(numAngles),
       static_cast<int>(scatteringComponents.size()), GL_RGB32F, GL_RGB, GL_FLOAT, data.data());
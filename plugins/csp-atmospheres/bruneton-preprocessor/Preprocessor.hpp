@@ -11,6 +11,7 @@
 
 #include "Metadata.hpp"
 #include "Params.hpp"
+#include "common.hpp"
 
 #include <GL/glew.h>
 #include <array>
@@ -27,9 +28,9 @@
 class Preprocessor {
  public:
   /// If only three wavelengths are used during preprocessing, these three are used:
-  static constexpr float kLambdaR = 680.0;
-  static constexpr float kLambdaG = 550.0;
-  static constexpr float kLambdaB = 440.0;
+  static constexpr float kLambdaR = common::kLambdaR;
+  static constexpr float kLambdaG = common::kLambdaG;
+  static constexpr float kLambdaB = common::kLambdaB;
 
   /// The constructor of the class takes all parameters which define the attributes of the
   /// atmosphere. It will allocate various GPU resources.
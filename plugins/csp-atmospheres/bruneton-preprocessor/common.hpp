@@ -0,0 +1,73 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-FileCopyrightText: 2017 Eric Bruneton
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef COMMON_HPP
+#define COMMON_HPP
+
+#include "Metadata.hpp"
+#include "Params.hpp"
+
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+/// This namespace contains functionality which is shared between the OpenGL preprocessor and the
+/// CPU preprocessor. This includes the conversion from spectral radiance to luminance as well as
+/// the code which writes the precomputed textures to disk.
+
+namespace common {
+
+/// If only three wavelengths are used during preprocessing, these three are used:
+constexpr float kLambdaR = 680.0;
+constexpr float kLambdaG = 550.0;
+constexpr float kLambdaB = 440.0;
+
+/// Returns the value of the linearly interpolated function defined by xVals and yVals at x.
+float interpolate(std::vector<float> const& xVals, std::vector<float> const& yVals, float x);
+
+/// Same as above, but evaluates the function at all three given wavelengths.
+glm::vec3 interpolate(
+    std::vector<float> const& xVals, std::vector<float> const& yVals, glm::vec3 const& lambdas);
+
+/// Returns the solar irradiance in W.m^-2 at the three given wavelengths.
+glm::vec3 getSolarIrradiance(glm::vec3 const& lambdas);
+
+/// Returns the matrix which converts the radiance computed for the given three wavelengths to
+/// luminance. If only three wavelengths are used in total, this is a diagonal matrix. Else, the
+/// three wavelengths are one batch of the full spectrum and their contribution to the luminance is
+/// computed using the CIE color matching functions. The returned matrix is meant to be uploaded to
+/// a shader with transposition enabled.
+glm::mat3 getLuminanceFromRadiance(
+    std::vector<float> const& wavelengths, glm::vec3 const& lambdas);
+
+/// Computes the angular radius and the illuminance of the Sun as well as some other values which
+/// are required at runtime and which do not depend on the actual precomputation.
+Metadata createMetadata(Params const& params);
+
+/// Returns the RGB values of the phase functions of the given scattering components at the given
+/// wavelengths. Each row of pixels corresponds to one scattering component. Forward-scattering is
+/// on the left, back-scattering is on the right.
+std::vector<float> getPhaseFunctionData(
+    std::vector<Params::ScatteringComponent> const& scatteringComponents,
+    std::vector<float> const& wavelengths, glm::vec3 const& lambdas);
+
+/// Returns the largest angular deviation of all rays which do not hit the planet. The data is
+/// expected to be in the format of the theta-deviation texture.
+float getMaxThetaDeviation(float const* data, int width, int height);
+
+/// These save the given RGB data as a tiff file and in the binary format which can be loaded
+/// faster by CosmoScout VR. Three-dimensional data is stored as a multi-page tiff file.
+void writeTexture2D(std::string const& path, float const* data, int width, int height);
+void writeTexture3D(std::string const& path, float const* data, int width, int height, int depth);
+
+/// Saves the given metadata as metadata.json to the given directory.
+void writeMetadata(std::string const& directory, Metadata const& metadata);
+
+} // namespace common
+
+#endif // COMMON_HPP
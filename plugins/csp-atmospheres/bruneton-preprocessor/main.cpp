@@ -7,10 +7,14 @@
 
 #include <GL/glew.h>
 #include <SDL2/SDL.h>
+#include <chrono>
 #include <fstream>
+#include <regex>
 
 #include "../../../../src/cs-utils/filesystem.hpp"
+#include "../src/tables.hpp"
 
+#include "CpuPreprocessor.hpp"
 #include "Params.hpp"
 #include "Preprocessor.hpp"
 #include "csv.hpp"
@@ -30,7 +34,110 @@ __declspec(dllexport) int AmdPowerXpressRequestHighPerformance = 1;
 void printHelp() {
   std::cout << "Welcome to the Atmosphere Preprocessor! Usage:" << std::endl;
   std::cout << std::endl;
-  std::cout << "  ./bruneton-preprocessor <input JSON> <output directory>" << std::endl;
+  std::cout << "  ./bruneton-preprocessor <input JSON> <output directory> [--cpu [threads]]"
+            << std::endl;
+  std::cout << std::endl;
+  std::cout << "If --cpu is given, no OpenGL context is created and the precomputation is done on "
+               "the CPU instead. Per default, one thread per hardware thread is used."
+            << std::endl;
+  std::cout << std::endl;
+  std::cout << "Existing TIFF output can be converted to the faster binary format with:"
+            << std::endl;
+  std::cout << std::endl;
+  std::cout << "  ./bruneton-preprocessor --convert <output directory>" << std::endl;
+  std::cout << std::endl;
+  std::cout << "The TIFF output of two runs can be compared with:" << std::endl;
+  std::cout << std::endl;
+  std::cout << "  ./bruneton-preprocessor --compare <reference directory> <output directory> "
+               "[tolerance]"
+            << std::endl;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+// Stores each TIFF file in the given directory also in the binary format which can be loaded faster
+// by CosmoScout VR.
+int convert(std::string const& directory) {
+  auto files = cs::utils::filesystem::listFiles(directory, std::regex(".*\\.tif"));
+
+  for (auto const& file : files) {
+    glm::ivec3         size;
+    std::vector<float> data;
+
+    if (!csp::atmospheres::tables::readTIFF(file, size, data)) {
+      std::cerr << "Failed to read TIFF file: " << file << std::endl;
+      return 1;
+    }
+
+    auto binaryFile = csp::atmospheres::tables::getBinaryPath(file);
+
+    if (!csp::atmospheres::tables::writeBinary(binaryFile, size, data.data())) {
+      std::cerr << "Failed to write binary file: " << binaryFile << std::endl;
+      return 1;
+    }
+
+    std::cout << "Converted " << file << " to " << binaryFile << "." << std::endl;
+  }
+
+  return 0;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+// Compares each TIFF file in the reference directory to the file with the same name in the output
+// directory. This can be used to validate the CPU backend against the OpenGL backend. Values larger
+// than one are compared relatively. Returns a non-zero value if any file is missing or if any value
+// differs by more than the given tolerance.
+int compare(std::string const& reference, std::string const& output, float tolerance) {
+  auto files  = cs::utils::filesystem::listFiles(reference, std::regex(".*\\.tif"));
+  int  result = 0;
+
+  for (auto const& file : files) {
+    auto name = boost::filesystem::path(file).filename().string();
+
+    glm::ivec3         referenceSize;
+    glm::ivec3         outputSize;
+    std::vector<float> referenceData;
+    std::vector<float> outputData;
+
+    if (!csp::atmospheres::tables::readTIFF(file, referenceSize, referenceData) ||
+        !csp::atmospheres::tables::readTIFF(output + "/" + name, outputSize, outputData)) {
+      std::cerr << "Failed to read " << name << "!" << std::endl;
+      result = 1;
+      continue;
+    }
+
+    if (referenceSize != outputSize || referenceData.size() != outputData.size()) {
+      std::cerr << name << ": The dimensions do not match!" << std::endl;
+      result = 1;
+      continue;
+    }
+
+    float  maxError      = 0.F;
+    size_t failingValues = 0;
+
+    for (size_t i = 0; i < referenceData.size(); ++i) {
+      float error = std::abs(referenceData[i] - outputData[i]) /
+                    std::max(1.F, std::abs(referenceData[i]));
+
+      // This also catches NaNs in either file, as any comparison with NaN is false.
+      if (!(error <= tolerance)) {
+        ++failingValues;
+      }
+
+      maxError = std::max(maxError, error);
+    }
+
+    if (failingValues > 0) {
+      std::cout << name << ": Maximum error is " << maxError << ", " << failingValues
+                << " values exceed the tolerance (failed)!" << std::endl;
+      result = 1;
+    } else {
+      std::cout << name << ": Maximum error is " << maxError << "." << std::endl;
+    }
+  }
+
+  return result;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -50,6 +157,43 @@ int main(int argc, char** argv) {
   std::string cInput(argv[1]);
   std::string cOutput(argv[2]);
 
+  // Convert existing output. This does not require an OpenGL context.
+  if (cInput == "--convert") {
+    return convert(cOutput);
+  }
+
+  // Compare two existing outputs. This does not require an OpenGL context either.
+  if (cInput == "--compare") {
+    if (argc <= 3) {
+      printHelp();
+      return 1;
+    }
+
+    float tolerance = 0.001F;
+
+    try {
+      tolerance = argc > 4 ? std::stof(argv[4]) : tolerance;
+    } catch (std::exception const&) {
+      std::cerr << "Invalid tolerance: " << argv[4] << std::endl;
+      printHelp();
+      return 1;
+    }
+
+    return compare(cOutput, argv[3], tolerance);
+  }
+
+  // Check whether the precomputation should be done on the CPU.
+  bool     cUseCPU  = argc > 3 && std::string(argv[3]) == "--cpu";
+  uint32_t cThreads = 0;
+
+  try {
+    cThreads = cUseCPU && argc > 4 ? static_cast<uint32_t>(std::stoul(argv[4])) : 0;
+  } catch (std::exception const&) {
+    std::cerr << "Invalid thread count: " << argv[4] << std::endl;
+    printHelp();
+    return 1;
+  }
+
   // Try parsing the atmosphere settings.
   std::ifstream stream(cInput, std::ios::in);
 
@@ -112,6 +256,23 @@ int main(int argc, char** argv) {
     return 1;
   }
 
+  // The CPU backend does not require an OpenGL context.
+  if (cUseCPU) {
+    CpuPreprocessor preprocessor(params, cThreads);
+
+    auto start = std::chrono::steady_clock::now();
+    preprocessor.run(params.mMultiScatteringOrder.get() + 1);
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << "Precomputation on " << preprocessor.getThreadCount() << " CPU threads took "
+              << std::chrono::duration<double>(end - start).count() << " seconds." << std::endl;
+
+    cs::utils::filesystem::createDirectoryRecursively(boost::filesystem::system_complete(cOutput));
+    preprocessor.save(cOutput);
+
+    return 0;
+  }
+
   // Initialize SDL.
   if (SDL_Init(SDL_INIT_VIDEO) < 0) {
     SDL_Log("Unable to initialize SDL: %s", SDL_GetError());
@@ -150,7 +311,14 @@ int main(int argc, char** argv) {
 
   // Finally, run the preprocessor.
   Preprocessor preprocessor(params);
+
+  auto start = std::chrono::steady_clock::now();
   preprocessor.run(params.mMultiScatteringOrder.get() + 1);
+  glFinish();
+  auto end = std::chrono::steady_clock::now();
+
+  std::cout << "Precomputation on the GPU took "
+            << std::chrono::duration<double>(end - start).count() << " seconds." << std::endl;
 
   // Create the output directory if it does not exist.
   cs::utils::filesystem::createDirectoryRecursively(boost::filesystem::system_complete(cOutput));
@@ -14,9 +14,11 @@
 #include <nlohmann/json.hpp>
 #include <spdlog/spdlog.h>
 
+#include <chrono>
 #include <complex>
 #include <fstream>
 #include <map>
+#include <omp.h>
 #include <optional>
 #include <random>
 
@@ -103,11 +105,9 @@ void from_json(nlohmann::json const& j, SizeDistribution& s) {
   }
 }
 
-// Draws a random set of radii from the given distribution.
-std::vector<double> sampleRadii(SizeDistribution const& distribution, int32_t count) {
-
-  std::random_device rd{};
-  std::mt19937       gen{rd()};
+// Draws a random set of radii from the given distribution using the given random number generator.
+std::vector<double> sampleRadii(
+    SizeDistribution const& distribution, int32_t count, std::mt19937& gen) {
 
   std::vector<double> radii(count);
 
@@ -253,69 +253,148 @@ struct MieResult {
   double cAbs;
 };
 
-// This computes the phase function and average scattering and absorption cross sections of a
-// disperse particle mixture for a given wavelength. The phase function will be sampled at 2 *
-// thetaSamples - 1 positions between 0° (forward-scattering) and 180° (back-scattering). The
-// wavelength in m is given via the lambda parameter, the particle's radii are given via a sampled
-// radii distribution (also in m).
-MieResult mieDisperse(int32_t thetaSamples, double lambda, std::complex<double> ior,
-    std::vector<double> const& radii) {
+// This stores the sums of the cross sections and of the weighted phase function samples of a
+// contiguous chunk of particle radii. Chunks are summed in a fixed order to get the result of a
+// whole particle mixture.
+struct MieSums {
+  std::vector<double> phase;
+  double              cSca = 0.0;
+  double              cAbs = 0.0;
 
-  MieResult result;
-  result.phase = std::vector<double>(2 * thetaSamples - 1);
-  result.cAbs  = 0.0;
-  result.cSca  = 0.0;
+  void add(MieSums const& other) {
+    for (size_t i(0); i < phase.size(); ++i) {
+      phase[i] += other.phase[i];
+    }
 
-#pragma omp parallel for
-  for (int32_t i = 0; i < static_cast<int32_t>(radii.size()); ++i) {
-    double r = radii[i];
-    double x = 2.0 * r * glm::pi<double>() / lambda;
+    cSca += other.cSca;
+    cAbs += other.cAbs;
+  }
+};
+
+// A particle mixture for which mieDisperse() should compute the MieResult. The wavelength is given
+// in m via the lambda parameter, the particle's radii are given via a sampled radii distribution
+// (also in m).
+struct MieJob {
+  double               lambda;
+  std::complex<double> ior;
+  std::vector<double>  radii;
+};
+
+// The radii of each job are split into chunks of this size. Each chunk is summed up sequentially.
+// As the chunks do not depend on the number of threads, the results are bit-identical regardless
+// of how many threads are used.
+constexpr int32_t cRadiiPerChunk = 64;
+
+// This computes the phase function and average scattering and absorption cross sections of all
+// given disperse particle mixtures. The phase functions will be sampled at 2 * thetaSamples - 1
+// positions between 0° (forward-scattering) and 180° (back-scattering). The work is distributed
+// among all OpenMP threads on the granularity of chunks of particle radii of all jobs. The partial
+// results of the chunks of each job are then combined with a pairwise reduction.
+std::vector<MieResult> mieDisperse(int32_t thetaSamples, std::vector<MieJob> const& jobs) {
+
+  int32_t totalAngles = thetaSamples * 2 - 1;
+
+  // Assign a range of chunk indices to each job.
+  struct Chunk {
+    size_t  job;
+    int32_t firstRadius;
+    int32_t lastRadius;
+  };
+
+  // The last entry of firstChunks is the total number of chunks.
+  std::vector<Chunk>  chunks;
+  std::vector<size_t> firstChunks(jobs.size() + 1);
 
-    double                            qext, qsca, qback, gsca;
+  for (size_t j(0); j < jobs.size(); ++j) {
+    firstChunks[j] = chunks.size();
+    auto numRadii  = static_cast<int32_t>(jobs[j].radii.size());
+
+    for (int32_t r(0); r < numRadii; r += cRadiiPerChunk) {
+      chunks.push_back({j, r, std::min(r + cRadiiPerChunk, numRadii)});
+    }
+  }
+
+  firstChunks.back() = chunks.size();
+
+  std::vector<MieSums> sums(chunks.size(), MieSums{std::vector<double>(totalAngles)});
+
+#pragma omp parallel
+  {
+    // These scratch buffers are only allocated once per thread.
     std::vector<std::complex<double>> cxs1(2 * thetaSamples);
     std::vector<std::complex<double>> cxs2(2 * thetaSamples);
 
-    bhmie(x, ior, thetaSamples, cxs1, cxs2, &qext, &qsca, &qback, &gsca);
+#pragma omp for schedule(dynamic)
+    for (int64_t c = 0; c < static_cast<int64_t>(chunks.size()); ++c) {
+      auto const& chunk  = chunks[c];
+      auto const& job    = jobs[chunk.job];
+      auto&       result = sums[c];
 
-    double csca = qsca * glm::pi<double>() * r * r;
-    double cext = qext * glm::pi<double>() * r * r;
+      for (int32_t i = chunk.firstRadius; i < chunk.lastRadius; ++i) {
+        double r = job.radii[i];
+        double x = 2.0 * r * glm::pi<double>() / job.lambda;
 
-    // This is used to normalize the phase function to 4π.
-    double              normalization = glm::pi<double>() * x * x * qsca;
-    std::vector<double> phase(2 * thetaSamples - 1);
+        double qext, qsca, qback, gsca;
+        bhmie(x, job.ior, thetaSamples, cxs1, cxs2, &qext, &qsca, &qback, &gsca);
 
-    for (int32_t i(0); i < thetaSamples * 2 - 1; ++i) {
+        double csca = qsca * glm::pi<double>() * r * r;
+        double cext = qext * glm::pi<double>() * r * r;
 
-      // Compute the scattering intensity for each direction by averaging the parallel and
-      // orthogonal polarizations. For some reason bhmie returns the intensity values shifted by one
-      // index.
-      double intensity =
-          0.5 * (std::pow(std::abs(cxs1[i + 1]), 2.f) + std::pow(std::abs(cxs2[i + 1]), 2.f));
+        // This is used to normalize the phase function to 4π.
+        double normalization = glm::pi<double>() * x * x * qsca;
 
-      // The phase functions are normalized to 4π and weight by the scattering cross section of the
-      // current particle radius.
-      phase[i] = intensity / normalization * csca;
-    }
+        for (int32_t t(0); t < totalAngles; ++t) {
 
-#pragma omp critical
-    {
-      for (int32_t i(0); i < thetaSamples * 2 - 1; ++i) {
-        result.phase[i] += phase[i];
-      }
+          // Compute the scattering intensity for each direction by averaging the parallel and
+          // orthogonal polarizations. For some reason bhmie returns the intensity values shifted by
+          // one index.
+          double intensity = 0.5 * (std::norm(cxs1[t + 1]) + std::norm(cxs2[t + 1]));
+
+          // The phase functions are normalized to 4π and weight by the scattering cross section of
+          // the current particle radius.
+          result.phase[t] += intensity / normalization * csca;
+        }
 
-      result.cSca += csca;
-      result.cAbs += cext - csca;
+        result.cSca += csca;
+        result.cAbs += cext - csca;
+      }
     }
   }
 
-  for (auto& p : result.phase) {
-    p /= result.cSca;
-  }
+  std::vector<MieResult> results(jobs.size());
 
-  result.cSca /= radii.size();
-  result.cAbs /= radii.size();
+#pragma omp parallel for
+  for (int64_t j = 0; j < static_cast<int64_t>(jobs.size()); ++j) {
+    size_t first = firstChunks[j];
+    size_t count = firstChunks[j + 1] - first;
+
+    // Combine the chunks of this job with a pairwise reduction. The result ends up in the first
+    // chunk.
+    for (size_t stride(1); stride < count; stride *= 2) {
+      for (size_t i(0); i + stride < count; i += 2 * stride) {
+        sums[first + i].add(sums[first + i + stride]);
+      }
+    }
 
-  return result;
+    MieResult& result = results[j];
+    result.phase      = std::vector<double>(totalAngles, 0.0);
+    result.cSca       = 0.0;
+    result.cAbs       = 0.0;
+
+    if (count > 0) {
+      auto const& total    = sums[first];
+      double      numRadii = static_cast<double>(jobs[j].radii.size());
+
+      for (int32_t t(0); t < totalAngles; ++t) {
+        result.phase[t] = total.phase[t] / total.cSca;
+      }
+
+      result.cSca = total.cSca / numRadii;
+      result.cAbs = total.cAbs / numRadii;
+    }
+  }
+
+  return results;
 }
 
 } // namespace
@@ -335,6 +414,8 @@ int mieMode(std::vector<std::string> const& arguments) {
   int32_t     cLambdaSamples   = 15;
   int32_t     cThetaSamples    = 91;
   int32_t     cRadiusSamples   = 1000;
+  int32_t     cSeed            = -1;
+  int32_t     cThreads         = 0;
 
   // First configure all possible command line options.
   cs::utils::CommandLine args("Here are the available options:");
@@ -354,6 +435,13 @@ int mieMode(std::vector<std::string> const& arguments) {
       "function. This can be useful to reduce the dynamic range for cinematic purposes. This "
       "should be in the range [0..1] (default: " +
           std::to_string(cPhaseFlattening) + ").");
+  args.addArgument({"--seed"}, &cSeed,
+      "The seed used for sampling the particle radii. Use this to get reproducible results. If "
+      "negative, a random seed is used (default: " +
+          std::to_string(cSeed) + ").");
+  args.addArgument({"--threads"}, &cThreads,
+      "The number of threads to use. If zero, the OpenMP default is used (default: " +
+          std::to_string(cThreads) + ").");
   common::addLambdaFlags(args, &cLambdas, &cMinLambda, &cMaxLambda, &cLambdaSamples);
   common::addThetaFlags(args, &cThetaSamples);
   args.addArgument({"-h", "--help"}, &cPrintHelp, "Show this help message.");
@@ -435,8 +523,30 @@ int mieMode(std::vector<std::string> const& arguments) {
   }
   phaseOutput << std::endl;
 
-  int32_t totalSteps  = static_cast<int32_t>(lambdas.size() * particleSettings.sizeModes.size());
-  int32_t currentStep = 0;
+  // Sample the particle radii for each wavelength and each size mode. This is done sequentially, so
+  // that a given seed always results in the same radii.
+  std::mt19937 gen(cSeed >= 0 ? static_cast<uint32_t>(cSeed) : std::random_device{}());
+
+  std::vector<MieJob> jobs;
+  for (size_t l(0); l < lambdas.size(); ++l) {
+    for (auto const& sizeMode : particleSettings.sizeModes) {
+      jobs.push_back({lambdas[l], ior[l], sampleRadii(sizeMode, cRadiusSamples, gen)});
+    }
+  }
+
+  if (cThreads > 0) {
+    omp_set_num_threads(cThreads);
+  }
+
+  std::cout << "Computing " << jobs.size() << " particle mixtures with " << cRadiusSamples
+            << " radii each on " << omp_get_max_threads() << " threads..." << std::endl;
+
+  auto start      = std::chrono::steady_clock::now();
+  auto mieResults = mieDisperse(cThetaSamples, jobs);
+  auto end        = std::chrono::steady_clock::now();
+
+  std::cout << "Computation took " << std::chrono::duration<double>(end - start).count()
+            << " seconds." << std::endl;
 
   // Now write a line to the CSV file for each wavelength.
   for (size_t l(0); l < lambdas.size(); ++l) {
@@ -450,13 +560,10 @@ int mieMode(std::vector<std::string> const& arguments) {
     double totalCoeffWeight = 0.0;
     double totalPhaseWeight = 0.0;
 
-    for (auto sizeMode : particleSettings.sizeModes) {
-
-      std::cout << "Computing step " << ++currentStep << " / " << totalSteps << std::endl;
-
-      auto radii = sampleRadii(sizeMode, cRadiusSamples);
+    for (size_t m(0); m < particleSettings.sizeModes.size(); ++m) {
 
-      auto mieResult = mieDisperse(cThetaSamples, lambda, ior[l], radii);
+      auto const& sizeMode  = particleSettings.sizeModes[m];
+      auto const& mieResult = mieResults[l * particleSettings.sizeModes.size() + m];
 
       // Scattering cross sections are weighted by the number density of the size modes, phase
       // functions are also weighted by the respective scattering cross-sections.
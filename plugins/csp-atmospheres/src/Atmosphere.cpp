@@ -48,6 +48,8 @@ Atmosphere::Atmosphere(std::shared_ptr<Plugin::Settings> pluginSettings,
     , mSolarSystem(std::move(solarSystem))
     , mGraphicsEngine(std::move(graphicsEngine))
     , mObjectName(std::move(objectName))
+    , mObject(mSolarSystem->getObjectHandle(mObjectName))
+    , mTimerRange("Atmosphere of " + mObjectName)
     , mEclipseShadowReceiver(
           std::make_shared<cs::core::EclipseShadowReceiver>(mAllSettings, mSolarSystem, false)) {
 
@@ -62,6 +64,14 @@ Atmosphere::Atmosphere(std::shared_ptr<Plugin::Settings> pluginSettings,
     }
   });
 
+  // Only the six finest mipmap levels of the cloud texture are used. The texture is shared with
+  // other users of the TextureLoader, so this is configured with a sampler object instead of
+  // modifying the texture parameters.
+  glGenSamplers(1, &mCloudSampler);
+  glSamplerParameteri(mCloudSampler, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+  glSamplerParameteri(mCloudSampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glSamplerParameterf(mCloudSampler, GL_TEXTURE_MAX_LOD, 5.F);
+
   // Attach this to the scene graph root.
   VistaSceneGraph* pSG = GetVistaSystem()->GetGraphicsManager()->GetSceneGraph();
   mAtmosphereNode.reset(pSG->NewOpenGLNode(pSG->GetRoot(), this));
@@ -81,12 +91,14 @@ Atmosphere::~Atmosphere() {
   if (mLimbLuminanceTexture != 0) {
     glDeleteTextures(1, &mLimbLuminanceTexture);
   }
+
+  glDeleteSamplers(1, &mCloudSampler);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void Atmosphere::configure(Plugin::Settings::Atmosphere const& settings) {
-  auto object = mSolarSystem->getObject(mObjectName);
+  auto const& object = mObject.get();
   if (object) {
     auto radii = object->getRadii();
 
@@ -116,10 +128,8 @@ void Atmosphere::configure(Plugin::Settings::Atmosphere const& settings) {
     // Reload the cloud texture if required.
     if (mSettings.mCloudTexture != settings.mCloudTexture) {
       if (settings.mCloudTexture.has_value() && !settings.mCloudTexture.value().empty()) {
-        mCloudTexture = cs::graphics::TextureLoader::loadFromFile(settings.mCloudTexture.value());
-        mCloudTexture->Bind();
-        glTexParameteri(mCloudTexture->GetTarget(), GL_TEXTURE_MAX_LOD, 5);
-        mCloudTexture->Unbind();
+        mCloudTexture =
+            cs::graphics::TextureLoader::loadFromFileAsync(settings.mCloudTexture.value());
       } else {
         mCloudTexture.reset();
       }
@@ -230,7 +240,7 @@ void Atmosphere::updateShaders() {
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void Atmosphere::update(double time) {
-  auto object = mSolarSystem->getObject(mObjectName);
+  auto const& object = mObject.get();
 
   if (object && object->getIsBodyVisible() && mPluginSettings->mEnable.get()) {
     mTime           = time;
@@ -274,8 +284,8 @@ void Atmosphere::update(double time) {
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 bool Atmosphere::Do() {
-  cs::utils::FrameStats::ScopedTimer          timer("Atmosphere of " + mObjectName);
-  cs::utils::FrameStats::ScopedSamplesCounter samplesCounter("Atmosphere of " + mObjectName);
+  cs::utils::FrameStats::ScopedTimer          timer(mTimerRange);
+  cs::utils::FrameStats::ScopedSamplesCounter samplesCounter(mTimerRange);
 
   if (mShaderDirty || mEclipseShadowReceiver->needsRecompilation()) {
     updateShaders();
@@ -391,6 +401,7 @@ bool Atmosphere::Do() {
 
   if (mSettings.mEnableClouds.get() && mCloudTexture) {
     mCloudTexture->Bind(GL_TEXTURE2);
+    glBindSampler(2, mCloudSampler);
     mAtmoShader.SetUniform(mAtmoUniforms.cloudTexture, 2);
     mAtmoShader.SetUniform(mAtmoUniforms.cloudAltitude, mSettings.mCloudAltitude.get());
   }
@@ -430,6 +441,7 @@ bool Atmosphere::Do() {
 
   if (mSettings.mEnableClouds.get() && mCloudTexture) {
     mCloudTexture->Unbind(GL_TEXTURE2);
+    glBindSampler(2, 0);
   }
 
   if (mSettings.mEnableClouds.get() && mLimbLuminanceTexture) {
@@ -10,6 +10,9 @@
 
 #include "Plugin.hpp"
 
+#include "../../../src/cs-core/ObjectHandle.hpp"
+#include "../../../src/cs-utils/FrameStats.hpp"
+
 #include <VistaKernel/GraphicsManager/VistaOpenGLDraw.h>
 #include <VistaOGLExt/VistaGLSLShader.h>
 
@@ -86,10 +89,13 @@ class Atmosphere : public IVistaOpenGLDraw {
   std::shared_ptr<cs::core::SolarSystem>           mSolarSystem;
   std::shared_ptr<cs::core::GraphicsEngine>        mGraphicsEngine;
   std::string                                      mObjectName;
+  cs::core::ObjectHandle                           mObject;
+  cs::utils::FrameStats::RangeId                   mTimerRange;
   std::unique_ptr<VistaOpenGLNode>                 mAtmosphereNode;
   std::shared_ptr<cs::graphics::HDRBuffer>         mHDRBuffer;
   std::shared_ptr<cs::core::EclipseShadowReceiver> mEclipseShadowReceiver;
-  std::unique_ptr<VistaTexture>                    mCloudTexture;
+  std::shared_ptr<VistaTexture>                    mCloudTexture;
+  GLuint                                           mCloudSampler         = 0;
   GLuint                                           mLimbLuminanceTexture = 0;
 
   glm::dvec3                   mRadii                          = glm::dvec3(1.0, 1.0, 1.0);
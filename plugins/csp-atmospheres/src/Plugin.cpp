@@ -15,6 +15,8 @@
 #include "../../../src/cs-utils/logger.hpp"
 #include "logger.hpp"
 
+#include <chrono>
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 EXPORT_FN cs::core::PluginBase* create() {
@@ -243,6 +245,10 @@ void Plugin::onLoad() {
   // Read settings from JSON.
   from_json(mAllSettings->mPlugins.at("csp-atmospheres"), *mPluginSettings);
 
+  // Creating the atmospheres includes loading the precomputed tables of the Bruneton model. The
+  // total time is reported so that different table formats can be compared.
+  auto start = std::chrono::steady_clock::now();
+
   // First try to re-configure existing atmospheres. We assume that they are similar if they have
   // the same name in the settings (which means they are attached to an anchor with the same name).
   auto atmosphere = mAtmospheres.begin();
@@ -273,6 +279,9 @@ void Plugin::onLoad() {
 
     mAtmospheres.emplace(settings.first, newAtmosphere);
   }
+
+  logger().info("Initialized {} atmospheres in {:.1f} ms.", mAtmospheres.size(),
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,140 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "TableRegistry.hpp"
+
+#include "logger.hpp"
+#include "tables.hpp"
+#include "utils.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <vector>
+
+namespace csp::atmospheres {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::unordered_map<std::string, std::weak_ptr<TableRegistry::Table const>> TableRegistry::mCache;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TableRegistry::Table::Table(GLuint texture, glm::ivec3 const& size)
+    : mTexture(texture)
+    , mSize(size) {
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TableRegistry::Table::~Table() {
+  glDeleteTextures(1, &mTexture);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::shared_ptr<TableRegistry::Table const> TableRegistry::load2D(std::string const& path) {
+  return load(path, false);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::shared_ptr<TableRegistry::Table const> TableRegistry::load3D(std::string const& path) {
+  return load(path, true);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::shared_ptr<TableRegistry::Table const> TableRegistry::load(
+    std::string const& path, bool is3D) {
+
+  // Prefer the binary file if it exists. If the TIFF file has been modified after the binary file
+  // was written, the binary file is outdated and the TIFF file is used instead.
+  std::string binaryPath = tables::getBinaryPath(path);
+  bool        useBinary  = boost::filesystem::exists(binaryPath);
+
+  if (useBinary && boost::filesystem::exists(path) &&
+      boost::filesystem::last_write_time(binaryPath) < boost::filesystem::last_write_time(path)) {
+    logger().warn("Ignoring outdated table '{}' as '{}' is newer! Run the bruneton-preprocessor "
+                  "with --convert to update it.",
+        binaryPath, path);
+    useBinary = false;
+  }
+
+  std::string file = useBinary ? binaryPath : path;
+
+  if (!boost::filesystem::exists(file)) {
+    logger().error("Failed to load table '{}': File does not exist!", path);
+    return nullptr;
+  }
+
+  // The key identifies the content of the file. Regenerated tables will get a new key.
+  std::string key = boost::filesystem::canonical(file).string() + ":" +
+                    std::to_string(boost::filesystem::file_size(file)) + ":" +
+                    std::to_string(boost::filesystem::last_write_time(file));
+
+  auto cached = mCache.find(key);
+  if (cached != mCache.end()) {
+    if (auto table = cached->second.lock()) {
+      return table;
+    }
+  }
+
+  std::shared_ptr<Table const> table;
+
+  if (useBinary) {
+    try {
+      boost::interprocess::file_mapping  mapping(file.c_str(), boost::interprocess::read_only);
+      boost::interprocess::mapped_region region(mapping, boost::interprocess::read_only);
+
+      auto const* bytes = static_cast<char const*>(region.get_address());
+
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+      auto const* header = reinterpret_cast<tables::BinaryHeader const*>(bytes);
+
+      if (region.get_size() < sizeof(tables::BinaryHeader) ||
+          !tables::isValid(*header, region.get_size() - sizeof(tables::BinaryHeader))) {
+        logger().error("Failed to load table '{}': Invalid file format!", file);
+        return nullptr;
+      }
+
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+      auto const* pixels = reinterpret_cast<float const*>(bytes + sizeof(tables::BinaryHeader));
+      glm::ivec3  size(header->mWidth, header->mHeight, header->mDepth);
+
+      GLuint texture = is3D ? utils::upload3DTexture(size.x, size.y, size.z, pixels)
+                            : utils::upload2DTexture(size.x, size.y, pixels);
+
+      table = std::make_shared<Table const>(texture, size);
+
+    } catch (std::exception const& e) {
+      logger().error("Failed to load table '{}': {}", file, e.what());
+      return nullptr;
+    }
+  } else {
+    glm::ivec3         size;
+    std::vector<float> pixels;
+
+    if (!tables::readTIFF(file, size, pixels)) {
+      logger().error("Failed to load table '{}': Cannot open TIFF file!", file);
+      return nullptr;
+    }
+
+    GLuint texture = is3D ? utils::upload3DTexture(size.x, size.y, size.z, pixels.data())
+                          : utils::upload2DTexture(size.x, size.y, pixels.data());
+
+    table = std::make_shared<Table const>(texture, size);
+  }
+
+  mCache[key] = table;
+
+  return table;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace csp::atmospheres
@@ -0,0 +1,57 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#ifndef CSP_ATMOSPHERES_TABLE_REGISTRY_HPP
+#define CSP_ATMOSPHERES_TABLE_REGISTRY_HPP
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace csp::atmospheres {
+
+/// The TableRegistry loads the precomputed lookup tables of the atmosphere models and shares the
+/// resulting textures between all atmospheres. If several bodies use the same data directory, or
+/// if an atmosphere is reloaded, the tables are only loaded once. The textures are deleted once
+/// the last atmosphere using them is destroyed.
+/// If there is a *.bin file next to a requested *.tif file, the binary file is memory-mapped and
+/// uploaded with a single call. The binary files can be created with the bruneton-preprocessor.
+/// The registry must only be used on the main thread.
+class TableRegistry {
+ public:
+  /// A texture containing a lookup table. The texture is deleted in the destructor.
+  struct Table {
+    Table(GLuint texture, glm::ivec3 const& size);
+    ~Table();
+
+    Table(Table const& other) = delete;
+    Table(Table&& other)      = delete;
+
+    Table& operator=(Table const& other) = delete;
+    Table& operator=(Table&& other)      = delete;
+
+    GLuint     mTexture = 0;
+    glm::ivec3 mSize{};
+  };
+
+  /// Returns the table stored in the given TIFF file (or its binary counterpart). Tables are
+  /// identified by the canonical path, size and modification time of the file which is actually
+  /// read, so regenerated tables will be loaded again. Returns nullptr if the file cannot be read.
+  static std::shared_ptr<Table const> load2D(std::string const& path);
+  static std::shared_ptr<Table const> load3D(std::string const& path);
+
+ private:
+  static std::shared_ptr<Table const> load(std::string const& path, bool is3D);
+
+  static std::unordered_map<std::string, std::weak_ptr<Table const>> mCache;
+};
+
+} // namespace csp::atmospheres
+
+#endif // CSP_ATMOSPHERES_TABLE_REGISTRY_HPP
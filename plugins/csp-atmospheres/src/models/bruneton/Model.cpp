@@ -9,11 +9,13 @@
 
 #include "../../../src/cs-utils/filesystem.hpp"
 #include "../../../src/cs-utils/utils.hpp"
+#include "../../TableRegistry.hpp"
 #include "../../logger.hpp"
 #include "../../utils.hpp"
 #include "Metadata.hpp"
 
 #include <cassert>
+#include <chrono>
 #include <cmath>
 #include <fstream>
 #include <glm/gtc/type_ptr.hpp>
@@ -37,11 +39,6 @@ void to_json(nlohmann::json& j, Model::Settings const& o) {
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 Model::~Model() {
-  glDeleteTextures(1, &mPhaseTexture);
-  glDeleteTextures(1, &mTransmittanceTexture);
-  glDeleteTextures(1, &mMultipleScatteringTexture);
-  glDeleteTextures(1, &mSingleAerosolsScatteringTexture);
-  glDeleteTextures(1, &mIrradianceTexture);
   glDeleteShader(mAtmosphereShader);
 }
 
@@ -71,40 +68,45 @@ bool Model::init(
     logger().error("Failed to parse atmosphere parameters: {}", e.what());
   }
 
-  // Load the precomputed textures.
-  mPhaseTexture = std::get<0>(utils::read2DTexture(settings.mDataDirectory + "/phase.tif"));
+  // Load the precomputed textures. They are shared with all other atmospheres using the same data
+  // directory.
+  auto loadingStart = std::chrono::steady_clock::now();
 
-  {
-    auto const [t, s]     = utils::read2DTexture(settings.mDataDirectory + "/transmittance.tif");
-    mTransmittanceTexture = t;
-    mTransmittanceTextureWidth  = s.x;
-    mTransmittanceTextureHeight = s.y;
-  }
-
-  {
-    auto const [t, s] = utils::read2DTexture(settings.mDataDirectory + "/indirect_illuminance.tif");
-    mIrradianceTexture       = t;
-    mIrradianceTextureWidth  = s.x;
-    mIrradianceTextureHeight = s.y;
-  }
-
-  {
-    auto const [t, s] = utils::read3DTexture(settings.mDataDirectory + "/multiple_scattering.tif");
-    mMultipleScatteringTexture = t;
-    mScatteringTextureNuSize   = meta.mScatteringTextureNuSize;
-    mScatteringTextureMuSSize  = s.x / mScatteringTextureNuSize;
-    mScatteringTextureMuSize   = s.y;
-    mScatteringTextureRSize    = s.z;
-  }
-
-  mSingleAerosolsScatteringTexture = std::get<0>(
-      utils::read3DTexture(settings.mDataDirectory + "/single_aerosols_scattering.tif"));
+  mPhaseTexture         = TableRegistry::load2D(settings.mDataDirectory + "/phase.tif");
+  mTransmittanceTexture = TableRegistry::load2D(settings.mDataDirectory + "/transmittance.tif");
+  mIrradianceTexture =
+      TableRegistry::load2D(settings.mDataDirectory + "/indirect_illuminance.tif");
+  mMultipleScatteringTexture =
+      TableRegistry::load3D(settings.mDataDirectory + "/multiple_scattering.tif");
+  mSingleAerosolsScatteringTexture =
+      TableRegistry::load3D(settings.mDataDirectory + "/single_aerosols_scattering.tif");
 
   if (meta.mRefraction) {
     mThetaDeviationTexture =
-        std::get<0>(utils::read2DTexture(settings.mDataDirectory + "/theta_deviation.tif"));
+        TableRegistry::load2D(settings.mDataDirectory + "/theta_deviation.tif");
+  } else {
+    mThetaDeviationTexture.reset();
   }
 
+  logger().debug("Loaded precomputed textures from '{}' in {:.1f} ms.", settings.mDataDirectory,
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadingStart)
+          .count());
+
+  // If a texture failed to load, an error has been printed already. We use zero-sized textures in
+  // this case.
+  auto getSize = [](std::shared_ptr<TableRegistry::Table const> const& table) {
+    return table ? table->mSize : glm::ivec3(0);
+  };
+
+  mTransmittanceTextureWidth  = getSize(mTransmittanceTexture).x;
+  mTransmittanceTextureHeight = getSize(mTransmittanceTexture).y;
+  mIrradianceTextureWidth     = getSize(mIrradianceTexture).x;
+  mIrradianceTextureHeight    = getSize(mIrradianceTexture).y;
+  mScatteringTextureNuSize    = meta.mScatteringTextureNuSize;
+  mScatteringTextureMuSSize   = getSize(mMultipleScatteringTexture).x / mScatteringTextureNuSize;
+  mScatteringTextureMuSize    = getSize(mMultipleScatteringTexture).y;
+  mScatteringTextureRSize     = getSize(mMultipleScatteringTexture).z;
+
   // Now create the shader. We load the common and model glsl files and concatenate them with the
   // some constants and the metadata.
 
@@ -152,30 +154,34 @@ GLuint Model::getShader() const {
 
 GLuint Model::setUniforms(GLuint program, GLuint startTextureUnit) const {
 
+  auto getTexture = [](std::shared_ptr<TableRegistry::Table const> const& table) {
+    return table ? table->mTexture : 0U;
+  };
+
   glActiveTexture(GL_TEXTURE0 + startTextureUnit + 0);
-  glBindTexture(GL_TEXTURE_2D, mPhaseTexture);
+  glBindTexture(GL_TEXTURE_2D, getTexture(mPhaseTexture));
   glUniform1i(glGetUniformLocation(program, "uPhaseTexture"), startTextureUnit + 0);
 
   glActiveTexture(GL_TEXTURE0 + startTextureUnit + 1);
-  glBindTexture(GL_TEXTURE_2D, mTransmittanceTexture);
+  glBindTexture(GL_TEXTURE_2D, getTexture(mTransmittanceTexture));
   glUniform1i(glGetUniformLocation(program, "uTransmittanceTexture"), startTextureUnit + 1);
 
   glActiveTexture(GL_TEXTURE0 + startTextureUnit + 2);
-  glBindTexture(GL_TEXTURE_3D, mMultipleScatteringTexture);
+  glBindTexture(GL_TEXTURE_3D, getTexture(mMultipleScatteringTexture));
   glUniform1i(glGetUniformLocation(program, "uMultipleScatteringTexture"), startTextureUnit + 2);
 
   glActiveTexture(GL_TEXTURE0 + startTextureUnit + 3);
-  glBindTexture(GL_TEXTURE_2D, mIrradianceTexture);
+  glBindTexture(GL_TEXTURE_2D, getTexture(mIrradianceTexture));
   glUniform1i(glGetUniformLocation(program, "uIrradianceTexture"), startTextureUnit + 3);
 
   glActiveTexture(GL_TEXTURE0 + startTextureUnit + 4);
-  glBindTexture(GL_TEXTURE_3D, mSingleAerosolsScatteringTexture);
+  glBindTexture(GL_TEXTURE_3D, getTexture(mSingleAerosolsScatteringTexture));
   glUniform1i(
       glGetUniformLocation(program, "uSingleAerosolsScatteringTexture"), startTextureUnit + 4);
 
   if (mThetaDeviationTexture) {
     glActiveTexture(GL_TEXTURE0 + startTextureUnit + 5);
-    glBindTexture(GL_TEXTURE_2D, mThetaDeviationTexture);
+    glBindTexture(GL_TEXTURE_2D, mThetaDeviationTexture->mTexture);
     glUniform1i(glGetUniformLocation(program, "uThetaDeviationTexture"), startTextureUnit + 5);
   }
 
@@ -10,6 +10,7 @@
 
 #include "../../../../src/cs-core/Settings.hpp"
 #include "../../ModelBase.hpp"
+#include "../../TableRegistry.hpp"
 
 namespace csp::atmospheres::models::bruneton {
 
@@ -59,13 +60,13 @@ class Model : public ModelBase {
   // To optimize resource usage, this texture stores single molecule-scattering plus all
   // multiple-scattering contributions. The single aerosols scattering is stored in an extra
   // texture.
-  GLuint mMultipleScatteringTexture       = 0;
-  GLuint mSingleAerosolsScatteringTexture = 0;
+  std::shared_ptr<TableRegistry::Table const> mMultipleScatteringTexture;
+  std::shared_ptr<TableRegistry::Table const> mSingleAerosolsScatteringTexture;
 
-  GLuint mPhaseTexture          = 0;
-  GLuint mTransmittanceTexture  = 0;
-  GLuint mThetaDeviationTexture = 0;
-  GLuint mIrradianceTexture     = 0;
+  std::shared_ptr<TableRegistry::Table const> mPhaseTexture;
+  std::shared_ptr<TableRegistry::Table const> mTransmittanceTexture;
+  std::shared_ptr<TableRegistry::Table const> mThetaDeviationTexture;
+  std::shared_ptr<TableRegistry::Table const> mIrradianceTexture;
 
   GLuint mAtmosphereShader = 0;
 };
@@ -0,0 +1,113 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#ifndef CSP_ATMOSPHERES_TABLES_HPP
+#define CSP_ATMOSPHERES_TABLES_HPP
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <tiffio.h>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// This header is shared between the plugin and the bruneton-preprocessor. It contains functions for
+// reading and writing the precomputed lookup tables of the atmosphere models. Besides TIFF files,
+// the tables can be stored in a raw binary format which can be memory-mapped and uploaded to the
+// GPU with a single call.
+
+namespace csp::atmospheres::tables {
+
+// The binary files start with this header. It is followed by width * height * depth RGB pixels
+// stored as 32 bit floats.
+struct BinaryHeader {
+  std::array<char, 4> mMagic{'C', 'S', 'A', 'T'};
+  uint32_t            mVersion  = 1;
+  uint32_t            mWidth    = 0;
+  uint32_t            mHeight   = 0;
+  uint32_t            mDepth    = 0;
+  uint32_t            mChannels = 3;
+};
+
+static_assert(sizeof(BinaryHeader) == 24, "The binary table header must not contain padding!");
+
+// Returns the path of the binary file which corresponds to the given TIFF file. For instance,
+// "output/earth/phase.tif" becomes "output/earth/phase.bin".
+inline std::string getBinaryPath(std::string const& tiffPath) {
+  return tiffPath.substr(0, tiffPath.rfind('.')) + ".bin";
+}
+
+// Returns true if the given header is valid and describes an RGB table with the given number of
+// bytes following the header.
+inline bool isValid(BinaryHeader const& header, size_t dataSize) {
+  BinaryHeader reference;
+  return header.mMagic == reference.mMagic && header.mVersion == reference.mVersion &&
+         header.mChannels == 3 &&
+         dataSize >= sizeof(float) * header.mChannels * header.mWidth * header.mHeight *
+                         static_cast<size_t>(header.mDepth);
+}
+
+// Writes a binary table. For 2D tables, size.z should be one. Returns false if the file could not
+// be written.
+inline bool writeBinary(std::string const& path, glm::ivec3 const& size, float const* data) {
+  BinaryHeader header;
+  header.mWidth  = static_cast<uint32_t>(size.x);
+  header.mHeight = static_cast<uint32_t>(size.y);
+  header.mDepth  = static_cast<uint32_t>(size.z);
+
+  std::ofstream file(path, std::ios::out | std::ios::binary);
+  if (!file) {
+    return false;
+  }
+
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  file.write(reinterpret_cast<char const*>(&header), sizeof(BinaryHeader));
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  file.write(reinterpret_cast<char const*>(data),
+      static_cast<std::streamsize>(sizeof(float) * 3 * size.x * size.y * size.z));
+
+  return file.good();
+}
+
+// Reads a 2D or 3D RGB float TIFF file. Each page of the TIFF file is one layer of the table.
+// Returns false if the file could not be opened.
+inline bool readTIFF(std::string const& path, glm::ivec3& size, std::vector<float>& data) {
+  auto* tiff = TIFFOpen(path.c_str(), "r");
+
+  if (!tiff) {
+    return false;
+  }
+
+  uint32_t width{};
+  uint32_t height{};
+
+  TIFFGetField(tiff, TIFFTAG_IMAGELENGTH, &height);
+  TIFFGetField(tiff, TIFFTAG_IMAGEWIDTH, &width);
+
+  uint32_t depth = TIFFNumberOfDirectories(tiff);
+
+  data.resize(static_cast<size_t>(width) * height * depth * 3);
+
+  for (uint32_t z = 0; z < depth; z++) {
+    TIFFSetDirectory(tiff, z);
+    for (uint32_t y = 0; y < height; y++) {
+      TIFFReadScanline(tiff, &data[3 * width * (y + height * static_cast<size_t>(z))], y);
+    }
+  }
+
+  TIFFClose(tiff);
+
+  size = glm::ivec3(width, height, depth);
+
+  return true;
+}
+
+} // namespace csp::atmospheres::tables
+
+#endif // CSP_ATMOSPHERES_TABLES_HPP
@@ -8,35 +8,43 @@
 #include "utils.hpp"
 
 #include "logger.hpp"
+#include "tables.hpp"
 
-#include <tiffio.h>
+#include <vector>
 
 namespace csp::atmospheres::utils {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 std::tuple<GLuint, glm::ivec2> read2DTexture(std::string const& path) {
-  auto* data = TIFFOpen(path.c_str(), "r");
+  glm::ivec3         size;
+  std::vector<float> pixels;
 
-  if (!data) {
+  if (!tables::readTIFF(path, size, pixels)) {
     logger().error("Failed to open TIFF file '{}'", path);
     return {0u, {0, 0}};
   }
 
-  uint32_t width{};
-  uint32_t height{};
+  return {upload2DTexture(size.x, size.y, pixels.data()), {size.x, size.y}};
+}
 
-  TIFFGetField(data, TIFFTAG_IMAGELENGTH, &height);
-  TIFFGetField(data, TIFFTAG_IMAGEWIDTH, &width);
+////////////////////////////////////////////////////////////////////////////////////////////////////
 
-  std::vector<float> pixels(width * height * 3);
+std::tuple<GLuint, glm::ivec3> read3DTexture(std::string const& path) {
+  glm::ivec3         size;
+  std::vector<float> pixels;
 
-  for (unsigned y = 0; y < height; y++) {
-    TIFFReadScanline(data, &pixels[width * 3 * y], y);
+  if (!tables::readTIFF(path, size, pixels)) {
+    logger().error("Failed to open TIFF file '{}'", path);
+    return {0u, {0, 0, 0}};
   }
 
-  TIFFClose(data);
+  return {upload3DTexture(size.x, size.y, size.z, pixels.data()), size};
+}
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+GLuint upload2DTexture(int32_t width, int32_t height, float const* pixels) {
   GLuint texture;
   glGenTextures(1, &texture);
   glActiveTexture(GL_TEXTURE0);
@@ -46,43 +54,14 @@ std::tuple<GLuint, glm::ivec2> read2DTexture(std::string const& path) {
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F, width, height, 0, GL_RGB, GL_FLOAT, pixels.data());
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F, width, height, 0, GL_RGB, GL_FLOAT, pixels);
 
-  return {texture, {width, height}};
+  return texture;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-std::tuple<GLuint, glm::ivec3> read3DTexture(std::string const& path) {
-  auto* data = TIFFOpen(path.c_str(), "r");
-
-  if (!data) {
-    logger().error("Failed to open TIFF file '{}'", path);
-    return {0u, {0, 0, 0}};
-  }
-
-  uint32_t width{};
-  uint32_t height{};
-  uint32_t depth{};
-
-  TIFFGetField(data, TIFFTAG_IMAGELENGTH, &height);
-  TIFFGetField(data, TIFFTAG_IMAGEWIDTH, &width);
-
-  do {
-    depth++;
-  } while (TIFFReadDirectory(data));
-
-  std::vector<float> pixels(width * height * depth * 3);
-
-  for (unsigned z = 0; z < depth; z++) {
-    TIFFSetDirectory(data, z);
-    for (unsigned y = 0; y < height; y++) {
-      TIFFReadScanline(data, &pixels[width * 3 * y + (3 * width * height * z)], y);
-    }
-  }
-
-  TIFFClose(data);
-
+GLuint upload3DTexture(int32_t width, int32_t height, int32_t depth, float const* pixels) {
   GLuint texture;
   glGenTextures(1, &texture);
   glActiveTexture(GL_TEXTURE0);
@@ -93,10 +72,9 @@ std::tuple<GLuint, glm::ivec3> read3DTexture(std::string const& path) {
   glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
   glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
-  glTexImage3D(
-      GL_TEXTURE_3D, 0, GL_RGB32F, width, height, depth, 0, GL_RGB, GL_FLOAT, pixels.data());
+  glTexImage3D(GL_TEXTURE_3D, 0, GL_RGB32F, width, height, depth, 0, GL_RGB, GL_FLOAT, pixels);
 
-  return {texture, {width, height, depth}};
+  return texture;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
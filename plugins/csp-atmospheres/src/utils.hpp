@@ -9,6 +9,7 @@
 #define CSP_ATMOSPHERES_UTILS_HPP
 
 #include <GL/glew.h>
+#include <cstdint>
 #include <string>
 #include <tuple>
 
@@ -25,6 +26,11 @@ std::tuple<GLuint, glm::ivec2> read2DTexture(std::string const& path);
 // used for the single scattering texture. It returns a tuple containing the OpenGL texture handle
 // and size of the texture.
 std::tuple<GLuint, glm::ivec3> read3DTexture(std::string const& path);
+
+// Creates a 2D or 3D texture from the given RGB float pixels. The textures use linear filtering and
+// are clamped to the edges. The caller is responsible for deleting the returned texture.
+GLuint upload2DTexture(int32_t width, int32_t height, float const* pixels);
+GLuint upload3DTexture(int32_t width, int32_t height, int32_t depth, float const* pixels);
 } // namespace csp::atmospheres::utils
 
 #endif // CSP_ATMOSPHERES_UTILS_HPP
@@ -145,14 +145,15 @@ std::shared_ptr<TileSource> const& LodBody::getIMGtileSource() const {
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void LodBody::setObjectName(std::string objectName) {
-  mShader.setObjectName(objectName);
-  mObjectName = std::move(objectName);
+  mObject     = mSolarSystem->getObjectHandle(objectName);
+  mTimerRange = cs::utils::FrameStats::RangeId("LoD-Body " + objectName);
+  mShader.setObjectName(std::move(objectName));
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 std::string const& LodBody::getObjectName() const {
-  return mObjectName;
+  return mObject.getName();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -164,8 +165,8 @@ void LodBody::setLODFactor(float lodFactor) {
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void LodBody::update() {
-  auto parent  = mSolarSystem->getObject(mObjectName);
-  bool visible = parent && parent->getIsBodyVisible();
+  auto const& parent  = mObject.get();
+  bool        visible = parent && parent->getIsBodyVisible();
 
   mPlanet.setEnabled(visible);
 
@@ -190,10 +191,9 @@ void LodBody::update() {
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 bool LodBody::Do() {
-  auto                                           timerName = "LoD-Body " + mObjectName;
-  cs::utils::FrameStats::ScopedTimer             timer(timerName);
-  cs::utils::FrameStats::ScopedSamplesCounter    samplesCounter(timerName);
-  cs::utils::FrameStats::ScopedPrimitivesCounter primitivesCounter(timerName);
+  cs::utils::FrameStats::ScopedTimer             timer(mTimerRange);
+  cs::utils::FrameStats::ScopedSamplesCounter    samplesCounter(mTimerRange);
+  cs::utils::FrameStats::ScopedPrimitivesCounter primitivesCounter(mTimerRange);
 
   mPlanet.draw();
 
@@ -8,9 +8,11 @@
 #ifndef CSP_LOD_BODIES_LOD_PLANET_HPP
 #define CSP_LOD_BODIES_LOD_PLANET_HPP
 
+#include "../../../src/cs-core/ObjectHandle.hpp"
 #include "../../../src/cs-graphics/Shadows.hpp"
 #include "../../../src/cs-scene/CelestialSurface.hpp"
 #include "../../../src/cs-scene/IntersectableObject.hpp"
+#include "../../../src/cs-utils/FrameStats.hpp"
 
 #include "PlanetShader.hpp"
 #include "TileSource.hpp"
@@ -94,7 +96,8 @@ class LodBody : public cs::scene::CelestialSurface,
   std::shared_ptr<TileSource>                      mIMGtileSource;
   std::shared_ptr<cs::core::EclipseShadowReceiver> mEclipseShadowReceiver;
 
-  std::string mObjectName;
+  cs::core::ObjectHandle         mObject;
+  cs::utils::FrameStats::RangeId mTimerRange;
 
   VistaPlanet  mPlanet;
   PlanetShader mShader;
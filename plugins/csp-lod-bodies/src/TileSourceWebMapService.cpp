@@ -11,6 +11,7 @@
 #include "TileNode.hpp"
 #include "logger.hpp"
 
+#include "../../../src/cs-utils/FrameStats.hpp"
 #include "../../../src/cs-utils/filesystem.hpp"
 #include "../../../src/cs-utils/utils.hpp"
 
@@ -231,8 +232,7 @@ std::mutex TileSourceWebMapService::mFileSystemMutex;
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 TileSourceWebMapService::TileSourceWebMapService(uint32_t resolution)
-    : mThreadPool(32)
-    , mResolution(resolution) {
+    : mResolution(resolution) {
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -426,7 +426,10 @@ std::optional<std::string> TileSourceWebMapService::loadData(TileId const& tileI
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 /* virtual */ void TileSourceWebMapService::loadTileAsync(TileId const& tileId, OnLoadCallback cb) {
-  mThreadPool.enqueue([=]() {
+  mTasks.enqueue([=, flowID = cs::utils::FrameStats::startFlow()]() {
+    static const cs::utils::FrameStats::RangeId range("Load WMS Tile");
+    cs::utils::FrameStats::ScopedTrace           trace(range, flowID);
+
     auto tile = loadTile(tileId);
     cb(tileId, std::move(tile));
   });
@@ -435,7 +438,7 @@ std::optional<std::string> TileSourceWebMapService::loadData(TileId const& tileI
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 int TileSourceWebMapService::getPendingRequests() {
-  return static_cast<int>(mThreadPool.getPendingTaskCount() + mThreadPool.getRunningTaskCount());
+  return static_cast<int>(mTasks.getPendingTaskCount() + mTasks.getRunningTaskCount());
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
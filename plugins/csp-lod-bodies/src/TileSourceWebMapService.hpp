@@ -73,12 +73,15 @@ class TileSourceWebMapService : public TileSource {
  private:
   static std::mutex mFileSystemMutex;
 
-  cs::utils::ThreadPool mThreadPool;
-  std::string           mUrl;
-  std::string           mCache = "cache/img";
-  std::string           mLayers;
-  TileDataType          mFormat = TileDataType::eColor;
-  uint32_t              mResolution;
+  std::string  mUrl;
+  std::string  mCache = "cache/img";
+  std::string  mLayers;
+  TileDataType mFormat = TileDataType::eColor;
+  uint32_t     mResolution;
+
+  // The tiles are loaded on the I/O ThreadPool. This is declared last so that pending requests
+  // are finished before the members above are destroyed.
+  cs::utils::TaskGroup mTasks{cs::utils::ThreadPool::getIO()};
 };
 } // namespace csp::lodbodies
 
@@ -12,9 +12,15 @@
 #include "../../../src/cs-core/SolarSystem.hpp"
 #include "../../../src/cs-core/TimeControl.hpp"
 #include "../../../src/cs-utils/convert.hpp"
+#include "../../../src/cs-utils/filesystem.hpp"
 #include "../../../src/cs-utils/logger.hpp"
 #include "logger.hpp"
 
+#include <VistaKernel/DisplayManager/VistaDisplayManager.h>
+#include <VistaKernel/DisplayManager/VistaWindow.h>
+#include <VistaKernel/VistaSystem.h>
+#include <array>
+#include <boost/filesystem.hpp>
 #include <iostream>
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -36,14 +42,12 @@ namespace csp::recorder {
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void from_json(nlohmann::json const& j, Plugin::Settings& o) {
-  cs::core::Settings::deserialize(j, "webAPIPort", o.mWebAPIPort);
   cs::core::Settings::deserialize(j, "recordObserver", o.mRecordObserver);
   cs::core::Settings::deserialize(j, "recordTime", o.mRecordTime);
   cs::core::Settings::deserialize(j, "recordExposure", o.mRecordExposure);
 }
 
 void to_json(nlohmann::json& j, Plugin::Settings const& o) {
-  cs::core::Settings::serialize(j, "webAPIPort", o.mWebAPIPort);
   cs::core::Settings::serialize(j, "recordObserver", o.mRecordObserver);
   cs::core::Settings::serialize(j, "recordTime", o.mRecordTime);
   cs::core::Settings::serialize(j, "recordExposure", o.mRecordExposure);
@@ -81,6 +85,15 @@ void Plugin::init() {
         }
       }));
 
+  // Plays back a recording and writes the rendered frames to an image sequence. If no file is
+  // given, the last recording of this session is used.
+  mGuiManager->getGui()->registerCallback("recorder.renderRecording",
+      "Renders the frames of the given recording file to an image sequence. The optional second "
+      "argument specifies the image format ('png', 'jpeg' or 'tiff', default is 'png').",
+      std::function([this](std::optional<std::string> file, std::optional<std::string> format) {
+        startPlayback(file.value_or(mLastRecording), format.value_or("png"));
+      }));
+
   // Add a callback to toggle recording of the observer transformation.
   mGuiManager->getGui()->registerCallback("recorder.setRecordObserver",
       "Enables or disables recording of the observer transformation.",
@@ -118,9 +131,6 @@ void Plugin::update() {
     // the current recording session. So open the file!
     if (!mOutFile.is_open()) {
 
-      // Reset the frame counter.
-      mFrameCounter = 0;
-
       // We use the current date as a filename.
       auto timeString =
           cs::utils::convert::time::toString(boost::posix_time::microsec_clock::local_time());
@@ -129,75 +139,48 @@ void Plugin::update() {
       cs::utils::replaceString(timeString, "T", "-");
       cs::utils::replaceString(timeString, "Z", "");
 
-      mOutFile.open("recording-" + timeString + ".py");
-
-      // Write the header of the file. This contains the functions which are then called for each
-      // recorded frame.
-      mOutFile << R"(#! python3
-
-# This file has been automatically created by the csp-recorder plugin of CosmoScout VR.
-# You can execute the script while CosmoScout VR is running. It will use the csp-web-api
-# plugin to capture an image for each recorded frame.
-
-import requests
-
-# The CosmoScout server instance.
-cosmoscout = "http://localhost:)" +
-                      std::to_string(mPluginSettings.mWebAPIPort.get()) + R"("
-
-# Simple one-liner to call JavaScript code on the CosmoScout VR side.
-def runJS(code):
-  requests.post(cosmoscout + "/run-js", code)
+      mLastRecording = "recording-" + timeString + ".jsonl";
+      mOutFile.open(mLastRecording);
+    }
 
-# Use this to capture a screenshot. The file can be a relative or absolute path to a png image,
-# but the directory must exist.
-def capture(file):
-  r = requests.get(cosmoscout + "/capture?delay=1&format=png")
-  with open(file, 'wb') as f:
-    f.write(r.content)
+    // Now that the output file is initialized, we can write the information for each frame. Each
+    // frame is stored as a single line of JSON. Only the recorded properties are included.
+    nlohmann::json frame;
 
-)" << std::endl;
-    }
+    if (mPluginSettings.mRecordObserver.get()) {
+      auto const& position = mAllSettings->mObserver.pPosition.get();
+      auto const& rotation = mAllSettings->mObserver.pRotation.get();
 
-    // Now that the output file is initialized, we can write the information for each frame. Here we
-    // write a call navigation.setBodyFull() setting the current full observer transformation.
-    if (mPluginSettings.mRecordTime.get()) {
-      mOutFile << fmt::format("runJS(\"CosmoScout.callbacks.navigation.setBodyFull('{}', '{}', "
-                              "{}, {}, {}, {}, {}, {}, {}, 0);\")",
-                      mAllSettings->mObserver.pCenter.get(), mAllSettings->mObserver.pFrame.get(),
-                      mAllSettings->mObserver.pPosition.get().x,
-                      mAllSettings->mObserver.pPosition.get().y,
-                      mAllSettings->mObserver.pPosition.get().z,
-                      mAllSettings->mObserver.pRotation.get().x,
-                      mAllSettings->mObserver.pRotation.get().y,
-                      mAllSettings->mObserver.pRotation.get().z,
-                      mAllSettings->mObserver.pRotation.get().w)
-               << std::endl;
+      frame["center"]   = mAllSettings->mObserver.pCenter.get();
+      frame["frame"]    = mAllSettings->mObserver.pFrame.get();
+      frame["position"] = {position.x, position.y, position.z};
+      frame["rotation"] = {rotation.x, rotation.y, rotation.z, rotation.w};
     }
 
-    // Record the time if required.
+    // Record the time if required. It is stored in TDB to avoid any rounding.
     if (mPluginSettings.mRecordTime.get()) {
-      mOutFile << "runJS(\"CosmoScout.callbacks.time.setDate('"
-               << cs::utils::convert::time::toString(mTimeControl->pSimulationTime.get())
-               << "');\")" << std::endl;
+      frame["time"] = mTimeControl->pSimulationTime.get();
     }
 
     // Record the HDR exposure if required.
     if (mPluginSettings.mRecordExposure.get()) {
-      mOutFile << "runJS(\"CosmoScout.callbacks.graphics.setExposure("
-               << mAllSettings->mGraphics.pExposure.get() << ");\")" << std::endl;
+      frame["exposure"] = mAllSettings->mGraphics.pExposure.get();
     }
 
-    // In any case, capture an image.
-    mOutFile << "capture('frame_" << mFrameCounter++ << ".png')" << std::endl << std::endl;
+    mOutFile << frame.dump() << std::endl;
 
   } else {
 
     // Recording has stopped last frame, so close the output file.
     if (mOutFile.is_open()) {
       mOutFile.close();
+      logger().info("Recording has been written to '{}'.", mLastRecording);
     }
   }
+
+  if (mFrameCapture) {
+    updatePlayback();
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -208,11 +191,19 @@ void Plugin::deInit() {
   // Save settings as this plugin may get reloaded.
   onSave();
 
+  // Abort any playback which is currently in progress.
+  if (mFrameCapture) {
+    mAllSettings->pTimeSpeed                    = mRestoreTimeSpeed;
+    mAllSettings->mGraphics.pEnableAutoExposure = mRestoreAutoExposure;
+    mFrameCapture.reset();
+  }
+
   // Clean up the side-bar.
   mGuiManager->removeSettingsSection("Recorder");
 
   // Unregister all callbacks.
   mGuiManager->getGui()->unregisterCallback("recorder.toggleRecording");
+  mGuiManager->getGui()->unregisterCallback("recorder.renderRecording");
   mGuiManager->getGui()->unregisterCallback("recorder.setRecordObserver");
   mGuiManager->getGui()->unregisterCallback("recorder.setRecordTime");
   mGuiManager->getGui()->unregisterCallback("recorder.setRecordExposure");
@@ -233,6 +224,164 @@ void Plugin::deInit() {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void Plugin::startPlayback(std::string const& file, std::string const& format) {
+  if (mFrameCapture) {
+    logger().warn("Cannot render '{}': Another recording is currently being rendered!", file);
+    return;
+  }
+
+  auto captureFormat = cs::graphics::FrameCapture::parseFormat(format);
+  if (!captureFormat || captureFormat == cs::graphics::FrameCapture::Format::eRaw) {
+    logger().warn("Cannot render '{}': Only 'png', 'jpeg' or 'tiff' are supported!", file);
+    return;
+  }
+
+  std::ifstream input(file);
+  if (file.empty() || !input) {
+    logger().warn("Cannot render '{}': Failed to open the recording!", file);
+    return;
+  }
+
+  mPlaybackFrames.clear();
+
+  try {
+    std::string line;
+    while (std::getline(input, line)) {
+      if (!line.empty()) {
+        mPlaybackFrames.push_back(nlohmann::json::parse(line));
+      }
+    }
+  } catch (std::exception const& e) {
+    logger().warn("Cannot render '{}': {}", file, e.what());
+    mPlaybackFrames.clear();
+    return;
+  }
+
+  if (mPlaybackFrames.empty()) {
+    logger().warn("Cannot render '{}': The recording is empty!", file);
+    return;
+  }
+
+  // The frames are written to a directory next to the recording which has the same name.
+  mPlaybackDirectory = boost::filesystem::path(file).replace_extension().string();
+  mPlaybackExtension = format == "jpeg" ? "jpg" : format;
+  mPlaybackFormat    = *captureFormat;
+  cs::utils::filesystem::createDirectoryRecursively(mPlaybackDirectory);
+
+  logger().info("Rendering {} frames of '{}' to '{}'...", mPlaybackFrames.size(), file,
+      mPlaybackDirectory);
+
+  // The simulation time must not advance during playback. Else it would depend on the frame rate.
+  mRestoreTimeSpeed        = mAllSettings->pTimeSpeed.get();
+  mRestoreAutoExposure     = mAllSettings->mGraphics.pEnableAutoExposure.get();
+  mAllSettings->pTimeSpeed = 0.F;
+
+  mFrameCapture  = std::make_unique<cs::graphics::FrameCapture>();
+  mPlaybackFrame = 0;
+  mPlaybackStart = std::chrono::steady_clock::now();
+
+  applyFrame(mPlaybackFrames.front());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Plugin::updatePlayback() {
+  mFrameCapture->update();
+
+  // The state is applied after the SolarSystem has been updated for the current frame, so the
+  // current frame is not yet entirely consistent. Hence we render one more frame before reading
+  // the pixels.
+  if (mPlaybackDelay > 0) {
+    --mPlaybackDelay;
+    return;
+  }
+
+  if (mPlaybackFrame < mPlaybackFrames.size()) {
+
+    // If all pixel buffers are in use, we simply render the same state once more.
+    if (!mFrameCapture->canRead()) {
+      return;
+    }
+
+    int32_t width  = 0;
+    int32_t height = 0;
+    auto*   window = GetVistaSystem()->GetDisplayManager()->GetWindows().begin()->second;
+    window->GetWindowProperties()->GetSize(width, height);
+
+    auto path =
+        fmt::format("{}/frame_{}.{}", mPlaybackDirectory, mPlaybackFrame, mPlaybackExtension);
+
+    // The encoded image is written on the worker thread.
+    cs::graphics::FrameCapture::Request request;
+    request.mFormat = mPlaybackFormat;
+    request.mOnDone = [pendingWrites = mPendingWrites, path](std::vector<std::byte>&& data) {
+      std::ofstream output(path, std::ios::binary);
+      output.write(reinterpret_cast<char const*>(data.data()), // NOLINT(*-reinterpret-cast)
+          static_cast<std::streamsize>(data.size()));
+
+      if (data.empty() || !output) {
+        logger().warn("Failed to write frame '{}'!", path);
+      }
+
+      --(*pendingWrites);
+    };
+
+    ++(*mPendingWrites);
+    mFrameCapture->read(width, height, std::move(request));
+
+    if (++mPlaybackFrame < mPlaybackFrames.size()) {
+      applyFrame(mPlaybackFrames[mPlaybackFrame]);
+    }
+
+    return;
+  }
+
+  // All frames have been read. We wait until they have been written to disc and report the
+  // achieved frame rate.
+  if (*mPendingWrites > 0) {
+    return;
+  }
+
+  double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - mPlaybackStart).count();
+
+  logger().info("Rendered {} frames in {:.1f} s ({:.1f} frames per second).",
+      mPlaybackFrames.size(), seconds, static_cast<double>(mPlaybackFrames.size()) / seconds);
+
+  mAllSettings->pTimeSpeed                    = mRestoreTimeSpeed;
+  mAllSettings->mGraphics.pEnableAutoExposure = mRestoreAutoExposure;
+
+  mPlaybackFrames.clear();
+  mFrameCapture.reset();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Plugin::applyFrame(nlohmann::json const& frame) {
+  if (frame.contains("center")) {
+    auto position = frame.at("position").get<std::array<double, 3>>();
+    auto rotation = frame.at("rotation").get<std::array<double, 4>>();
+
+    mSolarSystem->flyObserverTo(frame.at("center").get<std::string>(),
+        frame.at("frame").get<std::string>(), glm::dvec3(position[0], position[1], position[2]),
+        glm::dquat(rotation[3], rotation[0], rotation[1], rotation[2]), 0.0);
+  }
+
+  if (frame.contains("time")) {
+    mTimeControl->setTime(frame.at("time").get<double>());
+  }
+
+  // A recorded exposure can only be applied if auto-exposure is disabled.
+  if (frame.contains("exposure")) {
+    mAllSettings->mGraphics.pEnableAutoExposure = false;
+    mAllSettings->mGraphics.pExposure           = frame.at("exposure").get<float>();
+  }
+
+  mPlaybackDelay = 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 void Plugin::onLoad() {
   // Read settings from JSON.
   from_json(mAllSettings->mPlugins.at("csp-recorder"), mPluginSettings);
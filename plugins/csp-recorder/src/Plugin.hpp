@@ -10,26 +10,29 @@
 
 #include "../../../src/cs-core/PluginBase.hpp"
 #include "../../../src/cs-core/Settings.hpp"
+#include "../../../src/cs-graphics/FrameCapture.hpp"
 #include "../../../src/cs-utils/Property.hpp"
 
+#include <atomic>
+#include <chrono>
 #include <fstream>
+#include <memory>
+#include <vector>
 
 namespace csp::recorder {
 
-/// This plugin allows basic capturing of high-quality videos using csp-web-api. 'Basic' means that
-/// (for now) only the observer transformation, the simulation time and the exposure of the HDR mode
-/// is captured. This however, can be changed in the future.
+/// This plugin allows basic capturing of high-quality videos. 'Basic' means that (for now) only the
+/// observer transformation, the simulation time and the exposure of the HDR mode is captured. This
+/// however, can be changed in the future.
 /// Capturing works in two phases: First, the user navigates through space while 'recording'. This
-/// produces a python script in the bin/ directory which can be executed to capture the individual
-/// frame using csp-web-api. This two-step approach has the advantage that recording can be done at
-/// high frame rates (with all settings reduced to the bare minimum) while capturing can be done at
-/// high resolution and high quality.
+/// produces a JSON-lines file in the bin/ directory which contains the recorded state of each
+/// frame. Then, this file is played back in-process: The state of each recorded frame is applied
+/// one after another and the rendered frames are written to an image sequence. This two-step
+/// approach has the advantage that recording can be done at high frame rates (with all settings
+/// reduced to the bare minimum) while capturing can be done at high resolution and high quality.
 class Plugin : public cs::core::PluginBase {
  public:
   struct Settings {
-    /// This should be set to the port of csp-web-api.
-    cs::utils::Property<uint16_t> mWebAPIPort;
-
     /// These can be toggled via the user interface.
     cs::utils::DefaultProperty<bool> mRecordObserver{true};
     cs::utils::DefaultProperty<bool> mRecordTime{true};
@@ -44,11 +47,31 @@ class Plugin : public cs::core::PluginBase {
   void onLoad();
   void onSave();
 
+  void startPlayback(std::string const& file, std::string const& format);
+  void updatePlayback();
+  void applyFrame(nlohmann::json const& frame);
+
   Settings mPluginSettings;
 
   bool          mRecording = false;
   std::ofstream mOutFile;
-  uint32_t      mFrameCounter = 0;
+  std::string   mLastRecording;
+
+  // Members for the playback of recordings. The state of mPlaybackFrame is currently applied. It is
+  // read back once mPlaybackDelay frames have been rendered with this state.
+  std::vector<nlohmann::json>                 mPlaybackFrames;
+  size_t                                      mPlaybackFrame = 0;
+  int32_t                                     mPlaybackDelay = 0;
+  std::string                                 mPlaybackDirectory;
+  std::string                                 mPlaybackExtension;
+  cs::graphics::FrameCapture::Format          mPlaybackFormat{};
+  std::unique_ptr<cs::graphics::FrameCapture> mFrameCapture;
+  std::chrono::steady_clock::time_point       mPlaybackStart;
+  float                                       mRestoreTimeSpeed    = 0.F;
+  bool                                        mRestoreAutoExposure = true;
+
+  // This is shared with the encoding tasks as they may outlive the plugin.
+  std::shared_ptr<std::atomic<int32_t>> mPendingWrites = std::make_shared<std::atomic<int32_t>>(0);
 
   int mOnLoadConnection = -1;
   int mOnSaveConnection = -1;
@@ -110,7 +110,7 @@ void main() {
 
 Ring::Ring(std::shared_ptr<cs::core::Settings> settings,
     std::shared_ptr<cs::core::SolarSystem> solarSystem, std::string objectName)
-    : mObjectName(std::move(objectName))
+    : mObject(solarSystem->getObjectHandle(objectName))
     , mSettings(std::move(settings))
     , mSolarSystem(std::move(solarSystem))
     , mEclipseShadowReceiver(mSettings, mSolarSystem, true) {
@@ -160,7 +160,7 @@ Ring::~Ring() {
 
 void Ring::configure(Plugin::Settings::Ring const& settings) {
   if (mRingSettings.mTexture != settings.mTexture) {
-    mTexture = cs::graphics::TextureLoader::loadFromFile(settings.mTexture);
+    mTexture = cs::graphics::TextureLoader::loadFromFileAsync(settings.mTexture);
   }
   mRingSettings = settings;
 
@@ -171,7 +171,7 @@ void Ring::configure(Plugin::Settings::Ring const& settings) {
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void Ring::update() {
-  auto object = mSolarSystem->getObject(mObjectName);
+  auto const& object = mObject.get();
 
   if (object && object->getIsBodyVisible()) {
     mEclipseShadowReceiver.update(*object);
@@ -181,7 +181,7 @@ void Ring::update() {
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 bool Ring::Do() {
-  auto object = mSolarSystem->getObject(mObjectName);
+  auto const& object = mObject.get();
   if (!object || !object->getIsBodyVisible()) {
     return true;
   }
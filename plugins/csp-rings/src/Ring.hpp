@@ -11,6 +11,7 @@
 #include "Plugin.hpp"
 
 #include "../../../src/cs-core/EclipseShadowReceiver.hpp"
+#include "../../../src/cs-core/ObjectHandle.hpp"
 #include "../../../src/cs-scene/CelestialObject.hpp"
 
 #include <VistaKernel/GraphicsManager/VistaOpenGLDraw.h>
@@ -51,14 +52,14 @@ class Ring : public cs::scene::CelestialObject, public IVistaOpenGLDraw {
   bool GetBoundingBox(VistaBoundingBox& bb) override;
 
  private:
-  std::string                            mObjectName;
+  cs::core::ObjectHandle                 mObject;
   std::shared_ptr<cs::core::Settings>    mSettings;
   std::shared_ptr<cs::core::SolarSystem> mSolarSystem;
 
   std::unique_ptr<VistaOpenGLNode> mGLNode;
 
   Plugin::Settings::Ring        mRingSettings;
-  std::unique_ptr<VistaTexture> mTexture;
+  std::shared_ptr<VistaTexture> mTexture;
   VistaGLSLShader               mShader;
   VistaVertexArrayObject        mSphereVAO;
   VistaBufferObject             mSphereVBO;
@@ -0,0 +1,80 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "../src/SGP4Propagator.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// This measures the throughput of the SGP4Propagator for a catalog of the size of all currently
+// tracked objects. The satellites are propagated either in a single batch, which is how the
+// SatelliteCatalog uses the propagator, or one at a time.
+
+using namespace csp::satellites;
+
+namespace {
+
+// This is the first test case of the verification data set of Vallado et al.
+const std::string cVanguard =
+    "VANGUARD 1\n"
+    "1 00005U 58002B   00179.78495062  .00000023  00000-0  28098-4 0  4753\n"
+    "2 00005  34.2682 348.7242 1859667 331.7664  19.3264 10.82419157413667\n";
+
+} // namespace
+
+int main() {
+  const std::size_t satelliteCount = 30000;
+  const int         iterations     = 20;
+
+  auto elements = parseTLEs(cVanguard).at(0);
+
+  // Vary the elements slightly so that the satellites do not all follow the same code path through
+  // the trigonometric functions.
+  SGP4Propagator propagator;
+  for (std::size_t i = 0; i < satelliteCount; ++i) {
+    auto e = elements;
+    e.mMeanAnomaly += 0.001 * static_cast<double>(i);
+    e.mRightAscension += 0.0001 * static_cast<double>(i);
+    propagator.add(e);
+  }
+
+  std::vector<double> x(satelliteCount), y(satelliteCount), z(satelliteCount);
+  std::vector<double> vx(satelliteCount), vy(satelliteCount), vz(satelliteCount);
+
+  auto measure = [&](std::string const& label, auto&& func) {
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < iterations; ++i) {
+      func(elements.mEpoch + i);
+    }
+
+    double ms =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+            .count() /
+        iterations;
+
+    std::cout << label << ": " << ms << " ms for " << satelliteCount << " satellites ("
+              << satelliteCount / ms << " satellites per millisecond, x[0] = " << x[0] << ")"
+              << std::endl;
+  };
+
+  measure("Batch", [&](double julianDate) {
+    propagator.propagate(julianDate, 0, satelliteCount,
+        {x.data(), y.data(), z.data(), vx.data(), vy.data(), vz.data()});
+  });
+
+  measure("One at a time", [&](double julianDate) {
+    for (std::size_t i = 0; i < satelliteCount; ++i) {
+      propagator.propagate(julianDate, i, i + 1,
+          {&x[i], &y[i], &z[i], &vx[i], &vy[i], &vz[i]});
+    }
+  });
+
+  return 0;
+}
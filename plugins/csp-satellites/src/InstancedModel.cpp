@@ -0,0 +1,74 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "InstancedModel.hpp"
+
+#include <VistaKernel/GraphicsManager/VistaSceneGraph.h>
+#include <VistaKernel/GraphicsManager/VistaTransformNode.h>
+#include <VistaKernelOpenSGExt/VistaOpenSGMaterialTools.h>
+
+#include "../../../src/cs-utils/utils.hpp"
+
+namespace csp::satellites {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+InstancedModel::InstancedModel(std::string const& modelFile, std::string const& environmentMap,
+    VistaSceneGraph* sceneGraph, std::shared_ptr<tinygltf::Model> const& preparedModel)
+    : mSceneGraph(sceneGraph)
+    , mModel(preparedModel
+                 ? std::make_unique<cs::graphics::GltfLoader>(preparedModel, environmentMap)
+                 : std::make_unique<cs::graphics::GltfLoader>(modelFile, environmentMap)) {
+
+  mModel->setIBLIntensity(1.5);
+  mModel->setLightColor(1.0, 1.0, 1.0);
+
+  // The observer-relative transformations of the satellites are given in the coordinate system of
+  // the scene graph's root. Therefore the anchor will always have an identity transformation.
+  mAnchor.reset(sceneGraph->NewTransformNode(sceneGraph->GetRoot()));
+
+  mModel->attachInstancedTo(sceneGraph, mAnchor.get());
+
+  VistaOpenSGMaterialTools::SetSortKeyOnSubtree(
+      mAnchor.get(), static_cast<int>(cs::utils::DrawOrder::eOpaqueItems));
+
+  mAnchor->SetIsEnabled(false);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+InstancedModel::~InstancedModel() {
+  mSceneGraph->GetRoot()->DisconnectChild(mAnchor.get());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void InstancedModel::clearInstances() {
+  mInstances.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void InstancedModel::addInstance(
+    glm::mat4 const& transform, glm::vec3 const& sunDirection, float sunIlluminance) {
+  mInstances.push_back({transform, sunDirection, sunIlluminance});
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void InstancedModel::flush(bool enableHDR) {
+  mAnchor->SetIsEnabled(!mInstances.empty());
+
+  if (!mInstances.empty()) {
+    mModel->setEnableHDR(enableHDR);
+    mModel->setInstances(mInstances);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace csp::satellites
@@ -0,0 +1,61 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#ifndef CSP_SATELLITES_INSTANCED_MODEL_HPP
+#define CSP_SATELLITES_INSTANCED_MODEL_HPP
+
+#include "../../../src/cs-graphics/GltfLoader.hpp"
+
+#include <glm/glm.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+class VistaSceneGraph;
+class VistaTransformNode;
+
+namespace csp::satellites {
+
+/// All satellites which use the same model file and environment map share one InstancedModel.
+/// The model is loaded only once and all satellites using it are drawn with one instanced draw
+/// call per primitive of the model. Each frame, the visible satellites add themselves with
+/// addInstance() and the instances are uploaded to the GPU with flush().
+class InstancedModel {
+ public:
+  /// If preparedModel is given, it has to be the result of cs::graphics::GltfLoader::loadModel()
+  /// for the modelFile. Else, the model file is loaded by the constructor.
+  InstancedModel(std::string const& modelFile, std::string const& environmentMap,
+      VistaSceneGraph* sceneGraph, std::shared_ptr<tinygltf::Model> const& preparedModel = nullptr);
+
+  InstancedModel(InstancedModel const& other) = delete;
+  InstancedModel(InstancedModel&& other)      = delete;
+
+  InstancedModel& operator=(InstancedModel const& other) = delete;
+  InstancedModel& operator=(InstancedModel&& other)      = delete;
+
+  ~InstancedModel();
+
+  /// Removes all instances. This should be called at the beginning of each frame.
+  void clearInstances();
+
+  /// Adds an instance at the given observer-relative transformation. The sun direction and
+  /// illuminance are used for the lighting of this instance.
+  void addInstance(glm::mat4 const& transform, glm::vec3 const& sunDirection, float sunIlluminance);
+
+  /// Passes all instances added since the last call to clearInstances() to the model.
+  void flush(bool enableHDR);
+
+ private:
+  VistaSceneGraph*                          mSceneGraph;
+  std::unique_ptr<VistaTransformNode>       mAnchor;
+  std::unique_ptr<cs::graphics::GltfLoader> mModel;
+  std::vector<cs::graphics::GltfInstance>   mInstances;
+};
+
+} // namespace csp::satellites
+
+#endif // CSP_SATELLITES_INSTANCED_MODEL_HPP
@@ -0,0 +1,265 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "OrbitalElements.hpp"
+
+#include "logger.hpp"
+
+#include "../../../src/cs-utils/filesystem.hpp"
+
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+
+namespace csp::satellites {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+const double cDegToRad = 3.14159265358979323846 / 180.0;
+
+// Revolutions per day to radians per minute.
+const double cRevPerDayToRadPerMin = 2.0 * 3.14159265358979323846 / 1440.0;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::string trim(std::string const& s) {
+  auto begin = s.find_first_not_of(" \t\r\n");
+  if (begin == std::string::npos) {
+    return "";
+  }
+  auto end = s.find_last_not_of(" \t\r\n");
+  return s.substr(begin, end - begin + 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Throws a std::invalid_argument if the field does not contain a number.
+double parseDouble(std::string const& field) {
+  auto   value  = trim(field);
+  size_t pos    = 0;
+  double result = std::stod(value, &pos);
+  if (pos != value.size()) {
+    throw std::invalid_argument("Invalid number '" + field + "'!");
+  }
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Parses numbers in the TLE exponent notation, e.g. " 12345-3" means 0.12345e-3. The decimal point
+// of the mantissa is implied.
+double parseExponential(std::string const& field) {
+  auto value = trim(field);
+  if (value.size() < 3) {
+    throw std::invalid_argument("Invalid number '" + field + "'!");
+  }
+
+  auto mantissa = value.substr(0, value.size() - 2);
+  auto exponent = value.substr(value.size() - 2);
+  auto sign     = 1.0;
+
+  if (mantissa[0] == '-' || mantissa[0] == '+') {
+    sign     = mantissa[0] == '-' ? -1.0 : 1.0;
+    mantissa = mantissa.substr(1);
+  }
+
+  return sign * parseDouble("0." + mantissa) * std::pow(10.0, parseDouble(exponent));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Catalog numbers above 99999 use the "Alpha-5" scheme, where the first digit is replaced by a
+// letter. The letters I and O are not used.
+uint32_t parseCatalogNumber(std::string const& field) {
+  auto value = trim(field);
+  if (!value.empty() && std::isalpha(static_cast<unsigned char>(value[0]))) {
+    char letter = static_cast<char>(std::toupper(static_cast<unsigned char>(value[0])));
+    if (letter == 'I' || letter == 'O') {
+      throw std::invalid_argument("Invalid catalog number '" + field + "'!");
+    }
+    int digit = 10 + (letter - 'A') - (letter > 'I' ? 1 : 0) - (letter > 'O' ? 1 : 0);
+    return static_cast<uint32_t>(digit * 10000 + parseDouble(value.substr(1)));
+  }
+  return static_cast<uint32_t>(parseDouble(value));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool hasValidChecksum(std::string const& line) {
+  int sum = 0;
+  for (size_t i = 0; i < 68; ++i) {
+    if (std::isdigit(static_cast<unsigned char>(line[i]))) {
+      sum += line[i] - '0';
+    } else if (line[i] == '-') {
+      sum += 1;
+    }
+  }
+  return line[68] - '0' == sum % 10;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+OrbitalElements parseTLE(
+    std::string const& name, std::string const& line1, std::string const& line2) {
+  if (line1.size() < 69 || line2.size() < 69) {
+    throw std::invalid_argument("Lines are too short!");
+  }
+
+  if (!hasValidChecksum(line1) || !hasValidChecksum(line2)) {
+    throw std::invalid_argument("Invalid checksum!");
+  }
+
+  OrbitalElements elements;
+  elements.mName          = name;
+  elements.mCatalogNumber = parseCatalogNumber(line1.substr(2, 5));
+
+  // Two-digit years from 57 to 99 belong to the 20th century.
+  int year = static_cast<int>(parseDouble(line1.substr(18, 2)));
+  year += year < 57 ? 2000 : 1900;
+
+  // The epoch is given as fractional day of the year, starting with 1.0 at January 1st, 00:00.
+  elements.mEpoch = toJulianDate(year, 1, 1, 0, 0, 0.0) + parseDouble(line1.substr(20, 12)) - 1.0;
+  elements.mBStar = parseExponential(line1.substr(53, 8));
+
+  elements.mInclination       = parseDouble(line2.substr(8, 8)) * cDegToRad;
+  elements.mRightAscension    = parseDouble(line2.substr(17, 8)) * cDegToRad;
+  elements.mEccentricity      = parseDouble("0." + trim(line2.substr(26, 7)));
+  elements.mArgumentOfPerigee = parseDouble(line2.substr(34, 8)) * cDegToRad;
+  elements.mMeanAnomaly       = parseDouble(line2.substr(43, 8)) * cDegToRad;
+  elements.mMeanMotion        = parseDouble(line2.substr(52, 11)) * cRevPerDayToRadPerMin;
+
+  return elements;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Parses dates like "2024-01-15T12:34:56.123456".
+double parseOMMEpoch(std::string const& epoch) {
+  int    year   = 0;
+  int    month  = 0;
+  int    day    = 0;
+  int    hour   = 0;
+  int    minute = 0;
+  double second = 0.0;
+
+  // NOLINTNEXTLINE(cert-err34-c): The number of converted fields is checked.
+  if (std::sscanf(epoch.c_str(), "%d-%d-%dT%d:%d:%lf", &year, &month, &day, &hour, &minute,
+          &second) != 6) {
+    throw std::invalid_argument("Invalid epoch '" + epoch + "'!");
+  }
+
+  return toJulianDate(year, month, day, hour, minute, second);
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::vector<OrbitalElements> parseTLEs(std::string const& text) {
+  std::vector<OrbitalElements> result;
+  std::vector<std::string>     lines;
+
+  std::istringstream stream(text);
+  std::string        line;
+  while (std::getline(stream, line)) {
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    lines.push_back(line);
+  }
+
+  std::string name;
+
+  for (size_t i = 0; i < lines.size(); ++i) {
+    bool isDataLine = lines[i].size() >= 2 && lines[i][0] == '1' && lines[i][1] == ' ';
+
+    if (!isDataLine) {
+      // In the three-line format, names are prefixed with "0 ".
+      name = trim(lines[i]);
+      if (name.size() >= 2 && name[0] == '0' && name[1] == ' ') {
+        name = trim(name.substr(2));
+      }
+      continue;
+    }
+
+    if (i + 1 >= lines.size() || lines[i + 1].size() < 2 || lines[i + 1][0] != '2') {
+      logger().warn("Ignoring incomplete element set '{}'!", name);
+      continue;
+    }
+
+    try {
+      result.push_back(parseTLE(name, lines[i], lines[i + 1]));
+    } catch (std::exception const& e) {
+      logger().warn("Ignoring invalid element set '{}': {}", name, e.what());
+    }
+
+    name.clear();
+    ++i;
+  }
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::vector<OrbitalElements> parseOMMs(nlohmann::json const& json) {
+  std::vector<OrbitalElements> result;
+
+  for (auto const& omm : json) {
+    try {
+      OrbitalElements elements;
+      elements.mName              = omm.value("OBJECT_NAME", "");
+      elements.mCatalogNumber     = omm.at("NORAD_CAT_ID").get<uint32_t>();
+      elements.mEpoch             = parseOMMEpoch(omm.at("EPOCH").get<std::string>());
+      elements.mBStar             = omm.at("BSTAR").get<double>();
+      elements.mInclination       = omm.at("INCLINATION").get<double>() * cDegToRad;
+      elements.mRightAscension    = omm.at("RA_OF_ASC_NODE").get<double>() * cDegToRad;
+      elements.mEccentricity      = omm.at("ECCENTRICITY").get<double>();
+      elements.mArgumentOfPerigee = omm.at("ARG_OF_PERICENTER").get<double>() * cDegToRad;
+      elements.mMeanAnomaly       = omm.at("MEAN_ANOMALY").get<double>() * cDegToRad;
+      elements.mMeanMotion = omm.at("MEAN_MOTION").get<double>() * cRevPerDayToRadPerMin;
+      result.push_back(elements);
+    } catch (std::exception const& e) {
+      logger().warn("Ignoring invalid OMM '{}': {}", omm.value("OBJECT_NAME", ""), e.what());
+    }
+  }
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::vector<OrbitalElements> loadOrbitalElements(std::string const& file) {
+  if (!boost::filesystem::exists(file)) {
+    throw std::runtime_error("File '" + file + "' does not exist!");
+  }
+
+  auto content = cs::utils::filesystem::loadToString(file);
+
+  if (file.size() >= 5 && file.substr(file.size() - 5) == ".json") {
+    return parseOMMs(nlohmann::json::parse(content));
+  }
+
+  return parseTLEs(content);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+double toJulianDate(int year, int month, int day, int hour, int minute, double second) {
+  // This is valid for all dates between 1901 and 2099.
+  double jd = 367.0 * year - std::floor(7.0 * (year + std::floor((month + 9) / 12.0)) * 0.25) +
+              std::floor(275.0 * month / 9.0) + day + 1721013.5;
+  return jd + ((second / 60.0 + minute) / 60.0 + hour) / 24.0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace csp::satellites
@@ -0,0 +1,55 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#ifndef CSP_SATELLITES_ORBITAL_ELEMENTS_HPP
+#define CSP_SATELLITES_ORBITAL_ELEMENTS_HPP
+
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace csp::satellites {
+
+/// The mean orbital elements of an Earth satellite as they are published in two-line element sets
+/// (TLE) or in CCSDS Orbit Mean-Elements Messages (OMM). They are only meaningful in combination
+/// with the SGP4 model, see SGP4Propagator. All angles are given in radians.
+struct OrbitalElements {
+  std::string mName;
+  uint32_t    mCatalogNumber = 0;
+
+  double mEpoch             = 0.0; ///< The epoch as Julian date (UTC).
+  double mBStar             = 0.0; ///< The drag term in inverse Earth radii.
+  double mInclination       = 0.0;
+  double mRightAscension    = 0.0; ///< The right ascension of the ascending node.
+  double mEccentricity      = 0.0;
+  double mArgumentOfPerigee = 0.0;
+  double mMeanAnomaly       = 0.0;
+  double mMeanMotion        = 0.0; ///< The Kozai mean motion in radians per minute.
+};
+
+/// Parses all element sets in the given string. Each element set consists of the two data lines
+/// which may be preceded by a line containing the name of the satellite. Element sets with invalid
+/// checksums or numbers are skipped with a warning.
+std::vector<OrbitalElements> parseTLEs(std::string const& text);
+
+/// Parses a JSON array of OMMs in the format which is for example provided by CelesTrak with
+/// FORMAT=json. Invalid entries are skipped with a warning.
+std::vector<OrbitalElements> parseOMMs(nlohmann::json const& json);
+
+/// Loads all element sets from the given file. Files with the extension ".json" are parsed with
+/// parseOMMs(), all other files with parseTLEs(). This throws a std::runtime_error if the file
+/// cannot be read.
+std::vector<OrbitalElements> loadOrbitalElements(std::string const& file);
+
+/// Returns the Julian date of the given UTC calendar date. The seconds may contain a fraction.
+double toJulianDate(int year, int month, int day, int hour, int minute, double second);
+
+} // namespace csp::satellites
+
+#endif // CSP_SATELLITES_ORBITAL_ELEMENTS_HPP
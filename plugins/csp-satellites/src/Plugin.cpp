@@ -7,10 +7,13 @@
 
 #include "Plugin.hpp"
 
+#include "InstancedModel.hpp"
 #include "Satellite.hpp"
+#include "SatelliteCatalog.hpp"
 #include "logger.hpp"
 
 #include "../../../src/cs-core/SolarSystem.hpp"
+#include "../../../src/cs-utils/ThreadPool.hpp"
 #include "../../../src/cs-utils/logger.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -43,12 +46,58 @@ void to_json(nlohmann::json& j, Plugin::Settings::Satellite const& o) {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void from_json(nlohmann::json const& j, Plugin::Settings::Catalog& o) {
+  cs::core::Settings::deserialize(j, "file", o.mFile);
+  cs::core::Settings::deserialize(j, "pointSize", o.mPointSize);
+  cs::core::Settings::deserialize(j, "maxPixelError", o.mMaxPixelError);
+}
+
+void to_json(nlohmann::json& j, Plugin::Settings::Catalog const& o) {
+  cs::core::Settings::serialize(j, "file", o.mFile);
+  cs::core::Settings::serialize(j, "pointSize", o.mPointSize);
+  cs::core::Settings::serialize(j, "maxPixelError", o.mMaxPixelError);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 void from_json(nlohmann::json const& j, Plugin::Settings& o) {
   cs::core::Settings::deserialize(j, "satellites", o.mSatellites);
+  cs::core::Settings::deserialize(j, "catalog", o.mCatalog);
 }
 
 void to_json(nlohmann::json& j, Plugin::Settings const& o) {
   cs::core::Settings::serialize(j, "satellites", o.mSatellites);
+  cs::core::Settings::serialize(j, "catalog", o.mCatalog);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Plugin::prepare(nlohmann::json const& pluginSettings) {
+
+  // Parsing the model files and decoding their textures does not require an OpenGL context, so
+  // this is done here on worker threads.
+  Settings settings;
+  from_json(pluginSettings, settings);
+
+  // Each model file is only loaded once, even if it is used by several satellites. All entries are
+  // created before the tasks are started, so that the tasks do not modify the map concurrently.
+  for (auto const& satellite : settings.mSatellites) {
+    mPreparedModels.emplace(satellite.second.mModelFile, nullptr);
+  }
+
+  cs::utils::TaskGroup tasks;
+
+  for (auto& model : mPreparedModels) {
+    tasks.enqueue([&model]() {
+      try {
+        model.second = cs::graphics::GltfLoader::loadModel(model.first);
+      } catch (std::exception const&) {
+        // The file is loaded again in init(), which will report the error.
+      }
+    });
+  }
+
+  tasks.wait();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -75,6 +124,8 @@ void Plugin::deInit() {
   onSave();
 
   mSatellites.clear();
+  mModels.clear();
+  mCatalog.reset();
 
   mAllSettings->onLoad().disconnect(mOnLoadConnection);
   mAllSettings->onSave().disconnect(mOnSaveConnection);
@@ -85,9 +136,21 @@ void Plugin::deInit() {
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void Plugin::update() {
+  for (auto const& model : mModels) {
+    model.second->clearInstances();
+  }
+
   for (auto const& satellite : mSatellites) {
     satellite->update();
   }
+
+  for (auto const& model : mModels) {
+    model.second->flush(mAllSettings->mGraphics.pEnableHDR.get());
+  }
+
+  if (mCatalog) {
+    mCatalog->update();
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -99,9 +162,55 @@ void Plugin::onLoad() {
   // Read settings from JSON.
   mPluginSettings = mAllSettings->mPlugins.at("csp-satellites");
 
+  // Models which are still used after reloading the settings are not loaded again.
+  std::map<std::pair<std::string, std::string>, std::shared_ptr<InstancedModel>> models;
+
   for (auto const& settings : mPluginSettings.mSatellites) {
-    mSatellites.push_back(std::make_shared<Satellite>(
-        settings.second, settings.first, mSceneGraph, mAllSettings, mSolarSystem));
+    auto  key   = std::make_pair(settings.second.mModelFile, settings.second.mEnvironmentMap);
+    auto& model = models[key];
+
+    if (!model) {
+      auto existing = mModels.find(key);
+      if (existing != mModels.end()) {
+        model = existing->second;
+      } else {
+        // The data of a prepared model is moved into the InstancedModel, so it can only be used
+        // once. The same file with another environment map is loaded again.
+        std::shared_ptr<tinygltf::Model> prepared;
+        auto                             preparedIt = mPreparedModels.find(key.first);
+        if (preparedIt != mPreparedModels.end()) {
+          prepared = std::move(preparedIt->second);
+          mPreparedModels.erase(preparedIt);
+        }
+
+        model = std::make_shared<InstancedModel>(key.first, key.second, mSceneGraph, prepared);
+      }
+    }
+
+    mSatellites.push_back(
+        std::make_shared<Satellite>(model, settings.first, mAllSettings, mSolarSystem));
+  }
+
+  mModels = std::move(models);
+  mPreparedModels.clear();
+
+  logger().info(
+      "Loaded {} satellites with {} different models.", mSatellites.size(), mModels.size());
+
+  // The catalog is only loaded again if the file changed.
+  if (!mPluginSettings.mCatalog) {
+    mCatalog.reset();
+  } else if (mCatalog && mCatalog->getFile() == mPluginSettings.mCatalog->mFile) {
+    mCatalog->configure(*mPluginSettings.mCatalog);
+  } else {
+    mCatalog.reset();
+
+    try {
+      mCatalog = std::make_shared<SatelliteCatalog>(
+          *mPluginSettings.mCatalog, mAllSettings, mSolarSystem, mTimeControl);
+    } catch (std::exception const& e) {
+      logger().error("Failed to load satellite catalog: {}", e.what());
+    }
   }
 }
 
@@ -14,13 +14,20 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 #include <map>
+#include <memory>
 #include <optional>
 #include <string>
 #include <vector>
 
+namespace tinygltf {
+struct Model;
+} // namespace tinygltf
+
 namespace csp::satellites {
 
+class InstancedModel;
 class Satellite;
+class SatelliteCatalog;
 
 /// This plugin enables to place satellites into the Solar System.
 /// The configuration of this plugin is done via the provided json config. See README.md for
@@ -39,8 +46,25 @@ class Plugin : public cs::core::PluginBase {
     };
 
     std::map<std::string, Satellite> mSatellites;
+
+    /// The settings for a catalog of satellites which are propagated with SGP4 and drawn as points.
+    struct Catalog {
+      /// Path to a file with two-line element sets. Files with the extension ".json" are parsed as
+      /// an array of CCSDS Orbit Mean-Elements Messages instead, as provided by CelesTrak.
+      std::string mFile;
+
+      /// The diameter of the points in pixels.
+      cs::utils::DefaultProperty<float> mPointSize{3.F};
+
+      /// A satellite is propagated again once its position on screen would be off by more than
+      /// this many pixels.
+      cs::utils::DefaultProperty<float> mMaxPixelError{1.F};
+    };
+
+    std::optional<Catalog> mCatalog;
   };
 
+  void prepare(nlohmann::json const& pluginSettings) override;
   void init() override;
   void deInit() override;
   void update() override;
@@ -52,6 +76,15 @@ class Plugin : public cs::core::PluginBase {
   Settings                                mPluginSettings;
   std::vector<std::shared_ptr<Satellite>> mSatellites;
 
+  /// Satellites with the same model file and environment map share one model. The key of this map
+  /// is the pair of both file names.
+  std::map<std::pair<std::string, std::string>, std::shared_ptr<InstancedModel>> mModels;
+
+  /// The model files parsed in prepare(). They are used by the first onLoad() in init().
+  std::map<std::string, std::shared_ptr<tinygltf::Model>> mPreparedModels;
+
+  std::shared_ptr<SatelliteCatalog> mCatalog;
+
   int mOnLoadConnection = -1;
   int mOnSaveConnection = -1;
 };
@@ -0,0 +1,425 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "SGP4Propagator.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace csp::satellites {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+const double cPi    = 3.14159265358979323846;
+const double cTwoPi = 2.0 * cPi;
+
+// WGS-72 constants as used by the reference implementation.
+const double cMu         = 398600.8;  // km³/s²
+const double cEarthRadii = 6378.135;  // km
+const double cXke        = 60.0 / std::sqrt(cEarthRadii * cEarthRadii * cEarthRadii / cMu);
+const double cJ2         = 0.001082616;
+const double cJ3         = -0.00000253881;
+const double cJ4         = -0.00000165597;
+const double cJ3oJ2      = cJ3 / cJ2;
+const double cX2o3       = 2.0 / 3.0;
+
+// Earth radii per minute to kilometers per second.
+const double cVelocityScale = cEarthRadii * cXke / 60.0;
+
+// Satellites with a longer period require the deep-space model.
+const double cDeepSpacePeriod = 225.0; // min
+
+// The number of iterations for solving Kepler's equation. The reference implementation stops
+// earlier if the solution converged, more iterations do not change the result.
+const int cKeplerIterations = 10;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Frame rotations about the y and z axis, stored in row-major order.
+std::array<double, 9> rotateY(double angle) {
+  double c = std::cos(angle);
+  double s = std::sin(angle);
+  return {c, 0.0, -s, 0.0, 1.0, 0.0, s, 0.0, c};
+}
+
+std::array<double, 9> rotateZ(double angle) {
+  double c = std::cos(angle);
+  double s = std::sin(angle);
+  return {c, s, 0.0, -s, c, 0.0, 0.0, 0.0, 1.0};
+}
+
+std::array<double, 9> multiply(std::array<double, 9> const& a, std::array<double, 9> const& b) {
+  std::array<double, 9> result{};
+  for (int row = 0; row < 3; ++row) {
+    for (int col = 0; col < 3; ++col) {
+      for (int i = 0; i < 3; ++i) {
+        result.at(row * 3 + col) += a.at(row * 3 + i) * b.at(i * 3 + col);
+      }
+    }
+  }
+  return result;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void SGP4Propagator::add(OrbitalElements const& elements) {
+  double ecco  = elements.mEccentricity;
+  double inclo = elements.mInclination;
+  double argpo = elements.mArgumentOfPerigee;
+  double mo    = elements.mMeanAnomaly;
+  double bstar = elements.mBStar;
+
+  // Recover the original mean motion and semi-major axis from the Kozai mean motion.
+  double eccsq  = ecco * ecco;
+  double omeosq = 1.0 - eccsq;
+  double rteosq = std::sqrt(omeosq);
+  double cosio  = std::cos(inclo);
+  double cosio2 = cosio * cosio;
+  double sinio  = std::sin(inclo);
+
+  double ak   = std::pow(cXke / elements.mMeanMotion, cX2o3);
+  double d1   = 0.75 * cJ2 * (3.0 * cosio2 - 1.0) / (rteosq * omeosq);
+  double del  = d1 / (ak * ak);
+  double adel = ak * (1.0 - del * del - del * (1.0 / 3.0 + 134.0 * del * del / 81.0));
+  del         = d1 / (adel * adel);
+
+  double noUnkozai = elements.mMeanMotion / (1.0 + del);
+  double ao        = std::pow(cXke / noUnkozai, cX2o3);
+  double po        = ao * omeosq;
+  double con42     = 1.0 - 5.0 * cosio2;
+  double con41     = -con42 - cosio2 - cosio2;
+  double posq      = po * po;
+  double rp        = ao * (1.0 - ecco);
+
+  Status status = Status::eOk;
+
+  if (!(elements.mMeanMotion > 0.0) || ecco < 0.0 || ecco >= 1.0 || !(noUnkozai > 0.0)) {
+    status = Status::eInvalid;
+  } else if (cTwoPi / noUnkozai >= cDeepSpacePeriod) {
+    status = Status::eDeepSpace;
+  }
+
+  // For perigee heights below 220 km, the higher-order drag terms are omitted. The same applies to
+  // deep-space satellites.
+  bool isimp = rp < (220.0 / cEarthRadii + 1.0) || status == Status::eDeepSpace;
+
+  // Adjust the atmospheric density parameters for low perigee heights.
+  double sfour  = 78.0 / cEarthRadii + 1.0;
+  double qzms24 = std::pow((120.0 - 78.0) / cEarthRadii, 4.0);
+  double perige = (rp - 1.0) * cEarthRadii;
+
+  if (perige < 156.0) {
+    sfour = perige < 98.0 ? 20.0 : perige - 78.0;
+
+    qzms24 = std::pow((120.0 - sfour) / cEarthRadii, 4.0);
+    sfour  = sfour / cEarthRadii + 1.0;
+  }
+
+  double pinvsq = 1.0 / posq;
+  double tsi    = 1.0 / (ao - sfour);
+  double eta    = ao * ecco * tsi;
+  double etasq  = eta * eta;
+  double eeta   = ecco * eta;
+  double psisq  = std::abs(1.0 - etasq);
+  double coef   = qzms24 * std::pow(tsi, 4.0);
+  double coef1  = coef / std::pow(psisq, 3.5);
+  double cc2    = coef1 * noUnkozai *
+               (ao * (1.0 + 1.5 * etasq + eeta * (4.0 + etasq)) +
+                   0.375 * cJ2 * tsi / psisq * con41 * (8.0 + 3.0 * etasq * (8.0 + etasq)));
+  double cc1 = bstar * cc2;
+  double cc3 = ecco > 1.0e-4 ? -2.0 * coef * tsi * cJ3oJ2 * noUnkozai * sinio / ecco : 0.0;
+
+  double x1mth2 = 1.0 - cosio2;
+  double cc4 =
+      2.0 * noUnkozai * coef1 * ao * omeosq *
+      (eta * (2.0 + 0.5 * etasq) + ecco * (0.5 + 2.0 * etasq) -
+          cJ2 * tsi / (ao * psisq) *
+              (-3.0 * con41 * (1.0 - 2.0 * eeta + etasq * (1.5 - 0.5 * eeta)) +
+                  0.75 * x1mth2 * (2.0 * etasq - eeta * (1.0 + etasq)) * std::cos(2.0 * argpo)));
+  double cc5 = 2.0 * coef1 * ao * omeosq * (1.0 + 2.75 * (etasq + eeta) + eeta * etasq);
+
+  // Secular rates caused by the zonal harmonics.
+  double cosio4 = cosio2 * cosio2;
+  double temp1  = 1.5 * cJ2 * pinvsq * noUnkozai;
+  double temp2  = 0.5 * temp1 * cJ2 * pinvsq;
+  double temp3  = -0.46875 * cJ4 * pinvsq * pinvsq * noUnkozai;
+  double mdot   = noUnkozai + 0.5 * temp1 * rteosq * con41 +
+                0.0625 * temp2 * rteosq * (13.0 - 78.0 * cosio2 + 137.0 * cosio4);
+  double argpdot = -0.5 * temp1 * con42 + 0.0625 * temp2 * (7.0 - 114.0 * cosio2 + 395.0 * cosio4) +
+                   temp3 * (3.0 - 36.0 * cosio2 + 49.0 * cosio4);
+  double xhdot1  = -temp1 * cosio;
+  double nodedot =
+      xhdot1 + (0.5 * temp2 * (4.0 - 19.0 * cosio2) + 2.0 * temp3 * (3.0 - 7.0 * cosio2)) * cosio;
+
+  double omgcof = bstar * cc3 * std::cos(argpo);
+  double xmcof  = ecco > 1.0e-4 ? -cX2o3 * coef * bstar / eeta : 0.0;
+  double nodecf = 3.5 * omeosq * xhdot1 * cc1;
+  double t2cof  = 1.5 * cc1;
+
+  // Avoid a division by zero for retrograde equatorial orbits.
+  double xlcof = -0.25 * cJ3oJ2 * sinio * (3.0 + 5.0 * cosio) / std::max(1.0 + cosio, 1.5e-12);
+  double aycof = -0.5 * cJ3oJ2 * sinio;
+  double delmo = std::pow(1.0 + eta * std::cos(mo), 3.0);
+
+  // The higher-order drag terms. If they are omitted, all coefficients are set to zero so that
+  // propagate() can use the same code path for all satellites.
+  double d2    = 0.0;
+  double d3    = 0.0;
+  double d4    = 0.0;
+  double t3cof = 0.0;
+  double t4cof = 0.0;
+  double t5cof = 0.0;
+
+  if (isimp) {
+    omgcof = 0.0;
+    xmcof  = 0.0;
+    cc5    = 0.0;
+  } else {
+    double cc1sq = cc1 * cc1;
+    double temp  = 0.0;
+
+    d2    = 4.0 * ao * tsi * cc1sq;
+    temp  = d2 * tsi * cc1 / 3.0;
+    d3    = (17.0 * ao + sfour) * temp;
+    d4    = 0.5 * temp * ao * tsi * (221.0 * ao + 31.0 * sfour) * cc1;
+    t3cof = d2 + 2.0 * cc1sq;
+    t4cof = 0.25 * (3.0 * d3 + cc1 * (12.0 * d2 + 10.0 * cc1sq));
+    t5cof = 0.2 * (3.0 * d4 + 12.0 * cc1 * d3 + 6.0 * d2 * d2 + 15.0 * cc1sq * (2.0 * d2 + cc1sq));
+  }
+
+  mElements.push_back(elements);
+  mInitialStatus.push_back(status);
+  mStatus.push_back(status);
+
+  mEpoch.push_back(elements.mEpoch);
+  mNoUnkozai.push_back(noUnkozai);
+  mEcco.push_back(ecco);
+  mInclo.push_back(inclo);
+  mNodeo.push_back(elements.mRightAscension);
+  mArgpo.push_back(argpo);
+  mMo.push_back(mo);
+  mBstar.push_back(bstar);
+  mMdot.push_back(mdot);
+  mArgpdot.push_back(argpdot);
+  mNodedot.push_back(nodedot);
+  mNodecf.push_back(nodecf);
+  mCc1.push_back(cc1);
+  mCc4.push_back(cc4);
+  mCc5.push_back(cc5);
+  mT2cof.push_back(t2cof);
+  mT3cof.push_back(t3cof);
+  mT4cof.push_back(t4cof);
+  mT5cof.push_back(t5cof);
+  mD2.push_back(d2);
+  mD3.push_back(d3);
+  mD4.push_back(d4);
+  mOmgcof.push_back(omgcof);
+  mXmcof.push_back(xmcof);
+  mEta.push_back(eta);
+  mDelmo.push_back(delmo);
+  mSinmao.push_back(std::sin(mo));
+  mXlcof.push_back(xlcof);
+  mAycof.push_back(aycof);
+  mCon41.push_back(con41);
+  mX1mth2.push_back(x1mth2);
+  mX7thm1.push_back(7.0 * cosio2 - 1.0);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void SGP4Propagator::clear() {
+  mElements.clear();
+  mInitialStatus.clear();
+  mStatus.clear();
+
+  for (auto* v : {&mEpoch, &mNoUnkozai, &mEcco, &mInclo, &mNodeo, &mArgpo, &mMo, &mBstar, &mMdot,
+           &mArgpdot, &mNodedot, &mNodecf, &mCc1, &mCc4, &mCc5, &mT2cof, &mT3cof, &mT4cof, &mT5cof,
+           &mD2, &mD3, &mD4, &mOmgcof, &mXmcof, &mEta, &mDelmo, &mSinmao, &mXlcof, &mAycof, &mCon41,
+           &mX1mth2, &mX7thm1}) {
+    v->clear();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::size_t SGP4Propagator::size() const {
+  return mElements.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+SGP4Propagator::Status SGP4Propagator::getStatus(std::size_t index) const {
+  return mStatus.at(index);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+OrbitalElements const& SGP4Propagator::getElements(std::size_t index) const {
+  return mElements.at(index);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void SGP4Propagator::propagate(
+    double julianDate, std::size_t begin, std::size_t end, Output const& output) {
+
+  end = std::min(end, size());
+
+  // This loop has no data-dependent control flow. Error conditions are recorded in the status and
+  // the computation simply continues with the invalid values.
+  for (std::size_t i = begin; i < end; ++i) {
+    double t  = (julianDate - mEpoch[i]) * 1440.0;
+    double t2 = t * t;
+    double t3 = t2 * t;
+    double t4 = t3 * t;
+
+    // Secular effects of the gravitational field and the atmospheric drag.
+    double xmdf   = mMo[i] + mMdot[i] * t;
+    double argpdf = mArgpo[i] + mArgpdot[i] * t;
+    double nodedf = mNodeo[i] + mNodedot[i] * t;
+    double nodem  = nodedf + mNodecf[i] * t2;
+
+    double delomg = mOmgcof[i] * t;
+    double delm   = mXmcof[i] * (std::pow(1.0 + mEta[i] * std::cos(xmdf), 3.0) - mDelmo[i]);
+    double mm     = xmdf + delomg + delm;
+    double argpm  = argpdf - delomg - delm;
+
+    double tempa = 1.0 - mCc1[i] * t - mD2[i] * t2 - mD3[i] * t3 - mD4[i] * t4;
+    double tempe = mBstar[i] * mCc4[i] * t + mBstar[i] * mCc5[i] * (std::sin(mm) - mSinmao[i]);
+    double templ = mT2cof[i] * t2 + mT3cof[i] * t3 + t4 * (mT4cof[i] + t * mT5cof[i]);
+
+    double am = std::pow(cXke / mNoUnkozai[i], cX2o3) * tempa * tempa;
+    double nm = cXke / std::pow(am, 1.5);
+    double em = mEcco[i] - tempe;
+
+    bool invalid = em >= 1.0 || em < -0.001;
+
+    em = std::max(em, 1.0e-6);
+    mm = mm + mNoUnkozai[i] * templ;
+
+    double xlm = mm + argpm + nodem;
+    nodem      = std::fmod(nodem, cTwoPi);
+    argpm      = std::fmod(argpm, cTwoPi);
+    xlm        = std::fmod(xlm, cTwoPi);
+    mm         = std::fmod(xlm - argpm - nodem, cTwoPi);
+
+    double sinim = std::sin(mInclo[i]);
+    double cosim = std::cos(mInclo[i]);
+
+    // Long-period periodic terms.
+    double axnl = em * std::cos(argpm);
+    double temp = 1.0 / (am * (1.0 - em * em));
+    double aynl = em * std::sin(argpm) + temp * mAycof[i];
+    double xl   = mm + argpm + nodem + temp * mXlcof[i] * axnl;
+
+    // Solve Kepler's equation with a fixed number of Newton-Raphson iterations.
+    double u      = std::fmod(xl - nodem, cTwoPi);
+    double eo1    = u;
+    double sineo1 = 0.0;
+    double coseo1 = 0.0;
+
+    for (int k = 0; k < cKeplerIterations; ++k) {
+      sineo1      = std::sin(eo1);
+      coseo1      = std::cos(eo1);
+      double step = (u - aynl * coseo1 + axnl * sineo1 - eo1) /
+                    (1.0 - coseo1 * axnl - sineo1 * aynl);
+      eo1 += std::clamp(step, -0.95, 0.95);
+    }
+
+    // Short-period preliminary quantities.
+    double ecose = axnl * coseo1 + aynl * sineo1;
+    double esine = axnl * sineo1 - aynl * coseo1;
+    double el2   = axnl * axnl + aynl * aynl;
+    double pl    = am * (1.0 - el2);
+
+    invalid = invalid || pl < 0.0;
+    pl      = std::max(pl, 1.0e-12);
+
+    double rl     = am * (1.0 - ecose);
+    double rdotl  = std::sqrt(am) * esine / rl;
+    double rvdotl = std::sqrt(pl) / rl;
+    double betal  = std::sqrt(1.0 - el2);
+    temp          = esine / (1.0 + betal);
+    double sinu   = am / rl * (sineo1 - aynl - axnl * temp);
+    double cosu   = am / rl * (coseo1 - axnl + aynl * temp);
+    double su     = std::atan2(sinu, cosu);
+    double sin2u  = (cosu + cosu) * sinu;
+    double cos2u  = 1.0 - 2.0 * sinu * sinu;
+
+    // Short-period periodic terms.
+    temp         = 1.0 / pl;
+    double temp1 = 0.5 * cJ2 * temp;
+    double temp2 = temp1 * temp;
+
+    double mrt = rl * (1.0 - 1.5 * temp2 * betal * mCon41[i]) + 0.5 * temp1 * mX1mth2[i] * cos2u;
+    su         = su - 0.25 * temp2 * mX7thm1[i] * sin2u;
+    double xnode = nodem + 1.5 * temp2 * cosim * sin2u;
+    double xinc  = mInclo[i] + 1.5 * temp2 * cosim * sinim * cos2u;
+    double mvt   = rdotl - nm * temp1 * mX1mth2[i] * sin2u / cXke;
+    double rvdot = rvdotl + nm * temp1 * (mX1mth2[i] * cos2u + 1.5 * mCon41[i]) / cXke;
+
+    // Orientation vectors.
+    double sinsu = std::sin(su);
+    double cossu = std::cos(su);
+    double snod  = std::sin(xnode);
+    double cnod  = std::cos(xnode);
+    double sini  = std::sin(xinc);
+    double cosi  = std::cos(xinc);
+    double xmx   = -snod * cosi;
+    double xmy   = cnod * cosi;
+    double ux    = xmx * sinsu + cnod * cossu;
+    double uy    = xmy * sinsu + snod * cossu;
+    double uz    = sini * sinsu;
+    double vx    = xmx * cossu - cnod * sinsu;
+    double vy    = xmy * cossu - snod * sinsu;
+    double vz    = sini * cossu;
+
+    std::size_t o = i - begin;
+
+    output.mX[o]  = mrt * ux * cEarthRadii;
+    output.mY[o]  = mrt * uy * cEarthRadii;
+    output.mZ[o]  = mrt * uz * cEarthRadii;
+    output.mVX[o] = (mvt * ux + rvdot * vx) * cVelocityScale;
+    output.mVY[o] = (mvt * uy + rvdot * vy) * cVelocityScale;
+    output.mVZ[o] = (mvt * uz + rvdot * vz) * cVelocityScale;
+
+    // The satellite is below the surface of the Earth if mrt is smaller than one.
+    bool decayed = invalid || mrt < 1.0;
+
+    mStatus[i] = mInitialStatus[i] == Status::eInvalid ? Status::eInvalid
+                 : decayed                             ? Status::eDecayed
+                                                       : mInitialStatus[i];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::array<double, 9> SGP4Propagator::getTEMEToJ2000(double julianDate) {
+  const double arcsecToRad = cPi / (180.0 * 3600.0);
+
+  // Julian centuries since J2000.
+  double t = (julianDate - 2451545.0) / 36525.0;
+
+  double zeta  = (2306.2181 * t + 0.30188 * t * t + 0.017998 * t * t * t) * arcsecToRad;
+  double z     = (2306.2181 * t + 1.09468 * t * t + 0.018203 * t * t * t) * arcsecToRad;
+  double theta = (2004.3109 * t - 0.42665 * t * t - 0.041833 * t * t * t) * arcsecToRad;
+
+  // This matrix rotates J2000 coordinates to mean-of-date coordinates. The transpose is the
+  // inverse rotation.
+  auto precession = multiply(multiply(rotateZ(-z), rotateY(theta)), rotateZ(-zeta));
+
+  return {precession[0], precession[3], precession[6], precession[1], precession[4],
+      precession[7], precession[2], precession[5], precession[8]};
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace csp::satellites
@@ -0,0 +1,124 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#ifndef CSP_SATELLITES_SGP4_PROPAGATOR_HPP
+#define CSP_SATELLITES_SGP4_PROPAGATOR_HPP
+
+#include "OrbitalElements.hpp"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace csp::satellites {
+
+/// The SGP4Propagator computes the positions and velocities of many Earth satellites with the
+/// SGP4 model. The implementation follows "Revisiting Spacetrack Report #3" by Vallado et al.
+/// (AIAA 2006-6753) with the WGS-72 constants.
+///
+/// The satellite parameters are stored as structure of arrays and propagate() processes a
+/// contiguous range of satellites in a single loop without data-dependent branches. Satellites for
+/// which some terms of the model are not required simply use coefficients of zero. This keeps the
+/// loop amenable to vectorization over satellites. Different ranges can be propagated concurrently
+/// from different threads.
+///
+/// Only the near-Earth part of the model is implemented. Satellites with an orbital period of
+/// 225 minutes or more (e.g. navigation or geostationary satellites) are propagated without the
+/// lunar-solar and resonance terms of the deep-space model. Their getStatus() is eDeepSpace and
+/// their error grows with the time since their epoch. This is sufficient for visualizing them as
+/// points, but not for precise applications.
+class SGP4Propagator {
+ public:
+  enum class Status : uint8_t {
+    eOk,        ///< The satellite was propagated successfully.
+    eDeepSpace, ///< The satellite was propagated without the deep-space terms, see above.
+    eInvalid,   ///< The elements were invalid, the satellite is never propagated.
+    eDecayed    ///< The satellite decayed or the elements became invalid during the propagation.
+  };
+
+  /// The states are written to these arrays in structure-of-arrays layout. Positions are given in
+  /// kilometers, velocities in kilometers per second, both in the True Equator Mean Equinox (TEME)
+  /// frame of the propagation time. Each array must have space for the number of propagated
+  /// satellites.
+  struct Output {
+    double* mX  = nullptr;
+    double* mY  = nullptr;
+    double* mZ  = nullptr;
+    double* mVX = nullptr;
+    double* mVY = nullptr;
+    double* mVZ = nullptr;
+  };
+
+  /// Adds a satellite and initializes all time-independent parameters.
+  void add(OrbitalElements const& elements);
+
+  /// Removes all satellites.
+  void clear();
+
+  /// Returns the number of satellites.
+  std::size_t size() const;
+
+  /// Returns the status of the given satellite. This is updated by propagate().
+  Status getStatus(std::size_t index) const;
+
+  /// Returns the elements the given satellite was added with.
+  OrbitalElements const& getElements(std::size_t index) const;
+
+  /// Propagates all satellites with indices in [begin, end) to the given Julian date (UTC) and
+  /// writes their states to the given output. The state of satellite i is written to index
+  /// i - begin.
+  void propagate(double julianDate, std::size_t begin, std::size_t end, Output const& output);
+
+  /// Returns the matrix which rotates TEME coordinates of the given Julian date to the J2000 frame.
+  /// This includes the IAU-1976 precession but ignores the nutation, the resulting error is below
+  /// 20 arc seconds. The matrix is stored in row-major order.
+  static std::array<double, 9> getTEMEToJ2000(double julianDate);
+
+ private:
+  std::vector<OrbitalElements> mElements;
+  std::vector<Status>          mInitialStatus;
+  std::vector<Status>          mStatus;
+
+  // The time-independent parameters of the SGP4 model. The names follow the reference
+  // implementation of Vallado et al.
+  std::vector<double> mEpoch;
+  std::vector<double> mNoUnkozai;
+  std::vector<double> mEcco;
+  std::vector<double> mInclo;
+  std::vector<double> mNodeo;
+  std::vector<double> mArgpo;
+  std::vector<double> mMo;
+  std::vector<double> mBstar;
+  std::vector<double> mMdot;
+  std::vector<double> mArgpdot;
+  std::vector<double> mNodedot;
+  std::vector<double> mNodecf;
+  std::vector<double> mCc1;
+  std::vector<double> mCc4;
+  std::vector<double> mCc5;
+  std::vector<double> mT2cof;
+  std::vector<double> mT3cof;
+  std::vector<double> mT4cof;
+  std::vector<double> mT5cof;
+  std::vector<double> mD2;
+  std::vector<double> mD3;
+  std::vector<double> mD4;
+  std::vector<double> mOmgcof;
+  std::vector<double> mXmcof;
+  std::vector<double> mEta;
+  std::vector<double> mDelmo;
+  std::vector<double> mSinmao;
+  std::vector<double> mXlcof;
+  std::vector<double> mAycof;
+  std::vector<double> mCon41;
+  std::vector<double> mX1mth2;
+  std::vector<double> mX7thm1;
+};
+
+} // namespace csp::satellites
+
+#endif // CSP_SATELLITES_SGP4_PROPAGATOR_HPP
@@ -10,28 +10,24 @@
 
 #include "Plugin.hpp"
 
+#include "../../../src/cs-core/ObjectHandle.hpp"
 #include "../../../src/cs-core/Settings.hpp"
 
-#include <VistaKernel/GraphicsManager/VistaSceneGraph.h>
-
-namespace cs::graphics {
-class GltfLoader;
-} // namespace cs::graphics
-
 namespace cs::core {
 class Settings;
 class SolarSystem;
 } // namespace cs::core
 
-class VistaTransformNode;
-
 namespace csp::satellites {
 
-/// A single satellite within the Solar System.
+class InstancedModel;
+
+/// A single satellite within the Solar System. The model of the satellite is shared with all other
+/// satellites using the same model file.
 class Satellite {
  public:
-  Satellite(Plugin::Settings::Satellite const& config, std::string objectName,
-      VistaSceneGraph* sceneGraph, std::shared_ptr<cs::core::Settings> settings,
+  Satellite(std::shared_ptr<InstancedModel> model, std::string objectName,
+      std::shared_ptr<cs::core::Settings>    settings,
       std::shared_ptr<cs::core::SolarSystem> solarSystem);
 
   Satellite(Satellite const& other) = delete;
@@ -40,18 +36,17 @@ class Satellite {
   Satellite& operator=(Satellite const& other) = delete;
   Satellite& operator=(Satellite&& other)      = delete;
 
-  ~Satellite();
+  ~Satellite() = default;
 
+  /// Adds an instance to the shared model if the satellite is visible.
   void update();
 
  private:
-  VistaSceneGraph*                          mSceneGraph;
-  std::shared_ptr<cs::core::Settings>       mSettings;
-  std::shared_ptr<cs::core::SolarSystem>    mSolarSystem;
-  std::unique_ptr<VistaTransformNode>       mAnchor;
-  std::unique_ptr<cs::graphics::GltfLoader> mModel;
+  std::shared_ptr<InstancedModel>        mModel;
+  std::shared_ptr<cs::core::Settings>    mSettings;
+  std::shared_ptr<cs::core::SolarSystem> mSolarSystem;
 
-  std::string mObjectName;
+  cs::core::ObjectHandle mObject;
 };
 } // namespace csp::satellites
 
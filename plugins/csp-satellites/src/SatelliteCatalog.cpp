@@ -0,0 +1,395 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "SatelliteCatalog.hpp"
+
+#include "OrbitalElements.hpp"
+#include "logger.hpp"
+
+#include "../../../src/cs-core/Settings.hpp"
+#include "../../../src/cs-core/SolarSystem.hpp"
+#include "../../../src/cs-core/TimeControl.hpp"
+#include "../../../src/cs-utils/FrameStats.hpp"
+#include "../../../src/cs-utils/ThreadPool.hpp"
+#include "../../../src/cs-utils/convert.hpp"
+#include "../../../src/cs-utils/utils.hpp"
+
+#include <VistaKernel/GraphicsManager/VistaGraphicsManager.h>
+#include <VistaKernel/GraphicsManager/VistaOpenGLNode.h>
+#include <VistaKernel/GraphicsManager/VistaSceneGraph.h>
+#include <VistaKernel/VistaSystem.h>
+#include <VistaKernelOpenSGExt/VistaOpenSGMaterialTools.h>
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace csp::satellites {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// Returns the Julian date (UTC) of the given Barycentric Dynamical Time.
+double getJulianDate(double tdb) {
+  auto time = cs::utils::convert::time::toPosix(tdb);
+
+  // Julian days start at noon.
+  return static_cast<double>(time.date().julian_day()) - 0.5 +
+         static_cast<double>(time.time_of_day().total_microseconds()) / 86400.0e6;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const char* SatelliteCatalog::VERT_SHADER = R"(
+layout(std430, binding = 0) readonly buffer Positions {
+  vec4 positions[];
+};
+
+uniform mat4  uMatModelView;
+uniform mat4  uMatProjection;
+uniform float uPointSize;
+
+void main() {
+  vec4 position = positions[gl_VertexID];
+
+  // Satellites which could not be propagated are moved out of the clip volume.
+  if (position.w == 0.0) {
+    gl_Position  = vec4(2.0, 2.0, 2.0, 1.0);
+    gl_PointSize = 1.0;
+    return;
+  }
+
+  gl_Position  = uMatProjection * uMatModelView * vec4(position.xyz, 1.0);
+  gl_PointSize = uPointSize;
+}
+)";
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const char* SatelliteCatalog::FRAG_SHADER = R"(
+uniform vec3 uColor;
+
+layout(location = 0) out vec4 oColor;
+
+void main() {
+  // Draw round points.
+  if (length(gl_PointCoord - vec2(0.5)) > 0.5) {
+    discard;
+  }
+
+  oColor = vec4(uColor, 1.0);
+}
+)";
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+SatelliteCatalog::SatelliteCatalog(Plugin::Settings::Catalog catalogSettings,
+    std::shared_ptr<cs::core::Settings>                      settings,
+    std::shared_ptr<cs::core::SolarSystem>                   solarSystem,
+    std::shared_ptr<cs::core::TimeControl>                   timeControl)
+    : mCatalogSettings(std::move(catalogSettings))
+    , mSettings(std::move(settings))
+    , mSolarSystem(std::move(solarSystem))
+    , mTimeControl(std::move(timeControl))
+    , mAnchor("Earth", "J2000") {
+
+  // The anchor is not registered with the SolarSystem, so the existence has to be set manually. If
+  // there is no SPICE data for the current time, the anchor will not have a valid position.
+  mAnchor.setExistence(
+      glm::dvec2(std::numeric_limits<double>::lowest(), std::numeric_limits<double>::max()));
+
+  auto elements = loadOrbitalElements(mCatalogSettings.mFile);
+
+  // Satellites with a similar mean motion move with a similar speed. Sorting them ensures that the
+  // satellites of a block require propagation at about the same time.
+  std::sort(elements.begin(), elements.end(), [](auto const& a, auto const& b) {
+    return a.mMeanMotion < b.mMeanMotion;
+  });
+
+  for (auto const& e : elements) {
+    mPropagator.add(e);
+  }
+
+  mPositions.resize(mPropagator.size());
+  mSpeeds.resize(mPropagator.size());
+  mBlockTimes.resize(
+      (mPropagator.size() + cBlockSize - 1) / cBlockSize, std::numeric_limits<double>::quiet_NaN());
+
+  logger().info("Loaded {} satellites from '{}'.", mPropagator.size(), mCatalogSettings.mFile);
+
+  // The buffer is persistently mapped so that the worker threads can write the propagated
+  // positions directly into it.
+  if (mPropagator.size() > 0) {
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    auto       bytes = static_cast<GLsizeiptr>(sizeof(glm::vec4) * mPropagator.size());
+
+    glGenBuffers(1, &mBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, mBuffer);
+    glBufferStorage(GL_SHADER_STORAGE_BUFFER, bytes, nullptr, flags);
+    mMappedPositions =
+        static_cast<glm::vec4*>(glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, bytes, flags));
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+  }
+
+  // Add to scenegraph.
+  VistaSceneGraph* pSG = GetVistaSystem()->GetGraphicsManager()->GetSceneGraph();
+  mGLNode.reset(pSG->NewOpenGLNode(pSG->GetRoot(), this));
+  VistaOpenSGMaterialTools::SetSortKeyOnSubtree(
+      mGLNode.get(), static_cast<int>(cs::utils::DrawOrder::eOpaqueItems));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+SatelliteCatalog::~SatelliteCatalog() {
+  VistaSceneGraph* pSG = GetVistaSystem()->GetGraphicsManager()->GetSceneGraph();
+  pSG->GetRoot()->DisconnectChild(mGLNode.get());
+
+  if (mFence) {
+    glDeleteSync(mFence);
+  }
+
+  if (mBuffer) {
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, mBuffer);
+    glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    glDeleteBuffers(1, &mBuffer);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::string const& SatelliteCatalog::getFile() const {
+  return mCatalogSettings.mFile;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void SatelliteCatalog::configure(Plugin::Settings::Catalog const& settings) {
+  mCatalogSettings = settings;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void SatelliteCatalog::update() {
+  double simulationTime = mTimeControl->pSimulationTime.get();
+
+  mAnchor.update(simulationTime, mSolarSystem->getObserver());
+
+  if (!mMappedPositions || !mAnchor.getIsInExistence() || !mAnchor.getHasValidPosition()) {
+    return;
+  }
+
+  double julianDate = getJulianDate(simulationTime);
+  glm::dvec3 observer(glm::inverse(mAnchor.getObserverRelativeTransform())[3]);
+
+  // The maximum angular error in radians.
+  double maxError = mCatalogSettings.mMaxPixelError.get() / mPixelsPerRadian;
+
+  // A block has to be propagated if any of its satellites would be off by more than the maximum
+  // error. The position error is approximated by the distance the satellite moved since the last
+  // propagation.
+  std::vector<std::size_t> dirtyBlocks;
+
+  for (std::size_t block = 0; block < mBlockTimes.size(); ++block) {
+    double dt    = std::abs(julianDate - mBlockTimes[block]) * 86400.0;
+    bool   dirty = std::isnan(dt);
+
+    std::size_t end = std::min((block + 1) * cBlockSize, mPropagator.size());
+
+    for (std::size_t i = block * cBlockSize; i < end && !dirty; ++i) {
+      dirty = mSpeeds[i] * dt > maxError * glm::length(mPositions[i] - observer);
+    }
+
+    if (dirty) {
+      dirtyBlocks.push_back(block);
+    }
+  }
+
+  static const cs::utils::FrameStats::RangeId propagatedSatellites("Propagated Satellites");
+  cs::utils::FrameStats::get().addValue(
+      propagatedSatellites, static_cast<int64_t>(dirtyBlocks.size() * cBlockSize));
+
+  if (dirtyBlocks.empty()) {
+    return;
+  }
+
+  // The buffer must not be modified while the points of the last frame are still being drawn.
+  // Usually, the GPU has finished long ago.
+  if (mFence) {
+    glClientWaitSync(mFence, GL_SYNC_FLUSH_COMMANDS_BIT, std::numeric_limits<GLuint64>::max());
+    glDeleteSync(mFence);
+    mFence = nullptr;
+  }
+
+  auto rotation = SGP4Propagator::getTEMEToJ2000(julianDate);
+
+  // The chunks of dirty blocks are distributed dynamically: The worker threads and the calling
+  // thread take the next chunk from a shared counter until all chunks are processed. This way the
+  // main thread does not idle while the workers propagate the satellites.
+  std::atomic<std::size_t> nextChunk{0};
+
+  auto propagateChunks = [this, julianDate, &rotation, &dirtyBlocks, &nextChunk]() {
+    std::size_t first = 0;
+    while ((first = nextChunk.fetch_add(cBlocksPerTask)) < dirtyBlocks.size()) {
+      std::size_t last = std::min(first + cBlocksPerTask, dirtyBlocks.size());
+      for (std::size_t i = first; i < last; ++i) {
+        propagateBlock(dirtyBlocks[i], julianDate, rotation);
+      }
+    }
+  };
+
+  cs::utils::TaskGroup tasks;
+
+  for (std::size_t first = cBlocksPerTask; first < dirtyBlocks.size(); first += cBlocksPerTask) {
+    tasks.enqueue(propagateChunks, cs::utils::TaskPriority::eHigh);
+  }
+
+  propagateChunks();
+
+  // All chunks have been taken. Tasks which have not been started yet would find nothing to do,
+  // so they are dropped. We only have to wait for the chunks which are still being propagated.
+  tasks.cancel();
+  tasks.wait();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void SatelliteCatalog::propagateBlock(
+    std::size_t block, double julianDate, std::array<double, 9> const& rotation) {
+
+  std::size_t begin = block * cBlockSize;
+  std::size_t end   = std::min(begin + cBlockSize, mPropagator.size());
+
+  std::array<double, cBlockSize> x{};
+  std::array<double, cBlockSize> y{};
+  std::array<double, cBlockSize> z{};
+  std::array<double, cBlockSize> vx{};
+  std::array<double, cBlockSize> vy{};
+  std::array<double, cBlockSize> vz{};
+
+  mPropagator.propagate(
+      julianDate, begin, end, {x.data(), y.data(), z.data(), vx.data(), vy.data(), vz.data()});
+
+  auto const& r = rotation;
+
+  for (std::size_t i = begin; i < end; ++i) {
+    std::size_t j       = i - begin;
+    auto        status  = mPropagator.getStatus(i);
+    bool        visible = status == SGP4Propagator::Status::eOk ||
+                   status == SGP4Propagator::Status::eDeepSpace;
+
+    // Rotate from TEME to J2000 and convert from kilometers to meters.
+    glm::dvec3 position(r[0] * x[j] + r[1] * y[j] + r[2] * z[j],
+        r[3] * x[j] + r[4] * y[j] + r[5] * z[j], r[6] * x[j] + r[7] * y[j] + r[8] * z[j]);
+    position *= 1000.0;
+
+    double speed = std::sqrt(vx[j] * vx[j] + vy[j] * vy[j] + vz[j] * vz[j]) * 1000.0;
+
+    // Decayed satellites may become valid again when the time changes, e.g. if it runs backwards.
+    // They are assumed to move with cDecayedSpeed so that their blocks are checked regularly.
+    // Invalid elements never change, so these satellites do not need to be propagated again.
+    float hiddenSpeed = status == SGP4Propagator::Status::eDecayed ? cDecayedSpeed : 0.F;
+
+    mPositions[i]       = visible ? position : glm::dvec3(0.0);
+    mSpeeds[i]          = visible ? static_cast<float>(speed) : hiddenSpeed;
+    mMappedPositions[i] = glm::vec4(mPositions[i], visible ? 1.F : 0.F);
+  }
+
+  mBlockTimes[block] = julianDate;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool SatelliteCatalog::Do() {
+  if (!mMappedPositions || !mAnchor.getIsInExistence() || !mAnchor.getHasValidPosition()) {
+    return true;
+  }
+
+  if (mShaderDirty) {
+    std::string defines = "#version 430\n";
+
+    mShader = VistaGLSLShader();
+    mShader.InitVertexShaderFromString(defines + VERT_SHADER);
+    mShader.InitFragmentShaderFromString(defines + FRAG_SHADER);
+    mShader.Link();
+
+    mUniforms.modelViewMatrix  = mShader.GetUniformLocation("uMatModelView");
+    mUniforms.projectionMatrix = mShader.GetUniformLocation("uMatProjection");
+    mUniforms.pointSize        = mShader.GetUniformLocation("uPointSize");
+    mUniforms.color            = mShader.GetUniformLocation("uColor");
+
+    mShaderDirty = false;
+  }
+
+  // get model view and projection matrices
+  std::array<GLfloat, 16> glMatMV{};
+  std::array<GLfloat, 16> glMatP{};
+  glGetFloatv(GL_MODELVIEW_MATRIX, glMatMV.data());
+  glGetFloatv(GL_PROJECTION_MATRIX, glMatP.data());
+
+  auto const& transform = mAnchor.getObserverRelativeTransform();
+  auto        matMV     = glm::make_mat4x4(glMatMV.data()) * glm::mat4(transform);
+
+  // This is used for the error estimation in the next frame.
+  std::array<GLint, 4> viewport{};
+  glGetIntegerv(GL_VIEWPORT, viewport.data());
+  mPixelsPerRadian = 0.5F * static_cast<float>(viewport[3]) * glMatP[5];
+
+  // In HDR mode, the satellites are drawn with the luminance of a white, diffuse surface.
+  glm::vec3 color(1.F, 0.9F, 0.7F);
+
+  if (mSettings->mGraphics.pEnableHDR.get()) {
+    color *= static_cast<float>(mSolarSystem->getSunIlluminance(transform[3]) / glm::pi<double>());
+  }
+
+  glPushAttrib(GL_ENABLE_BIT | GL_DEPTH_BUFFER_BIT);
+
+  glEnable(GL_PROGRAM_POINT_SIZE);
+  glDepthMask(GL_FALSE);
+
+  mShader.Bind();
+  glUniformMatrix4fv(mUniforms.modelViewMatrix, 1, GL_FALSE, glm::value_ptr(matMV));
+  glUniformMatrix4fv(mUniforms.projectionMatrix, 1, GL_FALSE, glMatP.data());
+  mShader.SetUniform(mUniforms.pointSize, mCatalogSettings.mPointSize.get());
+  mShader.SetUniform(mUniforms.color, color[0], color[1], color[2]);
+
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, mBuffer);
+  glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(mPropagator.size()));
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+
+  mShader.Release();
+
+  glPopAttrib();
+
+  // The buffer may only be written again once the GPU has finished drawing. In stereo mode, Do()
+  // is called several times per frame, only the last fence is relevant.
+  if (mFence) {
+    glDeleteSync(mFence);
+  }
+
+  mFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool SatelliteCatalog::GetBoundingBox(VistaBoundingBox& /*bb*/) {
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace csp::satellites
@@ -0,0 +1,140 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#ifndef CSP_SATELLITES_SATELLITE_CATALOG_HPP
+#define CSP_SATELLITES_SATELLITE_CATALOG_HPP
+
+#include "Plugin.hpp"
+#include "SGP4Propagator.hpp"
+
+#include "../../../src/cs-scene/CelestialObject.hpp"
+
+#include <GL/glew.h>
+#include <VistaKernel/GraphicsManager/VistaOpenGLDraw.h>
+#include <VistaOGLExt/VistaGLSLShader.h>
+
+#include <array>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+class VistaOpenGLNode;
+
+namespace cs::core {
+class Settings;
+class SolarSystem;
+class TimeControl;
+} // namespace cs::core
+
+namespace csp::satellites {
+
+/// The SatelliteCatalog draws all satellites of a file with TLEs or OMMs as points around the
+/// Earth. The satellites are propagated with the SGP4Propagator on the main thread together with
+/// the worker threads of the global thread pool and the results are written directly to a
+/// persistently mapped GPU buffer.
+///
+/// The propagation is time-sliced: The satellites are processed in blocks and a block is only
+/// propagated again if the position of one of its satellites would otherwise be off by more than
+/// Plugin::Settings::Catalog::mMaxPixelError pixels on screen. This estimate is based on the speed
+/// of the satellite, the time since the last propagation and the distance to the observer. Hence,
+/// satellites far away from the observer are updated much less frequently than close ones. The
+/// satellites are sorted by their mean motion so that satellites in the same block move similarly.
+class SatelliteCatalog : public IVistaOpenGLDraw {
+ public:
+  SatelliteCatalog(Plugin::Settings::Catalog catalogSettings,
+      std::shared_ptr<cs::core::Settings>    settings,
+      std::shared_ptr<cs::core::SolarSystem> solarSystem,
+      std::shared_ptr<cs::core::TimeControl> timeControl);
+
+  SatelliteCatalog(SatelliteCatalog const& other) = delete;
+  SatelliteCatalog(SatelliteCatalog&& other)      = delete;
+
+  SatelliteCatalog& operator=(SatelliteCatalog const& other) = delete;
+  SatelliteCatalog& operator=(SatelliteCatalog&& other)      = delete;
+
+  ~SatelliteCatalog() override;
+
+  /// Returns the file the satellites were loaded from.
+  std::string const& getFile() const;
+
+  /// Updates the settings which do not require reloading the catalog.
+  void configure(Plugin::Settings::Catalog const& settings);
+
+  /// Propagates all satellites which would have a too large error in the current frame. This has
+  /// to be called once a frame.
+  void update();
+
+  bool Do() override;
+  bool GetBoundingBox(VistaBoundingBox& bb) override;
+
+ private:
+  /// Propagates the satellites of the given block to the given Julian date and writes them to the
+  /// GPU buffer. This is called concurrently for different blocks.
+  void propagateBlock(std::size_t block, double julianDate, std::array<double, 9> const& rotation);
+
+  /// The number of satellites which are propagated together.
+  static constexpr std::size_t cBlockSize = 64;
+
+  /// The number of blocks which a thread takes at once from the list of dirty blocks.
+  static constexpr std::size_t cBlocksPerTask = 16;
+
+  /// The speed in meters per second which is used for the error estimation of decayed satellites.
+  /// This is about the orbital speed in a low Earth orbit.
+  static constexpr float cDecayedSpeed = 8000.F;
+
+  static const char* VERT_SHADER;
+  static const char* FRAG_SHADER;
+
+  Plugin::Settings::Catalog              mCatalogSettings;
+  std::shared_ptr<cs::core::Settings>    mSettings;
+  std::shared_ptr<cs::core::SolarSystem> mSolarSystem;
+  std::shared_ptr<cs::core::TimeControl> mTimeControl;
+
+  std::unique_ptr<VistaOpenGLNode> mGLNode;
+
+  /// The center of the Earth in the J2000 frame. All positions are given relative to this.
+  cs::scene::CelestialObject mAnchor;
+
+  SGP4Propagator mPropagator;
+
+  /// The Earth-centered positions of the satellites in meters in the J2000 frame and their speed
+  /// in meters per second as computed by the last propagation. These are used for the error
+  /// estimation. Satellites which cannot be propagated are placed at the center of the Earth.
+  std::vector<glm::dvec3> mPositions;
+  std::vector<float>      mSpeeds;
+
+  /// The Julian date to which each block has been propagated last. This is NaN for blocks which
+  /// have not been propagated yet.
+  std::vector<double> mBlockTimes;
+
+  /// The positions in the persistently mapped buffer. The w-component is zero for satellites which
+  /// cannot be propagated, these are not drawn.
+  GLuint     mBuffer          = 0;
+  glm::vec4* mMappedPositions = nullptr;
+
+  /// The buffer must not be written while the GPU is still drawing the points of the previous
+  /// frame. This fence is inserted after drawing.
+  GLsync mFence = nullptr;
+
+  /// The number of pixels per radian at the center of the viewport. This is updated in Do() and
+  /// used for the error estimation of the next frame.
+  float mPixelsPerRadian = 1000.F;
+
+  VistaGLSLShader mShader;
+  bool            mShaderDirty = true;
+
+  struct {
+    uint32_t modelViewMatrix  = 0;
+    uint32_t projectionMatrix = 0;
+    uint32_t pointSize        = 0;
+    uint32_t color            = 0;
+  } mUniforms;
+};
+
+} // namespace csp::satellites
+
+#endif // CSP_SATELLITES_SATELLITE_CATALOG_HPP
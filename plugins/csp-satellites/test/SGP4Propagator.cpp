@@ -0,0 +1,104 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "../src/SGP4Propagator.hpp"
+
+#include "../../../src/cs-utils/doctest.hpp"
+
+#include <glm/gtc/constants.hpp>
+
+#include <cmath>
+#include <vector>
+
+namespace csp::satellites {
+
+namespace {
+
+// This is the first test case of the verification data set of Vallado et al.
+const std::string cVanguard =
+    "VANGUARD 1\n"
+    "1 00005U 58002B   00179.78495062  .00000023  00000-0  28098-4 0  4753\n"
+    "2 00005  34.2682 348.7242 1859667 331.7664  19.3264 10.82419157413667\n";
+
+} // namespace
+
+TEST_CASE("csp::satellites::parseTLEs") {
+  auto elements = parseTLEs(cVanguard);
+  REQUIRE(elements.size() == 1);
+
+  CHECK(elements[0].mName == "VANGUARD 1");
+  CHECK(elements[0].mCatalogNumber == 5);
+  CHECK(elements[0].mEpoch == doctest::Approx(2451723.28495062).epsilon(1e-12));
+  CHECK(elements[0].mBStar == doctest::Approx(0.28098e-4));
+  CHECK(elements[0].mEccentricity == doctest::Approx(0.1859667));
+  CHECK(elements[0].mMeanMotion ==
+        doctest::Approx(10.82419157 * 2.0 * glm::pi<double>() / 1440.0));
+
+  // Element sets with invalid checksums are skipped.
+  auto corrupted = cVanguard;
+  corrupted.replace(corrupted.find("34.2682"), 7, "34.2683");
+  CHECK(parseTLEs(corrupted).empty());
+}
+
+TEST_CASE("csp::satellites::SGP4Propagator") {
+  SGP4Propagator propagator;
+  propagator.add(parseTLEs(cVanguard).at(0));
+
+  // The reference states in kilometers and kilometers per second for the given minutes since the
+  // epoch.
+  struct Reference {
+    double mMinutes;
+    double mPosition[3];
+    double mVelocity[3];
+  };
+
+  const std::vector<Reference> references = {
+      {0.0, {7022.46529266, -1400.08296755, 0.03995155},
+          {1.893841015, 6.405893759, 4.534807250}},
+      {360.0, {-7154.03120202, -3783.17682504, -3536.19412294},
+          {4.741887409, -4.151817765, -2.093935425}},
+      {720.0, {-7134.59340119, 6531.68641334, 3260.27186483},
+          {-4.113793027, -2.911922039, -2.557327851}},
+      {1080.0, {5568.53901181, 4492.06992591, 3863.87641983},
+          {-4.209106476, 5.159719888, 2.744852980}},
+  };
+
+  double x{}, y{}, z{}, vx{}, vy{}, vz{};
+
+  for (auto const& r : references) {
+    propagator.propagate(propagator.getElements(0).mEpoch + r.mMinutes / 1440.0, 0, 1,
+        {&x, &y, &z, &vx, &vy, &vz});
+
+    CHECK(propagator.getStatus(0) == SGP4Propagator::Status::eOk);
+
+    // The remaining difference is caused by the limited precision of the Julian date.
+    CHECK(x == doctest::Approx(r.mPosition[0]).epsilon(1e-6));
+    CHECK(y == doctest::Approx(r.mPosition[1]).epsilon(1e-6));
+    CHECK(z == doctest::Approx(r.mPosition[2]).epsilon(1e-6));
+    CHECK(vx == doctest::Approx(r.mVelocity[0]).epsilon(1e-6));
+    CHECK(vy == doctest::Approx(r.mVelocity[1]).epsilon(1e-6));
+    CHECK(vz == doctest::Approx(r.mVelocity[2]).epsilon(1e-6));
+  }
+}
+
+TEST_CASE("csp::satellites::SGP4Propagator::getTEMEToJ2000") {
+  // At J2000, both frames are identical apart from the nutation.
+  auto identity = SGP4Propagator::getTEMEToJ2000(2451545.0);
+
+  for (int i = 0; i < 9; ++i) {
+    CHECK(identity.at(i) == doctest::Approx(i % 4 == 0 ? 1.0 : 0.0));
+  }
+
+  // The equinox moves westwards by about 50 arc seconds per year. Hence, the x-axis of date has a
+  // negative y-component in the J2000 frame.
+  auto matrix   = SGP4Propagator::getTEMEToJ2000(2451545.0 + 36525.0 * 0.25);
+  auto expected = 25.0 * 50.3 / 3600.0 * glm::pi<double>() / 180.0;
+  CHECK(matrix[3] < 0.0);
+  CHECK(std::acos(matrix[0]) == doctest::Approx(expected).epsilon(0.05));
+}
+
+} // namespace csp::satellites
@@ -150,8 +150,8 @@ Sharad::Sharad(std::shared_ptr<cs::core::Settings> settings,
     : mSettings(std::move(settings))
     , mGraphicsEngine(std::move(graphicsEngine))
     , mSolarSystem(std::move(solarSystem))
-    , mTexture(cs::graphics::TextureLoader::loadFromFile(sTiffFile))
-    , mObjectName(std::move(objectName)) {
+    , mTexture(cs::graphics::TextureLoader::loadFromFileAsync(sTiffFile))
+    , mObject(mSolarSystem->getObjectHandle(objectName)) {
 
   // Disables a warning in MSVC about using fopen_s and fscanf_s, which aren't supported in GCC.
   CS_WARNINGS_PUSH
@@ -268,7 +268,7 @@ void Sharad::update(double tTime, double sceneScale) {
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 bool Sharad::Do() {
-  auto object = mSolarSystem->getObject(mObjectName);
+  auto const& object = mObject.get();
 
   if (object && object->getIsBodyVisible()) {
     cs::utils::FrameStats::ScopedTimer timer("Sharad");
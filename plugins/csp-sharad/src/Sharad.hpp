@@ -49,10 +49,10 @@ class Sharad : public IVistaOpenGLDraw {
   std::shared_ptr<cs::core::Settings>       mSettings;
   std::shared_ptr<cs::core::GraphicsEngine> mGraphicsEngine;
   std::shared_ptr<cs::core::SolarSystem>    mSolarSystem;
-  std::unique_ptr<VistaTexture>             mTexture;
+  std::shared_ptr<VistaTexture>             mTexture;
 
-  std::string mObjectName;
-  double      mStartTime;
+  cs::core::ObjectHandle mObject;
+  double                 mStartTime;
 
   VistaGLSLShader        mShader;
   VistaVertexArrayObject mVAO;
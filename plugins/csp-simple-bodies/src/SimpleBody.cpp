@@ -292,11 +292,11 @@ SimpleBody::~SimpleBody() {
 
 void SimpleBody::configure(Plugin::Settings::SimpleBody const& settings) {
   if (mSimpleBodySettings.mTexture != settings.mTexture) {
-    mTexture = cs::graphics::TextureLoader::loadFromFile(settings.mTexture);
+    mTexture = cs::graphics::TextureLoader::loadFromFileAsync(settings.mTexture);
   }
 
   if (settings.mRing && mSimpleBodySettings.mRing->mTexture != settings.mRing->mTexture) {
-    mRingTexture = cs::graphics::TextureLoader::loadFromFile(settings.mRing->mTexture);
+    mRingTexture = cs::graphics::TextureLoader::loadFromFileAsync(settings.mRing->mTexture);
   }
 
   if (mSimpleBodySettings.mPrimeMeridianInCenter != settings.mPrimeMeridianInCenter) {
@@ -309,13 +309,13 @@ void SimpleBody::configure(Plugin::Settings::SimpleBody const& settings) {
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void SimpleBody::setObjectName(std::string objectName) {
-  mObjectName = std::move(objectName);
+  mObject = mSolarSystem->getObjectHandle(objectName);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 std::string const& SimpleBody::getObjectName() const {
-  return mObjectName;
+  return mObject.getName();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -323,7 +323,7 @@ std::string const& SimpleBody::getObjectName() const {
 bool SimpleBody::getIntersection(
     glm::dvec3 const& rayOrigin, glm::dvec3 const& rayDir, glm::dvec3& pos) const {
 
-  auto parent = mSolarSystem->getObject(mObjectName);
+  auto const& parent = mObject.get();
 
   if (!parent || !parent->getIsBodyVisible()) {
     return false;
@@ -365,11 +365,17 @@ double SimpleBody::getHeight(glm::dvec2 /*lngLat*/) const {
 
 void SimpleBody::update() {
 
-  auto parent = mSolarSystem->getObject(mObjectName);
+  auto const& parent = mObject.get();
 
   if (parent && parent->getIsBodyVisible()) {
+    if (mTimerCenterName != parent->getCenterName() || !mUpdateTimerRange.isValid()) {
+      mTimerCenterName  = parent->getCenterName();
+      mUpdateTimerRange = cs::utils::FrameStats::RangeId("Update " + mTimerCenterName);
+      mDrawTimerRange   = cs::utils::FrameStats::RangeId("Draw " + mTimerCenterName);
+    }
+
     cs::utils::FrameStats::ScopedTimer timer(
-        "Update " + parent->getCenterName(), cs::utils::FrameStats::TimerMode::eCPU);
+        mUpdateTimerRange, cs::utils::FrameStats::TimerMode::eCPU);
     mEclipseShadowReceiver.update(*parent);
   }
 }
@@ -377,13 +383,13 @@ void SimpleBody::update() {
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 bool SimpleBody::Do() {
-  auto parent = mSolarSystem->getObject(mObjectName);
+  auto const& parent = mObject.get();
 
   if (!parent || !parent->getIsBodyVisible()) {
     return true;
   }
 
-  cs::utils::FrameStats::ScopedTimer timer("Draw " + parent->getCenterName());
+  cs::utils::FrameStats::ScopedTimer timer(mDrawTimerRange);
 
   if (mShaderDirty || mEclipseShadowReceiver.needsRecompilation()) {
     mShader = VistaGLSLShader();
@@ -413,7 +419,7 @@ bool SimpleBody::Do() {
     cs::utils::replaceString(
         frag, "ECLIPSE_SHADER_SNIPPET", mEclipseShadowReceiver.getShaderSnippet());
 
-    cs::core::Settings::Shading const& shading = mSettings->getShadingForBody(mObjectName);
+    cs::core::Settings::Shading const& shading = mSettings->getShadingForBody(mObject.getName());
 
     std::string brdfHdrSnippet    = shading.pBrdfHdr.get().assembleShaderSnippet("BRDF_HDR");
     std::string brdfNonHdrSnippet = shading.pBrdfNonHdr.get().assembleShaderSnippet("BRDF_NON_HDR");
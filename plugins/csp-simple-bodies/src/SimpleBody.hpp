@@ -16,9 +16,11 @@
 #include <VistaOGLExt/VistaVertexArrayObject.h>
 
 #include "../../../src/cs-core/EclipseShadowReceiver.hpp"
+#include "../../../src/cs-core/ObjectHandle.hpp"
 #include "../../../src/cs-core/Settings.hpp"
 #include "../../../src/cs-scene/CelestialSurface.hpp"
 #include "../../../src/cs-scene/IntersectableObject.hpp"
+#include "../../../src/cs-utils/FrameStats.hpp"
 
 #include <memory>
 
@@ -71,18 +73,24 @@ class SimpleBody : public cs::scene::CelestialSurface,
   std::shared_ptr<cs::core::Settings>    mSettings;
   std::shared_ptr<cs::core::SolarSystem> mSolarSystem;
 
-  std::string mObjectName;
+  cs::core::ObjectHandle mObject;
+
+  // The timer ranges are named after the SPICE center of the body. They are updated whenever the
+  // center name of the body changes.
+  std::string                    mTimerCenterName;
+  cs::utils::FrameStats::RangeId mUpdateTimerRange;
+  cs::utils::FrameStats::RangeId mDrawTimerRange;
 
   std::unique_ptr<VistaOpenGLNode> mGLNode;
 
   Plugin::Settings::SimpleBody  mSimpleBodySettings;
-  std::unique_ptr<VistaTexture> mTexture;
+  std::shared_ptr<VistaTexture> mTexture;
   VistaGLSLShader               mShader;
   VistaVertexArrayObject        mSphereVAO;
   VistaBufferObject             mSphereVBO;
   VistaBufferObject             mSphereIBO;
 
-  std::unique_ptr<VistaTexture> mRingTexture;
+  std::shared_ptr<VistaTexture> mRingTexture;
 
   cs::core::EclipseShadowReceiver mEclipseShadowReceiver;
 
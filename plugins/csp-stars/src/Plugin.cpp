@@ -79,6 +79,48 @@ void to_json(nlohmann::json& j, Plugin::Settings const& o) {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+namespace {
+
+std::map<Stars::CatalogType, std::string> getCatalogs(Plugin::Settings const& settings) {
+  std::map<Stars::CatalogType, std::string> catalogs;
+
+  if (settings.mHipparcosCatalog) {
+    catalogs[Stars::CatalogType::eHipparcos] = *settings.mHipparcosCatalog;
+  }
+
+  if (settings.mTychoCatalog) {
+    catalogs[Stars::CatalogType::eTycho] = *settings.mTychoCatalog;
+  }
+
+  if (settings.mTycho2Catalog) {
+    catalogs[Stars::CatalogType::eTycho2] = *settings.mTycho2Catalog;
+  }
+
+  if (settings.mGaiaCatalog) {
+    catalogs[Stars::CatalogType::eGaia] = *settings.mGaiaCatalog;
+  }
+
+  return catalogs;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Plugin::prepare(nlohmann::json const& pluginSettings) {
+
+  // Reading the catalogs is by far the most expensive part of loading this plugin. As this does not
+  // require an OpenGL context, it is done here on a worker thread.
+  Settings settings;
+  from_json(pluginSettings, settings);
+
+  mPreparedCatalogs = getCatalogs(settings);
+  mPreparedStars    = Stars::loadCatalogs(
+      mPreparedCatalogs, settings.mCacheFile.value_or("star_cache.dat"));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 void Plugin::init() {
 
   logger().info("Loading plugin...");
@@ -89,6 +131,9 @@ void Plugin::init() {
   // Create the Stars object based on the settings.
   mStars = std::make_unique<Stars>();
 
+  // The stars are drawn relative to the barycenter of the Solar System.
+  mBarycenter = mSolarSystem->getObjectHandle("Barycenter");
+
   // Add the stars to the scenegraph.
   mStarsTransform.reset(mSceneGraph->NewTransformNode(mSceneGraph->GetRoot()));
 
@@ -256,9 +301,10 @@ void Plugin::update() {
   mStars->setStarFiguresColor(
       VistaColor(0.5F, 1.F, 0.8F, 0.3F * (mPluginSettings.mEnableStarFigures.get() ? 1.F : 0.F)));
 
-  auto mat = mSolarSystem->getObject("Barycenter")->getObserverRelativeTransform();
-
-  mStarsTransform->SetTransform(glm::value_ptr(mat), true);
+  if (mBarycenter) {
+    auto const& mat = mBarycenter->getObserverRelativeTransform();
+    mStarsTransform->SetTransform(glm::value_ptr(mat), true);
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -280,25 +326,17 @@ void Plugin::onLoad() {
 
   mStars->setCacheFile(mPluginSettings.mCacheFile.value_or("star_cache.dat"));
 
-  std::map<Stars::CatalogType, std::string> catalogs;
-
-  if (mPluginSettings.mHipparcosCatalog) {
-    catalogs[Stars::CatalogType::eHipparcos] = *mPluginSettings.mHipparcosCatalog;
-  }
-
-  if (mPluginSettings.mTychoCatalog) {
-    catalogs[Stars::CatalogType::eTycho] = *mPluginSettings.mTychoCatalog;
-  }
-
-  if (mPluginSettings.mTycho2Catalog) {
-    catalogs[Stars::CatalogType::eTycho2] = *mPluginSettings.mTycho2Catalog;
-  }
+  auto catalogs = getCatalogs(mPluginSettings);
 
-  if (mPluginSettings.mGaiaCatalog) {
-    catalogs[Stars::CatalogType::eGaia] = *mPluginSettings.mGaiaCatalog;
+  // Use the stars loaded in prepare() if the catalogs have not been changed in the meantime.
+  if (!mPreparedStars.empty() && catalogs == mPreparedCatalogs) {
+    mStars->setCatalogs(std::move(catalogs), std::move(mPreparedStars));
+  } else {
+    mStars->setCatalogs(catalogs);
   }
 
-  mStars->setCatalogs(catalogs);
+  mPreparedStars.clear();
+  mPreparedCatalogs.clear();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
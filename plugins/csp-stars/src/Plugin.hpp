@@ -8,12 +8,15 @@
 #ifndef CSP_STARS_PLUGIN_HPP
 #define CSP_STARS_PLUGIN_HPP
 
+#include "../../../src/cs-core/ObjectHandle.hpp"
 #include "../../../src/cs-core/PluginBase.hpp"
 #include "../../../src/cs-utils/DefaultProperty.hpp"
 #include "Stars.hpp"
 
 #include <glm/glm.hpp>
+#include <map>
 #include <optional>
+#include <vector>
 
 class VistaOpenGLNode;
 class VistaTransformNode;
@@ -43,6 +46,8 @@ class Plugin : public cs::core::PluginBase {
     cs::utils::DefaultProperty<glm::vec2>       mMagnitudeRange{glm::vec2(-10.F, 13.F)};
   };
 
+  /// Reads the star catalogs on a worker thread.
+  void prepare(nlohmann::json const& pluginSettings) override;
   void init() override;
   void deInit() override;
 
@@ -56,6 +61,11 @@ class Plugin : public cs::core::PluginBase {
   std::unique_ptr<Stars>              mStars;
   std::unique_ptr<VistaTransformNode> mStarsTransform;
   std::unique_ptr<VistaOpenGLNode>    mStarsNode;
+  cs::core::ObjectHandle              mBarycenter;
+
+  // The stars read in prepare(). They are uploaded to the GPU in the first call to onLoad().
+  std::map<Stars::CatalogType, std::string> mPreparedCatalogs;
+  std::vector<Stars::Star>                  mPreparedStars;
 
   int mEnableHDRConnection = -1;
   int mOnLoadConnection    = -1;
@@ -81,58 +81,72 @@ Stars::Stars() {
 
 void Stars::setCatalogs(std::map<Stars::CatalogType, std::string> catalogs) {
   if (mCatalogs != catalogs) {
+    auto stars = loadCatalogs(catalogs, mCacheFile);
+    setCatalogs(std::move(catalogs), std::move(stars));
+  }
+}
 
-    mCatalogs = std::move(catalogs);
+////////////////////////////////////////////////////////////////////////////////////////////////////
 
-    // Clear stars first.
-    mStars.clear();
+void Stars::setCatalogs(std::map<CatalogType, std::string> catalogs, std::vector<Star> stars) {
+  mCatalogs = std::move(catalogs);
+  mStars    = std::move(stars);
 
-    // Read star catalogs.
-    if (!readStarCache(mCacheFile)) {
-      std::map<CatalogType, std::string>::const_iterator it;
+  // Create buffers,
+  buildStarVAO();
+  buildBackgroundVAO();
+}
 
-      it = mCatalogs.find(CatalogType::eHipparcos);
-      if (it != mCatalogs.end()) {
-        readStarsFromCatalog(it->first, it->second);
-      }
+////////////////////////////////////////////////////////////////////////////////////////////////////
 
-      it = mCatalogs.find(CatalogType::eTycho);
-      if (it != mCatalogs.end()) {
-        readStarsFromCatalog(it->first, it->second);
-      }
+std::vector<Stars::Star> Stars::loadCatalogs(
+    std::map<CatalogType, std::string> const& catalogs, std::string const& cacheFile) {
 
-      it = mCatalogs.find(CatalogType::eTycho2);
-      if (it != mCatalogs.end()) {
-        // Do not load tycho and tycho 2.
-        if (mCatalogs.find(CatalogType::eTycho) == mCatalogs.end()) {
-          readStarsFromCatalog(it->first, it->second);
-        } else {
-          logger().warn("Failed to load Tycho2 catalog: Tycho already loaded!");
-        }
-      }
+  std::vector<Star> stars;
 
-      it = mCatalogs.find(CatalogType::eGaia);
-      if (it != mCatalogs.end()) {
-        // Do not load gaia together with tycho or tycho 2.
-        if (mCatalogs.find(CatalogType::eTycho) == mCatalogs.end() &&
-            mCatalogs.find(CatalogType::eTycho2) == mCatalogs.end()) {
-          readStarsFromCatalog(it->first, it->second);
-        } else {
-          logger().warn("Failed to load Gaia catalog: Tycho already loaded!");
-        }
+  // Read star catalogs.
+  if (!readStarCache(catalogs, cacheFile, stars)) {
+    std::map<CatalogType, std::string>::const_iterator it;
+
+    it = catalogs.find(CatalogType::eHipparcos);
+    if (it != catalogs.end()) {
+      readStarsFromCatalog(catalogs, it->first, it->second, stars);
+    }
+
+    it = catalogs.find(CatalogType::eTycho);
+    if (it != catalogs.end()) {
+      readStarsFromCatalog(catalogs, it->first, it->second, stars);
+    }
+
+    it = catalogs.find(CatalogType::eTycho2);
+    if (it != catalogs.end()) {
+      // Do not load tycho and tycho 2.
+      if (catalogs.find(CatalogType::eTycho) == catalogs.end()) {
+        readStarsFromCatalog(catalogs, it->first, it->second, stars);
+      } else {
+        logger().warn("Failed to load Tycho2 catalog: Tycho already loaded!");
       }
+    }
 
-      if (!mStars.empty()) {
-        writeStarCache(mCacheFile);
+    it = catalogs.find(CatalogType::eGaia);
+    if (it != catalogs.end()) {
+      // Do not load gaia together with tycho or tycho 2.
+      if (catalogs.find(CatalogType::eTycho) == catalogs.end() &&
+          catalogs.find(CatalogType::eTycho2) == catalogs.end()) {
+        readStarsFromCatalog(catalogs, it->first, it->second, stars);
       } else {
-        logger().warn("Loaded no stars! Stars will not work properly.");
+        logger().warn("Failed to load Gaia catalog: Tycho already loaded!");
       }
     }
 
-    // Create buffers,
-    buildStarVAO();
-    buildBackgroundVAO();
+    if (!stars.empty()) {
+      writeStarCache(catalogs, cacheFile, stars);
+    } else {
+      logger().warn("Loaded no stars! Stars will not work properly.");
+    }
   }
+
+  return stars;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -275,7 +289,7 @@ void Stars::setStarTexture(std::string const& filename) {
     if (filename.empty()) {
       mStarTexture.reset();
     } else {
-      mStarTexture = cs::graphics::TextureLoader::loadFromFile(filename);
+      mStarTexture = cs::graphics::TextureLoader::loadFromFileAsync(filename);
     }
   }
 }
@@ -288,7 +302,7 @@ void Stars::setCelestialGridTexture(std::string const& filename) {
     if (filename.empty()) {
       mCelestialGridTexture.reset();
     } else {
-      mCelestialGridTexture = cs::graphics::TextureLoader::loadFromFile(filename);
+      mCelestialGridTexture = cs::graphics::TextureLoader::loadFromFileAsync(filename);
     }
   }
 }
@@ -301,7 +315,7 @@ void Stars::setStarFiguresTexture(std::string const& filename) {
     if (filename.empty()) {
       mStarFiguresTexture.reset();
     } else {
-      mStarFiguresTexture = cs::graphics::TextureLoader::loadFromFile(filename);
+      mStarFiguresTexture = cs::graphics::TextureLoader::loadFromFileAsync(filename);
     }
   }
 }
@@ -617,7 +631,8 @@ bool Stars::GetBoundingBox(VistaBoundingBox& oBoundingBox) {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-bool Stars::readStarsFromCatalog(CatalogType type, std::string const& filename) {
+bool Stars::readStarsFromCatalog(std::map<CatalogType, std::string> const& catalogs,
+    CatalogType type, std::string const& filename, std::vector<Star>& stars) {
   bool success = false;
   logger().info("Reading star catalog '{}'.", filename);
 
@@ -631,7 +646,7 @@ bool Stars::readStarsFromCatalog(CatalogType type, std::string const& filename)
 
   if (file.is_open()) {
     int  lineCount = 0;
-    bool loadHipparcos(mCatalogs.find(CatalogType::eHipparcos) != mCatalogs.end());
+    bool loadHipparcos(catalogs.find(CatalogType::eHipparcos) != catalogs.end());
 
     // read line by line
     while (!file.eof()) {
@@ -726,19 +741,19 @@ bool Stars::readStarsFromCatalog(CatalogType type, std::string const& filename)
           star.mAscension   = (360.F + 90.F - star.mAscension) / 180.F * Vista::Pi;
           star.mDeclination = star.mDeclination / 180.F * Vista::Pi;
 
-          mStars.emplace_back(star);
+          stars.emplace_back(star);
         }
       }
 
       // Print progress status every 10000 stars.
-      if (mStars.size() % 10000 == 0) {
-        logger().info("Read {} stars so far...", mStars.size());
+      if (stars.size() % 10000 == 0) {
+        logger().info("Read {} stars so far...", stars.size());
       }
     }
     file.close();
     success = true;
 
-    logger().info("Read a total of {} stars.", mStars.size());
+    logger().info("Read a total of {} stars.", stars.size());
   } else {
     logger().error("Failed to load stars: Cannot open catalog file '{}'!", filename);
   }
@@ -748,20 +763,21 @@ bool Stars::readStarsFromCatalog(CatalogType type, std::string const& filename)
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void Stars::writeStarCache(const std::string& sCacheFile) const {
-  VistaType::uint32 catalogs = 0;
-  for (auto const& mCatalog : mCatalogs) {
-    catalogs += static_cast<uint32_t>(std::pow(2, static_cast<int>(mCatalog.first)));
+void Stars::writeStarCache(std::map<CatalogType, std::string> const& catalogs,
+    std::string const& sCacheFile, std::vector<Star> const& stars) {
+  VistaType::uint32 catalogBits = 0;
+  for (auto const& mCatalog : catalogs) {
+    catalogBits += static_cast<uint32_t>(std::pow(2, static_cast<int>(mCatalog.first)));
   }
 
   VistaByteBufferSerializer serializer;
   serializer.WriteInt32(
       static_cast<VistaType::uint32>(cCacheVersion)); // cache format version number
-  serializer.WriteInt32(catalogs);                    // cache format version number
+  serializer.WriteInt32(catalogBits);                 // cache format version number
   serializer.WriteInt32(static_cast<VistaType::uint32>(
-      mStars.size())); // write number of stars to front of byte stream
+      stars.size())); // write number of stars to front of byte stream
 
-  for (const auto& mStar : mStars) {
+  for (const auto& mStar : stars) {
     // serialize star data into byte stream
     serializer.WriteFloat32(mStar.mMagnitude);
     serializer.WriteFloat32(mStar.mTEff);
@@ -775,7 +791,7 @@ void Stars::writeStarCache(const std::string& sCacheFile) const {
   file.open(sCacheFile.c_str(), std::ios::out | std::ios::binary);
   if (file.is_open()) {
     // write serialized star data
-    logger().info("Writing {} stars ({} bytes) into '{}'.", mStars.size(),
+    logger().info("Writing {} stars ({} bytes) into '{}'.", stars.size(),
         serializer.GetBufferSize(), sCacheFile);
 
     // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
@@ -789,7 +805,8 @@ void Stars::writeStarCache(const std::string& sCacheFile) const {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-bool Stars::readStarCache(const std::string& sCacheFile) {
+bool Stars::readStarCache(std::map<CatalogType, std::string> const& catalogs,
+    std::string const& sCacheFile, std::vector<Star>& stars) {
   bool success = false;
 
   // open file
@@ -812,13 +829,13 @@ bool Stars::readStarCache(const std::string& sCacheFile) {
 
     // de-serialize byte stream
     VistaType::uint32 cacheVersion = 0;
-    VistaType::uint32 catalogs     = 0;
+    VistaType::uint32 catalogBits  = 0;
     VistaType::uint32 numStars     = 0;
 
     VistaByteBufferDeSerializer deserializer;
     deserializer.SetBuffer(&data[0], size); // prepare for de-serialization
     deserializer.ReadInt32(cacheVersion);   // read cache format version number
-    deserializer.ReadInt32(catalogs);       // read which catalogs were loaded
+    deserializer.ReadInt32(catalogBits);    // read which catalogs were loaded
     deserializer.ReadInt32(numStars);       // read number of stars from front of byte stream
 
     if (cacheVersion != cCacheVersion) {
@@ -826,11 +843,11 @@ bool Stars::readStarCache(const std::string& sCacheFile) {
     }
 
     VistaType::uint32 catalogsToLoad = 0;
-    for (const auto& mCatalog : mCatalogs) {
+    for (const auto& mCatalog : catalogs) {
       catalogsToLoad += static_cast<uint32_t>(std::pow(2, static_cast<int>(mCatalog.first)));
     }
 
-    if (catalogs != catalogsToLoad) {
+    if (catalogBits != catalogsToLoad) {
       return false;
     }
 
@@ -842,17 +859,17 @@ bool Stars::readStarCache(const std::string& sCacheFile) {
       deserializer.ReadFloat32(star.mDeclination);
       deserializer.ReadFloat32(star.mParallax);
 
-      mStars.emplace_back(star);
+      stars.emplace_back(star);
 
       // print progress status
-      if (mStars.size() % 100000 == 0) {
-        logger().info("Read {} stars so far...", mStars.size());
+      if (stars.size() % 100000 == 0) {
+        logger().info("Read {} stars so far...", stars.size());
       }
     }
 
     success = true;
 
-    logger().info("Read a total of {} stars.", mStars.size());
+    logger().info("Read a total of {} stars.", stars.size());
   }
 
   return success;
@@ -59,6 +59,15 @@ class Stars : public IVistaOpenGLDraw {
     eSRPoint
   };
 
+  /// Data structure of one record from star catalog.
+  struct Star {
+    float mMagnitude;
+    float mTEff;
+    float mAscension;
+    float mDeclination;
+    float mParallax;
+  };
+
   Stars();
   ~Stars() = default;
 
@@ -68,12 +77,21 @@ class Stars : public IVistaOpenGLDraw {
   /// class with the same call to setCatalogs() will use the stars from the cache file rather from
   /// the catalogs.
   void setCatalogs(std::map<CatalogType, std::string> catalogs);
+
+  /// Same as above, but uses stars which have been loaded before with loadCatalogs(). This requires
+  /// an OpenGL context, as the GPU buffers are created.
+  void setCatalogs(std::map<CatalogType, std::string> catalogs, std::vector<Star> stars);
   std::map<CatalogType, std::string> const& getCatalogs() const;
 
   /// Subsequent calls to setCatalogs() will use this cache file. Defaults to "star_cache.dat".
   void               setCacheFile(std::string cacheFile);
   std::string const& getCacheFile() const;
 
+  /// Reads the given catalogs or the given cache file if it contains the same catalogs. This does
+  /// not touch any OpenGL state and can hence be called on a worker thread.
+  static std::vector<Star> loadCatalogs(
+      std::map<CatalogType, std::string> const& catalogs, std::string const& cacheFile);
+
   /// Specifies how the stars should be drawn.
   void     setDrawMode(DrawMode value);
   DrawMode getDrawMode() const;
@@ -131,35 +149,29 @@ class Stars : public IVistaOpenGLDraw {
   bool GetBoundingBox(VistaBoundingBox& oBoundingBox) override;
 
  private:
-  /// Data structure of one record from star catalog.
-  struct Star {
-    float mMagnitude;
-    float mTEff;
-    float mAscension;
-    float mDeclination;
-    float mParallax;
-  };
-
   /// Reads star data from binary file.
-  bool readStarsFromCatalog(CatalogType type, std::string const& filename);
+  static bool readStarsFromCatalog(std::map<CatalogType, std::string> const& catalogs,
+      CatalogType type, std::string const& filename, std::vector<Star>& stars);
 
-  /// Writes internal star data read from catalog into a binary file.
-  void writeStarCache(const std::string& cacheFile) const;
+  /// Writes star data read from catalogs into a binary file.
+  static void writeStarCache(std::map<CatalogType, std::string> const& catalogs,
+      std::string const& cacheFile, std::vector<Star> const& stars);
 
   /// Reads star data from binary file.
-  bool readStarCache(const std::string& cacheFile);
+  static bool readStarCache(std::map<CatalogType, std::string> const& catalogs,
+      std::string const& cacheFile, std::vector<Star>& stars);
 
   /// Build vertex array objects from given star list.
   void buildStarVAO();
   void buildBackgroundVAO();
 
-  std::unique_ptr<VistaTexture> mStarTexture;
+  std::shared_ptr<VistaTexture> mStarTexture;
   std::string                   mStarTextureFile;
 
-  std::unique_ptr<VistaTexture> mCelestialGridTexture;
+  std::shared_ptr<VistaTexture> mCelestialGridTexture;
   std::string                   mCelestialGridTextureFile;
 
-  std::unique_ptr<VistaTexture> mStarFiguresTexture;
+  std::shared_ptr<VistaTexture> mStarFiguresTexture;
   std::string                   mStarFiguresTextureFile;
 
   std::string mCacheFile = "star_cache.dat";
@@ -28,6 +28,14 @@ class TimingsApi extends IApi {
   _cpuTimeData   = [];
   _sampleData    = [];
   _primitiveData = [];
+  _valueData     = [];
+
+  /**
+   * Each of these contains up to eight arrays of five elements:
+   * [<name>, <p50>, <p95>, <p99>, <max>]. All values are in microseconds.
+   */
+  _gpuStatistics = [];
+  _cpuStatistics = [];
 
   /**
    * The index of the currently shown frame data. Should be in the range [0 ... maxStoredFrames-1]
@@ -74,11 +82,12 @@ class TimingsApi extends IApi {
   }
 
   /**
-   * Both arguments should be JSON strings containing an array for each nesting level. Each element
-   * of these should contain an array of timing ranges. Each timing range is an array of three
-   * elements: [<name>, <frame-relative-start>, <frame-relative-end>].
+   * The first two arguments should be JSON strings containing an array for each nesting level. Each
+   * element of these should contain an array of timing ranges. Each timing range is an array of
+   * three elements: [<name>, <frame-relative-start>, <frame-relative-end>]. The remaining arguments
+   * contain arrays of counters: [<name>, <count>].
    */
-  setData(gpuData, cpuData, sampleCounts, primitiveCounts) {
+  setData(gpuData, cpuData, sampleCounts, primitiveCounts, valueCounts) {
     const container = document.getElementById('timings');
 
     // Only update the graph if it's not hovered.
@@ -87,6 +96,7 @@ class TimingsApi extends IApi {
       this._cpuTimeData.unshift(JSON.parse(cpuData));
       this._sampleData.unshift(JSON.parse(sampleCounts));
       this._primitiveData.unshift(JSON.parse(primitiveCounts));
+      this._valueData.unshift(JSON.parse(valueCounts));
 
       if (this._gpuTimeData.length > maxStoredFrames) {
         this._gpuTimeData.pop();
@@ -104,10 +114,43 @@ class TimingsApi extends IApi {
         this._primitiveData.pop();
       }
 
+      if (this._valueData.length > maxStoredFrames) {
+        this._valueData.pop();
+      }
+
       this._redraw();
     }
   }
 
+  /**
+   * Both arguments should be JSON strings containing the percentiles of the slowest ranges. Each
+   * range is an array of five elements: [<name>, <p50>, <p95>, <p99>, <max>]. All values are given
+   * in microseconds.
+   */
+  setStatistics(gpuStatistics, cpuStatistics) {
+    this._gpuStatistics = JSON.parse(gpuStatistics);
+    this._cpuStatistics = JSON.parse(cpuStatistics);
+
+    const container = document.querySelector("#statistics");
+    CosmoScout.gui.clearHtml(container);
+
+    const format = (value) => CosmoScout.utils.formatNumber(value * 0.001);
+
+    let html =
+        "<tr><th></th><th>p50 (ms)</th><th>p95 (ms)</th><th>p99 (ms)</th><th>max (ms)</th></tr>";
+
+    for (const [type, statistics] of [["GPU", this._gpuStatistics], ["CPU", this._cpuStatistics]]) {
+      for (const [name, p50, p95, p99, max] of statistics) {
+        html += `<tr><td>${type}: ${name}</td><td>${format(p50)}</td><td>${format(p95)}</td><td>${
+            format(p99)}</td><td>${format(max)}</td></tr>`;
+      }
+    }
+
+    const content     = document.createElement('template');
+    content.innerHTML = html;
+    container.appendChild(content.content);
+  }
+
   /**
    *
    */
@@ -117,6 +160,7 @@ class TimingsApi extends IApi {
     const cpuContainer        = document.querySelector("#cpu-graph")
     const samplesContainer    = document.querySelector("#samples-graph")
     const primitivesContainer = document.querySelector("#primitives-graph")
+    const valuesContainer     = document.querySelector("#values-graph")
     const gridContainer       = document.querySelector("#grid")
     const fpsContainer        = document.querySelector('#fps-counter');
 
@@ -125,6 +169,7 @@ class TimingsApi extends IApi {
     CosmoScout.gui.clearHtml(cpuContainer);
     CosmoScout.gui.clearHtml(samplesContainer);
     CosmoScout.gui.clearHtml(primitivesContainer);
+    CosmoScout.gui.clearHtml(valuesContainer);
     CosmoScout.gui.clearHtml(gridContainer);
 
     if (this._frameIndex < this._gpuTimeData.length &&
@@ -165,6 +210,14 @@ class TimingsApi extends IApi {
         this._drawCounterBars(primitivesContainer, primitiveData, primitiveData[0][1]);
       }
 
+      let valueData = this._valueData[this._frameIndex] || [];
+      valueData.sort((a, b) => b[1] - a[1]);
+      valueData.length = Math.min(valueData.length, 5);
+
+      if (valueData.length > 0 && valueData[0][1] > 0) {
+        this._drawCounterBars(valuesContainer, valueData, valueData[0][1]);
+      }
+
     } else {
       fpsContainer.innerHTML = "There is no data available for this frame.";
     }
@@ -13,6 +13,7 @@
 #include "../../../src/cs-utils/filesystem.hpp"
 #include "logger.hpp"
 
+#include <algorithm>
 #include <iostream>
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -134,10 +135,29 @@ void Plugin::init() {
         }
       }));
 
+  // This callback enables or disables the multi-threaded timeline tracing.
+  mGuiManager->getGui()->registerCallback("timings.setEnableTracing",
+      "Enables or disables recording of a multi-threaded timeline.",
+      std::function([](bool enable) { cs::utils::FrameStats::get().pEnableTracing = enable; }));
+
+  mTracingConnection =
+      cs::utils::FrameStats::get().pEnableTracing.connectAndTouch([this](bool enable) {
+        mGuiManager->setCheckboxValue("timings.setEnableTracing", enable);
+      });
+
   // Set the mEnableStatistics value based on the corresponding checkbox.
   mGuiManager->getGui()->registerCallback("timings.setEnableStatistics",
       "Shows or hides the on-screen timer statistics.",
-      std::function([this](bool enable) { mEnableStatistics = enable; }));
+      std::function([this](bool enable) {
+        mEnableStatistics = enable;
+
+        // Start with fresh percentiles whenever the statistics are shown, unless a recording is
+        // running.
+        if (enable && !mRecordingWriter) {
+          mGPUStatistics.clear();
+          mCPUStatistics.clear();
+        }
+      }));
 
   // Load settings.
   onLoad();
@@ -157,7 +177,7 @@ void Plugin::update() {
   if (cs::utils::FrameStats::get().pEnableMeasurements.get() &&
       (mEnableRecording || mEnableStatistics)) {
 
-    // Only record ranges longer than 10 µs.
+    // Only draw and record ranges longer than 10 µs.
     const uint32_t minTimeNanos      = 10000;
     auto const&    timerQueryResults = cs::utils::FrameStats::get().getTimerQueryResults();
     uint32_t       maxNestingLevel   = 0;
@@ -168,8 +188,8 @@ void Plugin::update() {
     }
 
     // The outer vector contains all timing ranges for a specific nesting level.
-    std::vector<std::vector<TimerRange>> cpuRanges(maxNestingLevel + 1);
-    std::vector<std::vector<TimerRange>> gpuRanges(maxNestingLevel + 1);
+    FrameRanges cpuRanges(maxNestingLevel + 1);
+    FrameRanges gpuRanges(maxNestingLevel + 1);
 
     // Compute frame-relative timestamps in microseconds.
     if (!timerQueryResults.empty()) {
@@ -177,14 +197,28 @@ void Plugin::update() {
       auto cpuFrameStart = timerQueryResults[0].mCPUStart;
 
       for (auto const& timerQueryResult : timerQueryResults) {
-        if (timerQueryResult.mGPUEnd - timerQueryResult.mGPUStart >= minTimeNanos) {
-          gpuRanges[timerQueryResult.mNestingLevel].emplace_back(timerQueryResult.mName,
+        auto const& name    = timerQueryResult.mRange.getName();
+        auto        gpuTime = timerQueryResult.mGPUEnd - timerQueryResult.mGPUStart;
+        auto        cpuTime = timerQueryResult.mCPUEnd - timerQueryResult.mCPUStart;
+
+        // The statistics include also the very short ranges. Ranges which are only measured on
+        // the CPU or only on the GPU have a zero duration on the other side, these are skipped.
+        if (gpuTime > 0) {
+          mGPUStatistics[timerQueryResult.mRange].add(static_cast<uint32_t>(gpuTime / 1000));
+        }
+
+        if (cpuTime > 0) {
+          mCPUStatistics[timerQueryResult.mRange].add(static_cast<uint32_t>(cpuTime / 1000));
+        }
+
+        if (gpuTime >= minTimeNanos) {
+          gpuRanges[timerQueryResult.mNestingLevel].emplace_back(name,
               static_cast<uint32_t>(timerQueryResult.mGPUStart - gpuFrameStart) / 1000,
               static_cast<uint32_t>(timerQueryResult.mGPUEnd - gpuFrameStart) / 1000);
         }
 
-        if (timerQueryResult.mCPUEnd - timerQueryResult.mCPUStart >= minTimeNanos) {
-          cpuRanges[timerQueryResult.mNestingLevel].emplace_back(timerQueryResult.mName,
+        if (cpuTime >= minTimeNanos) {
+          cpuRanges[timerQueryResult.mNestingLevel].emplace_back(name,
               static_cast<uint32_t>(timerQueryResult.mCPUStart - cpuFrameStart) / 1000,
               static_cast<uint32_t>(timerQueryResult.mCPUEnd - cpuFrameStart) / 1000);
         }
@@ -193,10 +227,11 @@ void Plugin::update() {
 
     auto const& samplesQueryResults    = cs::utils::FrameStats::get().getSamplesQueryResults();
     auto const& primitivesQueryResults = cs::utils::FrameStats::get().getPrimitivesQueryResults();
+    auto const& valueResults           = cs::utils::FrameStats::get().getValueResults();
 
     // Send the timing information to the statistics GUI item.
     if (mEnableStatistics) {
-      auto rangeToJSON = [](std::vector<std::vector<TimerRange>> const& ranges) {
+      auto rangeToJSON = [](FrameRanges const& ranges) {
         nlohmann::json json;
 
         for (auto const& level : ranges) {
@@ -218,7 +253,7 @@ void Plugin::update() {
         nlohmann::json json;
 
         for (auto const& count : counts) {
-          json.push_back({count.mName, count.mCount});
+          json.push_back({count.mRange.getName(), count.mCount});
         }
 
         return json.dump();
@@ -226,99 +261,193 @@ void Plugin::update() {
 
       mGuiItem->callJavascript("CosmoScout.timings.setData", rangeToJSON(gpuRanges),
           rangeToJSON(cpuRanges), countToJSON(samplesQueryResults),
-          countToJSON(primitivesQueryResults));
+          countToJSON(primitivesQueryResults), countToJSON(valueResults));
+
+      // The percentiles change only slowly, so we do not need to send them each frame.
+      const uint32_t statisticsUpdateInterval = 30;
+      if (++mFramesSinceStatisticsUpdate >= statisticsUpdateInterval) {
+        mFramesSinceStatisticsUpdate = 0;
+        sendStatistics();
+      }
     }
 
-    // Store the frame timing if we are in recording-mode.
+    // Stream the frame timing to disk if we are in recording-mode.
     if (mEnableRecording) {
-      mTimestamps.push_back(std::chrono::high_resolution_clock::now().time_since_epoch().count());
-      mRecordedGPURanges.push_back(std::move(gpuRanges));
-      mRecordedCPURanges.push_back(std::move(cpuRanges));
+      if (!mRecordingWriter) {
+        startRecording();
+      }
+
+      if (mRecordingWriter) {
+        mRecordingWriter->writeFrame(
+            std::chrono::high_resolution_clock::now().time_since_epoch().count(), gpuRanges,
+            cpuRanges);
+
+        const auto traceFlushInterval = std::chrono::seconds(10);
+        if (cs::utils::FrameStats::get().pEnableTracing.get() &&
+            std::chrono::steady_clock::now() - mLastTraceFlush >= traceFlushInterval) {
+          flushTrace();
+        }
+      }
     }
   }
 
-  // Recording seems to have stopped last frame, so write the output file!
-  if (!mEnableRecording && !mRecordedGPURanges.empty()) {
-
-    // We use the current date as a directory name.
-    auto timeString =
-        cs::utils::convert::time::toString(boost::posix_time::microsec_clock::local_time());
-    cs::utils::replaceString(timeString, ":", "-");
-    cs::utils::replaceString(timeString, ".", "-");
-    cs::utils::replaceString(timeString, "T", "-");
-    cs::utils::replaceString(timeString, "Z", "");
-
-    std::string directory = "csp-timings/" + timeString;
-    cs::utils::filesystem::createDirectoryRecursively(
-        boost::filesystem::system_complete(directory));
-
-    // This stores a CSV file for each nesting level in the directory created above. The prefix will
-    // be prepended to the CSV file name.
-    auto saveRecording = [&directory, this](std::string const&                        prefix,
-                             std::vector<std::vector<std::vector<TimerRange>>> const& recording) {
-      // Retrieve the maximum nesting level amongst all recorded frames. We need this to decide how
-      // many files to create. The nesting level may actually change during a recording if for
-      // example new objects come into view.
-      std::size_t maxNestingLevel = 0;
-      for (auto const& record : recording) {
-        maxNestingLevel = std::max(maxNestingLevel, record.size());
+  // Recording seems to have stopped last frame, so finish the output files!
+  if (!mEnableRecording && mRecordingWriter) {
+    stopRecording();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Plugin::startRecording() {
+
+  // We use the current date as a directory name.
+  auto timeString =
+      cs::utils::convert::time::toString(boost::posix_time::microsec_clock::local_time());
+  cs::utils::replaceString(timeString, ":", "-");
+  cs::utils::replaceString(timeString, ".", "-");
+  cs::utils::replaceString(timeString, "T", "-");
+  cs::utils::replaceString(timeString, "Z", "");
+
+  mRecordingDirectory = "csp-timings/" + timeString;
+  cs::utils::filesystem::createDirectoryRecursively(
+      boost::filesystem::system_complete(mRecordingDirectory));
+
+  try {
+    mRecordingWriter = std::make_unique<RecordingWriter>(mRecordingDirectory + "/recording.bin");
+  } catch (std::exception const& e) {
+    logger().error("Failed to start recording: {}", e.what());
+    return;
+  }
+
+  // The percentiles of the recording should not include any frames from before.
+  mGPUStatistics.clear();
+  mCPUStatistics.clear();
+
+  mLastTraceFlush = std::chrono::steady_clock::now();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Plugin::stopRecording() {
+
+  // This flushes and closes the binary file.
+  logger().debug("Recorded {} frames.", mRecordingWriter->getFrameCount());
+  mRecordingWriter.reset();
+
+  // Store the percentiles of each range.
+  {
+    std::ofstream csv(mRecordingDirectory + "/statistics.csv");
+    csv << "Type, Range, Count, Mean, P50, P95, P99, Max" << std::endl;
+
+    auto writeStatistics = [&csv](std::string const& type, Statistics const& statistics) {
+      for (auto const& [range, stats] : statistics) {
+        std::string column = range.getName();
+        cs::utils::replaceString(column, ",", "_");
+
+        csv << type << ", " << column << ", " << stats.getCount() << ", " << stats.getMean()
+            << ", " << stats.getPercentile(0.5) << ", " << stats.getPercentile(0.95) << ", "
+            << stats.getPercentile(0.99) << ", " << stats.getMax() << std::endl;
       }
+    };
 
-      // Create a file for each nesting level.
-      for (std::size_t level = 0; level < maxNestingLevel; ++level) {
+    writeStatistics("GPU", mGPUStatistics);
+    writeStatistics("CPU", mCPUStatistics);
+  }
 
-        std::ofstream csv(directory + "/" + prefix + "-level-" + std::to_string(level) + ".csv");
+  // If tracing is enabled, we also store the timeline of all threads. It can be viewed with
+  // chrome://tracing or https://ui.perfetto.dev. As the events are stored in ring buffers, only
+  // the last few seconds of long recordings will be included.
+  {
+    std::lock_guard<std::mutex> lock(mTraceFileMutex);
+    ++mRecordingIndex;
 
-        // Find unique range names in current level over all recorded frames.
-        std::set<std::string> rangeNames;
-        for (auto const& record : recording) {
-          for (auto const& range : record[level]) {
-            std::string name = range.mName;
-            cs::utils::replaceString(name, ",", "_");
-            rangeNames.insert(name);
-          }
-        }
+    if (cs::utils::FrameStats::get().pEnableTracing.get()) {
+      std::ofstream trace(mRecordingDirectory + "/trace.json");
+      cs::utils::FrameStats::writeChromeTrace(trace);
+    }
+  }
 
-        // Write CSV header.
-        csv << "Frame, Timestamp";
-        for (auto const& name : rangeNames) {
-          csv << ", " << name;
+  // Converting long recordings to CSV takes a while, so this is done in the background.
+  mTasks.enqueue(
+      [directory = mRecordingDirectory]() {
+        try {
+          convertRecordingToCSV(directory + "/recording.bin", directory);
+          logger().info("Stored timings recording in '{}'.", directory);
+        } catch (std::exception const& e) {
+          logger().error("Failed to convert timings recording to CSV: {}", e.what());
         }
-        csv << std::endl;
+      },
+      cs::utils::TaskPriority::eLow);
+}
 
-        // Write one CSV line for each frame. If a range has not been recorded for a specific frame,
-        // a zero will be written to the corresponding field.
-        for (std::size_t i = 0; i < recording.size(); ++i) {
+////////////////////////////////////////////////////////////////////////////////////////////////////
 
-          // Accumulate time per range as there may be multiple ranges with the same name.
-          std::map<std::string, uint32_t> rangeTimes;
-          for (auto const& name : rangeNames) {
-            rangeTimes[name] = 0;
-          }
+void Plugin::flushTrace() {
+  mLastTraceFlush = std::chrono::steady_clock::now();
 
-          for (auto const& range : recording[i][level]) {
-            std::string name = range.mName;
-            cs::utils::replaceString(name, ",", "_");
-            rangeTimes[name] += range.mEnd - range.mStart;
-          }
+  if (mTraceFlushPending.exchange(true)) {
+    return;
+  }
 
-          // Write the individual values to the CSV file.
-          csv << i << ", " << mTimestamps[i];
-          for (auto const& time : rangeTimes) {
-            csv << ", " << time.second;
+  // Exporting the ring buffers of all threads takes a while, so this is not done on the main
+  // thread. The file is written under a temporary name first, so that there is always a complete
+  // trace.json, even if the application crashes while writing.
+  mTasks.enqueue(
+      [this, directory = mRecordingDirectory, index = mRecordingIndex.load()]() {
+        std::lock_guard<std::mutex> lock(mTraceFileMutex);
+
+        if (index == mRecordingIndex) {
+          try {
+            {
+              std::ofstream trace(directory + "/trace.json.part");
+              cs::utils::FrameStats::writeChromeTrace(trace);
+            }
+            boost::filesystem::rename(directory + "/trace.json.part", directory + "/trace.json");
+          } catch (std::exception const& e) {
+            logger().warn("Failed to write the thread timeline: {}", e.what());
           }
-          csv << std::endl;
         }
-      }
-    };
 
-    // Call the lambda above, once for the GPU timings, once for the CPU timings.
-    saveRecording("gpu", mRecordedGPURanges);
-    saveRecording("cpu", mRecordedCPURanges);
+        mTraceFlushPending = false;
+      },
+      cs::utils::TaskPriority::eLow);
+}
 
-    mRecordedGPURanges.clear();
-    mRecordedCPURanges.clear();
-  }
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Plugin::sendStatistics() {
+
+  // Only the ranges with the largest p95 are shown.
+  const std::size_t maxRanges = 8;
+
+  auto statisticsToJSON = [maxRanges](Statistics const& statistics) {
+    std::vector<std::pair<cs::utils::FrameStats::RangeId, RangeStatistics const*>> sorted;
+    sorted.reserve(statistics.size());
+
+    for (auto const& [range, stats] : statistics) {
+      sorted.emplace_back(range, &stats);
+    }
+
+    std::size_t count = std::min(maxRanges, sorted.size());
+    std::partial_sort(
+        sorted.begin(), sorted.begin() + count, sorted.end(), [](auto const& a, auto const& b) {
+          return a.second->getPercentile(0.95) > b.second->getPercentile(0.95);
+        });
+
+    nlohmann::json json = nlohmann::json::array();
+
+    for (std::size_t i = 0; i < count; ++i) {
+      auto const& stats = *sorted[i].second;
+      json.push_back({sorted[i].first.getName(), stats.getPercentile(0.5),
+          stats.getPercentile(0.95), stats.getPercentile(0.99), stats.getMax()});
+    }
+
+    return json.dump();
+  };
+
+  mGuiItem->callJavascript("CosmoScout.timings.setStatistics", statisticsToJSON(mGPUStatistics),
+      statisticsToJSON(mCPUStatistics));
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -326,6 +455,11 @@ void Plugin::update() {
 void Plugin::deInit() {
   logger().info("Unloading plugin...");
 
+  // Finish a running recording.
+  if (mRecordingWriter) {
+    stopRecording();
+  }
+
   // Remove the settings tab of this plugin.
   mGuiManager->removeSettingsSection("Frame Timings");
 
@@ -333,6 +467,7 @@ void Plugin::deInit() {
   mGuiManager->getGui()->unregisterCallback("timings.setEnableTimerQueries");
   mGuiManager->getGui()->unregisterCallback("timings.setEnableRecording");
   mGuiManager->getGui()->unregisterCallback("timings.setEnableStatistics");
+  mGuiManager->getGui()->unregisterCallback("timings.setEnableTracing");
 
   // Remove the statistic GUI item. We don't exactly know whether it was attached locally or
   // globally, so we just attempt to remove it in both cases.
@@ -343,6 +478,7 @@ void Plugin::deInit() {
 
   // Disconnect any signals.
   cs::utils::FrameStats::get().pEnableMeasurements.disconnect(mFrameTimingConnection);
+  cs::utils::FrameStats::get().pEnableTracing.disconnect(mTracingConnection);
 
   mAllSettings->onLoad().disconnect(mOnLoadConnection);
   mAllSettings->onSave().disconnect(mOnSaveConnection);
@@ -12,14 +12,25 @@
 #include "../../../src/cs-gui/GuiItem.hpp"
 #include "../../../src/cs-utils/DefaultProperty.hpp"
 #include "../../../src/cs-utils/FrameStats.hpp"
+#include "../../../src/cs-utils/ThreadPool.hpp"
+#include "RangeStatistics.hpp"
+#include "Recording.hpp"
 
+#include <atomic>
+#include <chrono>
 #include <fstream>
 #include <list>
+#include <mutex>
+#include <unordered_map>
 
 namespace csp::timings {
 
 /// A plugin which uses the built-in timer queries of CosmoScout VR to draw on-screen live frame
-/// timing statistics. This plugin can also be used to export recorded time series to CSV files.
+/// timing statistics. This plugin can also be used to record time series. Recordings are streamed
+/// to a compact binary file while they are running and converted to CSV files once they are
+/// stopped. Additionally, the median, p95, p99 and maximum duration of each range is computed
+/// online and shown in the on-screen statistics. If tracing is enabled, a multi-threaded timeline
+/// of the recorded frames is exported as well.
 class Plugin : public cs::core::PluginBase {
  public:
   struct Settings {
@@ -33,23 +44,24 @@ class Plugin : public cs::core::PluginBase {
   void update() override;
 
  private:
-  struct TimerRange {
-    TimerRange(std::string name, uint32_t start, uint32_t end)
-        : mName(std::move(name))
-        , mStart(start)
-        , mEnd(end) {
-    }
-
-    std::string mName;
-
-    // Frame-relative timestamps in microseconds.
-    uint32_t mStart;
-    uint32_t mEnd;
-  };
-
   void onLoad();
   void onSave();
 
+  /// Creates a new output directory and opens the binary recording file in there.
+  void startRecording();
+
+  /// Closes the binary recording file, writes the percentiles and the trace (if enabled) and
+  /// converts the recording to CSV files in a background task.
+  void stopRecording();
+
+  /// Writes the thread timeline of the running recording in a background task. This is done every
+  /// few seconds while recording, so that a crash does not lose the timeline. If the previous
+  /// write has not finished yet, this does nothing.
+  void flushTrace();
+
+  /// Sends the ranges with the largest p95 to the statistics GUI item.
+  void sendStatistics();
+
   Settings mPluginSettings;
 
   /// This store the statistics GUI element.
@@ -58,19 +70,34 @@ class Plugin : public cs::core::PluginBase {
   bool mEnableRecording  = false;
   bool mEnableStatistics = false;
 
-  /// Stores recorded ranges for the GPU and CPU for each frame for each nesting level. So the
-  /// outer-most vector is per recorded frame, the middle per range nesting level and the inner-most
-  /// contains all ranges for the specific level.
-  /// Frame Indices | Nesting Levels | Ranges
-  std::vector<std::vector<std::vector<TimerRange>>> mRecordedGPURanges;
-  std::vector<std::vector<std::vector<TimerRange>>> mRecordedCPURanges;
+  /// This is only set while a recording is running and at least one frame has been recorded.
+  std::unique_ptr<RecordingWriter> mRecordingWriter;
+  std::string                      mRecordingDirectory;
+
+  /// Online statistics of the duration of each range. These are reset whenever a new recording is
+  /// started. The names of the ranges are only resolved when the statistics are reported.
+  using Statistics = std::unordered_map<cs::utils::FrameStats::RangeId, RangeStatistics>;
 
-  /// Sample queries do not support nesting.
-  std::vector<int64_t> mTimestamps;
+  Statistics mGPUStatistics;
+  Statistics mCPUStatistics;
+  uint32_t   mFramesSinceStatisticsUpdate = 0;
+
+  /// The trace file is written by flushTrace() in the background and by stopRecording() on the
+  /// main thread. The mutex serializes both. A background write is skipped if the recording it
+  /// belongs to has been stopped in the meantime, which increments mRecordingIndex.
+  std::chrono::steady_clock::time_point mLastTraceFlush;
+  std::atomic<bool>                     mTraceFlushPending{false};
+  std::atomic<uint32_t>                 mRecordingIndex{0};
+  std::mutex                            mTraceFileMutex;
 
   int mOnLoadConnection      = -1;
   int mOnSaveConnection      = -1;
   int mFrameTimingConnection = -1;
+  int mTracingConnection     = -1;
+
+  /// This is used for converting finished recordings to CSV files. It has to be declared last so
+  /// that pending conversions are finished before the other members are destroyed.
+  cs::utils::TaskGroup mTasks;
 };
 
 } // namespace csp::timings
@@ -0,0 +1,116 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "RangeStatistics.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace csp::timings {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void RangeStatistics::add(uint32_t value) {
+  ++mBuckets[getBucket(value)];
+  ++mCount;
+  mSum += value;
+  mMax = std::max(mMax, value);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void RangeStatistics::reset() {
+  mBuckets.fill(0);
+  mCount = 0;
+  mSum   = 0;
+  mMax   = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+uint64_t RangeStatistics::getCount() const {
+  return mCount;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+uint32_t RangeStatistics::getMax() const {
+  return mMax;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+double RangeStatistics::getMean() const {
+  if (mCount == 0) {
+    return 0.0;
+  }
+
+  return static_cast<double>(mSum) / static_cast<double>(mCount);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+uint32_t RangeStatistics::getPercentile(double percentile) const {
+  if (mCount == 0) {
+    return 0;
+  }
+
+  // This is the rank of the requested value in the sorted list of all values, starting at one.
+  auto rank = static_cast<uint64_t>(std::ceil(std::clamp(percentile, 0.0, 1.0) * mCount));
+  rank      = std::max<uint64_t>(rank, 1);
+
+  uint64_t seen = 0;
+  for (uint32_t i = 0; i < cBucketCount; ++i) {
+    seen += mBuckets[i];
+    if (seen >= rank) {
+      return std::min(getBucketUpperBound(i), mMax);
+    }
+  }
+
+  return mMax;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+uint32_t RangeStatistics::getBucket(uint32_t value) {
+
+  // Small values get a bucket of their own.
+  if (value < cSubBuckets) {
+    return value;
+  }
+
+  // Find the position of the most significant bit. This is at least five, as value >= 32.
+  uint32_t exponent = 5;
+  while (exponent < 31 && (value >> (exponent + 1)) != 0) {
+    ++exponent;
+  }
+
+  // The five bits following the most significant bit select the sub-bucket.
+  uint32_t shift = exponent - 5;
+  uint32_t sub   = (value >> shift) - cSubBuckets;
+
+  return cSubBuckets + shift * cSubBuckets + sub;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+uint32_t RangeStatistics::getBucketUpperBound(uint32_t bucket) {
+  if (bucket < cSubBuckets) {
+    return bucket;
+  }
+
+  uint64_t shift = (bucket - cSubBuckets) / cSubBuckets;
+  uint64_t sub   = (bucket - cSubBuckets) % cSubBuckets;
+  uint64_t lower = (cSubBuckets + sub) << shift;
+  uint64_t upper = lower + (uint64_t(1) << shift) - 1;
+
+  return static_cast<uint32_t>(upper);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace csp::timings
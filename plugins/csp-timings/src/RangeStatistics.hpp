@@ -0,0 +1,63 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#ifndef CSP_TIMINGS_RANGE_STATISTICS_HPP
+#define CSP_TIMINGS_RANGE_STATISTICS_HPP
+
+#include <array>
+#include <cstdint>
+
+namespace csp::timings {
+
+/// This class computes percentiles of a stream of durations without storing the individual values.
+/// The durations are counted in a histogram with logarithmically spaced buckets: each power of two
+/// is split into cSubBuckets linear buckets. Hence the relative error of the reported percentiles
+/// is bounded by 1 / cSubBuckets, regardless of how many values have been added. The memory
+/// footprint is constant (about 4 kB).
+class RangeStatistics {
+ public:
+  /// Each power of two is divided into this many buckets.
+  static constexpr uint32_t cSubBuckets = 32;
+
+  /// Adds a new value to the histogram. The unit is up to the caller, csp-timings uses
+  /// microseconds.
+  void add(uint32_t value);
+
+  /// Removes all values from the histogram.
+  void reset();
+
+  /// Returns the number of values which have been added since the last reset().
+  uint64_t getCount() const;
+
+  /// Returns the largest value which has been added since the last reset(). This value is exact.
+  uint32_t getMax() const;
+
+  /// Returns the arithmetic mean of all values. This value is exact.
+  double getMean() const;
+
+  /// Returns an approximation of the given percentile. The percentile should be in [0...1], for
+  /// example 0.95 for p95. The returned value is the upper bound of the bucket which contains the
+  /// percentile, but never larger than getMax(). Returns zero if no values have been added.
+  uint32_t getPercentile(double percentile) const;
+
+ private:
+  static uint32_t getBucket(uint32_t value);
+  static uint32_t getBucketUpperBound(uint32_t bucket);
+
+  // Values smaller than cSubBuckets are stored in the first cSubBuckets buckets with an exact
+  // resolution. For each of the remaining powers of two up to 2^32 there are cSubBuckets buckets.
+  static constexpr uint32_t cBucketCount = (32 - 5 + 1) * cSubBuckets;
+
+  std::array<uint32_t, cBucketCount> mBuckets{};
+  uint64_t                           mCount = 0;
+  uint64_t                           mSum   = 0;
+  uint32_t                           mMax   = 0;
+};
+
+} // namespace csp::timings
+
+#endif // CSP_TIMINGS_RANGE_STATISTICS_HPP
@@ -0,0 +1,315 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "Recording.hpp"
+
+#include "../../../src/cs-utils/utils.hpp"
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <set>
+#include <stdexcept>
+
+namespace csp::timings {
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+constexpr std::array<char, 8> cMagic   = {'C', 'S', 'T', 'I', 'M', 'I', 'N', 'G'};
+constexpr uint32_t            cVersion = 1;
+
+// The ofstream is given a larger buffer than the default, so that we do not hit the disk for each
+// frame.
+constexpr std::size_t cStreamBufferSize = 1 << 20;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+void write(std::ostream& stream, T value) {
+  stream.write(reinterpret_cast<char const*>(&value), sizeof(T));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The ranges of one frame as read from a recording. Per nesting level, this contains the name ID
+// and the duration in microseconds of each range.
+using RecordedRanges = std::vector<std::vector<std::pair<uint32_t, uint32_t>>>;
+
+/// Reads the records of a file written by the RecordingWriter one frame at a time.
+class RecordingReader {
+ public:
+  explicit RecordingReader(std::string const& file)
+      : mStream(file, std::ios::binary) {
+
+    std::array<char, 8> magic{};
+    mStream.read(magic.data(), magic.size());
+
+    if (!mStream || magic != cMagic || read<uint32_t>() != cVersion) {
+      throw std::runtime_error("File '" + file + "' is not a valid timings recording!");
+    }
+  }
+
+  /// Reads the next frame. Name records in between are stored in mNames, with commas replaced by
+  /// underscores as they would break the CSV format. Returns false once the end of the file is
+  /// reached. If the last frame was only partially written (for example because the application
+  /// crashed), it is silently ignored.
+  bool readFrame(int64_t& timestamp, RecordedRanges& gpuRanges, RecordedRanges& cpuRanges) {
+    char type = 0;
+    while (mStream.get(type)) {
+      if (type == 'N') {
+        auto        id     = read<uint32_t>();
+        auto        length = read<uint32_t>();
+        std::string name(length, ' ');
+        mStream.read(name.data(), length);
+        cs::utils::replaceString(name, ",", "_");
+        mNames[id] = std::move(name);
+      } else if (type == 'F') {
+        timestamp = read<int64_t>();
+        readRanges(gpuRanges);
+        readRanges(cpuRanges);
+        return static_cast<bool>(mStream);
+      } else {
+        return false;
+      }
+    }
+
+    return false;
+  }
+
+  /// Maps name IDs to the range names.
+  std::unordered_map<uint32_t, std::string> mNames;
+
+ private:
+  template <typename T>
+  T read() {
+    T value{};
+    mStream.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return value;
+  }
+
+  void readRanges(RecordedRanges& ranges) {
+    auto levelCount = read<uint32_t>();
+
+    // Never trust sizes read from a possibly truncated file.
+    if (!mStream) {
+      return;
+    }
+
+    ranges.resize(levelCount);
+
+    for (auto& level : ranges) {
+      auto rangeCount = read<uint32_t>();
+
+      if (!mStream) {
+        return;
+      }
+
+      level.resize(rangeCount);
+
+      for (auto& range : level) {
+        range.first = read<uint32_t>();
+        auto start  = read<uint32_t>();
+        auto end    = read<uint32_t>();
+
+        range.second = end - start;
+      }
+    }
+  }
+
+  std::ifstream mStream;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+RecordingWriter::RecordingWriter(std::string const& file)
+    : mBuffer(cStreamBufferSize) {
+
+  // The buffer has to be set before the file is opened.
+  mStream.rdbuf()->pubsetbuf(mBuffer.data(), static_cast<std::streamsize>(mBuffer.size()));
+  mStream.open(file, std::ios::binary);
+
+  if (!mStream) {
+    throw std::runtime_error("Failed to open file '" + file + "' for writing!");
+  }
+
+  mStream.write(cMagic.data(), cMagic.size());
+  write(mStream, cVersion);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void RecordingWriter::writeFrame(
+    int64_t timestamp, FrameRanges const& gpuRanges, FrameRanges const& cpuRanges) {
+
+  // Write the name records first, so that a reader always knows a name before it is referenced.
+  for (auto const* ranges : {&gpuRanges, &cpuRanges}) {
+    for (auto const& level : *ranges) {
+      for (auto const& range : level) {
+        getNameID(range.mName);
+      }
+    }
+  }
+
+  mStream.put('F');
+  write(mStream, timestamp);
+  writeRanges(gpuRanges);
+  writeRanges(cpuRanges);
+
+  ++mFrameCount;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+uint64_t RecordingWriter::getFrameCount() const {
+  return mFrameCount;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+uint32_t RecordingWriter::getNameID(std::string const& name) {
+  auto it = mNameIDs.find(name);
+  if (it != mNameIDs.end()) {
+    return it->second;
+  }
+
+  auto id = static_cast<uint32_t>(mNameIDs.size());
+  mNameIDs.emplace(name, id);
+
+  mStream.put('N');
+  write(mStream, id);
+  write(mStream, static_cast<uint32_t>(name.size()));
+  mStream.write(name.data(), static_cast<std::streamsize>(name.size()));
+
+  return id;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void RecordingWriter::writeRanges(FrameRanges const& ranges) {
+  write(mStream, static_cast<uint32_t>(ranges.size()));
+
+  for (auto const& level : ranges) {
+    write(mStream, static_cast<uint32_t>(level.size()));
+
+    for (auto const& range : level) {
+      write(mStream, mNameIDs.at(range.mName));
+      write(mStream, range.mStart);
+      write(mStream, range.mEnd);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void convertRecordingToCSV(std::string const& file, std::string const& directory) {
+
+  int64_t        timestamp = 0;
+  RecordedRanges gpuRanges;
+  RecordedRanges cpuRanges;
+
+  // In the first pass, we find the unique range names of each level over all recorded frames. The
+  // nesting level may actually change during a recording if for example new objects come into
+  // view.
+  std::vector<std::set<std::string>> gpuColumns;
+  std::vector<std::set<std::string>> cpuColumns;
+
+  {
+    RecordingReader reader(file);
+
+    auto collectColumns = [&](RecordedRanges const&                ranges,
+                              std::vector<std::set<std::string>>& columns) {
+      columns.resize(std::max(columns.size(), ranges.size()));
+      for (std::size_t level = 0; level < ranges.size(); ++level) {
+        for (auto const& range : ranges[level]) {
+          columns[level].insert(reader.mNames[range.first]);
+        }
+      }
+    };
+
+    while (reader.readFrame(timestamp, gpuRanges, cpuRanges)) {
+      collectColumns(gpuRanges, gpuColumns);
+      collectColumns(cpuRanges, cpuColumns);
+    }
+  }
+
+  // In the second pass, we write one CSV line for each frame to each file.
+  RecordingReader reader(file);
+
+  struct CSVFile {
+    std::unique_ptr<std::ofstream>               mStream;
+    std::unordered_map<std::string, std::size_t> mColumnIndices;
+    std::vector<uint32_t>                        mRow;
+  };
+
+  auto createFiles = [&directory](std::string const& prefix,
+                         std::vector<std::set<std::string>> const& columns) {
+    std::vector<CSVFile> files(columns.size());
+
+    for (std::size_t level = 0; level < columns.size(); ++level) {
+      auto& csv = files[level];
+
+      csv.mStream = std::make_unique<std::ofstream>(
+          directory + "/" + prefix + "-level-" + std::to_string(level) + ".csv");
+      csv.mRow.resize(columns[level].size());
+
+      // Write CSV header.
+      *csv.mStream << "Frame, Timestamp";
+      for (auto const& name : columns[level]) {
+        std::size_t index = csv.mColumnIndices.size();
+        csv.mColumnIndices.emplace(name, index);
+        *csv.mStream << ", " << name;
+      }
+      *csv.mStream << std::endl;
+    }
+
+    return files;
+  };
+
+  auto gpuFiles = createFiles("gpu", gpuColumns);
+  auto cpuFiles = createFiles("cpu", cpuColumns);
+
+  auto writeLines = [&](uint64_t frame, RecordedRanges const& ranges,
+                        std::vector<CSVFile>& files) {
+    for (std::size_t level = 0; level < files.size(); ++level) {
+      auto& csv = files[level];
+
+      // Accumulate time per range as there may be multiple ranges with the same name. If a range
+      // has not been recorded for a specific frame, a zero will be written to the corresponding
+      // field.
+      std::fill(csv.mRow.begin(), csv.mRow.end(), 0);
+
+      if (level < ranges.size()) {
+        for (auto const& range : ranges[level]) {
+          csv.mRow[csv.mColumnIndices.at(reader.mNames[range.first])] += range.second;
+        }
+      }
+
+      *csv.mStream << frame << ", " << timestamp;
+      for (auto time : csv.mRow) {
+        *csv.mStream << ", " << time;
+      }
+      *csv.mStream << "\n";
+    }
+  };
+
+  uint64_t frame = 0;
+  while (reader.readFrame(timestamp, gpuRanges, cpuRanges)) {
+    writeLines(frame, gpuRanges, gpuFiles);
+    writeLines(frame, cpuRanges, cpuFiles);
+    ++frame;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace csp::timings
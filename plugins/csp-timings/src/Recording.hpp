@@ -0,0 +1,89 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#ifndef CSP_TIMINGS_RECORDING_HPP
+#define CSP_TIMINGS_RECORDING_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace csp::timings {
+
+/// A single timer range of one frame.
+struct TimerRange {
+  TimerRange(std::string name, uint32_t start, uint32_t end)
+      : mName(std::move(name))
+      , mStart(start)
+      , mEnd(end) {
+  }
+
+  std::string mName;
+
+  // Frame-relative timestamps in microseconds.
+  uint32_t mStart;
+  uint32_t mEnd;
+};
+
+/// The ranges of one frame, grouped by nesting level.
+using FrameRanges = std::vector<std::vector<TimerRange>>;
+
+/// The RecordingWriter streams recorded frames to a compact binary file while the recording is
+/// running. This way, the memory footprint of a recording does not grow with its length. Each range
+/// name is written only once, subsequent occurrences reference it by a numerical ID. The file can
+/// be converted to CSV files with convertRecordingToCSV() once the recording is finished.
+///
+/// The file layout is as follows (all values in native byte order):
+///   "CSTIMING" uint32_t:version
+///   followed by any number of records which start with a one-byte record type:
+///   'N' uint32_t:nameID uint32_t:length char[length]:name
+///   'F' int64_t:timestamp  [GPU ranges] [CPU ranges]
+///   The ranges are stored as uint32_t:levelCount and then for each level uint32_t:rangeCount
+///   followed by rangeCount times uint32_t:nameID uint32_t:start uint32_t:end.
+class RecordingWriter {
+ public:
+  /// Opens the given file for writing. Throws a std::runtime_error if this fails.
+  explicit RecordingWriter(std::string const& file);
+
+  RecordingWriter(RecordingWriter const& other) = delete;
+  RecordingWriter(RecordingWriter&& other)      = delete;
+
+  RecordingWriter& operator=(RecordingWriter const& other) = delete;
+  RecordingWriter& operator=(RecordingWriter&& other)      = delete;
+
+  ~RecordingWriter() = default;
+
+  /// Appends one frame to the file. The timestamp is stored as-is.
+  void writeFrame(int64_t timestamp, FrameRanges const& gpuRanges, FrameRanges const& cpuRanges);
+
+  /// Returns the number of frames written so far.
+  uint64_t getFrameCount() const;
+
+ private:
+  uint32_t getNameID(std::string const& name);
+  void     writeRanges(FrameRanges const& ranges);
+
+  // The buffer has to outlive the stream, so it is declared first.
+  std::vector<char>                         mBuffer;
+  std::ofstream                             mStream;
+  std::unordered_map<std::string, uint32_t> mNameIDs;
+  uint64_t                                  mFrameCount = 0;
+};
+
+/// Reads a file written by the RecordingWriter and stores one CSV file for each nesting level of
+/// the GPU and the CPU ranges in the given directory. The files are called gpu-level-<N>.csv and
+/// cpu-level-<N>.csv. Each line contains the frame index, the timestamp and the accumulated time
+/// in microseconds of each range name. The input file is read twice, so the memory footprint only
+/// depends on the number of distinct range names. Throws a std::runtime_error if the file cannot
+/// be read.
+void convertRecordingToCSV(std::string const& file, std::string const& directory);
+
+} // namespace csp::timings
+
+#endif // CSP_TIMINGS_RECORDING_HPP
@@ -0,0 +1,51 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "../src/RangeStatistics.hpp"
+#include "../../../src/cs-utils/doctest.hpp"
+
+namespace csp::timings {
+TEST_CASE("csp::timings::RangeStatistics") {
+  RangeStatistics stats;
+
+  CHECK(stats.getCount() == 0);
+  CHECK(stats.getPercentile(0.5) == 0);
+
+  for (uint32_t i = 1; i <= 10000; ++i) {
+    stats.add(i);
+  }
+
+  CHECK(stats.getCount() == 10000);
+  CHECK(stats.getMax() == 10000);
+  CHECK(stats.getMean() == doctest::Approx(5000.5));
+
+  // The relative error is bounded by 1 / RangeStatistics::cSubBuckets.
+  for (double p : {0.5, 0.95, 0.99}) {
+    CHECK(stats.getPercentile(p) >= p * 10000);
+    CHECK(stats.getPercentile(p) <= p * 10000 * (1.0 + 1.0 / RangeStatistics::cSubBuckets));
+  }
+
+  CHECK(stats.getPercentile(1.0) == 10000);
+
+  stats.reset();
+  CHECK(stats.getCount() == 0);
+  CHECK(stats.getMax() == 0);
+}
+
+TEST_CASE("csp::timings::RangeStatistics with small values") {
+  RangeStatistics stats;
+
+  for (uint32_t i = 0; i < 10; ++i) {
+    stats.add(3);
+  }
+  stats.add(0xFFFFFFFF);
+
+  // Values below RangeStatistics::cSubBuckets are exact.
+  CHECK(stats.getPercentile(0.5) == 3);
+  CHECK(stats.getPercentile(1.0) == 0xFFFFFFFF);
+}
+} // namespace csp::timings
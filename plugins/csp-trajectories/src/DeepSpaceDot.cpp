@@ -137,13 +137,20 @@ DeepSpaceDot::~DeepSpaceDot() {
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void DeepSpaceDot::setObjectName(std::string objectName) {
-  mObjectName = std::move(objectName);
+  mObject     = mSolarSystem->getObjectHandle(objectName);
+  mTimerRange = cs::utils::FrameStats::RangeId("DeepSpaceDot for " + objectName);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 std::string const& DeepSpaceDot::getObjectName() const {
-  return mObjectName;
+  return mObject.getName();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::shared_ptr<const cs::scene::CelestialObject> const& DeepSpaceDot::getObject() const {
+  return mObject.get();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -153,7 +160,7 @@ bool DeepSpaceDot::Do() {
     return true;
   }
 
-  auto object = mSolarSystem->getObject(mObjectName);
+  auto const& object = mObject.get();
   if (!object) {
     return true;
   }
@@ -182,7 +189,7 @@ bool DeepSpaceDot::Do() {
     mShaderDirty = false;
   }
 
-  cs::utils::FrameStats::ScopedTimer timer("DeepSpaceDot for " + mObjectName);
+  cs::utils::FrameStats::ScopedTimer timer(mTimerRange);
 
   // get model view and projection matrices
   std::array<GLfloat, 16> glMatMV{};
@@ -9,6 +9,7 @@
 #define CSP_TRAJECTORIES_DEEP_SPACE_DOT_HPP
 
 #include "../../../src/cs-core/SolarSystem.hpp"
+#include "../../../src/cs-utils/FrameStats.hpp"
 #include "../../../src/cs-utils/utils.hpp"
 
 #include <VistaBase/VistaColor.h>
@@ -72,6 +73,10 @@ class DeepSpaceDot : public IVistaOpenGLDraw {
   void               setObjectName(std::string objectName);
   std::string const& getObjectName() const;
 
+  /// Returns the object the dot is attached to. This may be a nullptr if no object with the given
+  /// name exists.
+  std::shared_ptr<const cs::scene::CelestialObject> const& getObject() const;
+
   bool Do() override;
   bool GetBoundingBox(VistaBoundingBox& bb) override;
 
@@ -80,7 +85,8 @@ class DeepSpaceDot : public IVistaOpenGLDraw {
 
   std::unique_ptr<VistaOpenGLNode>       mGLNode;
   std::shared_ptr<cs::core::SolarSystem> mSolarSystem;
-  std::string                            mObjectName;
+  cs::core::ObjectHandle                 mObject;
+  cs::utils::FrameStats::RangeId         mTimerRange;
 
   bool mShaderDirty = true;
 
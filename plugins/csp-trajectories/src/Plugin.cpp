@@ -173,9 +173,8 @@ void Plugin::update() {
 
     // Hide all dots if the orbit of the object they are attached to is not visible.
     if (visible) {
-      auto objectName = dot->getObjectName();
-      auto object     = mSolarSystem->getObject(objectName);
-      visible         = object && object->getIsOrbitVisible();
+      auto const& object = dot->getObject();
+      visible            = object && object->getIsOrbitVisible();
     }
 
     dot->pVisible = visible;
@@ -205,8 +204,7 @@ void Plugin::update() {
       mPluginSettings->mEnableLDRFlares.get() && !mAllSettings->mGraphics.pEnableHDR.get();
   for (auto const& flare : mLDRFlares) {
     if (updateVisibility(flare, ldrFlaresEnabled)) {
-      auto objectName = flare->getObjectName();
-      auto object     = mSolarSystem->getObject(objectName);
+      auto const& object = flare->getObject();
 
       double bodyDist        = glm::length(object->getObserverRelativePosition());
       double sceneScale      = mSolarSystem->getObserver().getScale();
@@ -230,8 +228,7 @@ void Plugin::update() {
       mPluginSettings->mEnableHDRFlares.get() && mAllSettings->mGraphics.pEnableHDR.get();
   for (auto const& flare : mHDRFlares) {
     if (updateVisibility(flare, hdrFlaresEnabled)) {
-      auto objectName = flare->getObjectName();
-      auto object     = mSolarSystem->getObject(objectName);
+      auto const& object = flare->getObject();
 
       auto   toBody   = object->getObserverRelativePosition();
       double bodyDist = glm::length(toBody);
@@ -59,11 +59,10 @@ void Trajectory::update(double tTime) {
     return;
   }
 
-  cs::utils::FrameStats::ScopedTimer timer(
-      "Trajectory of " + mTargetName, cs::utils::FrameStats::TimerMode::eCPU);
+  cs::utils::FrameStats::ScopedTimer timer(mTimerRange, cs::utils::FrameStats::TimerMode::eCPU);
 
-  auto parent = mSolarSystem->getObject(mParentName);
-  auto target = mSolarSystem->getObject(mTargetName);
+  auto const& parent = mParent.get();
+  auto const& target = mTarget.get();
 
   if (parent && target && parent->getIsInExistence() && target->getIsOrbitVisible()) {
     double dLengthSeconds = pLength.get() * 24.0 * 60.0 * 60.0;
@@ -132,7 +131,7 @@ void Trajectory::update(double tTime) {
       mLastUpdateTime = tTime;
 
       if (completeRecalculation) {
-        logger().debug("Recalculating trajectory for {}.", mTargetName);
+        logger().debug("Recalculating trajectory for {}.", mTarget.getName());
       }
     }
 
@@ -155,26 +154,27 @@ void Trajectory::update(double tTime) {
 
 void Trajectory::setTargetName(std::string objectName) {
   mPoints.clear();
-  mTargetName = std::move(objectName);
+  mTarget     = mSolarSystem->getObjectHandle(objectName);
+  mTimerRange = cs::utils::FrameStats::RangeId("Trajectory of " + objectName);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void Trajectory::setParentName(std::string objectName) {
   mPoints.clear();
-  mParentName = std::move(objectName);
+  mParent = mSolarSystem->getObjectHandle(objectName);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 std::string const& Trajectory::getTargetName() const {
-  return mTargetName;
+  return mTarget.getName();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 std::string const& Trajectory::getParentName() const {
-  return mParentName;
+  return mParent.getName();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -184,11 +184,11 @@ bool Trajectory::Do() {
     return true;
   }
 
-  auto parent = mSolarSystem->getObject(mParentName);
-  auto target = mSolarSystem->getObject(mTargetName);
+  auto const& parent = mParent.get();
+  auto const& target = mTarget.get();
 
-  if (parent->getIsInExistence() && target->getIsOrbitVisible()) {
-    cs::utils::FrameStats::ScopedTimer timer("Trajectory of " + mTargetName);
+  if (parent && target && parent->getIsInExistence() && target->getIsOrbitVisible()) {
+    cs::utils::FrameStats::ScopedTimer timer(mTimerRange);
     mTrajectory.Do();
   }
 
@@ -10,8 +10,10 @@
 
 #include "Plugin.hpp"
 
+#include "../../../src/cs-core/ObjectHandle.hpp"
 #include "../../../src/cs-scene/CelestialObject.hpp"
 #include "../../../src/cs-scene/Trajectory.hpp"
+#include "../../../src/cs-utils/FrameStats.hpp"
 
 #include <VistaBase/VistaColor.h>
 #include <VistaKernel/GraphicsManager/VistaOpenGLDraw.h>
@@ -63,8 +65,10 @@ class Trajectory : public IVistaOpenGLDraw {
 
   std::unique_ptr<VistaOpenGLNode> mGLNode;
 
-  std::string mTargetName;
-  std::string mParentName;
+  cs::core::ObjectHandle mTarget;
+  cs::core::ObjectHandle mParent;
+
+  cs::utils::FrameStats::RangeId mTimerRange;
 
   std::vector<glm::dvec4> mPoints;
   int                     mStartIndex     = 0;
@@ -11,6 +11,7 @@
 #include "../../../src/cs-core/Settings.hpp"
 #include "../../../src/cs-core/SolarSystem.hpp"
 #include "../../../src/cs-scene/CelestialObserver.hpp"
+#include "../../../src/cs-utils/FrameStats.hpp"
 #include "../../../src/cs-utils/logger.hpp"
 #include "../../../src/cs-utils/utils.hpp"
 #include "logger.hpp"
@@ -24,14 +25,8 @@
 #include <VistaKernel/VistaFrameLoop.h>
 #include <VistaKernel/VistaSystem.h>
 #include <VistaOGLExt/VistaTexture.h>
+#include <algorithm>
 #include <curlpp/cURLpp.hpp>
-#include <glm/gtc/type_ptr.hpp>
-#include <sstream>
-#include <tiffio.h>
-#include <tiffio.hxx>
-
-#define STB_IMAGE_WRITE_IMPLEMENTATION
-#include <stb_image_write.h>
 #include <utility>
 
 #include "../../../src/cs-core/GraphicsEngine.hpp"
@@ -54,56 +49,6 @@ namespace {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-// Appends void* data to a std::vector<std::byte> (which is given through a void* as well). So this
-// is pretty unsafe, but I think it's the only way to make stb_image write to a
-// std::vector<std::byte>.
-void stbWriteToVector(void* context, void* data, int len) {
-  auto* vector   = static_cast<std::vector<std::byte>*>(context);
-  auto* charData = static_cast<std::byte*>(data);
-  // NOLINTNEXTLINE (cppcoreguidelines-pro-bounds-pointer-arithmetic)
-  vector->insert(vector->end(), charData, charData + len);
-}
-
-// Encodes the pixel data in "in" to a in-memory tiff in "out".
-template <typename T>
-void tiffWriteToVector(std::vector<std::byte>& out, std::vector<T>& in, uint32_t width,
-    uint32_t height, uint32_t samples, uint32_t bits) {
-
-  std::ostringstream oStream;
-  TIFF*              tiff = TIFFStreamOpen("MemTIFF", &oStream);
-
-  TIFFSetField(tiff, TIFFTAG_IMAGEWIDTH, width);
-  TIFFSetField(tiff, TIFFTAG_IMAGELENGTH, height);
-  TIFFSetField(tiff, TIFFTAG_SAMPLESPERPIXEL, samples);
-  TIFFSetField(tiff, TIFFTAG_BITSPERSAMPLE, bits);
-  TIFFSetField(tiff, TIFFTAG_ORIENTATION, ORIENTATION_TOPLEFT);
-  TIFFSetField(tiff, TIFFTAG_ROWSPERSTRIP, 16);
-  TIFFSetField(tiff, TIFFTAG_COMPRESSION, COMPRESSION_NONE);
-  TIFFSetField(tiff, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
-  TIFFSetField(tiff, TIFFTAG_SAMPLEFORMAT, SAMPLEFORMAT_IEEEFP);
-
-  if (samples == 3) {
-    TIFFSetField(tiff, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_RGB);
-  } else {
-    TIFFSetField(tiff, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_MINISBLACK);
-  }
-
-  for (uint32_t i(0); i < height; ++i) {
-    TIFFWriteScanline(tiff, &in.at((height - i - 1) * width * samples), i);
-  }
-
-  TIFFClose(tiff);
-
-  // Convert the stringstream to a std::vector<std::byte>.
-  std::string s = oStream.str();
-  out.reserve(s.size());
-
-  std::transform(s.begin(), s.end(), std::back_inserter(out),
-      [](char& c) { return static_cast<std::byte>(c); });
-}
-
-////////////////////////////////////////////////////////////////////////////////////////////////////
-
 // A simple wrapper class which basically allows registering of lambdas as endpoint handlers for
 // our CivetServer. This one handles GET requests.
 class GetHandler : public CivetHandler {
@@ -230,6 +175,8 @@ void Plugin::init() {
 
   // Return a json object containing the current scene settings.
   mHandlers.emplace("/save", std::make_unique<GetHandler>([this](mg_connection* conn) {
+    std::lock_guard<std::mutex> requestLock(mSaveRequestMutex);
+
     // This string will contain the json data at the end of this method.
     std::string response;
     {
@@ -249,6 +196,32 @@ void Plugin::init() {
     mg_write(conn, response.data(), response.length());
   }));
 
+  // Returns a multi-threaded timeline of the next few frames in the Chrome Trace Event format. It
+  // can be viewed with chrome://tracing or https://ui.perfetto.dev. Tracing is enabled for the
+  // requested number of frames in the Plugin::update() method further below.
+  mHandlers.emplace("/trace", std::make_unique<GetHandler>([this](mg_connection* conn) {
+    std::lock_guard<std::mutex> requestLock(mTraceRequestMutex);
+
+    std::string response;
+    {
+      std::unique_lock<std::mutex> lock(mTraceMutex);
+
+      mTraceFrames    = std::clamp(getParam<int32_t>(conn, "frames", 100), 1, 10000);
+      mTraceRequested = true;
+      mTraceReady     = false;
+
+      // The predicate protects against spurious wake-ups, which would return an empty trace.
+      mTraceDone.wait(lock, [this]() { return mTraceReady; });
+
+      response = std::move(mTrace);
+      mTrace.clear();
+      mTraceReady = false;
+    }
+
+    mg_send_http_ok(conn, "application/json", response.length());
+    mg_write(conn, response.data(), response.length());
+  }));
+
   // Allows uploading of the current scene settings.
   mHandlers.emplace("/load", std::make_unique<PostHandler>([this](mg_connection* conn) {
     std::lock_guard<std::mutex> lock(mLoadMutex);
@@ -262,45 +235,134 @@ void Plugin::init() {
   // The /capture endpoint is a little bit more involved. As it takes several frames for the
   // capture to be completed (first we have to resize CosmoScout's window to the requested size,
   // then we have to wait some frames so that everything is loaded properly), we have to do some
-  // more synchronization here.
+  // more synchronization here. The request is queued and the main thread fulfills the promise once
+  // the image has been read back and encoded.
   mHandlers.emplace("/capture", std::make_unique<GetHandler>([this](mg_connection* conn) {
-    // First acquire the lock to make sure the mCapture* members are not currently read by the
-    // main thread.
-    std::unique_lock<std::mutex> lock(mCaptureMutex);
+    auto request = std::make_shared<CaptureRequest>();
 
     // Read all paramters.
-    mCaptureDelay  = std::clamp(getParam<int32_t>(conn, "delay", 50), 1, 200);
-    mCaptureWidth  = std::clamp(getParam<int32_t>(conn, "width", 0), 0, 4096);
-    mCaptureHeight = std::clamp(getParam<int32_t>(conn, "height", 0), 0, 4096);
-    mRestoreState  = getParam<std::string>(conn, "restoreState", "false") == "true";
-    mCaptureGui    = getParam<std::string>(conn, "gui", "auto");
-    mCaptureDepth  = getParam<std::string>(conn, "depth", "false") == "true";
-    mCaptureFormat = getParam<std::string>(conn, "format", mCaptureDepth ? "tiff" : "png");
+    request->mDelay        = std::clamp(getParam<int32_t>(conn, "delay", 50), 1, 200);
+    request->mWidth        = std::clamp(getParam<int32_t>(conn, "width", 0), 0, 4096);
+    request->mHeight       = std::clamp(getParam<int32_t>(conn, "height", 0), 0, 4096);
+    request->mRestoreState = getParam<std::string>(conn, "restoreState", "false") == "true";
+    request->mGui          = getParam<std::string>(conn, "gui", "auto");
+    request->mDepth        = getParam<std::string>(conn, "depth", "false") == "true";
+
+    auto formatName = getParam<std::string>(conn, "format", request->mDepth ? "tiff" : "png");
+    auto format     = cs::graphics::FrameCapture::parseFormat(formatName);
 
     // Validate format parameter.
-    if (mCaptureFormat != "png" && mCaptureFormat != "jpeg" && mCaptureFormat != "tiff" &&
-        mCaptureFormat != "raw") {
+    if (!format) {
       mg_send_http_error(
           conn, 422, "Only 'png', 'jpeg', 'tiff' or 'raw' are allowed for the format parameter!");
       return;
     }
 
     // Validate gui parameter.
-    if (mCaptureGui != "auto" && mCaptureGui != "true" && mCaptureGui != "false") {
+    if (request->mGui != "auto" && request->mGui != "true" && request->mGui != "false") {
       mg_send_http_error(
           conn, 422, "Only 'auto', 'true', or 'false' are allowed for the gui parameter!");
       return;
     }
 
-    // This tells the main thread that a capture request is pending.
-    mCaptureRequested = true;
+    request->mFormat = *format;
+    auto result      = request->mResult.get_future();
+
+    // This tells the main thread that a capture request is pending. It is actually captured in the
+    // Plugin::updateCapture() method further below.
+    {
+      std::lock_guard<std::mutex> lock(mCaptureMutex);
+      if (!mCaptureAborted) {
+        mCaptureRequests.push_back(std::move(request));
+      }
+    }
+
+    // The promise is destroyed without a value if the server is stopped in the meantime. In this
+    // case, or if the request arrived while the server is shutting down, we send an error.
+    std::vector<std::byte> capture;
+    try {
+      capture = result.get();
+    } catch (std::future_error const&) {}
+
+    if (capture.empty()) {
+      mg_send_http_error(conn, 503, "The capture has been aborted!");
+      return;
+    }
 
-    // Now we use a condition variable to wait for the capture. It is actually captured in the
-    // Plugin::update() method further below.
-    mCaptureDone.wait(lock);
     // The capture has been captured, return the result!
-    mg_send_http_ok(conn, ("image/" + mCaptureFormat).c_str(), mCapture.size());
-    mg_write(conn, mCapture.data(), mCapture.size());
+    mg_send_http_ok(conn, ("image/" + formatName).c_str(), capture.size());
+    mg_write(conn, capture.data(), capture.size());
+  }));
+
+  // The /stream endpoint continuously sends the latest frame as a multipart response. With the
+  // default jpeg format, this is an MJPEG stream which can be displayed directly by web browsers.
+  // The frames are read back in the Plugin::updateStreams() method further below.
+  mHandlers.emplace("/stream", std::make_unique<GetHandler>([this](mg_connection* conn) {
+    auto formatName = getParam<std::string>(conn, "format", "jpeg");
+    auto format     = cs::graphics::FrameCapture::parseFormat(formatName);
+
+    if (!format || format == cs::graphics::FrameCapture::Format::eTIFF) {
+      mg_send_http_error(
+          conn, 422, "Only 'jpeg', 'png' or 'raw' are allowed for the format parameter!");
+      return;
+    }
+
+    auto client     = std::make_shared<StreamClient>();
+    client->mFormat = *format;
+
+    {
+      std::lock_guard<std::mutex> lock(mStreams->mMutex);
+
+      if (mStreams->mClients.size() >= cMaxStreamClients) {
+        mg_send_http_error(conn, 503, "Too many open streams! Only %zu are allowed at a time.",
+            cMaxStreamClients);
+        return;
+      }
+
+      client->mClosed = mStreams->mClosed;
+      mStreams->mClients.push_back(client);
+    }
+
+    mg_printf(conn, "HTTP/1.1 200 OK\r\n"
+                    "Content-Type: multipart/x-mixed-replace; boundary=frame\r\n"
+                    "Cache-Control: no-cache\r\n"
+                    "Connection: close\r\n\r\n");
+
+    int32_t lastFrameIndex = 0;
+
+    while (true) {
+      std::shared_ptr<std::vector<std::byte> const> frame;
+      int32_t                                       width  = 0;
+      int32_t                                       height = 0;
+
+      {
+        std::unique_lock<std::mutex> lock(client->mMutex);
+        client->mFrameAvailable.wait(
+            lock, [&]() { return client->mClosed || client->mFrameIndex != lastFrameIndex; });
+
+        if (client->mClosed) {
+          break;
+        }
+
+        frame          = client->mFrame;
+        width          = client->mWidth;
+        height         = client->mHeight;
+        lastFrameIndex = client->mFrameIndex;
+      }
+
+      // The resolution is sent along with each part, as it is required for decoding raw frames.
+      if (mg_printf(conn,
+              "--frame\r\nContent-Type: image/%s\r\nContent-Length: %zu\r\n"
+              "X-Width: %d\r\nX-Height: %d\r\n\r\n",
+              formatName.c_str(), frame->size(), width, height) <= 0 ||
+          mg_write(conn, frame->data(), frame->size()) <= 0 || mg_printf(conn, "\r\n") <= 0) {
+        break;
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(mStreams->mMutex);
+    auto&                       clients = mStreams->mClients;
+    clients.erase(std::remove(clients.begin(), clients.end(), client), clients.end());
   }));
 
   // All POST requests received on /run-js are stored in a queue. They are executed in the main
@@ -371,6 +433,30 @@ void Plugin::update() {
     }
   }
 
+  // Execute any pending /trace request. Tracing is enabled for the requested number of frames, then
+  // the collected events are exported and the previous tracing state is restored.
+  {
+    std::lock_guard<std::mutex> lock(mTraceMutex);
+    auto&                       frameStats = cs::utils::FrameStats::get();
+    int32_t                     frameCount = GetVistaSystem()->GetFrameLoop()->GetFrameCount();
+
+    if (mTraceRequested) {
+      logger().debug("Executing '/trace' request for {} frames.", mTraceFrames);
+      mRestoreTracing           = frameStats.pEnableTracing.get();
+      frameStats.pEnableTracing = true;
+      mTraceAtFrame             = frameCount + mTraceFrames;
+      mTraceRequested           = false;
+    }
+
+    if (mTraceAtFrame > 0 && mTraceAtFrame <= frameCount) {
+      mTrace                    = cs::utils::FrameStats::getChromeTrace();
+      frameStats.pEnableTracing = mRestoreTracing;
+      mTraceAtFrame             = 0;
+      mTraceReady               = true;
+      mTraceDone.notify_one();
+    }
+  }
+
   // Execute any pending /load request.
   {
     std::lock_guard<std::mutex> lock(mLoadMutex);
@@ -386,155 +472,171 @@ void Plugin::update() {
     }
   }
 
-  // If a screen shot has been requested, we first resize the image to the given size. Then we wait
-  // mCaptureDelay frames until we actually read the pixels.
-  {
-    std::lock_guard<std::mutex> lock(mCaptureMutex);
-    if (mCaptureRequested) {
-      if (mCaptureWidth > 0 && mCaptureHeight > 0) {
-        auto* window = GetVistaSystem()->GetDisplayManager()->GetWindows().begin()->second;
-        window->GetWindowProperties()->GetSize(mRestoreW, mRestoreH);
-        window->GetWindowProperties()->SetSize(mCaptureWidth, mCaptureHeight);
-      }
-      mCaptureAtFrame = GetVistaSystem()->GetFrameLoop()->GetFrameCount() + mCaptureDelay;
-      if (mCaptureGui != "auto") {
-        mRestoreGui                        = mAllSettings->pEnableUserInterface.get();
-        mAllSettings->pEnableUserInterface = mCaptureGui == "true";
+  // Check for finished reads of the /capture and /stream endpoints. The frame capture is created
+  // lazily as it is destroyed whenever the server is stopped.
+  if (!mFrameCapture) {
+    mFrameCapture = std::make_unique<cs::graphics::FrameCapture>();
+  }
+
+  mFrameCapture->update();
+
+  updateCapture();
+  updateStreams();
+
+  // In this plugin, we cannot call this directly when the onLoad signal of the settings is fired,
+  // since reloading can cause our server to be restarted. And as reloading can be triggered from a
+  // /load request, this could lead to a deadlock.
+  if (mReloadRequired) {
+    from_json(mAllSettings->mPlugins.at("csp-web-api"), mPluginSettings);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Plugin::updateCapture() {
+
+  // If no capture is currently being processed, we start with the next one. We first resize the
+  // window to the given size. Then we wait mDelay frames until we actually read the pixels.
+  if (!mActiveCapture) {
+    {
+      std::lock_guard<std::mutex> lock(mCaptureMutex);
+      if (mCaptureRequests.empty()) {
+        return;
       }
-      mCaptureRequested = false;
-    }
 
-    // Now we waited several frames. We read the pixels, encode the data as png and notify the
-    // server's worker thread that the screen shot is done.
-    if (mCaptureAtFrame > 0 &&
-        mCaptureAtFrame == GetVistaSystem()->GetFrameLoop()->GetFrameCount()) {
+      mActiveCapture = std::move(mCaptureRequests.front());
+      mCaptureRequests.pop_front();
+    }
 
+    if (mActiveCapture->mWidth > 0 && mActiveCapture->mHeight > 0) {
       auto* window = GetVistaSystem()->GetDisplayManager()->GetWindows().begin()->second;
-      window->GetWindowProperties()->GetSize(mCaptureWidth, mCaptureHeight);
-
-      logger().debug("Capturing capture for /capture request: resolution = {}x{}, show gui = {}, "
-                     "depth = {}, format = {}, restore resolution to {}x{}, reenable Gui {}",
-          mCaptureWidth, mCaptureHeight, mCaptureGui, mCaptureDepth, mCaptureFormat, mRestoreW,
-          mRestoreH, mRestoreGui);
-
-      // We encode image data in the main thread as this is not thread-safe.
-      stbi_flip_vertically_on_write(1);
-
-      // Clear last data first.
-      mCapture.clear();
-
-      if (mCaptureDepth) {
-
-        // Capture the depth component.
-        std::vector<float> capture(mCaptureWidth * mCaptureHeight);
-        glReadPixels(
-            0, 0, mCaptureWidth, mCaptureHeight, GL_DEPTH_COMPONENT, GL_FLOAT, capture.data());
-
-        if (mCaptureFormat == "tiff" || mCaptureFormat == "raw") {
-
-          // If a tiff image is requested, we convert the depth buffer to meters.
-          std::array<GLfloat, 16> glMatP{};
-          glGetFloatv(GL_PROJECTION_MATRIX, glMatP.data());
-          auto      matInvP = glm::inverse(glm::make_mat4x4(glMatP.data()));
-          glm::vec2 pixel(1.F / mCaptureWidth, 1.F / mCaptureHeight);
-
-          for (size_t i(0); i < capture.size(); ++i) {
-            auto coords = glm::vec2(i % mCaptureWidth, i / mCaptureWidth) * pixel + 0.5F * pixel;
-            auto pos    = matInvP * glm::vec4(2.F * coords - 1.F, 2.F * capture[i] - 1.F, 1.F);
-
-            float dist = static_cast<float>(
-                (glm::length(pos.xyz() / pos.w) * mSolarSystem->getObserver().getScale()));
-            capture[i] = std::isinf(dist) ? std::numeric_limits<float>::max() : dist;
-          }
-          if (mCaptureFormat == "tiff") {
-            // Now write the tiff image.
-            tiffWriteToVector(mCapture, capture, mCaptureWidth, mCaptureHeight, 1, 32);
-          } else {
-            // Write raw vector
-            mCapture.resize(capture.size() * sizeof(float));
-            memcpy(mCapture.data(), capture.data(), mCapture.size());
-          }
-
-        } else {
-          // Capture format is png or jpeg, let's convert the depth to 8-bit.
-          std::vector<std::byte> captureByte(mCaptureWidth * mCaptureHeight);
-          for (size_t i(0); i < capture.size(); ++i) {
-            // The funny cast is required for MSVC 14.1 which does not like casting floating point
-            // numbers to std::byte.
-            captureByte[i] = static_cast<std::byte>(static_cast<uint8_t>(capture[i] * 255.0));
-          }
-
-          if (mCaptureFormat == "png") {
-            stbi_write_png_to_func(&stbWriteToVector, &mCapture, mCaptureWidth, mCaptureHeight, 1,
-                captureByte.data(), mCaptureWidth);
-          } else {
-            stbi_write_jpg_to_func(&stbWriteToVector, &mCapture, mCaptureWidth, mCaptureHeight, 1,
-                captureByte.data(), 80);
-          }
-        }
+      window->GetWindowProperties()->GetSize(mRestoreW, mRestoreH);
+      window->GetWindowProperties()->SetSize(mActiveCapture->mWidth, mActiveCapture->mHeight);
+    }
 
-      } else {
-        if (mCaptureFormat == "raw") {
-          // larger output size, but performance is comparable or better because there is no image
-          // encoding
-          mCapture.resize(mCaptureWidth * mCaptureHeight * 3 * sizeof(float));
-          if (mAllSettings->mGraphics.pEnableHDR.get()) {
-            // using the hdr buffer
-            std::shared_ptr<cs::graphics::HDRBuffer> hdrBuffer = mGraphicsEngine->getHDRBuffer();
-            VistaTexture* luminance_buffer = hdrBuffer->getCurrentWriteAttachment();
-            luminance_buffer->Bind();
-            glGetTexImage(luminance_buffer->GetTarget(), 0, GL_RGB, GL_FLOAT,
-                static_cast<void*>(mCapture.data()));
-            luminance_buffer->Unbind();
-          } else {
-            // without HDR, output is float in [0, 1], but the values in the buffer were
-            // previously converted to uint [0, 255]. For high quality raw output, use HDR mode.
-            glReadPixels(0, 0, mCaptureWidth, mCaptureHeight, GL_RGB, GL_FLOAT,
-                static_cast<void*>(mCapture.data()));
-          }
-        } else {
-          // Capturing color images is pretty straight-forward.
-          std::vector<std::byte> capture(mCaptureWidth * mCaptureHeight * 3);
-          glReadPixels(0, 0, mCaptureWidth, mCaptureHeight, GL_RGB, GL_UNSIGNED_BYTE, &capture[0]);
-
-          if (mCaptureFormat == "tiff") {
-            tiffWriteToVector(mCapture, capture, mCaptureWidth, mCaptureHeight, 3, 8);
-          } else if (mCaptureFormat == "png") {
-            stbi_write_png_to_func(&stbWriteToVector, &mCapture, mCaptureWidth, mCaptureHeight, 3,
-                capture.data(), mCaptureWidth * 3);
-          } else {
-            stbi_write_jpg_to_func(
-                &stbWriteToVector, &mCapture, mCaptureWidth, mCaptureHeight, 3, capture.data(), 80);
-          }
-        }
-      }
+    mCaptureAtFrame = GetVistaSystem()->GetFrameLoop()->GetFrameCount() + mActiveCapture->mDelay;
 
-      // Restore stb image state to default.
-      stbi_flip_vertically_on_write(0);
+    if (mActiveCapture->mGui != "auto") {
+      mRestoreGui                        = mAllSettings->pEnableUserInterface.get();
+      mAllSettings->pEnableUserInterface = mActiveCapture->mGui == "true";
+    }
+  }
 
-      mCaptureAtFrame = 0;
+  // Now we waited several frames. We start reading the pixels, they are encoded on a worker thread
+  // which then fulfills the promise of the server's worker thread. If all pixel buffers are in use,
+  // we try again in the next frame.
+  if (mCaptureAtFrame > GetVistaSystem()->GetFrameLoop()->GetFrameCount() ||
+      !mFrameCapture->canRead()) {
+    return;
+  }
 
-      // The capture has been done, notify the worker thread,
-      mCaptureDone.notify_one();
-      if (mRestoreState) {
-        // Restore interactive window UI and image resolution
-        if (mCaptureGui != "auto") {
-          mAllSettings->pEnableUserInterface = mRestoreGui;
-        }
+  int32_t width  = 0;
+  int32_t height = 0;
+  auto*   window = GetVistaSystem()->GetDisplayManager()->GetWindows().begin()->second;
+  window->GetWindowProperties()->GetSize(width, height);
+
+  logger().debug("Capturing capture for /capture request: resolution = {}x{}, show gui = {}, "
+                 "depth = {}, restore resolution to {}x{}, reenable Gui {}",
+      width, height, mActiveCapture->mGui, mActiveCapture->mDepth, mRestoreW, mRestoreH,
+      mRestoreGui);
+
+  cs::graphics::FrameCapture::Request request;
+  request.mFormat     = mActiveCapture->mFormat;
+  request.mDepth      = mActiveCapture->mDepth;
+  request.mSceneScale = mSolarSystem->getObserver().getScale();
+  request.mOnDone     = [capture = mActiveCapture](std::vector<std::byte>&& data) {
+    capture->mResult.set_value(std::move(data));
+  };
+
+  // For high quality raw output, the HDR buffer is used if available. Without HDR, the output is
+  // float in [0, 1], but the values in the buffer were previously converted to uint [0, 255].
+  if (request.mFormat == cs::graphics::FrameCapture::Format::eRaw &&
+      mAllSettings->mGraphics.pEnableHDR.get()) {
+    request.mSource = mGraphicsEngine->getHDRBuffer()->getCurrentWriteAttachment();
+  }
 
-        if (mRestoreW > 0 && mRestoreH > 0) {
-          auto* window = GetVistaSystem()->GetDisplayManager()->GetWindows().begin()->second;
-          window->GetWindowProperties()->SetSize(mRestoreW, mRestoreH);
-        }
+  mFrameCapture->read(width, height, std::move(request));
+
+  if (mActiveCapture->mRestoreState) {
+    // Restore interactive window UI and image resolution
+    if (mActiveCapture->mGui != "auto") {
+      mAllSettings->pEnableUserInterface = mRestoreGui;
+    }
+
+    if (mRestoreW > 0 && mRestoreH > 0) {
+      window->GetWindowProperties()->SetSize(mRestoreW, mRestoreH);
+    }
+  }
+
+  mActiveCapture.reset();
+  mCaptureAtFrame = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Plugin::updateStreams() {
+
+  // Collect the formats which are currently requested by connected clients.
+  std::vector<cs::graphics::FrameCapture::Format> formats;
+  {
+    std::lock_guard<std::mutex> lock(mStreams->mMutex);
+    for (auto const& client : mStreams->mClients) {
+      if (std::find(formats.begin(), formats.end(), client->mFormat) == formats.end()) {
+        formats.push_back(client->mFormat);
       }
     }
   }
 
-  // In this plugin, we cannot call this directly when the onLoad signal of the settings is fired,
-  // since reloading can cause our server to be restarted. And as reloading can be triggered from a
-  // /load request, this could lead to a deadlock.
-  if (mReloadRequired) {
-    from_json(mAllSettings->mPlugins.at("csp-web-api"), mPluginSettings);
+  if (formats.empty()) {
+    return;
+  }
+
+  int32_t width  = 0;
+  int32_t height = 0;
+  auto*   window = GetVistaSystem()->GetDisplayManager()->GetWindows().begin()->second;
+  window->GetWindowProperties()->GetSize(width, height);
+
+  int32_t frameIndex = GetVistaSystem()->GetFrameLoop()->GetFrameCount();
+
+  // We keep at most two reads per format in flight. This is enough to keep up with the frame rate,
+  // as the pixels are usually available one or two frames later. The remaining pixel buffers are
+  // left for the /capture endpoint.
+  for (auto format : formats) {
+    if (mStreams->mPendingReads >= 2 * static_cast<int32_t>(formats.size()) ||
+        !mFrameCapture->canRead()) {
+      return;
+    }
+
+    cs::graphics::FrameCapture::Request request;
+    request.mFormat = format;
+    request.mOnDone = [streams = mStreams, format, width, height, frameIndex](
+                          std::vector<std::byte>&& data) {
+      --streams->mPendingReads;
+
+      if (data.empty()) {
+        return;
+      }
+
+      auto frame = std::make_shared<std::vector<std::byte> const>(std::move(data));
+
+      std::lock_guard<std::mutex> lock(streams->mMutex);
+      for (auto const& client : streams->mClients) {
+        std::lock_guard<std::mutex> clientLock(client->mMutex);
+
+        // Encoding may finish out of order, we never send an older frame after a newer one.
+        if (client->mFormat == format && client->mFrameIndex < frameIndex) {
+          client->mFrame      = frame;
+          client->mWidth      = width;
+          client->mHeight     = height;
+          client->mFrameIndex = frameIndex;
+          client->mFrameAvailable.notify_one();
+        }
+      }
+    };
+
+    if (mFrameCapture->read(width, height, std::move(request))) {
+      ++mStreams->mPendingReads;
+    }
   }
 }
 
@@ -552,8 +654,10 @@ void Plugin::startServer(uint16_t port) {
   quitServer();
 
   try {
-    // We start the server with one thread only, as we do not want to process requests in parallel.
-    std::vector<std::string> options{"listening_ports", std::to_string(port), "num_threads", "1"};
+    // Each connection to the /stream endpoint occupies one thread, so we use several of them.
+    // Requests which modify shared state are serialized by the handlers.
+    std::vector<std::string> options{
+        "listening_ports", std::to_string(port), "num_threads", std::to_string(cServerThreads)};
     mServer = std::make_unique<CivetServer>(options);
 
     for (auto const& handler : mHandlers) {
@@ -566,11 +670,41 @@ void Plugin::startServer(uint16_t port) {
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void Plugin::quitServer() {
+
+  // Abort all pending captures. Destroying the promises wakes up the waiting handlers. Reads which
+  // are already being encoded will still be finished.
+  {
+    std::lock_guard<std::mutex> lock(mCaptureMutex);
+    mCaptureRequests.clear();
+    mCaptureAborted = true;
+  }
+
+  mActiveCapture.reset();
+  mFrameCapture.reset();
+
+  // Wake up all handlers of the /stream endpoint, else stopping the server would block forever.
+  {
+    std::lock_guard<std::mutex> lock(mStreams->mMutex);
+    mStreams->mClosed = true;
+    for (auto const& client : mStreams->mClients) {
+      std::lock_guard<std::mutex> clientLock(client->mMutex);
+      client->mClosed = true;
+      client->mFrameAvailable.notify_one();
+    }
+  }
+
   try {
     if (mServer) {
       mServer.reset();
     }
   } catch (std::exception const& e) { logger().warn("Failed to quit server: {}!", e.what()); }
+
+  // Reads which have been dropped together with the frame capture will never finish, so the old
+  // state with its count of pending reads is discarded.
+  mStreams = std::make_shared<StreamState>();
+
+  std::lock_guard<std::mutex> lock(mCaptureMutex);
+  mCaptureAborted = false;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
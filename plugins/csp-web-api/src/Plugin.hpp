@@ -9,11 +9,15 @@
 #define CSP_WEB_API_PLUGIN_HPP
 
 #include "../../../src/cs-core/PluginBase.hpp"
+#include "../../../src/cs-graphics/FrameCapture.hpp"
 #include "../../../src/cs-utils/DefaultProperty.hpp"
 
+#include <atomic>
 #include <condition_variable>
 #include <cstddef>
 #include <deque>
+#include <future>
+#include <memory>
 #include <optional>
 #include <queue>
 #include <unordered_map>
@@ -46,40 +50,93 @@ class Plugin : public cs::core::PluginBase {
  private:
   void onSave();
 
+  void updateCapture();
+  void updateStreams();
+
   void startServer(uint16_t port);
   void quitServer();
 
-  Settings                                                       mPluginSettings;
+  Settings mPluginSettings;
+
+  // The number of threads of the server.
+  static constexpr int cServerThreads = 8;
+
   std::unique_ptr<CivetServer>                                   mServer;
   std::unordered_map<std::string, std::unique_ptr<CivetHandler>> mHandlers;
 
-  // Members for the /capture endpoint
-  std::mutex              mCaptureMutex;
-  std::condition_variable mCaptureDone;
-  bool                    mCaptureRequested = false;
-  int32_t                 mCaptureWidth     = 0;
-  int32_t                 mCaptureHeight    = 0;
-  int32_t                 mCaptureDelay     = 0;
-  std::string             mCaptureGui       = "auto";
-  bool                    mRestoreState     = false;
-  bool                    mRestoreGui       = true;
-  int32_t                 mRestoreW         = -1;
-  int32_t                 mRestoreH         = -1;
-  bool                    mCaptureDepth     = false;
-  std::string             mCaptureFormat;
-  int32_t                 mCaptureAtFrame = 0;
-  std::vector<std::byte>  mCapture;
+  // Members for the /capture endpoint. Each request is stored in a queue by the server's worker
+  // threads. The requests are processed one after another by the main thread, however the pixels
+  // are read back and encoded asynchronously, so that several captures can be in flight at once.
+  struct CaptureRequest {
+    int32_t                              mWidth        = 0;
+    int32_t                              mHeight       = 0;
+    int32_t                              mDelay        = 0;
+    std::string                          mGui          = "auto";
+    bool                                 mRestoreState = false;
+    bool                                 mDepth        = false;
+    cs::graphics::FrameCapture::Format   mFormat       = cs::graphics::FrameCapture::Format::ePNG;
+    std::promise<std::vector<std::byte>> mResult;
+  };
+
+  std::mutex                                  mCaptureMutex;
+  std::deque<std::shared_ptr<CaptureRequest>> mCaptureRequests;
+  bool                                        mCaptureAborted = false;
+  std::shared_ptr<CaptureRequest>             mActiveCapture;
+  int32_t                                     mCaptureAtFrame = 0;
+  bool                                        mRestoreGui     = true;
+  int32_t                                     mRestoreW       = -1;
+  int32_t                                     mRestoreH       = -1;
+  std::unique_ptr<cs::graphics::FrameCapture> mFrameCapture;
+
+  // Members for the /stream endpoint. Each connected client waits for new frames of its format.
+  // Older frames are dropped if a client cannot keep up with the frame rate. Each stream occupies
+  // one thread of the server, so the number of streams is limited in order to keep some threads
+  // for other requests.
+  static constexpr size_t cMaxStreamClients = cServerThreads / 2;
+
+  struct StreamClient {
+    std::mutex                                    mMutex;
+    std::condition_variable                       mFrameAvailable;
+    cs::graphics::FrameCapture::Format            mFormat{};
+    std::shared_ptr<std::vector<std::byte> const> mFrame;
+    int32_t                                       mWidth      = 0;
+    int32_t                                       mHeight     = 0;
+    int32_t                                       mFrameIndex = 0;
+    bool                                          mClosed     = false;
+  };
+
+  // This is shared with the encoding tasks of the FrameCapture, as they may outlive the plugin.
+  struct StreamState {
+    std::mutex                                 mMutex;
+    std::vector<std::shared_ptr<StreamClient>> mClients;
+    std::atomic<int32_t>                       mPendingReads{0};
+    bool                                       mClosed = false;
+  };
+
+  std::shared_ptr<StreamState> mStreams = std::make_shared<StreamState>();
 
   // Members for the /log endpoint
   std::mutex              mLogMutex;
   std::deque<std::string> mLogMessages;
 
-  // Members for the /save endpoint
+  // Members for the /save endpoint. Concurrent requests are processed one after another.
+  std::mutex              mSaveRequestMutex;
   std::mutex              mSaveMutex;
   std::condition_variable mSaveDone;
   bool                    mSaveRequested = false;
   std::string             mSaveSettings;
 
+  // Members for the /trace endpoint. Concurrent requests are processed one after another.
+  std::mutex              mTraceRequestMutex;
+  std::mutex              mTraceMutex;
+  std::condition_variable mTraceDone;
+  bool                    mTraceRequested = false;
+  int32_t                 mTraceFrames    = 0;
+  int32_t                 mTraceAtFrame   = 0;
+  bool                    mTraceReady     = false;
+  bool                    mRestoreTracing = false;
+  std::string             mTrace;
+
   // Members for the /load endpoint
   std::mutex  mLoadMutex;
   std::string mLoadSettings;
@@ -0,0 +1,91 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "../src/WebMapService.hpp"
+
+#include "../../../src/cs-utils/filesystem.hpp"
+
+#include <boost/date_time/gregorian/gregorian.hpp>
+#include <boost/filesystem.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <regex>
+#include <sstream>
+
+// This measures how long it takes to create a WebMapService for a large capability document
+// similar to the ones of NASA GIBS. The first creation parses the XML document and stores the
+// parsed layers next to it, the second one restores the layers from there. No server is contacted,
+// as the document is written to the cache directory and CacheMode::eAlways is used.
+
+using namespace csp::wmsoverlays;
+
+namespace {
+
+const std::string cUrl = "https://example.com/wms";
+
+// Writes a capability document with the given number of time-dependent layers to the given cache
+// directory. Each layer lists the given number of single days.
+void writeCapabilities(boost::filesystem::path const& cacheDir, int layerCount, int timeSteps) {
+  std::stringstream xml;
+  xml << R"(<?xml version="1.0" encoding="UTF-8"?>)"
+      << R"(<WMS_Capabilities version="1.3.0" updateSequence="42">)"
+      << "<Service><Title>Benchmark Service</Title><MaxWidth>2048</MaxWidth></Service>"
+      << "<Capability><Request><GetMap><Format>image/png</Format><Format>image/jpeg</Format>"
+      << "</GetMap></Request>"
+      << "<Layer><Title>Root</Title><CRS>CRS:84</CRS>";
+
+  for (int i = 0; i < layerCount; ++i) {
+    xml << "<Layer><Name>layer_" << i << "</Name><Title>Layer " << i << "</Title>"
+        << R"(<BoundingBox CRS="CRS:84" minx="-90" miny="-45" maxx="90" maxy="45"/>)"
+        << R"(<Style><Name>default</Name><Title>Default</Title></Style>)"
+        << R"(<Dimension name="time" units="ISO8601">)";
+
+    boost::gregorian::date date(2000, 1, 1);
+    for (int t = 0; t < timeSteps; ++t) {
+      xml << (t > 0 ? "," : "") << boost::gregorian::to_iso_extended_string(date);
+      date += boost::gregorian::days(2);
+    }
+
+    xml << "</Dimension></Layer>";
+  }
+
+  xml << "</Layer></Capability></WMS_Capabilities>";
+
+  cs::utils::filesystem::createDirectoryRecursively(cacheDir);
+  cs::utils::filesystem::writeStringToFile(
+      (cacheDir / (std::regex_replace(cUrl, std::regex("[/:*]"), "_") + ".xml")).string(),
+      xml.str());
+}
+
+// Returns the time in milliseconds which is required to create a WebMapService from the cache.
+double measureCreation(boost::filesystem::path const& cacheDir) {
+  auto          start = std::chrono::steady_clock::now();
+  WebMapService wms(cUrl, WebMapService::CacheMode::eAlways, cacheDir.string());
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+} // namespace
+
+int main() {
+  const int layerCount = 100;
+  const int timeSteps  = 365;
+
+  auto cacheDir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+  writeCapabilities(cacheDir, layerCount, timeSteps);
+
+  double xmlTime    = measureCreation(cacheDir);
+  double cachedTime = measureCreation(cacheDir);
+
+  std::cout << layerCount << " layers with " << timeSteps << " time steps each: " << xmlTime
+            << " ms from XML, " << cachedTime << " ms from the parsed layers" << std::endl;
+
+  boost::filesystem::remove_all(cacheDir);
+
+  return 0;
+}
@@ -46,22 +46,6 @@ NLOHMANN_JSON_SERIALIZE_ENUM(
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void from_json(nlohmann::json const& j, Bounds& o) {
-  std::array<double, 4> bounds{};
-  j.get_to(bounds);
-  o.mMinLon = bounds[0];
-  o.mMaxLon = bounds[1];
-  o.mMinLat = bounds[2];
-  o.mMaxLat = bounds[3];
-}
-
-void to_json(nlohmann::json& j, Bounds const& o) {
-  std::array<double, 4> bounds{o.mMinLon, o.mMaxLon, o.mMinLat, o.mMaxLat};
-  j = bounds;
-}
-
-////////////////////////////////////////////////////////////////////////////////////////////////////
-
 void from_json(nlohmann::json const& j, Plugin::Settings::Body& o) {
   cs::core::Settings::deserialize(j, "activeServer", o.mActiveServer);
   cs::core::Settings::deserialize(j, "activeLayer", o.mActiveLayer);
@@ -81,7 +65,9 @@ void to_json(nlohmann::json& j, Plugin::Settings::Body const& o) {
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void from_json(nlohmann::json const& j, Plugin::Settings& o) {
+  cs::core::Settings::deserialize(j, "enableTiling", o.mEnableTiling);
   cs::core::Settings::deserialize(j, "preFetch", o.mPrefetchCount);
+  cs::core::Settings::deserialize(j, "textureCacheSize", o.mTextureCacheSize);
   cs::core::Settings::deserialize(j, "maxTextureSize", o.mMaxTextureSize);
   cs::core::Settings::deserialize(j, "mapCache", o.mMapCache);
   cs::core::Settings::deserialize(j, "capabilityCache", o.mCapabilityCache);
@@ -90,7 +76,9 @@ void from_json(nlohmann::json const& j, Plugin::Settings& o) {
 }
 
 void to_json(nlohmann::json& j, Plugin::Settings const& o) {
+  cs::core::Settings::serialize(j, "enableTiling", o.mEnableTiling);
   cs::core::Settings::serialize(j, "preFetch", o.mPrefetchCount);
+  cs::core::Settings::serialize(j, "textureCacheSize", o.mTextureCacheSize);
   cs::core::Settings::serialize(j, "maxTextureSize", o.mMaxTextureSize);
   cs::core::Settings::serialize(j, "mapCache", o.mMapCache);
   cs::core::Settings::serialize(j, "capabilityCache", o.mCapabilityCache);
@@ -171,6 +159,10 @@ void Plugin::init() {
       "texture for the next timestep is already cached, e.g. using a prefetch > 0.",
       std::function([this](bool enable) { mPluginSettings->mEnableInterpolation = enable; }));
 
+  mGuiManager->getGui()->registerCallback("wmsOverlays.setEnableTiling",
+      "Enables or disables loading overlays as tiles matching the current view.",
+      std::function([this](bool enable) { mPluginSettings->mEnableTiling = enable; }));
+
   mGuiManager->getGui()->registerCallback("wmsOverlays.setEnableAutomaticBoundsUpdate",
       "Enables or disables automatically updating the bounds when the observer stops moving.",
       std::function(
@@ -435,6 +427,7 @@ void Plugin::deInit() {
   mGuiManager->removeCSS("css/csp-wms-overlays.css");
 
   mGuiManager->getGui()->unregisterCallback("wmsOverlays.setEnableTimeInterpolation");
+  mGuiManager->getGui()->unregisterCallback("wmsOverlays.setEnableTiling");
   mGuiManager->getGui()->unregisterCallback("wmsOverlays.setEnableAutomaticBoundsUpdate");
   mGuiManager->getGui()->unregisterCallback("wmsOverlays.setMaxTextureSize");
   mGuiManager->getGui()->unregisterCallback("wmsOverlays.setPrefetchCount");
@@ -464,23 +457,23 @@ void Plugin::deInit() {
 
 void Plugin::update() {
   std::vector<std::string> finishedBodies;
-  for (auto const& creationThreads : mWmsCreationThreads) {
-    int running  = creationThreads.second.getRunningTaskCount();
-    int total    = static_cast<int>(mPluginSettings->mBodies.at(creationThreads.first).mWms.size());
-    int progress = total - running;
-    if (progress > mWmsCreationProgress.at(creationThreads.first)) {
-      logger().info(
-          "Loaded {} of {} WMS servers for {}...", progress, total, creationThreads.first);
-      mWmsCreationProgress.at(creationThreads.first) = progress;
+  for (auto const& creationTasks : mWmsCreationTasks) {
+    int remaining = static_cast<int>(creationTasks.second.getRunningTaskCount() +
+                                     creationTasks.second.getPendingTaskCount());
+    int total     = static_cast<int>(mPluginSettings->mBodies.at(creationTasks.first).mWms.size());
+    int progress  = total - remaining;
+    if (progress > mWmsCreationProgress.at(creationTasks.first)) {
+      logger().info("Loaded {} of {} WMS servers for {}...", progress, total, creationTasks.first);
+      mWmsCreationProgress.at(creationTasks.first) = progress;
     }
-    if (creationThreads.second.hasFinished()) {
-      initOverlay(creationThreads.first, mPluginSettings->mBodies.at(creationThreads.first));
-      finishedBodies.push_back(creationThreads.first);
-      logger().info("Finished loading WMS servers for {}.", creationThreads.first);
+    if (creationTasks.second.hasFinished()) {
+      initOverlay(creationTasks.first, mPluginSettings->mBodies.at(creationTasks.first));
+      finishedBodies.push_back(creationTasks.first);
+      logger().info("Finished loading WMS servers for {}.", creationTasks.first);
     }
   }
   for (auto const& body : finishedBodies) {
-    mWmsCreationThreads.erase(body);
+    mWmsCreationTasks.erase(body);
   }
 
   if (mPluginSettings->mEnableAutomaticBoundsUpdate.get() && mNoMovement &&
@@ -536,10 +529,12 @@ void Plugin::onLoad() {
 
     mWMSOverlays.emplace(settings.first, wmsOverlay);
 
-    mWmsCreationThreads.emplace(settings.first, settings.second.mWms.size());
+    // The capabilities of all servers are loaded and parsed in parallel on the I/O thread pool.
+    mWmsCreationTasks.emplace(std::piecewise_construct, std::forward_as_tuple(settings.first),
+        std::forward_as_tuple(cs::utils::ThreadPool::getIO()));
     mWmsCreationProgress.emplace(settings.first, 0);
     for (auto const& wmsUrl : settings.second.mWms) {
-      mWmsCreationThreads.at(settings.first).enqueue([this, settings, wmsUrl]() {
+      mWmsCreationTasks.at(settings.first).enqueue([this, settings, wmsUrl]() {
         try {
           WebMapService                wms(wmsUrl, mPluginSettings->mUseCapabilityCache.get(),
                              mPluginSettings->mCapabilityCache.get());
@@ -30,10 +30,14 @@ class Plugin : public cs::core::PluginBase {
  public:
   /// The startup settings of the plugin.
   struct Settings {
-    /// Specifies whether to interpolate textures between timesteps (does not work when pre-fetch is
-    /// inactive).
+    /// Specifies whether to interpolate textures between timesteps.
     cs::utils::DefaultProperty<bool> mEnableInterpolation{true};
 
+    /// Specifies whether layers which allow requesting subsets should be loaded as a quadtree of
+    /// tiles matching the current view instead of as a single texture for the current bounds.
+    /// Tiled overlays follow the observer automatically and only show the current time step.
+    cs::utils::DefaultProperty<bool> mEnableTiling{false};
+
     /// Specifies whether to automatically update the overlay bounds when the observer stopped
     /// moving for a certain amount of time.
     cs::utils::DefaultProperty<bool> mEnableAutomaticBoundsUpdate{false};
@@ -51,9 +55,15 @@ class Plugin : public cs::core::PluginBase {
     cs::utils::DefaultProperty<WebMapService::CacheMode> mUseCapabilityCache{
         WebMapService::CacheMode::eNever};
 
-    /// The amount of textures that gets pre-fetched in every time direction.
+    /// The minimum amount of textures that gets pre-fetched in playback direction. At high time
+    /// speeds or with slow servers, more textures are pre-fetched automatically. When the time is
+    /// paused, nothing is pre-fetched.
     cs::utils::DefaultProperty<int> mPrefetchCount{0};
 
+    /// The maximum amount of memory in MiB which is used for keeping decoded map textures of
+    /// time-dependent layers in memory. This limit applies to each body separately.
+    cs::utils::DefaultProperty<int> mTextureCacheSize{512};
+
     /// The size of the requested map textures along the longer axis. Some wms layers may only be
     /// available in certain sizes, those won't be influenced by this setting.
     cs::utils::DefaultProperty<int> mMaxTextureSize{1024};
@@ -119,10 +129,10 @@ class Plugin : public cs::core::PluginBase {
   /// appropriate range specified in the layer capabilities, a warning will be displayed.
   void checkScale(Bounds const& bounds, WebMapLayer const& layer, int maxTextureSize);
 
-  std::shared_ptr<Settings>                    mPluginSettings = std::make_shared<Settings>();
-  std::mutex                                   mWmsInsertMutex;
-  std::map<std::string, cs::utils::ThreadPool> mWmsCreationThreads;
-  std::map<std::string, int>                   mWmsCreationProgress;
+  std::shared_ptr<Settings>                   mPluginSettings = std::make_shared<Settings>();
+  std::mutex                                  mWmsInsertMutex;
+  std::map<std::string, cs::utils::TaskGroup> mWmsCreationTasks;
+  std::map<std::string, int>                  mWmsCreationProgress;
   std::map<std::string, std::shared_ptr<TextureOverlayRenderer>> mWMSOverlays;
   std::map<std::string, std::vector<WebMapService>>              mWms;
 
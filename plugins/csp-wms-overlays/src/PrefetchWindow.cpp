@@ -0,0 +1,57 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "PrefetchWindow.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace csp::wmsoverlays {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void PrefetchWindow::addLatency(double seconds) {
+  if (!mHasMeasurement) {
+    mLatency        = seconds;
+    mHasMeasurement = true;
+  } else {
+    mLatency = 0.8 * mLatency + 0.2 * seconds;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+double PrefetchWindow::getLatency() const {
+  return mLatency;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+PrefetchWindow::Range PrefetchWindow::compute(
+    double timeSpeed, double sampleDuration, int minAhead) const {
+  Range range;
+
+  if (timeSpeed == 0.0 || sampleDuration <= 0.0) {
+    return range;
+  }
+
+  range.mDirection = timeSpeed < 0.0 ? -1 : 1;
+
+  // The number of samples which are passed while one texture is being loaded. As loads are
+  // distributed over the thread pool, twice that amount is requested to absorb latency spikes. One
+  // sample is added since the current sample may already be partially over.
+  double samplesPerSecond = std::abs(timeSpeed) / sampleDuration;
+  int    required         = static_cast<int>(std::ceil(2.0 * samplesPerSecond * mLatency)) + 1;
+
+  range.mAhead = std::clamp(std::max(required, minAhead), 0, cMaxSamples);
+
+  return range;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace csp::wmsoverlays
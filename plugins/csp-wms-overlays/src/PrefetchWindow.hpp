@@ -0,0 +1,50 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#ifndef CSP_WMS_OVERLAYS_PREFETCH_WINDOW_HPP
+#define CSP_WMS_OVERLAYS_PREFETCH_WINDOW_HPP
+
+namespace csp::wmsoverlays {
+
+/// Decides how many samples of a time-dependent layer should be loaded ahead of the current
+/// simulation time. The window grows with the time speed and with the measured time it takes to
+/// load a texture, so that playback does not outrun the loaded textures. When the simulation time
+/// is paused, nothing is pre-fetched.
+class PrefetchWindow {
+ public:
+  /// The result of compute(). The samples which should be loaded are the current one and mAhead
+  /// samples in mDirection. Samples in the opposite direction are not pre-fetched, as they were
+  /// usually loaded before.
+  struct Range {
+    int mAhead     = 0;
+    int mDirection = 1;
+  };
+
+  /// The window will never be larger than this.
+  static constexpr int cMaxSamples = 64;
+
+  /// Adds a measurement of the time in seconds which was required to load one texture. This is
+  /// smoothed with an exponential moving average.
+  void addLatency(double seconds);
+
+  /// Returns the current latency estimate in seconds. Before the first measurement, a
+  /// conservative default of one second is returned.
+  double getLatency() const;
+
+  /// Computes the window for the given time speed (simulated seconds per real second, negative
+  /// when playing backwards) and duration of one sample in seconds. When playing, at least
+  /// minAhead samples are loaded in playback direction.
+  Range compute(double timeSpeed, double sampleDuration, int minAhead) const;
+
+ private:
+  double mLatency        = 1.0;
+  bool   mHasMeasurement = false;
+};
+
+} // namespace csp::wmsoverlays
+
+#endif // CSP_WMS_OVERLAYS_PREFETCH_WINDOW_HPP
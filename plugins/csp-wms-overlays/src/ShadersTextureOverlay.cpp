@@ -52,14 +52,21 @@ const std::string TextureOverlayRenderer::SURFACE_VERT = R"(
 const std::string TextureOverlayRenderer::SURFACE_FRAG = R"(
     out vec4 FragColor;
 
-    uniform sampler2D uDepthBuffer;
-    uniform sampler2D uFirstTexture;
-    uniform sampler2D uSecondTexture;
+    uniform sampler2D      uDepthBuffer;
+    uniform sampler2DArray uTextures;
+    uniform int            uFirstLayer;
+    uniform int            uSecondLayer;
 
     uniform float     uFade;
     uniform bool      uUseFirstTexture;
     uniform bool      uUseSecondTexture;
 
+    // Tiles are sorted from coarse to fine, the bounds are given in radians as
+    // (minLon, maxLon, minLat, maxLat).
+    uniform int       uTileCount;
+    uniform vec4      uTileBounds[MAX_TILES];
+    uniform int       uTileLayers[MAX_TILES];
+
     uniform dmat4     uMatInvMVP;
 
     uniform dvec2     uLonRange;
@@ -101,6 +108,25 @@ const std::string TextureOverlayRenderer::SURFACE_FRAG = R"(
         return mix( srgbIn/vec3(12.92), pow((srgbIn+vec3(0.055))/vec3(1.055),vec3(2.4)), bLess );
     }
 
+    // ===========================================================================
+    vec4 getTileColor(vec2 lnglat)
+    {
+        // Use the finest tile which contains the given position.
+        for (int i = uTileCount - 1; i >= 0; --i) {
+            vec4 bounds = uTileBounds[i];
+
+            if (lnglat.x >= bounds.x && lnglat.x <= bounds.y &&
+                lnglat.y >= bounds.z && lnglat.y <= bounds.w)
+            {
+                vec2 coords = vec2((lnglat.x - bounds.x) / (bounds.y - bounds.x),
+                                   1.0 - (lnglat.y - bounds.z) / (bounds.w - bounds.z));
+                return texture(uTextures, vec3(coords, uTileLayers[i]));
+            }
+        }
+
+        return vec4(0.);
+    }
+
     // ===========================================================================
     void main()
     {
@@ -121,12 +147,14 @@ const std::string TextureOverlayRenderer::SURFACE_FRAG = R"(
                 vec2 newCoords = vec2(float(norm_u), float(1.0 - norm_v));
 
                 vec4 color = vec4(0.);
-                if (uUseFirstTexture) {
-                  color = texture(uFirstTexture, newCoords);
+                if (uTileCount > 0) {
+                  color = getTileColor(lnglat);
+                } else if (uUseFirstTexture) {
+                  color = texture(uTextures, vec3(newCoords, uFirstLayer));
 
                   // Fade second texture in.
                   if(uUseSecondTexture) {
-                    vec4 secColor = texture(uSecondTexture, newCoords);
+                    vec4 secColor = texture(uTextures, vec3(newCoords, uSecondLayer));
                     color = mix(secColor, color, uFade);
                   }
                 }
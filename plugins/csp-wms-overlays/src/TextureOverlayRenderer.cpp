@@ -39,6 +39,7 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include <cmath>
+#include <numeric>
 
 namespace csp::wmsoverlays {
 
@@ -52,26 +53,15 @@ TextureOverlayRenderer::TextureOverlayRenderer(std::string objectName,
     : mSettings(std::move(settings))
     , mGraphicsEngine(std::move(graphicsEngine))
     , mPluginSettings(std::move(pluginSettings))
-    , mObjectName(std::move(objectName))
-    , mWMSTexture(GL_TEXTURE_2D)
-    , mSecondWMSTexture(GL_TEXTURE_2D)
+    , mObject(solarSystem->getObjectHandle(objectName))
+    , mTextureCache(static_cast<size_t>(mPluginSettings->mTextureCacheSize.get()) * 1024 * 1024)
+    , mTextureRing(2)
     , mSolarSystem(std::move(solarSystem))
     , mTimeControl(std::move(timeControl)) {
 
-  auto object = mSolarSystem->getObject(mObjectName);
-  mMinBounds  = -object->getRadii();
-  mMaxBounds  = object->getRadii();
-
-  // create textures ---------------------------------------------------------
-
-  mWMSTexture.Bind();
-  mWMSTexture.SetWrapS(GL_CLAMP_TO_EDGE);
-  mWMSTexture.SetWrapT(GL_CLAMP_TO_EDGE);
-  mWMSTexture.Unbind();
-  mSecondWMSTexture.Bind();
-  mSecondWMSTexture.SetWrapS(GL_CLAMP_TO_EDGE);
-  mSecondWMSTexture.SetWrapT(GL_CLAMP_TO_EDGE);
-  mSecondWMSTexture.Unbind();
+  auto const& object = mObject.get();
+  mMinBounds          = -object->getRadii();
+  mMaxBounds          = object->getRadii();
 
   // Add to scenegraph.
   VistaSceneGraph* pSG = GetVistaSystem()->GetGraphicsManager()->GetSceneGraph();
@@ -79,7 +69,12 @@ TextureOverlayRenderer::TextureOverlayRenderer(std::string objectName,
   VistaOpenSGMaterialTools::SetSortKeyOnSubtree(
       mGLNode.get(), static_cast<int>(cs::utils::DrawOrder::ePlanets) + 10);
 
+  // Tiled overlays follow the view, so they do not depend on the bounds and the texture size.
   pBounds.connect([this](Bounds const& value) {
+    if (isTiled()) {
+      return;
+    }
+
     clearTextures();
     if (mActiveWMSLayer->getSettings().mTimeIntervals.empty()) {
       WebMapTextureLoader::Request request = getRequest();
@@ -89,6 +84,10 @@ TextureOverlayRenderer::TextureOverlayRenderer(std::string objectName,
   });
 
   mPluginSettings->mMaxTextureSize.connect([this](int value) {
+    if (isTiled()) {
+      return;
+    }
+
     clearTextures();
     if (mActiveWMSLayer->getSettings().mTimeIntervals.empty()) {
       WebMapTextureLoader::Request request = getRequest();
@@ -102,6 +101,20 @@ TextureOverlayRenderer::TextureOverlayRenderer(std::string objectName,
       [this](bool /*unused*/) { mShaderDirty = true; });
   mHDRConnection =
       mSettings->mGraphics.pEnableHDR.connect([this](bool /*unused*/) { mShaderDirty = true; });
+
+  mTextureCacheSizeConnection = mPluginSettings->mTextureCacheSize.connect([this](int value) {
+    mTextureCache.setMaxBytes(static_cast<size_t>(std::max(value, 0)) * 1024 * 1024);
+  });
+
+  mEnableTilingConnection = mPluginSettings->mEnableTiling.connect([this](bool /*unused*/) {
+    clearTextures();
+    mWMSTextureUsed       = false;
+    mSecondWMSTextureUsed = false;
+
+    if (mActiveWMSLayer && mActiveWMSLayer->getSettings().mTimeIntervals.empty() && !isTiled()) {
+      getTimeIndependentTexture(getRequest());
+    }
+  });
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -109,6 +122,8 @@ TextureOverlayRenderer::TextureOverlayRenderer(std::string objectName,
 TextureOverlayRenderer::~TextureOverlayRenderer() {
   mSettings->mGraphics.pEnableLighting.disconnect(mLightingConnection);
   mSettings->mGraphics.pEnableHDR.disconnect(mHDRConnection);
+  mPluginSettings->mTextureCacheSize.disconnect(mTextureCacheSizeConnection);
+  mPluginSettings->mEnableTiling.disconnect(mEnableTilingConnection);
 
   clearTextures();
 
@@ -119,7 +134,7 @@ TextureOverlayRenderer::~TextureOverlayRenderer() {
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 std::string const& TextureOverlayRenderer::getObjectName() const {
-  return mObjectName;
+  return mObject.getName();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -140,7 +155,7 @@ void TextureOverlayRenderer::setActiveWMS(WebMapService const& wms, WebMapLayer
   if (mActiveWMSLayer && mActiveWMSLayer->isRequestable()) {
     if (!mActiveWMSLayer->getSettings().mTimeIntervals.empty()) {
       mCurrentInterval = mActiveWMSLayer->getSettings().mTimeIntervals.at(0);
-    } else {
+    } else if (!isTiled()) {
       getTimeIndependentTexture(getRequest());
     }
   }
@@ -166,7 +181,7 @@ void TextureOverlayRenderer::setStyle(std::string style) {
     mStyle = std::move(style);
 
     clearTextures();
-    if (mActiveWMSLayer->getSettings().mTimeIntervals.empty()) {
+    if (mActiveWMSLayer->getSettings().mTimeIntervals.empty() && !isTiled()) {
       getTimeIndependentTexture(getRequest());
     }
   }
@@ -175,9 +190,18 @@ void TextureOverlayRenderer::setStyle(std::string style) {
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void TextureOverlayRenderer::clearTextures() {
-  mTextures.clear();
+  logStatistics();
+
+  mTextureCache.clear();
+  mTextureRing.clear();
+  for (auto& texture : mTexturesBuffer) {
+    texture.second.mToken.cancel();
+  }
+
   mTexturesBuffer.clear();
   mWrongTextures.clear();
+  mTileBounds.clear();
+  mTileLayers.clear();
 
   mCurrentTexture       = "";
   mCurrentSecondTexture = "";
@@ -186,8 +210,16 @@ void TextureOverlayRenderer::clearTextures() {
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void TextureOverlayRenderer::updateLonLatRange() {
+  if (auto bounds = getVisibleBounds()) {
+    pBounds = bounds.value();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::optional<Bounds> TextureOverlayRenderer::getVisibleBounds() {
   if (!mActiveWMS || !mActiveWMSLayer) {
-    return;
+    return std::nullopt;
   }
 
   VistaProjection::VistaProjectionProperties* projectionProperties =
@@ -203,11 +235,11 @@ void TextureOverlayRenderer::updateLonLatRange() {
   projectionProperties->GetProjPlaneExtents(left, right, bottom, top);
 
   // Get the intersections of the camera rays at the corners of the screen with the body.
-  auto object        = mSolarSystem->getObject(mObjectName);
-  auto intersectable = object->getIntersectableObject();
+  auto const& object        = mObject.get();
+  auto        intersectable = object->getIntersectableObject();
 
   if (!intersectable) {
-    return;
+    return std::nullopt;
   }
 
   std::array<std::pair<bool, glm::dvec3>, 4> intersections;
@@ -224,7 +256,7 @@ void TextureOverlayRenderer::updateLonLatRange() {
           [](auto intersection) { return intersection.first; })) {
     // The body is not visible in all four corners of the screen.
     // For now this results in using the maximum bounds of the map.
-    pBounds = mActiveWMSLayer->getSettings().mBounds;
+    return mActiveWMSLayer->getSettings().mBounds;
   } else {
     // All four corners of the screen show the body.
     // The intersection points can be converted to longitude and latitude.
@@ -316,7 +348,7 @@ void TextureOverlayRenderer::updateLonLatRange() {
       }
     }
 
-    pBounds = currentBounds;
+    return currentBounds;
   }
 }
 
@@ -331,6 +363,202 @@ Bounds TextureOverlayRenderer::getBounds() {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+bool TextureOverlayRenderer::isTiled() const {
+  if (!mActiveWMSLayer || !mPluginSettings->mEnableTiling.get()) {
+    return false;
+  }
+
+  // Layers which do not allow subsets or only come in a fixed size cannot be requested as tiles.
+  auto const& settings = mActiveWMSLayer->getSettings();
+  return !settings.mNoSubsets && !settings.mFixedWidth && !settings.mFixedHeight;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TextureOverlayRenderer::updateTiles() {
+  mTileBounds.clear();
+  mTileLayers.clear();
+
+  auto const& layerSettings = mActiveWMSLayer->getSettings();
+
+  // Tiles of time-dependent layers are only loaded for the current time step.
+  std::optional<std::string> timeString;
+
+  if (!layerSettings.mTimeIntervals.empty()) {
+    boost::posix_time::ptime time =
+        cs::utils::convert::time::toPosix(mTimeControl->pSimulationTime.get());
+    boost::posix_time::ptime sampleStartTime =
+        time - boost::posix_time::microseconds(time.time_of_day().fractional_seconds());
+
+    if (!utils::timeInIntervals(sampleStartTime, layerSettings.mTimeIntervals, mCurrentInterval)) {
+      return;
+    }
+
+    timeString = utils::timeToString(mCurrentInterval.mFormat, sampleStartTime);
+  }
+
+  std::optional<Bounds> visibleBounds = getVisibleBounds();
+  if (!visibleBounds) {
+    return;
+  }
+
+  Bounds bounds;
+  bounds.mMinLon = std::max(visibleBounds->mMinLon, layerSettings.mBounds.mMinLon);
+  bounds.mMaxLon = std::min(visibleBounds->mMaxLon, layerSettings.mBounds.mMaxLon);
+  bounds.mMinLat = std::max(visibleBounds->mMinLat, layerSettings.mBounds.mMinLat);
+  bounds.mMaxLat = std::min(visibleBounds->mMaxLat, layerSettings.mBounds.mMaxLat);
+
+  if (bounds.mMinLon >= bounds.mMaxLon || bounds.mMinLat >= bounds.mMaxLat) {
+    return;
+  }
+
+  // Choose the level on which one pixel of a tile roughly covers one pixel on screen. Near the
+  // poles, the visible longitude range gets very large, so the finer of both axes is used. If this
+  // results in too many tiles, coarser levels are used.
+  std::array<GLint, 4> viewport{};
+  glGetIntegerv(GL_VIEWPORT, viewport.data());
+
+  double degreesPerPixel =
+      std::min((visibleBounds->mMaxLon - visibleBounds->mMinLon) / std::max(viewport[2], 1),
+          (visibleBounds->mMaxLat - visibleBounds->mMinLat) / std::max(viewport[3], 1));
+
+  int                     level = getTileLevel(degreesPerPixel, cTileSize, cMaxTileLevel);
+  std::vector<WebMapTile> tiles = getTiles(bounds, level);
+
+  while (tiles.size() > static_cast<size_t>(cMaxVisibleTiles) && level > 0) {
+    tiles = getTiles(bounds, --level);
+  }
+
+  auto getKey = [&timeString](WebMapTile const& tile) {
+    return timeString ? timeString.value() + "_" + tile.getId() : tile.getId();
+  };
+
+  std::vector<std::string> keys;
+  for (auto const& tile : tiles) {
+    keys.push_back(getKey(tile));
+  }
+
+  // Cancel requests for tiles which are not visible anymore.
+  auto texIt = mTexturesBuffer.begin();
+  while (texIt != mTexturesBuffer.end()) {
+    if (std::find(keys.begin(), keys.end(), texIt->first) == keys.end()) {
+      texIt->second.mToken.cancel();
+      texIt = mTexturesBuffer.erase(texIt);
+    } else {
+      ++texIt;
+    }
+  }
+
+  // Request all visible tiles which are neither loaded nor currently loading. Tiles are always
+  // stored in the map cache, as their bounds are fixed.
+  for (size_t i = 0; i < tiles.size(); ++i) {
+    auto const& key = keys[i];
+
+    if (mTexturesBuffer.find(key) == mTexturesBuffer.end() &&
+        std::find(mWrongTextures.begin(), mWrongTextures.end(), key) == mWrongTextures.end() &&
+        !mTextureCache.contains(key) && !mTextureRing.getLayer(key)) {
+      WebMapTextureLoader::Request request;
+      request.mMaxSize = cTileSize;
+      request.mStyle   = mStyle;
+      request.mTime    = timeString;
+      request.mBounds  = tiles[i].getBounds();
+      request.mTileId  = tiles[i].getId();
+
+      PendingTexture pending;
+      pending.mStartTime = std::chrono::steady_clock::now();
+      pending.mFuture    = mTextureLoader.loadTextureAsync(*mActiveWMS, *mActiveWMSLayer, request,
+          mPluginSettings->mMapCache.get(), true, cs::utils::TaskPriority::eHigh, pending.mToken);
+
+      mTexturesBuffer.emplace(key, std::move(pending));
+    }
+  }
+
+  collectTextures();
+
+  // Select the tiles which are drawn. If a tile is not loaded yet, the nearest loaded ancestor is
+  // drawn instead, so that zooming in does not leave holes in the overlay.
+  std::vector<WebMapTile>  drawnTiles;
+  std::vector<std::string> drawnKeys;
+
+  for (auto const& tile : tiles) {
+    WebMapTile candidate = tile;
+
+    while (true) {
+      std::string key = getKey(candidate);
+
+      if (mTextureRing.getLayer(key) || mTextureCache.contains(key)) {
+        if (std::find(drawnKeys.begin(), drawnKeys.end(), key) == drawnKeys.end()) {
+          drawnTiles.push_back(candidate);
+          drawnKeys.push_back(key);
+        }
+        break;
+      }
+
+      if (candidate.mLevel == 0) {
+        break;
+      }
+
+      candidate = candidate.getParent();
+    }
+  }
+
+  // The shader uses the last tile containing a fragment, so finer tiles have to come last.
+  std::vector<size_t> order(drawnTiles.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+      [&](size_t a, size_t b) { return drawnTiles[a].mLevel < drawnTiles[b].mLevel; });
+
+  // Upload the selected tiles. To limit the work done in a single frame, only a few tiles are
+  // uploaded per frame, the others are drawn in one of the following frames.
+  mTextureRing.setLayerCount(cMaxDrawnTiles);
+
+  int uploads = 0;
+
+  for (size_t i : order) {
+    std::optional<int> layer = mTextureRing.getLayer(drawnKeys[i]);
+
+    if (!layer && uploads < cMaxTileUploadsPerFrame) {
+      bool uploaded = false;
+      layer         = getTextureLayer(drawnKeys[i], drawnKeys, uploaded);
+      uploads += uploaded ? 1 : 0;
+    }
+
+    if (layer) {
+      Bounds tileBounds = drawnTiles[i].getBounds();
+      mTileBounds.emplace_back(cs::utils::convert::toRadians(tileBounds.mMinLon),
+          cs::utils::convert::toRadians(tileBounds.mMaxLon),
+          cs::utils::convert::toRadians(tileBounds.mMinLat),
+          cs::utils::convert::toRadians(tileBounds.mMaxLat));
+      mTileLayers.push_back(layer.value());
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TextureOverlayRenderer::collectTextures() {
+  auto texIt = mTexturesBuffer.begin();
+  while (texIt != mTexturesBuffer.end()) {
+    if (texIt->second.mFuture.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+      std::optional<WebMapTexture> texture = texIt->second.mFuture.get();
+
+      if (texture.has_value()) {
+        auto latency = std::chrono::steady_clock::now() - texIt->second.mStartTime;
+        mPrefetchWindow.addLatency(std::chrono::duration<double>(latency).count());
+        mTextureCache.insert(texIt->first, std::move(texture.value()));
+      } else {
+        mWrongTextures.emplace_back(texIt->first);
+      }
+
+      texIt = mTexturesBuffer.erase(texIt);
+    } else {
+      ++texIt;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 WebMapTextureLoader::Request TextureOverlayRenderer::getRequest() {
   WebMapTextureLoader::Request request;
   request.mMaxSize = mPluginSettings->mMaxTextureSize.get();
@@ -348,8 +576,12 @@ void TextureOverlayRenderer::getTimeIndependentTexture(
         request, mPluginSettings->mMapCache.get(),
         request.mBounds == mActiveWMSLayer->getSettings().mBounds);
     if (texture.has_value()) {
-      mWMSTexture.UploadTexture(texture->mWidth, texture->mHeight, texture->mData.get(), false);
-      mWMSTextureUsed = true;
+      // A time-independent layer only ever shows a single texture, so the ring may have to shrink
+      // if it has been used for a time-dependent or tiled layer before.
+      mTextureRing.setLayerCount(1);
+      mTextureRing.clear();
+      mWMSTextureLayer = mTextureRing.upload("", texture.value(), {}).value_or(0);
+      mWMSTextureUsed  = true;
     } else {
       mWMSTextureUsed = false;
     }
@@ -358,6 +590,44 @@ void TextureOverlayRenderer::getTimeIndependentTexture(
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+std::optional<int> TextureOverlayRenderer::getTextureLayer(
+    std::string const& timeString, std::vector<std::string> const& keep, bool& uploaded) {
+
+  if (auto layer = mTextureRing.getLayer(timeString)) {
+    return layer;
+  }
+
+  WebMapTexture const* texture = mTextureCache.get(timeString);
+
+  if (!texture) {
+    return std::nullopt;
+  }
+
+  uploaded = true;
+  return mTextureRing.upload(timeString, *texture, keep);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TextureOverlayRenderer::logStatistics() {
+  auto const& cache = mTextureCache.getStatistics();
+  auto const& ring  = mTextureRing.getStatistics();
+
+  if (cache.mHits + ring.mUploads == 0) {
+    return;
+  }
+
+  logger().debug("Texture statistics for '{}': {} cache hits, {} evictions, {} uploads in {:.1f} "
+                 "ms, {} MiB cached.",
+      mObject.getName(), cache.mHits, cache.mEvictions, ring.mUploads, ring.mUploadTime,
+      mTextureCache.getBytes() / 1024 / 1024);
+
+  mTextureCache.resetStatistics();
+  mTextureRing.resetStatistics();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 void TextureOverlayRenderer::requestUpdateBounds() {
   mUpdateLonLatRange = true;
 }
@@ -374,6 +644,7 @@ bool TextureOverlayRenderer::Do() {
     mShader = VistaGLSLShader();
 
     std::string defines = "#version 440\n";
+    defines += "#define MAX_TILES " + std::to_string(cMaxDrawnTiles) + "\n";
 
     if (mSettings->mGraphics.pEnableHDR.get()) {
       defines += "#define ENABLE_HDR\n";
@@ -392,126 +663,160 @@ bool TextureOverlayRenderer::Do() {
   }
 
   if (mSolarSystem->pActiveObject.get() == nullptr ||
-      mSolarSystem->pActiveObject != mSolarSystem->getObject(mObjectName) ||
+      mSolarSystem->pActiveObject != mObject.get() ||
       !mActiveWMS.has_value() || !mActiveWMSLayer.has_value()) {
     return false;
   }
 
-  if (mActiveWMSLayer && !mActiveWMSLayer->getSettings().mTimeIntervals.empty()) {
+  if (isTiled()) {
+    mWMSTextureUsed       = false;
+    mSecondWMSTextureUsed = false;
+    updateTiles();
+  } else if (mActiveWMSLayer && !mActiveWMSLayer->getSettings().mTimeIntervals.empty()) {
     // Get the current time. Pre-fetch times are related to this.
     boost::posix_time::ptime time =
         cs::utils::convert::time::toPosix(mTimeControl->pSimulationTime.get());
 
-    // Select WMS textures to be downloaded. If no pre-fetch is set, only sellect the texture for
-    // the current timestep.
-    for (int preFetch = -mPluginSettings->mPrefetchCount.get();
-         preFetch <= mPluginSettings->mPrefetchCount.get(); preFetch++) {
+    // Get the start time of the current WMS sample.
+    boost::posix_time::ptime sampleStartTime =
+        time - boost::posix_time::microseconds(time.time_of_day().fractional_seconds());
+    bool inInterval = utils::timeInIntervals(
+        sampleStartTime, mActiveWMSLayer->getSettings().mTimeIntervals, mCurrentInterval);
+
+    // Create identifier for the sample start time.
+    std::string timeString = utils::timeToString(mCurrentInterval.mFormat, sampleStartTime);
+
+    // The following sample is required for interpolation.
+    boost::posix_time::ptime sampleAfter =
+        utils::addDurationToTime(sampleStartTime, mCurrentInterval.mSampleDuration);
+    bool isAfterInInterval = utils::timeInIntervals(
+        sampleAfter, mActiveWMSLayer->getSettings().mTimeIntervals, mCurrentInterval);
+    std::string afterString = utils::timeToString(mCurrentInterval.mFormat, sampleAfter);
+
+    bool interpolate = mPluginSettings->mEnableInterpolation.get() &&
+                       mCurrentInterval.mSampleDuration.isDuration();
+
+    // Collect the time steps which should be loaded, ordered by priority: The current one, the
+    // following one if interpolation is enabled and the pre-fetched ones in playback direction.
+    std::vector<std::string> timeSteps;
+
+    auto addTimeStep = [&](std::string const& step) {
+      if (std::find(timeSteps.begin(), timeSteps.end(), step) == timeSteps.end()) {
+        timeSteps.push_back(step);
+      }
+    };
+
+    if (inInterval) {
+      addTimeStep(timeString);
+    }
+
+    if (interpolate && isAfterInInterval) {
+      addTimeStep(afterString);
+    }
+
+    // The number of pre-fetched samples depends on the time speed and the load latency.
+    size_t                mandatorySteps = timeSteps.size();
+    PrefetchWindow::Range window         = mPrefetchWindow.compute(mSettings->pTimeSpeed.get(),
+        mCurrentInterval.mSampleDuration.getApproximateSeconds(),
+        mPluginSettings->mPrefetchCount.get());
+
+    for (int i = 1; i <= window.mAhead; i++) {
+      int preFetch = i * window.mDirection;
 
       // Get the start time of the WMS sample.
-      boost::posix_time::ptime sampleStartTime =
+      boost::posix_time::ptime preFetchTime =
           utils::addDurationToTime(time, mCurrentInterval.mSampleDuration, preFetch);
-      sampleStartTime -= boost::posix_time::microseconds(time.time_of_day().fractional_seconds());
-      bool inInterval = utils::timeInIntervals(
-          sampleStartTime, mActiveWMSLayer->getSettings().mTimeIntervals, mCurrentInterval);
+      preFetchTime -= boost::posix_time::microseconds(time.time_of_day().fractional_seconds());
+
+      if (utils::timeInIntervals(
+              preFetchTime, mActiveWMSLayer->getSettings().mTimeIntervals, mCurrentInterval)) {
+        addTimeStep(utils::timeToString(mCurrentInterval.mFormat, preFetchTime));
+      }
+    }
 
-      // Create identifier for the sample start time.
-      std::string timeString = utils::timeToString(mCurrentInterval.mFormat, sampleStartTime);
+    // Cancel requests which are not required anymore, for example because the time speed was
+    // reduced or the playback direction changed.
+    auto texIt = mTexturesBuffer.begin();
+    while (texIt != mTexturesBuffer.end()) {
+      if (std::find(timeSteps.begin(), timeSteps.end(), texIt->first) == timeSteps.end()) {
+        texIt->second.mToken.cancel();
+        texIt = mTexturesBuffer.erase(texIt);
+      } else {
+        ++texIt;
+      }
+    }
 
-      auto requestedTexture = mTexturesBuffer.find(timeString);
-      auto loadedTexture    = mTextures.find(timeString);
-      auto wrongTexture     = std::find(mWrongTextures.begin(), mWrongTextures.end(), timeString);
+    // Request all textures which are neither loaded nor currently loading. Textures which are
+    // required for the current frame are loaded before the pre-fetched ones.
+    for (size_t i = 0; i < timeSteps.size(); ++i) {
+      auto const& step = timeSteps[i];
 
-      // Only load textures that aren't stored yet.
-      if (requestedTexture == mTexturesBuffer.end() && loadedTexture == mTextures.end() &&
-          wrongTexture == mWrongTextures.end() && inInterval) {
+      if (mTexturesBuffer.find(step) == mTexturesBuffer.end() &&
+          std::find(mWrongTextures.begin(), mWrongTextures.end(), step) == mWrongTextures.end() &&
+          !mTextureCache.contains(step) && !mTextureRing.getLayer(step)) {
         // Load WMS texture.
         WebMapTextureLoader::Request request;
         request.mMaxSize = mPluginSettings->mMaxTextureSize.get();
         request.mStyle   = mStyle;
-        request.mTime    = timeString;
+        request.mTime    = step;
         request.mBounds  = getBounds();
 
-        mTexturesBuffer.insert(std::pair<std::string, std::future<std::optional<WebMapTexture>>>(
-            timeString, mTextureLoader.loadTextureAsync(*mActiveWMS, *mActiveWMSLayer, request,
-                            mPluginSettings->mMapCache.get(),
-                            request.mBounds == mActiveWMSLayer->getSettings().mBounds)));
+        auto priority = i < mandatorySteps ? cs::utils::TaskPriority::eHigh
+                                           : cs::utils::TaskPriority::eLow;
+
+        PendingTexture pending;
+        pending.mStartTime = std::chrono::steady_clock::now();
+        pending.mFuture    = mTextureLoader.loadTextureAsync(*mActiveWMS, *mActiveWMSLayer, request,
+            mPluginSettings->mMapCache.get(),
+            request.mBounds == mActiveWMSLayer->getSettings().mBounds, priority, pending.mToken);
+
+        mTexturesBuffer.emplace(step, std::move(pending));
       }
     }
 
     // Check whether the WMS textures are loaded to the memory.
-    auto texIt = mTexturesBuffer.begin();
-    while (texIt != mTexturesBuffer.end()) {
-      if (texIt->second.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
-        std::optional<WebMapTexture> texture = texIt->second.get();
+    collectTextures();
 
-        if (texture.has_value()) {
-          mTextures.insert(
-              std::pair<std::string, WebMapTexture>(texIt->first, std::move(texture.value())));
-        } else {
-          mWrongTextures.emplace_back(texIt->first);
-        }
+    // The ring holds the current texture, the following one and the pre-fetched ones in playback
+    // direction. Textures in the opposite direction stay in the texture cache.
+    mTextureRing.setLayerCount(std::min(window.mAhead + 2, cMaxRingLayers));
 
-        texIt = mTexturesBuffer.erase(texIt);
-      } else {
-        ++texIt;
-      }
+    std::vector<std::string> keep(timeSteps.begin(),
+        timeSteps.begin() + std::min<size_t>(timeSteps.size(), mTextureRing.getLayerCount()));
+
+    bool uploaded = false;
+
+    // Use Wms texture inside the interval. Else the default planet texture will be used.
+    std::optional<int> layer;
+    if (inInterval) {
+      layer = getTextureLayer(timeString, keep, uploaded);
     }
 
-    // Get the current time.
-    time = cs::utils::convert::time::toPosix(mTimeControl->pSimulationTime.get());
-    boost::posix_time::ptime sampleStartTime =
-        time - boost::posix_time::microseconds(time.time_of_day().fractional_seconds());
-    bool inInterval = utils::timeInIntervals(
-        sampleStartTime, mActiveWMSLayer->getSettings().mTimeIntervals, mCurrentInterval);
+    mWMSTextureUsed  = layer.has_value();
+    mWMSTextureLayer = layer.value_or(0);
+    mCurrentTexture  = layer ? timeString : "";
 
-    // Create identifier for the sample start time.
-    std::string timeString = utils::timeToString(mCurrentInterval.mFormat, sampleStartTime);
+    // Create fading between Wms textures when interpolation is enabled.
+    layer.reset();
+    if (mWMSTextureUsed && interpolate && isAfterInInterval) {
+      layer = getTextureLayer(afterString, keep, uploaded);
+    }
 
-    // Find the current texture.
-    auto tex = mTextures.find(timeString);
-
-    // Use Wms texture inside the interval.
-    if (inInterval && tex != mTextures.end()) {
-      // Only update if we have a new texture.
-      if (mCurrentTexture != timeString) {
-        mWMSTextureUsed = true;
-        mWMSTexture.UploadTexture(
-            tex->second.mWidth, tex->second.mHeight, tex->second.mData.get(), false);
-        mCurrentTexture = timeString;
-      }
-    } // Use default planet texture instead.
-    else {
-      mWMSTextureUsed = false;
-      mCurrentTexture = "";
-    }
-
-    if (!mWMSTextureUsed || !mPluginSettings->mEnableInterpolation.get() ||
-        !mCurrentInterval.mSampleDuration.isDuration()) {
-      mSecondWMSTextureUsed = false;
-      mCurrentSecondTexture = "";
-    } // Create fading between Wms textures when interpolation is enabled.
-    else {
-      boost::posix_time::ptime sampleAfter =
-          utils::addDurationToTime(sampleStartTime, mCurrentInterval.mSampleDuration);
-      bool isAfterInInterval = utils::timeInIntervals(
-          sampleAfter, mActiveWMSLayer->getSettings().mTimeIntervals, mCurrentInterval);
-
-      // Find texture for the following sample.
-      tex = mTextures.find(utils::timeToString(mCurrentInterval.mFormat, sampleAfter));
-
-      if (isAfterInInterval && tex != mTextures.end()) {
-        // Only update if we ha a new second texture.
-        if (mCurrentSecondTexture != utils::timeToString(mCurrentInterval.mFormat, sampleAfter)) {
-          mSecondWMSTexture.UploadTexture(
-              tex->second.mWidth, tex->second.mHeight, tex->second.mData.get(), false);
-          mCurrentSecondTexture = utils::timeToString(mCurrentInterval.mFormat, sampleAfter);
-          mSecondWMSTextureUsed = true;
-        }
-        // Interpolate fade value between the 2 WMS textures.
-        mFade = static_cast<float>(
-            static_cast<double>((sampleAfter - time).total_seconds()) /
-            static_cast<double>((sampleAfter - sampleStartTime).total_seconds()));
-      }
+    mSecondWMSTextureUsed  = layer.has_value();
+    mSecondWMSTextureLayer = layer.value_or(0);
+    mCurrentSecondTexture  = layer ? afterString : "";
+
+    if (mSecondWMSTextureUsed) {
+      // Interpolate fade value between the 2 WMS textures.
+      mFade = static_cast<float>(
+          static_cast<double>((sampleAfter - time).total_seconds()) /
+          static_cast<double>((sampleAfter - sampleStartTime).total_seconds()));
+    }
+
+    // Fill the remaining layers of the ring ahead of time. To limit the work done in a single
+    // frame, this uploads at most one texture and only if no other texture was uploaded before.
+    for (size_t i = 0; i < keep.size() && !uploaded; ++i) {
+      getTextureLayer(keep[i], keep, uploaded);
     }
   }
 
@@ -523,9 +828,9 @@ bool TextureOverlayRenderer::Do() {
   glDepthMask(GL_FALSE);
   glEnable(GL_BLEND);
 
-  auto object    = mSolarSystem->getObject(mObjectName);
-  auto radii     = object->getRadii();
-  auto transform = object->getObserverRelativeTransform();
+  auto const& object    = mObject.get();
+  auto        radii     = object->getRadii();
+  auto        transform = object->getObserverRelativeTransform();
 
   // get matrices and related values
   std::array<GLfloat, 16> glMatV{};
@@ -543,34 +848,43 @@ bool TextureOverlayRenderer::Do() {
   // Only bind the enabled textures.
   auto depthbuffer = mGraphicsEngine->getCurrentDepthBufferAsTexture(false);
   depthbuffer->Bind(GL_TEXTURE0);
-  if (mWMSTextureUsed) {
-    mWMSTexture.Bind(GL_TEXTURE1);
+  if (mWMSTextureUsed || !mTileLayers.empty()) {
+    mTextureRing.bind(GL_TEXTURE1);
 
     if (mSecondWMSTextureUsed) {
       mShader.SetUniform(mShader.GetUniformLocation("uFade"), mFade);
-      mSecondWMSTexture.Bind(GL_TEXTURE2);
     }
   }
 
   mShader.SetUniform(mShader.GetUniformLocation("uDepthBuffer"), 0);
-  mShader.SetUniform(mShader.GetUniformLocation("uFirstTexture"), 1);
-  mShader.SetUniform(mShader.GetUniformLocation("uSecondTexture"), 2);
+  mShader.SetUniform(mShader.GetUniformLocation("uTextures"), 1);
+  mShader.SetUniform(mShader.GetUniformLocation("uFirstLayer"), mWMSTextureLayer);
+  mShader.SetUniform(mShader.GetUniformLocation("uSecondLayer"), mSecondWMSTextureLayer);
 
   mShader.SetUniform(mShader.GetUniformLocation("uUseFirstTexture"), mWMSTextureUsed);
   mShader.SetUniform(mShader.GetUniformLocation("uUseSecondTexture"), mSecondWMSTextureUsed);
 
+  auto tileCount = static_cast<GLsizei>(mTileLayers.size());
+  mShader.SetUniform(mShader.GetUniformLocation("uTileCount"), tileCount);
+
+  if (tileCount > 0) {
+    glUniform4fv(mShader.GetUniformLocation("uTileBounds"), tileCount,
+        glm::value_ptr(mTileBounds.front()));
+    glUniform1iv(mShader.GetUniformLocation("uTileLayers"), tileCount, mTileLayers.data());
+  }
+
   GLint loc = mShader.GetUniformLocation("uMatInvMVP");
   glUniformMatrix4dv(loc, 1, GL_FALSE, glm::value_ptr(matInvMVP));
 
-  // Double precision bounds
+  // Double precision bounds. Tiles may be drawn anywhere inside the bounds of the layer.
+  Bounds bounds = isTiled() ? mActiveWMSLayer->getSettings().mBounds : getBounds();
+
   loc = mShader.GetUniformLocation("uLatRange");
   glUniform2dv(loc, 1,
-      glm::value_ptr(
-          cs::utils::convert::toRadians(glm::dvec2(getBounds().mMinLat, getBounds().mMaxLat))));
+      glm::value_ptr(cs::utils::convert::toRadians(glm::dvec2(bounds.mMinLat, bounds.mMaxLat))));
   loc = mShader.GetUniformLocation("uLonRange");
   glUniform2dv(loc, 1,
-      glm::value_ptr(
-          cs::utils::convert::toRadians(glm::dvec2(getBounds().mMinLon, getBounds().mMaxLon))));
+      glm::value_ptr(cs::utils::convert::toRadians(glm::dvec2(bounds.mMinLon, bounds.mMaxLon))));
 
   glm::vec3 sunDirection(1, 0, 0);
   float     sunIlluminance(1.F);
@@ -614,12 +928,9 @@ bool TextureOverlayRenderer::Do() {
 
   depthbuffer->Unbind(GL_TEXTURE0);
 
-  if (mWMSTextureUsed) {
-    mWMSTexture.Unbind(GL_TEXTURE1);
-
-    if (mSecondWMSTextureUsed) {
-      mSecondWMSTexture.Unbind(GL_TEXTURE2);
-    }
+  if (mWMSTextureUsed || !mTileLayers.empty()) {
+    mTextureRing.unbind(GL_TEXTURE1);
+    glActiveTexture(GL_TEXTURE0);
   }
 
   // Release shader
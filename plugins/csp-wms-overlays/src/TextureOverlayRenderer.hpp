@@ -9,9 +9,15 @@
 #define CSP_WMS_OVERLAYS_TEXTURE_OVERLAY_RENDERER_HPP
 
 #include "Plugin.hpp"
+#include "PrefetchWindow.hpp"
 #include "WebMapLayer.hpp"
 #include "WebMapService.hpp"
+#include "WebMapTextureCache.hpp"
 #include "WebMapTextureLoader.hpp"
+#include "WebMapTextureRing.hpp"
+#include "WebMapTile.hpp"
+
+#include "../../../src/cs-core/ObjectHandle.hpp"
 
 #include <VistaKernel/GraphicsManager/VistaOpenGLDraw.h>
 #include <VistaMath/VistaBoundingBox.h>
@@ -19,6 +25,7 @@
 #include <VistaOGLExt/VistaTexture.h>
 
 #include <array>
+#include <chrono>
 #include <functional>
 #include <future>
 #include <unordered_map>
@@ -85,6 +92,22 @@ class TextureOverlayRenderer : public IVistaOpenGLDraw {
   /// Updates the longitude and latitude ranges according to the current viewport.
   void updateLonLatRange();
 
+  /// Returns the longitude and latitude ranges which are visible in the current viewport. If the
+  /// body does not cover the entire viewport, the bounds of the active layer are returned. Returns
+  /// std::nullopt if the ranges cannot be determined.
+  std::optional<Bounds> getVisibleBounds();
+
+  /// Returns true if tiling is enabled and the active layer can be loaded as tiles.
+  bool isTiled() const;
+
+  /// Requests the tiles which cover the visible part of the body and selects the tiles which
+  /// should be drawn in this frame. Tiles which are not loaded yet are replaced by the nearest
+  /// loaded ancestor.
+  void updateTiles();
+
+  /// Moves the textures of completed requests to the texture cache.
+  void collectTextures();
+
   /// Returns the manually set bounds if subsets are allowed by the active layer.
   /// Otherwise returns the default bounds of the layer.
   Bounds getBounds();
@@ -95,17 +118,46 @@ class TextureOverlayRenderer : public IVistaOpenGLDraw {
   /// Synchronously loads a texture for a time-independent map.
   void getTimeIndependentTexture(WebMapTextureLoader::Request const& request);
 
+  /// Returns the layer of the texture ring which contains the texture for the given time step. If
+  /// it is not resident on the GPU yet, it is uploaded from the texture cache and uploaded is set
+  /// to true. Layers containing one of the time steps in keep will not be overwritten. Returns
+  /// std::nullopt if the texture is not available yet.
+  std::optional<int> getTextureLayer(
+      std::string const& timeString, std::vector<std::string> const& keep, bool& uploaded);
+
+  /// Prints the cache statistics of the current layer to the log and resets them.
+  void logStatistics();
+
   std::shared_ptr<cs::core::Settings>       mSettings;
   std::shared_ptr<cs::core::GraphicsEngine> mGraphicsEngine;
   std::shared_ptr<Plugin::Settings>         mPluginSettings;
   Plugin::Settings::Body                    mSimpleWMSOverlaySettings;
-  std::string                               mObjectName;
+  cs::core::ObjectHandle                    mObject;
 
   std::unique_ptr<VistaOpenGLNode> mGLNode;
 
   /// Vista GLSL shader object used for rendering
   VistaGLSLShader mShader;
 
+  /// The maximum number of layers in the texture ring.
+  static constexpr int cMaxRingLayers = 16;
+
+  /// The edge length of tiles in pixels.
+  static constexpr int cTileSize = 256;
+  /// The finest quadtree level. On Earth, this corresponds to about ten meters per pixel. The tile
+  /// bounds are passed to the shader as single-precision radians. Near a longitude of 180 degrees,
+  /// these have a precision of about 2e-7, which is a sixth of a pixel on this level. On finer
+  /// levels, the tiles would visibly jitter and leave gaps.
+  static constexpr int cMaxTileLevel = 13;
+  /// The maximum number of tiles which are requested for the current view. If more tiles would
+  /// be required, a coarser level is used.
+  static constexpr int cMaxVisibleTiles = 32;
+  /// The maximum number of tiles which are drawn, including ancestors used as fallback. This is
+  /// also the number of layers in the texture ring in tiled mode.
+  static constexpr int cMaxDrawnTiles = 64;
+  /// The maximum number of tiles which are uploaded to the GPU per frame.
+  static constexpr int cMaxTileUploadsPerFrame = 4;
+
   /// Code for the geometry shader
   static const std::string SURFACE_GEOM;
   /// Code for the vertex shader
@@ -113,10 +165,21 @@ class TextureOverlayRenderer : public IVistaOpenGLDraw {
   /// Code for the fragment shader
   static const std::string SURFACE_FRAG;
 
+  /// A texture request which is still pending.
+  struct PendingTexture {
+    std::future<std::optional<WebMapTexture>> mFuture;
+    cs::utils::CancellationToken              mToken;
+    std::chrono::steady_clock::time_point     mStartTime;
+  };
+
   /// Stores all textures, for which the request ist still pending.
-  std::map<std::string, std::future<std::optional<WebMapTexture>>> mTexturesBuffer;
-  /// Stores all successfully loaded textures.
-  std::map<std::string, WebMapTexture> mTextures;
+  std::map<std::string, PendingTexture> mTexturesBuffer;
+  /// Decides how many samples are pre-fetched based on the time speed and the load latency.
+  PrefetchWindow mPrefetchWindow;
+  /// Stores successfully loaded textures up to the configured memory budget.
+  WebMapTextureCache mTextureCache;
+  /// The textures around the current time step which are resident on the GPU.
+  WebMapTextureRing mTextureRing;
   /// Stores textures, for which loading failed.
   std::vector<std::string> mWrongTextures;
 
@@ -131,10 +194,10 @@ class TextureOverlayRenderer : public IVistaOpenGLDraw {
   /// The active WMS layer.
   std::optional<WebMapLayer> mActiveWMSLayer;
 
-  /// The WMS texture.
-  VistaTexture mWMSTexture;
-  /// Second WMS texture for time interpolation.
-  VistaTexture mSecondWMSTexture;
+  /// Layer of the texture ring which contains the WMS texture.
+  int mWMSTextureLayer = 0;
+  /// Layer of the texture ring which contains the second WMS texture for time interpolation.
+  int mSecondWMSTextureLayer = 0;
   /// Whether to use the WMS texture.
   bool mWMSTextureUsed{};
   /// Whether to use the second WMS texture.
@@ -143,6 +206,11 @@ class TextureOverlayRenderer : public IVistaOpenGLDraw {
   std::string mCurrentTexture;
   /// Timestep of the second WMS texture.
   std::string mCurrentSecondTexture;
+  /// Bounds in radians (minimum longitude, maximum longitude, minimum latitude, maximum latitude)
+  /// of the tiles which are drawn. These are sorted from coarse to fine.
+  std::vector<glm::vec4> mTileBounds;
+  /// Layers of the texture ring which contain the tiles in mTileBounds.
+  std::vector<int> mTileLayers;
   /// Fading value between WMS textures.
   float mFade{};
   /// Used to save the current time format style and sample duration;
@@ -159,9 +227,11 @@ class TextureOverlayRenderer : public IVistaOpenGLDraw {
   /// Upper Corner of the bounding volume for the planet.
   glm::vec3 mMaxBounds;
 
-  bool mShaderDirty        = true;
-  int  mLightingConnection = -1;
-  int  mHDRConnection      = -1;
+  bool mShaderDirty                = true;
+  int  mLightingConnection         = -1;
+  int  mHDRConnection              = -1;
+  int  mTextureCacheSizeConnection = -1;
+  int  mEnableTilingConnection     = -1;
 };
 
 } // namespace csp::wmsoverlays
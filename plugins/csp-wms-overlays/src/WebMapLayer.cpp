@@ -16,6 +16,26 @@
 
 namespace csp::wmsoverlays {
 
+namespace {
+
+// Optional values are omitted in the serialized layers.
+template <typename T>
+void setOptional(nlohmann::json& j, std::string const& key, std::optional<T> const& value) {
+  if (value.has_value()) {
+    j[key] = value.value();
+  }
+}
+
+template <typename T>
+void getOptional(nlohmann::json const& j, std::string const& key, std::optional<T>& value) {
+  auto it = j.find(key);
+  if (it != j.end()) {
+    value = it->template get<T>();
+  }
+}
+
+} // namespace
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 WebMapLayer::WebMapLayer(VistaXML::TiXmlElement* element, Settings settings)
@@ -112,6 +132,70 @@ WebMapLayer::WebMapLayer(VistaXML::TiXmlElement* element, Settings settings)
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+WebMapLayer::WebMapLayer(nlohmann::json const& json)
+    : mTitle(json.at("title").get<std::string>()) {
+  getOptional(json, "name", mName);
+  getOptional(json, "abstract", mAbstract);
+
+  nlohmann::json const& settings = json.at("settings");
+  mSettings.mNoSubsets           = settings.at("noSubsets").get<bool>();
+  mSettings.mCrs                 = settings.at("crs").get<std::vector<std::string>>();
+  mSettings.mBounds              = settings.at("bounds").get<Bounds>();
+  mSettings.mOpaque              = settings.at("opaque").get<bool>();
+  mSettings.mTimeIntervals       = settings.at("timeIntervals").get<std::vector<TimeInterval>>();
+  getOptional(settings, "fixedWidth", mSettings.mFixedWidth);
+  getOptional(settings, "fixedHeight", mSettings.mFixedHeight);
+  getOptional(settings, "attribution", mSettings.mAttribution);
+  getOptional(settings, "minScale", mSettings.mMinScale);
+  getOptional(settings, "maxScale", mSettings.mMaxScale);
+
+  for (auto const& style : settings.at("styles")) {
+    mSettings.mStyles.emplace_back(style);
+  }
+
+  for (auto const& layer : json.at("layers")) {
+    mSubLayers.emplace_back(layer);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+nlohmann::json WebMapLayer::toJson() const {
+  nlohmann::json settings = {
+      {"noSubsets", mSettings.mNoSubsets},
+      {"crs", mSettings.mCrs},
+      {"bounds", mSettings.mBounds},
+      {"opaque", mSettings.mOpaque},
+      {"timeIntervals", mSettings.mTimeIntervals},
+      {"styles", nlohmann::json::array()},
+  };
+  setOptional(settings, "fixedWidth", mSettings.mFixedWidth);
+  setOptional(settings, "fixedHeight", mSettings.mFixedHeight);
+  setOptional(settings, "attribution", mSettings.mAttribution);
+  setOptional(settings, "minScale", mSettings.mMinScale);
+  setOptional(settings, "maxScale", mSettings.mMaxScale);
+
+  for (auto const& style : mSettings.mStyles) {
+    settings["styles"].push_back(style.toJson());
+  }
+
+  nlohmann::json json = {
+      {"title", mTitle},
+      {"settings", settings},
+      {"layers", nlohmann::json::array()},
+  };
+  setOptional(json, "name", mName);
+  setOptional(json, "abstract", mAbstract);
+
+  for (auto const& layer : mSubLayers) {
+    json["layers"].push_back(layer.toJson());
+  }
+
+  return json;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 std::string const& WebMapLayer::getTitle() const {
   return mTitle;
 }
@@ -169,6 +253,24 @@ WebMapLayer::Style::Style(VistaXML::TiXmlElement* element)
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+WebMapLayer::Style::Style(nlohmann::json const& json)
+    : mName(json.at("name").get<std::string>())
+    , mTitle(json.at("title").get<std::string>())
+    , mLegendUrl(json.contains("legendUrl")
+                     ? std::optional<std::string>(json.at("legendUrl").get<std::string>())
+                     : std::nullopt) {
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+nlohmann::json WebMapLayer::Style::toJson() const {
+  nlohmann::json json = {{"name", mName}, {"title", mTitle}};
+  setOptional(json, "legendUrl", mLegendUrl);
+  return json;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 std::optional<std::string> WebMapLayer::Style::getLegendUrl(VistaXML::TiXmlElement* element) {
   VistaXML::TiXmlHandle   handle(element);
   VistaXML::TiXmlElement* resource =
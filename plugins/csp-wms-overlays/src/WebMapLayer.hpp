@@ -11,6 +11,7 @@
 #include "utils.hpp"
 
 #include <VistaTools/tinyXML/tinyxml.h>
+#include <nlohmann/json.hpp>
 
 #include <array>
 #include <optional>
@@ -33,6 +34,11 @@ class WebMapLayer {
 
     explicit Style(VistaXML::TiXmlElement* element);
 
+    /// Restores a style which was serialized with toJson().
+    explicit Style(nlohmann::json const& json);
+
+    nlohmann::json toJson() const;
+
    private:
     static std::optional<std::string> getLegendUrl(VistaXML::TiXmlElement* element);
   };
@@ -65,6 +71,14 @@ class WebMapLayer {
 
   WebMapLayer(VistaXML::TiXmlElement* element, Settings settings);
 
+  /// Restores a layer and all of its child layers which were serialized with toJson(). This is
+  /// used for caching parsed capabilities. Throws a nlohmann::json::exception if the given json
+  /// is not valid.
+  explicit WebMapLayer(nlohmann::json const& json);
+
+  /// Serializes the layer and all of its child layers.
+  nlohmann::json toJson() const;
+
   /// Gets a human readable description of the layer.
   std::string const& getTitle() const;
   /// Gets the internal name of the layer used for requests.
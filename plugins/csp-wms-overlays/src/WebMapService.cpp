@@ -12,6 +12,7 @@
 #include "../../../src/cs-utils/filesystem.hpp"
 #include "../../../src/cs-utils/utils.hpp"
 
+#include <fstream>
 #include <regex>
 
 #include <boost/filesystem.hpp>
@@ -28,11 +29,12 @@ WebMapService::WebMapService(std::string url, CacheMode cacheMode, std::string c
     , mCacheMode(cacheMode)
     , mCacheDir(std::move(cacheDir))
     , mCacheFileName(std::regex_replace(mUrl, std::regex("[/:*]"), "_") + ".xml")
-    , mTitle(parseTitle())
-    , mSettings(parseSettings())
-    , mMapFormats(parseMapFormats())
-    , mRootLayer(parseRootLayer()) {
+    , mParsedCacheFileName(std::regex_replace(mUrl, std::regex("[/:*]"), "_") + ".cbor")
+    , mRootLayer(loadCapabilities()) {
   mRootLayer.getRequestableLayers(mRequestableLayers);
+
+  // The capability document is not required anymore once everything has been parsed.
+  mDoc.reset();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -86,6 +88,131 @@ bool WebMapService::isFormatSupported(std::string const& format) const {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+WebMapLayer WebMapService::loadCapabilities() {
+  if (mCacheMode != CacheMode::eNever) {
+    std::optional<nlohmann::json> cache = getParsedCapabilitiesFromCache();
+
+    if (cache.has_value()) {
+      bool           useCache       = mCacheMode == CacheMode::eAlways;
+      nlohmann::json updateSequence = cache->value("updateSequence", nlohmann::json());
+
+      if (mCacheMode == CacheMode::eUpdateSequence && updateSequence.is_string()) {
+        auto check = requestUpdateSequenceCheck(updateSequence.get<std::string>());
+        if (check.has_value() && check->mIsCurrent) {
+          useCache = true;
+        } else if (check.has_value() && check->mCapabilities.has_value()) {
+          // The server sent newer capabilities, these are parsed below.
+          auto& [doc, docString] = check->mCapabilities.value();
+          mDoc                   = std::move(doc);
+          validateCapabilities(docString, true);
+        }
+      }
+
+      if (useCache) {
+        try {
+          mTitle      = cache->at("title").get<std::string>();
+          mMapFormats = cache->at("mapFormats").get<std::vector<std::string>>();
+
+          if (cache->contains("maxWidth")) {
+            mSettings.mMaxWidth = cache->at("maxWidth").get<int>();
+          }
+
+          if (cache->contains("maxHeight")) {
+            mSettings.mMaxHeight = cache->at("maxHeight").get<int>();
+          }
+
+          return WebMapLayer(cache->at("rootLayer"));
+        } catch (std::exception const& e) {
+          logger().warn("Failed to restore cached capabilities for '{}': '{}'! Parsing the "
+                        "capability document instead.",
+              mUrl, e.what());
+        }
+      }
+    }
+  }
+
+  mTitle      = parseTitle();
+  mSettings   = parseSettings();
+  mMapFormats = parseMapFormats();
+
+  WebMapLayer rootLayer = parseRootLayer();
+
+  if (mCacheMode != CacheMode::eNever) {
+    saveParsedCapabilitiesToCache(rootLayer);
+  }
+
+  return rootLayer;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::optional<nlohmann::json> WebMapService::getParsedCapabilitiesFromCache() const {
+  boost::filesystem::path cacheFilePath(
+      boost::filesystem::path(mCacheDir) / boost::filesystem::path(mParsedCacheFileName));
+
+  if (!boost::filesystem::exists(cacheFilePath) ||
+      boost::filesystem::file_size(cacheFilePath) == 0) {
+    return {};
+  }
+
+  std::ifstream        file(cacheFilePath.string(), std::ios::binary);
+  std::vector<uint8_t> data(
+      (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+  nlohmann::json cache = nlohmann::json::from_cbor(data, true, false);
+
+  // The cache file name is derived from the URL, so different URLs may share the same file name.
+  if (cache.is_discarded() || !cache.is_object() ||
+      cache.value("version", 0) != cParsedCacheVersion || cache.value("url", "") != mUrl) {
+    logger().debug("Ignoring outdated or invalid parsed capabilities for '{}'.", mUrl);
+    return {};
+  }
+
+  return cache;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void WebMapService::saveParsedCapabilitiesToCache(WebMapLayer const& rootLayer) const {
+  VistaXML::TiXmlElement* capabilities   = mDoc->FirstChildElement("WMS_Capabilities");
+  const char*             updateSequence = capabilities->Attribute("updateSequence");
+
+  nlohmann::json cache = {
+      {"version", cParsedCacheVersion},
+      {"url", mUrl},
+      {"updateSequence", updateSequence ? nlohmann::json(updateSequence) : nlohmann::json()},
+      {"title", mTitle},
+      {"mapFormats", mMapFormats},
+      {"rootLayer", rootLayer.toJson()},
+  };
+
+  if (mSettings.mMaxWidth.has_value()) {
+    cache["maxWidth"] = mSettings.mMaxWidth.value();
+  }
+
+  if (mSettings.mMaxHeight.has_value()) {
+    cache["maxHeight"] = mSettings.mMaxHeight.value();
+  }
+
+  boost::filesystem::path cacheDir(mCacheDir);
+  boost::filesystem::path cacheFilePath(cacheDir / boost::filesystem::path(mParsedCacheFileName));
+
+  try {
+    if (!boost::filesystem::exists(cacheDir)) {
+      cs::utils::filesystem::createDirectoryRecursively(boost::filesystem::absolute(cacheDir));
+    }
+
+    std::vector<uint8_t> data = nlohmann::json::to_cbor(cache);
+    std::ofstream        file(cacheFilePath.string(), std::ios::binary);
+    file.write(
+        reinterpret_cast<char const*>(data.data()), static_cast<std::streamsize>(data.size()));
+  } catch (std::exception const& e) {
+    logger().warn("Failed to cache parsed capabilities for '{}': {}!", mUrl, e.what());
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 VistaXML::TiXmlElement* WebMapService::getCapabilities() {
   if (!mDoc.has_value()) {
     std::optional<std::string> docString;
@@ -123,42 +250,49 @@ VistaXML::TiXmlElement* WebMapService::getCapabilities() {
       std::tie(mDoc, docString) = requestCapabilities();
     }
 
-    VistaXML::TiXmlElement* capabilities = mDoc->FirstChildElement("WMS_Capabilities");
-    if (capabilities == nullptr) {
+    validateCapabilities(docString, saveToCache);
+  }
+  VistaXML::TiXmlElement* capabilities = mDoc->FirstChildElement("WMS_Capabilities");
+  return capabilities;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void WebMapService::validateCapabilities(
+    std::optional<std::string> const& docString, bool saveToCache) {
+  VistaXML::TiXmlElement* capabilities = mDoc->FirstChildElement("WMS_Capabilities");
+  if (capabilities == nullptr) {
+    std::stringstream message;
+    message << "WMS capabilities document for '" << mUrl << "' is not valid";
+    throw std::runtime_error(message.str());
+  }
+  std::optional<std::string> version = utils::getAttribute<std::string>(capabilities, "version");
+  if (!version.has_value()) {
+    logger().warn("No version number given in capabilities! Trying to use server anyway.");
+  } else {
+    if (version.value() != "1.3.0") {
       std::stringstream message;
-      message << "WMS capabilities document for '" << mUrl << "' is not valid";
+      message << "WMS '" << mUrl << "' only supports WMS version '" << version.value() << "'";
       throw std::runtime_error(message.str());
     }
-    std::optional<std::string> version = utils::getAttribute<std::string>(capabilities, "version");
-    if (!version.has_value()) {
-      logger().warn("No version number given in capabilities! Trying to use server anyway.");
-    } else {
-      if (version.value() != "1.3.0") {
-        std::stringstream message;
-        message << "WMS '" << mUrl << "' only supports WMS version '" << version.value() << "'";
-        throw std::runtime_error(message.str());
-      }
-    }
-
-    if (saveToCache && docString.has_value()) {
-      // Save capabilities to cache
-      boost::filesystem::path cacheFile(mCacheFileName);
-      boost::filesystem::path cacheDir(mCacheDir);
-      boost::filesystem::path cacheFilePath(cacheDir / cacheFile);
+  }
 
-      auto cacheDirAbs(boost::filesystem::absolute(cacheDir));
-      if (!(boost::filesystem::exists(cacheDirAbs))) {
-        try {
-          cs::utils::filesystem::createDirectoryRecursively(cacheDirAbs);
-        } catch (std::exception& e) {
-          logger().warn("Failed to create cache directory: {}!", e.what());
-        }
+  if (saveToCache && docString.has_value()) {
+    // Save capabilities to cache
+    boost::filesystem::path cacheFile(mCacheFileName);
+    boost::filesystem::path cacheDir(mCacheDir);
+    boost::filesystem::path cacheFilePath(cacheDir / cacheFile);
+
+    auto cacheDirAbs(boost::filesystem::absolute(cacheDir));
+    if (!(boost::filesystem::exists(cacheDirAbs))) {
+      try {
+        cs::utils::filesystem::createDirectoryRecursively(cacheDirAbs);
+      } catch (std::exception& e) {
+        logger().warn("Failed to create cache directory: {}!", e.what());
       }
-      cs::utils::filesystem::writeStringToFile(cacheFilePath.string(), docString.value());
     }
+    cs::utils::filesystem::writeStringToFile(cacheFilePath.string(), docString.value());
   }
-  VistaXML::TiXmlElement* capabilities = mDoc->FirstChildElement("WMS_Capabilities");
-  return capabilities;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -204,49 +338,22 @@ WebMapService::checkUpdateSequence(VistaXML::TiXmlDocument cacheDoc) {
   const char*             updateSequence = root->Attribute("updateSequence");
   if (updateSequence != nullptr) {
     // A sequence number was found, now check if it is the most recent one
-    std::stringstream url = getGetCapabilitiesUrl();
-    url << "&UPDATESEQUENCE=" << updateSequence;
-
-    std::stringstream resStream;
-    curlpp::Easy      request;
-    request.setOpt(curlpp::options::Url(url.str()));
-    request.setOpt(curlpp::options::WriteStream(&resStream));
-    request.setOpt(curlpp::options::NoSignal(true));
-    request.setOpt(curlpp::options::SslVerifyPeer(false));
-
-    try {
-      request.perform();
-    } catch (std::exception const& e) {
-      logger().warn("Failed to perform WMS Capabilities request while checking cache validity "
-                    "for '{}': '{}'!",
-          mUrl, e.what());
+    std::optional<UpdateSequenceCheck> check = requestUpdateSequenceCheck(updateSequence);
+    if (!check.has_value()) {
       return {};
     }
 
-    const std::string       resString = resStream.str();
-    VistaXML::TiXmlDocument resDoc;
-    resDoc.Parse(resString.c_str());
-    if (resDoc.Error()) {
-      logger().warn("Parsing XML failed while checking cache validity for '{}': '{}'!", mUrl,
-          resDoc.ErrorDesc());
-      return {};
+    if (check->mIsCurrent) {
+      // Cache is up to date
+      return std::make_tuple(cacheDoc, std::nullopt);
     }
 
-    try {
-      WebMapExceptionReport e(resDoc);
-      if (e.getExceptions().size() == 1 &&
-          e.getExceptions()[0].getCode() == WebMapException::Code::eCurrentUpdateSequence) {
-        // Cache is up to date
-        return std::make_tuple(cacheDoc, std::nullopt);
-      }
-      logger().warn(
-          "WMS Exception occurred while checking cache validity for '{}': '{}'!", mUrl, e.what());
-      // Cache is not up to date, and an exception occurred
-      return {};
-    } catch (std::exception const&) {
-      // No exception, the request's result should be the newest capabilities
-      return std::make_tuple(resDoc, resString);
+    if (check->mCapabilities.has_value()) {
+      auto& [resDoc, resString] = check->mCapabilities.value();
+      return std::make_tuple(resDoc, std::optional<std::string>(resString));
     }
+
+    return {};
   } else {
     // No sequence number found, so we can't verify that our cached file is up to date
     return {};
@@ -255,6 +362,59 @@ WebMapService::checkUpdateSequence(VistaXML::TiXmlDocument cacheDoc) {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+std::optional<WebMapService::UpdateSequenceCheck> WebMapService::requestUpdateSequenceCheck(
+    std::string const& updateSequence) {
+  std::stringstream url = getGetCapabilitiesUrl();
+  url << "&UPDATESEQUENCE=" << updateSequence;
+
+  std::stringstream resStream;
+  curlpp::Easy      request;
+  request.setOpt(curlpp::options::Url(url.str()));
+  request.setOpt(curlpp::options::WriteStream(&resStream));
+  request.setOpt(curlpp::options::NoSignal(true));
+  request.setOpt(curlpp::options::SslVerifyPeer(false));
+
+  try {
+    request.perform();
+  } catch (std::exception const& e) {
+    logger().warn("Failed to perform WMS Capabilities request while checking cache validity "
+                  "for '{}': '{}'!",
+        mUrl, e.what());
+    return {};
+  }
+
+  const std::string       resString = resStream.str();
+  VistaXML::TiXmlDocument resDoc;
+  resDoc.Parse(resString.c_str());
+  if (resDoc.Error()) {
+    logger().warn("Parsing XML failed while checking cache validity for '{}': '{}'!", mUrl,
+        resDoc.ErrorDesc());
+    return {};
+  }
+
+  UpdateSequenceCheck check;
+
+  try {
+    WebMapExceptionReport e(resDoc);
+    if (e.getExceptions().size() == 1 &&
+        e.getExceptions()[0].getCode() == WebMapException::Code::eCurrentUpdateSequence) {
+      // Cache is up to date
+      check.mIsCurrent = true;
+      return check;
+    }
+    logger().warn(
+        "WMS Exception occurred while checking cache validity for '{}': '{}'!", mUrl, e.what());
+    // Cache is not up to date, and an exception occurred
+    return {};
+  } catch (std::exception const&) {
+    // No exception, the request's result should be the newest capabilities
+    check.mCapabilities = std::make_tuple(resDoc, resString);
+    return check;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 std::tuple<VistaXML::TiXmlDocument, std::string> WebMapService::requestCapabilities() {
   std::stringstream url = getGetCapabilitiesUrl();
 
@@ -43,7 +43,8 @@ class WebMapService {
   /// The url string should be the base URL of the WMS without a query string.
   /// cacheMode can be used to control the caching behavior for the capability document.
   /// If caching is activated, cacheDir should be the path to a directory which can be
-  /// used for caching.
+  /// used for caching. Besides the capability document, the parsed layer tree is cached there, so
+  /// that the document does not have to be parsed again as long as it is up to date.
   WebMapService(std::string url, CacheMode cacheMode, std::string cacheDir);
 
   /// Gets the base URL of the service
@@ -66,6 +67,28 @@ class WebMapService {
   bool isFormatSupported(std::string const& format) const;
 
  private:
+  /// The answer of a server to a capabilities request with an update sequence.
+  struct UpdateSequenceCheck {
+    /// True if the given update sequence is the most recent one.
+    bool mIsCurrent = false;
+    /// If the given update sequence is outdated, this contains the newer capability document as a
+    /// parsed TiXmlDocument and as a raw string.
+    std::optional<std::tuple<VistaXML::TiXmlDocument, std::string>> mCapabilities;
+  };
+
+  /// Increase this whenever the format of the parsed capabilities cache changes.
+  static constexpr int cParsedCacheVersion = 1;
+
+  /// Initializes the title, settings and map formats and returns the root layer. If possible, these
+  /// are restored from the parsed capabilities cache, else the capability document is parsed.
+  WebMapLayer loadCapabilities();
+
+  /// Tries to load the parsed capabilities for this WMS from the cache. The result is empty if
+  /// there is no valid cache file.
+  std::optional<nlohmann::json> getParsedCapabilitiesFromCache() const;
+  /// Writes the parsed capabilities to the cache.
+  void saveParsedCapabilitiesToCache(WebMapLayer const& rootLayer) const;
+
   VistaXML::TiXmlElement*  getCapabilities();
   WebMapLayer              parseRootLayer();
   std::string              parseTitle();
@@ -81,6 +104,12 @@ class WebMapService {
   /// different to the one given to this function and thus should be saved to the cache.
   std::optional<std::tuple<VistaXML::TiXmlDocument, std::optional<std::string>>>
   checkUpdateSequence(VistaXML::TiXmlDocument cacheDoc);
+  /// Asks the server whether the given update sequence is still the most recent one. Returns an
+  /// empty optional if this could not be determined.
+  std::optional<UpdateSequenceCheck> requestUpdateSequenceCheck(std::string const& updateSequence);
+  /// Checks whether the capability document in mDoc is valid. If saveToCache is true and a raw
+  /// string is given, it is written to the cache.
+  void validateCapabilities(std::optional<std::string> const& docString, bool saveToCache);
   /// Requests a new capability document from the server.
   /// Returns the document as a parsed TiXmlDocument and as a raw string for caching.
   std::tuple<VistaXML::TiXmlDocument, std::string> requestCapabilities();
@@ -93,11 +122,12 @@ class WebMapService {
   const CacheMode   mCacheMode;
   const std::string mCacheDir;
   const std::string mCacheFileName;
+  const std::string mParsedCacheFileName;
 
-  const std::string mTitle;
-  const Settings    mSettings;
+  std::string mTitle;
+  Settings    mSettings;
 
-  const std::vector<std::string> mMapFormats;
+  std::vector<std::string> mMapFormats;
 
   WebMapLayer              mRootLayer;
   std::vector<WebMapLayer> mRequestableLayers;
@@ -0,0 +1,122 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "WebMapTextureCache.hpp"
+
+namespace csp::wmsoverlays {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+WebMapTextureCache::WebMapTextureCache(size_t maxBytes)
+    : mMaxBytes(maxBytes) {
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void WebMapTextureCache::setMaxBytes(size_t maxBytes) {
+  mMaxBytes = maxBytes;
+  evict();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t WebMapTextureCache::getMaxBytes() const {
+  return mMaxBytes;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t WebMapTextureCache::getBytes() const {
+  return mBytes;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t WebMapTextureCache::size() const {
+  return mEntries.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void WebMapTextureCache::insert(std::string const& key, WebMapTexture texture) {
+  auto it = mLookup.find(key);
+  if (it != mLookup.end()) {
+    mBytes -= getBytes(it->second->second);
+    mEntries.erase(it->second);
+    mLookup.erase(it);
+  }
+
+  mBytes += getBytes(texture);
+  mEntries.emplace_front(key, std::move(texture));
+  mLookup[key] = mEntries.begin();
+
+  evict();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+WebMapTexture const* WebMapTextureCache::get(std::string const& key) {
+  auto it = mLookup.find(key);
+  if (it == mLookup.end()) {
+    return nullptr;
+  }
+
+  ++mStatistics.mHits;
+
+  // Move the entry to the front. This does not invalidate any iterators.
+  mEntries.splice(mEntries.begin(), mEntries, it->second);
+  return &it->second->second;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool WebMapTextureCache::contains(std::string const& key) const {
+  return mLookup.find(key) != mLookup.end();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void WebMapTextureCache::clear() {
+  mEntries.clear();
+  mLookup.clear();
+  mBytes = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+WebMapTextureCache::Statistics const& WebMapTextureCache::getStatistics() const {
+  return mStatistics;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void WebMapTextureCache::resetStatistics() {
+  mStatistics = Statistics();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t WebMapTextureCache::getBytes(WebMapTexture const& texture) {
+  // The textures are always loaded with four channels.
+  return static_cast<size_t>(texture.mWidth) * static_cast<size_t>(texture.mHeight) * 4;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void WebMapTextureCache::evict() {
+  while (mBytes > mMaxBytes && mEntries.size() > 1) {
+    auto const& entry = mEntries.back();
+    mBytes -= getBytes(entry.second);
+    mLookup.erase(entry.first);
+    mEntries.pop_back();
+    ++mStatistics.mEvictions;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace csp::wmsoverlays
@@ -0,0 +1,81 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#ifndef CSP_WMS_OVERLAYS_TEXTURE_CACHE_HPP
+#define CSP_WMS_OVERLAYS_TEXTURE_CACHE_HPP
+
+#include "WebMapTextureLoader.hpp"
+
+#include <list>
+#include <string>
+#include <unordered_map>
+
+namespace csp::wmsoverlays {
+
+/// Keeps decoded map textures in memory, for example the individual time steps of a time-dependent
+/// layer. The total size of the stored pixel data is limited to a given number of bytes. If this
+/// budget is exceeded, the least recently used textures are evicted. The most recently inserted
+/// texture is always kept, even if it is larger than the budget on its own.
+class WebMapTextureCache {
+ public:
+  /// Counters which can be used to judge whether the cache is large enough.
+  struct Statistics {
+    uint64_t mHits      = 0;
+    uint64_t mEvictions = 0;
+  };
+
+  explicit WebMapTextureCache(size_t maxBytes);
+
+  /// Changes the budget. Textures are evicted immediately if required.
+  void   setMaxBytes(size_t maxBytes);
+  size_t getMaxBytes() const;
+
+  /// Returns the size of all currently stored textures in bytes.
+  size_t getBytes() const;
+
+  /// Returns the number of currently stored textures.
+  size_t size() const;
+
+  /// Stores a texture under the given key. An existing texture with the same key is replaced.
+  void insert(std::string const& key, WebMapTexture texture);
+
+  /// Returns the texture stored under the given key and marks it as recently used. Returns nullptr
+  /// if there is no such texture. The pointer is valid until the next call to insert() or clear().
+  /// Each successful call is counted as cache hit.
+  WebMapTexture const* get(std::string const& key);
+
+  /// Returns true if a texture is stored under the given key. This does neither change the order
+  /// of the textures nor the statistics.
+  bool contains(std::string const& key) const;
+
+  /// Removes all textures. The statistics are not reset.
+  void clear();
+
+  Statistics const& getStatistics() const;
+  void              resetStatistics();
+
+  /// Returns the size of the pixel data of the given texture in bytes.
+  static size_t getBytes(WebMapTexture const& texture);
+
+ private:
+  void evict();
+
+  using Entry = std::pair<std::string, WebMapTexture>;
+
+  size_t mMaxBytes;
+  size_t mBytes = 0;
+
+  // The most recently used texture is at the front.
+  std::list<Entry>                                            mEntries;
+  std::unordered_map<std::string, std::list<Entry>::iterator> mLookup;
+
+  Statistics mStatistics;
+};
+
+} // namespace csp::wmsoverlays
+
+#endif // CSP_WMS_OVERLAYS_TEXTURE_CACHE_HPP
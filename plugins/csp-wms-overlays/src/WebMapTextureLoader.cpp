@@ -11,6 +11,7 @@
 
 #include "logger.hpp"
 
+#include "../../../src/cs-utils/FrameStats.hpp"
 #include "../../../src/cs-utils/convert.hpp"
 #include "../../../src/cs-utils/filesystem.hpp"
 #include "../../../src/cs-utils/utils.hpp"
@@ -32,24 +33,31 @@ namespace csp::wmsoverlays {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-WebMapTextureLoader::WebMapTextureLoader()
-    : mThreadPool(32) {
-}
-
-////////////////////////////////////////////////////////////////////////////////////////////////////
-
 std::future<std::optional<WebMapTexture>> WebMapTextureLoader::loadTextureAsync(
     WebMapService const& wms, WebMapLayer const& layer, Request const& request,
-    std::string const& mapCache, bool saveToCache) {
-  return mThreadPool.enqueue(
-      [=]() { return loadTexture(wms, layer, request, mapCache, saveToCache); });
+    std::string const& mapCache, bool saveToCache, cs::utils::TaskPriority priority,
+    cs::utils::CancellationToken const& token) {
+  return mTasks.enqueue(
+      [=, flowID = cs::utils::FrameStats::startFlow()]() {
+        static const cs::utils::FrameStats::RangeId range("Load WMS Texture");
+        cs::utils::FrameStats::ScopedTrace           trace(range, flowID);
+
+        // All tasks of a TaskGroup share the group's token, so the token of this request has to
+        // be checked here.
+        if (token.isCancelled()) {
+          return std::optional<WebMapTexture>();
+        }
+
+        return loadTexture(wms, layer, request, mapCache, saveToCache, token);
+      },
+      priority);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 std::optional<WebMapTexture> WebMapTextureLoader::loadTexture(WebMapService const& wms,
     WebMapLayer const& layer, Request const& request, std::string const& mapCache,
-    bool saveToCache) {
+    bool saveToCache, cs::utils::CancellationToken const& token) {
   boost::filesystem::path cachePath = getCachePath(wms, layer, request, mapCache);
   if (saveToCache) {
     // The file is already there, we can return it
@@ -69,6 +77,11 @@ std::optional<WebMapTexture> WebMapTextureLoader::loadTexture(WebMapService cons
     saveTextureToFile(cachePath, textureStream.value());
   }
 
+  // Decoding is skipped if the texture is not required anymore.
+  if (token.isCancelled()) {
+    return {};
+  }
+
   std::optional<WebMapTexture> texture = loadTextureFromStream(textureStream.value());
   return texture;
 }
@@ -192,7 +205,7 @@ std::optional<WebMapTexture> WebMapTextureLoader::loadTextureFromFile(std::strin
   int width, height, bpp;
   int channels = 4;
 
-  std::unique_ptr<unsigned char> pixels(
+  std::unique_ptr<unsigned char, WebMapTexture::Deleter> pixels(
       stbi_load(fileName.c_str(), &width, &height, &bpp, channels));
 
   if (!pixels) {
@@ -211,7 +224,7 @@ std::optional<WebMapTexture> WebMapTextureLoader::loadTextureFromStream(
   int width, height, bpp;
   int channels = 4;
 
-  std::unique_ptr<unsigned char> pixels(
+  std::unique_ptr<unsigned char, WebMapTexture::Deleter> pixels(
       stbi_load_from_memory(reinterpret_cast<unsigned char*>(stream.str().data()),
           static_cast<int>(stream.str().size()), &width, &height, &bpp, channels));
 
@@ -241,6 +254,10 @@ boost::filesystem::path WebMapTextureLoader::getCachePath(WebMapService const& w
   cacheDir << mapCache << "/" << layerFixed << "/";
   cacheDir << request.mMaxSize << "px/";
 
+  if (request.mTileId.has_value()) {
+    cacheDir << "tiles/";
+  }
+
   // Add year subdirectory, if time is specified.
   if (request.mTime.has_value()) {
     std::string       year;
@@ -263,7 +280,15 @@ boost::filesystem::path WebMapTextureLoader::getCachePath(WebMapService const& w
     std::replace(timeForFile.begin(), timeForFile.end(), '/', '-');
     std::replace(timeForFile.begin(), timeForFile.end(), ':', '-');
 
-    cacheFile << cacheDir.str() << timeForFile << "." << fileFormat;
+    cacheFile << cacheDir.str() << timeForFile;
+
+    if (request.mTileId.has_value()) {
+      cacheFile << "_" << request.mTileId.value();
+    }
+
+    cacheFile << "." << fileFormat;
+  } else if (request.mTileId.has_value()) {
+    cacheFile << cacheDir.str() << request.mTileId.value() << "." << fileFormat;
   } else {
     cacheFile << cacheDir.str() << layerFixed << "." << fileFormat;
   }
@@ -16,15 +16,23 @@
 #include <boost/filesystem.hpp>
 
 #include <array>
+#include <cstdlib>
 #include <map>
 
 namespace csp::wmsoverlays {
 
 /// Struct for storing texture data along with some metadata.
 struct WebMapTexture {
-  std::unique_ptr<unsigned char> mData;
-  int                            mWidth;
-  int                            mHeight;
+  /// The pixel data is allocated by stbi with malloc(), so it has to be released with free().
+  struct Deleter {
+    void operator()(unsigned char* data) const {
+      std::free(data);
+    }
+  };
+
+  std::unique_ptr<unsigned char, Deleter> mData;
+  int                                     mWidth;
+  int                                     mHeight;
 };
 
 /// Class for requesting map textures from Web Map Services.
@@ -36,21 +44,31 @@ class WebMapTextureLoader {
     std::string                mStyle;
     Bounds                     mBounds;
     std::optional<std::string> mTime;
+
+    /// If set, the request is for a tile of a tiled overlay. The id is used to distinguish the
+    /// cached tiles, as the cache path does not contain the bounds.
+    std::optional<std::string> mTileId;
   };
 
-  /// Creates a new ThreadPool with the specified amount of threads.
-  WebMapTextureLoader();
+  /// Textures are loaded asynchronously on the I/O ThreadPool.
+  WebMapTextureLoader() = default;
 
   /// Async WMS texture loader.
-  /// Returns an empty optional if loading the texture failed.
+  /// Returns an empty optional if loading the texture failed. If the given token is cancelled
+  /// before the texture has been loaded, an empty optional is returned as well. Requests of a
+  /// higher priority are processed first.
   std::future<std::optional<WebMapTexture>> loadTextureAsync(WebMapService const& wms,
       WebMapLayer const& layer, Request const& request, std::string const& mapCache,
-      bool saveToCache);
+      bool saveToCache, cs::utils::TaskPriority priority = cs::utils::TaskPriority::eNormal,
+      cs::utils::CancellationToken const& token = cs::utils::CancellationToken());
 
   /// WMS texture loader.
-  /// Returns an empty optional if loading the texture failed.
+  /// Returns an empty optional if loading the texture failed. If the given token is cancelled
+  /// while the texture is downloaded, the downloaded image is stored in the cache but not decoded
+  /// and an empty optional is returned.
   std::optional<WebMapTexture> loadTexture(WebMapService const& wms, WebMapLayer const& layer,
-      Request const& request, std::string const& mapCache, bool saveToCache);
+      Request const& request, std::string const& mapCache, bool saveToCache,
+      cs::utils::CancellationToken const& token = cs::utils::CancellationToken());
 
  private:
   /// Requests a map texture from a WMS.
@@ -82,8 +100,11 @@ class WebMapTextureLoader {
   const std::map<std::string, std::string> mMimeToExtension = {
       {"image/png", "png"}, {"image/jpeg", "jpg"}};
 
-  std::mutex            mTextureMutex;
-  cs::utils::ThreadPool mThreadPool;
+  std::mutex mTextureMutex;
+
+  // This is declared last so that pending requests are finished before the members above are
+  // destroyed.
+  cs::utils::TaskGroup mTasks{cs::utils::ThreadPool::getIO()};
 };
 
 } // namespace csp::wmsoverlays
@@ -0,0 +1,173 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "WebMapTextureRing.hpp"
+
+#include "../../../src/cs-utils/FrameStats.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace csp::wmsoverlays {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+WebMapTextureRing::WebMapTextureRing(int layerCount)
+    : mKeys(std::max(layerCount, 1)) {
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+WebMapTextureRing::~WebMapTextureRing() {
+  release();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void WebMapTextureRing::setLayerCount(int layerCount) {
+  layerCount = std::max(layerCount, 1);
+
+  if (layerCount != getLayerCount()) {
+    release();
+    mKeys.assign(layerCount, std::nullopt);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int WebMapTextureRing::getLayerCount() const {
+  return static_cast<int>(mKeys.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::optional<int> WebMapTextureRing::getLayer(std::string const& key) const {
+  for (size_t i = 0; i < mKeys.size(); ++i) {
+    if (mKeys[i] == key) {
+      return static_cast<int>(i);
+    }
+  }
+
+  return std::nullopt;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::optional<int> WebMapTextureRing::upload(
+    std::string const& key, WebMapTexture const& texture, std::vector<std::string> const& keep) {
+
+  if (texture.mWidth != mWidth || texture.mHeight != mHeight || mTexture == 0U) {
+    allocate(texture.mWidth, texture.mHeight);
+  }
+
+  // Re-use the layer if the key is already resident. Else prefer free layers over layers which
+  // are not needed anymore.
+  std::optional<int> layer = getLayer(key);
+
+  for (size_t i = 0; i < mKeys.size() && !layer; ++i) {
+    if (!mKeys[i]) {
+      layer = static_cast<int>(i);
+    }
+  }
+
+  for (size_t i = 0; i < mKeys.size() && !layer; ++i) {
+    if (std::find(keep.begin(), keep.end(), *mKeys[i]) == keep.end()) {
+      layer = static_cast<int>(i);
+    }
+  }
+
+  if (!layer) {
+    return std::nullopt;
+  }
+
+  static const cs::utils::FrameStats::RangeId range("Upload WMS Texture");
+  cs::utils::FrameStats::ScopedTimer          timer(range, cs::utils::FrameStats::TimerMode::eCPU);
+
+  auto start = std::chrono::steady_clock::now();
+
+  glBindTexture(GL_TEXTURE_2D_ARRAY, mTexture);
+  glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, *layer, mWidth, mHeight, 1, GL_RGBA,
+      GL_UNSIGNED_BYTE, texture.mData.get());
+  glBindTexture(GL_TEXTURE_2D_ARRAY, 0U);
+
+  mKeys[*layer] = key;
+
+  ++mStatistics.mUploads;
+  mStatistics.mUploadTime +=
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  return layer;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void WebMapTextureRing::clear() {
+  mKeys.assign(mKeys.size(), std::nullopt);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void WebMapTextureRing::bind(GLenum unit) const {
+  glActiveTexture(unit);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, mTexture);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void WebMapTextureRing::unbind(GLenum unit) const {
+  glActiveTexture(unit);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, 0U);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+WebMapTextureRing::Statistics const& WebMapTextureRing::getStatistics() const {
+  return mStatistics;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void WebMapTextureRing::resetStatistics() {
+  mStatistics = Statistics();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void WebMapTextureRing::allocate(int width, int height) {
+  release();
+
+  mWidth  = width;
+  mHeight = height;
+
+  glGenTextures(1, &mTexture);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, mTexture);
+  glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, mWidth, mHeight, getLayerCount(), 0, GL_RGBA,
+      GL_UNSIGNED_BYTE, nullptr);
+
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, 0U);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void WebMapTextureRing::release() {
+  if (mTexture != 0U) {
+    glDeleteTextures(1, &mTexture);
+    mTexture = 0U;
+  }
+
+  mWidth  = 0;
+  mHeight = 0;
+  clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace csp::wmsoverlays
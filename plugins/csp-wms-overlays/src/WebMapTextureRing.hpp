@@ -0,0 +1,88 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#ifndef CSP_WMS_OVERLAYS_TEXTURE_RING_HPP
+#define CSP_WMS_OVERLAYS_TEXTURE_RING_HPP
+
+#include "WebMapTextureLoader.hpp"
+
+#include <GL/glew.h>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace csp::wmsoverlays {
+
+/// A small number of map textures which are resident on the GPU at the same time. They are stored
+/// in the layers of a GL_TEXTURE_2D_ARRAY, so switching between them only requires changing the
+/// layer index in the shader. Each layer is identified by a key, for example the time step of the
+/// texture. When all layers are occupied, the layer of a texture which is not needed anymore is
+/// overwritten.
+///
+/// All textures in the ring have the same size. If a texture of a different size is uploaded, the
+/// array is reallocated and all other layers are discarded.
+class WebMapTextureRing {
+ public:
+  /// Counters for the time spent on uploading textures to the GPU.
+  struct Statistics {
+    uint64_t mUploads = 0;
+
+    /// The accumulated CPU time of all uploads in milliseconds.
+    double mUploadTime = 0.0;
+  };
+
+  /// The GPU memory is allocated when the first texture is uploaded.
+  explicit WebMapTextureRing(int layerCount);
+
+  WebMapTextureRing(WebMapTextureRing const& other) = delete;
+  WebMapTextureRing(WebMapTextureRing&& other)      = delete;
+
+  WebMapTextureRing& operator=(WebMapTextureRing const& other) = delete;
+  WebMapTextureRing& operator=(WebMapTextureRing&& other)      = delete;
+
+  ~WebMapTextureRing();
+
+  /// Changes the number of layers. If the number changes, all layers are discarded.
+  void setLayerCount(int layerCount);
+  int  getLayerCount() const;
+
+  /// Returns the layer in which the texture with the given key is stored or std::nullopt if it is
+  /// not resident on the GPU.
+  std::optional<int> getLayer(std::string const& key) const;
+
+  /// Uploads the given texture to a free layer. If there is none, a layer is overwritten whose key
+  /// is not contained in the given list of keys which are still needed. Returns the layer or
+  /// std::nullopt if all layers are needed.
+  std::optional<int> upload(
+      std::string const& key, WebMapTexture const& texture, std::vector<std::string> const& keep);
+
+  /// Marks all layers as free. The GPU memory is kept.
+  void clear();
+
+  void bind(GLenum unit) const;
+  void unbind(GLenum unit) const;
+
+  Statistics const& getStatistics() const;
+  void              resetStatistics();
+
+ private:
+  void allocate(int width, int height);
+  void release();
+
+  GLuint mTexture = 0U;
+  int    mWidth   = 0;
+  int    mHeight  = 0;
+
+  // The key of the texture in each layer or std::nullopt if the layer is free.
+  std::vector<std::optional<std::string>> mKeys;
+
+  Statistics mStatistics;
+};
+
+} // namespace csp::wmsoverlays
+
+#endif // CSP_WMS_OVERLAYS_TEXTURE_RING_HPP
@@ -0,0 +1,98 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "WebMapTile.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace csp::wmsoverlays {
+
+namespace {
+
+// Returns the edge length of the tiles of the given level in degrees.
+double getTileExtent(int level) {
+  return 180.0 / std::pow(2.0, level);
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+Bounds WebMapTile::getBounds() const {
+  double extent = getTileExtent(mLevel);
+  return Bounds(-180.0 + mX * extent, -180.0 + (mX + 1) * extent, -90.0 + mY * extent,
+      -90.0 + (mY + 1) * extent);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::string WebMapTile::getId() const {
+  return std::to_string(mLevel) + "_" + std::to_string(mX) + "_" + std::to_string(mY);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+WebMapTile WebMapTile::getParent() const {
+  if (mLevel == 0) {
+    return *this;
+  }
+
+  return WebMapTile{mLevel - 1, mX / 2, mY / 2};
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool WebMapTile::operator==(WebMapTile const& other) const {
+  return mLevel == other.mLevel && mX == other.mX && mY == other.mY;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int getTileLevel(double degreesPerPixel, int tileSize, int maxLevel) {
+  if (degreesPerPixel <= 0.0 || tileSize <= 0) {
+    return maxLevel;
+  }
+
+  // On level l, a tile has 180 / 2^l / tileSize degrees per pixel.
+  double level = std::ceil(std::log2(180.0 / (tileSize * degreesPerPixel)));
+  return std::clamp(static_cast<int>(level), 0, maxLevel);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::vector<WebMapTile> getTiles(Bounds const& bounds, int level) {
+  double extent = getTileExtent(level);
+  int    countX = 2 << level;
+  int    countY = 1 << level;
+
+  // Tiles which only touch the bounds are not included.
+  auto getIndex = [extent](double value, double origin, int count, bool upper) {
+    double index = (value - origin) / extent;
+    index        = upper ? std::ceil(index) - 1 : std::floor(index);
+    return std::clamp(static_cast<int>(index), 0, count - 1);
+  };
+
+  int minX = getIndex(bounds.mMinLon, -180.0, countX, false);
+  int maxX = getIndex(bounds.mMaxLon, -180.0, countX, true);
+  int minY = getIndex(bounds.mMinLat, -90.0, countY, false);
+  int maxY = getIndex(bounds.mMaxLat, -90.0, countY, true);
+
+  std::vector<WebMapTile> tiles;
+
+  for (int y = minY; y <= maxY; ++y) {
+    for (int x = minX; x <= maxX; ++x) {
+      tiles.push_back(WebMapTile{level, x, y});
+    }
+  }
+
+  return tiles;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace csp::wmsoverlays
@@ -0,0 +1,49 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#ifndef CSP_WMS_OVERLAYS_WEB_MAP_TILE_HPP
+#define CSP_WMS_OVERLAYS_WEB_MAP_TILE_HPP
+
+#include "utils.hpp"
+
+#include <string>
+#include <vector>
+
+namespace csp::wmsoverlays {
+
+/// A tile of the quadtree which is used for tiled overlays. Level zero consists of two tiles of
+/// 180 by 180 degrees, which cover the western and the eastern hemisphere. On each following level,
+/// a tile is split into four children. The x index grows eastwards starting at -180 degrees
+/// longitude, the y index grows northwards starting at -90 degrees latitude.
+struct WebMapTile {
+  int mLevel = 0;
+  int mX     = 0;
+  int mY     = 0;
+
+  /// The geographical extent of the tile in degrees.
+  Bounds getBounds() const;
+
+  /// Returns a string which uniquely identifies this tile. It can be used as a file name.
+  std::string getId() const;
+
+  /// Returns the tile on the previous level which contains this tile. Tiles on level zero are
+  /// their own parent.
+  WebMapTile getParent() const;
+
+  bool operator==(WebMapTile const& other) const;
+};
+
+/// Returns the lowest quadtree level on which a tile with the given resolution in pixels has at
+/// most the given amount of degrees per pixel. The result is clamped to [0, maxLevel].
+int getTileLevel(double degreesPerPixel, int tileSize, int maxLevel);
+
+/// Returns all tiles of the given level which overlap the given bounds.
+std::vector<WebMapTile> getTiles(Bounds const& bounds, int level);
+
+} // namespace csp::wmsoverlays
+
+#endif // CSP_WMS_OVERLAYS_WEB_MAP_TILE_HPP
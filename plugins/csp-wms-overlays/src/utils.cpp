@@ -22,6 +22,62 @@ bool Duration::isDuration() const {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+double Duration::getApproximateSeconds() const {
+  const double secondsPerYear = 365.2425 * 24.0 * 60.0 * 60.0;
+  return mYears * secondsPerYear + mMonths * secondsPerYear / 12.0 +
+         static_cast<double>(mTimeDuration.total_milliseconds()) / 1000.0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void from_json(nlohmann::json const& j, Bounds& o) {
+  std::array<double, 4> bounds{};
+  j.get_to(bounds);
+  o.mMinLon = bounds[0];
+  o.mMaxLon = bounds[1];
+  o.mMinLat = bounds[2];
+  o.mMaxLat = bounds[3];
+}
+
+void to_json(nlohmann::json& j, Bounds const& o) {
+  std::array<double, 4> bounds{o.mMinLon, o.mMaxLon, o.mMinLat, o.mMaxLat};
+  j = bounds;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void from_json(nlohmann::json const& j, Duration& o) {
+  o.mYears        = j.at("years").get<int>();
+  o.mMonths       = j.at("months").get<int>();
+  o.mTimeDuration = boost::posix_time::microseconds(j.at("duration").get<int64_t>());
+}
+
+void to_json(nlohmann::json& j, Duration const& o) {
+  j = {{"years", o.mYears}, {"months", o.mMonths},
+      {"duration", o.mTimeDuration.total_microseconds()}};
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+const boost::posix_time::ptime cEpoch(boost::gregorian::date(1970, 1, 1));
+} // namespace
+
+void from_json(nlohmann::json const& j, TimeInterval& o) {
+  o.mStartTime      = cEpoch + boost::posix_time::microseconds(j.at("start").get<int64_t>());
+  o.mEndTime        = cEpoch + boost::posix_time::microseconds(j.at("end").get<int64_t>());
+  o.mFormat         = j.at("format").get<std::string>();
+  o.mSampleDuration = j.at("sampleDuration").get<Duration>();
+}
+
+void to_json(nlohmann::json& j, TimeInterval const& o) {
+  j = {{"start", (o.mStartTime - cEpoch).total_microseconds()},
+      {"end", (o.mEndTime - cEpoch).total_microseconds()}, {"format", o.mFormat},
+      {"sampleDuration", o.mSampleDuration}};
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 namespace utils {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
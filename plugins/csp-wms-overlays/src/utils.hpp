@@ -11,6 +11,7 @@
 #include "../../../src/cs-utils/convert.hpp"
 
 #include <VistaTools/tinyXML/tinyxml.h>
+#include <nlohmann/json.hpp>
 
 #include <optional>
 #include <regex>
@@ -55,6 +56,10 @@ struct Duration {
   /// Checks whether the object represents a non-zero duration.
   bool isDuration() const;
 
+  /// Returns the length of the duration in seconds. Years and months are approximated by their
+  /// average length.
+  double getApproximateSeconds() const;
+
   inline bool operator==(const Duration& rhs) const {
     return mYears == rhs.mYears && mMonths == rhs.mMonths && mTimeDuration == rhs.mTimeDuration;
   }
@@ -73,6 +78,17 @@ struct TimeInterval {
   }
 };
 
+/// Bounds are stored as an array of [minLon, maxLon, minLat, maxLat].
+void from_json(nlohmann::json const& j, Bounds& o);
+void to_json(nlohmann::json& j, Bounds const& o);
+
+/// Points in time and durations are stored as microseconds, so that parsed time intervals can be
+/// cached without having to parse ISO strings again.
+void from_json(nlohmann::json const& j, Duration& o);
+void to_json(nlohmann::json& j, Duration const& o);
+void from_json(nlohmann::json const& j, TimeInterval& o);
+void to_json(nlohmann::json& j, TimeInterval const& o);
+
 /// This namespace contains some utility functions for:
 /// A) Handling the format used by WMS for describing temporal data
 ///     The valid times for a given layer are generally specified as a comma-seperated list of
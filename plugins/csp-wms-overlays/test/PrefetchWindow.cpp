@@ -0,0 +1,129 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "../src/PrefetchWindow.hpp"
+
+#include "../../../src/cs-utils/doctest.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <vector>
+
+namespace csp::wmsoverlays {
+
+namespace {
+
+// Simulates the playback of a time-dependent layer with daily samples at 60 frames per second. Each
+// request takes the given latency in seconds to complete, requests outside the prefetch window are
+// cancelled. Returns the number of frames after the first sample was loaded in which the current
+// sample was not available.
+int simulatePlayback(double timeSpeed, double latency, int minAhead = 0) {
+  const double sampleDuration = 24.0 * 60.0 * 60.0;
+  const double frameTime      = 1.0 / 60.0;
+
+  PrefetchWindow            window;
+  std::map<int64_t, bool>   loaded;
+  std::map<int64_t, double> pending;
+
+  double simulationTime = 0.0;
+  int    gaps           = 0;
+  bool   started        = false;
+
+  for (double realTime = 0.0; realTime < 10.0; realTime += frameTime) {
+    auto current = static_cast<int64_t>(std::floor(simulationTime / sampleDuration));
+
+    // Complete requests whose latency has passed.
+    for (auto it = pending.begin(); it != pending.end();) {
+      if (realTime - it->second >= latency) {
+        loaded[it->first] = true;
+        window.addLatency(realTime - it->second);
+        it = pending.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    // Collect the samples of the current window, cancel the others and request the missing ones.
+    auto                 range = window.compute(timeSpeed, sampleDuration, minAhead);
+    std::vector<int64_t> samples{current};
+    for (int i = 1; i <= range.mAhead; ++i) {
+      samples.push_back(current + i * range.mDirection);
+    }
+
+    for (auto it = pending.begin(); it != pending.end();) {
+      if (std::find(samples.begin(), samples.end(), it->first) == samples.end()) {
+        it = pending.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    for (auto sample : samples) {
+      if (!loaded.count(sample) && !pending.count(sample)) {
+        pending[sample] = realTime;
+      }
+    }
+
+    if (loaded.count(current)) {
+      started = true;
+    } else if (started) {
+      ++gaps;
+    }
+
+    simulationTime += timeSpeed * frameTime;
+  }
+
+  return gaps;
+}
+
+} // namespace
+
+TEST_CASE("csp::wmsoverlays::PrefetchWindow::compute") {
+  PrefetchWindow window;
+  window.addLatency(0.5);
+
+  // Nothing is pre-fetched when the time is paused.
+  CHECK_EQ(window.compute(0.0, 3600.0, 5).mAhead, 0);
+
+  // At real-time speed, hourly samples only require the configured minimum or the next two
+  // samples.
+  CHECK_EQ(window.compute(1.0, 3600.0, 3).mAhead, 3);
+  CHECK_EQ(window.compute(1.0, 3600.0, 0).mAhead, 2);
+
+  // Ten samples per second with half a second latency require eleven samples ahead.
+  auto range = window.compute(-36000.0, 3600.0, 0);
+  CHECK_EQ(range.mAhead, 11);
+  CHECK_EQ(range.mDirection, -1);
+
+  // The window is limited.
+  CHECK_EQ(window.compute(1e9, 3600.0, 0).mAhead, PrefetchWindow::cMaxSamples);
+}
+
+TEST_CASE("csp::wmsoverlays::PrefetchWindow::addLatency") {
+  PrefetchWindow window;
+  CHECK_EQ(window.getLatency(), doctest::Approx(1.0));
+
+  window.addLatency(0.2);
+  CHECK_EQ(window.getLatency(), doctest::Approx(0.2));
+
+  window.addLatency(1.2);
+  CHECK_EQ(window.getLatency(), doctest::Approx(0.4));
+}
+
+TEST_CASE("csp::wmsoverlays::PrefetchWindow has no gaps during playback") {
+  // Time speeds in days per second and load latencies in seconds.
+  for (double daysPerSecond : {0.5, 2.0, 8.0, -8.0}) {
+    for (double latency : {0.05, 0.3, 1.0}) {
+      CAPTURE(daysPerSecond);
+      CAPTURE(latency);
+      CHECK_EQ(simulatePlayback(daysPerSecond * 24.0 * 60.0 * 60.0, latency), 0);
+    }
+  }
+}
+
+} // namespace csp::wmsoverlays
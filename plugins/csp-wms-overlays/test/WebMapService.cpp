@@ -0,0 +1,101 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "../src/WebMapService.hpp"
+
+#include "../../../src/cs-utils/doctest.hpp"
+#include "../../../src/cs-utils/filesystem.hpp"
+
+#include <boost/date_time/gregorian/gregorian.hpp>
+#include <boost/filesystem.hpp>
+
+#include <regex>
+#include <sstream>
+
+namespace csp::wmsoverlays {
+
+namespace {
+
+const std::string cUrl = "https://example.com/wms";
+
+// Writes a capability document with the given number of time-dependent layers to the given cache
+// directory, so that it can be loaded with CacheMode::eAlways without contacting a server. Each
+// layer lists the given number of single days, similar to the documents of NASA GIBS. Returns the
+// path of the written file.
+boost::filesystem::path writeCapabilities(
+    boost::filesystem::path const& cacheDir, int layerCount, int timeSteps) {
+  std::stringstream xml;
+  xml << R"(<?xml version="1.0" encoding="UTF-8"?>)"
+      << R"(<WMS_Capabilities version="1.3.0" updateSequence="42">)"
+      << "<Service><Title>Test Service</Title><MaxWidth>2048</MaxWidth></Service>"
+      << "<Capability><Request><GetMap><Format>image/png</Format><Format>image/jpeg</Format>"
+      << "</GetMap></Request>"
+      << "<Layer><Title>Root</Title><CRS>CRS:84</CRS>";
+
+  for (int i = 0; i < layerCount; ++i) {
+    xml << "<Layer><Name>layer_" << i << "</Name><Title>Layer " << i << "</Title>"
+        << R"(<BoundingBox CRS="CRS:84" minx="-90" miny="-45" maxx="90" maxy="45"/>)"
+        << R"(<Style><Name>default</Name><Title>Default</Title></Style>)"
+        << R"(<Dimension name="time" units="ISO8601">)";
+
+    boost::gregorian::date date(2000, 1, 1);
+    for (int t = 0; t < timeSteps; ++t) {
+      xml << (t > 0 ? "," : "") << boost::gregorian::to_iso_extended_string(date);
+      date += boost::gregorian::days(2);
+    }
+
+    xml << "</Dimension></Layer>";
+  }
+
+  xml << "</Layer></Capability></WMS_Capabilities>";
+
+  cs::utils::filesystem::createDirectoryRecursively(cacheDir);
+
+  boost::filesystem::path file =
+      cacheDir / (std::regex_replace(cUrl, std::regex("[/:*]"), "_") + ".xml");
+  cs::utils::filesystem::writeStringToFile(file.string(), xml.str());
+
+  return file;
+}
+
+} // namespace
+
+TEST_CASE("csp::wmsoverlays::WebMapService restores parsed capabilities from the cache") {
+  auto cacheDir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+  auto xmlFile  = writeCapabilities(cacheDir, 3, 5);
+
+  WebMapService parsed(cUrl, WebMapService::CacheMode::eAlways, cacheDir.string());
+
+  // Without the capability document, the service can only be restored from the parsed layers.
+  boost::filesystem::remove(xmlFile);
+  WebMapService cached(cUrl, WebMapService::CacheMode::eAlways, cacheDir.string());
+
+  CHECK(cached.getTitle() == "Test Service");
+  CHECK(cached.getSettings().mMaxWidth == parsed.getSettings().mMaxWidth);
+  CHECK(!cached.getSettings().mMaxHeight.has_value());
+  CHECK(cached.isFormatSupported("image/jpeg"));
+
+  REQUIRE(parsed.getLayers().size() == 3);
+  REQUIRE(cached.getLayers().size() == parsed.getLayers().size());
+
+  for (size_t i = 0; i < parsed.getLayers().size(); ++i) {
+    auto const& expected = parsed.getLayers()[i];
+    auto const& actual   = cached.getLayers()[i];
+
+    CHECK(actual.getName() == expected.getName());
+    CHECK(actual.getTitle() == expected.getTitle());
+    CHECK(actual.getSettings().mBounds == expected.getSettings().mBounds);
+    CHECK(actual.getSettings().mCrs == expected.getSettings().mCrs);
+    CHECK(actual.getSettings().mStyles.size() == 1);
+    CHECK(actual.getSettings().mTimeIntervals.size() == 5);
+    CHECK(actual.getSettings().mTimeIntervals == expected.getSettings().mTimeIntervals);
+  }
+
+  boost::filesystem::remove_all(cacheDir);
+}
+
+} // namespace csp::wmsoverlays
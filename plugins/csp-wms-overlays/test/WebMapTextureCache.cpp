@@ -0,0 +1,64 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "../src/WebMapTextureCache.hpp"
+
+#include "../../../src/cs-utils/doctest.hpp"
+
+#include <cstdlib>
+
+namespace csp::wmsoverlays {
+
+namespace {
+WebMapTexture createTexture(int width, int height) {
+  auto* data = static_cast<unsigned char*>(std::malloc(width * height * 4));
+  return WebMapTexture{std::unique_ptr<unsigned char, WebMapTexture::Deleter>(data), width, height};
+}
+} // namespace
+
+TEST_CASE("csp::wmsoverlays::WebMapTextureCache") {
+  // Each texture has 4 * 4 * 4 = 64 bytes, so three of them fit into the cache.
+  WebMapTextureCache cache(200);
+
+  cache.insert("a", createTexture(4, 4));
+  cache.insert("b", createTexture(4, 4));
+  cache.insert("c", createTexture(4, 4));
+
+  CHECK_EQ(cache.size(), 3);
+  CHECK_EQ(cache.getBytes(), 192);
+
+  // Using "a" makes "b" the least recently used texture.
+  CHECK_NE(cache.get("a"), nullptr);
+  CHECK_EQ(cache.get("x"), nullptr);
+
+  cache.insert("d", createTexture(4, 4));
+
+  CHECK_EQ(cache.size(), 3);
+  CHECK_UNARY(cache.contains("a"));
+  CHECK_UNARY_FALSE(cache.contains("b"));
+  CHECK_EQ(cache.getStatistics().mHits, 1);
+  CHECK_EQ(cache.getStatistics().mEvictions, 1);
+
+  // Replacing a texture does not count as eviction.
+  cache.insert("d", createTexture(2, 2));
+  CHECK_EQ(cache.getBytes(), 144);
+  CHECK_EQ(cache.getStatistics().mEvictions, 1);
+
+  // The most recently inserted texture is kept even if it exceeds the budget.
+  cache.insert("e", createTexture(16, 16));
+  CHECK_EQ(cache.size(), 1);
+  CHECK_UNARY(cache.contains("e"));
+
+  cache.setMaxBytes(0);
+  CHECK_EQ(cache.size(), 1);
+
+  cache.clear();
+  CHECK_EQ(cache.size(), 0);
+  CHECK_EQ(cache.getBytes(), 0);
+}
+
+} // namespace csp::wmsoverlays
@@ -0,0 +1,59 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "../src/WebMapTile.hpp"
+
+#include "../../../src/cs-utils/doctest.hpp"
+
+namespace csp::wmsoverlays {
+
+TEST_CASE("csp::wmsoverlays::WebMapTile::getBounds") {
+  CHECK(WebMapTile{0, 0, 0}.getBounds() == Bounds(-180.0, 0.0, -90.0, 90.0));
+  CHECK(WebMapTile{0, 1, 0}.getBounds() == Bounds(0.0, 180.0, -90.0, 90.0));
+  CHECK(WebMapTile{2, 5, 3}.getBounds() == Bounds(45.0, 90.0, 45.0, 90.0));
+}
+
+TEST_CASE("csp::wmsoverlays::WebMapTile::getParent") {
+  CHECK(WebMapTile{2, 5, 3}.getParent() == WebMapTile{1, 2, 1});
+  CHECK(WebMapTile{0, 1, 0}.getParent() == WebMapTile{0, 1, 0});
+  CHECK(WebMapTile{2, 5, 3}.getId() != WebMapTile{2, 3, 5}.getId());
+}
+
+TEST_CASE("csp::wmsoverlays::getTileLevel") {
+  // A 256 pixel tile on level zero has about 0.7 degrees per pixel.
+  CHECK_EQ(getTileLevel(1.0, 256, 10), 0);
+  CHECK_EQ(getTileLevel(180.0 / 256.0, 256, 10), 0);
+  CHECK_EQ(getTileLevel(180.0 / 512.0, 256, 10), 1);
+  CHECK_EQ(getTileLevel(180.0 / 600.0, 256, 10), 2);
+
+  // The result is clamped to the maximum level.
+  CHECK_EQ(getTileLevel(1e-9, 256, 10), 10);
+}
+
+TEST_CASE("csp::wmsoverlays::getTiles") {
+  // The entire globe.
+  CHECK_EQ(getTiles(Bounds(-180.0, 180.0, -90.0, 90.0), 0).size(), 2);
+  CHECK_EQ(getTiles(Bounds(-180.0, 180.0, -90.0, 90.0), 2).size(), 32);
+
+  // Tiles which only touch the bounds are excluded.
+  auto tiles = getTiles(Bounds(0.0, 45.0, 0.0, 45.0), 2);
+  REQUIRE_EQ(tiles.size(), 1);
+  CHECK(tiles[0] == WebMapTile{2, 4, 2});
+
+  // Bounds overlapping four tiles.
+  tiles = getTiles(Bounds(40.0, 50.0, 40.0, 50.0), 2);
+  CHECK_EQ(tiles.size(), 4);
+
+  // Panning only adds the newly exposed tiles.
+  auto before = getTiles(Bounds(10.0, 80.0, 10.0, 20.0), 3);
+  auto after  = getTiles(Bounds(40.0, 100.0, 10.0, 20.0), 3);
+  CHECK_EQ(before.size(), 4);
+  CHECK_EQ(after.size(), 4);
+  CHECK(before[1] == after[0]);
+}
+
+} // namespace csp::wmsoverlays
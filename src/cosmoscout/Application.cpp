@@ -16,9 +16,11 @@
 #include "../cs-core/SolarSystem.hpp"
 #include "../cs-core/TimeControl.hpp"
 #include "../cs-graphics/MouseRay.hpp"
+#include "../cs-graphics/TextureLoader.hpp"
 #include "../cs-scene/CelestialSurface.hpp"
 #include "../cs-utils/Downloader.hpp"
 #include "../cs-utils/FrameStats.hpp"
+#include "../cs-utils/ThreadPool.hpp"
 #include "../cs-utils/convert.hpp"
 #include "../cs-utils/filesystem.hpp"
 #include "../cs-utils/logger.hpp"
@@ -63,8 +65,10 @@
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-Application::Application(std::shared_ptr<cs::core::Settings> settings)
-    : mSettings(std::move(settings)) {
+Application::Application(std::shared_ptr<cs::core::Settings> settings, bool sequentialPlugins)
+    : mSettings(std::move(settings))
+    , mSequentialPlugins(sequentialPlugins)
+    , mStartupTime(std::chrono::steady_clock::now()) {
 
   mSettings->onLoad().connect([this]() { onLoad(); });
 
@@ -106,6 +110,9 @@ bool Application::Init(VistaSystem* pVistaSystem) {
   // Make sure that our shaders are found by ViSTA.
   VistaShaderRegistry::GetInstance().AddSearchDirectory("../share/resources/shaders");
 
+  // This name is shown for the main thread in exported traces.
+  cs::utils::FrameStats::setThreadName("Main Thread");
+
   // First we create all our core classes.
   mInputManager   = std::make_shared<cs::core::InputManager>(mSettings);
   mGraphicsEngine = std::make_shared<cs::core::GraphicsEngine>(mSettings);
@@ -178,6 +185,13 @@ void Application::Quit() {
   // Do not attempt to print anything to the on-screen console.
   cs::utils::onLogMessage().disconnect(mOnMessageConnection);
 
+  // Wait for plugins which are still being prepared on the thread pool.
+  for (auto const& plugin : mPlugins) {
+    if (plugin.second.mPrepared.valid()) {
+      plugin.second.mPrepared.wait();
+    }
+  }
+
   // De-init all plugins first.
   for (auto const& plugin : mPlugins) {
     plugin.second.mPlugin->deInit();
@@ -318,6 +332,16 @@ void Application::FrameUpdate() {
   }
   mPluginsToLoad.clear();
 
+  // upload textures -------------------------------------------------------------------------------
+
+  // Textures which are loaded asynchronously by the plugins are copied to the GPU in chunks. This
+  // limits the time spent on uploading textures in each frame.
+  {
+    cs::utils::FrameStats::ScopedTimer timer("Upload Textures");
+    const size_t cTextureUploadBudget = 32 * 1024 * 1024;
+    cs::graphics::TextureLoader::uploadPendingTextures(cTextureUploadBudget);
+  }
+
   // download datsets at application startup -------------------------------------------------------
 
   // At frame 25 we start to download datasets. This ensures that the loading screen is actually
@@ -325,10 +349,14 @@ void Application::FrameUpdate() {
   int32_t const waitFrames = 25;
   if (GetFrameCount() == waitFrames) {
     if (!mSettings->mDownloadData.empty()) {
-      // Download datasets in parallel. We use 10 threads to download the data.
-      mDownloader = std::make_unique<cs::utils::Downloader>(10);
+      // Download datasets in parallel on the global thread pool. Interrupted downloads are
+      // resumed, large files are downloaded in several chunks in parallel.
+      mDownloader = std::make_unique<cs::utils::Downloader>();
       for (auto const& download : mSettings->mDownloadData) {
-        mDownloader->download(download.mUrl, download.mFile);
+        cs::utils::Downloader::Options options;
+        options.mSHA256  = download.mSHA256;
+        options.mRefresh = download.mRefresh.value_or(false);
+        mDownloader->download(download.mUrl, download.mFile, options);
       }
 
       // If all files were already downloaded, this could have gone quite quickly...
@@ -380,57 +408,64 @@ void Application::FrameUpdate() {
   // loading the plugins.
   if (mDownloadedData && !mLoadedAllPlugins) {
 
-    // Before loading the first plugin and between loading the individual plugins, we will draw some
-    // frames. This allows the loading screen to update the status message and move the progress
-    // bar. For now, we wait a hard-coded number of 25 frames before and between loading of the
-    // plugins.
-    const int32_t cLoadingDelay = 25;
+    // In the first frame, the resources of all plugins are loaded concurrently on the global thread
+    // pool. With --sequential-plugins, initPlugin() prepares each plugin on the main thread
+    // instead.
+    if (GetFrameCount() == mStartPluginLoadingAtFrame) {
+      mStartPluginLoadingTime = std::chrono::steady_clock::now();
 
-    // Every 25th frame something happens. At frame X we will show the name of the plugin on the
-    // loading screen which will be loaded at frame X+25. At frame X+25 we will load the according
-    // plugin and also update the loading screen to display the name of the plugin which is going to
-    // be loaded at frame X+50. And so on.
-    if (((GetFrameCount() - mStartPluginLoadingAtFrame) % cLoadingDelay) == 0) {
-
-      // Calculate the index of the plugin which should be loaded this frame.
-      int32_t pluginToLoad = (GetFrameCount() - mStartPluginLoadingAtFrame) / cLoadingDelay - 1;
+      for (auto const& plugin : mPlugins) {
+        if (!mSequentialPlugins) {
+          preparePlugin(plugin.first);
+        }
+        mPluginsToInit.insert(plugin.first);
+      }
+    }
 
-      if (pluginToLoad >= 0 && pluginToLoad < static_cast<int32_t>(mPlugins.size())) {
+    // Then we initialize one plugin each frame as soon as its resources are available. Drawing
+    // frames in between allows the loading screen to update the status message and move the
+    // progress bar.
+    auto pluginToInit = getNextPluginToInit();
 
-        // Get an iterator pointing to the plugin handle.
-        auto plugin = mPlugins.begin();
-        std::advance(plugin, pluginToLoad);
+    if (pluginToInit) {
+      initPlugin(*pluginToInit);
+      mPluginsToInit.erase(*pluginToInit);
 
-        initPlugin(plugin->first);
+      // Display the name of a plugin which is still loading and update the progress accordingly.
+      if (!mPluginsToInit.empty()) {
+        mGuiManager->setLoadingScreenStatus("Loading " + *mPluginsToInit.begin() + " ...");
+        mGuiManager->setLoadingScreenProgress(
+            100.F * static_cast<float>(mPlugins.size() - mPluginsToInit.size()) / mPlugins.size(),
+            true);
+      }
+    }
 
-      } else if (pluginToLoad == static_cast<int32_t>(mPlugins.size())) {
+    if (mPluginsToInit.empty()) {
 
-        logger().info("Ready for Takeoff!");
+      // The total time spent in prepare() shows how long loading would have taken sequentially.
+      auto   now     = std::chrono::steady_clock::now();
+      double seconds = std::chrono::duration<double>(now - mStartPluginLoadingTime).count();
+      logger().info("Loaded {} plugins {} in {:.2f} s ({:.2f} s spent in prepare()).",
+          mPlugins.size(), mSequentialPlugins ? "sequentially" : "concurrently", seconds,
+          static_cast<double>(mPrepareMicroseconds.load()) * 1e-6);
 
-        // Once all plugins have been loaded, we set a boolean indicating this state.
-        mLoadedAllPlugins = true;
+      logger().info("Ready for Takeoff after {:.2f} s!",
+          std::chrono::duration<double>(now - mStartupTime).count());
 
-        // Update the loading screen status.
-        mGuiManager->setLoadingScreenStatus("Ready for Takeoff");
-        mGuiManager->setLoadingScreenProgress(100.F, true);
+      // Once all plugins have been loaded, we set a boolean indicating this state.
+      mLoadedAllPlugins = true;
 
-        // We will keep the loading screen active for some frames, as the first frames are usually a
-        // bit choppy as data is uploaded to the GPU.
-        mHideLoadingScreenAtFrame = GetFrameCount() + cLoadingDelay;
+      // Update the loading screen status.
+      mGuiManager->setLoadingScreenStatus("Ready for Takeoff");
+      mGuiManager->setLoadingScreenProgress(100.F, true);
 
-        // Call code which has to be executed whenever the settings are reloaded.
-        onLoad();
-      }
+      // We will keep the loading screen active for some frames, as the first frames are usually a
+      // bit choppy as data is uploaded to the GPU.
+      const int32_t cLoadingDelay = 25;
+      mHideLoadingScreenAtFrame   = GetFrameCount() + cLoadingDelay;
 
-      // If there is a plugin going to be loaded after the next cLoadingDelay frames, display its
-      // name on the loading screen and update the progress accordingly.
-      if (pluginToLoad + 1 < static_cast<int32_t>(mPlugins.size())) {
-        auto plugin = mPlugins.begin();
-        std::advance(plugin, pluginToLoad + 1);
-        mGuiManager->setLoadingScreenStatus("Loading " + plugin->first + " ...");
-        mGuiManager->setLoadingScreenProgress(
-            100.F * static_cast<float>(pluginToLoad + 1) / mPlugins.size(), true);
-      }
+      // Call code which has to be executed whenever the settings are reloaded.
+      onLoad();
     }
   }
 
@@ -504,7 +539,7 @@ void Application::FrameUpdate() {
     {
       cs::utils::FrameStats::ScopedTimer timer("Update Plugins");
       for (auto const& plugin : mPlugins) {
-        cs::utils::FrameStats::ScopedTimer timer("Update " + plugin.first);
+        cs::utils::FrameStats::ScopedTimer timer(plugin.second.mUpdateRange);
 
         try {
           plugin.second.mPlugin->update();
@@ -567,7 +602,7 @@ void Application::FrameUpdate() {
 
     // Call update on all APIs
     if (mLoadedAllPlugins) {
-      mGuiManager->getGui()->callJavascript("CosmoScout.update");
+      mGuiManager->getGui()->queueJavascript("CosmoScout.update");
     }
 
     if (mSolarSystem->pActiveObject.get()) {
@@ -594,10 +629,9 @@ void Application::FrameUpdate() {
       double heightDiff = polar.z / mSettings->mGraphics.pHeightScale.get() - surfaceHeight;
 
       if (!std::isnan(polar.x) && !std::isnan(polar.y) && !std::isnan(heightDiff)) {
-        mGuiManager->getGui()->executeJavascript(
-            fmt::format("CosmoScout.state.observerLngLatHeight = [{}, {}, {}]",
-                cs::utils::convert::toDegrees(polar.x), cs::utils::convert::toDegrees(polar.y),
-                heightDiff));
+        mGuiManager->getGui()->queueState("observerLngLatHeight",
+            fmt::format("[{}, {}, {}]", cs::utils::convert::toDegrees(polar.x),
+                cs::utils::convert::toDegrees(polar.y), heightDiff));
       }
 
       // Update the compass in the header bar.
@@ -613,7 +647,7 @@ void Application::FrameUpdate() {
           angle = -angle;
         }
 
-        mGuiManager->getGui()->callJavascript("CosmoScout.timeline.setNorthDirection", angle);
+        mGuiManager->getGui()->queueJavascript("CosmoScout.timeline.setNorthDirection", angle);
 
       } catch (std::exception const& e) {
         // Getting the relative transformation may fail due to insufficient SPICE data.
@@ -734,7 +768,9 @@ void Application::openPlugin(std::string const& name) {
         logger().info("Opening plugin '{}'.", name);
 
         // Actually call the plugin's constructor and add the returned pointer to out list.
-        mPlugins.insert(std::pair<std::string, Plugin>(name, {pluginHandle, pluginConstructor()}));
+        mPlugins.insert(std::pair<std::string, Plugin>(name,
+            {pluginHandle, pluginConstructor(), false,
+                cs::utils::FrameStats::RangeId("Update " + name)}));
       } else {
         logger().warn("Failed to load plugin '{}': {}", name, LIBERROR());
       }
@@ -748,19 +784,58 @@ void Application::openPlugin(std::string const& name) {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void Application::preparePlugin(std::string const& name) {
+  auto plugin = mPlugins.find(name);
+
+  if (plugin != mPlugins.end() && !plugin->second.mIsInitialized &&
+      !plugin->second.mPrepared.valid()) {
+
+    // First provide the plugin with all required class instances.
+    plugin->second.mPlugin->setAPI(mSettings, mSolarSystem, mGuiManager, mInputManager,
+        GetVistaSystem()->GetGraphicsManager()->GetSceneGraph(), mGraphicsEngine, mTimeControl);
+
+    // Then load the resources on a worker thread. Any exception is rethrown in initPlugin(). The
+    // settings are copied here, as the main thread may modify mSettings while prepare() runs.
+    auto* instance = plugin->second.mPlugin;
+
+    plugin->second.mPrepared = cs::utils::ThreadPool::getGlobal().enqueue(
+        [this, instance, pluginSettings = mSettings->mPlugins.at(name)]() {
+          auto start = std::chrono::steady_clock::now();
+          instance->prepare(pluginSettings);
+          mPrepareMicroseconds += std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now() - start)
+                                      .count();
+        },
+        cs::utils::TaskPriority::eHigh);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 void Application::initPlugin(std::string const& name) {
   auto plugin = mPlugins.find(name);
 
   if (plugin != mPlugins.end()) {
     if (!plugin->second.mIsInitialized) {
 
-      // First provide the plugin with all required class instances.
-      plugin->second.mPlugin->setAPI(mSettings, mSolarSystem, mGuiManager, mInputManager,
-          GetVistaSystem()->GetGraphicsManager()->GetSceneGraph(), mGraphicsEngine, mTimeControl);
-
-      // Then do the actual initialization. This may actually take a while and the application will
-      // become unresponsive in the meantime.
+      // Do the actual initialization. If the plugin has not been prepared on the thread pool
+      // before, this may actually take a while and the application will become unresponsive in
+      // the meantime.
       try {
+        if (plugin->second.mPrepared.valid()) {
+          plugin->second.mPrepared.get();
+        } else {
+          plugin->second.mPlugin->setAPI(mSettings, mSolarSystem, mGuiManager, mInputManager,
+              GetVistaSystem()->GetGraphicsManager()->GetSceneGraph(), mGraphicsEngine,
+              mTimeControl);
+
+          auto start = std::chrono::steady_clock::now();
+          plugin->second.mPlugin->prepare(mSettings->mPlugins.at(name));
+          mPrepareMicroseconds += std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now() - start)
+                                      .count();
+        }
+
         plugin->second.mPlugin->init();
         plugin->second.mIsInitialized = true;
 
@@ -777,6 +852,23 @@ void Application::initPlugin(std::string const& name) {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+std::optional<std::string> Application::getNextPluginToInit() const {
+
+  // If several plugins are ready, they are initialized in alphabetical order as before.
+  for (auto const& name : mPluginsToInit) {
+    auto const& plugin = mPlugins.at(name);
+
+    if (!plugin.mPrepared.valid() ||
+        plugin.mPrepared.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+      return name;
+    }
+  }
+
+  return std::nullopt;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 void Application::deinitPlugin(std::string const& name) {
   auto plugin = mPlugins.find(name);
 
@@ -800,6 +892,13 @@ void Application::closePlugin(std::string const& name) {
   if (plugin != mPlugins.end()) {
     logger().info("Closing plugin '{}'.", plugin->first);
 
+    // The plugin may still be prepared on the thread pool.
+    if (plugin->second.mPrepared.valid()) {
+      plugin->second.mPrepared.wait();
+    }
+
+    mPluginsToInit.erase(name);
+
     auto* handle           = plugin->second.mHandle;
     auto  pluginDestructor = // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
         reinterpret_cast<void (*)(cs::core::PluginBase*)>(LIBFUNC(handle, "destroy"));
@@ -827,25 +926,24 @@ void Application::connectSlots() {
           auto lngLat = cs::utils::convert::toDegrees(polar.xy());
 
           if (!std::isnan(lngLat.x) && !std::isnan(lngLat.y) && !std::isnan(polar.z)) {
-            mGuiManager->getGui()->executeJavascript(
-                fmt::format("CosmoScout.state.pointerPosition = [{}, {}, {}];", lngLat.x, lngLat.y,
+            mGuiManager->getGui()->queueState("pointerPosition",
+                fmt::format("[{}, {}, {}]", lngLat.x, lngLat.y,
                     polar.z / mSettings->mGraphics.pHeightScale.get()));
             return;
           }
         }
-        mGuiManager->getGui()->executeJavascript("CosmoScout.state.pointerPosition = undefined;");
+        mGuiManager->getGui()->queueState("pointerPosition", "undefined");
       });
 
   // Update the time shown in the user interface when the simulation time changes.
   mTimeControl->pSimulationTime.connectAndTouch([this](double val) {
-    mGuiManager->getGui()->executeJavascript(
-        fmt::format("CosmoScout.state.simulationTime = new Date('{}');",
-            cs::utils::convert::time::toString(val)));
+    mGuiManager->getGui()->queueState("simulationTime",
+        fmt::format("new Date('{}')", cs::utils::convert::time::toString(val)));
   });
 
   // Update the simulation time speed shown in the user interface.
   mSettings->pTimeSpeed.connectAndTouch([this](float val) {
-    mGuiManager->getGui()->executeJavascript(fmt::format("CosmoScout.state.timeSpeed = {};", val));
+    mGuiManager->getGui()->queueState("timeSpeed", fmt::format("{}", val));
   });
 
   // Show notification when the center name of the celestial observer changes.
@@ -874,20 +972,19 @@ void Application::connectSlots() {
 
   // Set the observer position state.
   mSettings->mObserver.pPosition.connectAndTouch([this](glm::dvec3 const& p) {
-    mGuiManager->getGui()->executeJavascript(
-        fmt::format("CosmoScout.state.observerPosition = [{}, {}, {}];", p.x, p.y, p.z));
+    mGuiManager->getGui()->queueState(
+        "observerPosition", fmt::format("[{}, {}, {}]", p.x, p.y, p.z));
   });
 
   // Set the observer rotation state.
   mSettings->mObserver.pRotation.connectAndTouch([this](glm::dquat const& r) {
-    mGuiManager->getGui()->executeJavascript(
-        fmt::format("CosmoScout.state.observerRotation = [{}, {}, {}, {}];", r.x, r.y, r.z, r.w));
+    mGuiManager->getGui()->queueState(
+        "observerRotation", fmt::format("[{}, {}, {}, {}]", r.x, r.y, r.z, r.w));
   });
 
   // Show the current speed of the celestial observer in the user interface.
   mSolarSystem->pCurrentObserverSpeed.connect([this](float speed) {
-    mGuiManager->getGui()->executeJavascript(
-        fmt::format("CosmoScout.state.observerSpeed = {};", speed));
+    mGuiManager->getGui()->queueState("observerSpeed", fmt::format("{}", speed));
   });
 
   // Show log messages in the user interface.
@@ -8,10 +8,16 @@
 #ifndef CS_APPLICATION_HPP
 #define CS_APPLICATION_HPP
 
+#include "../cs-utils/FrameStats.hpp"
+
 #include <VistaKernel/VistaFrameLoop.h>
+#include <atomic>
+#include <chrono>
+#include <future>
 #include <limits>
 #include <map>
 #include <memory>
+#include <optional>
 #include <set>
 
 #ifdef __linux__
@@ -61,11 +67,12 @@ class Downloader;
 ///      - After a few seconds, the data download in a background thread is started. Until
 ///        everything is downloaded, the progress is shown on the loading screen.
 ///      - SolarSystem::init() is called once the data download has finished.
-///      - For each plugin:
-///        - Show plugin name on the loading screen and wait some frames to make sure that the text
-///          is updated.
+///      - For all plugins concurrently on the global ThreadPool:
 ///        - PluginBase::setAPI()
+///        - PluginBase::prepare()
+///      - Once per frame, for the next plugin whose prepare() has finished:
 ///        - PluginBase::init()
+///        - Show the name of the next plugin on the loading screen.
 ///      - When the last plugin finished loading, the loading screen is removed and the observer is
 ///        animated to its initial position in space.
 ///      - If all plugins are loaded:
@@ -84,8 +91,11 @@ class Downloader;
 ///      - Cleanup curl
 class Application : public VistaFrameLoop {
  public:
-  /// This does only inititlize curl.
-  explicit Application(std::shared_ptr<cs::core::Settings> settings);
+  /// This does only inititlize curl. If sequentialPlugins is set, the plugins are not prepared
+  /// concurrently at startup but one after another on the main thread right before their init().
+  /// This is only meant for comparing startup times.
+  explicit Application(
+      std::shared_ptr<cs::core::Settings> settings, bool sequentialPlugins = false);
   ~Application() override;
 
   /// Initializes the Application. Should only be called by ViSTA.
@@ -105,6 +115,13 @@ class Application : public VistaFrameLoop {
     COSMOSCOUT_LIBTYPE    mHandle;
     cs::core::PluginBase* mPlugin        = nullptr;
     bool                  mIsInitialized = false;
+
+    /// Used for measuring the time spent in the plugin's update() method.
+    cs::utils::FrameStats::RangeId mUpdateRange;
+
+    /// This becomes ready once PluginBase::prepare() has finished on the thread pool. It is not
+    /// valid if prepare() has not been started asynchronously.
+    std::future<void> mPrepared;
   };
 
   /// Called whenever the settings are (re-)loaded;
@@ -113,9 +130,17 @@ class Application : public VistaFrameLoop {
   /// Opens a plugin from a shared library. Only the create() method of the plugin is called.
   void openPlugin(std::string const& name);
 
-  /// Calls setAPI() and init() on the given plugin. openPlugin() has to be called before.
+  /// Calls setAPI() and starts prepare() of the given plugin on the global thread pool.
+  /// openPlugin() has to be called before.
+  void preparePlugin(std::string const& name);
+
+  /// Calls init() on the given plugin. If preparePlugin() has not been called before, setAPI() and
+  /// prepare() are called synchronously first. openPlugin() has to be called before.
   void initPlugin(std::string const& name);
 
+  /// Returns the name of a plugin from mPluginsToInit which has been prepared already.
+  std::optional<std::string> getNextPluginToInit() const;
+
   /// Calls deinit() on the given plugin. initPlugin() has to be called before.
   void deinitPlugin(std::string const& name);
 
@@ -183,6 +208,14 @@ class Application : public VistaFrameLoop {
   int  mStartPluginLoadingAtFrame = 0;
   int  mHideLoadingScreenAtFrame  = 0;
 
+  // Plugins which still have to be initialized at application startup. This is used to report the
+  // startup time and the time spent in the prepare() methods of all plugins.
+  bool                                  mSequentialPlugins = false;
+  std::set<std::string>                 mPluginsToInit;
+  std::chrono::steady_clock::time_point mStartupTime;
+  std::chrono::steady_clock::time_point mStartPluginLoadingTime;
+  std::atomic<int64_t>                  mPrepareMicroseconds{0};
+
   int mOnMessageConnection = -1;
 
   // Used to reset the observer to the last known working simulation time in case of missing SPICE
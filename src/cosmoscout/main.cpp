@@ -51,6 +51,7 @@ int main(int argc, char** argv) {
   bool        runTests       = false;
   bool        printHelp      = false;
   bool        printVistaHelp = false;
+  bool        sequential     = false;
 
   // First configure all possible command line options.
   cs::utils::CommandLine args("Welcome to CosmoScout VR! Here are the available options:");
@@ -58,6 +59,9 @@ int main(int argc, char** argv) {
       "JSON file containing settings (default: " + settingsFile + ")");
   args.addArgument({"-h", "--help"}, &printHelp, "Print this help.");
   args.addArgument({"-v", "--vistahelp"}, &printVistaHelp, "Print help for vista options.");
+  args.addArgument({"--sequential-plugins"}, &sequential,
+      "Prepare the plugins one after another on the main thread instead of concurrently. This is "
+      "useful for comparing startup times.");
 
 #ifndef DOCTEST_CONFIG_DISABLE
   args.addArgument({"-t", "--run-tests"}, &runTests, "Runs all unit tests.");
@@ -127,7 +131,7 @@ int main(int argc, char** argv) {
     pVistaSystem->SetIniSearchPaths({"../share/config/vista"});
 
     // The Application contains a lot of initialization code and the frame update.
-    Application app(settings);
+    Application app(settings, sequential);
     pVistaSystem->SetFrameLoop(&app, true);
 
     // Now run the program!
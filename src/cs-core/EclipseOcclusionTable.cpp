@@ -0,0 +1,135 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "EclipseOcclusionTable.hpp"
+
+#include <cmath>
+
+namespace cs::core {
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The penumbra cone of an occluder only depends on the Sun and the occluder. Hence, it is computed
+// once per occluder and then tested against all receivers.
+struct PenumbraCone {
+  PenumbraCone(EclipseOcclusionTable::Sphere const& sun, EclipseOcclusionTable::Sphere const& occ)
+      : mOccluder(occ.mPosition) {
+
+    // Convert to occluder-centric coordinates.
+    glm::dvec3 pSun = sun.mPosition - occ.mPosition;
+    mSunDistance    = glm::length(pSun);
+    mSunDirection   = pSun / mSunDistance;
+
+    // Compute distances to the tips of the penumbra cone.
+    mDistToApex = mSunDistance * occ.mRadius / (sun.mRadius + occ.mRadius);
+
+    // Direction from the penumbra cone tip to the occluder.
+    mToOccluder = -mSunDirection * mDistToApex;
+
+    // Apparent angular size of the occluder when seen from the penumbra cone tip.
+    mOccluderAngle = std::asin(occ.mRadius / mDistToApex);
+  }
+
+  bool contains(EclipseOcclusionTable::Sphere const& receiver) const {
+
+    // Convert to occluder-centric coordinates.
+    glm::dvec3 pRec = receiver.mPosition - mOccluder;
+    double     dRec = glm::length(pRec);
+
+    // Do not consider cases where the receiver is really far away.
+    if (dRec > 0.1 * mSunDistance) {
+      return false;
+    }
+
+    // Do not consider cases where the receiver is in front of the caster.
+    if (glm::dot(mSunDirection, pRec / dRec) > 0) {
+      return false;
+    }
+
+    // Direction from the penumbra cone tip to the receiver.
+    auto toReceiver = pRec + mToOccluder;
+
+    // Distance from the penumbra cone tip to the receiver.
+    double distToReceiver = glm::length(toReceiver);
+
+    // Apparent angular size of the receiver when seen from the penumbra cone tip.
+    double aRec = std::asin(receiver.mRadius / distToReceiver);
+
+    // Angle between the directions to the occluder and the receiver.
+    double delta = 2.0 * std::asin(0.5 * glm::length(toReceiver / distToReceiver -
+                                             mToOccluder / mDistToApex));
+
+    // If the sum of the apparent angular sizes is larger than the angle between the directions to
+    // the occluder and the receiver, the receiver is in the penumbra cone.
+    return mOccluderAngle + aRec > delta;
+  }
+
+  glm::dvec3 mOccluder;
+  glm::dvec3 mSunDirection;
+  glm::dvec3 mToOccluder;
+  double     mSunDistance;
+  double     mDistToApex;
+  double     mOccluderAngle;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool EclipseOcclusionTable::isInPenumbra(
+    Sphere const& sun, Sphere const& occluder, Sphere const& receiver) {
+  return PenumbraCone(sun, occluder).contains(receiver);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void EclipseOcclusionTable::update(
+    Sphere const& sun, std::vector<Sphere> const& occluders, std::vector<Sphere> const& receivers) {
+
+  std::vector<PenumbraCone> cones;
+  cones.reserve(occluders.size());
+
+  for (auto const& occluder : occluders) {
+    cones.emplace_back(sun, occluder);
+  }
+
+  mOffsets.clear();
+  mOccluders.clear();
+  mOffsets.reserve(receivers.size() + 1);
+  mOffsets.push_back(0);
+
+  for (auto const& receiver : receivers) {
+    for (size_t i(0); i < cones.size(); ++i) {
+      if (cones[i].contains(receiver)) {
+        mOccluders.push_back(static_cast<uint32_t>(i));
+      }
+    }
+
+    mOffsets.push_back(static_cast<uint32_t>(mOccluders.size()));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t EclipseOcclusionTable::getReceiverCount() const {
+  return mOffsets.empty() ? 0 : mOffsets.size() - 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+uint32_t const* EclipseOcclusionTable::getOccluders(size_t receiver, size_t& count) const {
+  count = mOffsets[receiver + 1] - mOffsets[receiver];
+  return mOccluders.data() + mOffsets[receiver];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace cs::core
@@ -0,0 +1,60 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#ifndef CS_CORE_ECLIPSE_OCCLUSION_TABLE_HPP
+#define CS_CORE_ECLIPSE_OCCLUSION_TABLE_HPP
+
+#include "cs_core_export.hpp"
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace cs::core {
+
+/// This table stores which eclipse shadow casters potentially cast a shadow onto which shadow
+/// receivers. The SolarSystem rebuilds it once per frame after all celestial objects have been
+/// updated, so that each EclipseShadowReceiver can look up its casters in constant time instead of
+/// testing all casters again. All objects are considered to be spheres.
+class CS_CORE_EXPORT EclipseOcclusionTable {
+ public:
+  /// A sphere in observer-relative coordinates. The position and the radius have to be given in the
+  /// same unit, usually this is meters.
+  struct Sphere {
+    glm::dvec3 mPosition{0.0};
+    double     mRadius = 0.0;
+  };
+
+  /// Returns true if the receiver is potentially inside the penumbra cone which the occluder casts
+  /// when illuminated by the Sun. Receivers which are in front of the occluder or which are farther
+  /// away from the occluder than a tenth of the distance to the Sun are ignored.
+  static bool isInPenumbra(Sphere const& sun, Sphere const& occluder, Sphere const& receiver);
+
+  /// Recomputes the table for the given Sun, occluders, and receivers. Afterwards, the casters of
+  /// each receiver can be retrieved with getOccluders() using the index of the receiver in the
+  /// given vector. The memory of the table is reused from the previous call.
+  void update(Sphere const& sun, std::vector<Sphere> const& occluders,
+      std::vector<Sphere> const& receivers);
+
+  /// Returns the number of receivers of the last update() call.
+  size_t getReceiverCount() const;
+
+  /// Returns the indices of all occluders which potentially cast a shadow onto the receiver with
+  /// the given index. The indices are sorted in ascending order. The returned pointer is only valid
+  /// until the next call to update().
+  uint32_t const* getOccluders(size_t receiver, size_t& count) const;
+
+ private:
+  // The occluder indices of all receivers are stored in one contiguous vector. The indices of
+  // receiver i are stored in the range [mOffsets[i], mOffsets[i + 1]).
+  std::vector<uint32_t> mOffsets;
+  std::vector<uint32_t> mOccluders;
+};
+
+} // namespace cs::core
+
+#endif // CS_CORE_ECLIPSE_OCCLUSION_TABLE_HPP
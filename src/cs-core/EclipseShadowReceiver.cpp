@@ -76,17 +76,20 @@ void EclipseShadowReceiver::update(scene::CelestialObject const& shadowReceiver)
     return;
   }
 
-  // Acquire a list of all potentially relevant eclipse shadow maps.
-  mShadowMaps = mSolarSystem->getEclipseShadowMaps(shadowReceiver, mAllowSelfShadowing);
+  // Acquire a list of all potentially relevant eclipse shadow maps. This is a lookup in the table
+  // which the SolarSystem computes once per frame.
+  auto occluders = mSolarSystem->getEclipseOccluders(shadowReceiver, mAllowSelfShadowing);
 
   // For each shadow-casting body, we store the observer-relative position and the observer-relative
   // radius. For now, all occluders are considered to be spheres.
-  for (size_t i(0); i < mShadowMaps.size() && i < MAX_BODIES; ++i) {
-    auto object = mSolarSystem->getObject(mShadowMaps[i]->mOccluder);
-    auto pos    = object->getObserverRelativePosition();
+  mShadowMaps.clear();
 
-    mOccluders[i] = glm::vec4(
-        pos, object->getRadii()[0] * object->getScale() / mSolarSystem->getObserver().getScale());
+  for (size_t i(0); i < occluders.size(); ++i) {
+    mShadowMaps.push_back(occluders[i].mShadowMap);
+
+    if (i < MAX_BODIES) {
+      mOccluders[i] = glm::vec4(occluders[i].mSphere);
+    }
   }
 }
 
@@ -0,0 +1,117 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "ObjectHandle.hpp"
+
+namespace cs::core {
+
+namespace {
+
+// Default-constructed handles have no slot. They return references to these instead.
+std::string const                                   cEmptyName;
+std::shared_ptr<const scene::CelestialObject> const cNoObject;
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ObjectHandle::ObjectHandle(std::shared_ptr<Slot const> slot)
+    : mSlot(std::move(slot)) {
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::string const& ObjectHandle::getName() const {
+  return mSlot ? mSlot->mName : cEmptyName;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::shared_ptr<const scene::CelestialObject> const& ObjectHandle::get() const {
+  return mSlot ? mSlot->mObject : cNoObject;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+scene::CelestialObject const* ObjectHandle::operator->() const {
+  return get().get();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+scene::CelestialObject const& ObjectHandle::operator*() const {
+  return *get();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ObjectHandle::operator bool() const {
+  return mSlot && mSlot->mObject;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool ObjectHandle::operator==(ObjectHandle const& other) const {
+  return mSlot == other.mSlot;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool ObjectHandle::operator!=(ObjectHandle const& other) const {
+  return mSlot != other.mSlot;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ObjectHandleRegistry::ObjectHandleRegistry(ObjectMap const& objects)
+    : mObjects(objects) {
+
+  // Handles only need to be updated if an object is added or removed. Objects in the map are
+  // immutable, so there is nothing else to observe.
+  mOnAddConnection = mObjects.onAdd().connect([this](auto const& name, auto const& object) {
+    auto slot = mSlots.find(name);
+    if (slot != mSlots.end()) {
+      slot->second->mObject = object;
+    }
+  });
+
+  mOnRemoveConnection = mObjects.onRemove().connect([this](auto const& name, auto const& object) {
+    auto slot = mSlots.find(name);
+    if (slot != mSlots.end() && slot->second->mObject == object) {
+      slot->second->mObject.reset();
+    }
+  });
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ObjectHandleRegistry::~ObjectHandleRegistry() {
+  mObjects.onAdd().disconnect(mOnAddConnection);
+  mObjects.onRemove().disconnect(mOnRemoveConnection);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ObjectHandle ObjectHandleRegistry::getHandle(std::string const& name) {
+  auto& slot = mSlots[name];
+
+  if (!slot) {
+    slot        = std::make_shared<ObjectHandle::Slot>();
+    slot->mName = name;
+
+    auto object = mObjects.find(name);
+    if (object != mObjects.end()) {
+      slot->mObject = object->second;
+    }
+  }
+
+  return ObjectHandle(slot);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace cs::core
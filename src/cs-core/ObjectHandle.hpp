@@ -0,0 +1,104 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#ifndef CS_CORE_OBJECT_HANDLE_HPP
+#define CS_CORE_OBJECT_HANDLE_HPP
+
+#include "cs_core_export.hpp"
+
+#include "../cs-scene/CelestialObject.hpp"
+#include "../cs-utils/ObservableMap.hpp"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace cs::core {
+
+/// An ObjectHandle refers to a CelestialObject by its name. In contrast to
+/// SolarSystem::getObject(), which performs a map look-up each time it is called, the name of an
+/// ObjectHandle is resolved only once when the handle is created with
+/// SolarSystem::getObjectHandle(). Dereferencing the handle afterwards is only a pointer access.
+/// Therefore, plugins should store handles to the objects they need each frame instead of their
+/// names.
+/// Handles are updated automatically whenever the objects in the settings change: If the object is
+/// removed, the handle will return a nullptr; if an object with the same name is added later, the
+/// handle will refer to this new object. Handles can be copied cheaply; all copies share the same
+/// state. They are not thread-safe, they should only be used on the main thread.
+class CS_CORE_EXPORT ObjectHandle {
+ public:
+  /// Creates an empty handle. It will always return a nullptr.
+  ObjectHandle() = default;
+
+  /// Returns the name of the referenced object. This is empty for default-constructed handles.
+  std::string const& getName() const;
+
+  /// Returns the referenced object or a nullptr if currently no object with the name of this handle
+  /// exists. The returned reference stays valid until an object with the name of this handle is
+  /// added or removed, so usually it should not be stored.
+  std::shared_ptr<const scene::CelestialObject> const& get() const;
+
+  /// Convenience accessors for the referenced object. Make sure to check whether the handle refers
+  /// to an existing object before using them.
+  scene::CelestialObject const* operator->() const;
+  scene::CelestialObject const& operator*() const;
+
+  /// Returns true if the handle currently refers to an existing object.
+  explicit operator bool() const;
+
+  /// Two handles are equal if they were created for the same name by the same registry.
+  bool operator==(ObjectHandle const& other) const;
+  bool operator!=(ObjectHandle const& other) const;
+
+ private:
+  friend class ObjectHandleRegistry;
+
+  // All handles for the same name share one slot. It is updated by the ObjectHandleRegistry.
+  struct Slot {
+    std::string                                   mName;
+    std::shared_ptr<const scene::CelestialObject> mObject;
+  };
+
+  explicit ObjectHandle(std::shared_ptr<Slot const> slot);
+
+  std::shared_ptr<Slot const> mSlot;
+};
+
+/// The ObjectHandleRegistry creates ObjectHandles for a map of CelestialObjects and keeps them
+/// up-to-date when objects are added to or removed from the map. The SolarSystem owns one registry
+/// for the objects of the settings; usually you will not have to create one yourself.
+class CS_CORE_EXPORT ObjectHandleRegistry {
+ public:
+  using ObjectMap =
+      utils::ObservableMap<std::string, std::shared_ptr<const scene::CelestialObject>>;
+
+  /// The given map has to outlive the registry.
+  explicit ObjectHandleRegistry(ObjectMap const& objects);
+
+  ObjectHandleRegistry(ObjectHandleRegistry const& other) = delete;
+  ObjectHandleRegistry(ObjectHandleRegistry&& other)      = delete;
+
+  ObjectHandleRegistry& operator=(ObjectHandleRegistry const& other) = delete;
+  ObjectHandleRegistry& operator=(ObjectHandleRegistry&& other)      = delete;
+
+  ~ObjectHandleRegistry();
+
+  /// Returns a handle for the object with the given name. This is also possible if no such object
+  /// exists yet; the handle will refer to the object once it is added to the map.
+  ObjectHandle getHandle(std::string const& name);
+
+ private:
+  ObjectMap const&                                                     mObjects;
+  std::unordered_map<std::string, std::shared_ptr<ObjectHandle::Slot>> mSlots;
+
+  int mOnAddConnection    = -1;
+  int mOnRemoveConnection = -1;
+};
+
+} // namespace cs::core
+
+#endif // CS_CORE_OBJECT_HANDLE_HPP
@@ -11,6 +11,7 @@
 #include "cs_core_export.hpp"
 
 #include <memory>
+#include <nlohmann/json.hpp>
 
 #ifdef __linux__
 #define EXPORT_FN extern "C" __attribute__((visibility("default")))
@@ -52,8 +53,19 @@ class CS_CORE_EXPORT PluginBase {
       VistaSceneGraph* sceneGraph, std::shared_ptr<GraphicsEngine> graphicsEngine,
       std::shared_ptr<TimeControl> timeControl);
 
-  /// Override this function to initialize your plugin. It will be called directly after
-  /// application startup and before the update loop starts.
+  /// Override this function to load and decode the resources of your plugin, for example
+  /// catalogs, images or models. At application startup, this is called for all plugins
+  /// concurrently on worker threads of the global ThreadPool, after setAPI() has been called. Hence
+  /// it must not access OpenGL, the scene graph, the user interface or mAllSettings, as the main
+  /// thread may modify them concurrently. Instead, the settings of your plugin are passed as a copy
+  /// which has been made on the main thread. Store the results in members of your plugin and use
+  /// them in init(), which is called afterwards on the main thread. If this throws, init() is not
+  /// called.
+  virtual void prepare(nlohmann::json const& /*pluginSettings*/){};
+
+  /// Override this function to initialize your plugin. It will be called on the main thread after
+  /// prepare() has finished and before the update loop starts. Creating OpenGL objects and
+  /// registering user interface elements should happen here.
   virtual void init(){};
 
   /// Override this function for cleaning up after yourself, when the plugin terminates. We don't
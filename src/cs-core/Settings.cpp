@@ -246,11 +246,15 @@ void to_json(nlohmann::json& j, Settings::Bookmark const& o) {
 void from_json(nlohmann::json const& j, Settings::DownloadData& o) {
   Settings::deserialize(j, "url", o.mUrl);
   Settings::deserialize(j, "file", o.mFile);
+  Settings::deserialize(j, "sha256", o.mSHA256);
+  Settings::deserialize(j, "refresh", o.mRefresh);
 }
 
 void to_json(nlohmann::json& j, Settings::DownloadData const& o) {
   Settings::serialize(j, "url", o.mUrl);
   Settings::serialize(j, "file", o.mFile);
+  Settings::serialize(j, "sha256", o.mSHA256);
+  Settings::serialize(j, "refresh", o.mRefresh);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
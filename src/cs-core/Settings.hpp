@@ -310,6 +310,13 @@ class CS_CORE_EXPORT Settings {
   struct DownloadData {
     std::string mUrl;
     std::string mFile;
+
+    /// If given, the SHA-256 hash of the downloaded file is compared to this hexadecimal string.
+    /// If they do not match, the download is discarded.
+    std::optional<std::string> mSHA256;
+
+    /// If set to true, an existing file is downloaded again if it has changed on the server.
+    std::optional<bool> mRefresh;
   };
 
   std::vector<DownloadData> mDownloadData;
@@ -38,7 +38,8 @@ SolarSystem::SolarSystem(std::shared_ptr<Settings> settings,
     : mSettings(std::move(settings))
     , mGraphicsEngine(std::move(graphicsEngine))
     , mTimeControl(std::move(timeControl))
-    , mSun(getObject("Sun")) {
+    , mSun(getObject("Sun"))
+    , mObjectHandles(mSettings->mObjects) {
 
   // Make sure to update our pointer to the Sun if the settings are reloaded.
   mSettings->mObjects.onAdd().connect([this](auto const& name, auto const& object) {
@@ -47,10 +48,16 @@ SolarSystem::SolarSystem(std::shared_ptr<Settings> settings,
     }
   });
 
-  mSettings->mObjects.onRemove().connect([this](auto const& name, auto const& /*object*/) {
+  mSettings->mObjects.onRemove().connect([this](auto const& name, auto const& object) {
     if (name == "Sun") {
       mSun.reset();
     }
+
+    mUpdateRanges.erase(object.get());
+
+    // The eclipse occlusion table is keyed by object address. It will be recomputed in the next
+    // call to update().
+    mEclipseReceiverIndices.clear();
   });
 
   // Tell the user what's going on.
@@ -81,6 +88,12 @@ std::shared_ptr<const scene::CelestialObject> SolarSystem::getObject(
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+ObjectHandle SolarSystem::getObjectHandle(std::string const& name) {
+  return mObjectHandles.getHandle(name);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 std::shared_ptr<const scene::CelestialObject> SolarSystem::getObjectByCenterName(
     std::string const& center) const {
   for (auto const& [name, object] : mSettings->mObjects) {
@@ -129,71 +142,55 @@ double SolarSystem::getSunLuminance() const {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-std::vector<std::shared_ptr<graphics::EclipseShadowMap>> SolarSystem::getEclipseShadowMaps(
+std::vector<SolarSystem::EclipseOccluder> SolarSystem::getEclipseOccluders(
     scene::CelestialObject const& receiver, bool allowSelfShadowing) const {
 
-  std::vector<std::shared_ptr<graphics::EclipseShadowMap>> result;
+  std::vector<EclipseOccluder> result;
 
-  // Loop through all registered eclipse shadow casters and test if they are casting a shadow onto
-  // the given receiver. All involved objects are considered to be spheres.
-  for (auto const& shadowMap : mGraphicsEngine->getEclipseShadowMaps()) {
-    auto occluder = getObject(shadowMap->mOccluder);
+  auto addOccluder = [&](size_t index) {
+    auto const& occluder = mEclipseOccluders[index];
 
     // Avoid self-shadowing.
-    if (allowSelfShadowing || receiver.getCenterName() != occluder->getCenterName()) {
-
-      // Get observer-centric positions.
-      auto pSun = mSun->getObserverRelativePosition() * mObserver.getScale();
-      auto pRec = receiver.getObserverRelativePosition() * mObserver.getScale();
-      auto pOcc = occluder->getObserverRelativePosition() * mObserver.getScale();
-
-      // Convert to occluder-centric coordinates.
-      pSun = pSun - pOcc;
-      pRec = pRec - pOcc;
+    if (allowSelfShadowing || receiver.getCenterName() != occluder.mCenterName) {
+      result.push_back(occluder.mOccluder);
+    }
+  };
 
-      double dSun = glm::length(pSun);
-      double dRec = glm::length(pRec);
+  // Usually, the casters of the receiver have already been computed in update().
+  auto row = mEclipseReceiverIndices.find(&receiver);
+  if (row != mEclipseReceiverIndices.end()) {
+    size_t count    = 0;
+    auto   occluder = mEclipseOcclusionTable.getOccluders(row->second, count);
 
-      // Do not consider cases where the receiver is really far away.
-      if (dRec > 0.1 * dSun) {
-        continue;
-      }
+    for (size_t i(0); i < count; ++i) {
+      addOccluder(occluder[i]);
+    }
 
-      // Do not consider cases where the receiver is in front of the caster.
-      if (glm::dot(pSun / dSun, pRec / dRec) > 0) {
-        continue;
-      }
+    return result;
+  }
 
-      // Get the radii of all involved objects.
-      double rOcc = occluder->getRadii()[0];
-      double rRec = receiver.getRadii()[0];
-      double rSun = mSun->getRadii()[0];
+  // If the receiver is not part of the table, we test it against all casters.
+  auto sphere = getEclipseReceiverSphere(receiver);
 
-      // Compute distances to the tips of the penumbra cone.
-      double distToApex = dSun * rOcc / (rSun + rOcc);
+  for (size_t i(0); i < mEclipseOccluders.size(); ++i) {
+    if (EclipseOcclusionTable::isInPenumbra(
+            mEclipseSunSphere, mEclipseOccluderSpheres[i], sphere)) {
+      addOccluder(i);
+    }
+  }
 
-      // Directions from the penumbra cone tip to the occluder and the receiver.
-      auto toOccluder = -pSun * distToApex / dSun;
-      auto toReceiver = pRec + toOccluder;
+  return result;
+}
 
-      // Distance from the penumbra cone tip to the receiver.
-      double distToReceiver = glm::length(toReceiver);
+////////////////////////////////////////////////////////////////////////////////////////////////////
 
-      // Apparent angular sizes of the occluder and the receiver when seen from the penumbra cone
-      // tip.
-      double aOcc = std::asin(rOcc / distToApex);
-      double aRec = std::asin(rRec / distToReceiver);
+std::vector<std::shared_ptr<graphics::EclipseShadowMap>> SolarSystem::getEclipseShadowMaps(
+    scene::CelestialObject const& receiver, bool allowSelfShadowing) const {
 
-      // Angle between the directions to the occluder and the receiver.
-      double delta =
-          2.0 * std::asin(0.5 * glm::length(toReceiver / distToReceiver - toOccluder / distToApex));
+  std::vector<std::shared_ptr<graphics::EclipseShadowMap>> result;
 
-      // If the sum of the apparent angular sizes is larger than the angle between the directions to
-      // the occluder and the receiver, the receiver is in the penumbra cone.
-      if (aOcc + aRec > delta) {
-        result.push_back(shadowMap);
-      }
-    }
+  for (auto const& occluder : getEclipseOccluders(receiver, allowSelfShadowing)) {
+    result.push_back(occluder.mShadowMap);
   }
 
   return result;
@@ -246,9 +243,16 @@ void SolarSystem::update() {
 
   // First, update all celestial object positions.
   for (auto const& [name, object] : mSettings->mObjects) {
-    utils::FrameStats::ScopedTimer timer(
-        "Update " + object->getCenterName() + " / " + object->getFrameName(),
-        utils::FrameStats::TimerMode::eCPU);
+    auto& range = mUpdateRanges[object.get()];
+    if (!range.mRange.isValid() || range.mCenterName != object->getCenterName() ||
+        range.mFrameName != object->getFrameName()) {
+      range.mCenterName = object->getCenterName();
+      range.mFrameName  = object->getFrameName();
+      range.mRange      = utils::FrameStats::RangeId(
+          "Update " + range.mCenterName + " / " + range.mFrameName);
+    }
+
+    utils::FrameStats::ScopedTimer timer(range.mRange, utils::FrameStats::TimerMode::eCPU);
     object->update(simulationTime, mObserver);
   }
 
@@ -301,6 +305,60 @@ void SolarSystem::update() {
   mSettings->mObserver.pFrame    = mObserver.getFrameName();
   mSettings->mObserver.pPosition = mObserver.getPosition();
   mSettings->mObserver.pRotation = mObserver.getRotation();
+
+  // Finally, compute which eclipse shadow casters may cast a shadow onto which objects.
+  updateEclipseOcclusion();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+EclipseOcclusionTable::Sphere SolarSystem::getEclipseReceiverSphere(
+    scene::CelestialObject const& receiver) const {
+  return {receiver.getObserverRelativePosition() * mObserver.getScale(), receiver.getRadii()[0]};
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void SolarSystem::updateEclipseOcclusion() {
+  mEclipseOccluders.clear();
+  mEclipseOccluderSpheres.clear();
+  mEclipseReceiverSpheres.clear();
+  mEclipseReceiverIndices.clear();
+
+  if (!mSun) {
+    mEclipseOcclusionTable.update(mEclipseSunSphere, {}, {});
+    return;
+  }
+
+  // The table is computed in observer-centric coordinates in meters.
+  mEclipseSunSphere = {
+      mSun->getObserverRelativePosition() * mObserver.getScale(), mSun->getRadii()[0]};
+
+  // First, resolve the occluder of each eclipse shadow map. This requires a string lookup, so we
+  // do this only once per frame.
+  for (auto const& shadowMap : mGraphicsEngine->getEclipseShadowMaps()) {
+    auto occluder = getObject(shadowMap->mOccluder);
+
+    if (!occluder) {
+      continue;
+    }
+
+    auto   pos    = occluder->getObserverRelativePosition();
+    double radius = occluder->getRadii()[0] * occluder->getScale() / mObserver.getScale();
+
+    mEclipseOccluders.push_back(
+        {{shadowMap, glm::dvec4(pos, radius)}, occluder->getCenterName()});
+    mEclipseOccluderSpheres.push_back({pos * mObserver.getScale(), occluder->getRadii()[0]});
+  }
+
+  // Then test all celestial objects against all occluders.
+  for (auto const& [name, object] : mSettings->mObjects) {
+    mEclipseReceiverIndices[object.get()] = mEclipseReceiverSpheres.size();
+    mEclipseReceiverSpheres.push_back(getEclipseReceiverSphere(*object));
+  }
+
+  mEclipseOcclusionTable.update(
+      mEclipseSunSphere, mEclipseOccluderSpheres, mEclipseReceiverSpheres);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -10,12 +10,17 @@
 
 #include "cs_core_export.hpp"
 
+#include "EclipseOcclusionTable.hpp"
+#include "ObjectHandle.hpp"
+
 #include "../cs-scene/CelestialObject.hpp"
 #include "../cs-scene/CelestialObserver.hpp"
+#include "../cs-utils/FrameStats.hpp"
 #include "../cs-utils/Property.hpp"
 
 #include <chrono>
 #include <map>
+#include <unordered_map>
 #include <vector>
 
 namespace cs::graphics {
@@ -97,6 +102,12 @@ class CS_CORE_EXPORT SolarSystem {
   /// If it does not exist, a nullptr is returned and an error message is logged.
   std::shared_ptr<const scene::CelestialObject> getObject(std::string const& name) const;
 
+  /// Returns a handle for the object with the given name. Resolving the handle is much cheaper than
+  /// calling getObject() each frame, so plugins should use this for all objects they access
+  /// regularly. The handle will return a nullptr as long as no such object exists. See
+  /// ObjectHandle for details.
+  ObjectHandle getObjectHandle(std::string const& name);
+
   /// This returns a celestial object with the given center name. If none of the configured objects
   /// has this center name, a nullptr is returned. If multiple objects with the same center name are
   /// defined, one of the is chosen.
@@ -119,9 +130,22 @@ class CS_CORE_EXPORT SolarSystem {
 
   // Eclipse Shadow API ----------------------------------------------------------------------------
 
+  /// An eclipse shadow caster together with its observer-relative position (xyz) and radius (w) in
+  /// scene units. For now, all occluders are considered to be spheres.
+  struct EclipseOccluder {
+    std::shared_ptr<graphics::EclipseShadowMap> mShadowMap;
+    glm::dvec4                                  mSphere{0.0};
+  };
+
   /// Returns all eclipse shadow casters which may cast a shadow on the given object. If
   /// allowSelfShadowing is set to true, this will also return the eclipse shadow map of the given
-  /// body (if there is one).
+  /// body (if there is one). The casters of all celestial objects are computed once per frame in
+  /// update(), so this is only a table lookup. For objects which are not registered in the
+  /// settings, the casters are computed on the fly.
+  std::vector<EclipseOccluder> getEclipseOccluders(
+      scene::CelestialObject const& receiver, bool allowSelfShadowing) const;
+
+  /// Same as above, but only returns the shadow maps of the casters.
   std::vector<std::shared_ptr<graphics::EclipseShadowMap>> getEclipseShadowMaps(
       scene::CelestialObject const& receiver, bool allowSelfShadowing) const;
 
@@ -214,6 +238,7 @@ class CS_CORE_EXPORT SolarSystem {
   std::shared_ptr<TimeControl>                  mTimeControl;
   scene::CelestialObserver                      mObserver;
   std::shared_ptr<const scene::CelestialObject> mSun;
+  ObjectHandleRegistry                          mObjectHandles;
 
   bool mIsInitialized              = false;
   bool mSpiceFrameChangedLastFrame = false;
@@ -221,6 +246,42 @@ class CS_CORE_EXPORT SolarSystem {
   // These are used for measuring the observer speed.
   glm::dvec3                                     mLastPosition = glm::dvec3(0.0);
   std::chrono::high_resolution_clock::time_point mLastTime;
+
+  // The timer range names for updating the celestial objects are interned once per object. They are
+  // only recreated if the center or frame name of an object changes. They are keyed by the address
+  // of the object, so that no string has to be hashed each frame, and they are removed together
+  // with the objects.
+  struct UpdateRange {
+    std::string                    mCenterName;
+    std::string                    mFrameName;
+    utils::FrameStats::RangeId     mRange;
+  };
+
+  std::unordered_map<scene::CelestialObject const*, UpdateRange> mUpdateRanges;
+
+  // Recomputes the eclipse occlusion table for all celestial objects. This is called at the end of
+  // update(), once all objects have their positions for the current frame.
+  void updateEclipseOcclusion();
+
+  // Returns the sphere of the given receiver in the units used by the occlusion table.
+  EclipseOcclusionTable::Sphere getEclipseReceiverSphere(
+      scene::CelestialObject const& receiver) const;
+
+  // All registered eclipse shadow casters of the current frame. The center name is used for
+  // detecting self-shadowing.
+  struct EclipseOccluderInfo {
+    EclipseOccluder mOccluder;
+    std::string     mCenterName;
+  };
+
+  std::vector<EclipseOccluderInfo>           mEclipseOccluders;
+  std::vector<EclipseOcclusionTable::Sphere> mEclipseOccluderSpheres;
+  std::vector<EclipseOcclusionTable::Sphere> mEclipseReceiverSpheres;
+  EclipseOcclusionTable::Sphere              mEclipseSunSphere;
+  EclipseOcclusionTable                      mEclipseOcclusionTable;
+
+  // Maps each celestial object to its row in mEclipseOcclusionTable.
+  std::unordered_map<scene::CelestialObject const*, size_t> mEclipseReceiverIndices;
 };
 
 } // namespace cs::core
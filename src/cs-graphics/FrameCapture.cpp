@@ -0,0 +1,332 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "FrameCapture.hpp"
+
+#include "logger.hpp"
+
+#include <VistaOGLExt/VistaTexture.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <glm/gtc/type_ptr.hpp>
+#include <limits>
+#include <sstream>
+#include <stb_image_write.h>
+#include <tiffio.h>
+#include <tiffio.hxx>
+
+namespace cs::graphics {
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Appends void* data to a std::vector<std::byte> (which is given through a void* as well). So this
+// is pretty unsafe, but I think it's the only way to make stb_image write to a
+// std::vector<std::byte>.
+void stbWriteToVector(void* context, void* data, int len) {
+  auto* vector   = static_cast<std::vector<std::byte>*>(context);
+  auto* charData = static_cast<std::byte*>(data);
+  // NOLINTNEXTLINE (cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  vector->insert(vector->end(), charData, charData + len);
+}
+
+// Encodes the pixel data in "in" to a in-memory tiff in "out".
+template <typename T>
+void tiffWriteToVector(std::vector<std::byte>& out, std::vector<T>& in, uint32_t width,
+    uint32_t height, uint32_t samples, uint32_t bits) {
+
+  std::ostringstream oStream;
+  TIFF*              tiff = TIFFStreamOpen("MemTIFF", &oStream);
+
+  TIFFSetField(tiff, TIFFTAG_IMAGEWIDTH, width);
+  TIFFSetField(tiff, TIFFTAG_IMAGELENGTH, height);
+  TIFFSetField(tiff, TIFFTAG_SAMPLESPERPIXEL, samples);
+  TIFFSetField(tiff, TIFFTAG_BITSPERSAMPLE, bits);
+  TIFFSetField(tiff, TIFFTAG_ORIENTATION, ORIENTATION_TOPLEFT);
+  TIFFSetField(tiff, TIFFTAG_ROWSPERSTRIP, 16);
+  TIFFSetField(tiff, TIFFTAG_COMPRESSION, COMPRESSION_NONE);
+  TIFFSetField(tiff, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+  TIFFSetField(tiff, TIFFTAG_SAMPLEFORMAT, SAMPLEFORMAT_IEEEFP);
+
+  if (samples == 3) {
+    TIFFSetField(tiff, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_RGB);
+  } else {
+    TIFFSetField(tiff, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_MINISBLACK);
+  }
+
+  for (uint32_t i(0); i < height; ++i) {
+    TIFFWriteScanline(tiff, &in.at((height - i - 1) * width * samples), i);
+  }
+
+  TIFFClose(tiff);
+
+  // Convert the stringstream to a std::vector<std::byte>.
+  std::string s = oStream.str();
+  out.reserve(s.size());
+
+  std::transform(s.begin(), s.end(), std::back_inserter(out),
+      [](char& c) { return static_cast<std::byte>(c); });
+}
+
+// OpenGL returns the rows from bottom to top, png and jpeg expect them from top to bottom. We do
+// not use stbi_flip_vertically_on_write() as this is a global state which is not thread-safe.
+void flipRows(std::vector<std::byte>& data, size_t rowSize) {
+  size_t rows = data.size() / rowSize;
+  for (size_t i(0); i < rows / 2; ++i) {
+    std::swap_ranges(data.begin() + i * rowSize, data.begin() + (i + 1) * rowSize,
+        data.end() - (i + 1) * rowSize);
+  }
+}
+
+// Converts the raw pixel data read from the pixel buffer object to the requested format. This is
+// executed on a worker thread.
+std::vector<std::byte> encode(std::vector<std::byte>&& pixels, int32_t width, int32_t height,
+    glm::mat4 const& inverseProjection, FrameCapture::Request const& request) {
+
+  using Format = FrameCapture::Format;
+
+  std::vector<std::byte> result;
+
+  if (request.mDepth) {
+    std::vector<float> depth(static_cast<size_t>(width) * height);
+    std::memcpy(depth.data(), pixels.data(), depth.size() * sizeof(float));
+
+    if (request.mFormat == Format::eTIFF || request.mFormat == Format::eRaw) {
+
+      // If a tiff image is requested, we convert the depth buffer to meters.
+      glm::vec2 pixel(1.F / width, 1.F / height);
+
+      for (size_t i(0); i < depth.size(); ++i) {
+        auto coords = glm::vec2(i % width, i / width) * pixel + 0.5F * pixel;
+        auto pos    = inverseProjection * glm::vec4(2.F * coords - 1.F, 2.F * depth[i] - 1.F, 1.F);
+
+        float dist = static_cast<float>(glm::length(glm::vec3(pos) / pos.w) * request.mSceneScale);
+        depth[i]   = std::isinf(dist) ? std::numeric_limits<float>::max() : dist;
+      }
+
+      if (request.mFormat == Format::eTIFF) {
+        tiffWriteToVector(result, depth, width, height, 1, 32);
+      } else {
+        result.resize(depth.size() * sizeof(float));
+        std::memcpy(result.data(), depth.data(), result.size());
+      }
+
+    } else {
+      // Capture format is png or jpeg, let's convert the depth to 8-bit.
+      std::vector<std::byte> depthByte(depth.size());
+      for (size_t i(0); i < depth.size(); ++i) {
+        // The funny cast is required for MSVC 14.1 which does not like casting floating point
+        // numbers to std::byte.
+        depthByte[i] = static_cast<std::byte>(static_cast<uint8_t>(depth[i] * 255.0));
+      }
+
+      flipRows(depthByte, width);
+
+      if (request.mFormat == Format::ePNG) {
+        stbi_write_png_to_func(
+            &stbWriteToVector, &result, width, height, 1, depthByte.data(), width);
+      } else {
+        stbi_write_jpg_to_func(&stbWriteToVector, &result, width, height, 1, depthByte.data(), 80);
+      }
+    }
+
+    return result;
+  }
+
+  // Raw color data is returned as it is.
+  if (request.mFormat == Format::eRaw) {
+    return std::move(pixels);
+  }
+
+  if (request.mFormat == Format::eTIFF) {
+    tiffWriteToVector(result, pixels, width, height, 3, 8);
+    return result;
+  }
+
+  flipRows(pixels, width * 3);
+
+  if (request.mFormat == Format::ePNG) {
+    stbi_write_png_to_func(&stbWriteToVector, &result, width, height, 3, pixels.data(), width * 3);
+  } else {
+    stbi_write_jpg_to_func(&stbWriteToVector, &result, width, height, 3, pixels.data(), 80);
+  }
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::optional<FrameCapture::Format> FrameCapture::parseFormat(std::string const& name) {
+  if (name == "png") {
+    return Format::ePNG;
+  }
+  if (name == "jpeg") {
+    return Format::eJPEG;
+  }
+  if (name == "tiff") {
+    return Format::eTIFF;
+  }
+  if (name == "raw") {
+    return Format::eRaw;
+  }
+  return std::nullopt;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+FrameCapture::~FrameCapture() {
+  // Reads which have not been handed to a worker yet are simply dropped. The buffers must not be
+  // deleted while the workers are still copying data out of them.
+  mTasks.wait();
+
+  for (auto& slot : mSlots) {
+    if (slot.mFence) {
+      glDeleteSync(slot.mFence);
+    }
+
+    if (slot.mBuffer) {
+      glDeleteBuffers(1, &slot.mBuffer);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool FrameCapture::canRead() const {
+  for (auto const& slot : mSlots) {
+    if (!slot.mBusy.load(std::memory_order_acquire)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool FrameCapture::read(int32_t width, int32_t height, Request request) {
+  auto slot = std::find_if(mSlots.begin(), mSlots.end(),
+      [](Slot const& s) { return !s.mBusy.load(std::memory_order_acquire); });
+
+  if (slot == mSlots.end()) {
+    return false;
+  }
+
+  // Depth values and raw colors are read as floats, everything else as 8-bit RGB.
+  size_t bytes = static_cast<size_t>(width) * height;
+  if (request.mDepth) {
+    bytes *= sizeof(float);
+  } else if (request.mFormat == Format::eRaw) {
+    bytes *= 3 * sizeof(float);
+  } else {
+    bytes *= 3;
+  }
+
+  // The buffers are persistently mapped, so they can be read by the worker threads. They are only
+  // reallocated if they are too small.
+  if (slot->mSize < bytes) {
+    if (slot->mBuffer) {
+      glDeleteBuffers(1, &slot->mBuffer);
+    }
+
+    GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    glGenBuffers(1, &slot->mBuffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->mBuffer);
+    glBufferStorage(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(bytes), nullptr, flags);
+    slot->mData = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(bytes), flags);
+    slot->mSize = bytes;
+  }
+
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->mBuffer);
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+  if (request.mDepth) {
+    glReadPixels(0, 0, width, height, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+
+    // The projection is required for converting the depth values to distances.
+    std::array<GLfloat, 16> glMatP{};
+    glGetFloatv(GL_PROJECTION_MATRIX, glMatP.data());
+    slot->mInverseProjection = glm::inverse(glm::make_mat4x4(glMatP.data()));
+
+  } else if (request.mFormat == Format::eRaw && request.mSource) {
+    request.mSource->Bind();
+    glGetTexImage(request.mSource->GetTarget(), 0, GL_RGB, GL_FLOAT, nullptr);
+    request.mSource->Unbind();
+
+  } else if (request.mFormat == Format::eRaw) {
+    glReadPixels(0, 0, width, height, GL_RGB, GL_FLOAT, nullptr);
+
+  } else {
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+  }
+
+  glPixelStorei(GL_PACK_ALIGNMENT, 4);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  slot->mFence    = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  slot->mWidth    = width;
+  slot->mHeight   = height;
+  slot->mBytes    = bytes;
+  slot->mRequest  = std::move(request);
+  slot->mBusy.store(true, std::memory_order_release);
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void FrameCapture::update() {
+  for (auto& slot : mSlots) {
+    if (!slot.mFence) {
+      continue;
+    }
+
+    // Only poll the fence, we do not want to wait for the GPU.
+    GLenum status = glClientWaitSync(slot.mFence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+      continue;
+    }
+
+    glDeleteSync(slot.mFence);
+    slot.mFence = nullptr;
+
+    // The worker copies the data out of the buffer and releases the slot before it starts encoding.
+    mTasks.enqueue([s = &slot]() {
+      std::vector<std::byte> pixels(s->mBytes);
+      std::memcpy(pixels.data(), s->mData, s->mBytes);
+
+      auto request           = std::move(s->mRequest);
+      auto width             = s->mWidth;
+      auto height            = s->mHeight;
+      auto inverseProjection = s->mInverseProjection;
+
+      s->mBusy.store(false, std::memory_order_release);
+
+      std::vector<std::byte> result;
+
+      try {
+        result = encode(std::move(pixels), width, height, inverseProjection, request);
+      } catch (std::exception const& e) {
+        logger().error("Failed to encode captured frame: {}", e.what());
+      }
+
+      if (request.mOnDone) {
+        request.mOnDone(std::move(result));
+      }
+    });
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace cs::graphics
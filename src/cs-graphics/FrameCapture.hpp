@@ -0,0 +1,116 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#ifndef CS_GRAPHICS_FRAME_CAPTURE_HPP
+#define CS_GRAPHICS_FRAME_CAPTURE_HPP
+
+#include "cs_graphics_export.hpp"
+
+#include "../cs-utils/ThreadPool.hpp"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+class VistaTexture;
+
+namespace cs::graphics {
+
+/// The FrameCapture reads the content of the current framebuffer without stalling the rendering.
+/// The pixels are copied into one of several persistently mapped pixel buffer objects and a fence
+/// is inserted into the command stream. Once the fence has been signalled, usually one or two
+/// frames later, the pixels are copied out of the buffer and encoded on the global thread pool.
+/// Hence several captures can be in flight at the same time. All methods must be called from the
+/// main thread.
+class CS_GRAPHICS_EXPORT FrameCapture {
+ public:
+  enum class Format { ePNG, eJPEG, eTIFF, eRaw };
+
+  /// Returns the format for the given name ("png", "jpeg", "tiff" or "raw"), if it is valid.
+  static std::optional<Format> parseFormat(std::string const& name);
+
+  struct Request {
+    Format mFormat = Format::ePNG;
+
+    /// If set to true, the depth buffer is captured. For the tiff and the raw format, the depth
+    /// values are converted to distances in meters. For png and jpeg, they are stored as 8-bit
+    /// grey values.
+    bool mDepth = false;
+
+    /// If given, the color data is read from this texture instead of the framebuffer. This is
+    /// only used for the raw format.
+    VistaTexture* mSource = nullptr;
+
+    /// The scale of the observer. This is required for converting depth values to meters.
+    double mSceneScale = 1.0;
+
+    /// This is called from a worker thread with the encoded image once it is done. The vector is
+    /// empty if encoding failed. If the FrameCapture is destroyed before the pixels are read back,
+    /// it is not called at all.
+    std::function<void(std::vector<std::byte>&&)> mOnDone;
+  };
+
+  /// The number of pixel buffer objects. This is also the maximum number of reads in flight.
+  static constexpr size_t cBufferCount = 4;
+
+  FrameCapture() = default;
+
+  FrameCapture(FrameCapture const& other) = delete;
+  FrameCapture(FrameCapture&& other)      = delete;
+
+  FrameCapture& operator=(FrameCapture const& other) = delete;
+  FrameCapture& operator=(FrameCapture&& other)      = delete;
+
+  /// Waits for all reads which have been handed to the thread pool. This includes encoding the
+  /// images and calling Request::mOnDone.
+  ~FrameCapture();
+
+  /// Starts reading the given area of the currently bound framebuffer. Returns false if all pixel
+  /// buffer objects are in use. In this case, the request should be retried in a later frame.
+  bool read(int32_t width, int32_t height, Request request);
+
+  /// Returns true if read() would currently succeed.
+  bool canRead() const;
+
+  /// Checks the fences of all pending reads. The data of completed reads is handed to the thread
+  /// pool for encoding. This should be called once each frame.
+  void update();
+
+ private:
+  struct Slot {
+    uint32_t mBuffer = 0;
+    size_t   mSize   = 0;
+    void*    mData   = nullptr;
+    GLsync   mFence  = nullptr;
+
+    // This is set when a read is started and reset by the worker thread once it has copied the
+    // data out of the buffer.
+    std::atomic<bool> mBusy{false};
+
+    int32_t   mWidth  = 0;
+    int32_t   mHeight = 0;
+    size_t    mBytes  = 0;
+    glm::mat4 mInverseProjection{1.F};
+    Request   mRequest;
+  };
+
+  std::array<Slot, cBufferCount> mSlots;
+
+  // The tasks which copy the data out of the pixel buffer objects and encode it.
+  cs::utils::TaskGroup mTasks;
+};
+
+} // namespace cs::graphics
+
+#endif // CS_GRAPHICS_FRAME_CAPTURE_HPP
@@ -27,7 +27,9 @@
 
 #include <fstream>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
 
+#include "../cs-utils/ThreadPool.hpp"
 #include "internal/gltfmodel.hpp"
 
 namespace cs::graphics {
@@ -61,8 +63,38 @@ std::string GetFilePathExtension(const std::string& FileName) {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-GltfLoader::GltfLoader(const std::string& sGltfFile, const std::string& cubemapFilepath)
+GltfLoader::GltfLoader(const std::string& sGltfFile, const std::string& cubemapFilepath,
+    const std::string& cacheDirectory)
     : mShared(std::make_shared<internal::GltfShared>()) {
+
+  // Parsing the model and decoding its images does not require an OpenGL context. Therefore this
+  // is done on a worker thread while the environment maps are prepared on the main thread.
+  auto model = utils::ThreadPool::getGlobal().enqueue(
+      [sGltfFile]() { return loadModel(sGltfFile); }, utils::TaskPriority::eHigh);
+
+  auto environmentMaps = internal::getEnvironmentMaps(cubemapFilepath, cacheDirectory);
+
+  // This rethrows any exception which occurred while loading the model.
+  mShared->mTinyGltfModel = std::move(*model.get());
+  mShared->init(mShared->mTinyGltfModel, std::move(environmentMaps));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+GltfLoader::GltfLoader(std::shared_ptr<tinygltf::Model> const& model,
+    const std::string& cubemapFilepath, const std::string& cacheDirectory)
+    : mShared(std::make_shared<internal::GltfShared>()) {
+
+  auto environmentMaps = internal::getEnvironmentMaps(cubemapFilepath, cacheDirectory);
+
+  mShared->mTinyGltfModel = std::move(*model);
+  mShared->init(mShared->mTinyGltfModel, std::move(environmentMaps));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::shared_ptr<tinygltf::Model> GltfLoader::loadModel(std::string const& sGltfFile) {
+  auto               model = std::make_shared<tinygltf::Model>();
   tinygltf::TinyGLTF loader;
   std::string        err;
   std::string        warn;
@@ -71,10 +103,10 @@ GltfLoader::GltfLoader(const std::string& sGltfFile, const std::string& cubemapF
   bool ret = false;
   if (ext == "glb") {
     // Assume binary glTF.
-    ret = loader.LoadBinaryFromFile(&mShared->mTinyGltfModel, &err, &warn, sGltfFile);
+    ret = loader.LoadBinaryFromFile(model.get(), &err, &warn, sGltfFile);
   } else {
     // Assume ascii glTF.
-    ret = loader.LoadASCIIFromFile(&mShared->mTinyGltfModel, &err, &warn, sGltfFile);
+    ret = loader.LoadASCIIFromFile(model.get(), &err, &warn, sGltfFile);
   }
 
   if (!err.empty()) {
@@ -85,7 +117,7 @@ GltfLoader::GltfLoader(const std::string& sGltfFile, const std::string& cubemapF
     throw std::runtime_error(msg + sGltfFile);
   }
 
-  mShared->init(mShared->mTinyGltfModel, cubemapFilepath);
+  return model;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -179,6 +211,10 @@ bool GltfLoader::attachTo(VistaSceneGraph* pSG, VistaTransformNode* parent) {
     return false;
   }
 
+  if (mShared->mMeshes.empty()) {
+    mShared->buildMeshes(mShared->mTinyGltfModel, false);
+  }
+
   auto const& scene = (mShared->mTinyGltfModel.defaultScene >= 0)
                           ? mShared->mTinyGltfModel.scenes[mShared->mTinyGltfModel.defaultScene]
                           : mShared->mTinyGltfModel.scenes.front();
@@ -191,4 +227,136 @@ bool GltfLoader::attachTo(VistaSceneGraph* pSG, VistaTransformNode* parent) {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+glm::mat4 get_transform(tinygltf::Node const& node) {
+  if (node.matrix.size() == 16) {
+    return glm::make_mat4(node.matrix.data());
+  }
+
+  // Assume Trans x Rotate x Scale order
+  glm::mat4 transform(1.F);
+
+  if (node.translation.size() == 3) {
+    transform = glm::translate(transform,
+        glm::vec3(static_cast<float>(node.translation[0]), static_cast<float>(node.translation[1]),
+            static_cast<float>(node.translation[2])));
+  }
+
+  if (node.rotation.size() == 4) {
+    // glTF stores quaternions as (x, y, z, w).
+    glm::quat rotation(static_cast<float>(node.rotation[3]), static_cast<float>(node.rotation[0]),
+        static_cast<float>(node.rotation[1]), static_cast<float>(node.rotation[2]));
+    transform = transform * glm::mat4_cast(rotation);
+  }
+
+  if (node.scale.size() == 3) {
+    transform = glm::scale(transform,
+        glm::vec3(static_cast<float>(node.scale[0]), static_cast<float>(node.scale[1]),
+            static_cast<float>(node.scale[2])));
+  }
+
+  return transform;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void collect_mesh_nodes(tinygltf::Model const& model, tinygltf::Node const& node,
+    glm::mat4 const& parentTransform,
+    std::vector<internal::VistaGltfInstancedNode::MeshNode>& meshNodes) {
+  glm::mat4 transform = parentTransform * get_transform(node);
+
+  if (node.mesh >= 0) {
+    meshNodes.push_back({node.mesh, transform});
+  }
+
+  for (int i : node.children) {
+    collect_mesh_nodes(model, model.nodes[i], transform, meshNodes);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Extends the bounds given by minPos and maxPos so that they contain the box given by boxMin and
+// boxMax after it has been transformed with the given matrix.
+void extend_bounds(glm::mat4 const& transform, glm::vec3 const& boxMin, glm::vec3 const& boxMax,
+    glm::vec3& minPos, glm::vec3& maxPos) {
+  for (int i = 0; i < 8; ++i) {
+    glm::vec4 corner((i & 1) ? boxMax.x : boxMin.x, (i & 2) ? boxMax.y : boxMin.y,
+        (i & 4) ? boxMax.z : boxMin.z, 1.F);
+    glm::vec3 p(transform * corner);
+    minPos = glm::min(minPos, p);
+    maxPos = glm::max(maxPos, p);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool GltfLoader::attachInstancedTo(VistaSceneGraph* pSG, VistaTransformNode* parent) {
+  if (mShared->mTinyGltfModel.scenes.empty()) {
+    return false;
+  }
+
+  if (mShared->mInstancedMeshes.empty()) {
+    mShared->buildMeshes(mShared->mTinyGltfModel, true);
+  }
+
+  auto const& scene = (mShared->mTinyGltfModel.defaultScene >= 0)
+                          ? mShared->mTinyGltfModel.scenes[mShared->mTinyGltfModel.defaultScene]
+                          : mShared->mTinyGltfModel.scenes.front();
+
+  // The node hierarchy of the model is flattened, as all instances share the same node transforms.
+  std::vector<internal::VistaGltfInstancedNode::MeshNode> meshNodes;
+  for (int i : scene.nodes) {
+    collect_mesh_nodes(mShared->mTinyGltfModel, mShared->mTinyGltfModel.nodes[i], glm::mat4(1.F),
+        meshNodes);
+  }
+
+  // These bounds are transformed by each instance in setInstances().
+  mShared->mSceneMinPos    = glm::vec3(std::numeric_limits<float>::max());
+  mShared->mSceneMaxPos    = glm::vec3(std::numeric_limits<float>::lowest());
+  mShared->mHasSceneBounds = true;
+
+  for (auto const& node : meshNodes) {
+    auto const& mesh = mShared->mInstancedMeshes[node.meshIndex];
+
+    if (glm::any(glm::greaterThan(mesh.minPos, mesh.maxPos))) {
+      mShared->mHasSceneBounds = false;
+      break;
+    }
+
+    extend_bounds(node.transform, mesh.minPos, mesh.maxPos, mShared->mSceneMinPos,
+        mShared->mSceneMaxPos);
+  }
+
+  auto* draw = new internal::VistaGltfInstancedNode(std::move(meshNodes), mShared);
+  pSG->NewOpenGLNode(parent, draw);
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void GltfLoader::setInstances(std::vector<GltfInstance> const& instances) {
+  mShared->mInstances.resize(instances.size());
+  mShared->mInstancesMinPos = glm::vec3(std::numeric_limits<float>::max());
+  mShared->mInstancesMaxPos = glm::vec3(std::numeric_limits<float>::lowest());
+
+  for (std::size_t i = 0; i < instances.size(); ++i) {
+    auto const& instance = instances[i];
+    auto&       data     = mShared->mInstances[i];
+
+    data.modelMatrix  = instance.mTransform;
+    data.normalMatrix = glm::mat4(glm::inverse(glm::transpose(glm::mat3(instance.mTransform))));
+    data.light        = glm::vec4(instance.mLightDirection, instance.mLightIntensity);
+
+    if (mShared->mHasSceneBounds) {
+      extend_bounds(instance.mTransform, mShared->mSceneMinPos, mShared->mSceneMaxPos,
+          mShared->mInstancesMinPos, mShared->mInstancesMaxPos);
+    }
+  }
+
+  mShared->mInstancesDirty = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 } // namespace cs::graphics
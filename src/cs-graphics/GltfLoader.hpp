@@ -33,12 +33,29 @@ namespace internal {
 struct GltfShared;
 }
 
+/// One instance of a model drawn with GltfLoader::attachInstancedTo(). All values are relative to
+/// the parent node given to attachInstancedTo().
+struct GltfInstance {
+  glm::mat4 mTransform{1.F};                ///< The transformation of the instance.
+  glm::vec3 mLightDirection{0.F, 0.F, 1.F}; ///< The direction towards the light source.
+  float     mLightIntensity = 1.F;          ///< The intensity of the light source.
+};
+
 /// If added to the scene graph, this will draw a Gltf 2.0 model.
 // TODO maybe rename to GltfModel, because it does a lot more than loading an gltf model.
 class CS_GRAPHICS_EXPORT GltfLoader {
  public:
-  /// Creates a gltf model from the gltf and cubemap files.
-  GltfLoader(const std::string& sGltfFile, const std::string& cubemapFilepath);
+  /// Creates a gltf model from the gltf and cubemap files. The textures used for image-based
+  /// lighting are computed from the cubemap only once: Models using the same cubemap share them and
+  /// they are stored in the given cache directory for subsequent runs. If cacheDirectory is empty,
+  /// they are not written to disk.
+  GltfLoader(const std::string& sGltfFile, const std::string& cubemapFilepath,
+      const std::string& cacheDirectory = "cache/gltf");
+
+  /// Like above, but uses a model which has been parsed with loadModel() before. The data is moved
+  /// out of the given model, so it must not be used by anybody else.
+  GltfLoader(std::shared_ptr<tinygltf::Model> const& model, const std::string& cubemapFilepath,
+      const std::string& cacheDirectory = "cache/gltf");
 
   GltfLoader(GltfLoader const& other) = delete;
   GltfLoader(GltfLoader&& other)      = delete;
@@ -48,6 +65,11 @@ class CS_GRAPHICS_EXPORT GltfLoader {
 
   ~GltfLoader() = default;
 
+  /// Parses the given .gltf or .glb file and decodes its images. This does not require an OpenGL
+  /// context, so it can be called on any thread, for example in PluginBase::prepare(). Throws a
+  /// std::runtime_error if the file cannot be loaded.
+  static std::shared_ptr<tinygltf::Model> loadModel(std::string const& sGltfFile);
+
   void setLightColor(float r, float g, float b);
   void setLightDirection(float x, float y, float z);
   void setLightDirection(VistaVector3D const& dir);
@@ -63,6 +85,18 @@ class CS_GRAPHICS_EXPORT GltfLoader {
   /// Attaches the model to the VistaSceneGraph for rendering.
   bool attachTo(VistaSceneGraph* sg, VistaTransformNode* parent);
 
+  /// Attaches a single node to the VistaSceneGraph which draws the model once for each instance
+  /// given to setInstances(). All instances are drawn with one instanced draw call per primitive,
+  /// so this is much faster than attaching many copies of the same model. For the instances, the
+  /// values given to setLightDirection() and setLightIntensity() are ignored, as they are specified
+  /// per instance instead. This requires OpenGL 4.3.
+  bool attachInstancedTo(VistaSceneGraph* sg, VistaTransformNode* parent);
+
+  /// Sets the instances which are drawn by the node created with attachInstancedTo(). They are
+  /// uploaded to the GPU the next time the model is drawn. The bounding box of the node is updated
+  /// to contain all instances, so it has to be called after attachInstancedTo().
+  void setInstances(std::vector<GltfInstance> const& instances);
+
  private:
   std::shared_ptr<internal::GltfShared> mShared;
 };
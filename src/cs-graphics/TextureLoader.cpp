@@ -19,26 +19,67 @@
 #undef STB_IMAGE_WRITE_IMPLEMENTATION
 #undef STB_IMAGE_RESIZE_IMPLEMENTATION
 
+#include "../cs-utils/ThreadPool.hpp"
+
 #include <VistaOGLExt/VistaOGLUtils.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <future>
 #include <iostream>
+#include <optional>
 #include <tiffio.h>
+#include <unordered_map>
 #include <vector>
 
 namespace cs::graphics {
 
+namespace {
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-std::unique_ptr<VistaTexture> TextureLoader::loadFromFile(std::string const& sFileName) {
+// The decoded pixels of an image file and the parameters required for uploading them to the GPU.
+struct ImageData {
+  int32_t                mWidth          = 0;
+  int32_t                mHeight         = 0;
+  GLenum                 mInternalFormat = GL_RGBA8;
+  GLenum                 mFormat         = GL_RGBA;
+  GLenum                 mType           = GL_UNSIGNED_BYTE;
+  bool                   mMipMaps        = true;
+  std::vector<std::byte> mPixels;
+};
+
+// A texture requested with TextureLoader::loadFromFileAsync(). Once decoded, the pixels are copied
+// to a pixel buffer object in chunks and eventually transferred to the texture.
+struct PendingTexture {
+  std::string                           mFileName;
+  std::weak_ptr<VistaTexture>           mTexture;
+  std::future<std::optional<ImageData>> mFuture;
+  std::optional<ImageData>              mImage;
+  GLuint                                mBuffer   = 0;
+  size_t                                mUploaded = 0;
+};
+
+// This is only accessed on the main thread.
+struct AsyncState {
+  std::unordered_map<std::string, std::weak_ptr<VistaTexture>> mCache;
+  std::deque<PendingTexture>                                   mPending;
+};
+
+AsyncState& getAsyncState() {
+  static AsyncState state;
+  return state;
+}
 
-  std::string suffix = sFileName.substr(sFileName.rfind('.'));
+////////////////////////////////////////////////////////////////////////////////////////////////////
 
-  if (suffix == ".tga") {
-    // load with vista
-    logger().debug("Loading Texture '{}' with Vista.", sFileName);
-    return std::unique_ptr<VistaTexture>(VistaOGLUtils::LoadTextureFromTga(sFileName));
-  }
+// Reads the given file. This does not require an OpenGL context. *.tga files are not supported.
+std::optional<ImageData> decodeImage(std::string const& sFileName) {
 
-  std::unique_ptr<VistaTexture> result = std::make_unique<VistaTexture>(GL_TEXTURE_2D);
+  std::string suffix = sFileName.substr(sFileName.rfind('.'));
+
+  ImageData result;
 
   if (suffix == ".tiff" || suffix == ".tif") {
     // load with tifflib
@@ -47,7 +88,7 @@ std::unique_ptr<VistaTexture> TextureLoader::loadFromFile(std::string const& sFi
     auto* data = TIFFOpen(sFileName.c_str(), "r");
     if (!data) {
       logger().error("Failed to load '{}' with libtiff!", sFileName);
-      return nullptr;
+      return std::nullopt;
     }
 
     uint32 width{};
@@ -61,45 +102,43 @@ std::unique_ptr<VistaTexture> TextureLoader::loadFromFile(std::string const& sFi
     int16 channels{};
     TIFFGetField(data, TIFFTAG_SAMPLESPERPIXEL, &channels);
 
-    GLenum ePixelFormat = GL_RGBA;
+    result.mFormat = GL_RGBA;
 
     if (channels == 1) {
-      ePixelFormat = GL_RED;
+      result.mFormat = GL_RED;
     } else if (channels == 2) {
-      ePixelFormat = GL_RG;
+      result.mFormat = GL_RG;
     } else if (channels == 3) {
-      ePixelFormat = GL_RGB;
+      result.mFormat = GL_RGB;
     }
 
     if (bpp != 8 && bpp != 32) {
       logger().error(
           "Failed to load '{}' with libtiff: Only 8 or 32 bit per sample are supported right now!",
           sFileName);
-      return nullptr;
+      TIFFClose(data);
+      return std::nullopt;
     }
 
     if (bpp == 32) {
-
-      std::vector<float> pixels(width * height * channels);
-
-      for (unsigned y = 0; y < height; y++) {
-        TIFFReadScanline(data, &pixels[width * channels * y], y);
-      }
-
-      result->Bind();
-      glTexImage2D(
-          GL_TEXTURE_2D, 0, GL_RGB32F, width, height, 0, ePixelFormat, GL_FLOAT, pixels.data());
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-
+      result.mInternalFormat = GL_RGB32F;
+      result.mType           = GL_FLOAT;
+      result.mMipMaps        = false;
     } else {
+      result.mInternalFormat = channels == 1   ? GL_R8
+                               : channels == 2 ? GL_RG8
+                               : channels == 3 ? GL_RGB8
+                                               : GL_RGBA8;
+    }
 
-      std::vector<char> pixels(width * height * channels);
+    size_t rowSize = static_cast<size_t>(width) * channels * (bpp / 8);
 
-      for (unsigned y = 0; y < height; y++) {
-        TIFFReadScanline(data, &pixels[width * channels * y], y);
-      }
+    result.mWidth  = static_cast<int32_t>(width);
+    result.mHeight = static_cast<int32_t>(height);
+    result.mPixels.resize(rowSize * height);
 
-      result->UploadTexture(width, height, pixels.data(), true, ePixelFormat);
+    for (unsigned y = 0; y < height; y++) {
+      TIFFReadScanline(data, &result.mPixels[rowSize * y], y);
     }
 
     TIFFClose(data);
@@ -118,11 +157,15 @@ std::unique_ptr<VistaTexture> TextureLoader::loadFromFile(std::string const& sFi
 
     if (!pixels) {
       logger().error("Failed to load '{}' with stbi!", sFileName);
-      return nullptr;
+      return std::nullopt;
     }
 
-    result->Bind();
-    gluBuild2DMipmaps(GL_TEXTURE_2D, GL_RGBA32F, width, height, GL_RGBA, GL_FLOAT, pixels);
+    result.mWidth          = width;
+    result.mHeight         = height;
+    result.mInternalFormat = GL_RGBA32F;
+    result.mType           = GL_FLOAT;
+    result.mPixels.resize(sizeof(float) * width * height * channels);
+    std::memcpy(result.mPixels.data(), pixels, result.mPixels.size());
 
     stbi_image_free(pixels);
 
@@ -139,10 +182,13 @@ std::unique_ptr<VistaTexture> TextureLoader::loadFromFile(std::string const& sFi
 
     if (!pixels) {
       logger().error("Failed to load '{}' with stbi!", sFileName);
-      return nullptr;
+      return std::nullopt;
     }
 
-    result->UploadTexture(width, height, pixels);
+    result.mWidth  = width;
+    result.mHeight = height;
+    result.mPixels.resize(static_cast<size_t>(width) * height * channels);
+    std::memcpy(result.mPixels.data(), pixels, result.mPixels.size());
 
     stbi_image_free(pixels);
   }
@@ -152,4 +198,183 @@ std::unique_ptr<VistaTexture> TextureLoader::loadFromFile(std::string const& sFi
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// Uploads the given image to the texture. If a pixel buffer object is bound to
+// GL_PIXEL_UNPACK_BUFFER, pixels is an offset into this buffer. Mipmaps are generated on the GPU.
+void uploadImage(ImageData const& image, VistaTexture& texture, void const* pixels) {
+  texture.Bind();
+
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(image.mInternalFormat), image.mWidth,
+      image.mHeight, 0, image.mFormat, image.mType, pixels);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+  if (image.mMipMaps) {
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+  } else {
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  }
+
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+  texture.Unbind();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::unique_ptr<VistaTexture> TextureLoader::loadFromFile(std::string const& sFileName) {
+
+  std::string suffix = sFileName.substr(sFileName.rfind('.'));
+
+  if (suffix == ".tga") {
+    // load with vista
+    logger().debug("Loading Texture '{}' with Vista.", sFileName);
+    return std::unique_ptr<VistaTexture>(VistaOGLUtils::LoadTextureFromTga(sFileName));
+  }
+
+  auto image = decodeImage(sFileName);
+
+  if (!image) {
+    return nullptr;
+  }
+
+  std::unique_ptr<VistaTexture> result = std::make_unique<VistaTexture>(GL_TEXTURE_2D);
+  uploadImage(*image, *result, image->mPixels.data());
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::shared_ptr<VistaTexture> TextureLoader::loadFromFileAsync(std::string const& sFileName) {
+  auto& state = getAsyncState();
+
+  // Remove the entries of textures which are not used anymore, else the cache would grow with each
+  // file which has ever been loaded.
+  for (auto it = state.mCache.begin(); it != state.mCache.end();) {
+    if (it->second.expired()) {
+      it = state.mCache.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  // Return the cached texture if it is still in use somewhere.
+  auto cached = state.mCache.find(sFileName);
+  if (cached != state.mCache.end()) {
+    if (auto texture = cached->second.lock()) {
+      return texture;
+    }
+  }
+
+  std::shared_ptr<VistaTexture> texture;
+
+  std::string suffix = sFileName.substr(sFileName.rfind('.'));
+
+  if (suffix == ".tga") {
+    texture = loadFromFile(sFileName);
+  } else {
+    texture = std::make_shared<VistaTexture>(GL_TEXTURE_2D);
+
+    ImageData placeholder;
+    placeholder.mWidth   = 1;
+    placeholder.mHeight  = 1;
+    placeholder.mMipMaps = false;
+    placeholder.mPixels.resize(4, std::byte(0));
+    uploadImage(placeholder, *texture, placeholder.mPixels.data());
+
+    PendingTexture pending;
+    pending.mFileName = sFileName;
+    pending.mTexture  = texture;
+    pending.mFuture   = utils::ThreadPool::getGlobal().enqueue(
+        [sFileName]() { return decodeImage(sFileName); }, utils::TaskPriority::eHigh);
+
+    state.mPending.push_back(std::move(pending));
+  }
+
+  if (texture) {
+    state.mCache[sFileName] = texture;
+  }
+
+  return texture;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TextureLoader::uploadPendingTextures(size_t maxBytes) {
+  auto& state = getAsyncState();
+
+  size_t budget = maxBytes;
+
+  for (auto it = state.mPending.begin(); it != state.mPending.end() && budget > 0;) {
+    auto texture = it->mTexture.lock();
+
+    // The texture is not used anymore. Waiting for the future is not required, as the decoding
+    // task owns all of its data.
+    if (!texture) {
+      if (it->mBuffer != 0) {
+        glDeleteBuffers(1, &it->mBuffer);
+      }
+      it = state.mPending.erase(it);
+      continue;
+    }
+
+    if (!it->mImage) {
+      if (it->mFuture.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        ++it;
+        continue;
+      }
+
+      try {
+        it->mImage = it->mFuture.get();
+      } catch (std::exception const& e) {
+        logger().error("Failed to load '{}': {}", it->mFileName, e.what());
+      }
+
+      // Decoding failed. An error has been printed already, the placeholder will be kept.
+      if (!it->mImage) {
+        it = state.mPending.erase(it);
+        continue;
+      }
+
+      glGenBuffers(1, &it->mBuffer);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, it->mBuffer);
+      glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(it->mImage->mPixels.size()),
+          nullptr, GL_STREAM_DRAW);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    // Copy the next chunk of pixels to the pixel buffer object.
+    auto const& pixels = it->mImage->mPixels;
+    size_t      chunk  = std::min(budget, pixels.size() - it->mUploaded);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, it->mBuffer);
+    glBufferSubData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLintptr>(it->mUploaded),
+        static_cast<GLsizeiptr>(chunk), pixels.data() + it->mUploaded);
+
+    it->mUploaded += chunk;
+    budget -= chunk;
+
+    // Once all pixels are on the GPU, the placeholder is replaced with the actual image.
+    if (it->mUploaded == pixels.size()) {
+      uploadImage(*it->mImage, *texture, nullptr);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      glDeleteBuffers(1, &it->mBuffer);
+
+      logger().debug("Uploaded Texture '{}'.", it->mFileName);
+
+      it = state.mPending.erase(it);
+    } else {
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      ++it;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 } // namespace cs::graphics
@@ -11,6 +11,7 @@
 #include "cs_graphics_export.hpp"
 
 #include <VistaOGLExt/VistaTexture.h>
+#include <cstddef>
 #include <memory>
 #include <string>
 
@@ -21,6 +22,19 @@ class CS_GRAPHICS_EXPORT TextureLoader {
   /// Loads a VistaTexture from the given file. This support *.tga, *.tif, *.hdr as well as all
   /// image formats supported by stb_image (including *.bmp, *.jpeg and *.png).
   static std::unique_ptr<VistaTexture> loadFromFile(std::string const& sFileName);
+
+  /// Like loadFromFile(), but the file is decoded on the global ThreadPool. The returned texture
+  /// contains a transparent 1x1 placeholder until the pixels have been uploaded by
+  /// uploadPendingTextures(). Textures are shared between all callers which request the same file,
+  /// so the returned texture should not be modified. *.tga files are loaded synchronously.
+  /// This has to be called on the main thread.
+  static std::shared_ptr<VistaTexture> loadFromFileAsync(std::string const& sFileName);
+
+  /// Uploads the pixels of textures which have been decoded since the last call. At most maxBytes
+  /// are copied to the GPU, so large textures are uploaded over several frames. The mipmaps are
+  /// generated on the GPU once a texture is complete. This is called once each frame by the
+  /// Application.
+  static void uploadPendingTextures(size_t maxBytes);
 };
 
 } // namespace cs::graphics
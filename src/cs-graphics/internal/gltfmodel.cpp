@@ -11,6 +11,8 @@
 #include <GL/glew.h>
 
 #include "../../cs-utils/FrameStats.hpp"
+#include "../../cs-utils/ThreadPool.hpp"
+#include "../../cs-utils/filesystem.hpp"
 #include "../logger.hpp"
 #include "pbr_fragment_shader.hpp"
 #include "pbr_vertex_shader.hpp"
@@ -23,8 +25,12 @@
 #include <VistaKernel/VistaSystem.h>
 #include <VistaMath/VistaBoundingBox.h>
 #include <algorithm>
+#include <boost/filesystem.hpp>
 #include <fstream>
 #include <gli/gli.hpp>
+#include <iomanip>
+#include <map>
+#include <sstream>
 #include <utility>
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -549,6 +555,10 @@ GLProgramInfo getProgramInfo(unsigned int program) {
   info.u_ModelMatrix_loc  = glGetUniformLocation(program, "u_ModelMatrix");
   info.u_NormalMatrix_loc = glGetUniformLocation(program, "u_NormalMatrix");
 
+  info.u_ViewProjectionMatrix_loc = glGetUniformLocation(program, "u_ViewProjectionMatrix");
+  info.u_NodeMatrix_loc           = glGetUniformLocation(program, "u_NodeMatrix");
+  info.u_NodeNormalMatrix_loc     = glGetUniformLocation(program, "u_NodeNormalMatrix");
+
   info.u_LightDirection_loc = glGetUniformLocation(program, "u_LightDirection");
   info.u_LightColor_loc     = glGetUniformLocation(program, "u_LightColor");
   info.u_EnableHDR_loc      = glGetUniformLocation(program, "u_EnableHDR");
@@ -928,7 +938,7 @@ std::shared_ptr<GLuint> createGPUsampler(tinygltf::Sampler const& s) {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-Texture createBrdfLUT(int width, int height) {
+Texture createBrdfLUTTexture(int width, int height, void const* data) {
   std::shared_ptr<GLuint> texture_ptr(new GLuint(0), [](GLuint* ptr) {
     if (*ptr != 0u) {
       glDeleteTextures(1, ptr);
@@ -941,34 +951,231 @@ Texture createBrdfLUT(int width, int height) {
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16F, width, height, 0, GL_RG, GL_HALF_FLOAT, nullptr);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16F, width, height, 0, GL_RG, GL_HALF_FLOAT, data);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  tinygltf::Sampler sampler;
+  sampler.name      = "brdfLUT";
+  sampler.minFilter = GL_LINEAR;
+  sampler.magFilter = GL_LINEAR;
+  sampler.wrapS     = GL_CLAMP_TO_EDGE;
+  sampler.wrapT     = GL_CLAMP_TO_EDGE;
+
+  return Texture{GL_TEXTURE_2D, createGPUsampler(sampler), texture_ptr};
+} // NOLINT(clang-analyzer-cplusplus.NewDeleteLeaks): TODO memory leak here?
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+Texture createBrdfLUT(int width, int height) {
+  auto texture = createBrdfLUTTexture(width, height, nullptr);
   auto program = createCompute(compute_brdf_lut);
 
   glUseProgram(program);
-  glBindImageTexture(0, *texture_ptr, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RG16F);
+  glBindImageTexture(0, *texture.image, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RG16F);
   glDispatchCompute(static_cast<GLuint>(width) / 16, static_cast<GLuint>(height) / 16, 1);
-  glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+  glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
   glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RG16F);
 
   glDeleteProgram(program);
   CheckGLErrors("in createBrdfLUT");
 
-  tinygltf::Sampler sampler;
-  sampler.name      = "brdfLUT";
-  sampler.minFilter = GL_LINEAR;
-  sampler.magFilter = GL_LINEAR;
-  sampler.wrapS     = GL_CLAMP_TO_EDGE;
-  sampler.wrapT     = GL_CLAMP_TO_EDGE;
+  return texture;
+}
 
-  return Texture{GL_TEXTURE_2D, createGPUsampler(sampler), texture_ptr};
-} // NOLINT(clang-analyzer-cplusplus.NewDeleteLeaks): TODO memory leak here?
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+gli::texture2d downloadBrdfLUT(Texture const& texture, int width, int height) {
+  gli::texture2d gliTex(gli::FORMAT_RG16_SFLOAT_PACK16, gli::extent2d(width, height), 1);
+
+  glBindTexture(GL_TEXTURE_2D, *texture.image);
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glGetTexImage(GL_TEXTURE_2D, 0, GL_RG, GL_HALF_FLOAT, gliTex.data());
+  glPixelStorei(GL_PACK_ALIGNMENT, 4);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  CheckGLErrors("in downloadBrdfLUT");
+
+  return gliTex;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// The resolutions of the image-based lighting textures. They are part of the cache key, so changing
+// them invalidates all cached textures.
+const int         cBrdfLUTSize        = 512;
+const int         cDiffuseSize        = 32;
+const std::size_t cSpecularLevels     = 10;
+const int         cCacheFormatVersion = 1;
+
+// Returns a hash of everything besides the cubemap itself which has an influence on the
+// image-based lighting textures. This is a 64-bit FNV-1a hash, formatted as hexadecimal string.
+std::string getFilterHash() {
+  std::ostringstream parameters;
+  parameters << cCacheFormatVersion << cBrdfLUTSize << cDiffuseSize << cSpecularLevels
+             << vertex_shader_source << filter_fragment_source << irradiance_fragment_source
+             << compute_brdf_lut;
+
+  uint64_t hash = 14695981039346656037ULL;
+  for (char c : parameters.str()) {
+    hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ULL;
+  }
+
+  std::ostringstream result;
+  result << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return result.str();
+}
+
+// Loads a texture which has been written by saveCached() before. An empty texture is returned if
+// the file does not exist or is not valid.
+template <typename T>
+T loadCached(std::string const& file) {
+  if (file.empty() || !boost::filesystem::exists(file)) {
+    return T();
+  }
+
+  T texture(gli::load(file));
+
+  if (texture.empty()) {
+    logger().warn("Ignoring invalid cached texture '{}'!", file);
+  }
+
+  return texture;
+}
+
+// Writes the given texture to the cache on a worker thread. The texture is written to a uniquely
+// named temporary file first and then renamed, so that other instances never read partially
+// written files and concurrent writers of the same file do not interfere.
+template <typename T>
+void saveCached(T const& texture, std::string const& file) {
+  if (file.empty()) {
+    return;
+  }
+
+  utils::ThreadPool::getGlobal().enqueue(
+      [texture, file]() {
+        try {
+          boost::filesystem::path path(file);
+          utils::filesystem::createDirectoryRecursively(path.parent_path());
+
+          auto tmpFile = boost::filesystem::unique_path(file + ".%%%%-%%%%-%%%%.tmp").string();
+          if (gli::save_ktx(texture, tmpFile)) {
+            boost::filesystem::rename(tmpFile, path);
+          } else {
+            boost::filesystem::remove(tmpFile);
+            logger().warn("Failed to write cached texture '{}'!", file);
+          }
+        } catch (std::exception const& e) {
+          logger().warn("Failed to write cached texture '{}': {}", file, e.what());
+        }
+      },
+      utils::TaskPriority::eLow);
+}
+
+} // namespace
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void GltfShared::buildMeshes(tinygltf::Model const& gltf) {
+std::shared_ptr<EnvironmentMaps const> getEnvironmentMaps(
+    std::string const& cubemapFilepath, std::string const& cacheDirectory) {
+
+  // The textures are kept alive by the models which use them. Once all models using a cubemap are
+  // deleted, the textures will be deleted as well. This map is only accessed on the main thread.
+  static std::map<std::string, std::weak_ptr<EnvironmentMaps const>> loadedEnvironmentMaps;
+  static std::weak_ptr<unsigned int>                                 loadedBrdfLUTImage;
+  static std::weak_ptr<unsigned int>                                 loadedBrdfLUTSampler;
+
+  {
+    std::ifstream f(cubemapFilepath.c_str());
+    if (!f.good()) {
+      throw std::runtime_error("GltfShared: Cannot open cubemap: " + cubemapFilepath);
+    }
+  }
+
+  // Different relative paths may refer to the same file, so the canonical path is used as key.
+  auto& cached = loadedEnvironmentMaps[boost::filesystem::canonical(cubemapFilepath).string()];
+  if (auto environmentMaps = cached.lock()) {
+    return environmentMaps;
+  }
+
+  // save current viewport
+  std::array<GLint, 4> current_viewport{};
+  glGetIntegerv(GL_VIEWPORT, current_viewport.data());
+
+  // The cached files are named after the content of the cubemap and the filtering parameters.
+  std::string filterHash = getFilterHash();
+  std::string brdfFile;
+  std::string diffuseFile;
+  std::string specularFile;
+
+  if (!cacheDirectory.empty()) {
+    auto prefix  = cacheDirectory + "/" + utils::filesystem::computeSHA256(cubemapFilepath);
+    brdfFile     = cacheDirectory + "/brdf-" + filterHash + ".ktx";
+    diffuseFile  = prefix + "-" + filterHash + "-diffuse.ktx";
+    specularFile = prefix + "-" + filterHash + "-specular.ktx";
+  }
+
+  auto environmentMaps = std::make_shared<EnvironmentMaps>();
+
+  // The BRDF lookup table does not depend on the cubemap, so all environment maps share one.
+  environmentMaps->brdfLUT = {
+      GL_TEXTURE_2D, loadedBrdfLUTSampler.lock(), loadedBrdfLUTImage.lock()};
+
+  if (!environmentMaps->brdfLUT.image || !environmentMaps->brdfLUT.sampler) {
+    auto brdfGliTex = loadCached<gli::texture2d>(brdfFile);
+
+    if (!brdfGliTex.empty() && brdfGliTex.format() == gli::FORMAT_RG16_SFLOAT_PACK16 &&
+        brdfGliTex.extent() == gli::extent2d(cBrdfLUTSize, cBrdfLUTSize)) {
+      environmentMaps->brdfLUT =
+          createBrdfLUTTexture(cBrdfLUTSize, cBrdfLUTSize, brdfGliTex.data());
+    } else {
+      environmentMaps->brdfLUT = createBrdfLUT(cBrdfLUTSize, cBrdfLUTSize);
+      saveCached(downloadBrdfLUT(environmentMaps->brdfLUT, cBrdfLUTSize, cBrdfLUTSize), brdfFile);
+    }
+
+    loadedBrdfLUTImage   = environmentMaps->brdfLUT.image;
+    loadedBrdfLUTSampler = environmentMaps->brdfLUT.sampler;
+  }
+
+  auto diffuseGliTex  = loadCached<gli::texture_cube>(diffuseFile);
+  auto specularGliTex = loadCached<gli::texture_cube>(specularFile);
+
+  if (diffuseGliTex.empty() || specularGliTex.empty() ||
+      specularGliTex.levels() != cSpecularLevels) {
+    gli::texture_cube inputGliTex(gli::load(cubemapFilepath));
+
+    diffuseGliTex  = irradianceCubemap(inputGliTex, cDiffuseSize, cDiffuseSize);
+    specularGliTex = prefilterCubemapGGX(inputGliTex, cSpecularLevels);
+
+    saveCached(diffuseGliTex, diffuseFile);
+    saveCached(specularGliTex, specularFile);
+  }
+
+  environmentMaps->diffuse  = uploadCubemap(diffuseGliTex);
+  environmentMaps->specular = uploadCubemap(specularGliTex);
+
+  // reset current viewport
+  glViewport(current_viewport[0], current_viewport[1], current_viewport[2], current_viewport[3]);
+  glScissor(current_viewport[0], current_viewport[1], current_viewport[2], current_viewport[3]);
+
+  cached = environmentMaps;
+
+  return environmentMaps;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void GltfShared::buildMeshes(tinygltf::Model const& gltf, bool instanced) {
   for (auto const& gltfMesh : gltf.meshes) {
     Mesh mesh;
+
+    // The bounds of instanced meshes are accumulated in GltfLoader::setInstances(), so they have to
+    // start empty. Meshes without bounds are detected there.
+    if (instanced) {
+      mesh.minPos = glm::vec3(std::numeric_limits<float>::max());
+      mesh.maxPos = glm::vec3(std::numeric_limits<float>::lowest());
+    }
+
     for (auto const& primitive : gltfMesh.primitives) {
       auto it = primitive.attributes.find("POSITION");
 
@@ -987,22 +1194,33 @@ void GltfShared::buildMeshes(tinygltf::Model const& gltf) {
           mesh.maxPos[2] = std::max(mesh.maxPos[2], float(a.maxValues[2]));
         }
       }
-      mesh.primitives.push_back(createMeshPrimitive(gltf, primitive));
+      mesh.primitives.push_back(createMeshPrimitive(gltf, primitive, instanced));
+    }
+
+    if (instanced) {
+      mInstancedMeshes.push_back(mesh);
+    } else {
+      mMeshes.push_back(mesh);
     }
-    mMeshes.push_back(mesh);
   }
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 Primitive GltfShared::createMeshPrimitive(
-    tinygltf::Model const& gltf, tinygltf::Primitive const& primitive) {
+    tinygltf::Model const& gltf, tinygltf::Primitive const& primitive, bool instanced) {
   Primitive myPrimitive;
   myPrimitive.hasIndices = primitive.indices >= 0;
 
   std::string definesVS = "#version 330\n";
   std::string definesFS = "#version 330\n";
 
+  // The instance data is read from a shader storage buffer which requires GLSL 4.30.
+  if (instanced) {
+    definesVS = "#version 430\n#define USE_INSTANCING\n";
+    definesFS = "#version 430\n#define USE_INSTANCING\n";
+  }
+
   definesFS += "#define USE_IBL\n#define USE_TEX_LOD\n";
 
   if (primitive.attributes.count("NORMAL")) {
@@ -1178,6 +1396,41 @@ void Primitive::draw(glm::mat4 const& projMat, glm::mat4 const& viewMat, glm::ma
   glUniform3fv(programInfo.u_LightDirection_loc, 1, glm::value_ptr(shared.m_lightDirection));
   glUniform3fv(programInfo.u_LightColor_loc, 1,
       glm::value_ptr(shared.m_lightColor * shared.m_lightIntensity));
+
+  bindMaterial(eye, shared);
+  drawVertexArray(1);
+  unbindMaterial();
+
+  glUseProgram(0);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Primitive::drawInstanced(glm::mat4 const& viewProjMat, glm::mat4 const& nodeMat,
+    glm::vec3 const& eye, GltfShared const& shared, int instanceCount) const {
+  if (programPtr) {
+    glUseProgram(*programPtr);
+  }
+
+  // The light direction and intensity are stored per instance.
+  auto nodeNormalMat = glm::inverse(glm::transpose(glm::mat3(nodeMat)));
+  glUniformMatrix4fv(
+      programInfo.u_ViewProjectionMatrix_loc, 1, GL_FALSE, glm::value_ptr(viewProjMat));
+  glUniformMatrix4fv(programInfo.u_NodeMatrix_loc, 1, GL_FALSE, glm::value_ptr(nodeMat));
+  glUniformMatrix3fv(
+      programInfo.u_NodeNormalMatrix_loc, 1, GL_FALSE, glm::value_ptr(nodeNormalMat));
+  glUniform3fv(programInfo.u_LightColor_loc, 1, glm::value_ptr(shared.m_lightColor));
+
+  bindMaterial(eye, shared);
+  drawVertexArray(instanceCount);
+  unbindMaterial();
+
+  glUseProgram(0);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Primitive::bindMaterial(glm::vec3 const& eye, GltfShared const& shared) const {
   glUniform1i(programInfo.u_EnableHDR_loc, shared.m_enableHDR);
   glUniform3fv(programInfo.u_Camera_loc, 1, glm::value_ptr(eye));
 
@@ -1199,43 +1452,41 @@ void Primitive::draw(glm::mat4 const& projMat, glm::mat4 const& viewMat, glm::ma
     glBindTexture(tex.target, *tex.image);
     glBindSampler(texVar.unit, *tex.sampler);
   }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Primitive::unbindMaterial() const {
+  for (auto const& pair : textures) {
+    glActiveTexture(GL_TEXTURE0 + pair.second.unit);
+    glBindTexture(pair.first.target, 0);
+    glBindSampler(pair.second.unit, 0);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void Primitive::drawVertexArray(int instanceCount) const {
   if (vaoPtr) {
     glBindVertexArray(*vaoPtr);
     if (hasIndices) {
-      glDrawElements(static_cast<GLenum>(mode), static_cast<GLsizei>(indicesCount),
+      glDrawElementsInstanced(static_cast<GLenum>(mode), static_cast<GLsizei>(indicesCount),
           static_cast<GLenum>(indicesType),
           // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-          static_cast<char*>(nullptr) + byteOffset);
+          static_cast<char*>(nullptr) + byteOffset, instanceCount);
     } else {
-      glDrawArrays(static_cast<GLenum>(mode), 0, static_cast<GLsizei>(verticesCount));
+      glDrawArraysInstanced(
+          static_cast<GLenum>(mode), 0, static_cast<GLsizei>(verticesCount), instanceCount);
     }
     glBindVertexArray(0);
   }
-
-  for (auto const& pair : textures) {
-    glActiveTexture(GL_TEXTURE0 + pair.second.unit);
-    glBindTexture(pair.first.target, 0);
-    glBindSampler(pair.second.unit, 0);
-  }
-
-  glUseProgram(0);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void GltfShared::init(tinygltf::Model const& gltf, std::string const& cubemapFilepath) {
+void GltfShared::init(
+    tinygltf::Model const& gltf, std::shared_ptr<EnvironmentMaps const> environmentMaps) {
 
-  // save current viewport
-  std::array<GLint, 4> current_viewport{};
-  glGetIntegerv(GL_VIEWPORT, current_viewport.data());
-
-  {
-    std::ifstream f(cubemapFilepath.c_str());
-    if (!f.good()) {
-      throw std::runtime_error("GltfShared: Cannot open cubemap: " + cubemapFilepath);
-    }
-  }
   std::vector<std::shared_ptr<unsigned int>> sharedImages;
   for (auto const& i : gltf.images) {
     sharedImages.emplace_back(createGPUimage(i, true));
@@ -1257,27 +1508,21 @@ void GltfShared::init(tinygltf::Model const& gltf, std::string const& cubemapFil
     mTextures.emplace_back(Texture{GL_TEXTURE_2D, sampler, sharedImages.at(t.source)});
   }
 
+  // The image-based lighting textures are shared with all other models using the same cubemap.
+  mEnvironmentMaps = std::move(environmentMaps);
+
   mBrdfLUTindex = static_cast<int>(mTextures.size());
-  mTextures.push_back(createBrdfLUT(512, 512));
+  mTextures.push_back(mEnvironmentMaps->brdfLUT);
 
   glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
-  gli::texture_cube inputGliTex(gli::load(cubemapFilepath));
 
   // diffuse env map
   mDiffuseEnvMapIndex = static_cast<int>(mTextures.size());
-  auto diffuseGliTex  = irradianceCubemap(inputGliTex, 32, 32);
-  mTextures.push_back(uploadCubemap(diffuseGliTex));
+  mTextures.push_back(mEnvironmentMaps->diffuse);
 
   // specular env map
   mSpecularEnvMapIndex = static_cast<int>(mTextures.size());
-  auto specularGliTex  = prefilterCubemapGGX(inputGliTex, 10);
-  mTextures.push_back(uploadCubemap(specularGliTex));
-
-  buildMeshes(gltf);
-
-  // reset current viewport
-  glViewport(current_viewport[0], current_viewport[1], current_viewport[2], current_viewport[3]);
-  glScissor(current_viewport[0], current_viewport[1], current_viewport[2], current_viewport[3]);
+  mTextures.push_back(mEnvironmentMaps->specular);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1291,6 +1536,15 @@ void Mesh::draw(glm::mat4 const& projMat, glm::mat4 const& viewMat, glm::mat4 co
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void Mesh::drawInstanced(glm::mat4 const& viewProjMat, glm::mat4 const& nodeMat,
+    glm::vec3 const& eye, GltfShared const& shared, int instanceCount) const {
+  for (auto const& p : primitives) {
+    p.drawInstanced(viewProjMat, nodeMat, eye, shared, instanceCount);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 VistaGltfNode::VistaGltfNode(tinygltf::Node const& node, std::shared_ptr<GltfShared> shared)
     : mShared(std::move(shared))
     , mName(node.name)
@@ -1302,6 +1556,8 @@ VistaGltfNode::~VistaGltfNode() = default;
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 bool VistaGltfNode::Do() {
+  static const cs::utils::FrameStats::RangeId drawCalls("glTF Draw Calls");
+
   cs::utils::FrameStats::ScopedTimer             timer("VistaGltfNode");
   cs::utils::FrameStats::ScopedSamplesCounter    samplesCounter("VistaGltfNode");
   cs::utils::FrameStats::ScopedPrimitivesCounter primitivesCounter("VistaGltfNode");
@@ -1320,7 +1576,9 @@ bool VistaGltfNode::Do() {
   glDisable(GL_CULL_FACE);
 
   if (mMeshIndex >= 0 && mShared) {
-    mShared->mMeshes[mMeshIndex].draw(projMat, viewMat, modelMat, *mShared);
+    auto const& mesh = mShared->mMeshes[mMeshIndex];
+    mesh.draw(projMat, viewMat, modelMat, *mShared);
+    cs::utils::FrameStats::get().addValue(drawCalls, static_cast<int64_t>(mesh.primitives.size()));
   }
 
   glEnable(GL_CULL_FACE);
@@ -1342,4 +1600,90 @@ bool VistaGltfNode::GetBoundingBox(VistaBoundingBox& bb) {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+VistaGltfInstancedNode::VistaGltfInstancedNode(
+    std::vector<MeshNode> meshNodes, std::shared_ptr<GltfShared> shared)
+    : mMeshNodes(std::move(meshNodes))
+    , mShared(std::move(shared)) {
+}
+
+VistaGltfInstancedNode::~VistaGltfInstancedNode() = default;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool VistaGltfInstancedNode::Do() {
+  static const cs::utils::FrameStats::RangeId drawCalls("glTF Draw Calls");
+
+  cs::utils::FrameStats::ScopedTimer             timer("VistaGltfInstancedNode");
+  cs::utils::FrameStats::ScopedSamplesCounter    samplesCounter("VistaGltfInstancedNode");
+  cs::utils::FrameStats::ScopedPrimitivesCounter primitivesCounter("VistaGltfInstancedNode");
+
+  if (mShared->mInstances.empty()) {
+    return true;
+  }
+
+  if (!mShared->mInstanceBuffer) {
+    mShared->mInstanceBuffer = std::shared_ptr<GLuint>(new GLuint(0), [](GLuint* ptr) {
+      if (*ptr != 0u) {
+        glDeleteBuffers(1, ptr);
+      }
+    });
+    glGenBuffers(1, mShared->mInstanceBuffer.get());
+  }
+
+  // The instances are uploaded at most once per frame, even if Do() is called once per eye.
+  if (mShared->mInstancesDirty) {
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, *mShared->mInstanceBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER,
+        static_cast<GLsizeiptr>(mShared->mInstances.size() * sizeof(InstanceData)),
+        mShared->mInstances.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    mShared->mInstancesDirty = false;
+  }
+
+  // All instance transformations are relative to the parent of this node. Therefore we do all
+  // computations in the coordinate system of the parent.
+  std::array<GLfloat, 16> glMat{};
+  glGetFloatv(GL_MODELVIEW_MATRIX, glMat.data());
+  glm::mat4 modelViewMat = glm::make_mat4(glMat.data());
+
+  glGetFloatv(GL_PROJECTION_MATRIX, glMat.data());
+  glm::mat4 projMat     = glm::make_mat4(glMat.data());
+  glm::mat4 viewProjMat = projMat * modelViewMat;
+  glm::vec3 eye         = glm::vec3(glm::inverse(modelViewMat)[3]);
+
+  auto instanceCount = static_cast<int>(mShared->mInstances.size());
+
+  glDisable(GL_CULL_FACE);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, *mShared->mInstanceBuffer);
+
+  for (auto const& node : mMeshNodes) {
+    auto const& mesh = mShared->mInstancedMeshes[node.meshIndex];
+    mesh.drawInstanced(viewProjMat, node.transform, eye, *mShared, instanceCount);
+    cs::utils::FrameStats::get().addValue(drawCalls, static_cast<int64_t>(mesh.primitives.size()));
+  }
+
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+  glEnable(GL_CULL_FACE);
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool VistaGltfInstancedNode::GetBoundingBox(VistaBoundingBox& bb) {
+  auto const& minPos = mShared->mInstancesMinPos;
+  auto const& maxPos = mShared->mInstancesMaxPos;
+
+  // Without valid bounds, the node must not be culled.
+  if (!mShared->mHasSceneBounds || glm::any(glm::greaterThan(minPos, maxPos))) {
+    return false;
+  }
+
+  bb.SetBounds(glm::value_ptr(minPos), glm::value_ptr(maxPos));
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 } // namespace cs::graphics::internal
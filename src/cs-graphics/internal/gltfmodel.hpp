@@ -13,6 +13,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <memory>
 #include <tiny_gltf.h>
@@ -60,6 +61,11 @@ struct GLProgramInfo {
   int u_ModelMatrix_loc{};
   int u_NormalMatrix_loc{};
 
+  // Only used by the instanced variant of the shader
+  int u_ViewProjectionMatrix_loc{};
+  int u_NodeMatrix_loc{};
+  int u_NodeNormalMatrix_loc{};
+
   // Fragmentshader
   int u_LightDirection_loc{};
   int u_LightColor_loc{};
@@ -106,6 +112,13 @@ struct Primitive {
   void draw(glm::mat4 const& projMat, glm::mat4 const& viewMat, glm::mat4 const& modelMat,
       GltfShared const& shared) const;
 
+  /// Draws the vertex array once for each instance in the instance buffer of the given shared
+  /// state, which has to be bound to GL_SHADER_STORAGE_BUFFER binding point zero. The primitive
+  /// must have been created for instancing. All matrices are relative to the parent node of the
+  /// instances; nodeMat is the transformation of the glTF node containing this primitive.
+  void drawInstanced(glm::mat4 const& viewProjMat, glm::mat4 const& nodeMat, glm::vec3 const& eye,
+      GltfShared const& shared, int instanceCount) const;
+
   bool hasIndices = false;  ///< Determines if glDrawElements or glDrawArrays will be called.
   int  mode       = 0x0004; ///< GL_TRIANGLES;
 
@@ -123,12 +136,19 @@ struct Primitive {
   std::vector<std::pair<Texture, TextureVar>> textures;
   std::shared_ptr<unsigned int>               vaoPtr;
   std::shared_ptr<unsigned int>               programPtr;
+
+ private:
+  void bindMaterial(glm::vec3 const& eye, GltfShared const& shared) const;
+  void unbindMaterial() const;
+  void drawVertexArray(int instanceCount) const;
 };
 
 /// Manages all primitives belonging to a mesh.
 struct Mesh {
   void draw(glm::mat4 const& projMat, glm::mat4 const& viewMat, glm::mat4 const& modelMat,
       GltfShared const& shared) const;
+  void drawInstanced(glm::mat4 const& viewProjMat, glm::mat4 const& nodeMat, glm::vec3 const& eye,
+      GltfShared const& shared, int instanceCount) const;
 
   /// All primitives belonging to the model.
   std::vector<Primitive> primitives;
@@ -138,13 +158,42 @@ struct Mesh {
   glm::vec3 maxPos = glm::vec3(std::numeric_limits<float>::max());
 };
 
+/// The textures used for image-based lighting. They only depend on the environment map, so they
+/// are shared by all models which use the same environment map.
+struct EnvironmentMaps {
+  Texture brdfLUT;  ///< The BRDF lookup table. This is shared by all environment maps.
+  Texture diffuse;  ///< The irradiance cubemap.
+  Texture specular; ///< The GGX-prefiltered cubemap, one mipmap level per roughness step.
+};
+
+/// Returns the image-based lighting textures for the given cubemap. If they are still used by
+/// another model, the same textures are returned. Else they are loaded from the cache directory or,
+/// if they are not cached yet, computed on the GPU and written to the cache directory. The cache
+/// is content-addressed, so it is invalidated automatically if the cubemap or the filtering
+/// parameters change. No files are read or written if cacheDirectory is empty. This has to be
+/// called on the main thread, as it requires an OpenGL context.
+std::shared_ptr<EnvironmentMaps const> getEnvironmentMaps(
+    std::string const& cubemapFilepath, std::string const& cacheDirectory);
+
+/// The per-instance data of instanced models as it is stored in the shader storage buffer. The
+/// layout has to match the Instance struct of the vertex shader.
+struct InstanceData {
+  glm::mat4 modelMatrix;  ///< The transformation of the instance.
+  glm::mat4 normalMatrix; ///< The inverse transpose of the upper 3x3 part of modelMatrix.
+  glm::vec4 light;        ///< The direction towards the light (xyz) and its intensity (w).
+};
+
 /// Represents a GLTF model.
 struct GltfShared {
-  void init(tinygltf::Model const& gltf, const std::string& cubemapFilepath);
+  void init(tinygltf::Model const& gltf, std::shared_ptr<EnvironmentMaps const> environmentMaps);
+
+  /// Creates mMeshes or, if instanced is set, mInstancedMeshes. The latter use shader programs
+  /// which read their transformations from the instance buffer.
+  void buildMeshes(tinygltf::Model const& gltf, bool instanced);
 
  private:
-  void      buildMeshes(tinygltf::Model const& gltf);
-  Primitive createMeshPrimitive(tinygltf::Model const& gltf, tinygltf::Primitive const& primitive);
+  Primitive createMeshPrimitive(
+      tinygltf::Model const& gltf, tinygltf::Primitive const& primitive, bool instanced);
 
  public:
   glm::vec3            m_lightColor     = glm::vec3(0.0F, 0.0F, 0.0F);
@@ -156,9 +205,29 @@ struct GltfShared {
   tinygltf::Model      mTinyGltfModel;
   std::vector<Texture> mTextures;
   std::vector<Mesh>    mMeshes;
+  std::vector<Mesh>    mInstancedMeshes;
   int                  mBrdfLUTindex        = -1;
   int                  mDiffuseEnvMapIndex  = -1;
   int                  mSpecularEnvMapIndex = -1;
+
+  std::shared_ptr<EnvironmentMaps const> mEnvironmentMaps;
+
+  /// The instances drawn by VistaGltfInstancedNode. mInstancesDirty is set whenever they have to be
+  /// uploaded to mInstanceBuffer again.
+  std::vector<InstanceData>     mInstances;
+  std::shared_ptr<unsigned int> mInstanceBuffer;
+  bool                          mInstancesDirty = false;
+
+  /// The bounds of all meshes of the default scene including their node transformations. They are
+  /// computed by GltfLoader::attachInstancedTo(). mHasSceneBounds is false if a mesh has no bounds.
+  glm::vec3 mSceneMinPos    = glm::vec3(std::numeric_limits<float>::max());
+  glm::vec3 mSceneMaxPos    = glm::vec3(std::numeric_limits<float>::lowest());
+  bool      mHasSceneBounds = false;
+
+  /// The union of the scene bounds transformed by all instances. They are computed by
+  /// GltfLoader::setInstances(). If there are no instances, the minimum is larger than the maximum.
+  glm::vec3 mInstancesMinPos = glm::vec3(std::numeric_limits<float>::max());
+  glm::vec3 mInstancesMaxPos = glm::vec3(std::numeric_limits<float>::lowest());
 };
 
 /// A Vista wrapper for the GLTF model responsible for rendering.
@@ -187,6 +256,37 @@ class VistaGltfNode : public IVistaOpenGLDraw {
   glm::vec3                   mMaxPos = glm::vec3(std::numeric_limits<float>::max());
 };
 
+/// A Vista wrapper which draws all meshes of the default scene of a GLTF model once for each
+/// instance in GltfShared::mInstances. There is one instanced draw call per primitive, regardless
+/// of the number of instances.
+class VistaGltfInstancedNode : public IVistaOpenGLDraw {
+ public:
+  /// One node of the default scene which contains a mesh.
+  struct MeshNode {
+    int       meshIndex;
+    glm::mat4 transform; ///< The transformation relative to the root of the scene.
+  };
+
+  VistaGltfInstancedNode(std::vector<MeshNode> meshNodes, std::shared_ptr<GltfShared> shared);
+  ~VistaGltfInstancedNode() override;
+
+  VistaGltfInstancedNode(VistaGltfInstancedNode const& other) = delete;
+  VistaGltfInstancedNode(VistaGltfInstancedNode&& other)      = delete;
+
+  VistaGltfInstancedNode& operator=(VistaGltfInstancedNode const& other) = delete;
+  VistaGltfInstancedNode& operator=(VistaGltfInstancedNode&& other)      = delete;
+
+  /// The method Do() gets the callback from scene graph during the rendering process.
+  bool Do() override;
+
+  /// This method should return the bounding box of the OpenGL object you draw in the method Do().
+  bool GetBoundingBox(VistaBoundingBox& bb) override;
+
+ private:
+  std::vector<MeshNode>       mMeshNodes;
+  std::shared_ptr<GltfShared> mShared;
+};
+
 } // namespace cs::graphics::internal
 
 #endif // CS_GRAPHICS_GLTFMODEL_HPP
@@ -32,8 +32,19 @@ const char* GLTF_FRAG = R"(
 
 out vec4 FragColor;
 
-uniform vec3 u_LightDirection;
 uniform vec3 u_LightColor;
+
+#ifdef USE_INSTANCING
+// The direction towards the light and its intensity are given per instance.
+flat in vec4 v_Light;
+#define LIGHT_DIRECTION v_Light.xyz
+#define LIGHT_COLOR (u_LightColor * v_Light.w)
+#else
+uniform vec3 u_LightDirection;
+#define LIGHT_DIRECTION u_LightDirection
+#define LIGHT_COLOR u_LightColor
+#endif
+
 uniform bool u_EnableHDR;
 
 #ifdef USE_IBL
@@ -270,7 +281,7 @@ void main()
     vec3 V = normalize(E - P);           // Vector from surface point to camera
     vec3 R = -normalize(reflect(V, N));
 
-    vec3 L = normalize(u_LightDirection);             // Vector from surface point to light
+    vec3 L = normalize(LIGHT_DIRECTION);              // Vector from surface point to light
     vec3 H = normalize(L + V);                        // Half vector between both L and V
 
     // we divide by NdotL in GGX_V1
@@ -295,7 +306,7 @@ void main()
     vec3 diffuse = lambert(diffuseColor);
     vec3 D_Vis = vec3(G * D / (4.0 * NdotL * NdotV));
     vec3 brdf = mix(diffuse, D_Vis, F);
-    vec3 color = u_LightColor * brdf * NdotL;
+    vec3 color = LIGHT_COLOR * brdf * NdotL;
 
     // Calculate lighting contribution from image based lighting source (IBL)
 #ifdef USE_IBL
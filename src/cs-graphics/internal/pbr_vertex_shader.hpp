@@ -22,12 +22,32 @@ in vec4 a_Tangent;
 in vec2 a_UV;
 #endif
 
+#ifdef USE_INSTANCING
+// The per-instance data, see GltfInstance. The instance transform is applied after the transform of
+// the glTF node, the light is given as direction and intensity.
+struct Instance {
+  mat4 modelMatrix;
+  mat4 normalMatrix;
+  vec4 light;
+};
+
+layout(std430, binding = 0) readonly buffer InstanceBuffer {
+  Instance u_Instances[];
+};
+
+uniform mat4 u_ViewProjectionMatrix;
+uniform mat4 u_NodeMatrix;
+uniform mat3 u_NodeNormalMatrix;
+
+flat out vec4 v_Light;
+#else
 uniform mat4 u_MVPMatrix;
 
 uniform mat4 u_ModelMatrix;
 //uniform mat4 u_ViewMatrix;
 //uniform mat4 u_ProjectionMatrix;
 uniform mat3 u_NormalMatrix;
+#endif
 
 out vec3 v_Position;
 out vec2 v_UV;
@@ -42,17 +62,29 @@ out vec3 v_Normal;
 
 void main()
 {
-  vec4 pos = u_ModelMatrix * a_Position;
+  #ifdef USE_INSTANCING
+  Instance instance = u_Instances[gl_InstanceID];
+  mat4 modelMatrix  = instance.modelMatrix * u_NodeMatrix;
+  mat3 normalMatrix = mat3(instance.normalMatrix) * u_NodeNormalMatrix;
+  mat4 mvpMatrix    = u_ViewProjectionMatrix * modelMatrix;
+  v_Light           = instance.light;
+  #else
+  mat4 modelMatrix  = u_ModelMatrix;
+  mat3 normalMatrix = u_NormalMatrix;
+  mat4 mvpMatrix    = u_MVPMatrix;
+  #endif
+
+  vec4 pos = modelMatrix * a_Position;
   v_Position = vec3(pos.xyz) / pos.w;
 
   #ifdef HAS_NORMALS
   #ifdef HAS_TANGENTS
-  vec3 normalW = normalize(u_NormalMatrix * a_Normal);
-  vec3 tangentW = normalize(u_NormalMatrix * a_Tangent.xyz);
+  vec3 normalW = normalize(normalMatrix * a_Normal);
+  vec3 tangentW = normalize(normalMatrix * a_Tangent.xyz);
   vec3 bitangentW = cross(normalW, tangentW) * a_Tangent.w;
   v_TBN = mat3(tangentW, bitangentW, normalW);
   #else // HAS_TANGENTS != 1
-  v_Normal = normalize(u_NormalMatrix * a_Normal);
+  v_Normal = normalize(normalMatrix * a_Normal);
   #endif
   #endif
 
@@ -62,7 +94,7 @@ void main()
   v_UV = vec2(0.0);
   #endif
 
-  gl_Position = u_MVPMatrix * a_Position; // needs w for proper perspective correction
+  gl_Position = mvpMatrix * a_Position; // needs w for proper perspective correction
 }
 
 )";
@@ -9,10 +9,94 @@
 
 #include "GuiArea.hpp"
 
+#include "../cs-utils/FrameStats.hpp"
+
 #include <VistaOGLExt/VistaTexture.h>
 
+#include <algorithm>
+#include <limits>
+
 namespace cs::gui {
 
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int64_t getArea(Rect const& rect) {
+  return static_cast<int64_t>(rect.mWidth) * rect.mHeight;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+Rect getUnion(Rect const& a, Rect const& b) {
+  int minX = std::min(a.mX, b.mX);
+  int minY = std::min(a.mY, b.mY);
+  int maxX = std::max(a.mX + a.mWidth, b.mX + b.mWidth);
+  int maxY = std::max(a.mY + a.mHeight, b.mY + b.mHeight);
+  return {minX, minY, maxX - minX, maxY - minY};
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Adds the given rectangle to the list of dirty rectangles. It is clamped to the texture size and
+// merged with existing rectangles if the union does not cover more pixels than the individual
+// rectangles. If there are more than maxRects rectangles afterwards, the pair whose union adds the
+// fewest pixels is merged until the limit is met.
+void addDirtyRect(std::vector<Rect>& rects, Rect rect, int width, int height, size_t maxRects) {
+  int minX = std::clamp(rect.mX, 0, width);
+  int minY = std::clamp(rect.mY, 0, height);
+  int maxX = std::clamp(rect.mX + rect.mWidth, 0, width);
+  int maxY = std::clamp(rect.mY + rect.mHeight, 0, height);
+
+  if (maxX <= minX || maxY <= minY) {
+    return;
+  }
+
+  rect = {minX, minY, maxX - minX, maxY - minY};
+
+  // Merging may enable further merges, so we repeat this until nothing changes.
+  bool merged = true;
+  while (merged) {
+    merged = false;
+    for (auto it = rects.begin(); it != rects.end(); ++it) {
+      Rect combined = getUnion(rect, *it);
+      if (getArea(combined) <= getArea(rect) + getArea(*it)) {
+        rect = combined;
+        rects.erase(it);
+        merged = true;
+        break;
+      }
+    }
+  }
+
+  rects.push_back(rect);
+
+  while (rects.size() > maxRects) {
+    size_t  bestA    = 0;
+    size_t  bestB    = 1;
+    int64_t bestCost = std::numeric_limits<int64_t>::max();
+
+    for (size_t a = 0; a < rects.size(); ++a) {
+      for (size_t b = a + 1; b < rects.size(); ++b) {
+        int64_t cost =
+            getArea(getUnion(rects[a], rects[b])) - getArea(rects[a]) - getArea(rects[b]);
+        if (cost < bestCost) {
+          bestA    = a;
+          bestB    = b;
+          bestCost = cost;
+        }
+      }
+    }
+
+    rects[bestA] = getUnion(rects[bestA], rects[bestB]);
+    rects.erase(rects.begin() + static_cast<std::ptrdiff_t>(bestB));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 GuiItem::GuiItem(std::string const& url, bool allowLocalFileAccess)
@@ -39,8 +123,6 @@ GuiItem::GuiItem(std::string const& url, bool allowLocalFileAccess)
     , mIsRelOffsetY(true) {
 
   setDrawCallback([this](DrawEvent const& event) {
-    mPBOsNeedUpload = static_cast<uint8_t>(mTexturePBOs.size());
-
     if (event.mResized) {
       mTextureSizeX = event.mWidth;
       mTextureSizeY = event.mHeight;
@@ -48,6 +130,10 @@ GuiItem::GuiItem(std::string const& url, bool allowLocalFileAccess)
       recreateBuffers();
     }
 
+    for (auto const& rect : event.mDirtyRects) {
+      addDirtyRect(mDirtyRects, rect, mTextureSizeX, mTextureSizeY, cMaxDirtyRects);
+    }
+
     return mPixels.data();
   });
 
@@ -227,28 +313,73 @@ void GuiItem::onAreaResize(int width, int height) {
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 uint32_t GuiItem::getTexture() const {
+  static const utils::FrameStats::RangeId uploadedBytes("GUI Upload (Bytes)");
+
+  size_t previousPBO   = (mCurrentPBO + mTexturePBOs.size() - 1) % mTexturePBOs.size();
+  auto&  currentRects  = mPBOUploadRects[mCurrentPBO];
+  auto&  previousRects = mPBOUploadRects[previousPBO];
 
-  // Copy the pixels buffer to the texture.
-  if (mPBOsNeedUpload > 0) {
+  if (mDirtyRects.empty() && previousRects.empty()) {
+    return mTexture;
+  }
 
+  // The dirty areas are stored in the PBO at the same position as in the pixel buffer. This way,
+  // they can be uploaded with the row length of the entire texture.
+  size_t rowSize = 4 * mTextureSizeX;
+
+  // Copy the dirty areas of the pixel buffer to the current PBO. As the PBO only needs to contain
+  // these areas, its previous content can be discarded.
+  if (!mDirtyRects.empty()) {
     glBindBuffer(GL_PIXEL_UNPACK_BUFFER, mTexturePBOs[mCurrentPBO]);
-    auto ptr = static_cast<uint8_t*>(glMapBufferRange(
-        GL_PIXEL_UNPACK_BUFFER, 0, 4 * mTextureSizeX * mTextureSizeY, GL_MAP_WRITE_BIT));
-    std::memcpy(ptr, mPixels.data(), 4 * mTextureSizeX * mTextureSizeY);
+    auto* ptr = static_cast<uint8_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0,
+        rowSize * mTextureSizeY, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+
+    for (auto const& rect : mDirtyRects) {
+      size_t offset = rect.mY * rowSize + 4 * rect.mX;
+
+      if (rect.mWidth == mTextureSizeX) {
+        std::memcpy(ptr + offset, mPixels.data() + offset, rect.mHeight * rowSize);
+      } else {
+        for (int i = 0; i < rect.mHeight; ++i) {
+          std::memcpy(ptr + offset + i * rowSize, mPixels.data() + offset + i * rowSize,
+              4 * rect.mWidth);
+        }
+      }
+    }
+
     glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    currentRects = std::move(mDirtyRects);
+    mDirtyRects.clear();
+  }
+
+  // Upload the areas which were copied to the other PBO in the previous call.
+  if (!previousRects.empty()) {
+    int64_t bytes = 0;
 
     glBindTexture(GL_TEXTURE_2D, mTexture);
-    glBindBuffer(GL_PIXEL_UNPACK_BUFFER,
-        mTexturePBOs[(mCurrentPBO + mTexturePBOs.size() - 1) % mTexturePBOs.size()]);
-    glTexSubImage2D(
-        GL_TEXTURE_2D, 0, 0, 0, mTextureSizeX, mTextureSizeY, GL_BGRA, GL_UNSIGNED_BYTE, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, mTexturePBOs[previousPBO]);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, mTextureSizeX);
+
+    for (auto const& rect : previousRects) {
+      size_t offset = rect.mY * rowSize + 4 * rect.mX;
+      glTexSubImage2D(GL_TEXTURE_2D, 0, rect.mX, rect.mY, rect.mWidth, rect.mHeight, GL_BGRA,
+          GL_UNSIGNED_BYTE, reinterpret_cast<void*>(offset)); // NOLINT: PBO offset.
+      bytes += 4 * getArea(rect);
+    }
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
     glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
     glBindTexture(GL_TEXTURE_2D, 0);
 
-    mCurrentPBO = (mCurrentPBO + 1) % mTexturePBOs.size();
-    mPBOsNeedUpload -= 1;
+    previousRects.clear();
+
+    utils::FrameStats::get().addValue(uploadedBytes, bytes);
   }
 
+  mCurrentPBO = (mCurrentPBO + 1) % mTexturePBOs.size();
+
   return mTexture;
 }
 
@@ -279,6 +410,13 @@ void GuiItem::recreateBuffers() {
   glBindTexture(GL_TEXTURE_2D, 0);
 
   mPixels.resize(4 * mTextureSizeX * mTextureSizeY);
+
+  // The new texture has no content yet, so everything will be uploaded.
+  mDirtyRects.clear();
+  for (auto& rects : mPBOUploadRects) {
+    rects.clear();
+  }
+  mDirtyRects.push_back({0, 0, mTextureSizeX, mTextureSizeY});
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -84,9 +84,13 @@ class CS_GUI_EXPORT GuiItem : public WebView {
   /// Gets called, when the parent GuiArea changes size.
   void onAreaResize(int width, int height);
 
-  /// @return The current HTML output as an OpenGL texture.
+  /// @return The current HTML output as an OpenGL texture. Only the areas which changed since the
+  /// last call are uploaded to the GPU.
   uint32_t getTexture() const;
 
+  /// The dirty areas are merged so that at most this many rectangles are uploaded per PBO.
+  static constexpr size_t cMaxDirtyRects = 8;
+
  private:
   void recreateBuffers();
   void updateSizes();
@@ -94,8 +98,12 @@ class CS_GUI_EXPORT GuiItem : public WebView {
   std::vector<uint8_t>    mPixels;
   uint32_t                mTexture = 0;
   std::array<uint32_t, 2> mTexturePBOs;
-  mutable uint8_t         mCurrentPBO     = 0;
-  mutable uint8_t         mPBOsNeedUpload = 0;
+  mutable uint8_t         mCurrentPBO = 0;
+
+  // The areas which changed since they were last copied to a PBO and the areas which each PBO
+  // contains and which still have to be uploaded to the texture.
+  mutable std::vector<Rect>                mDirtyRects;
+  mutable std::array<std::vector<Rect>, 2> mPBOUploadRects;
 
   // in pixels
   int mTextureSizeX = 0;
@@ -9,11 +9,24 @@
 
 #include "internal/WebViewClient.hpp"
 
+#include "../cs-utils/FrameStats.hpp"
+
 #include <include/cef_app.h>
 #include <thread>
+#include <unordered_set>
 
 namespace cs::gui {
 
+namespace {
+
+// All existing WebViews. This is only accessed from the main thread.
+std::unordered_set<WebView*>& getWebViews() {
+  static std::unordered_set<WebView*> webViews;
+  return webViews;
+}
+
+} // namespace
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 class DevToolsClient : public CefClient {
@@ -39,17 +52,23 @@ WebView::WebView(const std::string& url, int width, int height, bool allowLocalF
 
   CefBrowserSettings browserSettings;
 
-  int const targetFrameRate             = 60;
-  browserSettings.windowless_frame_rate = targetFrameRate;
+  browserSettings.windowless_frame_rate = cActiveFrameRate;
   browserSettings.web_security          = allowLocalFileAccess ? STATE_DISABLED : STATE_ENABLED;
 
   mBrowser =
       CefBrowserHost::CreateBrowserSync(info, mClient, url, browserSettings, nullptr, nullptr);
+
+  mLastActivity    = std::chrono::steady_clock::now();
+  mPaintCountStart = mLastActivity;
+
+  getWebViews().insert(this);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 WebView::~WebView() {
+  getWebViews().erase(this);
+
   auto host = mBrowser->GetHost();
   while (!host->TryCloseBrowser()) {
     CefDoMessageLoopWork();
@@ -84,6 +103,7 @@ void WebView::resize(int width, int height) const {
   mClient->GetInternalRenderHandler()->Resize(width, height);
 
   if (mBrowser) {
+    markActive();
     mBrowser->GetHost()->WasResized();
   }
 }
@@ -247,6 +267,7 @@ void WebView::selectAll() const {
 
 void WebView::injectFocusEvent(bool focus) {
   if (mInteractive) {
+    markActive();
     mBrowser->GetHost()->SendFocusEvent(focus);
   }
 }
@@ -258,6 +279,8 @@ void WebView::injectMouseEvent(MouseEvent const& event) {
     return;
   }
 
+  markActive();
+
   CefMouseEvent cef_event;
   cef_event.modifiers = static_cast<uint32>(mMouseModifiers);
   cef_event.x         = mMouseX;
@@ -354,6 +377,8 @@ void WebView::callJavascriptImpl(
   }
   call.back() = ')';
 
+  markActive();
+
   CefRefPtr<CefFrame> frame = mBrowser->GetMainFrame();
   frame->ExecuteJavaScript(call, frame->GetURL(), 0);
 }
@@ -361,12 +386,119 @@ void WebView::callJavascriptImpl(
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void WebView::executeJavascript(std::string const& code) const {
+  markActive();
+
   CefRefPtr<CefFrame> frame = mBrowser->GetMainFrame();
   frame->ExecuteJavaScript(code, frame->GetURL(), 0);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void WebView::queueJavascriptImpl(
+    std::string const& function, std::vector<std::string>&& args) const {
+  mQueuedCalls.emplace_back(function, std::move(args));
+  ++mQueuedCount;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void WebView::queueState(std::string const& key, std::string const& value) const {
+  mQueuedState[key] = value;
+  ++mQueuedCount;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void WebView::flushJavascript() const {
+  static const utils::FrameStats::RangeId coalescedCalls("JavaScript Calls Coalesced");
+
+  if (mQueuedCount == 0) {
+    return;
+  }
+
+  // The message has the form window.dispatchBatch({key: value, ...}, [[function, [args]], ...]).
+  // The dispatcher is defined in internal/RenderProcessHandler.cpp.
+  std::string message = "window.dispatchBatch({";
+
+  for (auto const& [key, value] : mQueuedState) {
+    message += utils::toString(key) + ":" + value + ",";
+  }
+
+  message += "},[";
+
+  for (auto const& [function, args] : mQueuedCalls) {
+    message += "[" + utils::toString(function) + ",[";
+    for (auto const& arg : args) {
+      message += arg + ",";
+    }
+    message += "]],";
+  }
+
+  message += "]);";
+
+  CefRefPtr<CefFrame> frame = mBrowser->GetMainFrame();
+  frame->ExecuteJavaScript(message, frame->GetURL(), 0);
+
+  // All queued items have been sent with one message.
+  utils::FrameStats::get().addValue(coalescedCalls, mQueuedCount - 1);
+
+  mQueuedCalls.clear();
+  mQueuedState.clear();
+  mQueuedCount = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void WebView::updateAll() {
+  for (auto* webView : getWebViews()) {
+    webView->update();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool WebView::getIsIdle() const {
+  return mIsIdle;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void WebView::update() {
+  flushJavascript();
+
+  auto now = std::chrono::steady_clock::now();
+
+  if (now - mPaintCountStart < cIdleTimeout) {
+    return;
+  }
+
+  // Count the paints since the last check.
+  auto paintCount  = mClient->GetInternalRenderHandler()->GetPaintCount();
+  auto paints      = paintCount - mPaintCount;
+  mPaintCount      = paintCount;
+  mPaintCountStart = now;
+
+  bool idle = now - mLastActivity >= cIdleTimeout && paints < cIdlePaintCount;
+
+  if (idle != mIsIdle) {
+    mIsIdle = idle;
+    mBrowser->GetHost()->SetWindowlessFrameRate(idle ? cIdleFrameRate : cActiveFrameRate);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void WebView::markActive() const {
+  mLastActivity = std::chrono::steady_clock::now();
+
+  if (mIsIdle) {
+    mIsIdle = false;
+    mBrowser->GetHost()->SetWindowlessFrameRate(cActiveFrameRate);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 void WebView::registerCallback(
     std::string const& name, std::string const& comment, std::function<void()> const& callback) {
   registerJSCallbackImpl(name, comment, {},
@@ -16,6 +16,7 @@
 #include <chrono>
 #include <include/cef_client.h>
 #include <iostream>
+#include <map>
 #include <optional>
 #include <typeindex>
 
@@ -67,6 +68,52 @@ class CS_GUI_EXPORT WebView {
   /// Execute Javascript code.
   void executeJavascript(std::string const& code) const;
 
+  /// Like callJavascript(), but the call is not sent to the page immediately. All calls and state
+  /// updates which are queued during a frame are sent in one message when flushJavascript() is
+  /// called. This avoids the overhead of sending and parsing many small snippets of code every
+  /// frame. The calls are executed in the order in which they were queued.
+  ///
+  /// @param function The name of the function. It has to be reachable from the global scope.
+  /// @param a        The arguments of the function. See callJavascript() for details.
+  template <typename... Args>
+  void queueJavascript(std::string const& function, Args&&... a) const {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-array-to-pointer-decay)
+    std::vector<std::string> args = {(utils::toString(a))...};
+    queueJavascriptImpl(function, std::move(args));
+  }
+
+  /// Queues an assignment to CosmoScout.state[key]. If the same key is set multiple times before
+  /// the next flush, only the last value is sent. The state is updated before the queued calls are
+  /// executed.
+  ///
+  /// @param key   The name of the state variable.
+  /// @param value A JavaScript expression, for example "[1, 2, 3]" or "undefined".
+  void queueState(std::string const& key, std::string const& value) const;
+
+  /// Sends all queued calls and state updates to the page. They are handled by a dispatcher which
+  /// is installed in every JavaScript context by the render process. The number of calls which
+  /// were saved by this is reported as "JavaScript Calls Coalesced" to the FrameStats.
+  void flushJavascript() const;
+
+  /// Calls flushJavascript() on all WebViews and adapts their frame rate to their paint activity.
+  /// This is done once each frame by cs::gui::update(), so usually there is no need to call this
+  /// manually. This must only be called from the main thread.
+  static void updateAll();
+
+  /// While a page is idle, it is rendered with cIdleFrameRate instead of cActiveFrameRate. A page
+  /// becomes idle if there was no input and no call to callJavascript() or executeJavascript() for
+  /// cIdleTimeout and if it painted less than cIdlePaintCount times during this period. Queued
+  /// calls do not count as activity, as they are usually sent every frame. Any input or direct
+  /// JavaScript call immediately restores the active frame rate. So does a page which keeps
+  /// painting while idle, for example because of an animation.
+  static constexpr int                       cActiveFrameRate = 60;
+  static constexpr int                       cIdleFrameRate   = 5;
+  static constexpr uint64_t                  cIdlePaintCount  = 2;
+  static constexpr std::chrono::milliseconds cIdleTimeout{1000};
+
+  /// Returns true if the page is currently rendered with the reduced frame rate.
+  bool getIsIdle() const;
+
   /// Register a callback which can be called from Javascript with the
   /// "window.callNative('callback_name', ... args ...)" function. Callbacks are also registered as
   /// CosmoScout.callbacks.callback_name(... args ...). For the latter to work, the WebView has to
@@ -250,7 +297,11 @@ class CS_GUI_EXPORT WebView {
         });
   }
 
+  void update();
+  void markActive() const;
+
   void callJavascriptImpl(std::string const& function, std::vector<std::string> const& args) const;
+  void queueJavascriptImpl(std::string const& function, std::vector<std::string>&& args) const;
   void registerJSCallbackImpl(std::string const& name, std::string const& comment,
       std::vector<std::type_index>&&                                   types,
       std::function<void(std::vector<std::optional<JSType>>&&)> const& callback);
@@ -258,6 +309,18 @@ class CS_GUI_EXPORT WebView {
   detail::WebViewClient* mClient;
   CefRefPtr<CefBrowser>  mBrowser;
 
+  // Calls and state updates which will be sent with the next flushJavascript(). The number of
+  // queued items is used to report how many messages were saved.
+  mutable std::vector<std::pair<std::string, std::vector<std::string>>> mQueuedCalls;
+  mutable std::map<std::string, std::string>                             mQueuedState;
+  mutable int64_t                                                        mQueuedCount = 0;
+
+  // Idle detection. The paint count is compared once per cIdleTimeout.
+  mutable bool                                  mIsIdle = false;
+  mutable std::chrono::steady_clock::time_point mLastActivity;
+  std::chrono::steady_clock::time_point         mPaintCountStart;
+  uint64_t                                      mPaintCount = 0;
+
   bool mInteractive = true;
   bool mCanScroll   = true;
 
@@ -72,6 +72,12 @@ int RenderHandler::GetHeight() const {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+uint64_t RenderHandler::GetPaintCount() const {
+  return mPaintCount;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 void RenderHandler::GetViewRect(CefRefPtr<CefBrowser> /*browser*/, CefRect& rect) {
   rect = CefRect(0, 0, mWidth, mHeight);
 }
@@ -80,6 +86,8 @@ void RenderHandler::GetViewRect(CefRefPtr<CefBrowser> /*browser*/, CefRect& rect
 
 void RenderHandler::OnPaint(CefRefPtr<CefBrowser> /*browser*/, PaintElementType /*type*/,
     RectList const& dirtyRects, const void* b, int width, int height) {
+  ++mPaintCount;
+
   DrawEvent event{};
   event.mResized  = width != mLastDrawWidth || height != mLastDrawHeight;
   mLastDrawWidth  = width;
@@ -90,6 +98,12 @@ void RenderHandler::OnPaint(CefRefPtr<CefBrowser> /*browser*/, PaintElementType
     event.mY      = 0;
     event.mWidth  = width;
     event.mHeight = height;
+    event.mDirtyRects.push_back({0, 0, width, height});
+  } else {
+    event.mDirtyRects.reserve(dirtyRects.size());
+    for (auto const& rect : dirtyRects) {
+      event.mDirtyRects.push_back({rect.x, rect.y, rect.width, rect.height});
+    }
   }
 
   mPixelData = mDrawCallback(event);
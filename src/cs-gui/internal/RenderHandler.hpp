@@ -32,6 +32,9 @@ class RenderHandler : public CefRenderHandler {
   int GetWidth() const;
   int GetHeight() const;
 
+  /// Returns the number of times OnPaint() has been called. This is used to detect idle pages.
+  uint64_t GetPaintCount() const;
+
   /// Gives the browser the available area for its view.
   void GetViewRect(CefRefPtr<CefBrowser> browser, CefRect& rect) override;
 
@@ -50,6 +53,8 @@ class RenderHandler : public CefRenderHandler {
   int mLastDrawWidth{};
   int mLastDrawHeight{};
 
+  uint64_t mPaintCount{};
+
   DrawCallback                 mDrawCallback;
   RequestKeyboardFocusCallback mRequestKeyboardFocusCallback;
 
@@ -11,6 +11,37 @@
 
 namespace cs::gui::detail {
 
+namespace {
+
+// This is called by WebView::flushJavascript() with all state updates and function calls which
+// were queued during one frame. The functions are given by name, so the first component of each
+// name has to be resolved in the global scope. As this may be a let or const binding which is not
+// a property of the window object, an indirect eval is used in this case.
+const char* const cDispatcherCode = R"(
+window.dispatchBatch = (state, calls) => {
+  const resolve = (name) => name in window ? window[name] : (0, eval)(name);
+
+  if (Object.keys(state).length > 0 && typeof CosmoScout !== 'undefined') {
+    Object.assign(CosmoScout.state, state);
+  }
+
+  for (const [name, args] of calls) {
+    try {
+      const path = name.split('.');
+      if (path.length === 1) {
+        resolve(name)(...args);
+      } else {
+        const method = path.pop();
+        const object = path.slice(1).reduce((a, b) => a[b], resolve(path[0]));
+        object[method](...args);
+      }
+    } catch (e) { console.error(`Failed to call ${name}: ${e.message}`); }
+  }
+};
+)";
+
+} // namespace
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void RenderProcessHandler::OnContextCreated(
@@ -19,6 +50,11 @@ void RenderProcessHandler::OnContextCreated(
   CefRefPtr<CefV8Value> object = context->GetGlobal();
   CefRefPtr<CefV8Value> func   = CefV8Value::CreateFunction("callNative", new JSHandler(browser));
   object->SetValue("callNative", func, V8_PROPERTY_ATTRIBUTE_NONE);
+
+  // Install the dispatcher for the JavaScript calls which are queued by the WebView.
+  CefRefPtr<CefV8Value>     result;
+  CefRefPtr<CefV8Exception> exception;
+  context->Eval(cDispatcherCode, "", 0, result, exception);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -18,14 +18,23 @@
 
 namespace cs::gui {
 
+/// An axis-aligned area of the GUI in pixels.
+struct CS_GUI_EXPORT Rect {
+  int mX;      ///< The x coordinate of the left edge.
+  int mY;      ///< The y coordinate of the top edge.
+  int mWidth;  ///< The width of the area.
+  int mHeight; ///< The height of the area.
+};
+
 /// Data describing the new state of a part of the GUI, when it changed.
 struct CS_GUI_EXPORT DrawEvent {
-  int            mX;       ///< The x coordinate of the redrawn area.
-  int            mY;       ///< The y coordinate of the redrawn area.
-  int            mWidth;   ///< The width of the redrawn area.
-  int            mHeight;  ///< The height of the redrawn area.
-  bool           mResized; ///< If the event was triggered by a resize.
-  const uint8_t* mData;    ///< The new pixel data of the redrawn area.
+  int               mX;          ///< The x coordinate of the redrawn area.
+  int               mY;          ///< The y coordinate of the redrawn area.
+  int               mWidth;      ///< The width of the redrawn area.
+  int               mHeight;     ///< The height of the redrawn area.
+  bool              mResized;    ///< If the event was triggered by a resize.
+  const uint8_t*    mData;       ///< The new pixel data of the redrawn area.
+  std::vector<Rect> mDirtyRects; ///< All areas which changed. Covers everything after a resize.
 };
 
 using DrawCallback = std::function<uint8_t*(const DrawEvent&)>;
@@ -22,8 +22,8 @@ class IntersectableObject;
 
 /// CelestialObjects are configured in the scene configuration file and instantiated by the Settings
 /// class. They are updated once each frame by the SolarSystem. Plugins can get references to
-/// CelestialObjects via SolarSystem::getObject() and retrieve their current observer-centric
-/// transformation each frame.
+/// CelestialObjects via SolarSystem::getObject() or SolarSystem::getObjectHandle() and retrieve
+/// their current observer-centric transformation each frame.
 /// CelestialObjects have a lifetime in the universe. They are defined by
 /// their start and end existence time. The time is given in the Barycentric Dynamical Time format,
 /// which is used throughout SPICE.
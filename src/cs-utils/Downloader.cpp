@@ -7,21 +7,293 @@
 
 #include "Downloader.hpp"
 
+#include "FrameStats.hpp"
 #include "filesystem.hpp"
 #include "logger.hpp"
 
+#include <boost/algorithm/string.hpp>
+#include <curlpp/Easy.hpp>
+#include <curlpp/Infos.hpp>
+#include <curlpp/Options.hpp>
+
+#include <atomic>
+#include <fstream>
+#include <list>
+
 namespace cs::utils {
 
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// The ETag and Last-Modified headers of a remote file. They are used to detect whether the file
+/// has changed on the server.
+struct Validators {
+  std::string mETag;
+  std::string mLastModified;
+
+  bool isEmpty() const {
+    return mETag.empty() && mLastModified.empty();
+  }
+
+  bool operator==(Validators const& other) const {
+    return mETag == other.mETag && mLastModified == other.mLastModified;
+  }
+
+  /// Returns a value suitable for an If-Range header. Weak ETags cannot be used for range
+  /// requests, in this case the Last-Modified date is used.
+  std::string getIfRange() const {
+    if (!mETag.empty() && !boost::algorithm::starts_with(mETag, "W/")) {
+      return mETag;
+    }
+    return mLastModified;
+  }
+};
+
+/// The validators are stored in a small text file with one line for each header.
+Validators loadValidators(std::string const& file) {
+  Validators    validators;
+  std::ifstream stream(file);
+  std::getline(stream, validators.mETag);
+  std::getline(stream, validators.mLastModified);
+  return validators;
+}
+
+void saveValidators(std::string const& file, Validators const& validators) {
+  std::ofstream stream(file);
+  stream << validators.mETag << std::endl << validators.mLastModified << std::endl;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// The relevant parts of the response headers of an HTTP request.
+struct ResponseInfo {
+  long                    mStatus = 0;
+  std::optional<uint64_t> mContentLength;
+  std::optional<uint64_t> mContentRangeTotal;
+  bool                    mAcceptRanges = false;
+  Validators              mValidators;
+};
+
+/// This is used as curlpp::options::HeaderFunction. It is called once for each header line.
+size_t parseHeader(ResponseInfo& info, char const* data, size_t length) {
+  std::string line(data, length);
+  boost::algorithm::trim(line);
+
+  // Each response starts with a status line like "HTTP/1.1 200 OK". If redirects are followed,
+  // there are several responses. Only the last one is relevant.
+  if (boost::algorithm::starts_with(line, "HTTP/")) {
+    info = ResponseInfo();
+
+    auto space = line.find(' ');
+    if (space != std::string::npos) {
+      info.mStatus = std::strtol(line.c_str() + space + 1, nullptr, 10);
+    }
+
+    return length;
+  }
+
+  auto colon = line.find(':');
+  if (colon == std::string::npos) {
+    return length;
+  }
+
+  auto key   = boost::algorithm::to_lower_copy(line.substr(0, colon));
+  auto value = boost::algorithm::trim_copy(line.substr(colon + 1));
+
+  if (key == "content-length") {
+    info.mContentLength = std::strtoull(value.c_str(), nullptr, 10);
+  } else if (key == "content-range") {
+    // This is either "bytes <first>-<last>/<total>" or "bytes */<total>". The total may be "*" if
+    // it is unknown to the server.
+    auto slash = value.rfind('/');
+    if (slash != std::string::npos && slash + 1 < value.size() && value[slash + 1] != '*') {
+      info.mContentRangeTotal = std::strtoull(value.c_str() + slash + 1, nullptr, 10);
+    }
+  } else if (key == "accept-ranges") {
+    info.mAcceptRanges = value == "bytes";
+  } else if (key == "etag") {
+    info.mValidators.mETag = value;
+  } else if (key == "last-modified") {
+    info.mValidators.mLastModified = value;
+  }
+
+  return length;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void setupRequest(curlpp::Easy& request, std::string const& url, ResponseInfo& info) {
+  request.setOpt(curlpp::options::Url(url));
+  request.setOpt(curlpp::options::NoSignal(true));
+  request.setOpt(curlpp::options::SslVerifyPeer(false));
+  request.setOpt(curlpp::options::FollowLocation(true));
+  request.setOpt(curlpp::options::HeaderFunction([&info](char* data, size_t size, size_t count) {
+    return parseHeader(info, data, size * count);
+  }));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Performs a HEAD request. If validators are given, they are sent as If-None-Match and
+/// If-Modified-Since headers, so the server will respond with 304 if the file has not changed.
+ResponseInfo requestHead(std::string const& url, Validators const& validators) {
+  ResponseInfo info;
+  curlpp::Easy request;
+  setupRequest(request, url, info);
+  request.setOpt(curlpp::options::NoBody(true));
+
+  std::list<std::string> headers;
+
+  if (!validators.mETag.empty()) {
+    headers.push_back("If-None-Match: " + validators.mETag);
+  }
+
+  if (!validators.mLastModified.empty()) {
+    headers.push_back("If-Modified-Since: " + validators.mLastModified);
+  }
+
+  if (!headers.empty()) {
+    request.setOpt(curlpp::options::HttpHeader(headers));
+  }
+
+  request.perform();
+
+  return info;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-Downloader::Downloader(size_t threadCount)
-    : mThreadPool(threadCount) {
+/// Performs a GET request for the bytes [first, last] of the remote file (or [first, end] if last
+/// is not given) and writes them to the destination file. If existing is larger than zero, the data
+/// is appended to the existing content of the file. If the server responds with the entire file
+/// instead (because it ignores the range or because the If-Range validator does not match anymore),
+/// the destination file is truncated. This is only allowed if no last byte is given, else an
+/// exception is thrown. onData is called with the number of bytes written to or removed from the
+/// destination file.
+ResponseInfo requestRange(std::string const& url, std::string const& destination, uint64_t first,
+    std::optional<uint64_t> last, uint64_t existing, std::string const& ifRange,
+    std::function<void(int64_t)> const& onData) {
+
+  ResponseInfo  info;
+  std::ofstream stream;
+  bool          rangeIgnored = false;
+
+  curlpp::Easy request;
+  setupRequest(request, url, info);
+
+  if (first > 0 || last) {
+    request.setOpt(curlpp::options::Range(
+        std::to_string(first) + "-" + (last ? std::to_string(*last) : std::string())));
+
+    if (!ifRange.empty()) {
+      request.setOpt(curlpp::options::HttpHeader({"If-Range: " + ifRange}));
+    }
+  }
+
+  request.setOpt(curlpp::options::WriteFunction([&](char* data, size_t size, size_t count) {
+    size_t length = size * count;
+
+    // The bodies of HTTP error responses are not written to the file. For other protocols like
+    // FTP, there is no status line, so mStatus remains zero.
+    if (info.mStatus != 0 && (info.mStatus < 200 || info.mStatus >= 300)) {
+      return length;
+    }
+
+    if (!stream.is_open()) {
+      bool append = existing > 0 && info.mStatus == 206;
+
+      if ((first > 0 || last) && info.mStatus != 206) {
+        // The server sent the entire file.
+        if (last) {
+          rangeIgnored = true;
+          return size_t(0);
+        }
+
+        onData(-static_cast<int64_t>(existing));
+      }
+
+      stream.open(destination, std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+
+      if (!stream) {
+        return size_t(0);
+      }
+    }
+
+    stream.write(data, static_cast<std::streamsize>(length));
+    onData(static_cast<int64_t>(length));
+
+    return stream ? length : size_t(0);
+  }));
+
+  try {
+    request.perform();
+  } catch (std::exception const&) {
+    if (rangeIgnored) {
+      throw std::runtime_error("The server did not respond with the requested range!");
+    }
+    throw;
+  }
+
+  // If everything up to the end of the file has been requested, a server responds with 416 if the
+  // existing data is complete already. In this case, the data is kept.
+  if (info.mStatus == 416 && existing > 0 && !last && info.mContentRangeTotal &&
+      *info.mContentRangeTotal == first) {
+    return info;
+  }
+
+  // Otherwise, the requested range does not exist. The partial data is most likely corrupt, so it
+  // is removed to start from scratch the next time.
+  if (info.mStatus == 416) {
+    stream.close();
+    boost::filesystem::remove(destination);
+  }
+
+  if (info.mStatus != 0 && info.mStatus != 200 && info.mStatus != 206) {
+    throw std::runtime_error("The server responded with status " + std::to_string(info.mStatus) +
+                             " for '" + url + "'!");
+  }
+
+  // Empty files do not produce any call to the write function.
+  if (!stream.is_open() && (info.mStatus == 0 || info.mStatus == 200)) {
+    stream.open(destination, std::ios::binary | std::ios::trunc);
+  }
+
+  stream.close();
+
+  if (stream.fail()) {
+    throw std::runtime_error("Failed to write to '" + destination + "'!");
+  }
+
+  return info;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::string getChunkFile(std::string const& partFile, uint64_t chunk) {
+  return partFile + "." + std::to_string(chunk);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+Downloader::Downloader(uint64_t chunkSize)
+    : mChunkSize(chunkSize) {
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void Downloader::download(std::string const& url, std::string const& file) {
-  if (boost::filesystem::exists(file)) {
+  download(url, file, Options());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Downloader::download(std::string const& url, std::string const& file, Options const& options) {
+  if (!options.mRefresh && boost::filesystem::exists(file)) {
     return;
   }
 
@@ -29,19 +301,18 @@ void Downloader::download(std::string const& url, std::string const& file) {
   size_t                       progressIndex = mProgress.size();
   mProgress.emplace_back(0.0, 0.0);
 
-  // We download to a file with a .part suffix. Once the download is done, we will remove the
-  // suffix.
-  mThreadPool.enqueue([this, file, url, progressIndex]() {
-    logger().info("Downloading file '{}'...", file);
-
-    filesystem::downloadFile(
-        url, file + ".part", [this, progressIndex](double progress, double total) {
-          std::unique_lock<std::mutex> lock(mProgressMutex);
-          mProgress[progressIndex] = {progress, total};
-        });
-
-    std::rename((file + ".part").c_str(), file.c_str());
-    logger().info("Finished downloading file '{}'.", file);
+  mTasks.enqueue([this, file, url, options, progressIndex, flowID = FrameStats::startFlow()]() {
+    static const FrameStats::RangeId range("Download File");
+    FrameStats::ScopedTrace           trace(range, flowID);
+
+    try {
+      downloadImpl(url, file, options, progressIndex);
+    } catch (std::exception const& e) {
+      logger().error("Failed to download file '{}' from '{}': {}", file, url, e.what());
+
+      std::unique_lock<std::mutex> lock(mProgressMutex);
+      ++mFailedCount;
+    }
   });
 }
 
@@ -68,7 +339,227 @@ double Downloader::getProgress() const {
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 bool Downloader::hasFinished() const {
-  return mThreadPool.hasFinished();
+  return mTasks.hasFinished();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+uint32_t Downloader::getFailedCount() const {
+  std::unique_lock<std::mutex> lock(mProgressMutex);
+  return mFailedCount;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Downloader::downloadImpl(std::string const& url, std::string const& file,
+    Options const& options, size_t progressIndex) {
+
+  // We download to a file with a .part suffix. Once the download is done, we will remove the
+  // suffix. The validators of the remote file at the time the .part file was started are stored
+  // next to it, so that we can check whether the partial data can be reused.
+  std::string partFile     = file + ".part";
+  std::string partMetaFile = file + ".part.meta";
+  std::string metaFile     = file + ".meta";
+
+  auto directory = boost::filesystem::path(file).parent_path();
+  if (!directory.empty()) {
+    filesystem::createDirectoryRecursively(directory);
+  }
+
+  std::atomic<int64_t> downloaded{0};
+  uint64_t             total = 0;
+
+  // This may be called from several threads if a file is downloaded in chunks.
+  auto onData = [&](int64_t bytes) {
+    downloaded += bytes;
+    std::unique_lock<std::mutex> lock(mProgressMutex);
+    mProgress[progressIndex] = {static_cast<double>(downloaded), static_cast<double>(total)};
+  };
+
+  // First, we ask the server for the size of the file, whether it supports range requests and
+  // for the validators. If the file exists already, this is a conditional request.
+  bool         exists = boost::filesystem::exists(file);
+  Validators   stored = exists ? loadValidators(metaFile) : Validators();
+  ResponseInfo head;
+
+  try {
+    head = requestHead(url, stored);
+  } catch (std::exception const& e) {
+    // We keep existing files if we are offline.
+    if (exists) {
+      logger().warn("Failed to check whether file '{}' is up-to-date: {}", file, e.what());
+      return;
+    }
+  }
+
+  if (exists) {
+    if (head.mStatus == 304) {
+      logger().debug("File '{}' is up-to-date.", file);
+      return;
+    }
+
+    // Files which have been downloaded without storing the validators are considered up-to-date
+    // if their size matches. The validators are stored for the next time.
+    if (head.mStatus == 200 && stored.isEmpty() && head.mContentLength &&
+        *head.mContentLength == boost::filesystem::file_size(file)) {
+      saveValidators(metaFile, head.mValidators);
+      return;
+    }
+
+    if (head.mStatus != 200) {
+      logger().warn("Failed to check whether file '{}' is up-to-date: The server responded with "
+                    "status {}.",
+          file, head.mStatus);
+      return;
+    }
+
+    logger().info("File '{}' has changed on the server.", file);
+  }
+
+  // Some servers do not support HEAD requests. In this case we simply download the entire file.
+  bool headValid    = head.mStatus == 200;
+  bool acceptRanges = headValid && head.mAcceptRanges && !head.mValidators.isEmpty();
+  total             = headValid && head.mContentLength ? *head.mContentLength : 0;
+
+  // Partial data can only be reused if the remote file has not changed in the meantime.
+  if (!acceptRanges || !(loadValidators(partMetaFile) == head.mValidators)) {
+    boost::filesystem::remove(partFile);
+    for (uint64_t i = 0; i < cMaxChunks; ++i) {
+      boost::filesystem::remove(getChunkFile(partFile, i));
+    }
+  }
+
+  if (acceptRanges) {
+    saveValidators(partMetaFile, head.mValidators);
+  }
+
+  Validators validators = head.mValidators;
+
+  if (acceptRanges && total >= 2 * mChunkSize) {
+
+    // Large files are downloaded in several chunks in parallel. Each chunk is written to a
+    // separate file, so that each of them can be resumed individually.
+    uint64_t chunkCount  = std::min(cMaxChunks, total / mChunkSize);
+    uint64_t chunkLength = (total + chunkCount - 1) / chunkCount;
+
+    logger().info("Downloading file '{}' in {} chunks...", file, chunkCount);
+
+    TaskGroup                      chunks(ThreadPool::getIO());
+    std::vector<std::future<void>> results;
+
+    for (uint64_t i = 0; i < chunkCount; ++i) {
+      std::string chunkFile = getChunkFile(partFile, i);
+      uint64_t    first     = i * chunkLength;
+      uint64_t    last      = std::min(total, first + chunkLength) - 1;
+      uint64_t    existing  = 0;
+
+      if (boost::filesystem::exists(chunkFile)) {
+        existing = boost::filesystem::file_size(chunkFile);
+      }
+
+      if (existing > last - first + 1) {
+        boost::filesystem::remove(chunkFile);
+        existing = 0;
+      }
+
+      onData(static_cast<int64_t>(existing));
+
+      if (existing == last - first + 1) {
+        continue;
+      }
+
+      results.push_back(chunks.enqueue([&, chunkFile, first, last, existing]() {
+        requestRange(url, chunkFile, first + existing, last, existing, validators.getIfRange(),
+            onData);
+      }));
+    }
+
+    chunks.wait();
+
+    // This re-throws the first error which occurred in a chunk.
+    for (auto& result : results) {
+      result.get();
+    }
+
+    // Finally, all chunks are concatenated.
+    {
+      std::ofstream stream(partFile, std::ios::binary | std::ios::trunc);
+
+      for (uint64_t i = 0; i < chunkCount; ++i) {
+        std::ifstream chunk(getChunkFile(partFile, i), std::ios::binary);
+        stream << chunk.rdbuf();
+      }
+
+      if (!stream) {
+        throw std::runtime_error("Failed to write to '" + partFile + "'!");
+      }
+    }
+
+    for (uint64_t i = 0; i < chunkCount; ++i) {
+      boost::filesystem::remove(getChunkFile(partFile, i));
+    }
+
+  } else {
+
+    // Smaller files are downloaded in one go. Previously downloaded data is reused.
+    uint64_t existing = 0;
+
+    if (acceptRanges && boost::filesystem::exists(partFile)) {
+      existing = boost::filesystem::file_size(partFile);
+    }
+
+    // Partial data which is larger than the remote file cannot belong to it.
+    if (total > 0 && existing > total) {
+      boost::filesystem::remove(partFile);
+      existing = 0;
+    }
+
+    onData(static_cast<int64_t>(existing));
+
+    // The previous attempt may have failed after all data had been received, for instance while
+    // computing the checksum or renaming the file. Then there is nothing left to request.
+    if (total > 0 && existing == total) {
+      logger().info("Download of file '{}' is complete already.", file);
+    } else {
+      if (existing > 0) {
+        logger().info("Resuming download of file '{}' at {} bytes...", file, existing);
+      } else {
+        logger().info("Downloading file '{}'...", file);
+      }
+
+      auto info = requestRange(
+          url, partFile, existing, std::nullopt, existing, validators.getIfRange(), onData);
+
+      if (!headValid) {
+        validators = info.mValidators;
+      }
+    }
+  }
+
+  // Verify the checksum if one is given. Corrupt data is removed so that the next attempt starts
+  // from scratch.
+  if (options.mSHA256) {
+    auto expected = boost::algorithm::to_lower_copy(*options.mSHA256);
+    auto actual   = filesystem::computeSHA256(partFile);
+
+    if (expected != actual) {
+      boost::filesystem::remove(partFile);
+      boost::filesystem::remove(partMetaFile);
+      throw std::runtime_error(
+          "Checksum mismatch! Expected SHA-256 " + expected + " but got " + actual + ".");
+    }
+  }
+
+  boost::filesystem::rename(partFile, file);
+  boost::filesystem::remove(partMetaFile);
+
+  if (validators.isEmpty()) {
+    boost::filesystem::remove(metaFile);
+  } else {
+    saveValidators(metaFile, validators);
+  }
+
+  logger().info("Finished downloading file '{}'.", file);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -12,30 +12,73 @@
 
 #include "ThreadPool.hpp"
 
+#include <optional>
+#include <string>
+
 namespace cs::utils {
 
 /// This class can be used to download a set of files in parallel.
+///
+/// Files are downloaded to a file with a .part suffix which is renamed once the download is
+/// complete. If a download is interrupted, it will be resumed with an HTTP range request the next
+/// time, provided that the server supports range requests and the remote file has not changed in
+/// the meantime. Large files are split into several chunks which are downloaded in parallel.
+///
+/// The ETag and Last-Modified headers of each downloaded file are stored in a file with a .meta
+/// suffix next to it. They are used for conditional requests if an existing file should be
+/// refreshed.
 class CS_UTILS_EXPORT Downloader {
  public:
-  /// This initializes the internal thread pool with the given number of threads.
-  explicit Downloader(size_t threadCount);
+  struct Options {
+    /// If set, the SHA-256 hash of the downloaded file (as hexadecimal string) is compared to this
+    /// value. If they do not match, the downloaded data is discarded.
+    std::optional<std::string> mSHA256;
+
+    /// If set to true, an existing file is not simply kept. Instead, the server is asked with a
+    /// conditional request whether the file has changed. If so, it is downloaded again.
+    bool mRefresh = false;
+  };
+
+  /// The default minimum size of the chunks of large files.
+  static constexpr uint64_t cDefaultChunkSize = 32 * 1024 * 1024;
+
+  /// Large files are split into at most this many chunks.
+  static constexpr uint64_t cMaxChunks = 8;
+
+  /// The downloads are executed on the I/O ThreadPool. Files which are at least twice as large
+  /// as chunkSize are downloaded in chunks of at least this size in parallel, if the server
+  /// supports range requests.
+  explicit Downloader(uint64_t chunkSize = cDefaultChunkSize);
 
   /// Queue a file to be downloaded. If a file with the given name already exists, nothing will be
-  /// done. This method will return quickly, as the actual download is done in a separate thread.
-  ///  If the path to the destination file does not exist, it will be created.
+  /// done unless Options::mRefresh is set. This method will return quickly, as the actual download
+  /// is done in a separate thread. If the path to the destination file does not exist, it will be
+  /// created.
   void download(std::string const& url, std::string const& file);
+  void download(std::string const& url, std::string const& file, Options const& options);
 
   /// Returns the total download progress in percent. If no file was downloaded, it will return 100.
   double getProgress() const;
 
-  /// Returns true when the internal thread pool has no running or pending tasks.
+  /// Returns true when there are no running or pending downloads.
   bool hasFinished() const;
 
+  /// Returns the number of downloads which failed, for example due to network errors or checksum
+  /// mismatches. The reasons are printed to the log.
+  uint32_t getFailedCount() const;
+
  private:
-  ThreadPool mThreadPool;
+  void downloadImpl(std::string const& url, std::string const& file, Options const& options,
+      size_t progressIndex);
 
+  uint64_t                               mChunkSize;
   mutable std::mutex                     mProgressMutex;
   std::vector<std::pair<double, double>> mProgress;
+  uint32_t                               mFailedCount = 0;
+
+  // This is declared last so that it waits for all downloads before the members above are
+  // destroyed.
+  TaskGroup mTasks{ThreadPool::getIO()};
 };
 
 } // namespace cs::utils
@@ -10,25 +10,246 @@
 #include "logger.hpp"
 
 #include <GL/glew.h>
+#include <atomic>
+#include <deque>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
 #include <thread>
 #include <utility>
 
 namespace cs::utils {
 
+namespace {
+
+// All range names are stored in this registry. The names are stored in a std::deque so that
+// references to them stay valid when new names are added. The keys of the map are views into the
+// strings of the deque.
+struct RangeRegistry {
+  std::mutex                                     mMutex;
+  std::deque<std::string>                        mNames;
+  std::unordered_map<std::string_view, uint32_t> mIndices;
+};
+
+RangeRegistry& getRangeRegistry() {
+  static RangeRegistry registry;
+  return registry;
+}
+
+int64_t now() {
+  return std::chrono::high_resolution_clock::now().time_since_epoch().count();
+}
+
+// Each thread which records trace events owns a ThreadTrace. The events are stored in a ring buffer
+// which is only written by the owning thread. Exporting threads read the buffer without locking.
+// This works similar to a seqlock: The writer announces the index it is about to overwrite in
+// mWriteCount before writing the event and publishes it in mEventCount afterwards. Readers discard
+// all events which may have been overwritten while they were copying them.
+enum class TraceEventType : uint32_t { eBegin, eEnd, eFlowStart, eFlowEnd };
+
+struct TraceEvent {
+  std::atomic<int64_t>  mTime{};
+  std::atomic<uint64_t> mData{}; // TraceEventType in the upper, range index in the lower 32 bit.
+  std::atomic<uint64_t> mFlowID{};
+};
+
+struct ThreadTrace {
+  uint32_t    mThreadID{};
+  std::string mName; // Protected by the mutex of the TraceRegistry.
+
+  std::atomic<TraceEvent*>      mEvents{nullptr};
+  std::unique_ptr<TraceEvent[]> mEventStorage; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+  std::atomic<uint64_t>         mWriteCount{0};
+  std::atomic<uint64_t>         mEventCount{0};
+
+  void record(TraceEventType type, uint32_t range, uint64_t flowID) {
+    auto* events = mEvents.load(std::memory_order_acquire);
+
+    // The ring buffer is allocated lazily so that threads which never record anything do not
+    // consume any memory.
+    if (!events) {
+      mEventStorage = std::make_unique<TraceEvent[]>(FrameStats::cTraceBufferSize);
+      events        = mEventStorage.get();
+      mEvents.store(events, std::memory_order_release);
+    }
+
+    uint64_t index = mEventCount.load(std::memory_order_relaxed);
+    auto&    event = events[index % FrameStats::cTraceBufferSize];
+
+    mWriteCount.store(index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    event.mTime.store(now(), std::memory_order_relaxed);
+    event.mData.store((static_cast<uint64_t>(type) << 32U) | static_cast<uint64_t>(range),
+        std::memory_order_relaxed);
+    event.mFlowID.store(flowID, std::memory_order_relaxed);
+
+    mEventCount.store(index + 1, std::memory_order_release);
+  }
+};
+
+// Exported timestamps are relative to mStartTime.
+struct TraceRegistry {
+  int64_t                                   mStartTime = now();
+  std::atomic<bool>                         mEnabled{false};
+  std::atomic<uint64_t>                     mNextFlowID{1};
+  std::mutex                                mMutex;
+  std::vector<std::shared_ptr<ThreadTrace>> mThreads;
+};
+
+TraceRegistry& getTraceRegistry() {
+  static TraceRegistry registry;
+  return registry;
+}
+
+// Returns the ThreadTrace of the calling thread. It is registered on first use. The registry keeps
+// the ThreadTrace alive after the thread exits so that its events can still be exported.
+ThreadTrace& getThreadTrace() {
+  thread_local std::shared_ptr<ThreadTrace> trace = []() {
+    auto&                        registry = getTraceRegistry();
+    std::unique_lock<std::mutex> lock(registry.mMutex);
+
+    auto result       = std::make_shared<ThreadTrace>();
+    result->mThreadID = static_cast<uint32_t>(registry.mThreads.size() + 1);
+    result->mName     = "Thread " + std::to_string(result->mThreadID);
+    registry.mThreads.push_back(result);
+
+    return result;
+  }();
+
+  return *trace;
+}
+
+bool isTracingEnabled() {
+  return getTraceRegistry().mEnabled.load(std::memory_order_relaxed);
+}
+
+void writeJSONString(std::ostream& stream, std::string const& value) {
+  stream << '"';
+  for (char c : value) {
+    switch (c) {
+    case '"':
+      stream << "\\\"";
+      break;
+    case '\\':
+      stream << "\\\\";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c)
+               << std::dec;
+      } else {
+        stream << c;
+      }
+    }
+  }
+  stream << '"';
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+FrameStats::RangeId::RangeId(std::string_view name) {
+  auto&                        registry = getRangeRegistry();
+  std::unique_lock<std::mutex> lock(registry.mMutex);
+
+  auto it = registry.mIndices.find(name);
+
+  if (it != registry.mIndices.end()) {
+    mIndex = it->second;
+  } else {
+    mIndex = static_cast<uint32_t>(registry.mNames.size());
+    registry.mNames.emplace_back(name);
+    registry.mIndices.emplace(registry.mNames.back(), mIndex);
+  }
+}
+
+std::string const& FrameStats::RangeId::getName() const {
+  static const std::string empty;
+
+  if (!isValid()) {
+    return empty;
+  }
+
+  auto&                        registry = getRangeRegistry();
+  std::unique_lock<std::mutex> lock(registry.mMutex);
+  return registry.mNames[mIndex];
+}
+
+bool FrameStats::RangeId::isValid() const {
+  return mIndex != std::numeric_limits<uint32_t>::max();
+}
+
+uint32_t FrameStats::RangeId::getIndex() const {
+  return mIndex;
+}
+
+bool FrameStats::RangeId::operator==(RangeId const& other) const {
+  return mIndex == other.mIndex;
+}
+
+bool FrameStats::RangeId::operator!=(RangeId const& other) const {
+  return mIndex != other.mIndex;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-FrameStats::ScopedTimer::ScopedTimer(std::string name, TimerMode mode)
-    : mID(FrameStats::get().startTimerQuery(std::move(name), mode)) {
+FrameStats::ScopedTimer::ScopedTimer(RangeId range, TimerMode mode)
+    : mID(FrameStats::get().startTimerQuery(range, mode))
+    , mTraced(isTracingEnabled()) {
+
+  if (mTraced) {
+    getThreadTrace().record(TraceEventType::eBegin, range.mIndex, 0);
+  }
+}
+
+FrameStats::ScopedTimer::ScopedTimer(std::string_view name, TimerMode mode)
+    : mID(FrameStats::get().startTimerQuery(name, mode))
+    , mTraced(isTracingEnabled()) {
+
+  if (mTraced) {
+    getThreadTrace().record(TraceEventType::eBegin, RangeId(name).mIndex, 0);
+  }
 }
 
 FrameStats::ScopedTimer::~ScopedTimer() {
   FrameStats::get().endTimerQuery(mID);
+
+  if (mTraced) {
+    getThreadTrace().record(TraceEventType::eEnd, 0, 0);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+FrameStats::ScopedTrace::ScopedTrace(RangeId range, uint64_t flowID)
+    : mActive(isTracingEnabled()) {
+
+  if (mActive) {
+    auto& trace = getThreadTrace();
+    trace.record(TraceEventType::eBegin, range.mIndex, 0);
+
+    if (flowID != 0) {
+      trace.record(TraceEventType::eFlowEnd, range.mIndex, flowID);
+    }
+  }
+}
+
+FrameStats::ScopedTrace::~ScopedTrace() {
+  if (mActive) {
+    getThreadTrace().record(TraceEventType::eEnd, 0, 0);
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-FrameStats::ScopedSamplesCounter::ScopedSamplesCounter(std::string name)
-    : mID(FrameStats::get().startSamplesQuery(std::move(name))) {
+FrameStats::ScopedSamplesCounter::ScopedSamplesCounter(RangeId range)
+    : mID(FrameStats::get().startSamplesQuery(range)) {
+}
+
+FrameStats::ScopedSamplesCounter::ScopedSamplesCounter(std::string_view name)
+    : mID(FrameStats::get().startSamplesQuery(name)) {
 }
 
 FrameStats::ScopedSamplesCounter::~ScopedSamplesCounter() {
@@ -37,8 +258,12 @@ FrameStats::ScopedSamplesCounter::~ScopedSamplesCounter() {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-FrameStats::ScopedPrimitivesCounter::ScopedPrimitivesCounter(std::string name)
-    : mID(FrameStats::get().startPrimitivesQuery(std::move(name))) {
+FrameStats::ScopedPrimitivesCounter::ScopedPrimitivesCounter(RangeId range)
+    : mID(FrameStats::get().startPrimitivesQuery(range)) {
+}
+
+FrameStats::ScopedPrimitivesCounter::ScopedPrimitivesCounter(std::string_view name)
+    : mID(FrameStats::get().startPrimitivesQuery(name)) {
 }
 
 FrameStats::ScopedPrimitivesCounter::~ScopedPrimitivesCounter() {
@@ -55,6 +280,8 @@ FrameStats& FrameStats::get() {
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 FrameStats::FrameStats() {
+  pEnableTracing.connectAndTouch([](bool enable) { getTraceRegistry().mEnabled = enable; });
+
   pEnableMeasurements.connectAndTouch([this](bool enable) {
     for (auto& pool : mQueryPools) {
       if (enable) {
@@ -96,7 +323,15 @@ void FrameStats::startFrame() {
 
   // Start the "root" full frame timing. This is always done, even if pEnableMeasurements is set to
   // false. This is required to get data for the pFrameTime property.
-  mFullFrameTimingID = pool->startTimerQuery("Process Frame", FrameStats::TimerMode::eBoth);
+  static const RangeId processFrame("Process Frame");
+  mFullFrameTimingID = pool->startTimerQuery(processFrame, FrameStats::TimerMode::eBoth);
+
+  // The frames are also recorded in the trace. This makes it easier to correlate background work
+  // with the frames.
+  mFrameTraced = isTracingEnabled();
+  if (mFrameTraced) {
+    getThreadTrace().record(TraceEventType::eBegin, processFrame.mIndex, 0);
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -106,15 +341,20 @@ void FrameStats::endFrame() {
   // End the "root" full frame timing. This is always done, even if pEnableMeasurements is set to
   // false. This is required to get data for the pFrameTime property.
   mQueryPools.at(mCurrentQueryPool)->endTimerQuery(mFullFrameTimingID);
+
+  if (mFrameTraced) {
+    getThreadTrace().record(TraceEventType::eEnd, 0, 0);
+    mFrameTraced = false;
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-int32_t FrameStats::startTimerQuery(std::string name, FrameStats::TimerMode mode) {
+int32_t FrameStats::startTimerQuery(RangeId range, FrameStats::TimerMode mode) {
 
   // Only attempt to start the timing if pEnableMeasurements is set to true.
   if (pEnableMeasurements.get()) {
-    return mQueryPools.at(mCurrentQueryPool)->startTimerQuery(std::move(name), mode);
+    return mQueryPools.at(mCurrentQueryPool)->startTimerQuery(range, mode);
   }
 
   return -1;
@@ -122,11 +362,11 @@ int32_t FrameStats::startTimerQuery(std::string name, FrameStats::TimerMode mode
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-int32_t FrameStats::startSamplesQuery(std::string name) {
+int32_t FrameStats::startSamplesQuery(RangeId range) {
 
   // Only attempt to start the counting if pEnableMeasurements is set to true.
   if (pEnableMeasurements.get()) {
-    return mQueryPools.at(mCurrentQueryPool)->startSamplesQuery(std::move(name));
+    return mQueryPools.at(mCurrentQueryPool)->startSamplesQuery(range);
   }
 
   return -1;
@@ -134,11 +374,47 @@ int32_t FrameStats::startSamplesQuery(std::string name) {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-int32_t FrameStats::startPrimitivesQuery(std::string name) {
+int32_t FrameStats::startPrimitivesQuery(RangeId range) {
 
   // Only attempt to start the counting if pEnableMeasurements is set to true.
   if (pEnableMeasurements.get()) {
-    return mQueryPools.at(mCurrentQueryPool)->startPrimitivesQuery(std::move(name));
+    return mQueryPools.at(mCurrentQueryPool)->startPrimitivesQuery(range);
+  }
+
+  return -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int32_t FrameStats::startTimerQuery(std::string_view name, FrameStats::TimerMode mode) {
+
+  // The name is only interned if it is actually needed.
+  if (pEnableMeasurements.get()) {
+    return startTimerQuery(RangeId(name), mode);
+  }
+
+  return -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int32_t FrameStats::startSamplesQuery(std::string_view name) {
+
+  // The name is only interned if it is actually needed.
+  if (pEnableMeasurements.get()) {
+    return startSamplesQuery(RangeId(name));
+  }
+
+  return -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int32_t FrameStats::startPrimitivesQuery(std::string_view name) {
+
+  // The name is only interned if it is actually needed.
+  if (pEnableMeasurements.get()) {
+    return startPrimitivesQuery(RangeId(name));
   }
 
   return -1;
@@ -176,6 +452,26 @@ void FrameStats::endPrimitivesQuery(int32_t id) {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void FrameStats::addValue(RangeId range, int64_t value) {
+
+  // Only attempt to record the value if pEnableMeasurements is set to true.
+  if (pEnableMeasurements.get()) {
+    mQueryPools.at(mCurrentQueryPool)->addValue(range, value);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void FrameStats::addValue(std::string_view name, int64_t value) {
+
+  // The name is only interned if it is actually needed.
+  if (pEnableMeasurements.get()) {
+    addValue(RangeId(name), value);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 std::vector<FrameStats::TimerQueryResult> const& FrameStats::getTimerQueryResults() {
 
   // We return the ranges from the last-but-one frame.
@@ -203,27 +499,167 @@ std::vector<FrameStats::CounterQueryResult> const& FrameStats::getPrimitivesQuer
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+std::vector<FrameStats::CounterQueryResult> const& FrameStats::getValueResults() {
+
+  // We return the values from the last-but-one frame.
+  auto oldestPool = (mCurrentQueryPool + 1) % mQueryPools.size();
+  return mQueryPools.at(oldestPool)->getValueResults();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void FrameStats::setThreadName(std::string_view name) {
+  auto& trace    = getThreadTrace();
+  auto& registry = getTraceRegistry();
+
+  std::unique_lock<std::mutex> lock(registry.mMutex);
+  trace.mName = name;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+uint64_t FrameStats::startFlow() {
+  if (!isTracingEnabled()) {
+    return 0;
+  }
+
+  uint64_t flowID = getTraceRegistry().mNextFlowID++;
+  getThreadTrace().record(TraceEventType::eFlowStart, 0, flowID);
+
+  return flowID;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void FrameStats::writeChromeTrace(std::ostream& stream) {
+  auto& registry = getTraceRegistry();
+
+  // Copy the list of threads and their names so that we do not block threads which are just being
+  // registered while we are writing the output.
+  std::vector<std::pair<std::shared_ptr<ThreadTrace>, std::string>> threads;
+  {
+    std::unique_lock<std::mutex> lock(registry.mMutex);
+    for (auto const& thread : registry.mThreads) {
+      threads.emplace_back(thread, thread->mName);
+    }
+  }
+
+  struct Event {
+    int64_t  mTime;
+    uint64_t mData;
+    uint64_t mFlowID;
+  };
+
+  std::vector<Event> events;
+
+  stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+  bool first     = true;
+  auto separator = [&]() {
+    if (!first) {
+      stream << ",";
+    }
+    first = false;
+  };
+
+  // The timestamps are given in microseconds.
+  stream << std::fixed << std::setprecision(3);
+
+  for (auto const& [thread, name] : threads) {
+    separator();
+    stream << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":"
+           << thread->mThreadID << ",\"args\":{\"name\":";
+    writeJSONString(stream, name);
+    stream << "}}";
+
+    auto* ring = thread->mEvents.load(std::memory_order_acquire);
+    if (!ring) {
+      continue;
+    }
+
+    // Copy the events which are currently in the ring buffer.
+    uint64_t end   = thread->mEventCount.load(std::memory_order_acquire);
+    uint64_t begin = end > cTraceBufferSize ? end - cTraceBufferSize : 0;
+
+    events.clear();
+    for (uint64_t i = begin; i < end; ++i) {
+      auto const& event = ring[i % cTraceBufferSize];
+      events.push_back({event.mTime.load(std::memory_order_relaxed),
+          event.mData.load(std::memory_order_relaxed),
+          event.mFlowID.load(std::memory_order_relaxed)});
+    }
+
+    // Discard all events which may have been overwritten by the writer while we were copying.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t written    = thread->mWriteCount.load(std::memory_order_relaxed);
+    uint64_t validBegin = written > cTraceBufferSize ? written - cTraceBufferSize : 0;
+    size_t   skip = validBegin > begin ? std::min<size_t>(validBegin - begin, events.size()) : 0;
+
+    for (size_t i = skip; i < events.size(); ++i) {
+      auto const& event = events[i];
+      auto        type  = static_cast<TraceEventType>(event.mData >> 32U);
+
+      RangeId range;
+      range.mIndex = static_cast<uint32_t>(event.mData & 0xFFFFFFFFU);
+
+      separator();
+      stream << "{\"pid\":1,\"tid\":" << thread->mThreadID
+             << ",\"ts\":" << static_cast<double>(event.mTime - registry.mStartTime) * 0.001;
+
+      switch (type) {
+      case TraceEventType::eBegin:
+        stream << ",\"ph\":\"B\",\"name\":";
+        writeJSONString(stream, range.getName());
+        break;
+      case TraceEventType::eEnd:
+        stream << ",\"ph\":\"E\"";
+        break;
+      case TraceEventType::eFlowStart:
+        stream << ",\"ph\":\"s\",\"cat\":\"flow\",\"name\":\"flow\",\"id\":"
+               << event.mFlowID;
+        break;
+      case TraceEventType::eFlowEnd:
+        stream << ",\"ph\":\"f\",\"bp\":\"e\",\"cat\":\"flow\",\"name\":\"flow\",\"id\":"
+               << event.mFlowID;
+        break;
+      }
+
+      stream << "}";
+    }
+  }
+
+  stream << "]}";
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::string FrameStats::getChromeTrace() {
+  std::ostringstream stream;
+  writeChromeTrace(stream);
+  return stream.str();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 QueryPool::QueryPool(std::size_t queryAllocationBucketSize)
     : mQueryAllocationBucketSize(queryAllocationBucketSize) {
 
-  mTimerQueries.mQueries.resize(mQueryAllocationBucketSize);
-  mSamplesQueries.mQueries.resize(mQueryAllocationBucketSize);
-  mPrimitivesQueries.mQueries.resize(mQueryAllocationBucketSize);
-
-  glGenQueries(static_cast<GLsizei>(queryAllocationBucketSize), mTimerQueries.mQueries.data());
-  glGenQueries(static_cast<GLsizei>(queryAllocationBucketSize), mSamplesQueries.mQueries.data());
-  glGenQueries(static_cast<GLsizei>(queryAllocationBucketSize), mPrimitivesQueries.mQueries.data());
+  // Reserve space for the results so that starting a range usually does not allocate any memory.
+  // The GPU query objects are allocated lazily in startTimerQuery() and the like.
+  mTimerQueryResults.reserve(mQueryAllocationBucketSize);
+  mSamplesQueryResults.reserve(mQueryAllocationBucketSize);
+  mPrimitivesQueryResults.reserve(mQueryAllocationBucketSize);
+  mValueResults.reserve(mQueryAllocationBucketSize);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 QueryPool::~QueryPool() {
-  glDeleteQueries(
-      static_cast<GLsizei>(mTimerQueries.mQueries.size()), mTimerQueries.mQueries.data());
-  glDeleteQueries(
-      static_cast<GLsizei>(mSamplesQueries.mQueries.size()), mSamplesQueries.mQueries.data());
-  glDeleteQueries(
-      static_cast<GLsizei>(mPrimitivesQueries.mQueries.size()), mPrimitivesQueries.mQueries.data());
+  for (auto* queries : {&mTimerQueries, &mSamplesQueries, &mPrimitivesQueries}) {
+    if (!queries->mQueries.empty()) {
+      glDeleteQueries(static_cast<GLsizei>(queries->mQueries.size()), queries->mQueries.data());
+    }
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -232,6 +668,7 @@ void QueryPool::reset() {
   mTimerQueryResults.clear();
   mSamplesQueryResults.clear();
   mPrimitivesQueryResults.clear();
+  mValueResults.clear();
 
   mTimerQueries.mNextID      = 0;
   mSamplesQueries.mNextID    = 0;
@@ -242,11 +679,11 @@ void QueryPool::reset() {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-int32_t QueryPool::startTimerQuery(std::string name, FrameStats::TimerMode mode) {
+int32_t QueryPool::startTimerQuery(FrameStats::RangeId range, FrameStats::TimerMode mode) {
 
   FrameStats::TimerQueryResult result;
   result.mMode         = mode;
-  result.mName         = std::move(name);
+  result.mRange        = range;
   result.mNestingLevel = mCurrentNestingLevel++;
 
   // Start the GPU result if necessary.
@@ -259,7 +696,7 @@ int32_t QueryPool::startTimerQuery(std::string name, FrameStats::TimerMode mode)
     result.mCPUStart = std::chrono::high_resolution_clock::now().time_since_epoch().count();
   }
 
-  mTimerQueryResults.push_back(std::move(result));
+  mTimerQueryResults.push_back(result);
 
   // Return the index at which this result was inserted.
   return static_cast<int32_t>(mTimerQueryResults.size() - 1);
@@ -267,12 +704,12 @@ int32_t QueryPool::startTimerQuery(std::string name, FrameStats::TimerMode mode)
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-int32_t QueryPool::startSamplesQuery(std::string name) {
+int32_t QueryPool::startSamplesQuery(FrameStats::RangeId range) {
   FrameStats::CounterQueryResult result;
-  result.mName       = std::move(name);
+  result.mRange      = range;
   result.mQueryIndex = startSamplesQuery();
 
-  mSamplesQueryResults.push_back(std::move(result));
+  mSamplesQueryResults.push_back(result);
 
   // Return the index at which this result was inserted.
   return static_cast<int32_t>(mSamplesQueryResults.size() - 1);
@@ -280,12 +717,12 @@ int32_t QueryPool::startSamplesQuery(std::string name) {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-int32_t QueryPool::startPrimitivesQuery(std::string name) {
+int32_t QueryPool::startPrimitivesQuery(FrameStats::RangeId range) {
   FrameStats::CounterQueryResult result;
-  result.mName       = std::move(name);
+  result.mRange      = range;
   result.mQueryIndex = startPrimitivesQuery();
 
-  mPrimitivesQueryResults.push_back(std::move(result));
+  mPrimitivesQueryResults.push_back(result);
 
   // Return the index at which this result was inserted.
   return static_cast<int32_t>(mPrimitivesQueryResults.size() - 1);
@@ -342,6 +779,25 @@ void QueryPool::endPrimitivesQuery(int32_t id) {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void QueryPool::addValue(FrameStats::RangeId range, int64_t value) {
+
+  // There are usually only a few value counters per frame, so a linear search is fine here.
+  for (auto& result : mValueResults) {
+    if (result.mRange == range) {
+      result.mCount += value;
+      return;
+    }
+  }
+
+  FrameStats::CounterQueryResult result;
+  result.mRange = range;
+  result.mCount = value;
+
+  mValueResults.push_back(result);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 void QueryPool::fetchQueries() {
 
   // Wait for the last query to finish.
@@ -392,13 +848,23 @@ std::vector<FrameStats::CounterQueryResult> const& QueryPool::getPrimitivesQuery
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+std::vector<FrameStats::CounterQueryResult> const& QueryPool::getValueResults() const {
+  return mValueResults;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 std::size_t QueryPool::startTimerQuery() {
   if (mTimerQueries.mNextID >= mTimerQueries.mQueries.size()) {
     auto currentSize = mTimerQueries.mQueries.size();
     mTimerQueries.mQueries.resize(currentSize + mQueryAllocationBucketSize, 0);
     glGenQueries(static_cast<GLsizei>(mQueryAllocationBucketSize),
         mTimerQueries.mQueries.data() + currentSize);
-    logger().info("reallocating startTimerQuery");
+
+    // The first batch is allocated on first use and is not worth a message.
+    if (currentSize > 0) {
+      logger().info("reallocating startTimerQuery");
+    }
   }
 
   glQueryCounter(mTimerQueries.mQueries[mTimerQueries.mNextID], GL_TIMESTAMP);
@@ -414,7 +880,11 @@ std::size_t QueryPool::startSamplesQuery() {
     mSamplesQueries.mQueries.resize(currentSize + mQueryAllocationBucketSize, 0);
     glGenQueries(static_cast<GLsizei>(mQueryAllocationBucketSize),
         mSamplesQueries.mQueries.data() + currentSize);
-    logger().info("reallocating startSamplesQuery");
+
+    // The first batch is allocated on first use and is not worth a message.
+    if (currentSize > 0) {
+      logger().info("reallocating startSamplesQuery");
+    }
   }
 
   glBeginQuery(GL_SAMPLES_PASSED, mSamplesQueries.mQueries[mSamplesQueries.mNextID]);
@@ -430,7 +900,11 @@ std::size_t QueryPool::startPrimitivesQuery() {
     mPrimitivesQueries.mQueries.resize(currentSize + mQueryAllocationBucketSize, 0);
     glGenQueries(static_cast<GLsizei>(mQueryAllocationBucketSize),
         mPrimitivesQueries.mQueries.data() + currentSize);
-    logger().info("reallocating startPrimitivesQuery");
+
+    // The first batch is allocated on first use and is not worth a message.
+    if (currentSize > 0) {
+      logger().info("reallocating startPrimitivesQuery");
+    }
   }
 
   glBeginQuery(GL_PRIMITIVES_GENERATED, mPrimitivesQueries.mQueries[mPrimitivesQueries.mNextID]);
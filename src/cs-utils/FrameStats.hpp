@@ -13,8 +13,12 @@
 
 #include <array>
 #include <chrono>
+#include <functional>
+#include <iosfwd>
+#include <limits>
 #include <memory>
 #include <optional>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -29,7 +33,10 @@ class QueryPool;
 /// GPU by a specific block of code, simply create a FrameStats::ScopedTimer. This will start a
 /// measuring range in its constructor and and end the range in its destructor.
 /// The ScopedSamplesCounter and the ScopedPrimitivesCounter do not support nesting, so you have to
-/// ensure that you do not start two of them at the same time.
+/// ensure that you do not start two of them at the same time. Arbitrary per-frame quantities, such
+/// as the number of bytes uploaded to the GPU, can be recorded with addValue().
+/// Additionally, this class can record a timeline of CPU ranges on all threads. See pEnableTracing
+/// and FrameStats::ScopedTrace for more information.
 class CS_UTILS_EXPORT FrameStats {
  public:
   /// Defines which timings should be measured.
@@ -39,13 +46,47 @@ class CS_UTILS_EXPORT FrameStats {
     eBoth
   };
 
+  /// A RangeId identifies the name of a timing or counting range. The name is interned once when
+  /// the RangeId is created, afterwards starting a range with a RangeId neither allocates memory
+  /// nor copies any strings. So in code which is executed every frame, you should create the
+  /// RangeIds up-front (e.g. as a class member or as a static local variable) and reuse them.
+  /// Creating two RangeIds with the same name will result in equal RangeIds. A RangeId can be
+  /// created from any thread and before an OpenGL context exists.
+  class CS_UTILS_EXPORT RangeId {
+   public:
+    /// Creates an invalid RangeId with an empty name.
+    RangeId() = default;
+
+    /// Interns the given name. This requires a hash-map lookup and, if the name has not been seen
+    /// before, a copy of the string.
+    explicit RangeId(std::string_view name);
+
+    /// Returns the name which was used to create this RangeId.
+    std::string const& getName() const;
+
+    /// Returns false if this RangeId has been default-constructed.
+    bool isValid() const;
+
+    /// Returns the index of the interned name. Equal RangeIds have equal indices. This is used as
+    /// hash value, so that RangeIds can be used as keys of unordered containers.
+    uint32_t getIndex() const;
+
+    bool operator==(RangeId const& other) const;
+    bool operator!=(RangeId const& other) const;
+
+   private:
+    friend class FrameStats;
+
+    uint32_t mIndex = std::numeric_limits<uint32_t>::max();
+  };
+
   /// This struct contains information on one specific timing range. It is used internally by the
   /// FrameStats singleton and can be accessed via its getTimerQueryResults() method.
   struct TimerQueryResult {
 
     /// The name of the range as it was passed to the constructor of the ScopedTimer or the
-    /// FrameStats::startRange() method.
-    std::string mName;
+    /// FrameStats::startRange() method. Use mRange.getName() to retrieve the actual string.
+    RangeId mRange;
 
     /// This contains the number of timing ranges which were active when this range was started.
     uint32_t mNestingLevel{};
@@ -67,10 +108,10 @@ class CS_UTILS_EXPORT FrameStats {
   };
 
   /// This struct contains information on one specific counting range. It is used internally by the
-  /// FrameStats singleton and is returned by the getSamplesQueryResults and
-  /// mgetPrimitivesQueryResults methods.
+  /// FrameStats singleton and is returned by the getSamplesQueryResults,
+  /// getPrimitivesQueryResults, and getValueResults methods.
   struct CounterQueryResult {
-    std::string mName;
+    RangeId     mRange;
     int64_t     mCount{};
     std::size_t mQueryIndex{};
   };
@@ -79,9 +120,14 @@ class CS_UTILS_EXPORT FrameStats {
   /// timer will start measuring upon creation and stop measuring on deletion.
   class CS_UTILS_EXPORT ScopedTimer {
    public:
-    /// @param name The name of the counter.
+    /// @param range The name of the counter. Prefer this overload in code which is executed
+    ///              every frame.
+    /// @param mode  The mode of querying. See CounterMode for more info.
+    explicit ScopedTimer(RangeId range, TimerMode mode = TimerMode::eBoth);
+
+    /// @param name The name of the counter. It is only interned if pEnableMeasurements is true.
     /// @param mode The mode of querying. See CounterMode for more info.
-    explicit ScopedTimer(std::string name, TimerMode mode = TimerMode::eBoth);
+    explicit ScopedTimer(std::string_view name, TimerMode mode = TimerMode::eBoth);
 
     ScopedTimer(ScopedTimer const& other) = delete;
     ScopedTimer(ScopedTimer&& other)      = delete;
@@ -93,14 +139,40 @@ class CS_UTILS_EXPORT FrameStats {
 
    private:
     int32_t mID;
+    bool    mTraced;
+  };
+
+  /// A ScopedTrace records a CPU range into the trace of the calling thread if pEnableTracing is
+  /// set to true. In contrast to the ScopedTimer, it can be used on any thread. If a flow ID is
+  /// given, the range will be connected to the place where the flow was started with startFlow().
+  /// This can be used to visualize which frame requested the work done in a background thread.
+  class CS_UTILS_EXPORT ScopedTrace {
+   public:
+    /// @param range  The name of the range.
+    /// @param flowID An ID returned by FrameStats::startFlow() or zero.
+    explicit ScopedTrace(RangeId range, uint64_t flowID = 0);
+
+    ScopedTrace(ScopedTrace const& other) = delete;
+    ScopedTrace(ScopedTrace&& other)      = delete;
+
+    ScopedTrace& operator=(ScopedTrace const& other) = delete;
+    ScopedTrace& operator=(ScopedTrace&& other)      = delete;
+
+    ~ScopedTrace();
+
+   private:
+    bool mActive;
   };
 
   /// A ScopedSamplesCounter is responsible for counting generated fragments during its entire
   /// existence. The counter will start measuring upon creation and stop measuring on deletion.
   class CS_UTILS_EXPORT ScopedSamplesCounter {
    public:
-    /// @param name The name of the counter.
-    explicit ScopedSamplesCounter(std::string name);
+    /// @param range The name of the counter.
+    explicit ScopedSamplesCounter(RangeId range);
+
+    /// @param name The name of the counter. It is only interned if pEnableMeasurements is true.
+    explicit ScopedSamplesCounter(std::string_view name);
 
     ScopedSamplesCounter(ScopedSamplesCounter const& other) = delete;
     ScopedSamplesCounter(ScopedSamplesCounter&& other)      = delete;
@@ -118,8 +190,11 @@ class CS_UTILS_EXPORT FrameStats {
   /// existence. The counter will start measuring upon creation and stop measuring on deletion.
   class CS_UTILS_EXPORT ScopedPrimitivesCounter {
    public:
-    /// @param name The name of the counter.
-    explicit ScopedPrimitivesCounter(std::string name);
+    /// @param range The name of the counter.
+    explicit ScopedPrimitivesCounter(RangeId range);
+
+    /// @param name The name of the counter. It is only interned if pEnableMeasurements is true.
+    explicit ScopedPrimitivesCounter(std::string_view name);
 
     ScopedPrimitivesCounter(ScopedPrimitivesCounter const& other) = delete;
     ScopedPrimitivesCounter(ScopedPrimitivesCounter&& other)      = delete;
@@ -144,6 +219,15 @@ class CS_UTILS_EXPORT FrameStats {
   /// be based on the last-but-one frame. See the documentation of getRanges() for more details.
   Property<double> pFrameTime = 0.0;
 
+  /// If set to true, all ScopedTimers (CPU side only) and ScopedTraces on all threads are recorded
+  /// into thread-local ring buffers. Each ring buffer stores the most recent cTraceBufferSize
+  /// events, so the memory used by tracing is bounded. Use writeChromeTrace() to export the
+  /// timeline. This is independent of pEnableMeasurements.
+  Property<bool> pEnableTracing = false;
+
+  /// The maximum number of events which are kept per thread.
+  static constexpr std::size_t cTraceBufferSize = 65536;
+
   FrameStats(FrameStats const& other) = delete;
   FrameStats(FrameStats&& other)      = delete;
 
@@ -163,10 +247,21 @@ class CS_UTILS_EXPORT FrameStats {
   /// Starts a timer / counter with the given name and mode. You can use this interface, however the
   /// ScopedTimer, ScopedSamplesCounter, and ScopedPrimitivesCounter are often more easy to use. The
   /// returned ID will be >= 0 if the timing range was actually started and -1 if
+  /// pEnableMeasurements is set to false. The RangeId overloads do not allocate any memory if
   /// pEnableMeasurements is set to false.
-  int32_t startTimerQuery(std::string name, TimerMode mode = TimerMode::eBoth);
-  int32_t startSamplesQuery(std::string name);
-  int32_t startPrimitivesQuery(std::string name);
+  int32_t startTimerQuery(RangeId range, TimerMode mode = TimerMode::eBoth);
+  int32_t startSamplesQuery(RangeId range);
+  int32_t startPrimitivesQuery(RangeId range);
+
+  int32_t startTimerQuery(std::string_view name, TimerMode mode = TimerMode::eBoth);
+  int32_t startSamplesQuery(std::string_view name);
+  int32_t startPrimitivesQuery(std::string_view name);
+
+  /// Adds the given value to the counter with the given name. All values which are added to the
+  /// same counter during one frame are summed up. The results can be retrieved with
+  /// getValueResults() two frames later. This does nothing if pEnableMeasurements is set to false.
+  void addValue(RangeId range, int64_t value);
+  void addValue(std::string_view name, int64_t value);
 
   /// Stops the query with the given ID. You can use this interface, however the ScopedTimer,
   /// ScopedSamplesCounter, and ScopedPrimitivesCounter are often more easy to use.
@@ -184,6 +279,22 @@ class CS_UTILS_EXPORT FrameStats {
   std::vector<TimerQueryResult> const&   getTimerQueryResults();
   std::vector<CounterQueryResult> const& getSamplesQueryResults();
   std::vector<CounterQueryResult> const& getPrimitivesQueryResults();
+  std::vector<CounterQueryResult> const& getValueResults();
+
+  /// Sets the name of the calling thread as shown in exported traces. This can be called from any
+  /// thread at any time.
+  static void setThreadName(std::string_view name);
+
+  /// Records the start of a flow on the calling thread and returns its ID. Pass the ID to a
+  /// ScopedTrace on another thread to connect both in the exported trace. Returns zero if tracing
+  /// is disabled. This can be called from any thread.
+  static uint64_t startFlow();
+
+  /// Writes the currently buffered events of all threads in the Chrome Trace Event format. The
+  /// result can be opened with chrome://tracing or https://ui.perfetto.dev. This can be called
+  /// from any thread, even while other threads are recording events.
+  static void        writeChromeTrace(std::ostream& stream);
+  static std::string getChromeTrace();
 
  private:
   /// You should not need to instantiate this class. One singleton instance can be created with the
@@ -195,14 +306,16 @@ class CS_UTILS_EXPORT FrameStats {
   int32_t                                   mCurrentQueryPool{};
 
   int32_t mFullFrameTimingID{};
+  bool    mFrameTraced = false;
 };
 
 /// The QueryPool is used in a triple-buffer fashion internally by the FrameStats class. You
 /// will not need to use this class directly.
 class CS_UTILS_EXPORT QueryPool {
  public:
-  /// The QueryPool will allocate queryAllocationBucketSize GPU timer query objects initially.
-  /// Whenever this amount is exhausted, a new batch of this size will be allocated.
+  /// The QueryPool will allocate GPU query objects in batches of queryAllocationBucketSize. The
+  /// first batch is allocated when the first query is started, so creating a QueryPool does not
+  /// require an OpenGL context.
   QueryPool(std::size_t queryAllocationBucketSize);
 
   /// Do not try to copy this class!
@@ -219,15 +332,19 @@ class CS_UTILS_EXPORT QueryPool {
 
   /// Starts a new query. The returned integer will always be >= 0 and can be used to end the
   /// range with the method below.
-  int32_t startTimerQuery(std::string name, FrameStats::TimerMode mode);
-  int32_t startSamplesQuery(std::string name);
-  int32_t startPrimitivesQuery(std::string name);
+  int32_t startTimerQuery(FrameStats::RangeId range, FrameStats::TimerMode mode);
+  int32_t startSamplesQuery(FrameStats::RangeId range);
+  int32_t startPrimitivesQuery(FrameStats::RangeId range);
 
   /// Ends a previously started query. This will do nothing if the given id is invalid.
   void endTimerQuery(int32_t id);
   void endSamplesQuery(int32_t id);
   void endPrimitivesQuery(int32_t id);
 
+  /// Adds the given value to the counter of the given range. The counter is created if it does not
+  /// exist yet.
+  void addValue(FrameStats::RangeId range, int64_t value);
+
   /// Fetches timestamps from GPU. This needs to be called before get*Results() and blocks until all
   /// queries are done.
   void fetchQueries();
@@ -237,6 +354,7 @@ class CS_UTILS_EXPORT QueryPool {
   std::vector<FrameStats::TimerQueryResult> const&   getTimerQueryResults() const;
   std::vector<FrameStats::CounterQueryResult> const& getSamplesQueryResults() const;
   std::vector<FrameStats::CounterQueryResult> const& getPrimitivesQueryResults() const;
+  std::vector<FrameStats::CounterQueryResult> const& getValueResults() const;
 
  private:
   struct Queries {
@@ -260,10 +378,20 @@ class CS_UTILS_EXPORT QueryPool {
   std::vector<FrameStats::TimerQueryResult>   mTimerQueryResults;
   std::vector<FrameStats::CounterQueryResult> mSamplesQueryResults;
   std::vector<FrameStats::CounterQueryResult> mPrimitivesQueryResults;
+  std::vector<FrameStats::CounterQueryResult> mValueResults;
 
   uint32_t mCurrentNestingLevel{};
 };
 
 } // namespace cs::utils
 
+namespace std {
+template <>
+struct hash<cs::utils::FrameStats::RangeId> {
+  std::size_t operator()(cs::utils::FrameStats::RangeId const& range) const noexcept {
+    return range.getIndex();
+  }
+};
+} // namespace std
+
 #endif // CS_UTILS_FRAME_STATS_HPP
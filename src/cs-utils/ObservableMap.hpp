@@ -55,7 +55,7 @@ class ObservableMap {
     auto item = mMap.extract(key);
 
     if (item) {
-      mOnRemove.emit(item.key(), item.value());
+      mOnRemove.emit(item.key(), item.mapped());
     }
   }
 
@@ -7,36 +7,135 @@
 
 #include "ThreadPool.hpp"
 
-#include <iostream>
+#include "FrameStats.hpp"
+
+#include <algorithm>
+#include <string>
 
 namespace cs::utils {
 
+namespace {
+
+// These are set for each worker thread and used to push tasks enqueued from within a worker to
+// the worker's own deques.
+thread_local ThreadPool const* tCurrentPool  = nullptr;
+thread_local size_t            tWorkerIndex = 0;
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+CancellationToken::CancellationToken()
+    : mCancelled(std::make_shared<std::atomic<bool>>(false)) {
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void CancellationToken::cancel() {
+  mCancelled->store(true);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool CancellationToken::isCancelled() const {
+  return mCancelled->load();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ThreadPool::Task::Task(Task&& other) noexcept
+    : mImpl(std::move(other.mImpl))
+    , mCancelled(std::move(other.mCancelled))
+    , mGroup(other.mGroup) {
+  other.mGroup = nullptr;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-ThreadPool::ThreadPool(size_t threads)
-    : mStop(false) {
+ThreadPool::Task& ThreadPool::Task::operator=(Task&& other) noexcept {
+  if (this != &other) {
+    release();
+    mImpl        = std::move(other.mImpl);
+    mCancelled   = std::move(other.mCancelled);
+    mGroup       = other.mGroup;
+    other.mGroup = nullptr;
+  }
+  return *this;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ThreadPool::Task::~Task() {
+  release();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool ThreadPool::Task::operator()() {
+  if (mCancelled && mCancelled->load()) {
+    return false;
+  }
+
+  if (mGroup) {
+    mGroup->onTaskStarted();
+  }
+
+  mImpl->run();
+
+  // Release the wrapped callable before the group is notified, as the owner of the group may be
+  // destroyed as soon as the last task has been finished.
+  mImpl.reset();
+
+  if (mGroup) {
+    mGroup->onTaskDone(true);
+    mGroup = nullptr;
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ThreadPool::Task::release() {
+  mImpl.reset();
+
+  // If the task was never executed, the group still counts it as pending.
+  if (mGroup) {
+    mGroup->onTaskDone(false);
+    mGroup = nullptr;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ThreadPool::ThreadPool(size_t threads) {
+  threads = std::max<size_t>(threads, 1);
+
   for (size_t i = 0; i < threads; ++i) {
-    mWorkers.emplace_back([this] {
-      while (true) {
-        std::function<void()> task;
-        {
-          std::unique_lock<std::mutex> lock(mMutex);
+    mQueues.emplace_back(std::make_unique<WorkerQueue>());
+  }
 
-          mCondition.wait(lock, [this] { return mStop || !mTasks.empty(); });
+  for (size_t i = 0; i < threads; ++i) {
+    mWorkers.emplace_back([this, i] {
+      tCurrentPool = this;
+      tWorkerIndex = i;
 
-          if (mStop && mTasks.empty()) {
-            return;
-          }
+      FrameStats::setThreadName("ThreadPool Worker " + std::to_string(i));
 
-          task = std::move(mTasks.top());
-          mTasks.pop();
-          ++mRunningTasks;
+      while (true) {
+        Task task;
+
+        if (pop(i, task)) {
+          run(task);
+          continue;
         }
 
-        task();
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+        mCondition.wait(lock, [this] { return mStop || mPendingTasks > 0; });
 
-        std::unique_lock<std::mutex> lock(mMutex);
-        --mRunningTasks;
+        if (mStop && mPendingTasks == 0) {
+          return;
+        }
       }
     });
   }
@@ -46,7 +145,7 @@ ThreadPool::ThreadPool(size_t threads)
 
 ThreadPool::~ThreadPool() {
   {
-    std::unique_lock<std::mutex> lock(mMutex);
+    std::unique_lock<std::mutex> lock(mSleepMutex);
     mStop = true;
   }
 
@@ -59,4 +158,219 @@ ThreadPool::~ThreadPool() {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+ThreadPool& ThreadPool::getGlobal() {
+  // The global pool is intentionally never destroyed. Joining threads during static destruction
+  // may dead-lock on some platforms when the library is unloaded, and all users of the pool are
+  // expected to wait for their tasks (e.g. using a TaskGroup) before they are destroyed anyways.
+  static ThreadPool* pool = new ThreadPool(std::max(2U, std::thread::hardware_concurrency()));
+  return *pool;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ThreadPool& ThreadPool::getIO() {
+  // Like the global pool, this is never destroyed. The thread count matches the number of threads
+  // the loaders of the WMS plugins used to create for themselves.
+  static ThreadPool* pool = new ThreadPool(32);
+  return *pool;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool ThreadPool::isWorkerThread() const {
+  return tCurrentPool == this;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool ThreadPool::runPendingTask() {
+  Task task;
+
+  size_t start = isWorkerThread() ? tWorkerIndex : mNextQueue.load() % mQueues.size();
+
+  if (!pop(start, task)) {
+    return false;
+  }
+
+  run(task);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ThreadPool::push(Task&& task, TaskPriority priority) {
+  if (mStop) {
+    throw std::runtime_error("enqueue on stopped ThreadPool");
+  }
+
+  size_t queue = isWorkerThread() ? tWorkerIndex : mNextQueue++ % mQueues.size();
+
+  {
+    std::unique_lock<std::mutex> lock(mQueues[queue]->mMutex);
+    mQueues[queue]->mTasks.at(static_cast<size_t>(priority)).emplace_back(std::move(task));
+    ++mPendingTasks;
+  }
+
+  // Locking the mutex here ensures that no worker misses the notification between checking its
+  // wait predicate and going to sleep.
+  { std::unique_lock<std::mutex> lock(mSleepMutex); }
+  mCondition.notify_one();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool ThreadPool::pop(size_t workerIndex, Task& task) {
+  size_t queueCount = mQueues.size();
+
+  // For each priority level, we first try to take the newest task of our own deque. If there is
+  // none, we try to steal the oldest task from any other worker. Only if there are no tasks of
+  // the current priority at all, we continue with the next priority level.
+  for (size_t priority = 0; priority < 3; ++priority) {
+    for (size_t i = 0; i < queueCount; ++i) {
+      auto& queue = *mQueues[(workerIndex + i) % queueCount];
+
+      std::unique_lock<std::mutex> lock(queue.mMutex);
+      auto&                        tasks = queue.mTasks.at(priority);
+
+      if (tasks.empty()) {
+        continue;
+      }
+
+      if (i == 0) {
+        task = std::move(tasks.back());
+        tasks.pop_back();
+      } else {
+        task = std::move(tasks.front());
+        tasks.pop_front();
+      }
+
+      ++mRunningTasks;
+      --mPendingTasks;
+
+      return true;
+    }
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ThreadPool::run(Task& task) {
+  task();
+
+  // Destroy the task before decrementing the counter so that hasFinished() only returns true once
+  // all captured resources have been released.
+  task = Task();
+
+  --mRunningTasks;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TaskGroup::TaskGroup(ThreadPool& pool)
+    : mPool(pool) {
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TaskGroup::~TaskGroup() {
+  wait();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TaskGroup::cancel() {
+  std::unique_lock<std::mutex> lock(mMutex);
+  mToken.cancel();
+  mToken = CancellationToken();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TaskGroup::wait() {
+
+  // Blocking a worker thread could dead-lock the pool if all workers wait for each other. Hence we
+  // process other tasks while waiting. If there are none, we sleep until either a new task is
+  // pushed to the pool or the last task of this group has finished. Both notify the condition
+  // variable of the pool.
+  if (mPool.isWorkerThread()) {
+    while (!hasFinished()) {
+      if (mPool.runPendingTask()) {
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(mPool.mSleepMutex);
+      mPool.mCondition.wait(lock, [this] { return mPool.mPendingTasks > 0 || hasFinished(); });
+    }
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(mMutex);
+  mCondition.wait(lock, [this] { return mPendingTasks + mRunningTasks == 0; });
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+uint32_t TaskGroup::getPendingTaskCount() const {
+  std::unique_lock<std::mutex> lock(mMutex);
+  return mPendingTasks;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+uint32_t TaskGroup::getRunningTaskCount() const {
+  std::unique_lock<std::mutex> lock(mMutex);
+  return mRunningTasks;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool TaskGroup::hasFinished() const {
+  std::unique_lock<std::mutex> lock(mMutex);
+  return mPendingTasks + mRunningTasks == 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TaskGroup::onTaskStarted() {
+  std::unique_lock<std::mutex> lock(mMutex);
+  --mPendingTasks;
+  ++mRunningTasks;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TaskGroup::onTaskDone(bool started) {
+  ThreadPool& pool     = mPool;
+  bool        finished = false;
+
+  {
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    if (started) {
+      --mRunningTasks;
+    } else {
+      --mPendingTasks;
+    }
+
+    // We notify while still holding the lock, as a waiting thread may destroy the group as soon as
+    // it is able to acquire the mutex.
+    finished = mPendingTasks + mRunningTasks == 0;
+    if (finished) {
+      mCondition.notify_all();
+    }
+  }
+
+  // Workers waiting for this group sleep on the condition variable of the pool, see wait(). The
+  // group must not be accessed anymore at this point. Locking the mutex ensures that no worker
+  // misses the notification between checking its wait predicate and going to sleep.
+  if (finished) {
+    { std::unique_lock<std::mutex> lock(pool.mSleepMutex); }
+    pool.mCondition.notify_all();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 } // namespace cs::utils
@@ -10,19 +10,63 @@
 
 #include "cs_utils_export.hpp"
 
+#include <array>
+#include <atomic>
 #include <condition_variable>
-#include <functional>
+#include <deque>
 #include <future>
 #include <memory>
 #include <mutex>
-#include <stack>
 #include <stdexcept>
 #include <thread>
+#include <type_traits>
 #include <vector>
 
 namespace cs::utils {
 
-/// This is based on https://github.com/progschj/ThreadPool
+class TaskGroup;
+
+/// Tasks with a higher priority are always dequeued before tasks with a lower priority. Tasks of
+/// the same priority are executed in no particular order.
+enum class TaskPriority {
+  eHigh   = 0, ///< For work which blocks the next frame (e.g. data required for rendering).
+  eNormal = 1, ///< The default priority.
+  eLow    = 2  ///< For speculative work like prefetching.
+};
+
+/// A CancellationToken can be passed to ThreadPool::enqueue(). If the token is cancelled before a
+/// task has been started, the task will not be executed at all. The std::future returned by
+/// ThreadPool::enqueue() will then throw a std::future_error (std::future_errc::broken_promise).
+/// Tasks which are already running are not interrupted, but they may poll isCancelled() in order
+/// to stop early. Copies of a token share the same state.
+class CS_UTILS_EXPORT CancellationToken {
+ public:
+  CancellationToken();
+
+  /// Marks all tasks which have been enqueued with this token (or a copy of it) as cancelled.
+  void cancel();
+
+  /// Returns true if cancel() has been called on this token or on any of its copies.
+  bool isCancelled() const;
+
+ private:
+  friend class ThreadPool;
+  friend class TaskGroup;
+
+  std::shared_ptr<std::atomic<bool>> mCancelled;
+};
+
+/// This is a work-stealing thread pool. Each worker owns a set of deques (one per TaskPriority).
+/// Tasks enqueued from within a worker are pushed to the worker's own deques, tasks enqueued from
+/// other threads are distributed round-robin. Workers take tasks from the back of their own deques
+/// (so that recently enqueued work is processed first) and steal from the front of other workers'
+/// deques when they run out of work. This is originally based on
+/// https://github.com/progschj/ThreadPool.
+///
+/// Instead of creating a separate pool for each subsystem, consider using the process-wide
+/// instance returned by ThreadPool::getGlobal() together with a TaskGroup. Tasks which mostly block
+/// on network or disk I/O should use ThreadPool::getIO() instead, so that they do not occupy the
+/// threads of the global pool.
 class CS_UTILS_EXPORT ThreadPool {
  public:
   /// Creates a new ThreadPool with the specified amount of threads.
@@ -34,40 +78,39 @@ class CS_UTILS_EXPORT ThreadPool {
   ThreadPool& operator=(ThreadPool const& other) = delete;
   ThreadPool& operator=(ThreadPool&& other)      = delete;
 
+  /// All pending tasks will be executed before the destructor returns.
   virtual ~ThreadPool();
 
-  /// Adds a new work item to the pool.
-  template <class F>
-  auto enqueue(F&& f) -> std::future<typename std::invoke_result<F>::type> {
-    using return_type = typename std::invoke_result<F>::type;
+  /// Returns a process-wide pool with one thread per hardware thread. It is created on first use.
+  static ThreadPool& getGlobal();
 
-    auto task = std::make_shared<std::packaged_task<return_type()>>(
-        [Func = std::forward<F>(f)] { return Func(); });
+  /// Returns a process-wide pool for tasks which spend most of their time waiting for I/O, for
+  /// example downloads. It has a fixed number of threads independent of the hardware, so that
+  /// many requests can be in flight at the same time. It is created on first use.
+  static ThreadPool& getIO();
 
-    std::future<return_type> res = task->get_future();
-    {
-      std::unique_lock<std::mutex> lock(mMutex);
-
-      if (mStop) {
-        throw std::runtime_error("enqueue on stopped ThreadPool");
-      }
+  /// Adds a new work item to the pool. If the given token is cancelled before the task is started,
+  /// the task is dropped and the returned future will throw a std::future_error.
+  template <class F>
+  auto enqueue(F&& f, TaskPriority priority = TaskPriority::eNormal)
+      -> std::future<std::invoke_result_t<F>> {
+    return enqueueImpl(std::forward<F>(f), priority, nullptr, nullptr);
+  }
 
-      mTasks.emplace([task]() { (*task)(); });
-    }
-    mCondition.notify_one();
-    return res;
+  template <class F>
+  auto enqueue(F&& f, TaskPriority priority, CancellationToken const& token)
+      -> std::future<std::invoke_result_t<F>> {
+    return enqueueImpl(std::forward<F>(f), priority, token.mCancelled, nullptr);
   }
 
   /// Returns the amount of tasks that await execution.
   uint32_t getPendingTaskCount() const {
-    std::unique_lock<std::mutex> lock(mMutex);
-    return static_cast<uint32_t>(mTasks.size());
+    return mPendingTasks.load();
   }
 
   /// Returns the number of tasks that currently are being executed.
   uint32_t getRunningTaskCount() const {
-    std::unique_lock<std::mutex> lock(mMutex);
-    return mRunningTasks;
+    return mRunningTasks.load();
   }
 
   /// Retruns true when there are no more tasks running or pending.
@@ -75,13 +118,169 @@ class CS_UTILS_EXPORT ThreadPool {
     return getPendingTaskCount() + getRunningTaskCount() == 0;
   }
 
+  /// Returns the number of worker threads.
+  size_t getThreadCount() const {
+    return mWorkers.size();
+  }
+
+  /// Returns true if the calling thread is one of the workers of this pool.
+  bool isWorkerThread() const;
+
+  /// Dequeues and executes a single pending task on the calling thread. This can be used to help
+  /// the pool while waiting for the results of other tasks. Returns false if there was no pending
+  /// task.
+  bool runPendingTask();
+
+ private:
+  friend class TaskGroup;
+
+  /// A move-only, type-erased callable. In contrast to std::function this does not require the
+  /// wrapped callable to be copyable, so std::packaged_task can be stored directly. If the task
+  /// belongs to a TaskGroup, the group is notified when the task is started and when it is
+  /// finished or dropped.
+  class Task {
+   public:
+    Task() = default;
+
+    template <class F>
+    Task(F&& f, std::shared_ptr<std::atomic<bool>> cancelled, TaskGroup* group)
+        : mImpl(std::make_unique<Model<std::decay_t<F>>>(std::forward<F>(f)))
+        , mCancelled(std::move(cancelled))
+        , mGroup(group) {
+    }
+
+    Task(Task const& other) = delete;
+    Task(Task&& other) noexcept;
+
+    Task& operator=(Task const& other) = delete;
+    Task& operator=(Task&& other) noexcept;
+
+    ~Task();
+
+    /// Returns false if the task has been cancelled and was therefore not executed.
+    bool operator()();
+
+   private:
+    struct Concept {
+      virtual ~Concept() = default;
+      virtual void run() = 0;
+    };
+
+    template <class F>
+    struct Model : Concept {
+      explicit Model(F&& f)
+          : mFunc(std::move(f)) {
+      }
+
+      void run() override {
+        mFunc();
+      }
+
+      F mFunc;
+    };
+
+    void release();
+
+    std::unique_ptr<Concept>           mImpl;
+    std::shared_ptr<std::atomic<bool>> mCancelled;
+    TaskGroup*                         mGroup = nullptr;
+  };
+
+  /// Each worker has one deque per priority level. The deques are protected by a per-worker mutex
+  /// so that workers only contend with each other when stealing.
+  struct WorkerQueue {
+    std::mutex                      mMutex;
+    std::array<std::deque<Task>, 3> mTasks;
+  };
+
+  template <class F>
+  auto enqueueImpl(F&& f, TaskPriority priority, std::shared_ptr<std::atomic<bool>> cancelled,
+      TaskGroup* group) -> std::future<std::invoke_result_t<F>> {
+    using return_type = std::invoke_result_t<F>;
+
+    std::packaged_task<return_type()> task(std::forward<F>(f));
+    std::future<return_type>          res = task.get_future();
+
+    push(Task(std::move(task), std::move(cancelled), group), priority);
+
+    return res;
+  }
+
+  void push(Task&& task, TaskPriority priority);
+  bool pop(size_t workerIndex, Task& task);
+  void run(Task& task);
+
+  std::vector<std::thread>                  mWorkers;
+  std::vector<std::unique_ptr<WorkerQueue>> mQueues;
+
+  std::mutex              mSleepMutex;
+  std::condition_variable mCondition;
+  std::atomic<bool>       mStop{false};
+
+  std::atomic<uint32_t> mPendingTasks{0};
+  std::atomic<uint32_t> mRunningTasks{0};
+  std::atomic<uint32_t> mNextQueue{0};
+};
+
+/// A TaskGroup submits tasks to a ThreadPool and keeps track of them. This allows several
+/// subsystems to share one pool while still being able to query their own progress, to wait for
+/// their own tasks and to cancel all of their pending tasks at once. The destructor waits for all
+/// tasks of the group to finish, so it is safe to capture the owner of the group in its tasks.
+class CS_UTILS_EXPORT TaskGroup {
+ public:
+  /// Creates a new group which submits its tasks to the given pool.
+  explicit TaskGroup(ThreadPool& pool = ThreadPool::getGlobal());
+
+  TaskGroup(TaskGroup const& other) = delete;
+  TaskGroup(TaskGroup&& other)      = delete;
+
+  TaskGroup& operator=(TaskGroup const& other) = delete;
+  TaskGroup& operator=(TaskGroup&& other)      = delete;
+
+  ~TaskGroup();
+
+  /// Adds a new work item to the pool. See ThreadPool::enqueue() for details. All tasks of a group
+  /// share the same CancellationToken.
+  template <class F>
+  auto enqueue(F&& f, TaskPriority priority = TaskPriority::eNormal)
+      -> std::future<std::invoke_result_t<F>> {
+    std::unique_lock<std::mutex> lock(mMutex);
+    ++mPendingTasks;
+    auto cancelled = mToken.mCancelled;
+    lock.unlock();
+
+    return mPool.enqueueImpl(std::forward<F>(f), priority, std::move(cancelled), this);
+  }
+
+  /// Drops all tasks of this group which have not been started yet. Tasks which are enqueued after
+  /// this call are not affected.
+  void cancel();
+
+  /// Blocks until all tasks of this group have been executed or dropped. If called from a worker
+  /// thread of the pool, the calling thread will help processing pending tasks while waiting.
+  void wait();
+
+  /// Returns the amount of tasks of this group that await execution.
+  uint32_t getPendingTaskCount() const;
+
+  /// Returns the number of tasks of this group that currently are being executed.
+  uint32_t getRunningTaskCount() const;
+
+  /// Retruns true when there are no more tasks of this group running or pending.
+  bool hasFinished() const;
+
  private:
-  std::vector<std::thread>          mWorkers;
-  std::stack<std::function<void()>> mTasks;
-  mutable std::mutex                mMutex;
-  std::condition_variable           mCondition;
-  bool                              mStop;
-  uint32_t                          mRunningTasks = 0;
+  friend class ThreadPool;
+
+  void onTaskStarted();
+  void onTaskDone(bool started);
+
+  ThreadPool&             mPool;
+  CancellationToken       mToken;
+  mutable std::mutex      mMutex;
+  std::condition_variable mCondition;
+  uint32_t                mPendingTasks = 0;
+  uint32_t                mRunningTasks = 0;
 };
 
 } // namespace cs::utils
@@ -14,12 +14,135 @@
 #include <curlpp/Infos.hpp>
 #include <curlpp/Options.hpp>
 
+#include <array>
 #include <cmath>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 
 namespace cs::utils::filesystem {
 
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// A straight-forward implementation of SHA-256 as specified in FIPS 180-4. It is only used for
+// verifying downloaded files, so it does not need to be particularly fast.
+class SHA256 {
+ public:
+  void update(uint8_t const* data, std::size_t length) {
+    for (std::size_t i = 0; i < length; ++i) {
+      mBlock[mBlockSize++] = data[i];
+
+      if (mBlockSize == mBlock.size()) {
+        processBlock();
+        mBlockSize = 0;
+      }
+    }
+
+    mLength += length;
+  }
+
+  std::string finalize() {
+    uint64_t bitLength = mLength * 8;
+
+    // Append a single one bit, then pad with zeros until eight bytes are left in the block.
+    uint8_t one = 0x80;
+    update(&one, 1);
+
+    uint8_t zero = 0x00;
+    while (mBlockSize != 56) {
+      update(&zero, 1);
+    }
+
+    // The message length in bits is stored big-endian in the last eight bytes.
+    for (int i = 7; i >= 0; --i) {
+      auto byte = static_cast<uint8_t>(bitLength >> (i * 8));
+      update(&byte, 1);
+    }
+
+    std::ostringstream result;
+    for (auto value : mState) {
+      result << std::hex << std::setw(8) << std::setfill('0') << value;
+    }
+
+    return result.str();
+  }
+
+ private:
+  static uint32_t rotr(uint32_t x, uint32_t n) {
+    return (x >> n) | (x << (32 - n));
+  }
+
+  void processBlock() {
+    static constexpr std::array<uint32_t, 64> k = {0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+        0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be,
+        0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+        0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152,
+        0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e,
+        0x92722c85, 0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624,
+        0xf40e3585, 0x106aa070, 0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3,
+        0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+        0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+    std::array<uint32_t, 64> w{};
+
+    for (std::size_t i = 0; i < 16; ++i) {
+      w[i] = static_cast<uint32_t>(mBlock[i * 4 + 0]) << 24 |
+             static_cast<uint32_t>(mBlock[i * 4 + 1]) << 16 |
+             static_cast<uint32_t>(mBlock[i * 4 + 2]) << 8 |
+             static_cast<uint32_t>(mBlock[i * 4 + 3]);
+    }
+
+    for (std::size_t i = 16; i < 64; ++i) {
+      uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+      uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+      w[i]        = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    auto [a, b, c, d, e, f, g, h] = mState;
+
+    for (std::size_t i = 0; i < 64; ++i) {
+      uint32_t s1    = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+      uint32_t ch    = (e & f) ^ (~e & g);
+      uint32_t temp1 = h + s1 + ch + k[i] + w[i];
+      uint32_t s0    = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+      uint32_t maj   = (a & b) ^ (a & c) ^ (b & c);
+      uint32_t temp2 = s0 + maj;
+
+      h = g;
+      g = f;
+      f = e;
+      e = d + temp1;
+      d = c;
+      c = b;
+      b = a;
+      a = temp1 + temp2;
+    }
+
+    mState[0] += a;
+    mState[1] += b;
+    mState[2] += c;
+    mState[3] += d;
+    mState[4] += e;
+    mState[5] += f;
+    mState[6] += g;
+    mState[7] += h;
+  }
+
+  std::array<uint32_t, 8> mState = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f,
+      0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+  std::array<uint8_t, 64> mBlock{};
+  std::size_t             mBlockSize = 0;
+  uint64_t                mLength    = 0;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void createDirectoryRecursively(
@@ -89,6 +212,27 @@ void writeStringToFile(std::string const& filePath, std::string const& content)
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+std::string computeSHA256(std::string const& file) {
+  std::ifstream stream(file, std::ifstream::in | std::ifstream::binary);
+
+  if (!stream) {
+    throw std::runtime_error("Failed to open " + file + " for computing its checksum!");
+  }
+
+  SHA256            sha256;
+  std::vector<char> buffer(1 << 16);
+
+  while (stream) {
+    stream.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    sha256.update(reinterpret_cast<uint8_t const*>(buffer.data()),
+        static_cast<std::size_t>(stream.gcount()));
+  }
+
+  return sha256.finalize();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 void downloadFile(std::string const& url, std::string const& destination,
     std::function<void(double, double)> const& progressCallback) {
   createDirectoryRecursively(boost::filesystem::path(destination).parent_path());
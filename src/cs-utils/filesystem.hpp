@@ -41,6 +41,10 @@ CS_UTILS_EXPORT std::string loadToString(std::string const& file);
 /// Write the input string into the output file
 CS_UTILS_EXPORT void writeStringToFile(std::string const& filePath, std::string const& content);
 
+/// Computes the SHA-256 hash of the given file and returns it as lower-case hexadecimal string.
+/// This will throw a std::runtime_error if the file cannot be read.
+CS_UTILS_EXPORT std::string computeSHA256(std::string const& file);
+
 /// Downloads a file from te internet. This call will block until the file is downloaded
 /// successfully or an error occurred. If the path to the destination file does not exist, it will
 /// be created. This will throw a std::runtime_error if something bad happend.
@@ -0,0 +1,87 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "../../src/cs-core/EclipseOcclusionTable.hpp"
+#include "../../src/cs-utils/doctest.hpp"
+
+#include <random>
+
+namespace cs::core {
+
+namespace {
+
+// A Sun-Earth-Moon like configuration. The Sun is on the positive x-axis.
+const EclipseOcclusionTable::Sphere cSun{glm::dvec3(1.5e11, 0.0, 0.0), 6.96e8};
+const EclipseOcclusionTable::Sphere cEarth{glm::dvec3(0.0, 0.0, 0.0), 6.371e6};
+
+// Creates a scene with the given number of bodies scattered around the Earth. The first few bodies
+// are used as occluders.
+std::vector<EclipseOcclusionTable::Sphere> createBodies(int count) {
+  std::mt19937                           gen(42);
+  std::uniform_real_distribution<double> position(-4e8, 4e8);
+  std::uniform_real_distribution<double> radius(1e3, 2e6);
+
+  std::vector<EclipseOcclusionTable::Sphere> bodies{cEarth};
+
+  for (int i = 1; i < count; ++i) {
+    bodies.push_back({glm::dvec3(position(gen), position(gen), position(gen)), radius(gen)});
+  }
+
+  return bodies;
+}
+
+} // namespace
+
+TEST_CASE("cs::core::EclipseOcclusionTable::isInPenumbra") {
+  // The Moon during a lunar eclipse.
+  CHECK_UNARY(EclipseOcclusionTable::isInPenumbra(
+      cSun, cEarth, {glm::dvec3(-3.84e8, 0.0, 0.0), 1.737e6}));
+
+  // The Moon next to the penumbra.
+  CHECK_UNARY_FALSE(EclipseOcclusionTable::isInPenumbra(
+      cSun, cEarth, {glm::dvec3(-3.84e8, 3e7, 0.0), 1.737e6}));
+
+  // The Moon between the Earth and the Sun.
+  CHECK_UNARY_FALSE(EclipseOcclusionTable::isInPenumbra(
+      cSun, cEarth, {glm::dvec3(3.84e8, 0.0, 0.0), 1.737e6}));
+
+  // Far away receivers are ignored.
+  CHECK_UNARY_FALSE(EclipseOcclusionTable::isInPenumbra(
+      cSun, cEarth, {glm::dvec3(-1e11, 0.0, 0.0), 1.737e6}));
+}
+
+TEST_CASE("cs::core::EclipseOcclusionTable::update") {
+  auto bodies    = createBodies(200);
+  auto occluders = std::vector<EclipseOcclusionTable::Sphere>(bodies.begin(), bodies.begin() + 8);
+
+  EclipseOcclusionTable table;
+  CHECK(table.getReceiverCount() == 0);
+
+  table.update(cSun, occluders, bodies);
+  CHECK(table.getReceiverCount() == bodies.size());
+
+  // The table must contain exactly the pairs for which isInPenumbra() returns true.
+  for (size_t r = 0; r < bodies.size(); ++r) {
+    size_t count = 0;
+    auto   data  = table.getOccluders(r, count);
+
+    std::vector<uint32_t> expected;
+    for (size_t o = 0; o < occluders.size(); ++o) {
+      if (EclipseOcclusionTable::isInPenumbra(cSun, occluders[o], bodies[r])) {
+        expected.push_back(static_cast<uint32_t>(o));
+      }
+    }
+
+    CHECK(std::vector<uint32_t>(data, data + count) == expected);
+  }
+
+  // Updating with fewer receivers shrinks the table.
+  table.update(cSun, occluders, {cEarth});
+  CHECK(table.getReceiverCount() == 1);
+}
+
+} // namespace cs::core
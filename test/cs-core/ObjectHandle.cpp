@@ -0,0 +1,68 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "../../src/cs-core/ObjectHandle.hpp"
+#include "../../src/cs-utils/doctest.hpp"
+
+namespace cs::core {
+
+TEST_CASE("cs::core::ObjectHandle") {
+  ObjectHandle handle;
+  CHECK_UNARY_FALSE(handle);
+  CHECK(handle.get() == nullptr);
+  CHECK(handle.getName().empty());
+}
+
+TEST_CASE("cs::core::ObjectHandleRegistry::getHandle") {
+  ObjectHandleRegistry::ObjectMap objects;
+  auto earth = std::make_shared<scene::CelestialObject>("Earth", "IAU_Earth");
+  objects.insert("Earth", earth);
+
+  ObjectHandleRegistry registry(objects);
+
+  auto handle = registry.getHandle("Earth");
+  CHECK_UNARY(handle);
+  CHECK(handle.get() == earth);
+  CHECK(handle->getCenterName() == "Earth");
+  CHECK(handle.getName() == "Earth");
+  CHECK(handle == registry.getHandle("Earth"));
+
+  // Handles may also be created before the object exists.
+  auto moon = registry.getHandle("Moon");
+  CHECK_UNARY_FALSE(moon);
+  CHECK(moon.getName() == "Moon");
+  CHECK(moon != handle);
+}
+
+TEST_CASE("cs::core::ObjectHandleRegistry updates handles") {
+  ObjectHandleRegistry::ObjectMap objects;
+  objects.insert("Earth", std::make_shared<scene::CelestialObject>("Earth", "IAU_Earth"));
+
+  ObjectHandleRegistry registry(objects);
+
+  auto earth = registry.getHandle("Earth");
+  auto copy  = earth;
+  auto moon  = registry.getHandle("Moon");
+
+  objects.erase("Earth");
+  CHECK_UNARY_FALSE(earth);
+  CHECK_UNARY_FALSE(copy);
+
+  auto newEarth = std::make_shared<scene::CelestialObject>("Earth", "J2000");
+  auto newMoon  = std::make_shared<scene::CelestialObject>("Moon", "IAU_Moon");
+  objects.insert("Earth", newEarth);
+  objects.insert("Moon", newMoon);
+  CHECK(earth.get() == newEarth);
+  CHECK(copy.get() == newEarth);
+  CHECK(moon.get() == newMoon);
+
+  objects.clear();
+  CHECK_UNARY_FALSE(earth);
+  CHECK_UNARY_FALSE(moon);
+}
+
+} // namespace cs::core
@@ -0,0 +1,324 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "../../src/cs-utils/Downloader.hpp"
+#include "../../src/cs-utils/doctest.hpp"
+#include "../../src/cs-utils/filesystem.hpp"
+
+#include <boost/algorithm/string.hpp>
+#include <boost/asio.hpp>
+
+namespace cs::utils {
+
+namespace {
+
+// A minimal HTTP/1.1 server which serves one file from memory. It supports HEAD requests, range
+// requests with If-Range and conditional requests with If-None-Match. Connections are handled one
+// after another and closed after each response.
+class HTTPStub {
+ public:
+  HTTPStub()
+      : mAcceptor(mContext,
+            boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0)) {
+    mThread = std::thread([this]() { serve(); });
+  }
+
+  ~HTTPStub() {
+    // Connect once more to unblock the accept() call.
+    mStop = true;
+    boost::asio::ip::tcp::socket socket(mContext);
+    socket.connect(mAcceptor.local_endpoint());
+    mThread.join();
+  }
+
+  std::string getURL() const {
+    return "http://127.0.0.1:" + std::to_string(mAcceptor.local_endpoint().port()) + "/file";
+  }
+
+  void setContent(std::string content, std::string etag) {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mContent = std::move(content);
+    mETag    = std::move(etag);
+  }
+
+  // If set, the connection is closed after this many bytes of the next response body.
+  std::atomic<uint64_t> mInterruptAfter{0};
+
+  std::atomic<uint64_t> mServedBytes{0};
+  std::atomic<uint32_t> mGetRequests{0};
+
+ private:
+  void serve() {
+    while (true) {
+      boost::asio::ip::tcp::socket socket(mContext);
+      mAcceptor.accept(socket);
+
+      if (mStop) {
+        return;
+      }
+
+      try {
+        handle(socket);
+      } catch (std::exception const&) {
+        // The client may close the connection at any time.
+      }
+    }
+  }
+
+  void handle(boost::asio::ip::tcp::socket& socket) {
+    boost::asio::streambuf buffer;
+    boost::asio::read_until(socket, buffer, "\r\n\r\n");
+
+    std::istream request(&buffer);
+    std::string  method;
+    std::string  line;
+    request >> method;
+    std::getline(request, line);
+
+    std::map<std::string, std::string> headers;
+    while (std::getline(request, line) && line != "\r") {
+      auto colon = line.find(':');
+      if (colon != std::string::npos) {
+        headers[boost::algorithm::to_lower_copy(line.substr(0, colon))] =
+            boost::algorithm::trim_copy(line.substr(colon + 1));
+      }
+    }
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    std::string                  status = "200 OK";
+    std::string                  body   = mContent;
+    std::string                  extraHeaders;
+
+    if (headers.count("if-none-match") && headers["if-none-match"] == mETag) {
+      status = "304 Not Modified";
+      body.clear();
+    } else if (headers.count("range") &&
+               (!headers.count("if-range") || headers["if-range"] == mETag)) {
+      // We only support "bytes=first-" and "bytes=first-last".
+      auto     range = headers["range"].substr(6);
+      auto     dash  = range.find('-');
+      uint64_t first = std::stoull(range.substr(0, dash));
+      uint64_t last  = dash + 1 < range.size() ? std::stoull(range.substr(dash + 1))
+                                               : mContent.size() - 1;
+
+      if (first >= mContent.size()) {
+        status       = "416 Range Not Satisfiable";
+        body.clear();
+        extraHeaders = "Content-Range: bytes */" + std::to_string(mContent.size()) + "\r\n";
+      } else {
+        status       = "206 Partial Content";
+        body         = mContent.substr(first, last - first + 1);
+        extraHeaders = "Content-Range: bytes " + std::to_string(first) + "-" +
+                       std::to_string(last) + "/" + std::to_string(mContent.size()) + "\r\n";
+      }
+    }
+
+    std::string response = "HTTP/1.1 " + status + "\r\n" + extraHeaders +
+                           "Content-Length: " + std::to_string(body.size()) + "\r\n" +
+                           "Accept-Ranges: bytes\r\nETag: " + mETag +
+                           "\r\nConnection: close\r\n\r\n";
+
+    if (method == "GET") {
+      ++mGetRequests;
+
+      uint64_t interrupt = mInterruptAfter.exchange(0);
+      if (interrupt > 0) {
+        body.resize(interrupt);
+      }
+
+      response += body;
+      mServedBytes += body.size();
+    }
+
+    boost::asio::write(socket, boost::asio::buffer(response));
+    socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both);
+  }
+
+  boost::asio::io_context        mContext;
+  boost::asio::ip::tcp::acceptor mAcceptor;
+  std::thread                    mThread;
+  std::atomic<bool>              mStop{false};
+
+  std::mutex  mMutex;
+  std::string mContent;
+  std::string mETag;
+};
+
+std::string createContent(size_t size) {
+  std::string content(size, ' ');
+  for (size_t i = 0; i < size; ++i) {
+    content[i] = static_cast<char>('a' + (i * 7) % 26);
+  }
+  return content;
+}
+
+void downloadAndWait(Downloader& downloader, std::string const& url, std::string const& file,
+    Downloader::Options const& options = Downloader::Options()) {
+  downloader.download(url, file, options);
+  while (!downloader.hasFinished()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+} // namespace
+
+TEST_CASE("cs::utils::Downloader") {
+  filesystem::createDirectoryRecursively("./testDirDownloader");
+  std::string file = "./testDirDownloader/basic.txt";
+  boost::filesystem::remove(file);
+
+  HTTPStub stub;
+  stub.setContent(createContent(5000), "\"v1\"");
+
+  Downloader downloader;
+  downloadAndWait(downloader, stub.getURL(), file);
+
+  CHECK(downloader.getFailedCount() == 0);
+  CHECK(downloader.getProgress() == doctest::Approx(100.0));
+  CHECK(filesystem::loadToString(file) == createContent(5000));
+  CHECK_UNARY_FALSE(boost::filesystem::exists(file + ".part"));
+  CHECK(filesystem::loadToString(file + ".meta") == "\"v1\"\n\n");
+
+  // Existing files are not downloaded again.
+  downloadAndWait(downloader, stub.getURL(), file);
+  CHECK(stub.mGetRequests == 1);
+}
+
+TEST_CASE("cs::utils::Downloader resumes interrupted downloads") {
+  filesystem::createDirectoryRecursively("./testDirDownloader");
+  std::string file = "./testDirDownloader/resume.txt";
+  boost::filesystem::remove(file);
+  boost::filesystem::remove(file + ".part");
+
+  HTTPStub stub;
+  stub.setContent(createContent(5000), "\"v1\"");
+  stub.mInterruptAfter = 1000;
+
+  {
+    Downloader downloader;
+    downloadAndWait(downloader, stub.getURL(), file);
+    CHECK(downloader.getFailedCount() == 1);
+  }
+
+  CHECK_UNARY_FALSE(boost::filesystem::exists(file));
+  CHECK(boost::filesystem::file_size(file + ".part") == 1000);
+
+  // Only the missing bytes are requested the second time.
+  stub.mServedBytes = 0;
+
+  Downloader downloader;
+  downloadAndWait(downloader, stub.getURL(), file);
+
+  CHECK(downloader.getFailedCount() == 0);
+  CHECK(stub.mServedBytes == 4000);
+  CHECK(filesystem::loadToString(file) == createContent(5000));
+
+  // If the file changes on the server, partial data is discarded.
+  boost::filesystem::remove(file);
+  stub.mInterruptAfter = 1000;
+
+  {
+    Downloader downloader;
+    downloadAndWait(downloader, stub.getURL(), file);
+  }
+
+  stub.setContent(createContent(3000), "\"v2\"");
+
+  downloadAndWait(downloader, stub.getURL(), file);
+  CHECK(filesystem::loadToString(file) == createContent(3000));
+}
+
+TEST_CASE("cs::utils::Downloader keeps complete partial downloads") {
+  filesystem::createDirectoryRecursively("./testDirDownloader");
+  std::string file = "./testDirDownloader/complete.txt";
+  boost::filesystem::remove(file);
+
+  HTTPStub stub;
+  stub.setContent(createContent(5000), "\"v1\"");
+
+  // This is what is left behind if a download fails after the last byte has been received.
+  filesystem::writeStringToFile(file + ".part", createContent(5000));
+  filesystem::writeStringToFile(file + ".part.meta", "\"v1\"\n\n");
+
+  Downloader downloader;
+  downloadAndWait(downloader, stub.getURL(), file);
+
+  CHECK(downloader.getFailedCount() == 0);
+  CHECK(filesystem::loadToString(file) == createContent(5000));
+  CHECK_UNARY_FALSE(boost::filesystem::exists(file + ".part"));
+}
+
+TEST_CASE("cs::utils::Downloader verifies checksums") {
+  filesystem::createDirectoryRecursively("./testDirDownloader");
+  std::string file = "./testDirDownloader/checksum.txt";
+  boost::filesystem::remove(file);
+
+  HTTPStub stub;
+  stub.setContent("abc", "\"v1\"");
+
+  Downloader          downloader;
+  Downloader::Options options;
+
+  options.mSHA256 = "0000000000000000000000000000000000000000000000000000000000000000";
+  downloadAndWait(downloader, stub.getURL(), file, options);
+
+  CHECK(downloader.getFailedCount() == 1);
+  CHECK_UNARY_FALSE(boost::filesystem::exists(file));
+  CHECK_UNARY_FALSE(boost::filesystem::exists(file + ".part"));
+
+  options.mSHA256 = "BA7816BF8F01CFEA414140DE5DAE2223B00361A396177A9CB410FF61F20015AD";
+  downloadAndWait(downloader, stub.getURL(), file, options);
+
+  CHECK(downloader.getFailedCount() == 1);
+  CHECK(filesystem::loadToString(file) == "abc");
+}
+
+TEST_CASE("cs::utils::Downloader refreshes changed files") {
+  filesystem::createDirectoryRecursively("./testDirDownloader");
+  std::string file = "./testDirDownloader/refresh.txt";
+  boost::filesystem::remove(file);
+
+  HTTPStub stub;
+  stub.setContent("first", "\"v1\"");
+
+  Downloader          downloader;
+  Downloader::Options options;
+  options.mRefresh = true;
+
+  downloadAndWait(downloader, stub.getURL(), file, options);
+  CHECK(stub.mGetRequests == 1);
+
+  // The file has not changed, so the conditional request should not download anything.
+  downloadAndWait(downloader, stub.getURL(), file, options);
+  CHECK(stub.mGetRequests == 1);
+  CHECK(filesystem::loadToString(file) == "first");
+
+  stub.setContent("second", "\"v2\"");
+
+  downloadAndWait(downloader, stub.getURL(), file, options);
+  CHECK(stub.mGetRequests == 2);
+  CHECK(filesystem::loadToString(file) == "second");
+}
+
+TEST_CASE("cs::utils::Downloader downloads large files in chunks") {
+  filesystem::createDirectoryRecursively("./testDirDownloader");
+  std::string file = "./testDirDownloader/chunks.txt";
+  boost::filesystem::remove(file);
+
+  HTTPStub stub;
+  stub.setContent(createContent(10000), "\"v1\"");
+
+  Downloader downloader(1024);
+  downloadAndWait(downloader, stub.getURL(), file);
+
+  CHECK(downloader.getFailedCount() == 0);
+  CHECK(stub.mGetRequests == Downloader::cMaxChunks);
+  CHECK(filesystem::loadToString(file) == createContent(10000));
+  CHECK_UNARY_FALSE(boost::filesystem::exists(file + ".part.0"));
+}
+
+} // namespace cs::utils
@@ -0,0 +1,83 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "../../src/cs-utils/FrameStats.hpp"
+#include "../../src/cs-utils/doctest.hpp"
+
+#include <thread>
+
+namespace cs::utils {
+TEST_CASE("cs::utils::FrameStats::RangeId") {
+  FrameStats::RangeId a("lorem");
+  FrameStats::RangeId b("ipsum");
+  FrameStats::RangeId c(std::string("lor") + "em");
+  FrameStats::RangeId invalid;
+
+  CHECK(a == c);
+  CHECK(a != b);
+  CHECK(std::hash<FrameStats::RangeId>()(a) == std::hash<FrameStats::RangeId>()(c));
+  CHECK(a.getName() == "lorem");
+  CHECK(b.getName() == "ipsum");
+
+  CHECK_UNARY(a.isValid());
+  CHECK_UNARY_FALSE(invalid.isValid());
+  CHECK(invalid.getName().empty());
+}
+
+TEST_CASE("cs::utils::FrameStats::startTimerQuery") {
+  auto&               stats = FrameStats::get();
+  FrameStats::RangeId range("FrameStats::startTimerQuery");
+
+  stats.pEnableMeasurements = false;
+  CHECK(stats.startTimerQuery(range, FrameStats::TimerMode::eCPU) == -1);
+  CHECK(stats.startTimerQuery("FrameStats::startTimerQuery", FrameStats::TimerMode::eCPU) == -1);
+
+  stats.pEnableMeasurements = true;
+  auto id                   = stats.startTimerQuery(range, FrameStats::TimerMode::eCPU);
+  CHECK(id >= 0);
+  stats.endTimerQuery(id);
+
+  stats.pEnableMeasurements = false;
+}
+
+TEST_CASE("cs::utils::FrameStats::writeChromeTrace") {
+  auto&               stats = FrameStats::get();
+  FrameStats::RangeId mainRange("FrameStats::writeChromeTrace main");
+  FrameStats::RangeId workerRange("FrameStats::writeChromeTrace worker");
+
+  stats.pEnableTracing = true;
+
+  uint64_t flowID = 0;
+  {
+    FrameStats::ScopedTimer timer(mainRange, FrameStats::TimerMode::eCPU);
+    flowID = FrameStats::startFlow();
+  }
+
+  CHECK(flowID != 0);
+
+  std::thread worker([&]() {
+    FrameStats::setThreadName("Test Worker");
+    FrameStats::ScopedTrace trace(workerRange, flowID);
+  });
+  worker.join();
+
+  stats.pEnableTracing = false;
+
+  // No flows are started while tracing is disabled.
+  CHECK(FrameStats::startFlow() == 0);
+
+  auto trace = FrameStats::getChromeTrace();
+
+  CHECK_UNARY(trace.find("\"traceEvents\":[") != std::string::npos);
+  CHECK_UNARY(trace.find("\"name\":\"Test Worker\"") != std::string::npos);
+  CHECK_UNARY(trace.find("\"name\":\"FrameStats::writeChromeTrace main\"") != std::string::npos);
+  CHECK_UNARY(trace.find("\"name\":\"FrameStats::writeChromeTrace worker\"") != std::string::npos);
+  CHECK_UNARY(trace.find("\"ph\":\"s\"") != std::string::npos);
+  CHECK_UNARY(trace.find("\"ph\":\"f\"") != std::string::npos);
+}
+
+} // namespace cs::utils
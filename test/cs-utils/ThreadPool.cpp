@@ -0,0 +1,168 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "../../src/cs-utils/ThreadPool.hpp"
+#include "../../src/cs-utils/doctest.hpp"
+
+#include <chrono>
+
+namespace cs::utils {
+TEST_CASE("cs::utils::ThreadPool::enqueue") {
+  ThreadPool pool(4);
+
+  std::vector<std::future<int>> results;
+  for (int i = 0; i < 100; ++i) {
+    results.push_back(pool.enqueue([i]() { return i * i; }));
+  }
+
+  for (int i = 0; i < 100; ++i) {
+    CHECK(results[i].get() == i * i);
+  }
+}
+
+TEST_CASE("cs::utils::ThreadPool::enqueue with move-only tasks") {
+  ThreadPool pool(2);
+
+  auto value  = std::make_unique<int>(42);
+  auto result = pool.enqueue([v = std::move(value)]() { return *v; });
+
+  CHECK(result.get() == 42);
+}
+
+TEST_CASE("cs::utils::ThreadPool::enqueue from within a task") {
+  ThreadPool pool(2);
+
+  auto outer = pool.enqueue([&pool]() {
+    auto inner = pool.enqueue([]() { return 1; });
+
+    // Waiting on a worker thread is fine as long as we help processing pending tasks.
+    while (inner.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+      pool.runPendingTask();
+    }
+    return inner.get() + 1;
+  });
+
+  CHECK(outer.get() == 2);
+}
+
+TEST_CASE("cs::utils::ThreadPool priorities") {
+  ThreadPool pool(1);
+
+  // Block the only worker so that all following tasks are queued.
+  std::promise<void> gate;
+  auto               blocker = pool.enqueue([f = gate.get_future().share()]() { f.wait(); });
+
+  std::mutex       mutex;
+  std::vector<int> order;
+
+  auto record = [&](int i) {
+    return [&, i]() {
+      std::unique_lock<std::mutex> lock(mutex);
+      order.push_back(i);
+    };
+  };
+
+  pool.enqueue(record(2), TaskPriority::eLow);
+  pool.enqueue(record(1), TaskPriority::eNormal);
+  pool.enqueue(record(0), TaskPriority::eHigh);
+
+  gate.set_value();
+  blocker.get();
+
+  while (!pool.hasFinished()) {
+    std::this_thread::yield();
+  }
+
+  CHECK(order == std::vector<int>{0, 1, 2});
+}
+
+TEST_CASE("cs::utils::ThreadPool cancellation") {
+  ThreadPool pool(1);
+
+  std::promise<void> gate;
+  auto               blocker = pool.enqueue([f = gate.get_future().share()]() { f.wait(); });
+
+  CancellationToken token;
+  std::atomic<bool> executed = false;
+
+  auto result = pool.enqueue([&]() { executed = true; }, TaskPriority::eNormal, token);
+  token.cancel();
+
+  gate.set_value();
+  blocker.get();
+
+  CHECK_THROWS_AS(result.get(), std::future_error);
+  CHECK_FALSE(executed);
+}
+
+TEST_CASE("cs::utils::TaskGroup") {
+  ThreadPool pool(2);
+
+  std::atomic<int> counter = 0;
+
+  {
+    TaskGroup group(pool);
+
+    for (int i = 0; i < 50; ++i) {
+      group.enqueue([&]() { ++counter; });
+    }
+
+    group.wait();
+    CHECK(counter == 50);
+    CHECK(group.hasFinished());
+  }
+}
+
+TEST_CASE("cs::utils::TaskGroup::wait on a worker thread") {
+  ThreadPool pool(2);
+
+  // The inner group's only task is blocked, so the outer task has to sleep in wait() until the
+  // task has finished. Both workers are occupied then, so no other task can be processed.
+  std::promise<void> gate;
+  auto               released = gate.get_future().share();
+
+  auto outer = pool.enqueue([&pool, released]() {
+    TaskGroup group(pool);
+    group.enqueue([released]() { released.wait(); });
+    group.wait();
+    return group.hasFinished();
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  gate.set_value();
+
+  CHECK(outer.get());
+}
+
+TEST_CASE("cs::utils::TaskGroup::cancel") {
+  ThreadPool pool(1);
+  TaskGroup  group(pool);
+
+  std::promise<void> gate;
+  auto               blocker = pool.enqueue([f = gate.get_future().share()]() { f.wait(); });
+
+  std::atomic<int> counter = 0;
+
+  for (int i = 0; i < 10; ++i) {
+    group.enqueue([&]() { ++counter; });
+  }
+
+  CHECK(group.getPendingTaskCount() == 10);
+
+  group.cancel();
+
+  // Tasks enqueued after cancel() are not affected.
+  group.enqueue([&]() { ++counter; });
+
+  gate.set_value();
+  group.wait();
+
+  CHECK(counter == 1);
+  CHECK(group.hasFinished());
+}
+
+} // namespace cs::utils
@@ -43,4 +43,21 @@ TEST_CASE("cs::utils::filesystem::create_and_list_files") {
   CHECK_EQ(*(++result.begin()), "./testDir/testfile.txt");
 };
 
+TEST_CASE("cs::utils::filesystem::computeSHA256") {
+  cs::utils::filesystem::createDirectoryRecursively("./testDirSHA");
+  cs::utils::filesystem::writeStringToFile("./testDirSHA/empty.sha", "");
+  cs::utils::filesystem::writeStringToFile("./testDirSHA/abc.sha", "abc");
+  cs::utils::filesystem::writeStringToFile(
+      "./testDirSHA/long.sha", "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq");
+
+  CHECK_EQ(cs::utils::filesystem::computeSHA256("./testDirSHA/empty.sha"),
+      "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+  CHECK_EQ(cs::utils::filesystem::computeSHA256("./testDirSHA/abc.sha"),
+      "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+  CHECK_EQ(cs::utils::filesystem::computeSHA256("./testDirSHA/long.sha"),
+      "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+
+  CHECK_THROWS(cs::utils::filesystem::computeSHA256("./testDirSHA/missing.sha"));
+};
+
 } // namespace cs::utils
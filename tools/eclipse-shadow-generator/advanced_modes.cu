@@ -11,9 +11,11 @@
 #include "common.hpp"
 #include "gpuErrCheck.hpp"
 #include "math.cuh"
+#include "parallel.cuh"
 #include "tiff_utils.hpp"
 
 #include <cstdint>
+#include <cstdio>
 #include <iostream>
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -29,7 +31,7 @@ enum class Mode { eShadow, eLimbLuminance, ePlanetView, eAtmoView };
 // Tonemapping code and color space conversions.
 // http://filmicworlds.com/blog/filmic-tonemapping-operators/
 
-__device__ glm::vec3 uncharted2Tonemap(glm::vec3 color) {
+__host__ __device__ glm::vec3 uncharted2Tonemap(glm::vec3 color) {
   const float A = 0.15;
   const float B = 0.50;
   const float C = 0.10;
@@ -39,91 +41,211 @@ __device__ glm::vec3 uncharted2Tonemap(glm::vec3 color) {
   return ((color * (A * color + C * B) + D * E) / (color * (A * color + B) + D * F)) - E / F;
 }
 
-__device__ glm::vec3 tonemap(glm::vec3 color) {
+__host__ __device__ glm::vec3 tonemap(glm::vec3 color) {
   const float W        = 11.2;
   color                = uncharted2Tonemap(10.0f * color);
   glm::vec3 whiteScale = glm::vec3(1.0) / uncharted2Tonemap(glm::vec3(W));
   return color * whiteScale;
 }
 
-__device__ float linearToSRGB(float value) {
+__host__ __device__ float linearToSRGB(float value) {
   if (value <= 0.0031308f)
     return 12.92f * value;
   else
     return 1.055f * pow(value, 1.0f / 2.4f) - 0.055f;
 }
 
-__device__ glm::vec3 linearToSRGB(glm::vec3 color) {
+__host__ __device__ glm::vec3 linearToSRGB(glm::vec3 color) {
   return glm::vec3(linearToSRGB(color.r), linearToSRGB(color.g), linearToSRGB(color.b));
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-double __device__ getSunIlluminance(double sunDistance) {
+double __host__ __device__ getSunIlluminance(double sunDistance) {
   const double sunLuminousPower = 3.75e28;
   return sunLuminousPower / (4.0 * glm::pi<double>() * sunDistance * sunDistance);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-__global__ void computeShadowMap(common::Output output, common::Mapping mapping,
-    common::Geometry geometry, common::LimbDarkening limbDarkening, advanced::Textures textures) {
-
-  uint32_t uShadow = blockIdx.x * blockDim.x + threadIdx.x;
-  uint32_t vShadow = blockIdx.y * blockDim.y + threadIdx.y;
-  uint32_t i       = vShadow * output.mSize + uShadow;
+struct ShadowMap {
+  common::Output        mOutput;
+  common::Mapping       mMapping;
+  common::Geometry      mGeometry;
+  common::LimbDarkening mLimbDarkening;
+  advanced::Textures    mTextures;
+
+  __host__ __device__ void operator()(uint32_t uShadow, uint32_t vShadow, uint32_t /*z*/) const {
+    uint32_t i = vShadow * mOutput.mSize + uShadow;
+
+    // For integrating the luminance over all directions, we render an image of the atmosphere from
+    // the perspective of the point in space. We use a parametrization of the texture space which
+    // contains exactly on half of the atmosphere as seen from the point. The individual sample
+    // points are weighted by the solid angle they cover on the sphere around the point.
+    //
+    //        ┌---..
+    //  vLimb │      '
+    //        └--.     \
+    //      uLimb \     │
+    //             │    │
+    //            /     │
+    //        ┌--'     /
+    //        │      .
+    //        └---''
+    //
+    // We use this resolution for the integration:
+    uint32_t samplesULimb = 256;
+    uint32_t samplesVLimb = 256;
+
+    // First, compute the angular radii of Sun and occluder as well as the angle between the two.
+    double phiOcc, phiSun, delta;
+    math::mapPixelToAngles(
+        glm::ivec2(uShadow, vShadow), mOutput.mSize, mMapping, mGeometry, phiOcc, phiSun, delta);
+
+    // Make sure to stick to positions outside the atmosphere.
+    double occDist    = glm::max(mGeometry.mRadiusOcc / glm::sin(phiOcc), mGeometry.mRadiusAtmo);
+    double sunDist    = mGeometry.mRadiusSun / glm::sin(phiSun);
+    double atmoRadius = mGeometry.mRadiusAtmo;
+    double phiAtmo    = glm::asin(atmoRadius / occDist);
+
+    glm::dvec3 camera       = glm::dvec3(0.0, 0.0, occDist);
+    glm::dvec3 sunDirection = glm::dvec3(0.0, glm::sin(delta), -glm::cos(delta));
+
+    glm::vec3 indirectIlluminance(0.0);
+
+    for (uint32_t sampleV = 0; sampleV < samplesVLimb; ++sampleV) {
+      double vLimb            = (static_cast<double>(sampleV) + 0.5) / samplesVLimb;
+      double upperBound       = (static_cast<double>(sampleV) + 1.0) / samplesVLimb;
+      double lowerBound       = static_cast<double>(sampleV) / samplesVLimb;
+      double upperPhiRay      = phiOcc + upperBound * (phiAtmo - phiOcc);
+      double lowerPhiRay      = phiOcc + lowerBound * (phiAtmo - phiOcc);
+      double rowSolidAngle =
+          0.5 * (math::getCapArea(upperPhiRay) - math::getCapArea(lowerPhiRay));
+      double sampleSolidAngle = rowSolidAngle / samplesULimb;
+
+      for (uint32_t sampleU = 0; sampleU < samplesULimb; ++sampleU) {
+
+        double beta = ((static_cast<double>(sampleU) + 0.5) / samplesULimb) * M_PI;
+
+        // Compute the direction of the ray.
+        double     phiRay = phiOcc + vLimb * (phiAtmo - phiOcc);
+        glm::dvec3 rayDir = glm::dvec3(0.0, glm::sin(phiRay), -glm::cos(phiRay));
+        rayDir =
+            glm::normalize(math::rotateVector(rayDir, glm::dvec3(0.0, 0.0, -1.0), glm::cos(beta)));
+
+        glm::vec3 luminance = advanced::getLuminance(
+            camera, rayDir, sunDirection, mGeometry, mLimbDarkening, mTextures, phiSun);
+
+        indirectIlluminance += luminance * static_cast<float>(sampleSolidAngle);
+      }
+    }
 
-  if ((uShadow >= output.mSize) || (vShadow >= output.mSize)) {
-    return;
+    // We only computed half of the atmosphere, so we multiply the result by two.
+    indirectIlluminance *= 2.0;
+
+    // We now have the light which reaches our point through the atmosphere. However, there is also
+    // a certain amount of direct sunlight which reaches the point from paths which do not intersect
+    // the atmosphere. We use the formula from the simple mode to compute the visible fraction of
+    // the Sun above the upper atmosphere boundary.
+
+    double sunArea = math::getCircleArea(1.0);
+    double radiusOcc, distance;
+    math::mapPixelToRadii(
+        glm::ivec2(uShadow, vShadow), mOutput.mSize, mMapping, radiusOcc, distance);
+    double radiusAtmo = radiusOcc * mGeometry.mRadiusAtmo / mGeometry.mRadiusOcc;
+    double visibleFraction =
+        1.0 - math::sampleCircleIntersection(1.0, radiusAtmo, distance, mLimbDarkening) / sunArea;
+
+    // We multiply this fraction with the illuminance of the Sun to get the direct
+    // illuminance.
+    double fullIlluminance   = getSunIlluminance(sunDist);
+    double directIlluminance = fullIlluminance * visibleFraction;
+
+    // We add the direct and indirect illuminance to get the total illuminance.
+    glm::dvec3 totalIlluminance = indirectIlluminance + glm::vec3(directIlluminance);
+
+    // And divide by the illuminance at the point if there were no atmosphere and no planet.
+    mOutput.mBuffer[i * 3 + 0] = totalIlluminance.r / fullIlluminance;
+    mOutput.mBuffer[i * 3 + 1] = totalIlluminance.g / fullIlluminance;
+    mOutput.mBuffer[i * 3 + 2] = totalIlluminance.b / fullIlluminance;
+
+    // Print a rough progress estimate.
+    if (i % 1000 == 0) {
+      printf("Progress: %f%%\n", (i / static_cast<float>(mOutput.mSize * mOutput.mSize)) * 100.0);
+    }
   }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
 
-  // For integrating the luminance over all directions, we render an image of the atmosphere from
-  // the perspective of the point in space. We use a parametrization of the texture space which
-  // contains exactly on half of the atmosphere as seen from the point. The individual sample points
-  // are weighted by the solid angle they cover on the sphere around the point.
-  //
-  //        ┌---..
-  //  vLimb │      '
-  //        └--.     \
-  //      uLimb \     │
-  //             │    │
-  //            /     │
-  //        ┌--'     /
-  //        │      .
-  //        └---''
-  //
-  // We use this resolution for the integration:
-  uint32_t samplesULimb = 256;
-  uint32_t samplesVLimb = 256;
-
-  // First, compute the angular radii of Sun and occluder as well as the angle between the two.
-  double phiOcc, phiSun, delta;
-  math::mapPixelToAngles(
-      glm::ivec2(uShadow, vShadow), output.mSize, mapping, geometry, phiOcc, phiSun, delta);
-
-  // Make sure to stick to positions outside the atmosphere.
-  double occDist    = glm::max(geometry.mRadiusOcc / glm::sin(phiOcc), geometry.mRadiusAtmo);
-  double sunDist    = geometry.mRadiusSun / glm::sin(phiSun);
-  double atmoRadius = geometry.mRadiusAtmo;
-  double phiAtmo    = glm::asin(atmoRadius / occDist);
-
-  glm::dvec3 camera       = glm::dvec3(0.0, 0.0, occDist);
-  glm::dvec3 sunDirection = glm::dvec3(0.0, glm::sin(delta), -glm::cos(delta));
-
-  glm::vec3 indirectIlluminance(0.0);
-
-  for (uint32_t sampleV = 0; sampleV < samplesVLimb; ++sampleV) {
-    double vLimb            = (static_cast<double>(sampleV) + 0.5) / samplesVLimb;
-    double upperBound       = (static_cast<double>(sampleV) + 1.0) / samplesVLimb;
-    double lowerBound       = static_cast<double>(sampleV) / samplesVLimb;
-    double upperPhiRay      = phiOcc + upperBound * (phiAtmo - phiOcc);
-    double lowerPhiRay      = phiOcc + lowerBound * (phiAtmo - phiOcc);
-    double rowSolidAngle    = 0.5 * (math::getCapArea(upperPhiRay) - math::getCapArea(lowerPhiRay));
-    double sampleSolidAngle = rowSolidAngle / samplesULimb;
-
-    for (uint32_t sampleU = 0; sampleU < samplesULimb; ++sampleU) {
-
-      double beta = ((static_cast<double>(sampleU) + 0.5) / samplesULimb) * M_PI;
+struct LimbLuminance {
+  common::Output        mOutput;
+  common::Mapping       mMapping;
+  common::Geometry      mGeometry;
+  common::LimbDarkening mLimbDarkening;
+  advanced::Textures    mTextures;
+  int                   mLayers;
+
+  __host__ __device__ void operator()(uint32_t x, uint32_t y, uint32_t z) const {
+    uint32_t i = z * mOutput.mSize * mOutput.mSize + y * mOutput.mSize + x;
+
+    // For precomputing the atmosphere's luminance for every position in the shadow volume, we
+    // render an image of the atmosphere from the perspective of the point in space. We use a
+    // parametrization of the texture space which contains exactly on half of the atmosphere as seen
+    // from the point. We render with a relatively high resolution in the vertical direction to
+    // capture even a small refracted image of the Sun. The output texture however only contain a
+    // few layers in the vLimb direction to keep the memory requirements low. For this, we render
+    // each layer separately and integrate the luminance over the vLimb direction.
+    //
+    //            uLimb - .
+    //       ^   ┌---..     '
+    // vLimb │   ├ -.  /'     \ 
+    //       │   └--./ .  \    │
+    //           │β⁠/ \  .  │   V
+    //           o    │ .  │
+    //               /  .  │
+    //           ┌--'  .  /
+    //           ├ - '   .
+    //           └---''
+    //
+    // The output texture is a 4D texture stored in a 3D texture: The x and y coordinates are the
+    // usual shadow map coordinates, and the z coordinate contains the layers of the atmosphere
+    // image around the planet. The resolution of the texture is [output.mSize, output.mSize,
+    // output.mSize * layers].
+    uint32_t samplesULimb = mOutput.mSize;
+
+    // We use this many vertical samples for each layer.
+    uint32_t samplesVLimb = 256;
+
+    // This thread computes the luminance for this layer and this position along the atmosphere
+    // ring.
+    uint32_t layer   = z / mOutput.mSize;
+    uint32_t sampleU = z % mOutput.mSize;
+
+    // First, compute the angular radii of Sun and occluder as well as the angle between the two.
+    double phiOcc, phiSun, delta;
+    math::mapPixelToAngles(
+        glm::ivec2(x, y), mOutput.mSize, mMapping, mGeometry, phiOcc, phiSun, delta);
+
+    // Make sure to stick to positions outside the atmosphere.
+    double occDist    = glm::max(mGeometry.mRadiusOcc / glm::sin(phiOcc), mGeometry.mRadiusAtmo);
+    double sunDist    = mGeometry.mRadiusSun / glm::sin(phiSun);
+    double atmoRadius = mGeometry.mRadiusAtmo;
+    double phiAtmo    = glm::asin(atmoRadius / occDist);
+
+    glm::dvec3 camera       = glm::dvec3(0.0, 0.0, occDist);
+    glm::dvec3 sunDirection = glm::dvec3(0.0, glm::sin(delta), -glm::cos(delta));
+
+    double beta = ((static_cast<double>(sampleU) + 0.5) / samplesULimb) * M_PI;
+
+    glm::vec3 luminance(0.0);
+
+    for (uint32_t sampleV = 0; sampleV < samplesVLimb; ++sampleV) {
+      double vLimb = (static_cast<double>(sampleV) + 0.5) / samplesVLimb;
+
+      double layerStart = static_cast<double>(layer) / mLayers;
+      double layerEnd   = static_cast<double>(layer + 1) / mLayers;
+      vLimb             = layerStart + vLimb * (layerEnd - layerStart);
 
       // Compute the direction of the ray.
       double     phiRay = phiOcc + vLimb * (phiAtmo - phiOcc);
@@ -131,215 +253,107 @@ __global__ void computeShadowMap(common::Output output, common::Mapping mapping,
       rayDir =
           glm::normalize(math::rotateVector(rayDir, glm::dvec3(0.0, 0.0, -1.0), glm::cos(beta)));
 
-      glm::vec3 luminance = advanced::getLuminance(
-          camera, rayDir, sunDirection, geometry, limbDarkening, textures, phiSun);
-
-      indirectIlluminance += luminance * static_cast<float>(sampleSolidAngle);
+      luminance += advanced::getLuminance(
+                       camera, rayDir, sunDirection, mGeometry, mLimbDarkening, mTextures, phiSun) /
+                   static_cast<float>(samplesVLimb);
     }
-  }
 
-  // We only computed half of the atmosphere, so we multiply the result by two.
-  indirectIlluminance *= 2.0;
-
-  // We now have the light which reaches our point through the atmosphere. However, there is also a
-  // certain amount of direct sunlight which reaches the point from paths which do not intersect the
-  // atmosphere. We use the formula from the simple mode to compute the visible fraction of the Sun
-  // above the upper atmosphere boundary.
-
-  double sunArea = math::getCircleArea(1.0);
-  double radiusOcc, distance;
-  math::mapPixelToRadii(glm::ivec2(uShadow, vShadow), output.mSize, mapping, radiusOcc, distance);
-  double radiusAtmo = radiusOcc * geometry.mRadiusAtmo / geometry.mRadiusOcc;
-  double visibleFraction =
-      1.0 - math::sampleCircleIntersection(1.0, radiusAtmo, distance, limbDarkening) / sunArea;
-
-  // We multiply this fraction with the illuminance of the Sun to get the direct
-  // illuminance.
-  double fullIlluminance   = getSunIlluminance(sunDist);
-  double directIlluminance = fullIlluminance * visibleFraction;
-
-  // We add the direct and indirect illuminance to get the total illuminance.
-  glm::dvec3 totalIlluminance = indirectIlluminance + glm::vec3(directIlluminance);
-
-  // And divide by the illuminance at the point if there were no atmosphere and no planet.
-  output.mBuffer[i * 3 + 0] = totalIlluminance.r / fullIlluminance;
-  output.mBuffer[i * 3 + 1] = totalIlluminance.g / fullIlluminance;
-  output.mBuffer[i * 3 + 2] = totalIlluminance.b / fullIlluminance;
-
-  // Print a rough progress estimate.
-  if (i % 1000 == 0) {
-    printf("Progress: %f%%\n", (i / static_cast<float>(output.mSize * output.mSize)) * 100.0);
+    // And divide by the illuminance at the point if there were no atmosphere and no planet.
+    mOutput.mBuffer[i * 3 + 0] = luminance.r;
+    mOutput.mBuffer[i * 3 + 1] = luminance.g;
+    mOutput.mBuffer[i * 3 + 2] = luminance.b;
+
+    // Print a rough progress estimate.
+    if (i % 1000 == 0) {
+      printf("Progress: %f%%\n",
+          (i / static_cast<float>(mOutput.mSize * mOutput.mSize * mOutput.mSize * mLayers)) *
+              100.0);
+    }
   }
-}
+};
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-__global__ void computeLimbLuminance(common::Output output, common::Mapping mapping,
-    common::Geometry geometry, common::LimbDarkening limbDarkening, advanced::Textures textures,
-    int layers) {
+struct AtmoView {
+  common::Mapping       mMapping;
+  common::Geometry      mGeometry;
+  float                 mExposure;
+  double                mPhiOcc;
+  double                mPhiSun;
+  double                mDelta;
+  common::Output        mOutput;
+  common::LimbDarkening mLimbDarkening;
+  advanced::Textures    mTextures;
 
-  uint32_t x = blockIdx.x * blockDim.x + threadIdx.x;
-  uint32_t y = blockIdx.y * blockDim.y + threadIdx.y;
-  uint32_t z = blockIdx.z * blockDim.z + threadIdx.z;
-  uint32_t i = z * output.mSize * output.mSize + y * output.mSize + x;
+  __host__ __device__ void operator()(uint32_t x, uint32_t y, uint32_t /*z*/) const {
+    uint32_t i = y * mOutput.mSize + x;
 
-  if ((x >= output.mSize) || (y >= output.mSize) || (z >= output.mSize * layers)) {
-    return;
-  }
+    double occDist    = mGeometry.mRadiusOcc / glm::sin(mPhiOcc);
+    double atmoRadius = mGeometry.mRadiusAtmo;
+    double phiAtmo    = glm::asin(atmoRadius / occDist);
 
-  // For precomputing the atmosphere's luminance for every position in the shadow volume, we render
-  // an image of the atmosphere from the perspective of the point in space. We use a parametrization
-  // of the texture space which contains exactly on half of the atmosphere as seen from the point.
-  // We render with a relatively high resolution in the vertical direction to capture even a small
-  // refracted image of the Sun. The output texture however only contain a few layers in the vLimb
-  // direction to keep the memory requirements low. For this, we render each layer separately and
-  // integrate the luminance over the vLimb direction.
-  //
-  //            uLimb - .
-  //       ^   ┌---..     '
-  // vLimb │   ├ -.  /'     \ 
-  //       │   └--./ .  \    │
-  //           │β⁠/ \  .  │   V
-  //           o    │ .  │
-  //               /  .  │
-  //           ┌--'  .  /
-  //           ├ - '   .
-  //           └---''
-  //
-  // The output texture is a 4D texture stored in a 3D texture: The x and y coordinates are the
-  // usual shadow map coordinates, and the z coordinate contains the layers of the atmosphere image
-  // around the planet. The resolution of the texture is [output.mSize, output.mSize, output.mSize *
-  // layers].
-  uint32_t samplesULimb = output.mSize;
-
-  // We use this many vertical samples for each layer.
-  uint32_t samplesVLimb = 256;
-
-  // This thread computes the luminance for this layer and this position along the atmosphere ring.
-  uint32_t layer   = z / output.mSize;
-  uint32_t sampleU = z % output.mSize;
-
-  // First, compute the angular radii of Sun and occluder as well as the angle between the two.
-  double phiOcc, phiSun, delta;
-  math::mapPixelToAngles(glm::ivec2(x, y), output.mSize, mapping, geometry, phiOcc, phiSun, delta);
-
-  // Make sure to stick to positions outside the atmosphere.
-  double occDist    = glm::max(geometry.mRadiusOcc / glm::sin(phiOcc), geometry.mRadiusAtmo);
-  double sunDist    = geometry.mRadiusSun / glm::sin(phiSun);
-  double atmoRadius = geometry.mRadiusAtmo;
-  double phiAtmo    = glm::asin(atmoRadius / occDist);
-
-  glm::dvec3 camera       = glm::dvec3(0.0, 0.0, occDist);
-  glm::dvec3 sunDirection = glm::dvec3(0.0, glm::sin(delta), -glm::cos(delta));
-
-  double beta = ((static_cast<double>(sampleU) + 0.5) / samplesULimb) * M_PI;
-
-  glm::vec3 luminance(0.0);
-
-  for (uint32_t sampleV = 0; sampleV < samplesVLimb; ++sampleV) {
-    double vLimb = (static_cast<double>(sampleV) + 0.5) / samplesVLimb;
-
-    double layerStart = static_cast<double>(layer) / layers;
-    double layerEnd   = static_cast<double>(layer + 1) / layers;
-    vLimb             = layerStart + vLimb * (layerEnd - layerStart);
+    glm::dvec3 camera       = glm::dvec3(0.0, 0.0, occDist);
+    glm::dvec3 sunDirection = glm::dvec3(0.0, glm::sin(mDelta), -glm::cos(mDelta));
 
     // Compute the direction of the ray.
-    double     phiRay = phiOcc + vLimb * (phiAtmo - phiOcc);
+    double beta  = (x / static_cast<double>(mOutput.mSize)) * M_PI;
+    double vLimb = (y / static_cast<double>(mOutput.mSize));
+
+    double     phiRay = mPhiOcc + vLimb * (phiAtmo - mPhiOcc);
     glm::dvec3 rayDir = glm::dvec3(0.0, glm::sin(phiRay), -glm::cos(phiRay));
     rayDir = glm::normalize(math::rotateVector(rayDir, glm::dvec3(0.0, 0.0, -1.0), glm::cos(beta)));
 
-    luminance += advanced::getLuminance(
-                     camera, rayDir, sunDirection, geometry, limbDarkening, textures, phiSun) /
-                 static_cast<float>(samplesVLimb);
-  }
+    glm::vec3 luminance = advanced::getLuminance(
+        camera, rayDir, sunDirection, mGeometry, mLimbDarkening, mTextures, mPhiSun);
 
-  // And divide by the illuminance at the point if there were no atmosphere and no planet.
-  output.mBuffer[i * 3 + 0] = luminance.r;
-  output.mBuffer[i * 3 + 1] = luminance.g;
-  output.mBuffer[i * 3 + 2] = luminance.b;
+    luminance = linearToSRGB(tonemap(luminance * mExposure));
 
-  // Print a rough progress estimate.
-  if (i % 1000 == 0) {
-    printf("Progress: %f%%\n",
-        (i / static_cast<float>(output.mSize * output.mSize * output.mSize * layers)) * 100.0);
+    mOutput.mBuffer[i * 3 + 0] = luminance.r;
+    mOutput.mBuffer[i * 3 + 1] = luminance.g;
+    mOutput.mBuffer[i * 3 + 2] = luminance.b;
   }
-}
+};
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-__global__ void drawAtmoView(common::Mapping mapping, common::Geometry geometry, float exposure,
-    double phiOcc, double phiSun, double delta, common::Output output,
-    common::LimbDarkening limbDarkening, advanced::Textures textures) {
-
-  uint32_t x = blockIdx.x * blockDim.x + threadIdx.x;
-  uint32_t y = blockIdx.y * blockDim.y + threadIdx.y;
-  uint32_t i = y * output.mSize + x;
-
-  if ((x >= output.mSize) || (y >= output.mSize)) {
-    return;
-  }
-
-  double occDist    = geometry.mRadiusOcc / glm::sin(phiOcc);
-  double atmoRadius = geometry.mRadiusAtmo;
-  double phiAtmo    = glm::asin(atmoRadius / occDist);
-
-  glm::dvec3 camera       = glm::dvec3(0.0, 0.0, occDist);
-  glm::dvec3 sunDirection = glm::dvec3(0.0, glm::sin(delta), -glm::cos(delta));
+struct PlanetView {
+  common::Mapping       mMapping;
+  common::Geometry      mGeometry;
+  float                 mExposure;
+  double                mPhiOcc;
+  double                mPhiSun;
+  double                mDelta;
+  float                 mFov;
+  common::Output        mOutput;
+  common::LimbDarkening mLimbDarkening;
+  advanced::Textures    mTextures;
+
+  __host__ __device__ void operator()(uint32_t x, uint32_t y, uint32_t /*z*/) const {
+    uint32_t i = y * mOutput.mSize + x;
+
+    // Total eclipse from Moon, horizon close up.
+    double     occDist      = mGeometry.mRadiusOcc / glm::sin(mPhiOcc);
+    glm::dvec3 camera       = glm::dvec3(0.0, 0.0, occDist);
+    double     fieldOfView  = mFov * M_PI / 180.0;
+    glm::dvec3 sunDirection = glm::dvec3(0.0, glm::sin(mDelta), -glm::cos(mDelta));
 
-  // Compute the direction of the ray.
-  double beta  = (x / static_cast<double>(output.mSize)) * M_PI;
-  double vLimb = (y / static_cast<double>(output.mSize));
-
-  double     phiRay = phiOcc + vLimb * (phiAtmo - phiOcc);
-  glm::dvec3 rayDir = glm::dvec3(0.0, glm::sin(phiRay), -glm::cos(phiRay));
-  rayDir = glm::normalize(math::rotateVector(rayDir, glm::dvec3(0.0, 0.0, -1.0), glm::cos(beta)));
-
-  glm::vec3 luminance = advanced::getLuminance(
-      camera, rayDir, sunDirection, geometry, limbDarkening, textures, phiSun);
-
-  luminance = linearToSRGB(tonemap(luminance * exposure));
-
-  output.mBuffer[i * 3 + 0] = luminance.r;
-  output.mBuffer[i * 3 + 1] = luminance.g;
-  output.mBuffer[i * 3 + 2] = luminance.b;
-}
+    // Compute the direction of the ray.
+    double theta = (x / static_cast<double>(mOutput.mSize) - 0.5) * fieldOfView;
+    double phi   = (y / static_cast<double>(mOutput.mSize) - 0.5) * fieldOfView;
 
-////////////////////////////////////////////////////////////////////////////////////////////////////
+    glm::dvec3 rayDir = glm::dvec3(
+        glm::sin(theta) * glm::cos(phi), glm::sin(phi), -glm::cos(theta) * glm::cos(phi));
 
-__global__ void drawPlanet(common::Mapping mapping, common::Geometry geometry, float exposure,
-    double phiOcc, double phiSun, double delta, float fov, common::Output output,
-    common::LimbDarkening limbDarkening, advanced::Textures textures) {
+    glm::vec3 luminance = advanced::getLuminance(
+        camera, rayDir, sunDirection, mGeometry, mLimbDarkening, mTextures, mPhiSun);
 
-  uint32_t x = blockIdx.x * blockDim.x + threadIdx.x;
-  uint32_t y = blockIdx.y * blockDim.y + threadIdx.y;
-  uint32_t i = y * output.mSize + x;
+    luminance = linearToSRGB(tonemap(luminance * mExposure));
 
-  if ((x >= output.mSize) || (y >= output.mSize)) {
-    return;
+    mOutput.mBuffer[i * 3 + 0] = luminance.r;
+    mOutput.mBuffer[i * 3 + 1] = luminance.g;
+    mOutput.mBuffer[i * 3 + 2] = luminance.b;
   }
-
-  // Total eclipse from Moon, horizon close up.
-  double     occDist      = geometry.mRadiusOcc / glm::sin(phiOcc);
-  glm::dvec3 camera       = glm::dvec3(0.0, 0.0, occDist);
-  double     fieldOfView  = fov * M_PI / 180.0;
-  glm::dvec3 sunDirection = glm::dvec3(0.0, glm::sin(delta), -glm::cos(delta));
-
-  // Compute the direction of the ray.
-  double theta = (x / static_cast<double>(output.mSize) - 0.5) * fieldOfView;
-  double phi   = (y / static_cast<double>(output.mSize) - 0.5) * fieldOfView;
-
-  glm::dvec3 rayDir =
-      glm::dvec3(glm::sin(theta) * glm::cos(phi), glm::sin(phi), -glm::cos(theta) * glm::cos(phi));
-
-  glm::vec3 luminance = advanced::getLuminance(
-      camera, rayDir, sunDirection, geometry, limbDarkening, textures, phiSun);
-
-  luminance = linearToSRGB(tonemap(luminance * exposure));
-
-  output.mBuffer[i * 3 + 0] = luminance.r;
-  output.mBuffer[i * 3 + 1] = luminance.g;
-  output.mBuffer[i * 3 + 2] = luminance.b;
-}
+};
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -349,6 +363,7 @@ int run(Mode mode, std::vector<std::string> const& arguments) {
   common::Mapping  mapping;
   common::Output   output;
   common::Geometry geometry;
+  common::Backend  backend;
   bool             printHelp = false;
 
   // These are only required for the planet or atmosphere view modes.
@@ -367,6 +382,7 @@ int run(Mode mode, std::vector<std::string> const& arguments) {
   common::addMappingFlags(args, mapping);
   common::addOutputFlags(args, output);
   common::addGeometryFlags(args, geometry);
+  common::addBackendFlags(args, backend);
 
   args.addArgument({"--input"}, &input, "The path to the atmosphere settings directory.");
 
@@ -418,37 +434,36 @@ int run(Mode mode, std::vector<std::string> const& arguments) {
     return 1;
   }
 
+  parallel::selectBackend(backend);
+
   // Load the atmosphere settings.
-  auto textures = advanced::loadTextures(input);
+  auto textures = advanced::loadTextures(input, backend);
 
   // Initialize the limb darkening model.
   common::LimbDarkening limbDarkening;
   limbDarkening.init();
 
-  // Compute the 2D kernel size.
-  dim3     blockSize(8, 8, mode == Mode::eLimbLuminance ? 8 : 1);
-  uint32_t numBlocksX = (output.mSize + blockSize.x - 1) / blockSize.x;
-  uint32_t numBlocksY = (output.mSize + blockSize.y - 1) / blockSize.y;
-  uint32_t numBlocksZ = mode == Mode::eLimbLuminance
-                            ? (output.mSize * limbLuminanceLayers + blockSize.z - 1) / blockSize.z
-                            : 1;
-  dim3     gridSize   = dim3(numBlocksX, numBlocksY, numBlocksZ);
-
   // Allocate the shared memory for the shadow map.
   if (mode == Mode::eLimbLuminance) {
-    gpuErrchk(cudaMallocManaged(&output.mBuffer,
-        static_cast<size_t>(output.mSize * output.mSize * output.mSize * limbLuminanceLayers) * 3 *
-            sizeof(float)));
+    output.mBuffer = parallel::allocateBuffer(backend,
+        static_cast<size_t>(output.mSize * output.mSize * output.mSize * limbLuminanceLayers) * 3);
   } else {
-    gpuErrchk(cudaMallocManaged(
-        &output.mBuffer, static_cast<size_t>(output.mSize * output.mSize) * 3 * sizeof(float)));
+    output.mBuffer = parallel::allocateBuffer(
+        backend, static_cast<size_t>(output.mSize * output.mSize) * 3);
   }
 
+  // The limb luminance mode uses a 3D kernel, all other modes use 2D kernels.
+  glm::uvec3 size(output.mSize, output.mSize, 1);
+  dim3       blockSize(8, 8, 1);
+
   if (mode == Mode::eShadow) {
-    computeShadowMap<<<gridSize, blockSize>>>(output, mapping, geometry, limbDarkening, textures);
+    parallel::forEach(
+        backend, size, blockSize, ShadowMap{output, mapping, geometry, limbDarkening, textures});
   } else if (mode == Mode::eLimbLuminance) {
-    computeLimbLuminance<<<gridSize, blockSize>>>(
-        output, mapping, geometry, limbDarkening, textures, limbLuminanceLayers);
+    size.z      = output.mSize * limbLuminanceLayers;
+    blockSize.z = 8;
+    parallel::forEach(backend, size, blockSize,
+        LimbLuminance{output, mapping, geometry, limbDarkening, textures, limbLuminanceLayers});
   } else {
 
     double     phiOcc, phiSun, delta;
@@ -470,17 +485,16 @@ int run(Mode mode, std::vector<std::string> const& arguments) {
     std::cout << " - Sun Elevation: " << glm::degrees(delta) << "°" << std::endl;
 
     if (mode == Mode::ePlanetView) {
-      drawPlanet<<<gridSize, blockSize>>>(
-          mapping, geometry, exposure, phiOcc, phiSun, delta, fov, output, limbDarkening, textures);
+      parallel::forEach(backend, size, blockSize,
+          PlanetView{mapping, geometry, exposure, phiOcc, phiSun, delta, fov, output, limbDarkening,
+              textures});
     } else if (mode == Mode::eAtmoView) {
-      drawAtmoView<<<gridSize, blockSize>>>(
-          mapping, geometry, exposure, phiOcc, phiSun, delta, output, limbDarkening, textures);
+      parallel::forEach(backend, size, blockSize,
+          AtmoView{
+              mapping, geometry, exposure, phiOcc, phiSun, delta, output, limbDarkening, textures});
     }
   }
 
-  gpuErrchk(cudaPeekAtLastError());
-  gpuErrchk(cudaDeviceSynchronize());
-
   // Finally write the output texture!
   if (mode == Mode::eLimbLuminance) {
     tiff_utils::write3D(output.mFile, output.mBuffer, static_cast<int>(output.mSize),
@@ -491,7 +505,8 @@ int run(Mode mode, std::vector<std::string> const& arguments) {
   }
 
   // Free the shared memory.
-  gpuErrchk(cudaFree(output.mBuffer));
+  parallel::freeBuffer(backend, output.mBuffer);
+  advanced::freeTextures(textures);
 
   return 0;
 }
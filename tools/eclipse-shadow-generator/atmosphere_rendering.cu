@@ -20,6 +20,8 @@
 
 #include "tiff_utils.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <nlohmann/json.hpp>
 
@@ -30,7 +32,7 @@ namespace {
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 // Returns the luminance of the Sun in candela per square meter.
-double __device__ getSunLuminance(double sunRadius) {
+double __host__ __device__ getSunLuminance(double sunRadius) {
   const double sunLuminousPower = 3.75e28;
   const double sunLuminousExitance =
       sunLuminousPower / (sunRadius * sunRadius * 4.0 * glm::pi<double>());
@@ -39,18 +41,29 @@ double __device__ getSunLuminance(double sunRadius) {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-// Creates a CUDA texture object from the given RGBA texture.
-cudaTextureObject_t createCudaTexture(tiff_utils::RGBATexture const& texture) {
-  cudaArray* cuArray;
-  auto       channelDesc = cudaCreateChannelDesc<float4>();
+// Creates a texture for the given backend from the given RGBA texture.
+advanced::Texture createTexture(
+    tiff_utils::RGBATexture const& texture, common::Backend const& backend) {
+  advanced::Texture result;
+  result.mWidth  = texture.width;
+  result.mHeight = texture.height;
+
+  // For the CPU backend, we simply keep a copy of the texel data.
+  if (backend.mUseCPU) {
+    result.mData = new float[texture.data.size()];
+    std::copy(texture.data.begin(), texture.data.end(), result.mData);
+    return result;
+  }
+
+  auto channelDesc = cudaCreateChannelDesc<float4>();
 
-  cudaMallocArray(&cuArray, &channelDesc, texture.width, texture.height);
-  cudaMemcpy2DToArray(cuArray, 0, 0, texture.data.data(), texture.width * sizeof(float) * 4,
+  cudaMallocArray(&result.mArray, &channelDesc, texture.width, texture.height);
+  cudaMemcpy2DToArray(result.mArray, 0, 0, texture.data.data(), texture.width * sizeof(float) * 4,
       texture.width * sizeof(float) * 4, texture.height, cudaMemcpyHostToDevice);
 
   cudaResourceDesc resDesc = {};
   resDesc.resType          = cudaResourceTypeArray;
-  resDesc.res.array.array  = cuArray;
+  resDesc.res.array.array  = result.mArray;
 
   cudaTextureDesc texDesc  = {};
   texDesc.addressMode[0]   = cudaAddressModeClamp;
@@ -59,42 +72,82 @@ cudaTextureObject_t createCudaTexture(tiff_utils::RGBATexture const& texture) {
   texDesc.readMode         = cudaReadModeElementType;
   texDesc.normalizedCoords = 1;
 
-  cudaTextureObject_t textureObject = 0;
-  cudaCreateTextureObject(&textureObject, &resDesc, &texDesc, nullptr);
+  cudaCreateTextureObject(&result.mObject, &resDesc, &texDesc, nullptr);
 
   gpuErrchk(cudaGetLastError());
 
-  return textureObject;
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Releases the memory of a texture created with createTexture().
+void freeTexture(advanced::Texture& texture) {
+  if (texture.mObject) {
+    gpuErrchk(cudaDestroyTextureObject(texture.mObject));
+    gpuErrchk(cudaFreeArray(texture.mArray));
+  }
+
+  delete[] texture.mData;
+
+  texture = advanced::Texture();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 // Provides a similar API to the texture2D function in GLSL. Returns the RGBA value at the given
 // texture coordinates as a glm::vec4.
-__device__ glm::vec4 texture2D(cudaTextureObject_t tex, glm::vec2 uv) {
-  auto data = tex2D<float4>(tex, uv.x, uv.y);
+__host__ __device__ glm::vec4 texture2D(advanced::Texture const& tex, glm::vec2 uv) {
+#ifdef __CUDA_ARCH__
+  auto data = tex2D<float4>(tex.mObject, uv.x, uv.y);
   return glm::vec4(data.x, data.y, data.z, data.w);
+#else
+  // This mimics the linear filtering of CUDA textures: Texel centers are located at half-integer
+  // coordinates and all texel fetches are clamped to the edge of the texture. The GPU computes the
+  // interpolation weights with a reduced precision, so the results differ very slightly.
+  float x    = uv.x * static_cast<float>(tex.mWidth) - 0.5F;
+  float y    = uv.y * static_cast<float>(tex.mHeight) - 0.5F;
+  float x0   = std::floor(x);
+  float y0   = std::floor(y);
+  float fx   = x - x0;
+  float fy   = y - y0;
+  int   maxX = static_cast<int>(tex.mWidth) - 1;
+  int   maxY = static_cast<int>(tex.mHeight) - 1;
+
+  auto fetch = [&](int i, int j) {
+    size_t index = 4 * (static_cast<size_t>(glm::clamp(j, 0, maxY)) * tex.mWidth +
+                           static_cast<size_t>(glm::clamp(i, 0, maxX)));
+    return glm::vec4(tex.mData[index + 0], tex.mData[index + 1], tex.mData[index + 2],
+        tex.mData[index + 3]);
+  };
+
+  int i = static_cast<int>(x0);
+  int j = static_cast<int>(y0);
+
+  return glm::mix(glm::mix(fetch(i, j), fetch(i + 1, j), fx),
+      glm::mix(fetch(i, j + 1), fetch(i + 1, j + 1), fx), fy);
+#endif
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 // In case the input value is negative, this function returns 0.0. Otherwise it returns the square
 // root of the input value.
-__device__ float safeSqrt(float a) {
+__host__ __device__ float safeSqrt(float a) {
   return glm::sqrt(glm::max(a, 0.0f));
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 // https://github.com/ebruneton/precomputed_atmospheric_scattering/blob/master/atmosphere/functions.glsl#L342
-__device__ float getTextureCoordFromUnitRange(float x, int textureSize) {
+__host__ __device__ float getTextureCoordFromUnitRange(float x, int textureSize) {
   return 0.5 / float(textureSize) + x * (1.0 - 1.0 / float(textureSize));
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 // https://github.com/ebruneton/precomputed_atmospheric_scattering/blob/master/atmosphere/functions.glsl#L207
-__device__ float distanceToTopAtmosphereBoundary(
+__host__ __device__ float distanceToTopAtmosphereBoundary(
     common::Geometry const& geometry, float r, float mu) {
   float discriminant = r * r * (mu * mu - 1.0) + geometry.mRadiusAtmo * geometry.mRadiusAtmo;
   return glm::max(0.f, -r * mu + safeSqrt(discriminant));
@@ -105,7 +158,7 @@ __device__ float distanceToTopAtmosphereBoundary(
 // As we are always in outer space, this function does not need the r parameter when compared to the
 // original version:
 // https://github.com/ebruneton/precomputed_atmospheric_scattering/blob/master/atmosphere/functions.glsl#L402
-__device__ glm::vec2 getTransmittanceTextureUvFromRMu(
+__host__ __device__ glm::vec2 getTransmittanceTextureUvFromRMu(
     advanced::Textures const& textures, common::Geometry const& geometry, double mu) {
 
   // Distance to top atmosphere boundary for a horizontal ray at ground level.
@@ -126,9 +179,9 @@ __device__ glm::vec2 getTransmittanceTextureUvFromRMu(
 // As we are always in outer space, this function does not need the r parameter when compared to the
 // original version:
 // https://github.com/ebruneton/precomputed_atmospheric_scattering/blob/master/atmosphere/functions.glsl#L773
-__device__ glm::vec3 getScatteringTextureUvwFromRMuMuSNu(advanced::Textures const& textures,
-    common::Geometry const& geometry, double mu, double muS, double nu,
-    bool rayRMuIntersectsGround) {
+__host__ __device__ glm::vec3 getScatteringTextureUvwFromRMuMuSNu(
+    advanced::Textures const& textures, common::Geometry const& geometry, double mu, double muS,
+    double nu, bool rayRMuIntersectsGround) {
 
   // Distance to top atmosphere boundary for a horizontal ray at ground level.
   double H =
@@ -175,7 +228,7 @@ __device__ glm::vec3 getScatteringTextureUvwFromRMuMuSNu(advanced::Textures cons
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 // https://github.com/ebruneton/precomputed_atmospheric_scattering/blob/master/atmosphere/functions.glsl#L473
-__device__ glm::vec3 getTransmittanceToTopAtmosphereBoundary(
+__host__ __device__ glm::vec3 getTransmittanceToTopAtmosphereBoundary(
     advanced::Textures const& textures, common::Geometry const& geometry, double mu) {
   glm::vec2 uv = getTransmittanceTextureUvFromRMu(textures, geometry, mu);
   return glm::vec3(texture2D(textures.mTransmittance, uv));
@@ -184,7 +237,7 @@ __device__ glm::vec3 getTransmittanceToTopAtmosphereBoundary(
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 // https://github.com/ebruneton/precomputed_atmospheric_scattering/blob/master/atmosphere/functions.glsl#L240
-__device__ bool rayIntersectsGround(common::Geometry const& geometry, double mu) {
+__host__ __device__ bool rayIntersectsGround(common::Geometry const& geometry, double mu) {
   return mu < 0.0 && geometry.mRadiusAtmo * geometry.mRadiusAtmo * (mu * mu - 1.0) +
                              geometry.mRadiusOcc * geometry.mRadiusOcc >=
                          0.0;
@@ -194,7 +247,8 @@ __device__ bool rayIntersectsGround(common::Geometry const& geometry, double mu)
 
 // This is different. In the original implementation, the phase function is the Rayleigh phase
 // function. We load the phase function from a texture.
-__device__ glm::vec3 moleculePhaseFunction(cudaTextureObject_t phaseTexture, float nu) {
+__host__ __device__ glm::vec3 moleculePhaseFunction(
+    advanced::Texture const& phaseTexture, float nu) {
   float theta = glm::acos(nu) / M_PI; // 0<->1
   return glm::vec3(texture2D(phaseTexture, glm::vec2(theta, 0.0)));
 }
@@ -203,7 +257,8 @@ __device__ glm::vec3 moleculePhaseFunction(cudaTextureObject_t phaseTexture, flo
 
 // This is different. In the original implementation, the phase function is the Cornette-Shanks
 // phase function. We load the phase function from a texture.
-__device__ glm::vec3 aerosolPhaseFunction(cudaTextureObject_t phaseTexture, float nu) {
+__host__ __device__ glm::vec3 aerosolPhaseFunction(
+    advanced::Texture const& phaseTexture, float nu) {
   float theta = glm::acos(nu) / M_PI; // 0<->1
   return glm::vec3(texture2D(phaseTexture, glm::vec2(theta, 1.0)));
 }
@@ -213,7 +268,7 @@ __device__ glm::vec3 aerosolPhaseFunction(cudaTextureObject_t phaseTexture, floa
 // As we are always in outer space, this function does not need the r parameter when compared to the
 // original version:
 // https://github.com/ebruneton/precomputed_atmospheric_scattering/blob/master/atmosphere/functions.glsl#L1658
-__device__ void getCombinedScattering(advanced::Textures const& textures,
+__host__ __device__ void getCombinedScattering(advanced::Textures const& textures,
     common::Geometry const& geometry, float mu, float muS, float nu, bool rayRMuIntersectsGround,
     glm::vec3& multipleScattering, glm::vec3& singleAerosolsScattering) {
   glm::vec3 uvw =
@@ -236,12 +291,12 @@ __device__ void getCombinedScattering(advanced::Textures const& textures,
 // Rotates the given ray towards the planet's surface by the angle given in the theta deviation
 // texture. Also returns the contact radius which is the distance of closest approach to the
 // planet's surface which the ray had when traveling through the atmosphere.
-__device__ glm::dvec3 getRefractedRay(advanced::Textures const& textures,
+__host__ __device__ glm::dvec3 getRefractedRay(advanced::Textures const& textures,
     common::Geometry const& geometry, glm::dvec3 camera, glm::dvec3 ray, double& contactRadius) {
 
   // If refraction is disabled, we can simply return the ray. However, we still need to compute the
   // contact radius.
-  if (!textures.mThetaDeviation) {
+  if (textures.mThetaDeviation.mWidth == 0) {
     double dist       = glm::length(camera);
     auto   toOccluder = -camera / dist;
     double angle      = math::angleBetweenVectors(ray, toOccluder);
@@ -274,7 +329,7 @@ namespace advanced {
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 // Loads all required textures from the given output directory from the Bruneton preprocessor tool.
-__host__ Textures loadTextures(std::string const& path) {
+__host__ Textures loadTextures(std::string const& path, common::Backend const& backend) {
   uint32_t scatteringTextureRSize = tiff_utils::getNumLayers(path + "/multiple_scattering.tif");
 
   tiff_utils::RGBATexture multiscattering =
@@ -286,11 +341,11 @@ __host__ Textures loadTextures(std::string const& path) {
   tiff_utils::RGBATexture transmittance = tiff_utils::read2DTexture(path + "/transmittance.tif");
 
   Textures textures;
-  textures.mMultipleScattering       = createCudaTexture(multiscattering);
-  textures.mSingleAerosolsScattering = createCudaTexture(singleScattering);
+  textures.mMultipleScattering       = createTexture(multiscattering, backend);
+  textures.mSingleAerosolsScattering = createTexture(singleScattering, backend);
 
-  textures.mPhase         = createCudaTexture(phase);
-  textures.mTransmittance = createCudaTexture(transmittance);
+  textures.mPhase         = createTexture(phase, backend);
+  textures.mTransmittance = createTexture(transmittance, backend);
 
   std::ifstream  metaFile(path + "/metadata.json");
   nlohmann::json meta;
@@ -310,7 +365,7 @@ __host__ Textures loadTextures(std::string const& path) {
   if (enableRefraction) {
     tiff_utils::RGBATexture theta_deviation =
         tiff_utils::read2DTexture(path + "/theta_deviation.tif");
-    textures.mThetaDeviation = createCudaTexture(theta_deviation);
+    textures.mThetaDeviation = createTexture(theta_deviation, backend);
   }
 
   return textures;
@@ -318,12 +373,22 @@ __host__ Textures loadTextures(std::string const& path) {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void freeTextures(Textures& textures) {
+  freeTexture(textures.mPhase);
+  freeTexture(textures.mThetaDeviation);
+  freeTexture(textures.mTransmittance);
+  freeTexture(textures.mMultipleScattering);
+  freeTexture(textures.mSingleAerosolsScattering);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 // Computes the luminance of the atmosphere for the given geometry. All distances are in meters.
 // This is loosely based on the original implementation by Eric Bruneton:
 // https://github.com/ebruneton/precomputed_atmospheric_scattering/blob/master/atmosphere/functions.glsl#L1705
-__device__ glm::vec3 getLuminance(glm::dvec3 camera, glm::dvec3 viewRay, glm::dvec3 sunDirection,
-    common::Geometry const& geometry, common::LimbDarkening const& limbDarkening,
-    Textures const& textures, double phiSun) {
+__host__ __device__ glm::vec3 getLuminance(glm::dvec3 camera, glm::dvec3 viewRay,
+    glm::dvec3 sunDirection, common::Geometry const& geometry,
+    common::LimbDarkening const& limbDarkening, Textures const& textures, double phiSun) {
 
   // Compute the distance to the top atmosphere boundary along the view ray, assuming the viewer is
   // in space (or NaN if the view ray does not intersect the atmosphere).
@@ -14,14 +14,25 @@
 
 namespace advanced {
 
+// A bilinearly filtered RGBA texture with normalized texture coordinates and clamp-to-edge
+// addressing. For the GPU backend, a CUDA texture object is created. For the CPU backend, the
+// texels are kept in host memory and the filtering is done in software.
+struct Texture {
+  cudaTextureObject_t mObject = 0;
+  cudaArray_t         mArray  = nullptr;
+  float*              mData   = nullptr;
+  uint32_t            mWidth  = 0;
+  uint32_t            mHeight = 0;
+};
+
 // These input textures are required for the Bruneton precomputed atmospheric scattering model.
 // They have to be precomputed using the "bruneton-preprocessor" tool of the csp-atmospheres plugin.
 struct Textures {
-  cudaTextureObject_t mPhase                    = 0;
-  cudaTextureObject_t mThetaDeviation           = 0;
-  cudaTextureObject_t mTransmittance            = 0;
-  cudaTextureObject_t mMultipleScattering       = 0;
-  cudaTextureObject_t mSingleAerosolsScattering = 0;
+  Texture mPhase;
+  Texture mThetaDeviation;
+  Texture mTransmittance;
+  Texture mMultipleScattering;
+  Texture mSingleAerosolsScattering;
 
   int    mTransmittanceTextureWidth;
   int    mTransmittanceTextureHeight;
@@ -32,12 +43,16 @@ struct Textures {
 };
 
 // Loads all required textures from the given output directory from the Bruneton preprocessor tool.
-Textures loadTextures(std::string const& path);
+// The textures are created for the given backend.
+Textures loadTextures(std::string const& path, common::Backend const& backend);
+
+// Releases all memory which has been allocated by loadTextures().
+void freeTextures(Textures& textures);
 
 // Computes the luminance of the atmosphere for the given geometry. All distances are in meters.
-__device__ glm::vec3 getLuminance(glm::dvec3 camera, glm::dvec3 viewRay, glm::dvec3 sunDirection,
-    common::Geometry const& geometry, common::LimbDarkening const& limbDarkening,
-    Textures const& textures, double phiSun);
+__host__ __device__ glm::vec3 getLuminance(glm::dvec3 camera, glm::dvec3 viewRay,
+    glm::dvec3 sunDirection, common::Geometry const& geometry,
+    common::LimbDarkening const& limbDarkening, Textures const& textures, double phiSun);
 
 } // namespace advanced
 
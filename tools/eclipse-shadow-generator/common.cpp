@@ -55,4 +55,17 @@ void addGeometryFlags(cs::utils::CommandLine& commandLine, Geometry& settings) {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void addBackendFlags(cs::utils::CommandLine& commandLine, Backend& settings) {
+  commandLine.addArgument({"--cpu"}, &settings.mUseCPU,
+      "Run the computation on the CPU instead of the GPU. This is done automatically if no CUDA "
+      "device is available (default: " +
+          std::to_string(settings.mUseCPU) + ").");
+  commandLine.addArgument({"--threads"}, &settings.mThreads,
+      "The number of threads used by the CPU backend. Zero uses one thread per hardware thread "
+      "(default: " +
+          std::to_string(settings.mThreads) + ").");
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 } // namespace common
\ No newline at end of file
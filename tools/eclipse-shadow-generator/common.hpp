@@ -41,6 +41,14 @@ struct Geometry {
   double mCloudAltitude        = 0.0;
 };
 
+// This is used to select where the kernels are executed. Per default, they run on the GPU using
+// CUDA. If the CPU backend is selected or if no CUDA device is available, the kernels are executed
+// by a pool of CPU threads instead. The values can be set via command line arguments.
+struct Backend {
+  bool     mUseCPU  = false;
+  uint32_t mThreads = 0; // Zero means one thread per hardware thread.
+};
+
 // This adds the command line arguments for the shadow-map parameterization to the given
 // CommandLine object.
 void addMappingFlags(cs::utils::CommandLine& commandLine, Mapping& settings);
@@ -53,6 +61,9 @@ void addOutputFlags(cs::utils::CommandLine& commandLine, Output& settings);
 // atmosphere to the given CommandLine object.
 void addGeometryFlags(cs::utils::CommandLine& commandLine, Geometry& settings);
 
+// This adds the command line arguments for selecting the backend to the given CommandLine object.
+void addBackendFlags(cs::utils::CommandLine& commandLine, Backend& settings);
+
 } // namespace common
 
 #endif // COMMON_HPP
\ No newline at end of file
@@ -0,0 +1,102 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "compare_mode.hpp"
+
+#include "../../src/cs-utils/CommandLine.hpp"
+#include "tiff_utils.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace compare {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int compareMode(std::vector<std::string> const& arguments) {
+  std::string reference;
+  std::string input;
+  double      tolerance = 1e-3;
+  bool        printHelp = false;
+
+  // First configure all possible command line options.
+  cs::utils::CommandLine args("Here are the available options:");
+  args.addArgument({"--reference"}, &reference, "The path to the reference texture.");
+  args.addArgument({"--input"}, &input, "The path to the texture which should be checked.");
+  args.addArgument({"--tolerance"}, &tolerance,
+      "The maximum allowed difference (default: " + std::to_string(tolerance) + ").");
+  args.addArgument({"-h", "--help"}, &printHelp, "Show this help message.");
+
+  // Then do the actual parsing.
+  try {
+    args.parse(arguments);
+  } catch (std::runtime_error const& e) {
+    std::cerr << "Failed to parse command line arguments: " << e.what() << std::endl;
+    return 1;
+  }
+
+  // When printHelp was set to true, we print a help message and exit.
+  if (printHelp) {
+    args.printHelp();
+    return 0;
+  }
+
+  if (reference.empty() || input.empty()) {
+    std::cerr << "You must provide the textures to compare using --reference and --input!"
+              << std::endl;
+    return 1;
+  }
+
+  uint32_t layers = tiff_utils::getNumLayers(reference);
+
+  if (layers == 0 || layers != tiff_utils::getNumLayers(input)) {
+    std::cerr << "The textures have a different number of layers!" << std::endl;
+    return 1;
+  }
+
+  double maxError      = 0.0;
+  size_t failingValues = 0;
+
+  for (uint32_t layer = 0; layer < layers; ++layer) {
+    tiff_utils::RGBATexture a = tiff_utils::read2DTexture(reference, layer);
+    tiff_utils::RGBATexture b = tiff_utils::read2DTexture(input, layer);
+
+    if (a.width != b.width || a.height != b.height) {
+      std::cerr << "The textures have a different size!" << std::endl;
+      return 1;
+    }
+
+    for (size_t i = 0; i < a.data.size(); ++i) {
+      double value = a.data[i];
+      double error = std::abs(value - b.data[i]) / std::max(1.0, std::abs(value));
+
+      // This also catches NaNs in the input texture.
+      if (!(error <= tolerance)) {
+        ++failingValues;
+      }
+
+      maxError = std::max(maxError, error);
+    }
+  }
+
+  std::cout << "Maximum error: " << maxError << std::endl;
+
+  if (failingValues > 0) {
+    std::cerr << failingValues << " values exceed the tolerance of " << tolerance << "!"
+              << std::endl;
+    return 1;
+  }
+
+  std::cout << "All values are within the tolerance of " << tolerance << "." << std::endl;
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace compare
@@ -0,0 +1,27 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#ifndef COMPARE_MODE_HPP
+#define COMPARE_MODE_HPP
+
+#include <string>
+#include <vector>
+
+// The "compare" mode is used to check that the CPU and the GPU backend produce the same results.
+// It loads two textures created by any of the other modes and reports the largest difference
+// between them. If any value differs by more than the given tolerance, a non-zero value is
+// returned so that the mode can be used in automated regression tests.
+
+namespace compare {
+
+// Compares all layers of the two given TIFF files. For values smaller than one, the tolerance is
+// an absolute error bound. For larger values, it is a relative error bound.
+int compareMode(std::vector<std::string> const& arguments);
+
+} // namespace compare
+
+#endif // COMPARE_MODE_HPP
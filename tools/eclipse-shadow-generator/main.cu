@@ -8,6 +8,7 @@
 #include "../../src/cs-utils/CommandLine.hpp"
 
 #include "advanced_modes.cuh"
+#include "compare_mode.hpp"
 #include "gpuErrCheck.hpp"
 #include "simple_modes.cuh"
 
@@ -31,6 +32,7 @@ void printHelp() {
   std::cout << "planet-view    Computes a view of a planet as seen from space." << std::endl;
   std::cout << "atmo-view      Computes a view of the entire atmosphere from a given position in space." << std::endl;
   std::cout << "limb-luminance Computes the average luminance of atmosphere for each position in the shadow map in a direction-dependent manner." << std::endl;
+  std::cout << "compare        Compares two textures, for instance to check that the CPU and the GPU backend produce the same results." << std::endl;
 }
 // clang-format on
 
@@ -82,6 +84,10 @@ int main(int argc, char** argv) {
     return advanced::atmoViewMode(arguments);
   }
 
+  if (cMode == "compare") {
+    return compare::compareMode(arguments);
+  }
+
   printHelp();
 
   return 0;
@@ -0,0 +1,102 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#include "parallel.cuh"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+
+namespace detail {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void forEachRow(uint32_t threads, uint32_t rows, std::function<void(uint32_t)> const& function) {
+  std::atomic<uint32_t> nextRow{0};
+
+  auto worker = [&]() {
+    for (uint32_t row = nextRow++; row < rows; row = nextRow++) {
+      function(row);
+    }
+  };
+
+  std::vector<std::thread> workers;
+  workers.reserve(threads - 1);
+
+  for (uint32_t i = 1; i < threads; ++i) {
+    workers.emplace_back(worker);
+  }
+
+  // The calling thread participates as well.
+  worker();
+
+  for (auto& thread : workers) {
+    thread.join();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace detail
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void selectBackend(common::Backend& backend) {
+  if (backend.mUseCPU) {
+    return;
+  }
+
+  int         deviceCount = 0;
+  cudaError_t error       = cudaGetDeviceCount(&deviceCount);
+
+  if (error != cudaSuccess || deviceCount == 0) {
+    std::cout << "No CUDA device available, falling back to the CPU backend." << std::endl;
+    backend.mUseCPU = true;
+
+    // Reset the sticky error state of the CUDA runtime.
+    cudaGetLastError();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+uint32_t getThreadCount(common::Backend const& backend) {
+  if (backend.mThreads > 0) {
+    return backend.mThreads;
+  }
+
+  return std::max(1U, std::thread::hardware_concurrency());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+float* allocateBuffer(common::Backend const& backend, size_t count) {
+  if (backend.mUseCPU) {
+    return new float[count];
+  }
+
+  float* buffer = nullptr;
+  gpuErrchk(cudaMallocManaged(&buffer, count * sizeof(float)));
+  return buffer;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void freeBuffer(common::Backend const& backend, float* buffer) {
+  if (backend.mUseCPU) {
+    delete[] buffer;
+  } else {
+    gpuErrchk(cudaFree(buffer));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace parallel
@@ -0,0 +1,113 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+// SPDX-License-Identifier: MIT
+
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include "common.hpp"
+#include "gpuErrCheck.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+
+#define GLM_FORCE_CTOR_INIT
+#include <glm/glm.hpp>
+
+// The kernels of the eclipse-shadow-generator are implemented as function objects with a
+// __host__ __device__ call operator which computes a single texel of the output. The functions in
+// this file execute such a kernel for all texels of the output, either on the GPU or on the CPU.
+
+namespace parallel {
+
+namespace detail {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename Kernel>
+__global__ void launch(glm::uvec3 size, Kernel kernel) {
+  uint32_t x = blockIdx.x * blockDim.x + threadIdx.x;
+  uint32_t y = blockIdx.y * blockDim.y + threadIdx.y;
+  uint32_t z = blockIdx.z * blockDim.z + threadIdx.z;
+
+  if ((x >= size.x) || (y >= size.y) || (z >= size.z)) {
+    return;
+  }
+
+  kernel(x, y, z);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Calls the given function for each row index in [0, rows) using the given number of threads. The
+// rows are distributed dynamically, so that threads which get cheap rows do not idle.
+void forEachRow(uint32_t threads, uint32_t rows, std::function<void(uint32_t)> const& function);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace detail
+
+// Switches to the CPU backend if no CUDA device is available. This should be called once after
+// the command line arguments have been parsed.
+void selectBackend(common::Backend& backend);
+
+// Returns the number of threads which will be used by the CPU backend.
+uint32_t getThreadCount(common::Backend const& backend);
+
+// Allocates a buffer for the given number of floats. For the GPU backend, managed memory is used
+// so that the result can be accessed on the host once the kernel has finished.
+float* allocateBuffer(common::Backend const& backend, size_t count);
+
+// Frees a buffer which has been allocated with allocateBuffer().
+void freeBuffer(common::Backend const& backend, float* buffer);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Calls kernel(x, y, z) for each cell of a grid with the given size and waits until all cells are
+// computed. On the GPU, the given block size is used. On the CPU, each thread processes entire rows
+// of the grid, so that the innermost loop runs over consecutive x coordinates.
+template <typename Kernel>
+void forEach(common::Backend const& backend, glm::uvec3 const& size, dim3 const& blockSize,
+    Kernel const& kernel) {
+
+  auto start = std::chrono::steady_clock::now();
+
+  if (backend.mUseCPU) {
+    detail::forEachRow(getThreadCount(backend), size.y * size.z, [&](uint32_t row) {
+      uint32_t y = row % size.y;
+      uint32_t z = row / size.y;
+      for (uint32_t x = 0; x < size.x; ++x) {
+        kernel(x, y, z);
+      }
+    });
+  } else {
+    dim3 gridSize((size.x + blockSize.x - 1) / blockSize.x,
+        (size.y + blockSize.y - 1) / blockSize.y, (size.z + blockSize.z - 1) / blockSize.z);
+
+    detail::launch<<<gridSize, blockSize>>>(size, kernel);
+
+    gpuErrchk(cudaPeekAtLastError());
+    gpuErrchk(cudaDeviceSynchronize());
+  }
+
+  std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+
+  std::cout << "Computed " << size.x * size.y * size.z << " texels ";
+  if (backend.mUseCPU) {
+    std::cout << "on the CPU using " << getThreadCount(backend) << " threads ";
+  } else {
+    std::cout << "on the GPU ";
+  }
+  std::cout << "in " << duration.count() << " s." << std::endl;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace parallel
+
+#endif // PARALLEL_HPP
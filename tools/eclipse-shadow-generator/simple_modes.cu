@@ -11,6 +11,7 @@
 #include "common.hpp"
 #include "gpuErrCheck.hpp"
 #include "math.cuh"
+#include "parallel.cuh"
 #include "tiff_utils.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -23,7 +24,7 @@ enum class Mode { eLimbDarkening, eCircleIntersection, eLinear, eSmoothstep };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-__device__ void writeAsRGBValue(float value, float* buffer, uint32_t index) {
+__host__ __device__ void writeAsRGBValue(float value, float* buffer, uint32_t index) {
   buffer[index * 3 + 0] = value;
   buffer[index * 3 + 1] = value;
   buffer[index * 3 + 2] = value;
@@ -31,109 +32,108 @@ __device__ void writeAsRGBValue(float value, float* buffer, uint32_t index) {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-__global__ void computeLimbDarkeningShadow(
-    common::Mapping mapping, common::Output output, common::LimbDarkening limbDarkening) {
-  uint32_t x = blockIdx.x * blockDim.x + threadIdx.x;
-  uint32_t y = blockIdx.y * blockDim.y + threadIdx.y;
-  uint32_t i = y * output.mSize + x;
+struct LimbDarkeningShadow {
+  common::Mapping       mMapping;
+  common::Output        mOutput;
+  common::LimbDarkening mLimbDarkening;
 
-  if ((x >= output.mSize) || (y >= output.mSize)) {
-    return;
-  }
+  __host__ __device__ void operator()(uint32_t x, uint32_t y, uint32_t /*z*/) const {
+    uint32_t i = y * mOutput.mSize + x;
 
-  double radiusOcc, distance;
-  math::mapPixelToRadii(glm::ivec2(x, y), output.mSize, mapping, radiusOcc, distance);
+    double radiusOcc, distance;
+    math::mapPixelToRadii(glm::ivec2(x, y), mOutput.mSize, mMapping, radiusOcc, distance);
 
-  double sunArea   = math::getCircleArea(1.0);
-  float  intensity = static_cast<float>(
-      1 - math::sampleCircleIntersection(1.0, radiusOcc, distance, limbDarkening) / sunArea);
+    double sunArea   = math::getCircleArea(1.0);
+    float  intensity = static_cast<float>(
+        1 - math::sampleCircleIntersection(1.0, radiusOcc, distance, mLimbDarkening) / sunArea);
 
-  writeAsRGBValue(intensity, output.mBuffer, i);
-}
+    writeAsRGBValue(intensity, mOutput.mBuffer, i);
+  }
+};
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-__global__ void computeCircleIntersectionShadow(common::Mapping mapping, common::Output output) {
-  uint32_t x = blockIdx.x * blockDim.x + threadIdx.x;
-  uint32_t y = blockIdx.y * blockDim.y + threadIdx.y;
-  uint32_t i = y * output.mSize + x;
+struct CircleIntersectionShadow {
+  common::Mapping mMapping;
+  common::Output  mOutput;
 
-  if ((x >= output.mSize) || (y >= output.mSize)) {
-    return;
-  }
+  __host__ __device__ void operator()(uint32_t x, uint32_t y, uint32_t /*z*/) const {
+    uint32_t i = y * mOutput.mSize + x;
 
-  double radiusOcc, distance;
-  math::mapPixelToRadii(glm::ivec2(x, y), output.mSize, mapping, radiusOcc, distance);
+    double radiusOcc, distance;
+    math::mapPixelToRadii(glm::ivec2(x, y), mOutput.mSize, mMapping, radiusOcc, distance);
 
-  double sunArea = math::getCircleArea(1.0);
-  float  intensity =
-      static_cast<float>(1.0 - math::getCircleIntersection(1.0, radiusOcc, distance) / sunArea);
+    double sunArea = math::getCircleArea(1.0);
+    float  intensity =
+        static_cast<float>(1.0 - math::getCircleIntersection(1.0, radiusOcc, distance) / sunArea);
 
-  writeAsRGBValue(intensity, output.mBuffer, i);
-}
+    writeAsRGBValue(intensity, mOutput.mBuffer, i);
+  }
+};
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-__global__ void computeLinearShadow(common::Mapping mapping, common::Output output) {
-  uint32_t x = blockIdx.x * blockDim.x + threadIdx.x;
-  uint32_t y = blockIdx.y * blockDim.y + threadIdx.y;
-  uint32_t i = y * output.mSize + x;
+struct LinearShadow {
+  common::Mapping mMapping;
+  common::Output  mOutput;
 
-  if ((x >= output.mSize) || (y >= output.mSize)) {
-    return;
-  }
+  __host__ __device__ void operator()(uint32_t x, uint32_t y, uint32_t /*z*/) const {
+    uint32_t i = y * mOutput.mSize + x;
 
-  double radiusSun = 1.0;
-  double radiusOcc, distance;
-  math::mapPixelToRadii(glm::ivec2(x, y), output.mSize, mapping, radiusOcc, distance);
+    double radiusSun = 1.0;
+    double radiusOcc, distance;
+    math::mapPixelToRadii(glm::ivec2(x, y), mOutput.mSize, mMapping, radiusOcc, distance);
 
-  double visiblePortion = (distance - glm::abs(radiusSun - radiusOcc)) /
-                          (radiusSun + radiusOcc - glm::abs(radiusSun - radiusOcc));
+    double visiblePortion = (distance - glm::abs(radiusSun - radiusOcc)) /
+                            (radiusSun + radiusOcc - glm::abs(radiusSun - radiusOcc));
 
-  double maxDepth = glm::min(1.0, glm::pow(radiusOcc / radiusSun, 2.0));
+    double maxDepth = glm::min(1.0, glm::pow(radiusOcc / radiusSun, 2.0));
 
-  float intensity = static_cast<float>(1.0 - maxDepth * glm::clamp(1.0 - visiblePortion, 0.0, 1.0));
+    float intensity =
+        static_cast<float>(1.0 - maxDepth * glm::clamp(1.0 - visiblePortion, 0.0, 1.0));
 
-  writeAsRGBValue(intensity, output.mBuffer, i);
-}
+    writeAsRGBValue(intensity, mOutput.mBuffer, i);
+  }
+};
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-__global__ void computeSmoothstepShadow(common::Mapping mapping, common::Output output) {
-  uint32_t x = blockIdx.x * blockDim.x + threadIdx.x;
-  uint32_t y = blockIdx.y * blockDim.y + threadIdx.y;
-  uint32_t i = y * output.mSize + x;
+struct SmoothstepShadow {
+  common::Mapping mMapping;
+  common::Output  mOutput;
 
-  if ((x >= output.mSize) || (y >= output.mSize)) {
-    return;
-  }
+  __host__ __device__ void operator()(uint32_t x, uint32_t y, uint32_t /*z*/) const {
+    uint32_t i = y * mOutput.mSize + x;
 
-  double radiusSun = 1.0;
-  double radiusOcc, distance;
-  math::mapPixelToRadii(glm::ivec2(x, y), output.mSize, mapping, radiusOcc, distance);
+    double radiusSun = 1.0;
+    double radiusOcc, distance;
+    math::mapPixelToRadii(glm::ivec2(x, y), mOutput.mSize, mMapping, radiusOcc, distance);
 
-  double visiblePortion = (distance - glm::abs(radiusSun - radiusOcc)) /
-                          (radiusSun + radiusOcc - glm::abs(radiusSun - radiusOcc));
+    double visiblePortion = (distance - glm::abs(radiusSun - radiusOcc)) /
+                            (radiusSun + radiusOcc - glm::abs(radiusSun - radiusOcc));
 
-  double maxDepth = glm::min(1.0, glm::pow(radiusOcc / radiusSun, 2.0));
+    double maxDepth = glm::min(1.0, glm::pow(radiusOcc / radiusSun, 2.0));
 
-  float intensity = static_cast<float>(
-      1.0 - maxDepth * glm::clamp(1.0 - glm::smoothstep(0.0, 1.0, visiblePortion), 0.0, 1.0));
+    float intensity = static_cast<float>(
+        1.0 - maxDepth * glm::clamp(1.0 - glm::smoothstep(0.0, 1.0, visiblePortion), 0.0, 1.0));
 
-  writeAsRGBValue(intensity, output.mBuffer, i);
-}
+    writeAsRGBValue(intensity, mOutput.mBuffer, i);
+  }
+};
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 int run(Mode mode, std::vector<std::string> const& arguments) {
   common::Mapping mapping;
   common::Output  output;
+  common::Backend backend;
   bool            cPrintHelp = false;
 
   // First configure all possible command line options.
   cs::utils::CommandLine args("Here are the available options:");
   common::addMappingFlags(args, mapping);
   common::addOutputFlags(args, output);
+  common::addBackendFlags(args, backend);
   args.addArgument({"-h", "--help"}, &cPrintHelp, "Show this help message.");
 
   // Then do the actual parsing.
@@ -150,39 +150,37 @@ int run(Mode mode, std::vector<std::string> const& arguments) {
     return 0;
   }
 
+  parallel::selectBackend(backend);
+
   // Initialize the limb darkening model.
   common::LimbDarkening limbDarkening;
   limbDarkening.init();
 
-  // Compute the 2D kernel size.
-  dim3     blockSize(16, 16);
-  uint32_t numBlocksX = (output.mSize + blockSize.x - 1) / blockSize.x;
-  uint32_t numBlocksY = (output.mSize + blockSize.y - 1) / blockSize.y;
-  dim3     gridSize   = dim3(numBlocksX, numBlocksY);
-
   // Allocate the shared memory for the shadow map.
-  gpuErrchk(cudaMallocManaged(
-      &output.mBuffer, static_cast<size_t>(output.mSize * output.mSize) * 3 * sizeof(float)));
+  output.mBuffer = parallel::allocateBuffer(
+      backend, static_cast<size_t>(output.mSize * output.mSize) * 3);
+
+  // Compute the shadow map using 2D kernels.
+  glm::uvec3 size(output.mSize, output.mSize, 1);
+  dim3       blockSize(16, 16);
 
   if (mode == Mode::eLimbDarkening) {
-    computeLimbDarkeningShadow<<<gridSize, blockSize>>>(mapping, output, limbDarkening);
+    parallel::forEach(
+        backend, size, blockSize, LimbDarkeningShadow{mapping, output, limbDarkening});
   } else if (mode == Mode::eCircleIntersection) {
-    computeCircleIntersectionShadow<<<gridSize, blockSize>>>(mapping, output);
+    parallel::forEach(backend, size, blockSize, CircleIntersectionShadow{mapping, output});
   } else if (mode == Mode::eLinear) {
-    computeLinearShadow<<<gridSize, blockSize>>>(mapping, output);
+    parallel::forEach(backend, size, blockSize, LinearShadow{mapping, output});
   } else if (mode == Mode::eSmoothstep) {
-    computeSmoothstepShadow<<<gridSize, blockSize>>>(mapping, output);
+    parallel::forEach(backend, size, blockSize, SmoothstepShadow{mapping, output});
   }
 
-  gpuErrchk(cudaPeekAtLastError());
-  gpuErrchk(cudaDeviceSynchronize());
-
   // Finally write the output texture!
   tiff_utils::write2D(output.mFile, output.mBuffer, static_cast<int>(output.mSize),
       static_cast<int>(output.mSize), 3);
 
   // Free the shared memory.
-  gpuErrchk(cudaFree(output.mBuffer));
+  parallel::freeBuffer(backend, output.mBuffer);
 
   return 0;
 }
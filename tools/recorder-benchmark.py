@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+
+# ------------------------------------------------------------------------------------------------ #
+#                                This file is part of CosmoScout VR                                #
+# ------------------------------------------------------------------------------------------------ #
+
+# SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+# SPDX-License-Identifier: MIT
+
+# This script compares the two ways of rendering a recording of csp-recorder. It requires a running
+# instance of CosmoScout VR with the csp-recorder and csp-web-api plugins enabled.
+#
+# First, the recording is rendered like the Python scripts written by earlier versions of
+# csp-recorder did: For each frame, the observer, the time and the exposure are set via the /run-js
+# endpoint and the image is then downloaded from the /capture endpoint. Afterwards, the same
+# recording is rendered in-process with CosmoScout.callbacks.recorder.renderRecording(). The
+# achieved frames per second are printed for both routes.
+#
+# Usage:
+#   python3 recorder-benchmark.py <recording.jsonl> [--port 9001] [--format png]
+#
+# Both routes use the same image format. The recording must be given as a path which is valid for
+# the CosmoScout VR instance as well. Stop the time and disable auto-exposure before running this,
+# as the in-process route does this automatically.
+
+import argparse
+import json
+import os
+import time
+import urllib.request
+
+parser = argparse.ArgumentParser()
+parser.add_argument("recording", help="a recording-<date>.jsonl file written by csp-recorder")
+parser.add_argument("--port", type=int, default=9001, help="the port of csp-web-api")
+parser.add_argument("--format", default="png", choices=["png", "jpeg", "tiff"])
+args = parser.parse_args()
+
+cosmoscout = "http://localhost:" + str(args.port)
+recording = os.path.abspath(args.recording)
+
+with open(recording) as f:
+  frames = [json.loads(line) for line in f if line.strip()]
+
+
+def runJS(code):
+  urllib.request.urlopen(cosmoscout + "/run-js", data=code.encode()).read()
+
+
+def capture():
+  url = cosmoscout + "/capture?delay=1&format=" + args.format
+  return urllib.request.urlopen(url).read()
+
+
+# HTTP route ---------------------------------------------------------------------------------------
+
+httpDirectory = os.path.splitext(recording)[0] + "-http"
+os.makedirs(httpDirectory, exist_ok=True)
+
+start = time.monotonic()
+
+for i, frame in enumerate(frames):
+  code = ""
+
+  if "center" in frame:
+    code += "CosmoScout.callbacks.navigation.setBodyFull('{}', '{}', " \
+        "{}, {}, {}, {}, {}, {}, {}, 0);" \
+        .format(frame["center"], frame["frame"], *frame["position"], *frame["rotation"])
+
+  if "time" in frame:
+    code += "CosmoScout.callbacks.time.set({!r}, 0);".format(frame["time"])
+
+  if "exposure" in frame:
+    code += "CosmoScout.callbacks.graphics.setExposure({!r});".format(frame["exposure"])
+
+  if code:
+    runJS(code)
+
+  with open(os.path.join(httpDirectory, "frame_{}.{}".format(i, args.format)), "wb") as f:
+    f.write(capture())
+
+httpSeconds = time.monotonic() - start
+
+print("HTTP route:       {} frames in {:.1f} s ({:.1f} frames per second)".format(
+    len(frames), httpSeconds, len(frames) / httpSeconds))
+
+# In-process route ---------------------------------------------------------------------------------
+
+# The frames are written to a directory next to the recording. As there is no way to query the
+# progress over HTTP, we wait until all frames of this run have been written. The images are
+# encoded in parallel, so they are not necessarily written in order.
+directory = os.path.splitext(recording)[0]
+extension = "jpg" if args.format == "jpeg" else args.format
+pending = [os.path.join(directory, "frame_{}.{}".format(i, extension)) for i in range(len(frames))]
+
+start = time.monotonic()
+startTime = time.time()
+
+runJS("CosmoScout.callbacks.recorder.renderRecording({}, '{}');".format(
+    json.dumps(recording), args.format))
+
+while pending:
+  pending = [p for p in pending if not os.path.exists(p) or os.path.getmtime(p) < startTime]
+  time.sleep(0.01)
+
+inProcessSeconds = time.monotonic() - start
+
+print("In-process route: {} frames in {:.1f} s ({:.1f} frames per second)".format(
+    len(frames), inProcessSeconds, len(frames) / inProcessSeconds))
+print("Speed-up:         {:.1f}x".format(httpSeconds / inProcessSeconds))
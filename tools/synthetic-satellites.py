@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+
+# ------------------------------------------------------------------------------------------------ #
+#                                This file is part of CosmoScout VR                                #
+# ------------------------------------------------------------------------------------------------ #
+
+# SPDX-FileCopyrightText: German Aerospace Center (DLR) <cosmoscout@dlr.de>
+# SPDX-License-Identifier: MIT
+
+# This script creates a synthetic scene with many satellites of csp-satellites which all share the
+# same glTF model. It is meant for measuring the draw calls and the CPU frame time of many instanced
+# satellites. As no SPICE kernels are required, each satellite is an object which is centered on
+# the Earth with a fixed position and rotation. The satellites are distributed evenly on a sphere
+# around the Earth, so they are all visible from the default observer position.
+#
+# Usage:
+#   python3 synthetic-satellites.py <input settings> <output settings> --model <file.glb>
+#           --environment-map <file.dds> [--count 1000] [--radius 8000000] [--size 50000]
+#
+# The paths of the model and the environment map are written to the settings as given, so they
+# should be relative to CosmoScout VR's bin directory or absolute. The draw calls are reported as
+# "glTF Draw Calls" in the frame timings, which can be shown with csp-timings.
+
+import argparse
+import json
+import math
+
+parser = argparse.ArgumentParser()
+parser.add_argument("input", help="the settings to add the satellites to")
+parser.add_argument("output", help="the file to write the resulting settings to")
+parser.add_argument("--model", required=True, help="the glTF model of all satellites")
+parser.add_argument("--environment-map", required=True, help="the environment map")
+parser.add_argument("--count", type=int, default=1000, help="the number of satellites")
+parser.add_argument("--radius", type=float, default=8000000.0,
+                    help="the distance of the satellites from the center of the Earth in meters")
+parser.add_argument("--size", type=float, default=50000.0,
+                    help="the radius of each satellite in meters")
+args = parser.parse_args()
+
+with open(args.input) as f:
+  settings = json.load(f)
+
+objects = settings.setdefault("objects", {})
+satellites = settings.setdefault("plugins", {}).setdefault(
+    "csp-satellites", {}).setdefault("satellites", {})
+
+existence = objects["Earth"]["existence"] if "Earth" in objects else [
+    "1950-01-02 00:00:00.000", "2049-12-31 00:00:00.000"]
+
+# The satellites are placed on a Fibonacci sphere. Each satellite is rotated around the z-axis so
+# that not all of them face the same direction.
+goldenAngle = math.pi * (3.0 - math.sqrt(5.0))
+
+for i in range(args.count):
+  name = "Synthetic Satellite {}".format(i)
+
+  y = 1.0 - 2.0 * (i + 0.5) / args.count
+  r = math.sqrt(1.0 - y * y)
+  theta = goldenAngle * i
+
+  position = [args.radius * r * math.cos(theta), args.radius * y, args.radius * r * math.sin(theta)]
+  rotation = [0.0, 0.0, math.sin(theta * 0.5), math.cos(theta * 0.5)]
+
+  objects[name] = {
+      "center": "Earth",
+      "frame": "IAU_Earth",
+      "position": position,
+      "rotation": rotation,
+      "existence": existence,
+      "trackable": False
+  }
+
+  satellites[name] = {
+      "modelFile": args.model,
+      "environmentMap": args.environment_map,
+      "size": args.size
+  }
+
+with open(args.output, "w") as f:
+  json.dump(settings, f, indent=2)
+
+print("Wrote {} satellites to '{}'.".format(args.count, args.output))